@@ -5,6 +5,7 @@ set(SO3_VERSION "@PROJECT_VERSION@")
 include(CMakeFindDependencyMacro)
 find_dependency(FFTW3 REQUIRED)
 find_dependency(Ssht REQUIRED)
+find_dependency(Threads REQUIRED)
 
 include("${CMAKE_CURRENT_LIST_DIR}/astro-informatics-so3Targets.cmake")
 set(SO3_LIBRARIES astro-informatics-so3::astro-informatics-so3)
@@ -8,5 +8,21 @@
 #include "so3_core.h"
 #include "so3_adjoint.h"
 #include "so3_conv.h"
+#include "so3_small.h"
+#include "so3_tune.h"
+#include "so3_fft.h"
+#include "so3_alloc.h"
+#include "so3_solver.h"
+#include "so3_flmn.h"
+#include "so3_filter.h"
+#include "so3_wigner.h"
+#include "so3_sparse.h"
+#include "so3_grid.h"
+#include "so3_interp.h"
+#include "so3_search.h"
+#include "so3_resample.h"
+#include "so3_descriptor.h"
+#include "so3_quadrature.h"
+#include "so3_codec.h"
 
 #endif // SO3_H
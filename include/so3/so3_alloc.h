@@ -0,0 +1,49 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_ALLOC
+#define SO3_ALLOC
+
+#include <stddef.h>
+
+/*!
+ * Buffers of at least this many bytes are mapped directly from the kernel
+ * and advised to use transparent huge pages.
+ */
+#ifndef SO3_ALLOC_LARGE_MIN
+#define SO3_ALLOC_LARGE_MIN (2 << 20)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  /*!
+   * Map large buffers untouched, so that each page is placed on the NUMA
+   * node of the thread that first writes it, and advise huge pages.
+   */
+  SO3_ALLOC_POLICY_LOCAL,
+  /*! Plain calloc, for comparison. */
+  SO3_ALLOC_POLICY_CALLOC,
+  /*!
+   * As \link SO3_ALLOC_POLICY_LOCAL \endlink, but if so3 is built with
+   * libnuma (SO3_NUMA) the pages are bound to the node of the allocating
+   * thread, whichever thread first writes them. Without libnuma this is the
+   * same as \link SO3_ALLOC_POLICY_LOCAL \endlink.
+   */
+  SO3_ALLOC_POLICY_BIND,
+  SO3_ALLOC_POLICY_SIZE
+} so3_alloc_policy_t;
+
+void *so3_alloc_large(size_t count, size_t size);
+void so3_alloc_free(void *ptr);
+
+void so3_alloc_set_policy(so3_alloc_policy_t policy);
+so3_alloc_policy_t so3_alloc_get_policy(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,73 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_ASYNC
+#define SO3_ASYNC
+
+#include "so3_types.h"
+#include <complex.h>
+
+/*!
+ * Largest number of queued jobs with identical parameters that a worker
+ * gathers into one batch.
+ */
+#ifndef SO3_ASYNC_MAX_BATCH
+#define SO3_ASYNC_MAX_BATCH 256
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Pool of worker threads, see so3_async.c. Without SO3_ASYNC_FFTW_THREADS,
+ * the pool installs a planner lock in so3_fft, so FFTW planning is
+ * serialised across the process. Transforms with L > SO3_SMALL_L_MAX run
+ * concurrently when the tuner chooses the direct method. With the method
+ * via SSHT, which plans inside SSHT, they run one at a time.
+ */
+typedef struct so3_async so3_async_t;
+typedef struct so3_async_job so3_async_job_t;
+
+/*!
+ * Completion callback of a submitted job. It runs on the worker thread which
+ * ran the job, once the output has been written and before the job is
+ * reported as done, so it must neither wait for its own job nor block for
+ * long.
+ */
+typedef void (*so3_async_callback_t)(so3_async_job_t *job, void *user_data);
+
+so3_async_t *so3_async_start(int nworkers);
+void so3_async_stop(so3_async_t *pool);
+
+so3_async_job_t *so3_submit_inverse(
+    so3_async_t *pool, SO3_COMPLEX(double) * f, const SO3_COMPLEX(double) * flmn,
+    const so3_parameters_t *parameters, so3_async_callback_t callback,
+    void *user_data);
+so3_async_job_t *so3_submit_inverse_real(
+    so3_async_t *pool, double *f, const SO3_COMPLEX(double) * flmn,
+    const so3_parameters_t *parameters, so3_async_callback_t callback,
+    void *user_data);
+so3_async_job_t *so3_submit_forward(
+    so3_async_t *pool, SO3_COMPLEX(double) * flmn, const SO3_COMPLEX(double) * f,
+    const so3_parameters_t *parameters, so3_async_callback_t callback,
+    void *user_data);
+so3_async_job_t *so3_submit_forward_real(
+    so3_async_t *pool, SO3_COMPLEX(double) * flmn, const double *f,
+    const so3_parameters_t *parameters, so3_async_callback_t callback,
+    void *user_data);
+so3_async_job_t *so3_submit_convolve(
+    so3_async_t *pool, SO3_COMPLEX(double) * hlmn, const SO3_COMPLEX(double) * flmn,
+    const so3_parameters_t *f_parameters, const SO3_COMPLEX(double) * glmn,
+    const so3_parameters_t *g_parameters, so3_async_callback_t callback,
+    void *user_data);
+
+int so3_async_poll(so3_async_job_t *job);
+void so3_async_wait(so3_async_job_t *job);
+void so3_async_release(so3_async_job_t *job);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,123 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_CLIENT
+#define SO3_CLIENT
+
+#include "so3_types.h"
+#include <complex.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+ * Environment variable holding the path of the so3d socket. If it is not
+ * set, $XDG_RUNTIME_DIR/so3d.sock is used, or /tmp/so3d-<uid>.sock if
+ * XDG_RUNTIME_DIR is not set either.
+ */
+#define SO3_SERVER_SOCKET_ENV "SO3D_SOCKET"
+
+/*! Identifies so3d requests, and changes whenever the request layout does. */
+#define SO3_SERVER_MAGIC 0x534f3301u
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  /*! Complex inverse transforms, flmn -> f. */
+  SO3_SERVER_INVERSE,
+  /*! Complex forward transforms, f -> flmn. */
+  SO3_SERVER_FORWARD,
+  /*! Real inverse transforms, flmn (n >= 0) -> real f. */
+  SO3_SERVER_INVERSE_REAL,
+  /*! Real forward transforms, real f -> flmn (n >= 0). */
+  SO3_SERVER_FORWARD_REAL,
+  /*! so3_conv_harmonic_convolution, (flmn, glmn) -> hlmn. */
+  SO3_SERVER_HARMONIC_CONVOLUTION,
+  SO3_SERVER_OP_SIZE
+} so3_server_op_t;
+
+typedef enum {
+  SO3_SERVER_OK = 0,
+  /*! The request was malformed or its buffers were too small. */
+  SO3_SERVER_EINVAL,
+  /*! The shared-memory buffer could not be mapped. */
+  SO3_SERVER_ESHM,
+  /*! The connection to the server failed. */
+  SO3_SERVER_EIO
+} so3_server_status_t;
+
+/*!
+ * Request sent over the socket, together with the file descriptor of the
+ * shared-memory buffer holding its input and output.
+ *
+ * The input of a request holds batch signals stored one after the other. For
+ * \link SO3_SERVER_HARMONIC_CONVOLUTION \endlink each input signal is flmn
+ * (described by parameters) immediately followed by glmn (described by
+ * g_parameters), and each output is hlmn with the parameters returned by
+ * \link so3_conv_get_parameters_of_convolved_lmn \endlink.
+ *
+ * The parameters are sent as raw structs, so client and server must be built
+ * from the same version of so3.
+ */
+typedef struct {
+  uint32_t magic;
+  uint32_t op;
+  so3_parameters_t parameters;
+  so3_parameters_t g_parameters;
+  int32_t batch;
+  uint64_t shm_size, in_offset, out_offset;
+} so3_server_request_t;
+
+typedef struct {
+  int32_t status;
+} so3_server_response_t;
+
+/*!
+ * Buffer in anonymous shared memory that can be handed to the server without
+ * copying.
+ */
+typedef struct {
+  int fd;
+  void *data;
+  size_t size;
+} so3_shm_t;
+
+typedef struct so3_client so3_client_t;
+
+void so3_server_default_path(char *path, size_t size);
+so3_server_status_t so3_server_check_request(const so3_server_request_t *request);
+size_t so3_server_in_size(const so3_server_request_t *request);
+size_t so3_server_out_size(const so3_server_request_t *request);
+
+so3_shm_t *so3_shm_alloc(size_t size);
+void so3_shm_free(so3_shm_t *shm);
+
+so3_client_t *so3_client_connect(const char *path);
+void so3_client_close(so3_client_t *client);
+
+so3_server_status_t so3_client_submit(
+    so3_client_t *client, const so3_server_request_t *request, const so3_shm_t *shm);
+
+so3_server_status_t so3_client_inverse(
+    so3_client_t *client, SO3_COMPLEX(double) * f, const SO3_COMPLEX(double) * flmn,
+    int batch, const so3_parameters_t *parameters);
+so3_server_status_t so3_client_forward(
+    so3_client_t *client, SO3_COMPLEX(double) * flmn, const SO3_COMPLEX(double) * f,
+    int batch, const so3_parameters_t *parameters);
+so3_server_status_t so3_client_inverse_real(
+    so3_client_t *client, double *f, const SO3_COMPLEX(double) * flmn, int batch,
+    const so3_parameters_t *parameters);
+so3_server_status_t so3_client_forward_real(
+    so3_client_t *client, SO3_COMPLEX(double) * flmn, const double *f, int batch,
+    const so3_parameters_t *parameters);
+so3_server_status_t so3_client_harmonic_convolution(
+    so3_client_t *client, SO3_COMPLEX(double) * hlmn, const SO3_COMPLEX(double) * flmn,
+    const so3_parameters_t *f_parameters, const SO3_COMPLEX(double) * glmn,
+    const so3_parameters_t *g_parameters);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
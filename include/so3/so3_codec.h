@@ -0,0 +1,32 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_CODEC
+#define SO3_CODEC
+
+#include "so3_types.h"
+#include <complex.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t so3_codec_encode_bound(const so3_parameters_t *parameters);
+size_t so3_codec_encode(
+    unsigned char *data, const SO3_COMPLEX(double) * flmn, double error_bound,
+    const so3_parameters_t *parameters);
+size_t so3_codec_size(const unsigned char *data, size_t size);
+
+int so3_codec_decode(
+    SO3_COMPLEX(double) * flmn, const unsigned char *data, size_t size,
+    const so3_parameters_t *parameters);
+int so3_codec_decode_el(
+    SO3_COMPLEX(double) * flmn, const unsigned char *data, size_t size, int el,
+    const so3_parameters_t *parameters);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -44,6 +44,38 @@ void so3_core_forward_direct_real(
     SO3_COMPLEX(double) * flmn, const double* f,
     const so3_parameters_t* parameters);
 
+void so3_core_inverse_batch(
+    SO3_COMPLEX(double) * f, const SO3_COMPLEX(double) * flmn, int batch,
+    const so3_parameters_t* parameters);
+
+void so3_core_inverse_batch_real(
+    double* f, const SO3_COMPLEX(double) * flmn, int batch,
+    const so3_parameters_t* parameters);
+
+void so3_core_forward_batch(
+    SO3_COMPLEX(double) * flmn, const SO3_COMPLEX(double) * f, int batch,
+    const so3_parameters_t* parameters);
+
+void so3_core_forward_batch_real(
+    SO3_COMPLEX(double) * flmn, const double* f, int batch,
+    const so3_parameters_t* parameters);
+
+void so3_core_inverse_auto(
+    SO3_COMPLEX(double) * f, const SO3_COMPLEX(double) * flmn,
+    const so3_parameters_t* parameters);
+
+void so3_core_inverse_auto_real(
+    double* f, const SO3_COMPLEX(double) * flmn,
+    const so3_parameters_t* parameters);
+
+void so3_core_forward_auto(
+    SO3_COMPLEX(double) * flmn, const SO3_COMPLEX(double) * f,
+    const so3_parameters_t* parameters);
+
+void so3_core_forward_auto_real(
+    SO3_COMPLEX(double) * flmn, const double* f,
+    const so3_parameters_t* parameters);
+
 #ifdef __cplusplus
 }
 #endif
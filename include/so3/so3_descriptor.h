@@ -0,0 +1,38 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_DESCRIPTOR
+#define SO3_DESCRIPTOR
+
+#include "so3_types.h"
+#include <complex.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Selection of a bispectrum entry: the degrees and orders n of the two
+ * coefficients that are coupled, and of the coefficient they are coupled to.
+ */
+typedef struct {
+  int el1, n1;
+  int el2, n2;
+  int el, n;
+} so3_descriptor_triple_t;
+
+void so3_descriptor_clebsch_gordan(double *cg, int el1, int el2, int el);
+
+void so3_descriptor_power(
+    double *power, const SO3_COMPLEX(double) * flmn, int batch,
+    const so3_parameters_t *parameters);
+void so3_descriptor_bispectrum(
+    SO3_COMPLEX(double) * bispectrum, const SO3_COMPLEX(double) * flmn, int batch,
+    const so3_descriptor_triple_t *triples, int ntriples,
+    const so3_parameters_t *parameters);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
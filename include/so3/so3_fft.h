@@ -0,0 +1,117 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_FFT
+#define SO3_FFT
+
+#include "so3_types.h"
+#include <complex.h>
+
+/*!
+ * Backend used for new plans unless \link so3_fft_set_backend \endlink is
+ * called. Set with the fft_backend CMake option.
+ */
+#ifndef SO3_FFT_DEFAULT_BACKEND
+#define SO3_FFT_DEFAULT_BACKEND SO3_FFT_BACKEND_FFTW
+#endif
+
+/*! Sign of the exponent of forward and backward transforms, as in FFTW. */
+#define SO3_FFT_FORWARD (-1)
+#define SO3_FFT_BACKWARD (+1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  /*! FFTW3. */
+  SO3_FFT_BACKEND_FFTW,
+  /*! Bundled mixed-radix implementation without a planning stage. */
+  SO3_FFT_BACKEND_BUILTIN,
+  SO3_FFT_BACKEND_SIZE
+} so3_fft_backend_t;
+
+typedef enum {
+  /*! Cheap planning, as FFTW_ESTIMATE. */
+  SO3_FFT_ESTIMATE,
+  /*! Measured planning, as FFTW_MEASURE. May overwrite the arrays. */
+  SO3_FFT_MEASURE
+} so3_fft_flags_t;
+
+typedef enum {
+  SO3_FFT_C2C,
+  /*! Real input, non-redundant half of the last dimension as output. */
+  SO3_FFT_R2C,
+  /*! Inverse of SO3_FFT_R2C, up to normalisation. */
+  SO3_FFT_C2R
+} so3_fft_kind_t;
+
+/*!
+ * Length and input/output strides of one dimension, in elements of the
+ * respective arrays, as fftw_iodim.
+ */
+typedef struct {
+  int n;
+  int is;
+  int os;
+} so3_fft_dim_t;
+
+typedef struct so3_fft_plan so3_fft_plan_t;
+
+/*! Lock or unlock function of \link so3_fft_set_planner_lock \endlink. */
+typedef void (*so3_fft_lock_t)(void *data);
+
+void so3_fft_set_backend(so3_fft_backend_t backend);
+so3_fft_backend_t so3_fft_get_backend(void);
+void so3_fft_set_planner_lock(
+    so3_fft_lock_t lock, so3_fft_lock_t unlock, void *data);
+void so3_fft_get_planner_lock(
+    so3_fft_lock_t *lock, so3_fft_lock_t *unlock, void **data);
+
+so3_fft_plan_t *so3_fft_plan_guru(
+    so3_fft_kind_t kind, int rank, const so3_fft_dim_t *dims, int howmany_rank,
+    const so3_fft_dim_t *howmany_dims, void *in, void *out, int sign,
+    so3_fft_flags_t flags);
+
+so3_fft_plan_t *so3_fft_plan_many_dft(
+    int rank, const int *n, int howmany, SO3_COMPLEX(double) * in,
+    const int *inembed, int istride, int idist, SO3_COMPLEX(double) * out,
+    const int *onembed, int ostride, int odist, int sign, so3_fft_flags_t flags);
+so3_fft_plan_t *so3_fft_plan_many_dft_r2c(
+    int rank, const int *n, int howmany, double *in, const int *inembed,
+    int istride, int idist, SO3_COMPLEX(double) * out, const int *onembed,
+    int ostride, int odist, so3_fft_flags_t flags);
+so3_fft_plan_t *so3_fft_plan_many_dft_c2r(
+    int rank, const int *n, int howmany, SO3_COMPLEX(double) * in,
+    const int *inembed, int istride, int idist, double *out,
+    const int *onembed, int ostride, int odist, so3_fft_flags_t flags);
+so3_fft_plan_t *so3_fft_plan_dft_1d(
+    int n0, SO3_COMPLEX(double) * in, SO3_COMPLEX(double) * out, int sign,
+    so3_fft_flags_t flags);
+so3_fft_plan_t *so3_fft_plan_dft_2d(
+    int n0, int n1, SO3_COMPLEX(double) * in, SO3_COMPLEX(double) * out,
+    int sign, so3_fft_flags_t flags);
+so3_fft_plan_t *so3_fft_plan_dft_3d(
+    int n0, int n1, int n2, SO3_COMPLEX(double) * in,
+    SO3_COMPLEX(double) * out, int sign, so3_fft_flags_t flags);
+so3_fft_plan_t *so3_fft_plan_dft_r2c_2d(
+    int n0, int n1, double *in, SO3_COMPLEX(double) * out,
+    so3_fft_flags_t flags);
+so3_fft_plan_t *so3_fft_plan_dft_c2r_2d(
+    int n0, int n1, SO3_COMPLEX(double) * in, double *out,
+    so3_fft_flags_t flags);
+so3_fft_plan_t *so3_fft_plan_dft_c2r_3d(
+    int n0, int n1, int n2, SO3_COMPLEX(double) * in, double *out,
+    so3_fft_flags_t flags);
+
+void so3_fft_execute(const so3_fft_plan_t *plan);
+void so3_fft_execute_dft(
+    const so3_fft_plan_t *plan, SO3_COMPLEX(double) * in,
+    SO3_COMPLEX(double) * out);
+void so3_fft_destroy_plan(so3_fft_plan_t *plan);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
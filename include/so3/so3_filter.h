@@ -0,0 +1,45 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_FILTER
+#define SO3_FILTER
+
+#include "so3_types.h"
+#include <complex.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Harmonic filter h(el, m, n) = eln(el, n) * elmn(el, m, n). Either factor
+ * may be NULL, in which case it is one.
+ */
+typedef struct {
+  /*!
+   * Filter depending on (el, n), an L x (2*N-1) array indexed as
+   * eln[el*(2*N-1) + N-1 + n], as for \link so3_flmn_scale_by_eln \endlink.
+   */
+  const double *eln;
+  /*! Filter depending on (el, m, n), in the flmn layout of the parameters. */
+  const SO3_COMPLEX(double) * elmn;
+} so3_filter_t;
+
+typedef struct so3_filter_plan so3_filter_plan_t;
+
+so3_filter_plan_t *so3_filter_plan_init(const so3_parameters_t *parameters);
+void so3_filter_plan_free(so3_filter_plan_t *plan);
+int so3_filter_plan_is_fused(const so3_filter_plan_t *plan);
+
+void so3_filter(
+    SO3_COMPLEX(double) * g, const SO3_COMPLEX(double) * f, const so3_filter_t *filter,
+    int batch, so3_filter_plan_t *plan);
+void so3_filter_real(
+    double *g, const double *f, const so3_filter_t *filter, int batch,
+    so3_filter_plan_t *plan);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
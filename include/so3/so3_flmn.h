@@ -0,0 +1,45 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_FLMN
+#define SO3_FLMN
+
+#include "so3_types.h"
+#include <complex.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void so3_flmn_axpy(
+    SO3_COMPLEX(double) * y, SO3_COMPLEX(double) alpha, const SO3_COMPLEX(double) * x,
+    const so3_parameters_t *parameters);
+void so3_flmn_scale(
+    SO3_COMPLEX(double) * x, SO3_COMPLEX(double) alpha,
+    const so3_parameters_t *parameters);
+void so3_flmn_scale_by_el(
+    SO3_COMPLEX(double) * x, const double *weights, const so3_parameters_t *parameters);
+void so3_flmn_scale_by_eln(
+    SO3_COMPLEX(double) * x, const double *weights, const so3_parameters_t *parameters);
+
+SO3_COMPLEX(double)
+so3_flmn_dot(
+    const SO3_COMPLEX(double) * x, const SO3_COMPLEX(double) * y,
+    const so3_parameters_t *parameters);
+SO3_COMPLEX(double)
+so3_flmn_weighted_dot(
+    const SO3_COMPLEX(double) * x, const SO3_COMPLEX(double) * y,
+    const double *weights, const so3_parameters_t *parameters);
+double so3_flmn_norm(const SO3_COMPLEX(double) * x, const so3_parameters_t *parameters);
+void so3_flmn_norm_per_el(
+    double *norms, const SO3_COMPLEX(double) * x, const so3_parameters_t *parameters);
+
+void so3_flmn_change_bandlimit(
+    SO3_COMPLEX(double) * flmn_out, const so3_parameters_t *parameters_out,
+    const SO3_COMPLEX(double) * flmn_in, const so3_parameters_t *parameters_in);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
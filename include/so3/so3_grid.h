@@ -0,0 +1,49 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_GRID
+#define SO3_GRID
+
+#include "so3_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Grid cell enclosing a rotation: the indices of its lower corner and the
+ * fractional position of the rotation within the cell along each angle.
+ */
+typedef struct {
+  /*! Indices of the lower corner. The upper corner is a+1 (mod nalpha), b+1
+   *  and g+1 (mod ngamma). */
+  int a, b, g;
+  /*! Fractional offsets in [0, 1] from the lower corner. */
+  double ta, tb, tg;
+} so3_grid_cell_t;
+
+void so3_grid_coordinates(
+    double *alphas, double *betas, double *gammas, const so3_parameters_t *parameters);
+void so3_grid_quaternions(double *quaternions, const so3_parameters_t *parameters);
+
+void so3_grid_euler_to_quaternion(
+    double *quaternions, const double *alphas, const double *betas,
+    const double *gammas, int count);
+void so3_grid_quaternion_to_euler(
+    double *alphas, double *betas, double *gammas, const double *quaternions,
+    int count);
+void so3_grid_matrix_to_euler(
+    double *alphas, double *betas, double *gammas, const double *matrices, int count);
+
+void so3_grid_nearest(
+    int *indices, const double *alphas, const double *betas, const double *gammas,
+    int count, const so3_parameters_t *parameters);
+void so3_grid_enclosing(
+    so3_grid_cell_t *cells, const double *alphas, const double *betas,
+    const double *gammas, int count, const so3_parameters_t *parameters);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,39 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_INTERP
+#define SO3_INTERP
+
+#include "so3_types.h"
+#include <complex.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! Local interpolation kernel, applied separately in alpha, beta and gamma. */
+typedef enum {
+  /*! Linear, i.e. trilinear, interpolation from 2x2x2 samples. */
+  SO3_INTERP_LINEAR,
+  /*! Cubic convolution (Catmull-Rom) from 4x4x4 samples. */
+  SO3_INTERP_CUBIC
+} so3_interp_method_t;
+
+typedef struct so3_interp_plan so3_interp_plan_t;
+
+so3_interp_plan_t *
+so3_interp_plan_init(const so3_parameters_t *parameters, so3_interp_method_t method);
+void so3_interp_plan_free(so3_interp_plan_t *plan);
+
+void so3_interp(
+    SO3_COMPLEX(double) * values, const SO3_COMPLEX(double) * f, const double *alphas,
+    const double *betas, const double *gammas, int count, so3_interp_plan_t *plan);
+void so3_interp_real(
+    double *values, const double *f, const double *alphas, const double *betas,
+    const double *gammas, int count, so3_interp_plan_t *plan);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,51 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_MPI
+#define SO3_MPI
+
+#include "so3_types.h"
+#include <complex.h>
+#include <mpi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Distribution of a transform over the ranks of a communicator.
+ *
+ * Each rank owns n_count consecutive values n = n_first + k*n_inc of the
+ * n-mode, and the beta rows b_start <= b < b_stop.
+ *
+ * The local harmonic coefficients are stored as one padded block of L*L
+ * values per owned n, i.e. flmn_local[k*L*L + el*el + el + m]. The local
+ * signal holds the owned beta rows of the global signal, for all alpha and
+ * gamma, i.e. f_local[a + nalpha*((b - b_start) + (b_stop - b_start)*g)].
+ */
+typedef struct {
+  MPI_Comm comm;
+  int rank, size;
+  int n_first, n_inc, n_count;
+  int b_start, b_stop;
+} so3_mpi_layout_t;
+
+void so3_mpi_layout_init(
+    so3_mpi_layout_t *layout, MPI_Comm comm, const so3_parameters_t *parameters);
+int so3_mpi_flmn_local_size(
+    const so3_mpi_layout_t *layout, const so3_parameters_t *parameters);
+int so3_mpi_f_local_size(
+    const so3_mpi_layout_t *layout, const so3_parameters_t *parameters);
+
+void so3_mpi_inverse_via_ssht(
+    SO3_COMPLEX(double) * f_local, const SO3_COMPLEX(double) * flmn_local,
+    const so3_mpi_layout_t *layout, const so3_parameters_t *parameters);
+void so3_mpi_forward_via_ssht(
+    SO3_COMPLEX(double) * flmn_local, const SO3_COMPLEX(double) * f_local,
+    const so3_mpi_layout_t *layout, const so3_parameters_t *parameters);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
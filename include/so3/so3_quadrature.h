@@ -0,0 +1,30 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_QUADRATURE
+#define SO3_QUADRATURE
+
+#include "so3_types.h"
+#include <complex.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SO3_COMPLEX(double)
+so3_integrate(const SO3_COMPLEX(double) * f, const so3_parameters_t *parameters);
+double so3_integrate_real(const double *f, const so3_parameters_t *parameters);
+void so3_quadrature_cache_clear(void);
+
+SO3_COMPLEX(double)
+so3_inner_product(
+    const SO3_COMPLEX(double) * f, const SO3_COMPLEX(double) * g,
+    const so3_parameters_t *parameters);
+double so3_inner_product_real(
+    const double *f, const double *g, const so3_parameters_t *parameters);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,36 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_RESAMPLE
+#define SO3_RESAMPLE
+
+#include "so3_types.h"
+#include <complex.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct so3_resample_plan so3_resample_plan_t;
+
+so3_resample_plan_t *so3_resample_plan_init(
+    const so3_parameters_t *parameters_out, const so3_parameters_t *parameters_in);
+void so3_resample_plan_free(so3_resample_plan_t *plan);
+void so3_resample_execute(
+    so3_resample_plan_t *plan, SO3_COMPLEX(double) * f_out,
+    const SO3_COMPLEX(double) * f_in);
+void so3_resample_execute_real(
+    so3_resample_plan_t *plan, double *f_out, const double *f_in);
+
+void so3_resample(
+    SO3_COMPLEX(double) * f_out, const so3_parameters_t *parameters_out,
+    const SO3_COMPLEX(double) * f_in, const so3_parameters_t *parameters_in);
+void so3_resample_real(
+    double *f_out, const so3_parameters_t *parameters_out, const double *f_in,
+    const so3_parameters_t *parameters_in);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
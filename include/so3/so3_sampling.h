@@ -12,6 +12,26 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+
+/*!
+ * Cursor over the coefficients of an flmn array in storage order, see
+ * \link so3_flmn_iter_init \endlink. The position is read from the
+ * public fields after each successful \link so3_flmn_iter_next \endlink.
+ */
+typedef struct {
+  /*! Harmonic index. */
+  int el;
+  /*! Azimuthal harmonic index. */
+  int m;
+  /*! Orientational harmonic index. */
+  int n;
+  /*! 1D index into the flmn array. */
+  int ind;
+
+  // Internal state.
+  int L, M, mmax, size, compact, zero_first;
+} so3_flmn_iter_t;
+
 SO3_COMPLEX(double)
 so3_sampling_weight(const so3_parameters_t *parameters, int p);
 
@@ -20,6 +40,7 @@ int so3_sampling_n(const so3_parameters_t *parameters);
 int so3_sampling_nalpha(const so3_parameters_t *parameters);
 int so3_sampling_nbeta(const so3_parameters_t *parameters);
 int so3_sampling_ngamma(const so3_parameters_t *parameters);
+int so3_sampling_mlim(const so3_parameters_t *parameters);
 
 double so3_sampling_a2alpha(int a, const so3_parameters_t *parameters);
 double so3_sampling_b2beta(int b, const so3_parameters_t *parameters);
@@ -48,6 +69,9 @@ bool so3_sampling_is_elmn_non_zero(
 int so3_sampling_is_elmn_non_zero_return_int(
     const int el, const int m, const int n, const so3_parameters_t *parameters);
 
+void so3_flmn_iter_init(so3_flmn_iter_t *iter, const so3_parameters_t *parameters);
+bool so3_flmn_iter_next(so3_flmn_iter_t *iter);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,29 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_SEARCH
+#define SO3_SEARCH
+
+#include "so3_types.h"
+#include <complex.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! Rotation found by the search, with the real part of the correlation. */
+typedef struct {
+  double alpha, beta, gamma;
+  double score;
+} so3_search_candidate_t;
+
+int so3_search(
+    so3_search_candidate_t *candidates, int ncandidates,
+    const SO3_COMPLEX(double) * flm, const SO3_COMPLEX(double) * glm, int L_coarse,
+    const so3_parameters_t *parameters);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,30 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_SERVER
+#define SO3_SERVER
+
+#include "so3_client.h"
+
+/*!
+ * Largest number of queued requests with identical parameters that a worker
+ * gathers into one batch.
+ */
+#ifndef SO3_SERVER_MAX_BATCH
+#define SO3_SERVER_MAX_BATCH 256
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct so3_server so3_server_t;
+
+so3_server_t *so3_server_start(const char *path, int nworkers);
+void so3_server_stop(so3_server_t *server);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
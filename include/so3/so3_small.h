@@ -0,0 +1,54 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_SMALL
+#define SO3_SMALL
+
+#include "so3_types.h"
+#include <complex.h>
+
+/*!
+ * Largest band-limit for which the batched transforms in so3_core
+ * automatically use the small band-limit engine.
+ */
+#ifndef SO3_SMALL_L_MAX
+#define SO3_SMALL_L_MAX 16
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Precomputed matrices of the small band-limit engine for one parameter set.
+ */
+typedef struct so3_small_plan so3_small_plan_t;
+
+so3_small_plan_t *so3_small_plan_init(const so3_parameters_t *parameters);
+void so3_small_plan_free(so3_small_plan_t *plan);
+
+so3_small_plan_t *so3_small_plan_cached(const so3_parameters_t *parameters);
+so3_small_plan_t *so3_small_plan_get(const so3_parameters_t *parameters);
+void so3_small_plan_cache_clear(void);
+
+void so3_small_inverse(
+    SO3_COMPLEX(double) * f, const SO3_COMPLEX(double) * flmn, int batch,
+    const so3_small_plan_t *plan);
+
+void so3_small_inverse_real(
+    double *f, const SO3_COMPLEX(double) * flmn, int batch,
+    const so3_small_plan_t *plan);
+
+void so3_small_forward(
+    SO3_COMPLEX(double) * flmn, const SO3_COMPLEX(double) * f, int batch,
+    const so3_small_plan_t *plan);
+
+void so3_small_forward_real(
+    SO3_COMPLEX(double) * flmn, const double *f, int batch,
+    const so3_small_plan_t *plan);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,79 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_SOLVER
+#define SO3_SOLVER
+
+#include "so3_types.h"
+#include <complex.h>
+
+/*!
+ * Largest Wigner table in bytes that a solver stores. Above it the table is
+ * recomputed ring by ring in every application of the operators.
+ */
+#ifndef SO3_SOLVER_TABLE_MAX
+#define SO3_SOLVER_TABLE_MAX ((size_t)1 << 30)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  /*! Conjugate gradients on the normal equations. */
+  SO3_SOLVER_CG,
+  /*! LSQR of Paige and Saunders. */
+  SO3_SOLVER_LSQR
+} so3_solver_method_t;
+
+typedef enum {
+  SO3_SOLVER_PRECONDITIONER_NONE,
+  /*! Diagonal of the normal operator. */
+  SO3_SOLVER_PRECONDITIONER_JACOBI
+} so3_solver_preconditioner_t;
+
+/*!
+ * Options of \link so3_solver_solve \endlink. Fields left at zero take their
+ * default values.
+ */
+typedef struct {
+  /*! Iterative method. Default: CG. */
+  so3_solver_method_t method;
+  /*! Maximum number of iterations. Default: 100. */
+  int max_iterations;
+  /*!
+   * Stop once the residual of the normal equations has dropped by this
+   * factor. Default: 1e-10.
+   */
+  double tolerance;
+  /*! Tikhonov damping lambda >= 0 of the coefficients. Default: 0. */
+  double damping;
+  /*! Preconditioner. Default: none. */
+  so3_solver_preconditioner_t preconditioner;
+} so3_solver_options_t;
+
+/*!
+ * Persistent operator pair for least-squares reconstructions: the Wigner
+ * table, FFT plans and scratch of the inverse transform and its adjoint.
+ */
+typedef struct so3_solver so3_solver_t;
+
+so3_solver_t *so3_solver_init(const so3_parameters_t *parameters);
+void so3_solver_free(so3_solver_t *solver);
+void so3_solver_set_weights(so3_solver_t *solver, const double *weights);
+
+void so3_solver_inverse(
+    so3_solver_t *solver, SO3_COMPLEX(double) * f, const SO3_COMPLEX(double) * flmn);
+void so3_solver_adjoint_inverse(
+    so3_solver_t *solver, SO3_COMPLEX(double) * flmn, const SO3_COMPLEX(double) * f);
+void so3_solver_normal(
+    so3_solver_t *solver, SO3_COMPLEX(double) * out, const SO3_COMPLEX(double) * flmn);
+int so3_solver_solve(
+    so3_solver_t *solver, SO3_COMPLEX(double) * flmn, const SO3_COMPLEX(double) * f,
+    const so3_solver_options_t *options, double *residual);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
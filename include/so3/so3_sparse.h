@@ -0,0 +1,52 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_SPARSE
+#define SO3_SPARSE
+
+#include "so3_types.h"
+#include <complex.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! A single harmonic coefficient flmn. */
+typedef struct {
+  int el, m, n;
+  SO3_COMPLEX(double) value;
+} so3_sparse_coefficient_t;
+
+/*! Algorithm of the sparse transforms. */
+typedef enum {
+  /*! Choose by the cost model of \link so3_sparse_method_select \endlink. */
+  SO3_SPARSE_AUTO,
+  /*! Synthesise or project every coefficient with its own Wigner function. */
+  SO3_SPARSE_SYNTHESIS,
+  /*! Go through a full flmn array and the dense transforms. */
+  SO3_SPARSE_DENSE
+} so3_sparse_method_t;
+
+so3_sparse_method_t so3_sparse_method_select(
+    const so3_sparse_coefficient_t *coefficients, int ncoefficients, int forward,
+    const so3_parameters_t *parameters);
+
+void so3_sparse_inverse(
+    SO3_COMPLEX(double) * f, const so3_sparse_coefficient_t *coefficients,
+    int ncoefficients, so3_sparse_method_t method, const so3_parameters_t *parameters);
+void so3_sparse_inverse_real(
+    double *f, const so3_sparse_coefficient_t *coefficients, int ncoefficients,
+    so3_sparse_method_t method, const so3_parameters_t *parameters);
+void so3_sparse_forward(
+    so3_sparse_coefficient_t *coefficients, int ncoefficients,
+    const SO3_COMPLEX(double) * f, so3_sparse_method_t method,
+    const so3_parameters_t *parameters);
+void so3_sparse_forward_real(
+    so3_sparse_coefficient_t *coefficients, int ncoefficients, const double *f,
+    so3_sparse_method_t method, const so3_parameters_t *parameters);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
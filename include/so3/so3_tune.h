@@ -0,0 +1,56 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_TUNE
+#define SO3_TUNE
+
+#include "so3_types.h"
+#include <ssht/ssht.h>
+
+/*!
+ * Environment variable holding the path of the tuning file. If it is not
+ * set, $HOME/.so3_tune is used.
+ */
+#define SO3_TUNE_FILE_ENV "SO3_TUNE_FILE"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  SO3_TUNE_INVERSE,
+  SO3_TUNE_FORWARD,
+  SO3_TUNE_DIRECTION_SIZE
+} so3_tune_direction_t;
+
+typedef enum {
+  /*! so3_core_*_via_ssht */
+  SO3_TUNE_METHOD_VIA_SSHT,
+  /*! so3_core_*_direct */
+  SO3_TUNE_METHOD_DIRECT,
+  SO3_TUNE_METHOD_SIZE
+} so3_tune_method_t;
+
+/*!
+ * Algorithm selected for one parameter set and direction.
+ */
+typedef struct {
+  so3_tune_method_t method;
+  ssht_dl_method_t dl_method;
+  /*! Measured run time in seconds of one transform. */
+  double seconds;
+} so3_tune_choice_t;
+
+so3_tune_choice_t
+so3_tune_select(const so3_parameters_t *parameters, so3_tune_direction_t direction);
+so3_tune_choice_t
+so3_tune_benchmark(const so3_parameters_t *parameters, so3_tune_direction_t direction);
+
+void so3_tune_set_file(const char *path);
+void so3_tune_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -92,14 +92,14 @@ typedef enum {
 typedef enum {
     /*!
      * McEwen and Wiaux sampling:
-     * 2*L-1 samples in alpha, in [0, 2pi).
+     * 2*M-1 samples in alpha, in [0, 2pi).
      * L samples in beta, in (0, pi].
      * 2*N-1 samples in gamma, in [0, 2pi).
      */
     SO3_SAMPLING_MW,
     /*!
      * McEwen and Wiaux symmetric sampling:
-     * 2*L samples in alpha, in [0, 2pi).
+     * 2*M samples in alpha, in [0, 2pi).
      * L+1 samples in beta, in [0, pi].
      * 2*N-1 samples in gamma, in [0, 2pi).
      */
@@ -198,6 +198,22 @@ typedef struct {
      * A non-zero value indicates that the signal is steerable.
      */
     int steerable;
+
+    /*!
+     * Upper azimuthal band-limit. Only flmn with |m| < M will be
+     * stored and considered. Zero (the default) means M = L.
+     * \var int M
+     */
+    int M;
+
+    /*!
+     * Magnitude below which Wigner d-function values at pi/2 are treated
+     * as zero by the direct transforms, which then skip the corresponding
+     * (m, m') and (n, m') terms. Zero (the default) keeps every value and
+     * gives the exact transforms.
+     * \var double dl_tolerance
+     */
+    double dl_tolerance;
 } so3_parameters_t;
 
 #endif
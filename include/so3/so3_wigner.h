@@ -0,0 +1,45 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_WIGNER
+#define SO3_WIGNER
+
+#include "so3_types.h"
+#include <complex.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Recursion in el for the Wigner d-functions d^el_mn(beta) of fixed (m, n) at
+ * a set of angles beta.
+ */
+typedef struct {
+  /*! Orders of the recursion. */
+  int m, n;
+  /*! Current degree, starting at max(|m|, |n|). */
+  int el;
+  /*! Number of angles. */
+  int nbeta;
+  /*! d^el_mn at every angle. */
+  double *d;
+  // Private: cos(beta) and d^(el-1)_mn at every angle.
+  double *cos_beta, *d_prev;
+} so3_wigner_d_recursion_t;
+
+void so3_wigner_d_recursion_init(
+    so3_wigner_d_recursion_t *recursion, int m, int n, const double *beta, int nbeta);
+void so3_wigner_d_recursion_next(so3_wigner_d_recursion_t *recursion);
+void so3_wigner_d_recursion_free(so3_wigner_d_recursion_t *recursion);
+
+int so3_wigner_D_size(int el_max, so3_storage_t storage);
+void so3_wigner_D_batch(
+    SO3_COMPLEX(double) * out, int el_max, const double *alphas, const double *betas,
+    const double *gammas, int count, so3_storage_t storage, so3_n_order_t n_order);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -14,13 +14,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
-#include <complex.h>  // Must be before fftw3.h
-#include <fftw3.h>
+#include <complex.h>
 
 #include <ssht/ssht.h>
 
 #include "so3/so3_types.h"
 #include "so3/so3_error.h"
+#include "so3/so3_fft.h"
 #include "so3/so3_sampling.h"
 
 #define MIN(a,b) ((a < b) ? (a) : (b))
@@ -35,7 +35,7 @@ void so3_adjoint_inverse_direct(
     complex double *flmn, const complex double *f,
     const so3_parameters_t *parameters
 ) {
-    int L0, L, N;
+    int L0, L, N, M;
     so3_sampling_t sampling;
     so3_storage_t storage;
     so3_n_mode_t n_mode;
@@ -45,6 +45,7 @@ void so3_adjoint_inverse_direct(
 
     L0 = parameters->L0;
     L = parameters->L;
+    M = so3_sampling_mlim(parameters);
     N = parameters->N;
     sampling = parameters->sampling_scheme;
     storage = parameters->storage;
@@ -57,7 +58,9 @@ void so3_adjoint_inverse_direct(
     // Print messages depending on verbosity level.
     if (verbosity > 0)
     {
-        printf("%sComputing adjoint inverse transform using MW sampling with\n", SO3_PROMPT);
+        printf("%sComputing adjoint inverse transform using %s sampling with\n"
+                , SO3_PROMPT
+                , sampling == SO3_SAMPLING_MW ? "MW" : "MWSS");
         printf("%sparameters  (L, N, reality) = (%d, %d, FALSE)\n", SO3_PROMPT, L, N);
         if (verbosity > 1)
             printf("%sUsing routine so3_adjoint_inverse_direct with storage method %d...\n"
@@ -65,15 +68,32 @@ void so3_adjoint_inverse_direct(
                     , storage);
     }
 
-    int m_stride = 2*L-1;
-    int m_offset = L-1;
+    int m_stride = 2*M-1;
+    int m_offset = M-1;
     // unused: int n_stride = 2*N-1;
     int n_offset = N-1;
     int mm_stride = 2*L-1;
     int mm_offset = L-1;
-    int a_stride = 2*L-1;
-    int b_stride = L;
-    int bext_stride = 2*L-1;
+    // Sizes of the sampling grid and of its periodic extension in beta.
+    int nalpha, nbeta, nbeta_ext;
+    switch (sampling)
+    {
+    case SO3_SAMPLING_MW:
+        nalpha = 2*M-1;
+        nbeta = L;
+        nbeta_ext = 2*L-1;
+        break;
+    case SO3_SAMPLING_MW_SS:
+        nalpha = 2*M;
+        nbeta = L+1;
+        nbeta_ext = 2*L;
+        break;
+    default:
+        SO3_ERROR_GENERIC("Invalid sampling scheme.");
+    }
+    int a_stride = nalpha;
+    int b_stride = nbeta;
+    int bext_stride = nbeta_ext;
     // unused: int g_stride = 2*N-1;
 
     int n_start, n_stop, n_inc;
@@ -130,18 +150,18 @@ void so3_adjoint_inverse_direct(
         expsmm[mm + mm_offset] = cexp(-I*mm*SSHT_PI/(2.0*L-1.0));
 
     // Compute Fourier transform over alpha and gamma, i.e. compute Fmn(b).
-    complex double *Fmnb = calloc((2*L-1)*(2*L-1)*(2*N-1), sizeof(*Fmnb));
+    complex double *Fmnb = calloc(nbeta_ext*(2*M-1)*(2*N-1), sizeof(*Fmnb));
     SO3_ERROR_MEM_ALLOC_CHECK(Fmnb);
-    complex double *inout = calloc((2*L-1)*(2*N-1), sizeof(*inout));
+    complex double *inout = calloc(nalpha*(2*N-1), sizeof(*inout));
     SO3_ERROR_MEM_ALLOC_CHECK(inout);
-    fftw_plan plan = fftw_plan_dft_2d(
-                        2*N-1, 2*L-1,
+    so3_fft_plan_t *plan = so3_fft_plan_dft_2d(
+                        2*N-1, nalpha,
                         inout, inout, 
-                        FFTW_FORWARD, 
-                        FFTW_ESTIMATE);
+                        SO3_FFT_FORWARD, 
+                        SO3_FFT_ESTIMATE);
 
     int b, g;
-    for (b = 0; b < L; ++b)
+    for (b = 0; b < nbeta; ++b)
     {
         // TODO: This memcpy loop could probably be avoided by using
         // a more elaborate FFTW plan which performs the FFT directly
@@ -153,74 +173,76 @@ void so3_adjoint_inverse_direct(
                     b + b_stride*(
                     g)), 
                 a_stride*sizeof(*f));
-        fftw_execute_dft(plan, inout, inout);
+        so3_fft_execute_dft(plan, inout, inout);
 
         // Apply spatial shift
         for (n = n_start; n <= n_stop; n += n_inc)
         {
             int n_shift = n < 0 ? 2*N-1 : 0;
-            for (m = -L+1; m <= L-1; ++m)
+            for (m = -M+1; m <= M-1; ++m)
             {
-                int m_shift = m < 0 ? 2*L-1 : 0;
+                int m_shift = m < 0 ? nalpha : 0;
                 Fmnb[b + bext_stride*(
                      m + m_offset + m_stride*(
                      n + n_offset))] =
-                    inout[m + m_shift + m_stride*(
+                    inout[m + m_shift + a_stride*(
                           n + n_shift)];
             }
         }
     }
-    fftw_destroy_plan(plan);
+    so3_fft_destroy_plan(plan);
 
     // Extend Fmnb by filling it with zeroes.
     for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
-            for (b = L; b < 2*L-1; ++b)
+        for (m = -M+1; m <= M-1; ++m)
+            for (b = nbeta; b < nbeta_ext; ++b)
                 Fmnb[b + bext_stride*(
                      m + m_offset + m_stride*(
                      n + n_offset))] = 0.0;
 
 
     // Compute Fourier transform over beta, i.e. compute Fmnm'.
-    complex double *Fmnm = calloc((2*L-1)*(2*L-1)*(2*N-1), sizeof(*Fmnm));
+    complex double *Fmnm = calloc((2*M-1)*(2*L-1)*(2*N-1), sizeof(*Fmnm));
     SO3_ERROR_MEM_ALLOC_CHECK(Fmnm);
 
-    plan = fftw_plan_dft_1d(
-            2*L-1,
+    plan = so3_fft_plan_dft_1d(
+            nbeta_ext,
             inout, inout, 
-            FFTW_FORWARD, 
-            FFTW_ESTIMATE);
+            SO3_FFT_FORWARD, 
+            SO3_FFT_ESTIMATE);
     for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
+        for (m = -M+1; m <= M-1; ++m)
         {
             memcpy(inout, 
                    Fmnb + 0 + bext_stride*(
                           m + m_offset + m_stride*(
                           n + n_offset)), 
                    bext_stride*sizeof(*Fmnb));
-            fftw_execute_dft(plan, inout, inout);
+            so3_fft_execute_dft(plan, inout, inout);
 
             // Apply spatial shift
             for (mm = -L+1; mm <= L-1; ++mm)
             {
-                int mm_shift = mm < 0 ? 2*L-1 : 0;
+                int mm_shift = mm < 0 ? nbeta_ext : 0;
                 Fmnm[m + m_offset + m_stride*(
                      mm + mm_offset + mm_stride*(
                      n + n_offset))] =
                     inout[mm + mm_shift];
             }
         }
-    fftw_destroy_plan(plan);
+    so3_fft_destroy_plan(plan);
     free(inout);
 
-    // Apply phase modulation to account for sampling offset.
-    for (n = n_start; n <= n_stop; n += n_inc)
-        for (mm = -L+1; mm <= L-1; ++mm)
-            for (m = -L+1; m <= L-1; ++m)
-                Fmnm[m + m_offset + m_stride*(
-                     mm + mm_offset + mm_stride*(
-                     n + n_offset))] *=
-                    expsmm[mm + mm_offset];
+    // Apply phase modulation to account for sampling offset. MWSS sampling
+    // starts at the north pole, so there is no offset to account for.
+    if (sampling == SO3_SAMPLING_MW)
+        for (n = n_start; n <= n_stop; n += n_inc)
+            for (mm = -L+1; mm <= L-1; ++mm)
+                for (m = -M+1; m <= M-1; ++m)
+                    Fmnm[m + m_offset + m_stride*(
+                         mm + mm_offset + mm_stride*(
+                         n + n_offset))] *=
+                        expsmm[mm + mm_offset];
 
     // Compute flmn.
     double *dl, *dl8 = NULL;
@@ -235,7 +257,7 @@ void so3_adjoint_inverse_direct(
     int dl_stride = ssht_dl_get_stride(L, SSHT_DL_QUARTER);
     for (n = -N+1; n <= N-1; ++n)
         for (el = abs(n); el < L; ++el)
-            for (m = -el; m <= el; ++m)
+            for (m = -MIN(el, M-1); m <= MIN(el, M-1); ++m)
             {
                 int ind;
                 so3_sampling_elmn2ind(&ind, el, m, n, parameters);
@@ -364,7 +386,7 @@ void so3_adjoint_inverse_direct(
                 double elnmm_factor = mmsign * elnsign * elfactor
                                       * dl[abs(n) + dl_offset + abs(mm)*dl_stride];
                 
-                for (m = -el; m <= el; ++m)
+                for (m = -MIN(el, M-1); m <= MIN(el, M-1); ++m)
                 {
                     mmsign = mm >= 0 ? 1.0 : signs[el] * signs[abs(m)];
                     double elmsign = m >= 0 ? 1.0 : elmmsign;
@@ -403,7 +425,7 @@ void so3_adjoint_forward_direct(
     complex double *f, const complex double *flmn,
     const so3_parameters_t *parameters
 ) {    
-    int L0, L, N;
+    int L0, L, N, M;
     so3_sampling_t sampling;
     so3_storage_t storage;
     so3_n_mode_t n_mode;
@@ -413,6 +435,7 @@ void so3_adjoint_forward_direct(
 
     L0 = parameters->L0;
     L = parameters->L;
+    M = so3_sampling_mlim(parameters);
     N = parameters->N;
     sampling = parameters->sampling_scheme;
     storage = parameters->storage;
@@ -425,7 +448,9 @@ void so3_adjoint_forward_direct(
     // Print messages depending on verbosity level.
     if (verbosity > 0)
     {
-        printf("%sComputing forward adjoint transform using MW sampling with\n", SO3_PROMPT);
+        printf("%sComputing forward adjoint transform using %s sampling with\n"
+                , SO3_PROMPT
+                , sampling == SO3_SAMPLING_MW ? "MW" : "MWSS");
         printf("%sparameters  (L, N, reality) = (%d, %d, FALSE)\n", SO3_PROMPT, L, N);
         if (verbosity > 1)
             printf("%sUsing routine so3_adjoint_forward_direct with storage method %d...\n"
@@ -436,15 +461,32 @@ void so3_adjoint_forward_direct(
     // Iterators
     int el, m, n, mm, b, g; // mm for m'
 
-    int m_offset = L-1;
-    int m_stride = 2*L-1;
+    int m_offset = M-1;
+    int m_stride = 2*M-1;
     int n_offset = N-1;
     // unused: int n_stride = 2*N-1;
     int mm_offset = L-1;
     int mm_stride = 2*L-1;
-    int a_stride = 2*L-1;
-    int b_stride = L;
-    int bext_stride = 2*L-1;
+    // Sizes of the sampling grid and of its periodic extension in beta.
+    int nalpha, nbeta, nbeta_ext;
+    switch (sampling)
+    {
+    case SO3_SAMPLING_MW:
+        nalpha = 2*M-1;
+        nbeta = L;
+        nbeta_ext = 2*L-1;
+        break;
+    case SO3_SAMPLING_MW_SS:
+        nalpha = 2*M;
+        nbeta = L+1;
+        nbeta_ext = 2*L;
+        break;
+    default:
+        SO3_ERROR_GENERIC("Invalid sampling scheme.");
+    }
+    int a_stride = nalpha;
+    int b_stride = nbeta;
+    int bext_stride = nbeta_ext;
     // unused: int g_stride = 2*N-1;
 
     complex double* inout; // Used as temporary storage for various FFTs.
@@ -476,7 +518,7 @@ void so3_adjoint_forward_direct(
     // Compute Gmnm'
     // TODO: Currently m is fastest-varying, then n, then m'.
     // Should this order be changed to m-m'-n?
-    complex double *Gmnm = calloc((2*L-1)*(2*L-1)*(2*N-1), sizeof(*Gmnm));
+    complex double *Gmnm = calloc((2*M-1)*(2*L-1)*(2*N-1), sizeof(*Gmnm));
     SO3_ERROR_MEM_ALLOC_CHECK(Gmnm);
 
     int n_start, n_stop, n_inc;
@@ -493,7 +535,7 @@ void so3_adjoint_forward_direct(
     int dl_offset = ssht_dl_get_offset(L, SSHT_DL_QUARTER);
     int dl_stride = ssht_dl_get_stride(L, SSHT_DL_QUARTER);
 
-    complex double *mn_factors = calloc((2*L-1)*(2*N-1), sizeof *mn_factors);
+    complex double *mn_factors = calloc((2*M-1)*(2*N-1), sizeof *mn_factors);
     SO3_ERROR_MEM_ALLOC_CHECK(mn_factors);
 
     // TODO: SSHT starts this loop from MAX(L0, abs(spin)).
@@ -627,7 +669,7 @@ void so3_adjoint_forward_direct(
 
         // Factors which do not depend on m'.
         for (n = n_start; n <= n_stop; n += n_inc)
-            for (m = -el; m <= el; ++m)
+            for (m = -MIN(el, M-1); m <= MIN(el, M-1); ++m)
             {
                 int ind;
                 so3_sampling_elmn2ind(&ind, el, m, n, parameters);
@@ -651,7 +693,7 @@ void so3_adjoint_forward_direct(
                 // Factor which does not depend on m.
                 double elnmm_factor = elnsign
                                       * dl[abs(n) + dl_offset + mm*dl_stride];
-                for (m = -el; m < 0; ++m)
+                for (m = -MIN(el, M-1); m < 0; ++m)
                     Gmnm[mm + mm_offset + mm_stride*(
                          m + m_offset + m_stride*(
                          n + n_offset))] +=
@@ -659,7 +701,7 @@ void so3_adjoint_forward_direct(
                         * mn_factors[m + m_offset + m_stride*(
                                      n + n_offset)]
                         * elmmsign * dl[-m + dl_offset + mm*dl_stride];
-                for (m = 0; m <= el; ++m)
+                for (m = 0; m <= MIN(el, M-1); ++m)
                     Gmnm[mm + mm_offset + mm_stride*(
                          m + m_offset + m_stride*(
                          n + n_offset))] +=
@@ -706,7 +748,7 @@ void so3_adjoint_forward_direct(
 
     // Use symmetry to compute Gmnm' for negative m'.
     for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
+        for (m = -M+1; m <= M-1; ++m)
             for (mm = -L+1; mm < 0; ++mm)
                 Gmnm[mm + mm_offset + mm_stride*(
                      m + m_offset + m_stride*(
@@ -727,19 +769,19 @@ void so3_adjoint_forward_direct(
     // Compute IFFT of w to give wr.
     complex double *wr = calloc(4*L-3, sizeof(*w));
     SO3_ERROR_MEM_ALLOC_CHECK(wr);
-    inout = calloc(4*L-3, sizeof(*inout));
+    inout = calloc(MAX(4*L-3, nbeta_ext), sizeof(*inout));
     SO3_ERROR_MEM_ALLOC_CHECK(inout);
-    fftw_plan plan_bwd = fftw_plan_dft_1d(
+    so3_fft_plan_t *plan_bwd = so3_fft_plan_dft_1d(
                             4*L-3, 
                             inout, inout, 
-                            FFTW_BACKWARD, 
-                            FFTW_MEASURE);
-    fftw_plan plan_fwd = fftw_plan_dft_1d(
+                            SO3_FFT_BACKWARD, 
+                            SO3_FFT_MEASURE);
+    so3_fft_plan_t *plan_fwd = so3_fft_plan_dft_1d(
                             4*L-3, 
                             inout, 
                             inout, 
-                            FFTW_FORWARD, 
-                            FFTW_MEASURE);
+                            SO3_FFT_FORWARD, 
+                            SO3_FFT_MEASURE);
 
     // Apply spatial shift.
     for (mm = 1; mm <= 2*L-2; ++mm)
@@ -747,7 +789,7 @@ void so3_adjoint_forward_direct(
     for (mm = -2*(L-1); mm <= 0; ++mm)
         inout[mm + w_offset] = w[mm + 2*(L-1) + w_offset];
 
-    fftw_execute_dft(plan_bwd, inout, inout);
+    so3_fft_execute_dft(plan_bwd, inout, inout);
 
     // Apply spatial shift.
     for (mm = 0; mm <= 2*L-2; ++mm)
@@ -758,10 +800,10 @@ void so3_adjoint_forward_direct(
     // Compute Fmnm'' by convolution implemented as product in real space.
     complex double *Gmnm_pad = calloc(4*L-3, sizeof(*Gmnm_pad));
     SO3_ERROR_MEM_ALLOC_CHECK(Gmnm_pad);
-    complex double *Fmnm = calloc((2*L-1)*(2*L-1)*(2*N-1), sizeof(*Fmnm));
+    complex double *Fmnm = calloc((2*M-1)*(2*L-1)*(2*N-1), sizeof(*Fmnm));
     SO3_ERROR_MEM_ALLOC_CHECK(Fmnm);
     for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
+        for (m = -M+1; m <= M-1; ++m)
         {
 
             // Zero-pad Gmnm'.
@@ -781,7 +823,7 @@ void so3_adjoint_forward_direct(
             for (mm = -2*(L-1); mm <= 0; ++mm)
                 inout[mm + w_offset] = Gmnm_pad[mm + 2*(L-1) + w_offset];
             // Compute IFFT of Gmnm'.
-            fftw_execute_dft(plan_bwd, inout, inout);
+            so3_fft_execute_dft(plan_bwd, inout, inout);
             // Apply spatial shift.
             for (mm = 0; mm <= 2*L-2; ++mm)
                 Gmnm_pad[mm + w_offset] = inout[mm - 2*(L-1) + w_offset];
@@ -799,7 +841,7 @@ void so3_adjoint_forward_direct(
             for (mm = -2*(L-1); mm <= 0; ++mm)
                 inout[mm + w_offset] = Gmnm_pad[mm + 2*(L-1) + w_offset];
             // Compute Fmnm'' by FFT.
-            fftw_execute_dft(plan_fwd, inout, inout);
+            so3_fft_execute_dft(plan_fwd, inout, inout);
             // Apply spatial shift.
             for (mm = 0; mm <= 2*L-2; ++mm)
                 Gmnm_pad[mm + w_offset] = inout[mm - 2*(L-1) + w_offset];
@@ -815,40 +857,44 @@ void so3_adjoint_forward_direct(
                     * 4.0 * SSHT_PI * SSHT_PI / (4.0*L-3.0);
         
         }
-    fftw_destroy_plan(plan_bwd);
-    fftw_destroy_plan(plan_fwd);
+    so3_fft_destroy_plan(plan_bwd);
+    so3_fft_destroy_plan(plan_fwd);
 
-    // Apply phase modulation to account for sampling offset.
-    for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
-            for (mm = -L+1; mm <= L-1; ++mm)
-                Fmnm[mm + mm_offset + mm_stride*(
-                     m + m_offset + m_stride*(
-                     n + n_offset))] *=
-                    expsmm[mm + mm_offset];
+    // Apply phase modulation to account for sampling offset. MWSS sampling
+    // starts at the north pole, so there is no offset to account for.
+    if (sampling == SO3_SAMPLING_MW)
+        for (n = n_start; n <= n_stop; n += n_inc)
+            for (m = -M+1; m <= M-1; ++m)
+                for (mm = -L+1; mm <= L-1; ++mm)
+                    Fmnm[mm + mm_offset + mm_stride*(
+                         m + m_offset + m_stride*(
+                         n + n_offset))] *=
+                        expsmm[mm + mm_offset];
 
     // Compute Fourier transform over mm, i.e. compute Fmnb.
-    complex double *Fmnb = calloc((2*L-1)*(2*L-1)*(2*N-1), sizeof(*Fmnb));
+    complex double *Fmnb = calloc(nbeta_ext*(2*M-1)*(2*N-1), sizeof(*Fmnb));
     SO3_ERROR_MEM_ALLOC_CHECK(Fmnm);
 
-    fftw_plan plan = fftw_plan_dft_1d(
-        2*L-1,
+    so3_fft_plan_t *plan = so3_fft_plan_dft_1d(
+        nbeta_ext,
         inout, inout, 
-        FFTW_BACKWARD, 
-        FFTW_ESTIMATE);
+        SO3_FFT_BACKWARD, 
+        SO3_FFT_ESTIMATE);
     for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
+        for (m = -M+1; m <= M-1; ++m)
         {
-            // Apply spatial shift and normalisation factor
+            // Apply spatial shift and normalisation factor. The Nyquist
+            // term of MWSS sampling has no counterpart in Fmnm'.
+            inout[L] = 0.0;
             for (mm = -L+1; mm <= L-1; ++mm)
             {
-                int mm_shift = mm < 0 ? 2*L-1 : 0;
+                int mm_shift = mm < 0 ? nbeta_ext : 0;
                 inout[mm + mm_shift] =
                     Fmnm[mm + mm_offset + mm_stride*(
                          m + m_offset + m_stride*(
-                         n + n_offset))] / (2.0*L-1.0);
+                         n + n_offset))] / (double)nbeta_ext;
             }
-            fftw_execute_dft(plan, inout, inout);
+            so3_fft_execute_dft(plan, inout, inout);
             memcpy(Fmnb + 0 + bext_stride*(
                           m + m_offset + m_stride*(
                           n + n_offset)),
@@ -857,56 +903,56 @@ void so3_adjoint_forward_direct(
 
         }
 
-    fftw_destroy_plan(plan);
+    so3_fft_destroy_plan(plan);
     free(inout);
 
 
 
     // Adjoint of periodic extension of Ftm.
     for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
+        for (m = -M+1; m <= M-1; ++m)
         {
             int signmn = signs[abs(m+n)%2];
-            for (b = 0; b <= L-2; ++b)
-                Fmnb[b + bext_stride*(
+            for (b = nbeta; b < nbeta_ext; ++b)
+                Fmnb[(2*(nbeta-1)-b) + bext_stride*(
                      m + m_offset + m_stride*(
                      n + n_offset))] +=
                     signmn
-                    * Fmnb[(2*L-2-b) + bext_stride*(
+                    * Fmnb[b + bext_stride*(
                            m + m_offset + m_stride*(
                            n + n_offset))];
         }
 
     // Compute Fourier transform over alpha and gamma, i.e. compute f.
-    inout = calloc((2*L-1)*(2*N-1), sizeof(*inout));
+    inout = calloc(nalpha*(2*N-1), sizeof(*inout));
     SO3_ERROR_MEM_ALLOC_CHECK(inout);
-    plan = fftw_plan_dft_2d(
-        2*N-1, 2*L-1,
+    plan = so3_fft_plan_dft_2d(
+        2*N-1, nalpha,
         inout, inout, 
-        FFTW_BACKWARD, 
-        FFTW_ESTIMATE);
+        SO3_FFT_BACKWARD, 
+        SO3_FFT_ESTIMATE);
 
-    double norm_factor = 1.0/(2.0*L-1.0)/(2.0*N-1.0);
+    double norm_factor = 1.0/nalpha/(2.0*N-1.0);
 
-    for (b = 0; b < L; ++b)
+    for (b = 0; b < nbeta; ++b)
     {
-        for (int i_count=0; i_count<(2*L-1)*(2*N-1); i_count++) {inout[i_count] = 0.0;}
+        for (int i_count=0; i_count<nalpha*(2*N-1); i_count++) {inout[i_count] = 0.0;}
 
         // Apply spatial shift and normalisation factor
         for (n = n_start; n <= n_stop; n += n_inc)
         {
             int n_shift = n < 0 ? 2*N-1 : 0;
-            for (m = -L+1; m <= L-1; ++m)
+            for (m = -M+1; m <= M-1; ++m)
             {
-                int m_shift = m < 0 ? 2*L-1 : 0;
-                inout[m + m_shift + m_stride*(
+                int m_shift = m < 0 ? nalpha : 0;
+                inout[m + m_shift + a_stride*(
                       n + n_shift)] =
                     Fmnb[b + bext_stride*(
                          m + m_offset + m_stride*(
                          n + n_offset))] * norm_factor;
             }
         }
-        fftw_execute_dft(plan, inout, inout);
+        so3_fft_execute_dft(plan, inout, inout);
 
         // TODO: This memcpy loop could probably be avoided by using
         // a more elaborate FFTW plan which performs the FFT directly
@@ -921,7 +967,7 @@ void so3_adjoint_forward_direct(
 
 
     }
-    fftw_destroy_plan(plan);
+    so3_fft_destroy_plan(plan);
 
     free(Fmnb);
     free(Fmnm);
@@ -940,7 +986,7 @@ void so3_adjoint_inverse_direct_real(
     complex double *flmn, const double *f,
     const so3_parameters_t *parameters
 ) {
-    int L0, L, N;
+    int L0, L, N, M;
     so3_sampling_t sampling;
     so3_storage_t storage;
     so3_n_mode_t n_mode;
@@ -950,6 +996,7 @@ void so3_adjoint_inverse_direct_real(
 
     L0 = parameters->L0;
     L = parameters->L;
+    M = so3_sampling_mlim(parameters);
     N = parameters->N;
     sampling = parameters->sampling_scheme;
     storage = parameters->storage;
@@ -961,7 +1008,9 @@ void so3_adjoint_inverse_direct_real(
 
     // Print messages depending on verbosity level.
     if (verbosity > 0) {
-        printf("%sComputing adjoint inverse transform using MW sampling with\n", SO3_PROMPT);
+        printf("%sComputing adjoint inverse transform using %s sampling with\n"
+                , SO3_PROMPT
+                , sampling == SO3_SAMPLING_MW ? "MW" : "MWSS");
         printf("%sparameters  (L, N, reality) = (%d, %d, FALSE)\n", SO3_PROMPT, L, N);
         if (verbosity > 1)
             printf("%sUsing routine so3_adjoint_inverse_direct_real with storage method %d...\n"
@@ -969,15 +1018,32 @@ void so3_adjoint_inverse_direct_real(
                     , storage);
     }
 
-    int m_stride = 2*L-1;
-    int m_offset = L-1;
+    int m_stride = 2*M-1;
+    int m_offset = M-1;
     int n_offset = 0;
     int n_stride = N;
     int mm_stride = 2*L-1;
     int mm_offset = L-1;
-    int a_stride = 2*L-1;
-    int b_stride = L;
-    int bext_stride = 2*L-1;
+    // Sizes of the sampling grid and of its periodic extension in beta.
+    int nalpha, nbeta, nbeta_ext;
+    switch (sampling)
+    {
+    case SO3_SAMPLING_MW:
+        nalpha = 2*M-1;
+        nbeta = L;
+        nbeta_ext = 2*L-1;
+        break;
+    case SO3_SAMPLING_MW_SS:
+        nalpha = 2*M;
+        nbeta = L+1;
+        nbeta_ext = 2*L;
+        break;
+    default:
+        SO3_ERROR_GENERIC("Invalid sampling scheme.");
+    }
+    int a_stride = nalpha;
+    int b_stride = nbeta;
+    int bext_stride = nbeta_ext;
     int g_stride = 2*N-1;
 
     int n_start, n_stop, n_inc;
@@ -1034,20 +1100,20 @@ void so3_adjoint_inverse_direct_real(
         expsmm[mm + mm_offset] = cexp(-I*mm*SSHT_PI/(2.0*L-1.0));
 
     // Compute Fourier transform over alpha and gamma, i.e. compute Fmn(b).
-    complex double *Fmnb = calloc((2*L-1)*(2*L-1)*N, sizeof(*Fmnb));
+    complex double *Fmnb = calloc(nbeta_ext*(2*M-1)*N, sizeof(*Fmnb));
     SO3_ERROR_MEM_ALLOC_CHECK(Fmnb);
-    double *fft_in = calloc((2*L-1)*(2*N-1), sizeof(*fft_in));
+    double *fft_in = calloc(nalpha*(2*N-1), sizeof(*fft_in));
     SO3_ERROR_MEM_ALLOC_CHECK(fft_in);
-    complex double *fft_out = calloc((2*L-1)*N, sizeof(*fft_out));
+    complex double *fft_out = calloc(nalpha*N, sizeof(*fft_out));
     SO3_ERROR_MEM_ALLOC_CHECK(fft_out);
     // Redundant dimension needs to be last
-    fftw_plan plan = fftw_plan_dft_r2c_2d(
-                        2*L-1, 2*N-1,
+    so3_fft_plan_t *plan = so3_fft_plan_dft_r2c_2d(
+                        nalpha, 2*N-1,
                         fft_in, fft_out,
-                        FFTW_ESTIMATE);
+                        SO3_FFT_ESTIMATE);
 
     int a, b, g;
-    for (b = 0; b < L; ++b)
+    for (b = 0; b < nbeta; ++b)
     {
         // TODO: This loop could probably be avoided by using
         // a more elaborate FFTW plan which performs the FFT directly
@@ -1057,7 +1123,7 @@ void so3_adjoint_inverse_direct_real(
         // new 2D array, to perform a standard 2D FFT there. While
         // we're at it, we also reshape that array such that gamma
         // is the inner dimension, as required by FFTW.
-        for (a = 0; a < 2*L-1; ++a)
+        for (a = 0; a < nalpha; ++a)
             for (g = 0; g < 2*N-1; ++g)
                 fft_in[g + g_stride*(
                        a)] =
@@ -1065,15 +1131,15 @@ void so3_adjoint_inverse_direct_real(
                       b + b_stride*(
                       g))];
 
-        fftw_execute(plan);
+        so3_fft_execute(plan);
 
         // Apply spatial shift, while
         // reshaping the dimensions once more.
         for (n = n_start; n <= n_stop; n += n_inc)
         {
-            for (m = -L+1; m <= L-1; ++m)
+            for (m = -M+1; m <= M-1; ++m)
             {
-                int m_shift = m < 0 ? 2*L-1 : 0;
+                int m_shift = m < 0 ? nalpha : 0;
                 Fmnb[b + bext_stride*(
                      m + m_offset + m_stride*(
                      n + n_offset))] =
@@ -1082,58 +1148,60 @@ void so3_adjoint_inverse_direct_real(
             }
         }
     }
-    fftw_destroy_plan(plan);
+    so3_fft_destroy_plan(plan);
 
     // Extend Fmnb by filling it with zeroes.
     for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
-            for (b = L; b < 2*L-1; ++b)
+        for (m = -M+1; m <= M-1; ++m)
+            for (b = nbeta; b < nbeta_ext; ++b)
                 Fmnb[b + bext_stride*(
                      m + m_offset + m_stride*(
                      n + n_offset))] = 0.0;
 
     // Compute Fourier transform over beta, i.e. compute Fmnm'.
-    complex double *Fmnm = calloc((2*L-1)*(2*L-1)*(2*N-1), sizeof(*Fmnm));
+    complex double *Fmnm = calloc((2*M-1)*(2*L-1)*(2*N-1), sizeof(*Fmnm));
     SO3_ERROR_MEM_ALLOC_CHECK(Fmnm);
-    complex double *inout = calloc(2*L-1, sizeof(*inout));
+    complex double *inout = calloc(nbeta_ext, sizeof(*inout));
     SO3_ERROR_MEM_ALLOC_CHECK(inout);
     
-    plan = fftw_plan_dft_1d(
-            2*L-1,
+    plan = so3_fft_plan_dft_1d(
+            nbeta_ext,
             inout, inout, 
-            FFTW_FORWARD, 
-            FFTW_ESTIMATE);
+            SO3_FFT_FORWARD, 
+            SO3_FFT_ESTIMATE);
     for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
+        for (m = -M+1; m <= M-1; ++m)
         {
             memcpy(inout, 
                    Fmnb + 0 + bext_stride*(
                           m + m_offset + m_stride*(
                           n + n_offset)), 
                    bext_stride*sizeof(*Fmnb));
-            fftw_execute(plan);
+            so3_fft_execute(plan);
 
             // Apply spatial shift
             for (mm = -L+1; mm <= L-1; ++mm)
             {
-                int mm_shift = mm < 0 ? 2*L-1 : 0;
+                int mm_shift = mm < 0 ? nbeta_ext : 0;
                 Fmnm[m + m_offset + m_stride*(
                      mm + mm_offset + mm_stride*(
                      n + n_offset))] =
                     inout[mm + mm_shift];
             }
         }
-    fftw_destroy_plan(plan);
+    so3_fft_destroy_plan(plan);
     free(inout);
 
-    // Apply phase modulation to account for sampling offset.
-    for (n = n_start; n <= n_stop; n += n_inc)
-        for (mm = -L+1; mm <= L-1; ++mm)
-            for (m = -L+1; m <= L-1; ++m)
-                Fmnm[m + m_offset + m_stride*(
-                     mm + mm_offset + mm_stride*(
-                     n + n_offset))] *=
-                    expsmm[mm + mm_offset];
+    // Apply phase modulation to account for sampling offset. MWSS sampling
+    // starts at the north pole, so there is no offset to account for.
+    if (sampling == SO3_SAMPLING_MW)
+        for (n = n_start; n <= n_stop; n += n_inc)
+            for (mm = -L+1; mm <= L-1; ++mm)
+                for (m = -M+1; m <= M-1; ++m)
+                    Fmnm[m + m_offset + m_stride*(
+                         mm + mm_offset + mm_stride*(
+                         n + n_offset))] *=
+                        expsmm[mm + mm_offset];
 
     // Compute flmn.
     double *dl, *dl8 = NULL;
@@ -1148,7 +1216,7 @@ void so3_adjoint_inverse_direct_real(
     int dl_stride = ssht_dl_get_stride(L, SSHT_DL_QUARTER);
     for (n = 0; n <= N-1; ++n)
         for (el = n; el < L; ++el)
-            for (m = -el; m <= el; ++m)
+            for (m = -MIN(el, M-1); m <= MIN(el, M-1); ++m)
             {
                 int ind;
                 so3_sampling_elmn2ind_real(&ind, el, m, n, parameters);
@@ -1275,7 +1343,7 @@ void so3_adjoint_inverse_direct_real(
                 double elnmm_factor = mmsign * elfactor
                                       * dl[n + dl_offset + abs(mm)*dl_stride];
                 
-                for (m = -el; m <= el; ++m)
+                for (m = -MIN(el, M-1); m <= MIN(el, M-1); ++m)
                 {
                     mmsign = mm >= 0 ? 1.0 : signs[el] * signs[abs(m)];
                     double elmsign = m >= 0 ? 1.0 : elmmsign;
@@ -1314,7 +1382,7 @@ void so3_adjoint_forward_direct_real(
     double *f, const complex double *flmn,
     const so3_parameters_t *parameters
 ) {
-    int L0, L, N;
+    int L0, L, N, M;
     so3_sampling_t sampling;
     so3_storage_t storage;
     so3_n_mode_t n_mode;
@@ -1324,6 +1392,7 @@ void so3_adjoint_forward_direct_real(
 
     L0 = parameters->L0;
     L = parameters->L;
+    M = so3_sampling_mlim(parameters);
     N = parameters->N;
     sampling = parameters->sampling_scheme;
     storage = parameters->storage;
@@ -1336,7 +1405,9 @@ void so3_adjoint_forward_direct_real(
     // Print messages depending on verbosity level.
     if (verbosity > 0)
     {
-        printf("%sComputing forward adjoint transform using MW sampling with\n", SO3_PROMPT);
+        printf("%sComputing forward adjoint transform using %s sampling with\n"
+                , SO3_PROMPT
+                , sampling == SO3_SAMPLING_MW ? "MW" : "MWSS");
         printf("%sparameters  (L, N, reality) = (%d, %d, FALSE)\n", SO3_PROMPT, L, N);
         if (verbosity > 1)
             printf("%sUsing routine so3_adjoint_forward_direct with storage method %d...\n"
@@ -1347,15 +1418,32 @@ void so3_adjoint_forward_direct_real(
     // Iterators
     int el, m, n, mm, a, b, g; // mm for m'
 
-    int m_stride = 2*L-1;
-    int m_offset = L-1;
+    int m_stride = 2*M-1;
+    int m_offset = M-1;
     int n_offset = 0;
     int n_stride = N;
     int mm_stride = 2*L-1;
     int mm_offset = L-1;
-    int a_stride = 2*L-1;
-    int b_stride = L;
-    int bext_stride = 2*L-1;
+    // Sizes of the sampling grid and of its periodic extension in beta.
+    int nalpha, nbeta, nbeta_ext;
+    switch (sampling)
+    {
+    case SO3_SAMPLING_MW:
+        nalpha = 2*M-1;
+        nbeta = L;
+        nbeta_ext = 2*L-1;
+        break;
+    case SO3_SAMPLING_MW_SS:
+        nalpha = 2*M;
+        nbeta = L+1;
+        nbeta_ext = 2*L;
+        break;
+    default:
+        SO3_ERROR_GENERIC("Invalid sampling scheme.");
+    }
+    int a_stride = nalpha;
+    int b_stride = nbeta;
+    int bext_stride = nbeta_ext;
     int g_stride = 2*N-1;
 
     complex double* inout; // Used as temporary storage for various FFTs.
@@ -1387,7 +1475,7 @@ void so3_adjoint_forward_direct_real(
     // Compute Gmnm'
     // TODO: Currently m is fastest-varying, then n, then m'.
     // Should this order be changed to m-m'-n?
-    complex double *Gmnm = calloc((2*L-1)*(2*L-1)*N, sizeof(*Gmnm));
+    complex double *Gmnm = calloc((2*M-1)*(2*L-1)*N, sizeof(*Gmnm));
     SO3_ERROR_MEM_ALLOC_CHECK(Gmnm);
 
     int n_start, n_stop, n_inc;
@@ -1404,7 +1492,7 @@ void so3_adjoint_forward_direct_real(
     int dl_offset = ssht_dl_get_offset(L, SSHT_DL_QUARTER);
     int dl_stride = ssht_dl_get_stride(L, SSHT_DL_QUARTER);
 
-    complex double *mn_factors = calloc((2*L-1)*(2*N-1), sizeof *mn_factors);
+    complex double *mn_factors = calloc((2*M-1)*(2*N-1), sizeof *mn_factors);
     SO3_ERROR_MEM_ALLOC_CHECK(mn_factors);
 
     // TODO: SSHT starts this loop from MAX(L0, abs(spin)).
@@ -1536,7 +1624,7 @@ void so3_adjoint_forward_direct_real(
 
         // Factors which do not depend on m'.
         for (n = n_start; n <= n_stop; n += n_inc)
-            for (m = -el; m <= el; ++m)
+            for (m = -MIN(el, M-1); m <= MIN(el, M-1); ++m)
             {
                 int ind;
                 so3_sampling_elmn2ind_real(&ind, el, m, n, parameters);
@@ -1556,7 +1644,7 @@ void so3_adjoint_forward_direct_real(
             {
                 // Factor which does not depend on m.
                 double elnmm_factor = dl[n + dl_offset + mm*dl_stride];
-                for (m = -el; m < 0; ++m)
+                for (m = -MIN(el, M-1); m < 0; ++m)
                     Gmnm[mm + mm_offset + mm_stride*(
                          m + m_offset + m_stride*(
                          n + n_offset))] +=
@@ -1564,7 +1652,7 @@ void so3_adjoint_forward_direct_real(
                         * mn_factors[m + m_offset + m_stride*(
                                      n + n_offset)]
                         * elmmsign * dl[-m + dl_offset + mm*dl_stride];
-                for (m = 0; m <= el; ++m)
+                for (m = 0; m <= MIN(el, M-1); ++m)
                     Gmnm[mm + mm_offset + mm_stride*(
                          m + m_offset + m_stride*(
                          n + n_offset))] +=
@@ -1611,7 +1699,7 @@ void so3_adjoint_forward_direct_real(
 
     // Use symmetry to compute Gmnm' for negative m'.
     for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
+        for (m = -M+1; m <= M-1; ++m)
             for (mm = -L+1; mm < 0; ++mm)
                 Gmnm[mm + mm_offset + mm_stride*(
                      m + m_offset + m_stride*(
@@ -1632,19 +1720,19 @@ void so3_adjoint_forward_direct_real(
     // Compute IFFT of w to give wr.
     complex double *wr = calloc(4*L-3, sizeof(*w));
     SO3_ERROR_MEM_ALLOC_CHECK(wr);
-    inout = calloc(4*L-3, sizeof(*inout));
+    inout = calloc(MAX(4*L-3, nbeta_ext), sizeof(*inout));
     SO3_ERROR_MEM_ALLOC_CHECK(inout);
-    fftw_plan plan_bwd = fftw_plan_dft_1d(
+    so3_fft_plan_t *plan_bwd = so3_fft_plan_dft_1d(
                             4*L-3, 
                             inout, inout, 
-                            FFTW_BACKWARD, 
-                            FFTW_MEASURE);
-    fftw_plan plan_fwd = fftw_plan_dft_1d(
+                            SO3_FFT_BACKWARD, 
+                            SO3_FFT_MEASURE);
+    so3_fft_plan_t *plan_fwd = so3_fft_plan_dft_1d(
                             4*L-3, 
                             inout, 
                             inout, 
-                            FFTW_FORWARD, 
-                            FFTW_MEASURE);
+                            SO3_FFT_FORWARD, 
+                            SO3_FFT_MEASURE);
 
     // Apply spatial shift.
     for (mm = 1; mm <= 2*L-2; ++mm)
@@ -1652,7 +1740,7 @@ void so3_adjoint_forward_direct_real(
     for (mm = -2*(L-1); mm <= 0; ++mm)
         inout[mm + w_offset] = w[mm + 2*(L-1) + w_offset];
 
-    fftw_execute_dft(plan_bwd, inout, inout);
+    so3_fft_execute_dft(plan_bwd, inout, inout);
 
     // Apply spatial shift.
     for (mm = 0; mm <= 2*L-2; ++mm)
@@ -1663,10 +1751,10 @@ void so3_adjoint_forward_direct_real(
     // Compute Fmnm'' by convolution implemented as product in real space.
     complex double *Gmnm_pad = calloc(4*L-3, sizeof(*Gmnm_pad));
     SO3_ERROR_MEM_ALLOC_CHECK(Gmnm_pad);
-    complex double *Fmnm = calloc((2*L-1)*(2*L-1)*N, sizeof(*Fmnm));
+    complex double *Fmnm = calloc((2*M-1)*(2*L-1)*N, sizeof(*Fmnm));
     SO3_ERROR_MEM_ALLOC_CHECK(Fmnm);
     for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
+        for (m = -M+1; m <= M-1; ++m)
         {
 
             // Zero-pad Gmnm'.
@@ -1686,7 +1774,7 @@ void so3_adjoint_forward_direct_real(
             for (mm = -2*(L-1); mm <= 0; ++mm)
                 inout[mm + w_offset] = Gmnm_pad[mm + 2*(L-1) + w_offset];
             // Compute IFFT of Gmnm'.
-            fftw_execute_dft(plan_bwd, inout, inout);
+            so3_fft_execute_dft(plan_bwd, inout, inout);
             // Apply spatial shift.
             for (mm = 0; mm <= 2*L-2; ++mm)
                 Gmnm_pad[mm + w_offset] = inout[mm - 2*(L-1) + w_offset];
@@ -1704,7 +1792,7 @@ void so3_adjoint_forward_direct_real(
             for (mm = -2*(L-1); mm <= 0; ++mm)
                 inout[mm + w_offset] = Gmnm_pad[mm + 2*(L-1) + w_offset];
             // Compute Fmnm'' by FFT.
-            fftw_execute_dft(plan_fwd, inout, inout);
+            so3_fft_execute_dft(plan_fwd, inout, inout);
             // Apply spatial shift.
             for (mm = 0; mm <= 2*L-2; ++mm)
                 Gmnm_pad[mm + w_offset] = inout[mm - 2*(L-1) + w_offset];
@@ -1720,40 +1808,44 @@ void so3_adjoint_forward_direct_real(
                     * 4.0 * SSHT_PI * SSHT_PI / (4.0*L-3.0);
         
         }
-    fftw_destroy_plan(plan_bwd);
-    fftw_destroy_plan(plan_fwd);
+    so3_fft_destroy_plan(plan_bwd);
+    so3_fft_destroy_plan(plan_fwd);
 
-    // Apply phase modulation to account for sampling offset.
-    for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
-            for (mm = -L+1; mm <= L-1; ++mm)
-                Fmnm[mm + mm_offset + mm_stride*(
-                     m + m_offset + m_stride*(
-                     n + n_offset))] *=
-                    expsmm[mm + mm_offset];
+    // Apply phase modulation to account for sampling offset. MWSS sampling
+    // starts at the north pole, so there is no offset to account for.
+    if (sampling == SO3_SAMPLING_MW)
+        for (n = n_start; n <= n_stop; n += n_inc)
+            for (m = -M+1; m <= M-1; ++m)
+                for (mm = -L+1; mm <= L-1; ++mm)
+                    Fmnm[mm + mm_offset + mm_stride*(
+                         m + m_offset + m_stride*(
+                         n + n_offset))] *=
+                        expsmm[mm + mm_offset];
 
     // Compute Fourier transform over mm, i.e. compute Fmnb.
-    complex double *Fmnb = calloc((2*L-1)*(2*L-1)*N, sizeof(*Fmnb));
+    complex double *Fmnb = calloc(nbeta_ext*(2*M-1)*N, sizeof(*Fmnb));
     SO3_ERROR_MEM_ALLOC_CHECK(Fmnm);
 
-    fftw_plan plan = fftw_plan_dft_1d(
-        2*L-1,
+    so3_fft_plan_t *plan = so3_fft_plan_dft_1d(
+        nbeta_ext,
         inout, inout, 
-        FFTW_BACKWARD, 
-        FFTW_ESTIMATE);
+        SO3_FFT_BACKWARD, 
+        SO3_FFT_ESTIMATE);
     for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
+        for (m = -M+1; m <= M-1; ++m)
         {
-            // Apply spatial shift and normalisation factor
+            // Apply spatial shift and normalisation factor. The Nyquist
+            // term of MWSS sampling has no counterpart in Fmnm'.
+            inout[L] = 0.0;
             for (mm = -L+1; mm <= L-1; ++mm)
             {
-                int mm_shift = mm < 0 ? 2*L-1 : 0;
+                int mm_shift = mm < 0 ? nbeta_ext : 0;
                 inout[mm + mm_shift] =
                     Fmnm[mm + mm_offset + mm_stride*(
                          m + m_offset + m_stride*(
-                         n + n_offset))] / (2.0*L-1.0);
+                         n + n_offset))] / (double)nbeta_ext;
             }
-            fftw_execute_dft(plan, inout, inout);
+            so3_fft_execute_dft(plan, inout, inout);
             memcpy(Fmnb + 0 + bext_stride*(
                           m + m_offset + m_stride*(
                           n + n_offset)),
@@ -1762,47 +1854,50 @@ void so3_adjoint_forward_direct_real(
 
         }
 
-    fftw_destroy_plan(plan);
+    so3_fft_destroy_plan(plan);
     free(inout);
 
 
 
     // Adjoint of periodic extension of Ftm.
     for (n = n_start; n <= n_stop; n += n_inc)
-        for (m = -L+1; m <= L-1; ++m)
+        for (m = -M+1; m <= M-1; ++m)
         {
             int signmn = signs[abs(m+n)%2];
-            for (b = 0; b <= L-2; ++b)
-                Fmnb[b + bext_stride*(
+            for (b = nbeta; b < nbeta_ext; ++b)
+                Fmnb[(2*(nbeta-1)-b) + bext_stride*(
                      m + m_offset + m_stride*(
                      n + n_offset))] +=
                     signmn
-                    * Fmnb[(2*L-2-b) + bext_stride*(
+                    * Fmnb[b + bext_stride*(
                            m + m_offset + m_stride*(
                            n + n_offset))];
         }
 
     // Compute Fourier transform over alpha and gamma, i.e. compute f.
-    complex double *fft_in = calloc((2*L-1)*N, sizeof(*fft_in));
+    complex double *fft_in = calloc(nalpha*N, sizeof(*fft_in));
     SO3_ERROR_MEM_ALLOC_CHECK(fft_in);
-    double *fft_out = calloc((2*L-1)*(2*N-1), sizeof(*fft_out));
+    double *fft_out = calloc(nalpha*(2*N-1), sizeof(*fft_out));
     SO3_ERROR_MEM_ALLOC_CHECK(fft_out);
     // Redundant dimension needs to be last
-    plan = fftw_plan_dft_c2r_2d(
-        2*L-1, 2*N-1,
+    plan = so3_fft_plan_dft_c2r_2d(
+        nalpha, 2*N-1,
         fft_in, fft_out,
-        FFTW_ESTIMATE);
+        SO3_FFT_ESTIMATE);
 
-    double norm_factor = 1.0/(2.0*L-1.0)/(2.0*N-1.0);
+    double norm_factor = 1.0/nalpha/(2.0*N-1.0);
 
-    for (b = 0; b < L; ++b)
+    for (b = 0; b < nbeta; ++b)
     {
+        // The c2r transform overwrites its input, so clear it each time.
+        for (int i_count=0; i_count<nalpha*N; i_count++) {fft_in[i_count] = 0.0;}
+
         // Apply spatial shift and normalisation factor
         for (n = n_start; n <= n_stop; n += n_inc)
         {
-            for (m = -L+1; m <= L-1; ++m)
+            for (m = -M+1; m <= M-1; ++m)
             {
-                int m_shift = m < 0 ? 2*L-1 : 0;
+                int m_shift = m < 0 ? nalpha : 0;
                 fft_in[n + n_stride*(
                        m + m_shift)] =
                     Fmnb[b + bext_stride*(
@@ -1811,12 +1906,12 @@ void so3_adjoint_forward_direct_real(
             }
         }
 
-        fftw_execute(plan);
+        so3_fft_execute(plan);
 
         // TODO: This loop could probably be avoided by using
         // a more elaborate FFTW plan which performs the FFT directly
         // over the 1st and 3rd dimensions of f.
-        for (a = 0; a < 2*L-1; ++a)
+        for (a = 0; a < nalpha; ++a)
             for (g = 0; g < 2*N-1; ++g)
                 f[a + a_stride*(
                   b + b_stride*(
@@ -1824,7 +1919,7 @@ void so3_adjoint_forward_direct_real(
                                  a)];
 
     }
-    fftw_destroy_plan(plan);
+    so3_fft_destroy_plan(plan);
 
     free(Fmnb);
     free(Fmnm);
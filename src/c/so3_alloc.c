@@ -0,0 +1,155 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_alloc.c
+ * Placement of the large intermediate buffers of the transforms.
+ *
+ * The intermediate arrays of the transforms (fn, Fmnm, fext, Fmnb, Gmnm)
+ * grow as O(L^2 N) and dominate the memory traffic for large band-limits.
+ * Once a large buffer has been freed, glibc raises its mmap threshold and
+ * serves later callocs of that size from the heap, zeroing them with memset
+ * in the allocating thread, and the pages stay on the node where the heap
+ * was first touched. Large buffers are therefore mapped directly: their
+ * pages stay untouched until the transform writes them, so that on NUMA
+ * machines they land on the node of the thread doing the work, and they are
+ * aligned to and advised for transparent huge pages to reduce TLB misses in
+ * the strided FFT and recursion passes. Binding the pages to the node of
+ * the allocating thread instead is a separate policy, \link
+ * SO3_ALLOC_POLICY_BIND \endlink, for callers that allocate and compute on
+ * the same thread.
+ *
+ * The buffers are not pre-faulted by a parallel first-touch loop. Each
+ * transform in so3_core fills and reads its buffers on the calling thread,
+ * with no OpenMP region splitting them into slabs, so the thread that first
+ * writes a page is already the one that uses it; touching slabs from an
+ * OpenMP team would instead spread the pages over nodes the transform never
+ * runs on.
+ *
+ * Every buffer is preceded by a small header recording how it was
+ * obtained, so that all of them are released with \link so3_alloc_free
+ * \endlink.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define SO3_ALLOC_MMAP
+#endif
+
+#ifdef SO3_NUMA
+#include <numa.h>
+#endif
+
+#include "so3/so3_alloc.h"
+
+// Size of the header in front of every buffer, which keeps the buffers
+// aligned to a cache line.
+#define SO3_ALLOC_HEADER 64
+// Alignment of mapped buffers, the size of a transparent huge page on x86-64
+// and aarch64 with 4 KiB base pages.
+#define SO3_ALLOC_HUGE_PAGE (2 << 20)
+
+typedef struct {
+  void *base;
+  size_t length;
+  int mapped;
+} so3_alloc_header_t;
+
+static so3_alloc_policy_t so3_alloc_policy = SO3_ALLOC_POLICY_LOCAL;
+
+/*!
+ * Select how large buffers are allocated. The policy is global and should be
+ * set before any transform is running.
+ *
+ * \param[in] policy Allocation policy.
+ * \retval none
+ */
+void so3_alloc_set_policy(so3_alloc_policy_t policy) { so3_alloc_policy = policy; }
+
+/*!
+ * Get the allocation policy.
+ *
+ * \retval policy Current allocation policy.
+ */
+so3_alloc_policy_t so3_alloc_get_policy(void) { return so3_alloc_policy; }
+
+/*!
+ * Allocate a zero-initialised buffer for one of the large arrays of a
+ * transform, with the semantics of calloc.
+ *
+ * \param[in] count Number of elements.
+ * \param[in] size Size of each element in bytes.
+ * \retval ptr Buffer aligned to at least 64 bytes, or NULL on failure.
+ *             Free it with \link so3_alloc_free \endlink.
+ */
+void *so3_alloc_large(size_t count, size_t size) {
+  so3_alloc_header_t header;
+  char *ptr;
+
+  if (size && count > (SIZE_MAX - SO3_ALLOC_HEADER - SO3_ALLOC_HUGE_PAGE) / size)
+    return NULL;
+  size_t bytes = count * size;
+
+#ifdef SO3_ALLOC_MMAP
+  if (so3_alloc_policy != SO3_ALLOC_POLICY_CALLOC && bytes >= SO3_ALLOC_LARGE_MIN) {
+    // Anonymous mappings are zero-filled on first touch.
+    header.length = bytes + SO3_ALLOC_HEADER + SO3_ALLOC_HUGE_PAGE;
+    header.base = mmap(
+        NULL,
+        header.length,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0);
+    if (header.base != MAP_FAILED) {
+      header.mapped = 1;
+      uintptr_t start = (uintptr_t)header.base + SO3_ALLOC_HEADER;
+      ptr = (char *)((start + SO3_ALLOC_HUGE_PAGE - 1) &
+                     ~(uintptr_t)(SO3_ALLOC_HUGE_PAGE - 1));
+#ifdef MADV_HUGEPAGE
+      madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+#ifdef SO3_NUMA
+      if (so3_alloc_policy == SO3_ALLOC_POLICY_BIND && numa_available() >= 0)
+        numa_setlocal_memory(ptr, bytes);
+#endif
+      *(so3_alloc_header_t *)(ptr - SO3_ALLOC_HEADER) = header;
+      return ptr;
+    }
+  }
+#endif
+
+  header.length = bytes + 2 * SO3_ALLOC_HEADER;
+  header.base = calloc(1, header.length);
+  if (!header.base)
+    return NULL;
+  header.mapped = 0;
+  uintptr_t start = (uintptr_t)header.base + SO3_ALLOC_HEADER;
+  ptr = (char *)((start + SO3_ALLOC_HEADER - 1) & ~(uintptr_t)(SO3_ALLOC_HEADER - 1));
+  *(so3_alloc_header_t *)(ptr - SO3_ALLOC_HEADER) = header;
+  return ptr;
+}
+
+/*!
+ * Free a buffer allocated with \link so3_alloc_large \endlink.
+ *
+ * \param[in] ptr Buffer, may be NULL.
+ * \retval none
+ */
+void so3_alloc_free(void *ptr) {
+  if (!ptr)
+    return;
+  so3_alloc_header_t header =
+      *(so3_alloc_header_t *)((char *)ptr - SO3_ALLOC_HEADER);
+#ifdef SO3_ALLOC_MMAP
+  if (header.mapped) {
+    munmap(header.base, header.length);
+    return;
+  }
+#endif
+  free(header.base);
+}
@@ -0,0 +1,657 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_async.c
+ * Asynchronous submission of transforms to a pool of worker threads.
+ *
+ * Every submission queues a job and returns a handle at once. Worker threads
+ * take the oldest job together with every other queued job of the same
+ * operation and parameters, and run them as one batch, as the transform
+ * server does (see so3_server.c):
+ *
+ * - Transforms with L <= SO3_SMALL_L_MAX use the small band-limit engine.
+ *   Its plans are cached for the lifetime of the pool, and the signals of
+ *   all gathered jobs are transformed by one set of matrix products.
+ * - Larger transforms use the algorithm chosen by \link so3_tune_select
+ *   \endlink, once per batch. Each transform of the batch is independent, so
+ *   a worker takes only its share of the identical queued jobs, and leaves
+ *   the others to idle workers.
+ *
+ * FFTW planning is not thread-safe. Unless the library is built against
+ * fftw3_threads (SO3_ASYNC_FFTW_THREADS), the pools install one planner lock
+ * in so3_fft (see \link so3_fft_set_planner_lock \endlink) while any of them
+ * is running, so that the direct transforms run concurrently and only their
+ * planning is serialised. The last pool to stop restores the lock that was
+ * installed before the first one started.
+ * The transforms via SSHT plan inside SSHT, and tuning benchmarks them, so
+ * both hold the planner lock throughout.
+ *
+ * Buffers are not copied: the input must stay unchanged and the output must
+ * stay allocated until the job has completed.
+ *
+ * A job is owned jointly by the caller and the pool, and is freed once the
+ * caller has released it and the pool has completed it, in either order. A
+ * caller which only relies on the callback may release the handle right
+ * after submission, or from the callback itself.
+ */
+
+// For PTHREAD_MUTEX_RECURSIVE.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <complex.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef SO3_ASYNC_FFTW_THREADS
+#include <fftw3.h>
+#endif
+
+#include "so3/so3_async.h"
+#include "so3/so3_conv.h"
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_fft.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_small.h"
+#include "so3/so3_tune.h"
+#include "so3/so3_types.h"
+
+typedef enum {
+  SO3_ASYNC_INVERSE,
+  SO3_ASYNC_INVERSE_REAL,
+  SO3_ASYNC_FORWARD,
+  SO3_ASYNC_FORWARD_REAL,
+  SO3_ASYNC_CONVOLVE
+} so3_async_op_t;
+
+struct so3_async_job {
+  so3_async_op_t op;
+  // Parameters of the transform, or of flmn and glmn for a convolution.
+  so3_parameters_t parameters, g_parameters;
+  void *out;
+  const void *in, *g_in;
+  so3_async_callback_t callback;
+  void *user_data;
+
+  // Protects done and refs, which count the caller and the pool.
+  pthread_mutex_t lock;
+  pthread_cond_t finished;
+  int done, refs;
+  struct so3_async_job *next;
+};
+
+// Small band-limit plans are not modified by the transforms, so workers
+// share them.
+typedef struct {
+  so3_parameters_t parameters;
+  so3_small_plan_t *plan;
+} so3_async_plan_t;
+
+struct so3_async {
+  int planner_thread_safe;
+  int stopping;
+  pthread_t *workers;
+  int nworkers;
+
+  // Protects the queue and the stopping flag.
+  pthread_mutex_t lock;
+  pthread_cond_t queued;
+  so3_async_job_t *head, *tail;
+
+  pthread_mutex_t tune_lock, plans_lock;
+  so3_async_plan_t **plans;
+  int nplans;
+};
+
+static int
+so3_async_same_parameters(const so3_parameters_t *a, const so3_parameters_t *b) {
+  return a->reality == b->reality && a->L0 == b->L0 && a->L == b->L && a->N == b->N &&
+         so3_sampling_mlim(a) == so3_sampling_mlim(b) &&
+         a->sampling_scheme == b->sampling_scheme && a->n_order == b->n_order &&
+         a->storage == b->storage && a->n_mode == b->n_mode &&
+         a->dl_method == b->dl_method && a->steerable == b->steerable &&
+         a->dl_tolerance == b->dl_tolerance;
+}
+
+static int so3_async_same_job(const so3_async_job_t *a, const so3_async_job_t *b) {
+  return a->op == b->op && so3_async_same_parameters(&a->parameters, &b->parameters) &&
+         (a->op != SO3_ASYNC_CONVOLVE ||
+          so3_async_same_parameters(&a->g_parameters, &b->g_parameters));
+}
+
+// Planner lock shared by all pools. It is recursive, as the transforms via
+// SSHT hold it while so3_fft takes it again.
+static pthread_mutex_t so3_async_planner;
+
+#ifndef SO3_ASYNC_FFTW_THREADS
+// Protects the count of running pools and the planner lock they replaced.
+static pthread_mutex_t so3_async_pools_lock = PTHREAD_MUTEX_INITIALIZER;
+static int so3_async_npools = 0;
+static so3_fft_lock_t so3_async_saved_lock, so3_async_saved_unlock;
+static void *so3_async_saved_data;
+
+static void so3_async_planner_lock(void *data) {
+  (void)data;
+  pthread_mutex_lock(&so3_async_planner);
+}
+
+static void so3_async_planner_unlock(void *data) {
+  (void)data;
+  pthread_mutex_unlock(&so3_async_planner);
+}
+
+// Install the planner lock when the first pool starts.
+static void so3_async_planner_install(void) {
+  pthread_mutex_lock(&so3_async_pools_lock);
+  if (so3_async_npools++ == 0) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&so3_async_planner, &attr);
+    pthread_mutexattr_destroy(&attr);
+    so3_fft_get_planner_lock(
+        &so3_async_saved_lock, &so3_async_saved_unlock, &so3_async_saved_data);
+    so3_fft_set_planner_lock(so3_async_planner_lock, so3_async_planner_unlock, NULL);
+  }
+  pthread_mutex_unlock(&so3_async_pools_lock);
+}
+
+// Restore the previous planner lock when the last pool stops.
+static void so3_async_planner_restore(void) {
+  pthread_mutex_lock(&so3_async_pools_lock);
+  if (--so3_async_npools == 0) {
+    so3_fft_set_planner_lock(
+        so3_async_saved_lock, so3_async_saved_unlock, so3_async_saved_data);
+    pthread_mutex_destroy(&so3_async_planner);
+  }
+  pthread_mutex_unlock(&so3_async_pools_lock);
+}
+#endif
+
+static void so3_async_engine_lock(so3_async_t *pool) {
+  if (!pool->planner_thread_safe)
+    pthread_mutex_lock(&so3_async_planner);
+}
+
+static void so3_async_engine_unlock(so3_async_t *pool) {
+  if (!pool->planner_thread_safe)
+    pthread_mutex_unlock(&so3_async_planner);
+}
+
+// Whether jobs with these parameters use the small band-limit engine.
+static int so3_async_is_small(const so3_async_job_t *job) {
+  return job->op != SO3_ASYNC_CONVOLVE && !job->parameters.steerable &&
+         job->parameters.L <= SO3_SMALL_L_MAX;
+}
+
+// Drop one reference to the job, and free it with the last one.
+static void so3_async_unref(so3_async_job_t *job) {
+  int refs;
+
+  pthread_mutex_lock(&job->lock);
+  refs = --job->refs;
+  pthread_mutex_unlock(&job->lock);
+  if (refs == 0) {
+    pthread_mutex_destroy(&job->lock);
+    pthread_cond_destroy(&job->finished);
+    free(job);
+  }
+}
+
+// Cached small band-limit plan, built on first use.
+static so3_async_plan_t *
+so3_async_small_plan(so3_async_t *pool, const so3_parameters_t *parameters) {
+  so3_async_plan_t *plan = NULL;
+  int i;
+
+  pthread_mutex_lock(&pool->plans_lock);
+  for (i = 0; i < pool->nplans && !plan; ++i)
+    if (so3_async_same_parameters(&pool->plans[i]->parameters, parameters))
+      plan = pool->plans[i];
+  if (!plan) {
+    plan = malloc(sizeof *plan);
+    SO3_ERROR_MEM_ALLOC_CHECK(plan);
+    plan->parameters = *parameters;
+    plan->plan = so3_small_plan_init(parameters);
+    pool->plans = realloc(pool->plans, (pool->nplans + 1) * sizeof *pool->plans);
+    SO3_ERROR_MEM_ALLOC_CHECK(pool->plans);
+    pool->plans[pool->nplans] = plan;
+    ++pool->nplans;
+  }
+  pthread_mutex_unlock(&pool->plans_lock);
+  return plan;
+}
+
+// Run the gathered jobs, which all have the same operation and parameters,
+// with the small band-limit engine.
+static void so3_async_run_small(
+    so3_async_t *pool, so3_async_job_t **jobs, int njobs,
+    const so3_parameters_t *parameters) {
+  const so3_async_op_t op = jobs[0]->op;
+  const size_t flmn_size = so3_sampling_flmn_size(parameters) * sizeof(complex double);
+  const size_t f_size = so3_sampling_f_size(parameters) *
+                        (parameters->reality ? sizeof(double) : sizeof(complex double));
+  const int inverse = op == SO3_ASYNC_INVERSE || op == SO3_ASYNC_INVERSE_REAL;
+  const size_t in_size = inverse ? flmn_size : f_size;
+  const size_t out_size = inverse ? f_size : flmn_size;
+  so3_async_plan_t *plan = so3_async_small_plan(pool, parameters);
+  char *in, *out;
+  int j;
+
+  if (njobs == 1) {
+    in = (char *)jobs[0]->in;
+    out = jobs[0]->out;
+  } else {
+    in = malloc(in_size * njobs);
+    out = malloc(out_size * njobs);
+    SO3_ERROR_MEM_ALLOC_CHECK(in);
+    SO3_ERROR_MEM_ALLOC_CHECK(out);
+    for (j = 0; j < njobs; ++j)
+      memcpy(in + in_size * j, jobs[j]->in, in_size);
+  }
+
+  switch (op) {
+  case SO3_ASYNC_INVERSE:
+    so3_small_inverse((complex double *)out, (complex double *)in, njobs, plan->plan);
+    break;
+  case SO3_ASYNC_INVERSE_REAL:
+    so3_small_inverse_real((double *)out, (complex double *)in, njobs, plan->plan);
+    break;
+  case SO3_ASYNC_FORWARD:
+    so3_small_forward((complex double *)out, (complex double *)in, njobs, plan->plan);
+    break;
+  case SO3_ASYNC_FORWARD_REAL:
+    so3_small_forward_real((complex double *)out, (double *)in, njobs, plan->plan);
+    break;
+  default:
+    break;
+  }
+
+  if (njobs > 1) {
+    for (j = 0; j < njobs; ++j)
+      memcpy(jobs[j]->out, out + out_size * j, out_size);
+    free(in);
+    free(out);
+  }
+}
+
+// Run the gathered jobs with the tuned algorithm. The direct transforms only
+// lock their FFT planning, in so3_fft.
+static void so3_async_run_tuned(
+    so3_async_t *pool, so3_async_job_t **jobs, int njobs,
+    so3_parameters_t *parameters, so3_tune_choice_t choice) {
+  const int via_ssht = choice.method == SO3_TUNE_METHOD_VIA_SSHT;
+  int j;
+  parameters->dl_method = choice.dl_method;
+
+  if (via_ssht)
+    so3_async_engine_lock(pool);
+  for (j = 0; j < njobs; ++j) {
+    so3_async_job_t *job = jobs[j];
+    switch (job->op) {
+    case SO3_ASYNC_INVERSE:
+      if (via_ssht)
+        so3_core_inverse_via_ssht(job->out, job->in, parameters);
+      else
+        so3_core_inverse_direct(job->out, job->in, parameters);
+      break;
+    case SO3_ASYNC_INVERSE_REAL:
+      if (via_ssht)
+        so3_core_inverse_via_ssht_real(job->out, job->in, parameters);
+      else
+        so3_core_inverse_direct_real(job->out, job->in, parameters);
+      break;
+    case SO3_ASYNC_FORWARD:
+      if (via_ssht)
+        so3_core_forward_via_ssht(job->out, job->in, parameters);
+      else
+        so3_core_forward_direct(job->out, job->in, parameters);
+      break;
+    case SO3_ASYNC_FORWARD_REAL:
+      if (via_ssht)
+        so3_core_forward_via_ssht_real(job->out, job->in, parameters);
+      else
+        so3_core_forward_direct_real(job->out, job->in, parameters);
+      break;
+    default:
+      break;
+    }
+  }
+  if (via_ssht)
+    so3_async_engine_unlock(pool);
+}
+
+static void so3_async_run(so3_async_t *pool, so3_async_job_t **jobs, int njobs) {
+  const so3_async_op_t op = jobs[0]->op;
+  so3_parameters_t parameters = jobs[0]->parameters;
+  int j;
+
+  if (op == SO3_ASYNC_CONVOLVE) {
+    so3_parameters_t h_parameters = so3_conv_get_parameters_of_convolved_lmn(
+        &jobs[0]->parameters, &jobs[0]->g_parameters);
+    for (j = 0; j < njobs; ++j)
+      so3_conv_harmonic_convolution(
+          jobs[j]->out, &h_parameters, jobs[j]->in, &jobs[j]->parameters,
+          jobs[j]->g_in, &jobs[j]->g_parameters);
+    return;
+  }
+
+  if (so3_async_is_small(jobs[0])) {
+    so3_async_run_small(pool, jobs, njobs, &parameters);
+    return;
+  }
+
+  // Tuning benchmarks the candidates the first time, which plans FFTs.
+  pthread_mutex_lock(&pool->tune_lock);
+  so3_async_engine_lock(pool);
+  so3_tune_choice_t choice = so3_tune_select(
+      &parameters, op == SO3_ASYNC_INVERSE || op == SO3_ASYNC_INVERSE_REAL
+                       ? SO3_TUNE_INVERSE
+                       : SO3_TUNE_FORWARD);
+  so3_async_engine_unlock(pool);
+  pthread_mutex_unlock(&pool->tune_lock);
+
+  so3_async_run_tuned(pool, jobs, njobs, &parameters, choice);
+}
+
+static void *so3_async_worker(void *arg) {
+  so3_async_t *pool = arg;
+  so3_async_job_t *jobs[SO3_ASYNC_MAX_BATCH];
+  so3_async_job_t **link;
+  int njobs, max_jobs, j;
+
+  pthread_mutex_lock(&pool->lock);
+  for (;;) {
+    while (!pool->head && !pool->stopping)
+      pthread_cond_wait(&pool->queued, &pool->lock);
+    if (!pool->head)
+      break;
+
+    // Gather the oldest job and the queued jobs identical to it: all of them
+    // for one product of the small band-limit engine, otherwise a share per
+    // worker.
+    jobs[0] = pool->head;
+    pool->head = jobs[0]->next;
+    njobs = 1;
+    max_jobs = SO3_ASYNC_MAX_BATCH;
+    if (!so3_async_is_small(jobs[0])) {
+      for (link = &pool->head; *link; link = &(*link)->next)
+        njobs += so3_async_same_job(*link, jobs[0]);
+      if ((njobs + pool->nworkers - 1) / pool->nworkers < max_jobs)
+        max_jobs = (njobs + pool->nworkers - 1) / pool->nworkers;
+      njobs = 1;
+    }
+    for (link = &pool->head; *link && njobs < max_jobs;) {
+      if (so3_async_same_job(*link, jobs[0])) {
+        jobs[njobs++] = *link;
+        *link = (*link)->next;
+      } else {
+        link = &(*link)->next;
+      }
+    }
+    for (pool->tail = NULL, link = &pool->head; *link; link = &(*link)->next)
+      pool->tail = *link;
+    pthread_mutex_unlock(&pool->lock);
+
+    so3_async_run(pool, jobs, njobs);
+
+    for (j = 0; j < njobs; ++j) {
+      if (jobs[j]->callback)
+        jobs[j]->callback(jobs[j], jobs[j]->user_data);
+      pthread_mutex_lock(&jobs[j]->lock);
+      jobs[j]->done = 1;
+      pthread_cond_broadcast(&jobs[j]->finished);
+      pthread_mutex_unlock(&jobs[j]->lock);
+      so3_async_unref(jobs[j]);
+    }
+    pthread_mutex_lock(&pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+static so3_async_job_t *so3_async_job_new(
+    so3_async_op_t op, void *out, const void *in, const so3_parameters_t *parameters,
+    so3_async_callback_t callback, void *user_data) {
+  so3_async_job_t *job = calloc(1, sizeof *job);
+  SO3_ERROR_MEM_ALLOC_CHECK(job);
+
+  job->op = op;
+  job->parameters = *parameters;
+  job->parameters.verbosity = 0;
+  if (op != SO3_ASYNC_CONVOLVE)
+    job->parameters.reality =
+        op == SO3_ASYNC_INVERSE_REAL || op == SO3_ASYNC_FORWARD_REAL;
+  job->out = out;
+  job->in = in;
+  job->callback = callback;
+  job->user_data = user_data;
+  job->refs = 2;
+  pthread_mutex_init(&job->lock, NULL);
+  pthread_cond_init(&job->finished, NULL);
+  return job;
+}
+
+static so3_async_job_t *so3_async_enqueue(so3_async_t *pool, so3_async_job_t *job) {
+  pthread_mutex_lock(&pool->lock);
+  if (pool->stopping)
+    SO3_ERROR_GENERIC("Job submitted to a stopped so3 worker pool");
+  if (pool->tail)
+    pool->tail->next = job;
+  else
+    pool->head = job;
+  pool->tail = job;
+  pthread_cond_signal(&pool->queued);
+  pthread_mutex_unlock(&pool->lock);
+  return job;
+}
+
+/*!
+ * Start a pool of worker threads for asynchronous transforms.
+ *
+ * \param[in] nworkers Number of worker threads, at least 1.
+ * \retval pool Running pool. Stop it with \link so3_async_stop \endlink.
+ */
+so3_async_t *so3_async_start(int nworkers) {
+  int i;
+
+  so3_async_t *pool = calloc(1, sizeof *pool);
+  SO3_ERROR_MEM_ALLOC_CHECK(pool);
+
+#ifdef SO3_ASYNC_FFTW_THREADS
+  fftw_make_planner_thread_safe();
+  pool->planner_thread_safe = 1;
+#else
+  so3_async_planner_install();
+#endif
+
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->queued, NULL);
+  pthread_mutex_init(&pool->tune_lock, NULL);
+  pthread_mutex_init(&pool->plans_lock, NULL);
+
+  pool->nworkers = nworkers > 0 ? nworkers : 1;
+  pool->workers = malloc(pool->nworkers * sizeof *pool->workers);
+  SO3_ERROR_MEM_ALLOC_CHECK(pool->workers);
+  for (i = 0; i < pool->nworkers; ++i)
+    if (pthread_create(&pool->workers[i], NULL, so3_async_worker, pool) != 0)
+      SO3_ERROR_GENERIC("Failed to start so3 worker");
+  return pool;
+}
+
+/*!
+ * Stop a pool started with \link so3_async_start \endlink.
+ *
+ * Waits for all submitted jobs to complete. Handles which have not been
+ * released stay valid and must still be released.
+ *
+ * \param[in] pool Pool.
+ * \retval none
+ */
+void so3_async_stop(so3_async_t *pool) {
+  int i;
+
+  pthread_mutex_lock(&pool->lock);
+  pool->stopping = 1;
+  pthread_cond_broadcast(&pool->queued);
+  pthread_mutex_unlock(&pool->lock);
+  for (i = 0; i < pool->nworkers; ++i)
+    pthread_join(pool->workers[i], NULL);
+#ifndef SO3_ASYNC_FFTW_THREADS
+  so3_async_planner_restore();
+#endif
+
+  for (i = 0; i < pool->nplans; ++i) {
+    so3_small_plan_free(pool->plans[i]->plan);
+    free(pool->plans[i]);
+  }
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->queued);
+  pthread_mutex_destroy(&pool->tune_lock);
+  pthread_mutex_destroy(&pool->plans_lock);
+  free(pool->plans);
+  free(pool->workers);
+  free(pool);
+}
+
+/*!
+ * Submit an inverse transform (see \link so3_core_inverse_direct \endlink).
+ *
+ * \param[in] pool Pool.
+ * \param[out] f Signal on the sampling grid, written before completion.
+ * \param[in] flmn Harmonic coefficients.
+ * \param[in] parameters A fully populated parameters object, copied.
+ * \param[in] callback Function called on completion, or NULL.
+ * \param[in] user_data Second argument of the callback.
+ * \retval job Handle to poll, wait for and release.
+ */
+so3_async_job_t *so3_submit_inverse(
+    so3_async_t *pool, complex double *f, const complex double *flmn,
+    const so3_parameters_t *parameters, so3_async_callback_t callback,
+    void *user_data) {
+  return so3_async_enqueue(
+      pool,
+      so3_async_job_new(SO3_ASYNC_INVERSE, f, flmn, parameters, callback, user_data));
+}
+
+/*!
+ * Submit an inverse transform of a real signal (see \link
+ * so3_core_inverse_direct_real \endlink). Arguments as for \link
+ * so3_submit_inverse \endlink.
+ */
+so3_async_job_t *so3_submit_inverse_real(
+    so3_async_t *pool, double *f, const complex double *flmn,
+    const so3_parameters_t *parameters, so3_async_callback_t callback,
+    void *user_data) {
+  return so3_async_enqueue(
+      pool, so3_async_job_new(
+                SO3_ASYNC_INVERSE_REAL, f, flmn, parameters, callback, user_data));
+}
+
+/*!
+ * Submit a forward transform (see \link so3_core_forward_direct \endlink).
+ *
+ * \param[in] pool Pool.
+ * \param[out] flmn Harmonic coefficients, written before completion.
+ * \param[in] f Signal on the sampling grid.
+ * \param[in] parameters A fully populated parameters object, copied.
+ * \param[in] callback Function called on completion, or NULL.
+ * \param[in] user_data Second argument of the callback.
+ * \retval job Handle to poll, wait for and release.
+ */
+so3_async_job_t *so3_submit_forward(
+    so3_async_t *pool, complex double *flmn, const complex double *f,
+    const so3_parameters_t *parameters, so3_async_callback_t callback,
+    void *user_data) {
+  return so3_async_enqueue(
+      pool,
+      so3_async_job_new(SO3_ASYNC_FORWARD, flmn, f, parameters, callback, user_data));
+}
+
+/*!
+ * Submit a forward transform of a real signal (see \link
+ * so3_core_forward_direct_real \endlink). Arguments as for \link
+ * so3_submit_forward \endlink.
+ */
+so3_async_job_t *so3_submit_forward_real(
+    so3_async_t *pool, complex double *flmn, const double *f,
+    const so3_parameters_t *parameters, so3_async_callback_t callback,
+    void *user_data) {
+  return so3_async_enqueue(
+      pool, so3_async_job_new(
+                SO3_ASYNC_FORWARD_REAL, flmn, f, parameters, callback, user_data));
+}
+
+/*!
+ * Submit a harmonic convolution (see \link so3_conv_harmonic_convolution
+ * \endlink).
+ *
+ * \param[in] pool Pool.
+ * \param[out] hlmn Coefficients of the convolution, with the parameters
+ *                  returned by \link so3_conv_get_parameters_of_convolved_lmn
+ *                  \endlink.
+ * \param[in] flmn Coefficients of the first signal.
+ * \param[in] f_parameters Parameters of flmn, copied.
+ * \param[in] glmn Coefficients of the second signal.
+ * \param[in] g_parameters Parameters of glmn, copied.
+ * \param[in] callback Function called on completion, or NULL.
+ * \param[in] user_data Second argument of the callback.
+ * \retval job Handle to poll, wait for and release.
+ */
+so3_async_job_t *so3_submit_convolve(
+    so3_async_t *pool, complex double *hlmn, const complex double *flmn,
+    const so3_parameters_t *f_parameters, const complex double *glmn,
+    const so3_parameters_t *g_parameters, so3_async_callback_t callback,
+    void *user_data) {
+  so3_async_job_t *job = so3_async_job_new(
+          SO3_ASYNC_CONVOLVE, hlmn, flmn, f_parameters, callback, user_data);
+  job->g_parameters = *g_parameters;
+  job->g_parameters.verbosity = 0;
+  job->g_in = glmn;
+  return so3_async_enqueue(pool, job);
+}
+
+/*!
+ * Check whether a job has completed, without blocking.
+ *
+ * \param[in] job Handle returned by a submission.
+ * \retval done 1 once the output has been written and the callback has
+ *              returned, 0 otherwise.
+ */
+int so3_async_poll(so3_async_job_t *job) {
+  int done;
+
+  pthread_mutex_lock(&job->lock);
+  done = job->done;
+  pthread_mutex_unlock(&job->lock);
+  return done;
+}
+
+/*!
+ * Block until a job has completed, including its callback. Must not be
+ * called from the callback of the same job.
+ *
+ * \param[in] job Handle returned by a submission.
+ * \retval none
+ */
+void so3_async_wait(so3_async_job_t *job) {
+  pthread_mutex_lock(&job->lock);
+  while (!job->done)
+    pthread_cond_wait(&job->finished, &job->lock);
+  pthread_mutex_unlock(&job->lock);
+}
+
+/*!
+ * Release a handle. The job still runs to completion if it has not
+ * completed yet, but the handle must not be used any more. May be called
+ * from the job's callback.
+ *
+ * \param[in] job Handle returned by a submission.
+ * \retval none
+ */
+void so3_async_release(so3_async_job_t *job) { so3_async_unref(job); }
@@ -0,0 +1,517 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_client.c
+ * Client of the so3d transform server.
+ *
+ * A client holds one connection to so3d. Every request is sent as a
+ * so3_server_request_t together with the file descriptor of a shared-memory
+ * buffer (a memfd on Linux, an unlinked POSIX shared-memory object
+ * elsewhere), in which the server reads the input and writes the output
+ * in place. Requests on one connection are synchronous; concurrent callers
+ * should each open their own connection.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <complex.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "so3/so3_client.h"
+#include "so3/so3_conv.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+
+// Report a closed peer as an error rather than raising SIGPIPE.
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+struct so3_client {
+  int fd;
+  // Reused by the copying convenience functions.
+  so3_shm_t *scratch;
+};
+
+/*!
+ * Get the path of the so3d socket, see \link SO3_SERVER_SOCKET_ENV \endlink.
+ *
+ * \param[out] path Buffer receiving the path.
+ * \param[in] size Size of the buffer.
+ * \retval none
+ */
+void so3_server_default_path(char *path, size_t size) {
+  const char *env = getenv(SO3_SERVER_SOCKET_ENV);
+  const char *runtime = getenv("XDG_RUNTIME_DIR");
+  if (env && *env)
+    snprintf(path, size, "%s", env);
+  else if (runtime && *runtime)
+    snprintf(path, size, "%s/so3d.sock", runtime);
+  else
+    snprintf(path, size, "/tmp/so3d-%ld.sock", (long)getuid());
+}
+
+// Parameters of one input or output signal of the request.
+static so3_parameters_t
+so3_server_signal_parameters(const so3_server_request_t *request, int output) {
+  so3_parameters_t parameters = request->parameters;
+  switch (request->op) {
+  case SO3_SERVER_INVERSE:
+  case SO3_SERVER_FORWARD:
+    parameters.reality = 0;
+    break;
+  case SO3_SERVER_INVERSE_REAL:
+  case SO3_SERVER_FORWARD_REAL:
+    parameters.reality = 1;
+    break;
+  case SO3_SERVER_HARMONIC_CONVOLUTION:
+    if (output)
+      parameters = so3_conv_get_parameters_of_convolved_lmn(
+          &request->parameters, &request->g_parameters);
+    break;
+  }
+  return parameters;
+}
+
+static size_t so3_server_flmn_bytes(const so3_parameters_t *parameters) {
+  return (size_t)so3_sampling_flmn_size(parameters) * sizeof(complex double);
+}
+
+static size_t so3_server_f_bytes(const so3_parameters_t *parameters) {
+  return (size_t)so3_sampling_f_size(parameters) *
+         (parameters->reality ? sizeof(double) : sizeof(complex double));
+}
+
+// Whether the transforms accept the parameters of one signal, and its
+// sizes fit the int returned by so3_sampling.
+static int so3_server_valid_parameters(const so3_parameters_t *parameters) {
+  const int L = parameters->L, N = parameters->N;
+  if (L < 1 || parameters->L0 < 0 || parameters->L0 >= L || N < 1 || N > L ||
+      parameters->M < 0 || parameters->M > L ||
+      (unsigned)parameters->sampling_scheme >= SO3_SAMPLING_SIZE ||
+      (unsigned)parameters->n_order >= SO3_N_ORDER_SIZE ||
+      (unsigned)parameters->storage >= SO3_STORAGE_SIZE ||
+      (unsigned)parameters->n_mode >= SO3_N_MODE_SIZE ||
+      (parameters->dl_method != SSHT_DL_RISBO &&
+       parameters->dl_method != SSHT_DL_TRAPANI))
+    return 0;
+  // MW_SS has the most samples, 2L in alpha and L+1 in beta.
+  return (2 * (size_t)N - 1) * (L + 1) * 2 * L <= INT_MAX;
+}
+
+// Whether the operation, batch and parameters of a request are valid, before
+// its sizes are checked.
+static int so3_server_valid_request(const so3_server_request_t *request) {
+  const so3_parameters_t *parameters = &request->parameters;
+  const so3_parameters_t *g_parameters = &request->g_parameters;
+
+  if (request->op >= SO3_SERVER_OP_SIZE || request->batch < 1 ||
+      !so3_server_valid_parameters(parameters))
+    return 0;
+  if (request->op != SO3_SERVER_HARMONIC_CONVOLUTION)
+    return !parameters->steerable || so3_sampling_mlim(parameters) == parameters->L;
+  return so3_server_valid_parameters(g_parameters) &&
+         g_parameters->sampling_scheme == parameters->sampling_scheme &&
+         g_parameters->n_order == parameters->n_order &&
+         g_parameters->storage == parameters->storage &&
+         g_parameters->n_mode == parameters->n_mode &&
+         g_parameters->reality == parameters->reality;
+}
+
+/*!
+ * Check that a request can be run by the server.
+ *
+ * All enums and band-limits are checked, so that a valid request never
+ * reaches an error of the transforms, which would stop the server.
+ * Steerable signals with M < L are rejected, as no algorithm supports them,
+ * and the two signals of a convolution must share their sampling, n-order,
+ * storage, n-mode and reality. The input and output of the whole batch must
+ * fit a size_t.
+ *
+ * \param[in] request Request with at least op, parameters, g_parameters and
+ *                    batch set.
+ * \retval status \link SO3_SERVER_OK \endlink if the request is valid,
+ *                \link SO3_SERVER_EINVAL \endlink otherwise.
+ */
+so3_server_status_t so3_server_check_request(const so3_server_request_t *request) {
+  return so3_server_in_size(request) && so3_server_out_size(request)
+             ? SO3_SERVER_OK
+             : SO3_SERVER_EINVAL;
+}
+
+/*!
+ * Size in bytes of the input of a request, or 0 if the request is invalid.
+ *
+ * \param[in] request Request with at least op, parameters, g_parameters and
+ *                    batch set.
+ * \retval size Size of the input of all signals of the batch.
+ */
+size_t so3_server_in_size(const so3_server_request_t *request) {
+  if (!so3_server_valid_request(request))
+    return 0;
+  so3_parameters_t parameters = so3_server_signal_parameters(request, 0);
+  size_t size = 0;
+  switch (request->op) {
+  case SO3_SERVER_INVERSE:
+  case SO3_SERVER_INVERSE_REAL:
+    size = so3_server_flmn_bytes(&parameters);
+    break;
+  case SO3_SERVER_FORWARD:
+  case SO3_SERVER_FORWARD_REAL:
+    size = so3_server_f_bytes(&parameters);
+    break;
+  case SO3_SERVER_HARMONIC_CONVOLUTION:
+    size = so3_server_flmn_bytes(&parameters) +
+           so3_server_flmn_bytes(&request->g_parameters);
+    break;
+  }
+  return size > SIZE_MAX / request->batch ? 0 : size * request->batch;
+}
+
+/*!
+ * Size in bytes of the output of a request, or 0 if the request is invalid.
+ *
+ * \param[in] request Request with at least op, parameters, g_parameters and
+ *                    batch set.
+ * \retval size Size of the output of all signals of the batch.
+ */
+size_t so3_server_out_size(const so3_server_request_t *request) {
+  if (!so3_server_valid_request(request))
+    return 0;
+  so3_parameters_t parameters = so3_server_signal_parameters(request, 1);
+  size_t size = 0;
+  switch (request->op) {
+  case SO3_SERVER_INVERSE:
+  case SO3_SERVER_INVERSE_REAL:
+    size = so3_server_f_bytes(&parameters);
+    break;
+  case SO3_SERVER_FORWARD:
+  case SO3_SERVER_FORWARD_REAL:
+  case SO3_SERVER_HARMONIC_CONVOLUTION:
+    size = so3_server_flmn_bytes(&parameters);
+    break;
+  }
+  return size > SIZE_MAX / request->batch ? 0 : size * request->batch;
+}
+
+/*!
+ * Allocate a buffer in shared memory.
+ *
+ * \param[in] size Size in bytes.
+ * \retval shm Buffer, or NULL if the shared memory could not be created.
+ *             Free it with \link so3_shm_free \endlink.
+ */
+so3_shm_t *so3_shm_alloc(size_t size) {
+  so3_shm_t *shm = calloc(1, sizeof *shm);
+  SO3_ERROR_MEM_ALLOC_CHECK(shm);
+#ifdef __linux__
+  shm->fd = memfd_create("so3", MFD_CLOEXEC);
+#else
+  char name[64];
+  snprintf(name, sizeof name, "/so3-%ld-%p", (long)getpid(), (void *)shm);
+  shm->fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (shm->fd >= 0)
+    shm_unlink(name);
+#endif
+  if (shm->fd < 0) {
+    free(shm);
+    return NULL;
+  }
+  shm->size = size > 0 ? size : 1;
+  if (ftruncate(shm->fd, shm->size) != 0) {
+    close(shm->fd);
+    free(shm);
+    return NULL;
+  }
+  shm->data = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, shm->fd, 0);
+  if (shm->data == MAP_FAILED) {
+    close(shm->fd);
+    free(shm);
+    return NULL;
+  }
+  return shm;
+}
+
+/*!
+ * Free a buffer allocated with \link so3_shm_alloc \endlink.
+ *
+ * \param[in] shm Buffer, may be NULL.
+ * \retval none
+ */
+void so3_shm_free(so3_shm_t *shm) {
+  if (!shm)
+    return;
+  munmap(shm->data, shm->size);
+  close(shm->fd);
+  free(shm);
+}
+
+/*!
+ * Connect to so3d.
+ *
+ * \param[in] path Path of the server socket, or NULL for
+ *                 \link so3_server_default_path \endlink.
+ * \retval client Connection, or NULL if the server is not running.
+ *                Close it with \link so3_client_close \endlink.
+ */
+so3_client_t *so3_client_connect(const char *path) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof address);
+  address.sun_family = AF_UNIX;
+  if (path)
+    snprintf(address.sun_path, sizeof address.sun_path, "%s", path);
+  else
+    so3_server_default_path(address.sun_path, sizeof address.sun_path);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return NULL;
+  if (connect(fd, (struct sockaddr *)&address, sizeof address) != 0) {
+    close(fd);
+    return NULL;
+  }
+
+  so3_client_t *client = calloc(1, sizeof *client);
+  SO3_ERROR_MEM_ALLOC_CHECK(client);
+  client->fd = fd;
+  return client;
+}
+
+/*!
+ * Close a connection opened with \link so3_client_connect \endlink.
+ *
+ * \param[in] client Connection, may be NULL.
+ * \retval none
+ */
+void so3_client_close(so3_client_t *client) {
+  if (!client)
+    return;
+  close(client->fd);
+  so3_shm_free(client->scratch);
+  free(client);
+}
+
+/*!
+ * Submit a request and wait for its completion.
+ *
+ * The input must be stored at shm->data + request->in_offset and the output
+ * is written at shm->data + request->out_offset. The magic and shm_size
+ * fields of the request are filled in.
+ *
+ * \param[in] client Connection.
+ * \param[in] request Request.
+ * \param[in] shm Shared-memory buffer holding the input and the output.
+ * \retval status \link SO3_SERVER_OK \endlink on success.
+ */
+so3_server_status_t so3_client_submit(
+    so3_client_t *client, const so3_server_request_t *request, const so3_shm_t *shm) {
+  so3_server_request_t message = *request;
+  so3_server_response_t response;
+  char control[CMSG_SPACE(sizeof(int))];
+  struct iovec iov;
+  struct msghdr msg;
+  struct cmsghdr *cmsg;
+  size_t done;
+  ssize_t count;
+
+  message.magic = SO3_SERVER_MAGIC;
+  message.shm_size = shm->size;
+
+  // The file descriptor travels with the first byte of the request.
+  memset(&msg, 0, sizeof msg);
+  memset(control, 0, sizeof control);
+  iov.iov_base = &message;
+  iov.iov_len = sizeof message;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof control;
+  cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &shm->fd, sizeof(int));
+
+  do
+    count = sendmsg(client->fd, &msg, MSG_NOSIGNAL);
+  while (count < 0 && errno == EINTR);
+  if (count <= 0)
+    return SO3_SERVER_EIO;
+  for (done = count; done < sizeof message; done += count) {
+    count = send(
+        client->fd, (char *)&message + done, sizeof message - done, MSG_NOSIGNAL);
+    if (count < 0 && errno == EINTR)
+      count = 0;
+    else if (count <= 0)
+      return SO3_SERVER_EIO;
+  }
+
+  for (done = 0; done < sizeof response; done += count) {
+    count = recv(client->fd, (char *)&response + done, sizeof response - done, 0);
+    if (count < 0 && errno == EINTR)
+      count = 0;
+    else if (count <= 0)
+      return SO3_SERVER_EIO;
+  }
+  return response.status;
+}
+
+// Copy the input into the scratch buffer, run the request and copy the
+// output back.
+static so3_server_status_t so3_client_copy_submit(
+    so3_client_t *client, so3_server_request_t *request, void *out, const void *in0,
+    size_t in0_size, const void *in1) {
+  size_t in_size = so3_server_in_size(request);
+  size_t out_size = so3_server_out_size(request);
+  so3_server_status_t status;
+
+  if (in_size == 0 || out_size == 0)
+    return SO3_SERVER_EINVAL;
+  if (!client->scratch || client->scratch->size < in_size + out_size) {
+    so3_shm_free(client->scratch);
+    client->scratch = so3_shm_alloc(in_size + out_size);
+    if (!client->scratch)
+      return SO3_SERVER_ESHM;
+  }
+
+  memcpy(client->scratch->data, in0, in0_size);
+  if (in1)
+    memcpy((char *)client->scratch->data + in0_size, in1, in_size - in0_size);
+  request->in_offset = 0;
+  request->out_offset = in_size;
+  status = so3_client_submit(client, request, client->scratch);
+  if (status == SO3_SERVER_OK)
+    memcpy(out, (char *)client->scratch->data + in_size, out_size);
+  return status;
+}
+
+static so3_server_status_t so3_client_transform(
+    so3_client_t *client, so3_server_op_t op, void *out, const void *in, int batch,
+    const so3_parameters_t *parameters) {
+  so3_server_request_t request;
+  memset(&request, 0, sizeof request);
+  request.op = op;
+  request.parameters = *parameters;
+  request.batch = batch;
+  return so3_client_copy_submit(
+      client, &request, out, in, so3_server_in_size(&request), NULL);
+}
+
+/*!
+ * Compute inverse Wigner transforms of a batch of complex signals on the
+ * server, see \link so3_core_inverse_batch \endlink.
+ *
+ * The data is copied through a shared-memory buffer owned by the connection.
+ * Use \link so3_client_submit \endlink to avoid the copies.
+ *
+ * \param[in] client Connection.
+ * \param[out] f Functions on SO(3), stored one after the other.
+ * \param[in] flmn Harmonic coefficients, stored one after the other.
+ * \param[in] batch Number of signals.
+ * \param[in] parameters A fully populated parameters object. The \link
+ *                       so3_parameters_t::reality reality\endlink flag is
+ *                       ignored.
+ * \retval status \link SO3_SERVER_OK \endlink on success.
+ */
+so3_server_status_t so3_client_inverse(
+    so3_client_t *client, complex double *f, const complex double *flmn, int batch,
+    const so3_parameters_t *parameters) {
+  return so3_client_transform(client, SO3_SERVER_INVERSE, f, flmn, batch, parameters);
+}
+
+/*!
+ * Compute forward Wigner transforms of a batch of complex signals on the
+ * server, see \link so3_client_inverse \endlink.
+ *
+ * \param[in] client Connection.
+ * \param[out] flmn Harmonic coefficients, stored one after the other.
+ * \param[in] f Functions on SO(3), stored one after the other.
+ * \param[in] batch Number of signals.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval status \link SO3_SERVER_OK \endlink on success.
+ */
+so3_server_status_t so3_client_forward(
+    so3_client_t *client, complex double *flmn, const complex double *f, int batch,
+    const so3_parameters_t *parameters) {
+  return so3_client_transform(client, SO3_SERVER_FORWARD, flmn, f, batch, parameters);
+}
+
+/*!
+ * Compute inverse Wigner transforms of a batch of real signals on the
+ * server, see \link so3_client_inverse \endlink.
+ *
+ * \param[in] client Connection.
+ * \param[out] f Real functions on SO(3), stored one after the other.
+ * \param[in] flmn Harmonic coefficients for n >= 0, stored one after the other.
+ * \param[in] batch Number of signals.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval status \link SO3_SERVER_OK \endlink on success.
+ */
+so3_server_status_t so3_client_inverse_real(
+    so3_client_t *client, double *f, const complex double *flmn, int batch,
+    const so3_parameters_t *parameters) {
+  return so3_client_transform(
+      client, SO3_SERVER_INVERSE_REAL, f, flmn, batch, parameters);
+}
+
+/*!
+ * Compute forward Wigner transforms of a batch of real signals on the
+ * server, see \link so3_client_inverse \endlink.
+ *
+ * \param[in] client Connection.
+ * \param[out] flmn Harmonic coefficients for n >= 0, stored one after the
+ *                  other.
+ * \param[in] f Real functions on SO(3), stored one after the other.
+ * \param[in] batch Number of signals.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval status \link SO3_SERVER_OK \endlink on success.
+ */
+so3_server_status_t so3_client_forward_real(
+    so3_client_t *client, complex double *flmn, const double *f, int batch,
+    const so3_parameters_t *parameters) {
+  return so3_client_transform(
+      client, SO3_SERVER_FORWARD_REAL, flmn, f, batch, parameters);
+}
+
+/*!
+ * Compute a harmonic convolution on the server, see \link
+ * so3_conv_harmonic_convolution \endlink.
+ *
+ * \param[in] client Connection.
+ * \param[out] hlmn Harmonic coefficients of the convolution, with the
+ *                  parameters returned by \link
+ *                  so3_conv_get_parameters_of_convolved_lmn \endlink.
+ * \param[in] flmn Harmonic coefficients of the first signal.
+ * \param[in] f_parameters Parameters of flmn.
+ * \param[in] glmn Harmonic coefficients of the second signal.
+ * \param[in] g_parameters Parameters of glmn.
+ * \retval status \link SO3_SERVER_OK \endlink on success.
+ */
+so3_server_status_t so3_client_harmonic_convolution(
+    so3_client_t *client, complex double *hlmn, const complex double *flmn,
+    const so3_parameters_t *f_parameters, const complex double *glmn,
+    const so3_parameters_t *g_parameters) {
+  so3_server_request_t request;
+  memset(&request, 0, sizeof request);
+  request.op = SO3_SERVER_HARMONIC_CONVOLUTION;
+  request.parameters = *f_parameters;
+  request.g_parameters = *g_parameters;
+  request.batch = 1;
+  return so3_client_copy_submit(
+      client, &request, hlmn, flmn, so3_server_flmn_bytes(f_parameters), glmn);
+}
@@ -0,0 +1,543 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_codec.c
+ * Compressed archival format for harmonic coefficients.
+ *
+ * The coefficients of every degree el form one block, which is encoded and
+ * decoded independently of all others. The header holds the offset of every
+ * block, so that degrees are decoded in parallel, or on their own. Within a
+ * block, the coefficients are visited in runs of constant n, which are
+ * contiguous in m (see so3_flmn.c), in order of increasing n. This order does
+ * not depend on the storage method and n-order, so a stream can be decoded
+ * into any storage method and n-order, as long as the band-limits, reality
+ * and n-mode match those it was encoded with.
+ *
+ * The lossy mode quantises real and imaginary parts with the uniform step
+ * 2*error_bound, so that every part is reproduced to within error_bound. The
+ * step is the same for all degrees, i.e. the error bound is absolute and the
+ * quantisation does not adapt to the energy of each degree. The quantised
+ * integers of every run are zigzag-encoded and bit-packed with the
+ * smallest width that holds the largest of them. As the energy of typical
+ * signals decays with el, so do the widths, and the runs of high degrees
+ * shrink to a few bits per coefficient, or to nothing once all of their
+ * coefficients are below the error bound.
+ *
+ * The lossless mode (error_bound = 0) stores the IEEE 754 representations of
+ * every run, dropping the low-order bytes that are zero in all of them (e.g.
+ * for data converted from single precision) and all-zero runs entirely.
+ *
+ * Layout, with integers in little-endian byte order:
+ *   - bytes 0-3: magic "SO3C",
+ *   - bytes 4-7: format version, 1 for lossless, reality, n-mode,
+ *   - bytes 8-23: L0, L, N and M as 32-bit integers,
+ *   - bytes 24-31: quantisation step as a double,
+ *   - L+1 64-bit offsets of the blocks of el = 0..L-1 and of their end,
+ *   - the blocks, each made of one byte per run (bit width, resp. number of
+ *     bytes kept per part) followed by the packed parts of the runs,
+ *   - 16 zero bytes, so that the decoders may load whole words near the end.
+ *
+ * The decoders check the header, the offsets and the size of every block
+ * against the length of the data before reading them, so truncated or corrupt
+ * data are reported instead of being read out of bounds.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "so3/so3_codec.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+
+#include "so3_omp.h"
+
+#define MIN(a, b) ((a < b) ? (a) : (b))
+
+#define SO3_CODEC_VERSION 1
+#define SO3_CODEC_HEADER_SIZE 32
+#define SO3_CODEC_PADDING 16
+
+// Arrays with fewer coefficients are processed by a single thread.
+#define SO3_CODEC_PARALLEL_MIN 32768
+
+// Bound on the magnitude of quantised parts, 2^62, so that their zigzag codes
+// fit into 64 bits.
+#define SO3_CODEC_QUANTISED_MAX 4611686018427387904.0
+
+typedef struct {
+  int L, parallel;
+  // Runs of degree el are run_start[el] .. run_start[el + 1] - 1.
+  int *run_start;
+  // flmn index of m = -min(el, M-1) and length of each run.
+  int *ind, *size;
+} so3_codec_runs_t;
+
+static void so3_codec_runs_init(
+    so3_codec_runs_t *runs, const so3_parameters_t *parameters) {
+  const int L = parameters->L;
+  const int N = parameters->N;
+  const int M = so3_sampling_mlim(parameters);
+  int el, n, nruns;
+
+  runs->L = L;
+  runs->parallel = so3_sampling_flmn_size(parameters) >= SO3_CODEC_PARALLEL_MIN;
+  runs->run_start = malloc((L + 1) * sizeof *runs->run_start);
+  runs->ind = malloc(L * (2 * N - 1) * sizeof *runs->ind);
+  runs->size = malloc(L * (2 * N - 1) * sizeof *runs->size);
+  SO3_ERROR_MEM_ALLOC_CHECK(runs->run_start);
+  SO3_ERROR_MEM_ALLOC_CHECK(runs->ind);
+  SO3_ERROR_MEM_ALLOC_CHECK(runs->size);
+
+  nruns = 0;
+  for (el = 0; el < L; ++el) {
+    const int mmax = MIN(el, M - 1);
+    runs->run_start[el] = nruns;
+    for (n = parameters->reality ? 0 : -N + 1; n < N; ++n) {
+      if (el < parameters->L0 || abs(n) > el ||
+          !so3_sampling_is_elmn_non_zero(el, 0, n, parameters))
+        continue;
+      if (parameters->reality)
+        so3_sampling_elmn2ind_real(&runs->ind[nruns], el, -mmax, n, parameters);
+      else
+        so3_sampling_elmn2ind(&runs->ind[nruns], el, -mmax, n, parameters);
+      runs->size[nruns] = 2 * mmax + 1;
+      ++nruns;
+    }
+  }
+  runs->run_start[L] = nruns;
+}
+
+static void so3_codec_runs_free(so3_codec_runs_t *runs) {
+  free(runs->run_start);
+  free(runs->ind);
+  free(runs->size);
+}
+
+static void so3_codec_put_u32(unsigned char *p, uint32_t value) {
+  int i;
+  for (i = 0; i < 4; ++i)
+    p[i] = (unsigned char)(value >> (8 * i));
+}
+
+static uint32_t so3_codec_get_u32(const unsigned char *p) {
+  uint32_t value = 0;
+  int i;
+  for (i = 0; i < 4; ++i)
+    value |= (uint32_t)p[i] << (8 * i);
+  return value;
+}
+
+static void so3_codec_put_u64(unsigned char *p, uint64_t value) {
+  int i;
+  for (i = 0; i < 8; ++i)
+    p[i] = (unsigned char)(value >> (8 * i));
+}
+
+static uint64_t so3_codec_get_u64(const unsigned char *p) {
+  uint64_t value = 0;
+  int i;
+  for (i = 0; i < 8; ++i)
+    value |= (uint64_t)p[i] << (8 * i);
+  return value;
+}
+
+// Unaligned little-endian load of a whole word in the inner decode loops.
+static inline uint64_t so3_codec_load64(const unsigned char *p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof value);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  value = __builtin_bswap64(value);
+#endif
+  return value;
+}
+
+static inline uint64_t so3_codec_mask(int width) {
+  return width >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << width) - 1;
+}
+
+static inline uint64_t so3_codec_quantise(double x, double step) {
+  const double q = x / step;
+  int64_t k;
+  if (!(fabs(q) < SO3_CODEC_QUANTISED_MAX))
+    SO3_ERROR_GENERIC("Coefficient not finite or too large for the error bound.");
+  k = (int64_t)llround(q);
+  return k < 0 ? ~((uint64_t)k << 1) : (uint64_t)k << 1;
+}
+
+static inline double so3_codec_dequantise(uint64_t z, double step) {
+  const int64_t k = (int64_t)((z >> 1) ^ (~(z & 1) + 1));
+  return (double)k * step;
+}
+
+static int so3_codec_width(uint64_t max) {
+  int width = 0;
+  while (width < 64 && (max >> width))
+    ++width;
+  return width;
+}
+
+static void
+so3_codec_put_bits(unsigned char *data, uint64_t *pos, uint64_t value, int width) {
+  int done = 0;
+  while (done < width) {
+    const int shift = (int)(*pos & 7);
+    const int count = MIN(8 - shift, width - done);
+    const uint64_t chunk = (value >> done) & so3_codec_mask(count);
+    data[*pos >> 3] |= (unsigned char)(chunk << shift);
+    done += count;
+    *pos += count;
+  }
+}
+
+static inline uint64_t
+so3_codec_get_bits(const unsigned char *data, uint64_t pos, int width) {
+  const int shift = (int)(pos & 7);
+  uint64_t word = so3_codec_load64(data + (pos >> 3)) >> shift;
+  if (shift + width > 64)
+    word |= (uint64_t)data[(pos >> 3) + 8] << (64 - shift);
+  return word & so3_codec_mask(width);
+}
+
+// Number of bytes kept of the parts of a run in lossless mode, i.e. 8 minus
+// the number of low-order bytes that are zero in all of them.
+static int so3_codec_bytes_kept(const double *parts, int count) {
+  uint64_t all = 0, bits;
+  int k, kept = 8;
+  for (k = 0; k < count; ++k) {
+    memcpy(&bits, parts + k, sizeof bits);
+    all |= bits;
+  }
+  if (!all)
+    return 0;
+  while (!(all & 0xff)) {
+    all >>= 8;
+    --kept;
+  }
+  return kept;
+}
+
+/*!
+ * Compute an upper bound on the size of encoded coefficients.
+ *
+ * \param[in] parameters A fully populated parameters object.
+ * \retval size Number of bytes sufficient for \link so3_codec_encode
+ *              \endlink, in any mode.
+ */
+size_t so3_codec_encode_bound(const so3_parameters_t *parameters) {
+  const int L = parameters->L, N = parameters->N;
+  return SO3_CODEC_HEADER_SIZE + 8 * (size_t)(L + 1) + (size_t)L * (2 * N - 1) +
+         16 * (size_t)so3_sampling_flmn_size(parameters) + SO3_CODEC_PADDING;
+}
+
+/*!
+ * Encode harmonic coefficients.
+ *
+ * \param[out] data Encoded coefficients, of at least \link
+ *                  so3_codec_encode_bound \endlink bytes.
+ * \param[in] flmn Harmonic coefficients.
+ * \param[in] error_bound Largest absolute error of the real and imaginary
+ *                        parts of the decoded coefficients (up to rounding).
+ *                        Zero selects the lossless mode.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval size Number of bytes written to data.
+ *
+ * \note Coefficients that are zero by construction, e.g. padding, are not
+ *       stored. The quantisation step 2*error_bound is used for every degree;
+ *       only the bit widths of the runs adapt to the coefficients.
+ */
+size_t so3_codec_encode(
+    unsigned char *data, const SO3_COMPLEX(double) * flmn, double error_bound,
+    const so3_parameters_t *parameters) {
+  const int L = parameters->L;
+  const int lossless = error_bound == 0.0;
+  const double step = 2.0 * error_bound;
+  so3_codec_runs_t runs;
+  unsigned char *codes;
+  uint64_t *offsets, step_bits;
+  int el;
+
+  if (!(error_bound >= 0.0))
+    SO3_ERROR_GENERIC("Error bound must be non-negative.");
+
+  so3_codec_runs_init(&runs, parameters);
+  codes = malloc((runs.run_start[L] + 1) * sizeof *codes);
+  offsets = malloc((L + 1) * sizeof *offsets);
+  SO3_ERROR_MEM_ALLOC_CHECK(codes);
+  SO3_ERROR_MEM_ALLOC_CHECK(offsets);
+
+  // Choose the code of every run and compute the size of every block.
+  SO3_PRAGMA(omp parallel for schedule(dynamic) if (runs.parallel))
+  for (el = 0; el < L; ++el) {
+    uint64_t bits = 0;
+    int r, k;
+    for (r = runs.run_start[el]; r < runs.run_start[el + 1]; ++r) {
+      const double *parts = (const double *)(flmn + runs.ind[r]);
+      const int count = 2 * runs.size[r];
+      if (lossless) {
+        codes[r] = so3_codec_bytes_kept(parts, count);
+        bits += 8 * (uint64_t)codes[r] * count;
+      } else {
+        uint64_t max = 0;
+        for (k = 0; k < count; ++k) {
+          const uint64_t z = so3_codec_quantise(parts[k], step);
+          max = z > max ? z : max;
+        }
+        codes[r] = so3_codec_width(max);
+        bits += (uint64_t)codes[r] * count;
+      }
+    }
+    offsets[el + 1] = runs.run_start[el + 1] - runs.run_start[el] + (bits + 7) / 8;
+  }
+  offsets[0] = SO3_CODEC_HEADER_SIZE + 8 * (uint64_t)(L + 1);
+  for (el = 0; el < L; ++el)
+    offsets[el + 1] += offsets[el];
+
+  memcpy(data, "SO3C", 4);
+  data[4] = SO3_CODEC_VERSION;
+  data[5] = lossless;
+  data[6] = parameters->reality ? 1 : 0;
+  data[7] = parameters->n_mode;
+  so3_codec_put_u32(data + 8, parameters->L0);
+  so3_codec_put_u32(data + 12, L);
+  so3_codec_put_u32(data + 16, parameters->N);
+  so3_codec_put_u32(data + 20, so3_sampling_mlim(parameters));
+  memcpy(&step_bits, &step, sizeof step_bits);
+  so3_codec_put_u64(data + 24, step_bits);
+  for (el = 0; el <= L; ++el)
+    so3_codec_put_u64(data + SO3_CODEC_HEADER_SIZE + 8 * el, offsets[el]);
+  memset(data + offsets[L], 0, SO3_CODEC_PADDING);
+
+  // Write the blocks.
+  SO3_PRAGMA(omp parallel for schedule(dynamic) if (runs.parallel))
+  for (el = 0; el < L; ++el) {
+    const int nruns = runs.run_start[el + 1] - runs.run_start[el];
+    unsigned char *block = data + offsets[el];
+    unsigned char *payload = block + nruns;
+    uint64_t pos = 0;
+    int r, k, b;
+
+    memcpy(block, codes + runs.run_start[el], nruns);
+    memset(payload, 0, offsets[el + 1] - offsets[el] - nruns);
+    for (r = runs.run_start[el]; r < runs.run_start[el + 1]; ++r) {
+      const double *parts = (const double *)(flmn + runs.ind[r]);
+      const int count = 2 * runs.size[r];
+      const int code = codes[r];
+      if (code == 0)
+        continue;
+      for (k = 0; k < count; ++k) {
+        if (lossless) {
+          uint64_t bits;
+          memcpy(&bits, parts + k, sizeof bits);
+          bits >>= 8 * (8 - code);
+          for (b = 0; b < code; ++b)
+            payload[pos++] = (unsigned char)(bits >> (8 * b));
+        } else {
+          so3_codec_put_bits(payload, &pos, so3_codec_quantise(parts[k], step), code);
+        }
+      }
+    }
+  }
+
+  const size_t size = offsets[L] + SO3_CODEC_PADDING;
+  so3_codec_runs_free(&runs);
+  free(codes);
+  free(offsets);
+  return size;
+}
+
+static uint64_t so3_codec_offset(const unsigned char *data, int el) {
+  return so3_codec_get_u64(data + SO3_CODEC_HEADER_SIZE + 8 * (size_t)el);
+}
+
+// Check that size bytes hold the header, the offsets and the blocks they
+// delimit, followed by the padding.
+static int so3_codec_valid(const unsigned char *data, size_t size) {
+  uint64_t end, step_bits;
+  double step;
+  int64_t L;
+  int el;
+
+  if (size < SO3_CODEC_HEADER_SIZE || memcmp(data, "SO3C", 4) ||
+      data[4] != SO3_CODEC_VERSION || data[5] > 1)
+    return 0;
+  step_bits = so3_codec_get_u64(data + 24);
+  memcpy(&step, &step_bits, sizeof step);
+  if (!data[5] && !(step > 0.0 && isfinite(step)))
+    return 0;
+  L = so3_codec_get_u32(data + 12);
+  end = SO3_CODEC_HEADER_SIZE + 8 * (uint64_t)(L + 1);
+  if (L < 1 || L > INT32_MAX || end > size || so3_codec_offset(data, 0) != end)
+    return 0;
+  for (el = 0; el < L; ++el)
+    if (so3_codec_offset(data, el + 1) < so3_codec_offset(data, el))
+      return 0;
+  return so3_codec_offset(data, L) <= size - SO3_CODEC_PADDING;
+}
+
+/*!
+ * Size of encoded coefficients.
+ *
+ * \param[in] data Encoded coefficients.
+ * \param[in] size Number of bytes available at data, at least those of the
+ *                 encoded coefficients.
+ * \retval size Number of bytes returned by \link so3_codec_encode \endlink,
+ *              or 0 if data are not encoded coefficients of a supported
+ *              version, or are truncated or corrupt.
+ */
+size_t so3_codec_size(const unsigned char *data, size_t size) {
+  if (!so3_codec_valid(data, size))
+    return 0;
+  return so3_codec_offset(data, so3_codec_get_u32(data + 12)) + SO3_CODEC_PADDING;
+}
+
+// Check that the coefficients were encoded with matching parameters.
+static void
+so3_codec_check(const unsigned char *data, const so3_parameters_t *parameters) {
+  if (data[6] != (parameters->reality ? 1 : 0) || data[7] != parameters->n_mode ||
+      (int)so3_codec_get_u32(data + 8) != parameters->L0 ||
+      (int)so3_codec_get_u32(data + 12) != parameters->L ||
+      (int)so3_codec_get_u32(data + 16) != parameters->N ||
+      (int)so3_codec_get_u32(data + 20) != so3_sampling_mlim(parameters))
+    SO3_ERROR_GENERIC("Parameters do not match those of the encoded coefficients.");
+}
+
+// Check that the block of degree el holds the codes of its runs and the
+// payload they describe.
+static int so3_codec_block_valid(
+    const unsigned char *data, int el, const so3_codec_runs_t *runs) {
+  const uint64_t offset = so3_codec_offset(data, el);
+  const uint64_t block_size = so3_codec_offset(data, el + 1) - offset;
+  const unsigned char *block = data + offset;
+  const int *size = runs->size + runs->run_start[el];
+  const int nruns = runs->run_start[el + 1] - runs->run_start[el];
+  const int lossless = data[5];
+  uint64_t bits = 0;
+  int r;
+
+  if (block_size < (uint64_t)nruns)
+    return 0;
+  for (r = 0; r < nruns; ++r) {
+    const int code = block[r];
+    if (code > (lossless ? 8 : 64))
+      return 0;
+    bits += (lossless ? 8 : 1) * (uint64_t)code * 2 * size[r];
+  }
+  return (bits + 7) / 8 <= block_size - nruns;
+}
+
+static void so3_codec_decode_block(
+    SO3_COMPLEX(double) * flmn, const unsigned char *data, int el,
+    const so3_codec_runs_t *runs) {
+  const unsigned char *block = data + so3_codec_offset(data, el);
+  const unsigned char *payload = block + runs->run_start[el + 1] - runs->run_start[el];
+  const int lossless = data[5];
+  uint64_t pos = 0, step_bits = so3_codec_get_u64(data + 24);
+  double step;
+  int r, k;
+
+  memcpy(&step, &step_bits, sizeof step);
+  for (r = runs->run_start[el]; r < runs->run_start[el + 1]; ++r) {
+    double *restrict parts = (double *)(flmn + runs->ind[r]);
+    const int count = 2 * runs->size[r];
+    const int code = block[r - runs->run_start[el]];
+    if (code == 0) {
+      for (k = 0; k < count; ++k)
+        parts[k] = 0.0;
+    } else if (lossless) {
+      const unsigned char *p = payload + pos;
+      const uint64_t mask = so3_codec_mask(8 * code);
+      const int shift = 8 * (8 - code);
+      for (k = 0; k < count; ++k) {
+        const uint64_t bits = (so3_codec_load64(p + k * code) & mask) << shift;
+        memcpy(parts + k, &bits, sizeof bits);
+      }
+      pos += (uint64_t)code * count;
+    } else {
+      for (k = 0; k < count; ++k) {
+        parts[k] = so3_codec_dequantise(so3_codec_get_bits(payload, pos, code), step);
+        pos += code;
+      }
+    }
+  }
+}
+
+/*!
+ * Decode harmonic coefficients.
+ *
+ * \param[out] flmn Harmonic coefficients. Coefficients that are zero by
+ *                  construction, e.g. padding, are set to zero.
+ * \param[in] data Encoded coefficients.
+ * \param[in] size Number of bytes available at data, at least those of the
+ *                 encoded coefficients.
+ * \param[in] parameters A fully populated parameters object. The band-limits,
+ *                       reality and n-mode must be those the coefficients were
+ *                       encoded with, while the storage method and n-order
+ *                       may differ.
+ * \retval status 0 on success, or -1 if data are not encoded coefficients of
+ *                a supported version, or are truncated or corrupt, in which
+ *                case flmn is not written.
+ */
+int so3_codec_decode(
+    SO3_COMPLEX(double) * flmn, const unsigned char *data, size_t size,
+    const so3_parameters_t *parameters) {
+  so3_codec_runs_t runs;
+  int el, valid;
+
+  if (!so3_codec_valid(data, size))
+    return -1;
+  so3_codec_check(data, parameters);
+  so3_codec_runs_init(&runs, parameters);
+  for (valid = 1, el = 0; el < runs.L && valid; ++el)
+    valid = so3_codec_block_valid(data, el, &runs);
+  if (!valid) {
+    so3_codec_runs_free(&runs);
+    return -1;
+  }
+  memset(flmn, 0, so3_sampling_flmn_size(parameters) * sizeof *flmn);
+
+  SO3_PRAGMA(omp parallel for schedule(dynamic) if (runs.parallel))
+  for (el = 0; el < runs.L; ++el)
+    so3_codec_decode_block(flmn, data, el, &runs);
+
+  so3_codec_runs_free(&runs);
+  return 0;
+}
+
+/*!
+ * Decode the harmonic coefficients of a single degree.
+ *
+ * \param[out] flmn Harmonic coefficients. Only those of degree el are
+ *                  written.
+ * \param[in] data Encoded coefficients.
+ * \param[in] size Number of bytes available at data, as for \link
+ *                 so3_codec_decode \endlink.
+ * \param[in] el Degree to decode.
+ * \param[in] parameters A fully populated parameters object, as for \link
+ *                       so3_codec_decode \endlink.
+ * \retval status 0 on success, or -1 if data are not valid encoded
+ *                coefficients, in which case flmn is not written.
+ */
+int so3_codec_decode_el(
+    SO3_COMPLEX(double) * flmn, const unsigned char *data, size_t size, int el,
+    const so3_parameters_t *parameters) {
+  so3_codec_runs_t runs;
+  int valid;
+
+  if (!so3_codec_valid(data, size))
+    return -1;
+  so3_codec_check(data, parameters);
+  if (el < 0 || el >= parameters->L)
+    SO3_ERROR_GENERIC("Degree out of range.");
+  so3_codec_runs_init(&runs, parameters);
+  valid = so3_codec_block_valid(data, el, &runs);
+  if (valid)
+    so3_codec_decode_block(flmn, data, el, &runs);
+  so3_codec_runs_free(&runs);
+  return valid ? 0 : -1;
+}
@@ -50,39 +50,36 @@ void so3_conv_harmonic_convolution(
     const so3_parameters_t* g_parameters
 )
 {
-    int ind_h, ind_f, ind_g, el, m, n, k;
-    int n_start, n_stop, n_inc;
+    int ind_f, ind_g, el, m, n, k;
     int nf_start, nf_stop, nf_inc;
-    int el_start, el_stop, el_inc;
-    int m_start, m_stop, m_inc;
+    so3_flmn_iter_t iter;
 
-    so3_sampling_n_loop_values(&n_start, &n_stop, &n_inc, h_parameters);
-    for (n = n_start; n <= n_stop; n += n_inc)
+    so3_sampling_n_loop_values(&nf_start, &nf_stop, &nf_inc, f_parameters);
+
+    // Walk hlmn in storage order, which also clears the coefficients
+    // that are zero for the parameters of h (e.g. padding).
+    so3_flmn_iter_init(&iter, h_parameters);
+    while (so3_flmn_iter_next(&iter))
     {
-        so3_sampling_el_loop_values(&el_start, &el_stop, &el_inc, n, h_parameters);
-        for (el = el_start; el <= el_stop; el +=el_inc)
+        el = iter.el;
+        m = iter.m;
+        n = iter.n;
+        hlmn[iter.ind] = 0;
+
+        if (!so3_sampling_is_elmn_non_zero(el, m, n, h_parameters))
+            continue;
+
+        for (k = nf_start; k <= nf_stop; k += nf_inc)
         {
-            so3_sampling_m_loop_values(&m_start, &m_stop, &m_inc, el);
-            for (m = m_start; m <= m_stop; m +=m_inc)
+            if (so3_sampling_is_elmn_non_zero(el, n, k, g_parameters))
             {
-                if (h_parameters->reality) so3_sampling_elmn2ind_real(&ind_h, el, m, n, h_parameters);
-                else so3_sampling_elmn2ind(&ind_h, el, m, n, h_parameters);
-                hlmn[ind_h] = 0;
-
-                so3_sampling_n_loop_values(&nf_start, &nf_stop, &nf_inc, f_parameters);
-                for (k = nf_start; k <= nf_stop; k += nf_inc)
-                {
-                    if (so3_sampling_is_elmn_non_zero(el, n, k, g_parameters))
-                    {
-                        if (f_parameters->reality) so3_sampling_elmn2ind_real(&ind_f, el, m, k, f_parameters);
-                        else so3_sampling_elmn2ind(&ind_f, el, m, k, f_parameters);
-                        
-                        if (g_parameters->reality) so3_sampling_elmn2ind_real(&ind_g, el, n, k, g_parameters);
-                        else so3_sampling_elmn2ind(&ind_g, el, n, k, g_parameters);
-                        
-                        hlmn[ind_h] += flmn[ind_f] * conj(glmn[ind_g]);
-                    }
-                }
+                if (f_parameters->reality) so3_sampling_elmn2ind_real(&ind_f, el, m, k, f_parameters);
+                else so3_sampling_elmn2ind(&ind_f, el, m, k, f_parameters);
+                
+                if (g_parameters->reality) so3_sampling_elmn2ind_real(&ind_g, el, n, k, g_parameters);
+                else so3_sampling_elmn2ind(&ind_g, el, n, k, g_parameters);
+                
+                hlmn[iter.ind] += flmn[ind_f] * conj(glmn[ind_g]);
             }
         }
     }
@@ -116,7 +113,10 @@ so3_parameters_t so3_conv_get_parameters_of_convolved_lmn(
     h_parameters = *f_parameters;
 
     h_parameters.L = MIN(f_parameters->L, g_parameters->L);
-    h_parameters.N = h_parameters.L;
+    // hlmn inherits the azimuthal band-limit of flmn, while the azimuthal
+    // band-limit of glmn restricts the orientational one of hlmn.
+    h_parameters.M = MIN(so3_sampling_mlim(f_parameters), h_parameters.L);
+    h_parameters.N = MIN(h_parameters.L, so3_sampling_mlim(g_parameters));
     h_parameters.L0 = MAX(f_parameters->L0, g_parameters->L0);
     return h_parameters;
 }
@@ -190,26 +190,28 @@ void so3_conv_s2toso3_harmonic_convolution(
     const SO3_COMPLEX(double) * glm
 )
 {
-    int hlmn_length = so3_sampling_flmn_size(h_parameters);
     int el, m, n;
     int ind_f, ind_g;
     SO3_COMPLEX(double) psi;
+    so3_flmn_iter_t iter;
 
-    for (int i=0; i<hlmn_length; i++)
+    so3_flmn_iter_init(&iter, h_parameters);
+    while (so3_flmn_iter_next(&iter))
     {
-        if (h_parameters->reality) so3_sampling_ind2elmn_real(&el, &m, &n, i, h_parameters);
-        else so3_sampling_ind2elmn(&el, &m, &n, i, h_parameters);
+        el = iter.el;
+        m = iter.m;
+        n = iter.n;
 
         if (abs(m) <= el & abs(n) <= el)
         {
             ssht_sampling_elm2ind(&ind_f, el, m);
             ssht_sampling_elm2ind(&ind_g, el, n);
             psi = 8*SO3_PI*SO3_PI/(2*el+1);
-            hlmn[i] = flm[ind_f] * conj(glm[ind_g]) * psi;
+            hlmn[iter.ind] = flm[ind_f] * conj(glm[ind_g]) * psi;
         }
         else 
         {
-            hlmn[i] = 0;
+            hlmn[iter.ind] = 0;
         }
     }
 }
@@ -10,18 +10,23 @@
  * \author <a href="http://www.jasonmcewen.org">Jason McEwen</a>
  */
 
-#include <complex.h> // Must be before fftw3.h
-#include <fftw3.h>
+#include <complex.h>
 #include <math.h>
 #include <ssht/ssht.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "so3/so3_alloc.h"
 #include "so3/so3_error.h"
+#include "so3/so3_fft.h"
 #include "so3/so3_sampling.h"
+#include "so3/so3_small.h"
+#include "so3/so3_tune.h"
 #include "so3/so3_types.h"
 
+#include "so3_kernels.h"
+
 #define MIN(a, b) ((a < b) ? (a) : (b))
 #define MAX(a, b) ((a > b) ? (a) : (b))
 
@@ -34,6 +39,16 @@ typedef void (*forward_complex_ssht)(
 typedef void (*forward_real_ssht)(
     complex double *, const double *, int, int, ssht_dl_method_t, int);
 
+// Sizes of the sampling grid in alpha and beta, and of its periodic extension
+// in beta, used by the direct transforms.
+static void so3_core_grid_sizes(
+    int *nalpha, int *nbeta, int *nbeta_ext, const so3_parameters_t *parameters) {
+  *nalpha = so3_sampling_nalpha(parameters);
+  *nbeta = so3_sampling_nbeta(parameters);
+  *nbeta_ext = parameters->sampling_scheme == SO3_SAMPLING_MW ? 2 * parameters->L - 1
+                                                             : 2 * parameters->L;
+}
+
 /*!
  * Compute inverse Wigner transform for a complex signal via SSHT.
  *
@@ -65,13 +80,13 @@ void so3_core_inverse_via_ssht(
   complex double *fn, *ftemp;
   // Stride for several arrays
   int fn_n_stride;
-  // FFTW-related variables
-  int fftw_rank, fftw_howmany;
-  int fftw_idist, fftw_odist;
-  int fftw_istride, fftw_ostride;
-  int fftw_n;
-  complex double *fftw_target;
-  fftw_plan plan;
+  // FFT-related variables
+  int fft_rank, fft_howmany;
+  int fft_idist, fft_odist;
+  int fft_istride, fft_ostride;
+  int fft_n;
+  complex double *fft_target;
+  so3_fft_plan_t *plan;
 
   inverse_complex_ssht ssht;
 
@@ -86,6 +101,10 @@ void so3_core_inverse_via_ssht(
   verbosity = parameters->verbosity;
   steerable = parameters->steerable;
 
+  // ssht has no notion of an azimuthal band-limit.
+  if (so3_sampling_mlim(parameters) < L)
+    SO3_ERROR_GENERIC("Azimuthal band-limit M < L requires the direct transforms.");
+
   // Print messages depending on verbosity level.
   if (verbosity > 0) {
     printf("%sComputing inverse transform using MW sampling with\n", SO3_PROMPT);
@@ -115,47 +134,47 @@ void so3_core_inverse_via_ssht(
   if (steerable) {
     // For steerable signals, we need to supersample in n/gamma,
     // in order to create a symmetric sampling.
-    fftw_n = 2 * N; // Each transform is over 2*N
+    fft_n = 2 * N; // Each transform is over 2*N
 
     // We need to perform the FFT into a temporary buffer, because
     // the result will be twice as large as the output we need.
-    ftemp = malloc(2 * N * fn_n_stride * sizeof *ftemp);
+    ftemp = so3_alloc_large(2 * N * fn_n_stride, sizeof *ftemp);
     SO3_ERROR_MEM_ALLOC_CHECK(ftemp);
 
-    fftw_target = ftemp;
+    fft_target = ftemp;
   } else {
-    fftw_n = 2 * N - 1; // Each transform is over 2*N-1
+    fft_n = 2 * N - 1; // Each transform is over 2*N-1
 
-    fftw_target = f;
+    fft_target = f;
   }
 
-  fn = calloc(fftw_n * fn_n_stride, sizeof *fn);
+  fn = so3_alloc_large(fft_n * fn_n_stride, sizeof *fn);
   SO3_ERROR_MEM_ALLOC_CHECK(fn);
 
-  // Initialize fftw_plan first. With FFTW_ESTIMATE this is technically not
+  // Initialize the FFT plan first. With SO3_FFT_ESTIMATE this is technically not
   // necessary but still good practice.
-  fftw_rank = 1;              // We compute 1d transforms
-  fftw_howmany = fn_n_stride; // We need L*(2*L-1) of these transforms
+  fft_rank = 1;              // We compute 1d transforms
+  fft_howmany = fn_n_stride; // We need L*(2*L-1) of these transforms
 
   // We want to transform columns
-  fftw_idist = fftw_odist = 1; // The starts of the columns are contiguous in memory
-  fftw_istride = fftw_ostride =
+  fft_idist = fft_odist = 1; // The starts of the columns are contiguous in memory
+  fft_istride = fft_ostride =
       fn_n_stride; // Distance between two elements of the same column
 
-  plan = fftw_plan_many_dft(
-      fftw_rank,
-      &fftw_n,
-      fftw_howmany,
+  plan = so3_fft_plan_many_dft(
+      fft_rank,
+      &fft_n,
+      fft_howmany,
       fn,
       NULL,
-      fftw_istride,
-      fftw_idist,
-      fftw_target,
+      fft_istride,
+      fft_idist,
+      fft_target,
       NULL,
-      fftw_ostride,
-      fftw_odist,
-      FFTW_BACKWARD,
-      FFTW_ESTIMATE);
+      fft_ostride,
+      fft_odist,
+      SO3_FFT_BACKWARD,
+      SO3_FFT_ESTIMATE);
 
   for (n = -N + 1; n <= N - 1; ++n) {
     int ind, offset, i, el;
@@ -199,7 +218,7 @@ void so3_core_inverse_via_ssht(
 
     // The conditional applies the spatial transform, so that we store
     // the results in n-order 0, 1, 2, -2, -1
-    offset = (n < 0 ? n + fftw_n : n);
+    offset = (n < 0 ? n + fft_n : n);
 
     (*ssht)(fn + offset * fn_n_stride, flm, L0e, L, -n, dl_method, verbosity);
 
@@ -213,15 +232,15 @@ void so3_core_inverse_via_ssht(
     free(flm);
   }
 
-  fftw_execute(plan);
-  fftw_destroy_plan(plan);
+  so3_fft_execute(plan);
+  so3_fft_destroy_plan(plan);
 
   if (steerable) {
     memcpy(f, ftemp, N * fn_n_stride * sizeof(complex double));
-    free(ftemp);
+    so3_alloc_free(ftemp);
   }
 
-  free(fn);
+  so3_alloc_free(fn);
 
   if (verbosity > 0)
     printf("%sInverse transform computed!\n", SO3_PROMPT);
@@ -259,12 +278,12 @@ void so3_core_forward_via_ssht(
   complex double *ftemp, *fn;
   // Stride for several arrays
   int fn_n_stride;
-  // FFTW-related variables
-  int fftw_rank, fftw_howmany;
-  int fftw_idist, fftw_odist;
-  int fftw_istride, fftw_ostride;
-  int fftw_n;
-  fftw_plan plan;
+  // FFT-related variables
+  int fft_rank, fft_howmany;
+  int fft_idist, fft_odist;
+  int fft_istride, fft_ostride;
+  int fft_n;
+  so3_fft_plan_t *plan;
 
   forward_complex_ssht ssht;
 
@@ -282,6 +301,10 @@ void so3_core_forward_via_ssht(
   verbosity = parameters->verbosity;
   steerable = parameters->steerable;
 
+  // ssht has no notion of an azimuthal band-limit.
+  if (so3_sampling_mlim(parameters) < L)
+    SO3_ERROR_GENERIC("Azimuthal band-limit M < L requires the direct transforms.");
+
   // Print messages depending on verbosity level.
   if (verbosity > 0) {
     printf("%sComputing forward transform using MW sampling with\n", SO3_PROMPT);
@@ -309,7 +332,7 @@ void so3_core_forward_via_ssht(
   if (steerable) {
     int g, offset;
 
-    fn = calloc((2 * N - 1) * fn_n_stride, sizeof *fn);
+    fn = so3_alloc_large((2 * N - 1) * fn_n_stride, sizeof *fn);
     SO3_ERROR_MEM_ALLOC_CHECK(fn);
 
     for (n = -N + 1; n < N; n += 2) {
@@ -330,40 +353,40 @@ void so3_core_forward_via_ssht(
     // Make a copy of the input, because input is const
     // This could potentially be avoided by copying the input into fn and using an
     // in-place FFTW. The performance impact has to be profiled, though.
-    ftemp = malloc((2 * N - 1) * fn_n_stride * sizeof *ftemp);
+    ftemp = so3_alloc_large((2 * N - 1) * fn_n_stride, sizeof *ftemp);
     SO3_ERROR_MEM_ALLOC_CHECK(ftemp);
     memcpy(ftemp, f, (2 * N - 1) * fn_n_stride * sizeof(complex double));
 
-    fn = malloc((2 * N - 1) * fn_n_stride * sizeof *fn);
+    fn = so3_alloc_large((2 * N - 1) * fn_n_stride, sizeof *fn);
     SO3_ERROR_MEM_ALLOC_CHECK(fn);
 
-    // Initialize fftw_plan first. With FFTW_ESTIMATE this is technically not
+    // Initialize the FFT plan first. With SO3_FFT_ESTIMATE this is technically not
     // necessary but still good practice.
-    fftw_rank = 1;
-    fftw_n = 2 * N - 1;
-    fftw_howmany = fn_n_stride;
-    fftw_idist = fftw_odist = 1;
-    fftw_istride = fftw_ostride = fn_n_stride;
-
-    plan = fftw_plan_many_dft(
-        fftw_rank,
-        &fftw_n,
-        fftw_howmany,
+    fft_rank = 1;
+    fft_n = 2 * N - 1;
+    fft_howmany = fn_n_stride;
+    fft_idist = fft_odist = 1;
+    fft_istride = fft_ostride = fn_n_stride;
+
+    plan = so3_fft_plan_many_dft(
+        fft_rank,
+        &fft_n,
+        fft_howmany,
         ftemp,
         NULL,
-        fftw_istride,
-        fftw_idist,
+        fft_istride,
+        fft_idist,
         fn,
         NULL,
-        fftw_ostride,
-        fftw_odist,
-        FFTW_FORWARD,
-        FFTW_ESTIMATE);
+        fft_ostride,
+        fft_odist,
+        SO3_FFT_FORWARD,
+        SO3_FFT_ESTIMATE);
 
-    fftw_execute(plan);
-    fftw_destroy_plan(plan);
+    so3_fft_execute(plan);
+    so3_fft_destroy_plan(plan);
 
-    free(ftemp);
+    so3_alloc_free(ftemp);
 
     factor = 2 * SO3_PI / (double)(2 * N - 1);
     for (i = 0; i < (2 * N - 1) * fn_n_stride; ++i)
@@ -434,7 +457,7 @@ void so3_core_forward_via_ssht(
       printf("\n");
   }
 
-  free(fn);
+  so3_alloc_free(fn);
 
   if (verbosity > 0)
     printf("%sForward transform computed!\n", SO3_PROMPT);
@@ -472,13 +495,13 @@ void so3_core_inverse_via_ssht_real(
   double *ftemp;
   // Stride for several arrays
   int fn_n_stride;
-  // FFTW-related variables
-  int fftw_rank, fftw_howmany;
-  int fftw_idist, fftw_odist;
-  int fftw_istride, fftw_ostride;
-  int fftw_n;
-  double *fftw_target;
-  fftw_plan plan;
+  // FFT-related variables
+  int fft_rank, fft_howmany;
+  int fft_idist, fft_odist;
+  int fft_istride, fft_ostride;
+  int fft_n;
+  double *fft_target;
+  so3_fft_plan_t *plan;
 
   inverse_complex_ssht complex_ssht;
   inverse_real_ssht real_ssht;
@@ -494,6 +517,10 @@ void so3_core_inverse_via_ssht_real(
   verbosity = parameters->verbosity;
   steerable = parameters->steerable;
 
+  // ssht has no notion of an azimuthal band-limit.
+  if (so3_sampling_mlim(parameters) < L)
+    SO3_ERROR_GENERIC("Azimuthal band-limit M < L requires the direct transforms.");
+
   // Print messages depending on verbosity level.
   if (verbosity > 0) {
     printf("%sComputing inverse transform using MW sampling with\n", SO3_PROMPT);
@@ -525,55 +552,55 @@ void so3_core_inverse_via_ssht_real(
 
   // For steerable signals, we need to supersample in n/gamma,
   // in order to create a symmetric sampling.
-  // Each transform is over fftw_n samples (logically; physically, fn for negative n
+  // Each transform is over fft_n samples (logically; physically, fn for negative n
   // will be omitted)
   // if (steerable)
   //{
   // For steerable signals, we need to supersample in n/gamma,
   // in order to create a symmetric sampling.
-  //    fftw_n = 2*N;
+  //    fft_n = 2*N;
 
   // We need to perform the FFT into a temporary buffer, because
   // the result will be twice as large as the output we need.
   //    ftemp = malloc(2*N*fn_n_stride * sizeof *ftemp);
   //    SO3_ERROR_MEM_ALLOC_CHECK(ftemp);
 
-  //    fftw_target = ftemp;
+  //    fft_target = ftemp;
   //}
   // else
   //{
-  fftw_n = 2 * N - 1;
+  fft_n = 2 * N - 1;
 
-  fftw_target = f;
+  fft_target = f;
   //}
 
   // Only need to store for non-negative n
-  fn = calloc((fftw_n / 2 + 1) * fn_n_stride, sizeof *fn);
+  fn = so3_alloc_large((fft_n / 2 + 1) * fn_n_stride, sizeof *fn);
   SO3_ERROR_MEM_ALLOC_CHECK(fn);
 
-  // Initialize fftw_plan first. With FFTW_ESTIMATE this is technically not
+  // Initialize the FFT plan first. With SO3_FFT_ESTIMATE this is technically not
   // necessary but still good practice.
-  fftw_rank = 1;              // We compute 1d transforms
-  fftw_howmany = fn_n_stride; // We need L*(2*L-1) of these transforms
+  fft_rank = 1;              // We compute 1d transforms
+  fft_howmany = fn_n_stride; // We need L*(2*L-1) of these transforms
 
   // We want to transform columns
-  fftw_idist = fftw_odist = 1; // The starts of the columns are contiguous in memory
-  fftw_istride = fftw_ostride =
+  fft_idist = fft_odist = 1; // The starts of the columns are contiguous in memory
+  fft_istride = fft_ostride =
       fn_n_stride; // Distance between two elements of the same column
 
-  plan = fftw_plan_many_dft_c2r(
-      fftw_rank,
-      &fftw_n,
-      fftw_howmany,
+  plan = so3_fft_plan_many_dft_c2r(
+      fft_rank,
+      &fft_n,
+      fft_howmany,
       fn,
       NULL,
-      fftw_istride,
-      fftw_idist,
-      fftw_target,
+      fft_istride,
+      fft_idist,
+      fft_target,
       NULL,
-      fftw_ostride,
-      fftw_odist,
-      FFTW_ESTIMATE);
+      fft_ostride,
+      fft_odist,
+      SO3_FFT_ESTIMATE);
 
   flm = malloc(L * L * sizeof *flm);
   SO3_ERROR_MEM_ALLOC_CHECK(flm);
@@ -641,8 +668,8 @@ void so3_core_inverse_via_ssht_real(
 
   free(flm);
 
-  fftw_execute(plan);
-  fftw_destroy_plan(plan);
+  so3_fft_execute(plan);
+  so3_fft_destroy_plan(plan);
 
   // if (steerable)
   //{
@@ -650,7 +677,7 @@ void so3_core_inverse_via_ssht_real(
   //    free(ftemp);
   //}
 
-  free(fn);
+  so3_alloc_free(fn);
 
   if (verbosity > 0)
     printf("%sInverse transform computed!\n", SO3_PROMPT);
@@ -689,12 +716,12 @@ void so3_core_forward_via_ssht_real(
   complex double *flm = NULL, *fn;
   // Stride for several arrays
   int fn_n_stride;
-  // FFTW-related variables
-  int fftw_rank, fftw_howmany;
-  int fftw_idist, fftw_odist;
-  int fftw_istride, fftw_ostride;
-  int fftw_n;
-  fftw_plan plan;
+  // FFT-related variables
+  int fft_rank, fft_howmany;
+  int fft_idist, fft_odist;
+  int fft_istride, fft_ostride;
+  int fft_n;
+  so3_fft_plan_t *plan;
 
   forward_complex_ssht complex_ssht;
   forward_real_ssht real_ssht;
@@ -711,6 +738,10 @@ void so3_core_forward_via_ssht_real(
   n_mode = parameters->n_mode;
   dl_method = parameters->dl_method;
   steerable = parameters->steerable;
+
+  // ssht has no notion of an azimuthal band-limit.
+  if (so3_sampling_mlim(parameters) < L)
+    SO3_ERROR_GENERIC("Azimuthal band-limit M < L requires the direct transforms.");
   verbosity = parameters->verbosity;
 
   // Print messages depending on verbosity level.
@@ -770,42 +801,42 @@ void so3_core_forward_via_ssht_real(
   // Make a copy of the input, because input is const
   // This could potentially be avoided by copying the input into fn and using an
   // in-place FFTW. The performance impact has to be profiled, though.
-  ftemp = malloc((2 * N - 1) * fn_n_stride * sizeof *ftemp);
+  ftemp = so3_alloc_large((2 * N - 1) * fn_n_stride, sizeof *ftemp);
   SO3_ERROR_MEM_ALLOC_CHECK(ftemp);
   memcpy(ftemp, f, (2 * N - 1) * fn_n_stride * sizeof(double));
 
-  fn = malloc(N * fn_n_stride * sizeof *fn);
+  fn = so3_alloc_large(N * fn_n_stride, sizeof *fn);
   SO3_ERROR_MEM_ALLOC_CHECK(fn);
-  // Initialize fftw_plan first. With FFTW_ESTIMATE this is technically not
+  // Initialize the FFT plan first. With SO3_FFT_ESTIMATE this is technically not
   // necessary but still good practice.
-  fftw_rank = 1;      // We compute 1d transforms
-  fftw_n = 2 * N - 1; // Each transform is over 2*N-1 (logically; physically, fn for
+  fft_rank = 1;      // We compute 1d transforms
+  fft_n = 2 * N - 1; // Each transform is over 2*N-1 (logically; physically, fn for
                       // negative n will be omitted)
-  fftw_howmany = fn_n_stride; // We need L*(2*L-1) of these transforms
+  fft_howmany = fn_n_stride; // We need L*(2*L-1) of these transforms
 
   // We want to transform columns
-  fftw_idist = fftw_odist = 1; // The starts of the columns are contiguous in memory
-  fftw_istride = fftw_ostride =
+  fft_idist = fft_odist = 1; // The starts of the columns are contiguous in memory
+  fft_istride = fft_ostride =
       fn_n_stride; // Distance between two elements of the same column
 
-  plan = fftw_plan_many_dft_r2c(
-      fftw_rank,
-      &fftw_n,
-      fftw_howmany,
+  plan = so3_fft_plan_many_dft_r2c(
+      fft_rank,
+      &fft_n,
+      fft_howmany,
       ftemp,
       NULL,
-      fftw_istride,
-      fftw_idist,
+      fft_istride,
+      fft_idist,
       fn,
       NULL,
-      fftw_ostride,
-      fftw_odist,
-      FFTW_ESTIMATE);
+      fft_ostride,
+      fft_odist,
+      SO3_FFT_ESTIMATE);
 
-  fftw_execute(plan);
-  fftw_destroy_plan(plan);
+  so3_fft_execute(plan);
+  so3_fft_destroy_plan(plan);
 
-  free(ftemp);
+  so3_alloc_free(ftemp);
 
   factor = 2 * SO3_PI / (double)(2 * N - 1);
   for (i = 0; i < N * fn_n_stride; ++i)
@@ -890,7 +921,7 @@ void so3_core_forward_via_ssht_real(
   if (storage == SO3_STORAGE_COMPACT)
     free(flm);
 
-  free(fn);
+  so3_alloc_free(fn);
 
   if (verbosity > 0)
     printf("%sForward transform computed!\n", SO3_PROMPT);
@@ -900,7 +931,8 @@ void so3_core_forward_via_ssht_real(
  * Compute inverse Wigner transform for a complex signal directly (without using
  * SSHT).
  *
- * \param[out] f Function on sphere. Provide a buffer of size (2*L-1)*L*(2*N-1).
+ * \param[out] f Function on sphere. Provide a buffer of size (2*L-1)*L*(2*N-1)
+ *               for MW sampling or 2*L*(L+1)*(2*N-1) for MWSS sampling.
  * \param[in]  flmn Harmonic coefficients.
  * \param[in]  parameters A fully populated parameters object. The \link
  *                        so3_parameter_t::reality reality\endlink flag
@@ -914,7 +946,7 @@ void so3_core_forward_via_ssht_real(
 void so3_core_inverse_direct(
     complex double *f, const complex double *flmn, const so3_parameters_t *parameters) {
 
-  int L0, L, N;
+  int L0, L, N, M;
   so3_sampling_t sampling;
   so3_storage_t storage;
   so3_n_mode_t n_mode;
@@ -924,6 +956,7 @@ void so3_core_inverse_direct(
 
   L0 = parameters->L0;
   L = parameters->L;
+  M = so3_sampling_mlim(parameters);
   N = parameters->N;
   sampling = parameters->sampling_scheme;
   storage = parameters->storage;
@@ -935,7 +968,10 @@ void so3_core_inverse_direct(
 
   // Print messages depending on verbosity level.
   if (verbosity > 0) {
-    printf("%sComputing inverse transform using MW sampling with\n", SO3_PROMPT);
+    printf(
+        "%sComputing inverse transform using %s sampling with\n",
+        SO3_PROMPT,
+        sampling == SO3_SAMPLING_MW ? "MW" : "MWSS");
     printf("%sparameters  (L, N, reality) = (%d, %d, FALSE)\n", SO3_PROMPT, L, N);
     if (verbosity > 1)
       printf(
@@ -947,6 +983,10 @@ void so3_core_inverse_direct(
   // Iterators
   int el, m, n, mm; // mm for m'
 
+  // Sizes of the sampling grid and of its periodic extension in beta.
+  int nalpha, nbeta, nbeta_ext;
+  so3_core_grid_sizes(&nalpha, &nbeta, &nbeta_ext, parameters);
+
   // Allocate memory.
   double *sqrt_tbl = calloc(2 * (L - 1) + 2, sizeof(*sqrt_tbl));
   SO3_ERROR_MEM_ALLOC_CHECK(sqrt_tbl);
@@ -969,14 +1009,14 @@ void so3_core_inverse_direct(
   // Compute Fmnm'
   // TODO: Currently m is fastest-varying, then n, then m'.
   // Should this order be changed to m-m'-n?
-  complex double *Fmnm = calloc((2 * L - 1) * (2 * L - 1) * (2 * N - 1), sizeof(*Fmnm));
+  complex double *Fmnm =
+      so3_alloc_large((2 * M - 1) * (2 * L - 1) * (2 * N - 1), sizeof(*Fmnm));
   SO3_ERROR_MEM_ALLOC_CHECK(Fmnm);
-  int m_offset = L - 1;
-  int m_stride = 2 * L - 1;
+  int m_offset = M - 1;
+  int m_stride = 2 * M - 1;
   int n_offset = N - 1;
   int n_stride = 2 * N - 1;
   int mm_offset = L - 1;
-  int mm_stride = 2 * L - 1;
 
   int n_start, n_stop, n_inc;
 
@@ -990,9 +1030,38 @@ void so3_core_inverse_direct(
   int dl_offset = ssht_dl_get_offset(L, SSHT_DL_QUARTER);
   int dl_stride = ssht_dl_get_stride(L, SSHT_DL_QUARTER);
 
-  complex double *mn_factors = calloc((2 * L - 1) * (2 * N - 1), sizeof *mn_factors);
+  // Extent of the entries of every row of the Wigner plane above the
+  // tolerance, if negligible entries are skipped.
+  int *dl_mlim = NULL;
+  if (parameters->dl_tolerance > 0.0) {
+    dl_mlim = malloc(L * sizeof *dl_mlim);
+    SO3_ERROR_MEM_ALLOC_CHECK(dl_mlim);
+  }
+
+  complex double *mn_factors = calloc((2 * M - 1) * (2 * N - 1), sizeof *mn_factors);
   SO3_ERROR_MEM_ALLOC_CHECK(mn_factors);
 
+  // Kernel specialised for the n-mode and reality of this transform.
+  so3_kernel_args_t kernel_args = {
+      .parameters = parameters,
+      .L = L,
+      .M = M,
+      .N = N,
+      .dl = dl,
+      .dl_offset = dl_offset,
+      .dl_stride = dl_stride,
+      .dl_mlim = dl_mlim,
+      .signs = signs,
+      .exps = exps,
+      .mn_factors = mn_factors,
+      .layout = {
+          .origin = m_offset + m_stride * (n_offset + n_stride * mm_offset),
+          .m_step = 1,
+          .m_neg_shift = 0,
+          .n_step = m_stride,
+          .mm_step = m_stride * n_stride}};
+  so3_kernel_inverse_t kernel = so3_kernel_inverse_get(n_mode, 0);
+
   // TODO: SSHT starts this loop from MAX(L0, abs(spin)).
   // Can we use a similar optimisation? el can probably
   // be limited by n, but then we'd need to switch the
@@ -1035,87 +1104,14 @@ void so3_core_inverse_direct(
     }
 
     // Compute Fmnm' contribution for current el.
-
-    // Factor which depends only on el.
-    double elfactor = (2.0 * el + 1.0) / (8.0 * SO3_PI * SO3_PI);
-
-    switch (n_mode) {
-    case SO3_N_MODE_ALL:
-      n_start = MAX(-N + 1, -el);
-      n_stop = MIN(N - 1, el);
-      n_inc = 1;
-      break;
-    case SO3_N_MODE_EVEN:
-      n_start = MAX(-N + 1, -el);
-      n_start += (-n_start) % 2;
-      n_stop = MIN(N - 1, el);
-      n_stop -= n_stop % 2;
-      n_inc = 2;
-      break;
-    case SO3_N_MODE_ODD:
-      n_start = MAX(-N + 1, -el);
-      n_start += 1 + n_start % 2;
-      n_stop = MIN(N - 1, el);
-      n_stop -= 1 - n_stop % 2;
-      n_inc = 2;
-      break;
-    case SO3_N_MODE_MAXIMUM:
-      if (el < N - 1)
-        continue;
-      n_start = -N + 1;
-      n_stop = N - 1;
-      n_inc = MAX(1, 2 * N - 2);
-      break;
-    case SO3_N_MODE_L:
-      if (el >= N)
-        continue;
-      n_start = -el;
-      n_stop = el;
-      n_inc = MAX(1, 2 * el);
-      break;
-    default:
-      SO3_ERROR_GENERIC("Invalid n-mode.");
-    }
-
-    // Factors which do not depend on m'.
-    for (n = n_start; n <= n_stop; n += n_inc)
-      for (m = -el; m <= el; ++m) {
-        int ind;
-        so3_sampling_elmn2ind(&ind, el, m, n, parameters);
-        int mod = ((n - m) % 4 + 4) % 4;
-        mn_factors[m + m_offset + m_stride * (n + n_offset)] = flmn[ind] * exps[mod];
-      }
-
-    for (mm = 0; mm <= el; ++mm) {
-      // These signs are needed for the symmetry relations of
-      // Wigner symbols.
-      double elmmsign = signs[el] * signs[mm];
-
-      // TODO: If the conditional for elnsign is a bottleneck
-      // this loop can be split up just like the inner loop.
-      for (n = n_start; n <= n_stop; n += n_inc) {
-        double elnsign = n >= 0 ? 1.0 : elmmsign;
-        // Factor which does not depend on m.
-        double elnmm_factor =
-            elfactor * elnsign * dl[abs(n) + dl_offset + mm * dl_stride];
-        for (m = -el; m < 0; ++m)
-          Fmnm
-              [m + m_offset +
-               m_stride * (n + n_offset + n_stride * (mm + mm_offset))] +=
-              elnmm_factor * mn_factors[m + m_offset + m_stride * (n + n_offset)] *
-              elmmsign * dl[-m + dl_offset + mm * dl_stride];
-        for (m = 0; m <= el; ++m)
-          Fmnm
-              [m + m_offset +
-               m_stride * (n + n_offset + n_stride * (mm + mm_offset))] +=
-              elnmm_factor * mn_factors[m + m_offset + m_stride * (n + n_offset)] *
-              dl[m + dl_offset + mm * dl_stride];
-      }
-    }
+    if (dl_mlim)
+      so3_kernel_dl_mlim(dl_mlim, &kernel_args, el, parameters->dl_tolerance);
+    kernel(Fmnm, flmn, el, &kernel_args);
   }
 
   // Free dl memory.
   free(dl);
+  free(dl_mlim);
   if (dl_method == SSHT_DL_RISBO)
     free(dl8);
 
@@ -1148,38 +1144,43 @@ void so3_core_inverse_direct(
   // Use symmetry to compute Fmnm' for negative m'.
   for (mm = -L + 1; mm < 0; ++mm)
     for (n = n_start; n <= n_stop; n += n_inc)
-      for (m = -L + 1; m <= L - 1; ++m)
+      for (m = -M + 1; m <= M - 1; ++m)
         Fmnm[m + m_offset + m_stride * (n + n_offset + n_stride * (mm + mm_offset))] =
             signs[abs(m + n) % 2] *
             Fmnm
                 [m + m_offset +
                  m_stride * (n + n_offset + n_stride * (-mm + mm_offset))];
 
-  // Apply phase modulation to account for sampling offset.
-  for (mm = -L + 1; mm <= L - 1; ++mm) {
-    complex double mmfactor = cexp(I * mm * SO3_PI / (2.0 * L - 1.0));
-    for (n = n_start; n <= n_stop; n += n_inc)
-      for (m = -L + 1; m <= L - 1; ++m)
-        Fmnm[m + m_offset + m_stride * (n + n_offset + n_stride * (mm + mm_offset))] *=
-            mmfactor;
+  // Apply phase modulation to account for sampling offset. MWSS sampling
+  // starts at the north pole, so there is no offset to account for.
+  if (sampling == SO3_SAMPLING_MW) {
+    for (mm = -L + 1; mm <= L - 1; ++mm) {
+      complex double mmfactor = cexp(I * mm * SO3_PI / (2.0 * L - 1.0));
+      for (n = n_start; n <= n_stop; n += n_inc)
+        for (m = -M + 1; m <= M - 1; ++m)
+          Fmnm
+              [m + m_offset +
+               m_stride * (n + n_offset + n_stride * (mm + mm_offset))] *= mmfactor;
+    }
   }
 
   // Allocate space for function values.
-  complex double *fext = calloc((2 * L - 1) * (2 * L - 1) * (2 * N - 1), sizeof(*fext));
+  complex double *fext =
+      so3_alloc_large(nalpha * nbeta_ext * (2 * N - 1), sizeof(*fext));
   SO3_ERROR_MEM_ALLOC_CHECK(fext);
 
   // Set up plan before initialising array.
-  fftw_plan plan = fftw_plan_dft_3d(
-      2 * N - 1, 2 * L - 1, 2 * L - 1, fext, fext, FFTW_BACKWARD, FFTW_ESTIMATE);
+  so3_fft_plan_t *plan = so3_fft_plan_dft_3d(
+      2 * N - 1, nbeta_ext, nalpha, fext, fext, SO3_FFT_BACKWARD, SO3_FFT_ESTIMATE);
 
   // Apply spatial shift.
   for (mm = -L + 1; mm <= L - 1; ++mm) {
-    int mm_shift = mm < 0 ? 2 * L - 1 : 0;
+    int mm_shift = mm < 0 ? nbeta_ext : 0;
     for (n = n_start; n <= n_stop; n += n_inc) {
       int n_shift = n < 0 ? 2 * N - 1 : 0;
-      for (m = -L + 1; m <= L - 1; ++m) {
-        int m_shift = m < 0 ? 2 * L - 1 : 0;
-        fext[m + m_shift + m_stride * (mm + mm_shift + mm_stride * (n + n_shift))] =
+      for (m = -M + 1; m <= M - 1; ++m) {
+        int m_shift = m < 0 ? nalpha : 0;
+        fext[m + m_shift + nalpha * (mm + mm_shift + nbeta_ext * (n + n_shift))] =
             Fmnm
                 [m + m_offset +
                  m_stride * (n + n_offset + n_stride * (mm + mm_offset))];
@@ -1188,25 +1189,25 @@ void so3_core_inverse_direct(
   }
 
   // Free Fmnm' memory.
-  free(Fmnm);
+  so3_alloc_free(Fmnm);
 
   // Perform 3D FFT.
-  fftw_execute(plan);
-  fftw_destroy_plan(plan);
+  so3_fft_execute(plan);
+  so3_fft_destroy_plan(plan);
 
   // Extract f from the extended torus.
   int a, b, g;
-  int a_stride = 2 * L - 1;
-  int b_ext_stride = 2 * L - 1;
-  int b_stride = L;
+  int a_stride = nalpha;
+  int b_ext_stride = nbeta_ext;
+  int b_stride = nbeta;
   for (g = 0; g < 2 * N - 1; ++g)
-    for (b = 0; b < L; ++b)
-      for (a = 0; a < 2 * L - 1; ++a)
+    for (b = 0; b < nbeta; ++b)
+      for (a = 0; a < nalpha; ++a)
         f[a + a_stride * (b + b_stride * (g))] =
             fext[a + a_stride * (b + b_ext_stride * (g))];
 
   // Free fext memory.
-  free(fext);
+  so3_alloc_free(fext);
 
   if (verbosity > 0)
     printf("%sInverse transform computed!\n", SO3_PROMPT);
@@ -1225,7 +1226,8 @@ void so3_core_inverse_direct(
  * \param[out] flmn Harmonic coefficients. If \link so3_parameters_t::n_mode n_mode
  *                  \endlink is different from \link SO3_N_MODE_ALL \endlink,
  *                  this array has to be nulled before being passed to the function.
- * \param[in] f Function on sphere. Provide a buffer of size (2*L-1)*L*(2*N-1).
+ * \param[in] f Function on sphere. Provide a buffer of size (2*L-1)*L*(2*N-1)
+ *              for MW sampling or 2*L*(L+1)*(2*N-1) for MWSS sampling.
  * \param[in]  parameters A fully populated parameters object. The \link
  *                        so3_parameters_t::reality reality\endlink flag
  *                        is ignored. Use \link so3_core_forward_via_ssht_real
@@ -1237,7 +1239,7 @@ void so3_core_inverse_direct(
  */
 void so3_core_forward_direct(
     complex double *flmn, const complex double *f, const so3_parameters_t *parameters) {
-  int L0, L, N;
+  int L0, L, N, M;
   so3_sampling_t sampling;
   so3_storage_t storage;
   so3_n_mode_t n_mode;
@@ -1247,6 +1249,7 @@ void so3_core_forward_direct(
 
   L0 = parameters->L0;
   L = parameters->L;
+  M = so3_sampling_mlim(parameters);
   N = parameters->N;
   sampling = parameters->sampling_scheme;
   storage = parameters->storage;
@@ -1258,7 +1261,10 @@ void so3_core_forward_direct(
 
   // Print messages depending on verbosity level.
   if (verbosity > 0) {
-    printf("%sComputing forward transform using MW sampling with\n", SO3_PROMPT);
+    printf(
+        "%sComputing forward transform using %s sampling with\n",
+        SO3_PROMPT,
+        sampling == SO3_SAMPLING_MW ? "MW" : "MWSS");
     printf("%sparameters  (L, N, reality) = (%d, %d, FALSE)\n", SO3_PROMPT, L, N);
     if (verbosity > 1)
       printf(
@@ -1267,15 +1273,18 @@ void so3_core_forward_direct(
           storage);
   }
 
-  int m_stride = 2 * L - 1;
-  int m_offset = L - 1;
+  int m_stride = 2 * M - 1;
+  int m_offset = M - 1;
   // unused: int n_stride = 2*N-1;
   int n_offset = N - 1;
   int mm_stride = 2 * L - 1;
   int mm_offset = L - 1;
-  int a_stride = 2 * L - 1;
-  int b_stride = L;
-  int bext_stride = 2 * L - 1;
+  // Sizes of the sampling grid and of its periodic extension in beta.
+  int nalpha, nbeta, nbeta_ext;
+  so3_core_grid_sizes(&nalpha, &nbeta, &nbeta_ext, parameters);
+  int a_stride = nalpha;
+  int b_stride = nbeta;
+  int bext_stride = nbeta_ext;
   // unused: int g_stride = 2*N-1;
 
   int n_start, n_stop, n_inc;
@@ -1329,18 +1338,19 @@ void so3_core_forward_direct(
   for (mm = -L + 1; mm <= L - 1; ++mm)
     expsmm[mm + mm_offset] = cexp(-I * mm * SSHT_PI / (2.0 * L - 1.0));
 
-  double norm_factor = 1.0 / (2.0 * L - 1.0) / (2.0 * N - 1.0);
+  double norm_factor = 1.0 / nalpha / (2.0 * N - 1.0);
 
   // Compute Fourier transform over alpha and gamma, i.e. compute Fmn(b).
-  complex double *Fmnb = calloc((2 * L - 1) * (2 * L - 1) * (2 * N - 1), sizeof(*Fmnb));
+  complex double *Fmnb =
+      so3_alloc_large(nbeta_ext * (2 * M - 1) * (2 * N - 1), sizeof(*Fmnb));
   SO3_ERROR_MEM_ALLOC_CHECK(Fmnb);
-  complex double *inout = calloc((2 * L - 1) * (2 * N - 1), sizeof(*inout));
+  complex double *inout = calloc(nalpha * (2 * N - 1), sizeof(*inout));
   SO3_ERROR_MEM_ALLOC_CHECK(inout);
-  fftw_plan plan =
-      fftw_plan_dft_2d(2 * N - 1, 2 * L - 1, inout, inout, FFTW_FORWARD, FFTW_ESTIMATE);
+  so3_fft_plan_t *plan =
+      so3_fft_plan_dft_2d(2 * N - 1, nalpha, inout, inout, SO3_FFT_FORWARD, SO3_FFT_ESTIMATE);
 
   int b, g;
-  for (b = 0; b < L; ++b) {
+  for (b = 0; b < nbeta; ++b) {
     // TODO: This memcpy loop could probably be avoided by using
     // a more elaborate FFTW plan which performs the FFT directly
     // over the 1st and 3rd dimensions of f.
@@ -1349,60 +1359,65 @@ void so3_core_forward_direct(
           inout + g * a_stride,
           f + 0 + a_stride * (b + b_stride * (g)),
           a_stride * sizeof(*f));
-    fftw_execute_dft(plan, inout, inout);
+    so3_fft_execute_dft(plan, inout, inout);
 
     // Apply spatial shift and normalisation factor
     for (n = n_start; n <= n_stop; n += n_inc) {
       int n_shift = n < 0 ? 2 * N - 1 : 0;
-      for (m = -L + 1; m <= L - 1; ++m) {
-        int m_shift = m < 0 ? 2 * L - 1 : 0;
+      for (m = -M + 1; m <= M - 1; ++m) {
+        int m_shift = m < 0 ? nalpha : 0;
         Fmnb[b + bext_stride * (m + m_offset + m_stride * (n + n_offset))] =
-            inout[m + m_shift + m_stride * (n + n_shift)] * norm_factor;
+            inout[m + m_shift + a_stride * (n + n_shift)] * norm_factor;
       }
     }
   }
-  fftw_destroy_plan(plan);
+  so3_fft_destroy_plan(plan);
 
   // Extend Fmnb periodically.
   for (n = n_start; n <= n_stop; n += n_inc)
-    for (m = -L + 1; m <= L - 1; ++m) {
+    for (m = -M + 1; m <= M - 1; ++m) {
       int signmn = signs[abs(m + n) % 2];
-      for (b = L; b < 2 * L - 1; ++b)
+      for (b = nbeta; b < nbeta_ext; ++b)
         Fmnb[b + bext_stride * (m + m_offset + m_stride * (n + n_offset))] =
             signmn * Fmnb
-                         [(2 * L - 2 - b) +
+                         [(2 * (nbeta - 1) - b) +
                           bext_stride * (m + m_offset + m_stride * (n + n_offset))];
     }
 
   // Compute Fourier transform over beta, i.e. compute Fmnm'.
-  complex double *Fmnm = calloc((2 * L - 1) * (2 * L - 1) * (2 * N - 1), sizeof(*Fmnm));
+  complex double *Fmnm =
+      so3_alloc_large((2 * M - 1) * (2 * L - 1) * (2 * N - 1), sizeof(*Fmnm));
   SO3_ERROR_MEM_ALLOC_CHECK(Fmnm);
 
-  plan = fftw_plan_dft_1d(2 * L - 1, inout, inout, FFTW_FORWARD, FFTW_ESTIMATE);
+  plan = so3_fft_plan_dft_1d(nbeta_ext, inout, inout, SO3_FFT_FORWARD, SO3_FFT_ESTIMATE);
   for (n = n_start; n <= n_stop; n += n_inc)
-    for (m = -L + 1; m <= L - 1; ++m) {
+    for (m = -M + 1; m <= M - 1; ++m) {
       memcpy(
           inout,
           Fmnb + 0 + bext_stride * (m + m_offset + m_stride * (n + n_offset)),
           bext_stride * sizeof(*Fmnb));
-      fftw_execute_dft(plan, inout, inout);
+      so3_fft_execute_dft(plan, inout, inout);
 
       // Apply spatial shift and normalisation factor
       for (mm = -L + 1; mm <= L - 1; ++mm) {
-        int mm_shift = mm < 0 ? 2 * L - 1 : 0;
+        int mm_shift = mm < 0 ? nbeta_ext : 0;
         Fmnm[mm + mm_offset + mm_stride * (m + m_offset + m_stride * (n + n_offset))] =
-            inout[mm + mm_shift] / (2.0 * L - 1.0);
+            inout[mm + mm_shift] / (double)nbeta_ext;
       }
     }
-  fftw_destroy_plan(plan);
+  so3_fft_destroy_plan(plan);
   free(inout);
 
-  // Apply phase modulation to account for sampling offset.
-  for (n = n_start; n <= n_stop; n += n_inc)
-    for (m = -L + 1; m <= L - 1; ++m)
-      for (mm = -L + 1; mm <= L - 1; ++mm)
-        Fmnm[mm + mm_offset + mm_stride * (m + m_offset + m_stride * (n + n_offset))] *=
-            expsmm[mm + mm_offset];
+  // Apply phase modulation to account for sampling offset. MWSS sampling
+  // starts at the north pole, so there is no offset to account for.
+  if (sampling == SO3_SAMPLING_MW)
+    for (n = n_start; n <= n_stop; n += n_inc)
+      for (m = -M + 1; m <= M - 1; ++m)
+        for (mm = -L + 1; mm <= L - 1; ++mm)
+          Fmnm
+              [mm + mm_offset +
+               mm_stride * (m + m_offset + m_stride * (n + n_offset))] *=
+              expsmm[mm + mm_offset];
 
   // Compute weights.
   complex double *w = calloc(4 * L - 3, sizeof(*w));
@@ -1416,10 +1431,10 @@ void so3_core_forward_direct(
   SO3_ERROR_MEM_ALLOC_CHECK(wr);
   inout = calloc(4 * L - 3, sizeof(*inout));
   SO3_ERROR_MEM_ALLOC_CHECK(inout);
-  fftw_plan plan_bwd =
-      fftw_plan_dft_1d(4 * L - 3, inout, inout, FFTW_BACKWARD, FFTW_MEASURE);
-  fftw_plan plan_fwd =
-      fftw_plan_dft_1d(4 * L - 3, inout, inout, FFTW_FORWARD, FFTW_MEASURE);
+  so3_fft_plan_t *plan_bwd =
+      so3_fft_plan_dft_1d(4 * L - 3, inout, inout, SO3_FFT_BACKWARD, SO3_FFT_MEASURE);
+  so3_fft_plan_t *plan_fwd =
+      so3_fft_plan_dft_1d(4 * L - 3, inout, inout, SO3_FFT_FORWARD, SO3_FFT_MEASURE);
 
   // Apply spatial shift.
   for (mm = 1; mm <= 2 * L - 2; ++mm)
@@ -1427,7 +1442,7 @@ void so3_core_forward_direct(
   for (mm = -2 * (L - 1); mm <= 0; ++mm)
     inout[mm + w_offset] = w[mm + 2 * (L - 1) + w_offset];
 
-  fftw_execute_dft(plan_bwd, inout, inout);
+  so3_fft_execute_dft(plan_bwd, inout, inout);
 
   // Apply spatial shift.
   for (mm = 0; mm <= 2 * L - 2; ++mm)
@@ -1438,10 +1453,11 @@ void so3_core_forward_direct(
   // Compute Gmnm' by convolution implemented as product in real space.
   complex double *Fmnm_pad = calloc(4 * L - 3, sizeof(*Fmnm_pad));
   SO3_ERROR_MEM_ALLOC_CHECK(Fmnm_pad);
-  complex double *Gmnm = calloc((2 * L - 1) * (2 * L - 1) * (2 * N - 1), sizeof(*Gmnm));
+  complex double *Gmnm =
+      so3_alloc_large((2 * M - 1) * (2 * L - 1) * (2 * N - 1), sizeof(*Gmnm));
   SO3_ERROR_MEM_ALLOC_CHECK(Gmnm);
   for (n = n_start; n <= n_stop; n += n_inc)
-    for (m = -L + 1; m <= L - 1; ++m) {
+    for (m = -M + 1; m <= M - 1; ++m) {
 
       // Zero-pad Fmnm'.
       for (mm = -2 * (L - 1); mm <= -L; ++mm)
@@ -1458,7 +1474,7 @@ void so3_core_forward_direct(
       for (mm = -2 * (L - 1); mm <= 0; ++mm)
         inout[mm + w_offset] = Fmnm_pad[mm + 2 * (L - 1) + w_offset];
       // Compute IFFT of Fmnm'.
-      fftw_execute_dft(plan_bwd, inout, inout);
+      so3_fft_execute_dft(plan_bwd, inout, inout);
       // Apply spatial shift.
       for (mm = 0; mm <= 2 * L - 2; ++mm)
         Fmnm_pad[mm + w_offset] = inout[mm - 2 * (L - 1) + w_offset];
@@ -1476,7 +1492,7 @@ void so3_core_forward_direct(
       for (mm = -2 * (L - 1); mm <= 0; ++mm)
         inout[mm + w_offset] = Fmnm_pad[mm + 2 * (L - 1) + w_offset];
       // Compute Gmnm' by FFT.
-      fftw_execute_dft(plan_fwd, inout, inout);
+      so3_fft_execute_dft(plan_fwd, inout, inout);
       // Apply spatial shift.
       for (mm = 0; mm <= 2 * L - 2; ++mm)
         Fmnm_pad[mm + w_offset] = inout[mm - 2 * (L - 1) + w_offset];
@@ -1488,8 +1504,8 @@ void so3_core_forward_direct(
         Gmnm[m + m_offset + m_stride * (mm + mm_offset + mm_stride * (n + n_offset))] =
             Fmnm_pad[mm + w_offset] * 4.0 * SSHT_PI * SSHT_PI / (4.0 * L - 3.0);
     }
-  fftw_destroy_plan(plan_bwd);
-  fftw_destroy_plan(plan_fwd);
+  so3_fft_destroy_plan(plan_bwd);
+  so3_fft_destroy_plan(plan_fwd);
 
   // Compute flmn.
   double *dl, *dl8 = NULL;
@@ -1501,9 +1517,39 @@ void so3_core_forward_direct(
   }
   int dl_offset = ssht_dl_get_offset(L, SSHT_DL_QUARTER);
   int dl_stride = ssht_dl_get_stride(L, SSHT_DL_QUARTER);
+
+  // Extent of the entries of every row of the Wigner plane above the
+  // tolerance, if negligible entries are skipped.
+  int *dl_mlim = NULL;
+  if (parameters->dl_tolerance > 0.0) {
+    dl_mlim = malloc(L * sizeof *dl_mlim);
+    SO3_ERROR_MEM_ALLOC_CHECK(dl_mlim);
+  }
+
+  // Kernel specialised for the n-mode and reality of this transform.
+  so3_kernel_args_t kernel_args = {
+      .parameters = parameters,
+      .L = L,
+      .M = M,
+      .N = N,
+      .dl = dl,
+      .dl_offset = dl_offset,
+      .dl_stride = dl_stride,
+      .dl_mlim = dl_mlim,
+      .signs = signs,
+      .exps = exps,
+      .mn_factors = NULL,
+      .layout = {
+          .origin = m_offset + m_stride * (mm_offset + mm_stride * n_offset),
+          .m_step = 1,
+          .m_neg_shift = 0,
+          .n_step = m_stride * mm_stride,
+          .mm_step = m_stride}};
+  so3_kernel_forward_t kernel = so3_kernel_forward_get(n_mode, 0);
+
   for (n = -N + 1; n <= N - 1; ++n)
     for (el = abs(n); el < L; ++el)
-      for (m = -el; m <= el; ++m) {
+      for (m = -MIN(el, M - 1); m <= MIN(el, M - 1); ++m) {
         int ind;
         so3_sampling_elmn2ind(&ind, el, m, n, parameters);
         flmn[ind] = 0.0;
@@ -1547,86 +1593,22 @@ void so3_core_forward_direct(
     }
 
     // Compute flmn for current el.
-
-    switch (n_mode) {
-    case SO3_N_MODE_ALL:
-      n_start = MAX(-N + 1, -el);
-      n_stop = MIN(N - 1, el);
-      n_inc = 1;
-      break;
-    case SO3_N_MODE_EVEN:
-      n_start = MAX(-N + 1, -el);
-      n_start += (-n_start) % 2;
-      n_stop = MIN(N - 1, el);
-      n_stop -= n_stop % 2;
-      n_inc = 2;
-      break;
-    case SO3_N_MODE_ODD:
-      n_start = MAX(-N + 1, -el);
-      n_start += 1 + n_start % 2;
-      n_stop = MIN(N - 1, el);
-      n_stop -= 1 - n_stop % 2;
-      n_inc = 2;
-      break;
-    case SO3_N_MODE_MAXIMUM:
-      if (el < N - 1)
-        continue;
-      n_start = -N + 1;
-      n_stop = N - 1;
-      n_inc = MAX(1, 2 * N - 2);
-      break;
-    case SO3_N_MODE_L:
-      if (el >= N)
-        continue;
-      n_start = -el;
-      n_stop = el;
-      n_inc = MAX(1, 2 * el);
-      break;
-    default:
-      SO3_ERROR_GENERIC("Invalid n-mode.");
-    }
-
-    // TODO: Pull out a few multiplications into precomputations
-    // or split up loops to avoid conditionals to check signs.
-    for (mm = -el; mm <= el; ++mm) {
-      // These signs are needed for the symmetry relations of
-      // Wigner symbols.
-      double elmmsign = signs[el] * signs[abs(mm)];
-
-      for (n = n_start; n <= n_stop; n += n_inc) {
-        double mmsign = mm >= 0 ? 1.0 : signs[el] * signs[abs(n)];
-        double elnsign = n >= 0 ? 1.0 : elmmsign;
-
-        // Factor which does not depend on m.
-        double elnmm_factor =
-            mmsign * elnsign * dl[abs(n) + dl_offset + abs(mm) * dl_stride];
-
-        for (m = -el; m <= el; ++m) {
-          mmsign = mm >= 0 ? 1.0 : signs[el] * signs[abs(m)];
-          double elmsign = m >= 0 ? 1.0 : elmmsign;
-          int ind;
-          so3_sampling_elmn2ind(&ind, el, m, n, parameters);
-          int mod = ((m - n) % 4 + 4) % 4;
-          flmn[ind] += exps[mod] * elnmm_factor * mmsign * elmsign *
-                       dl[abs(m) + dl_offset + abs(mm) * dl_stride] *
-                       Gmnm
-                           [m + m_offset +
-                            m_stride * (mm + mm_offset + mm_stride * (n + n_offset))];
-        }
-      }
-    }
+    if (dl_mlim)
+      so3_kernel_dl_mlim(dl_mlim, &kernel_args, el, parameters->dl_tolerance);
+    kernel(flmn, Gmnm, el, &kernel_args);
   }
 
   free(dl);
+  free(dl_mlim);
   if (dl_method == SSHT_DL_RISBO)
     free(dl8);
-  free(Fmnb);
-  free(Fmnm);
+  so3_alloc_free(Fmnb);
+  so3_alloc_free(Fmnm);
   free(inout);
   free(w);
   free(wr);
   free(Fmnm_pad);
-  free(Gmnm);
+  so3_alloc_free(Gmnm);
   free(sqrt_tbl);
   free(signs);
   free(exps);
@@ -1640,7 +1622,8 @@ void so3_core_forward_direct(
  * Compute inverse Wigner transform for a real signal directly (without using
  * SSHT).
  *
- * \param[out] f Function on sphere. Provide a buffer of size (2*L-1)*L*(2*N-1).
+ * \param[out] f Function on sphere. Provide a buffer of size (2*L-1)*L*(2*N-1)
+ *               for MW sampling or 2*L*(L+1)*(2*N-1) for MWSS sampling.
  * \param[in] flmn Harmonic coefficients for n >= 0. Note that for n = 0, these have to
  *                 respect the symmetry flm0* = (-1)^(m+n)*fl-m0, and hence fl00 has to
  * be real. \param[in]  parameters A fully populated parameters object. The \link
@@ -1655,7 +1638,7 @@ void so3_core_forward_direct(
 void so3_core_inverse_direct_real(
     double *f, const complex double *flmn, const so3_parameters_t *parameters) {
 
-  int L0, L, N;
+  int L0, L, N, M;
   so3_sampling_t sampling;
   so3_storage_t storage;
   so3_n_mode_t n_mode;
@@ -1665,10 +1648,10 @@ void so3_core_inverse_direct_real(
 
   L0 = parameters->L0;
   L = parameters->L;
+  M = so3_sampling_mlim(parameters);
   N = parameters->N;
   sampling = parameters->sampling_scheme;
   storage = parameters->storage;
-  // TODO: Add optimisations for all n-modes.
   n_mode = parameters->n_mode;
   dl_method = parameters->dl_method;
   verbosity = parameters->verbosity;
@@ -1676,7 +1659,10 @@ void so3_core_inverse_direct_real(
 
   // Print messages depending on verbosity level.
   if (verbosity > 0) {
-    printf("%sComputing inverse transform using MW sampling with\n", SO3_PROMPT);
+    printf(
+        "%sComputing inverse transform using %s sampling with\n",
+        SO3_PROMPT,
+        sampling == SO3_SAMPLING_MW ? "MW" : "MWSS");
     printf("%sparameters  (L, N, reality) = (%d, %d, FALSE)\n", SO3_PROMPT, L, N);
     if (verbosity > 1)
       printf(
@@ -1688,6 +1674,10 @@ void so3_core_inverse_direct_real(
   // Iterators
   int el, m, n, mm; // mm for m'
 
+  // Sizes of the sampling grid and of its periodic extension in beta.
+  int nalpha, nbeta, nbeta_ext;
+  so3_core_grid_sizes(&nalpha, &nbeta, &nbeta_ext, parameters);
+
   // Allocate memory.
   double *sqrt_tbl = calloc(2 * (L - 1) + 2, sizeof(*sqrt_tbl));
   SO3_ERROR_MEM_ALLOC_CHECK(sqrt_tbl);
@@ -1708,16 +1698,19 @@ void so3_core_inverse_direct_real(
     exps[i] = cexp(I * SO3_PION2 * i);
 
   // Compute Fmnm'
-  // TODO: Currently m is fastest-varying, then n, then m'.
-  // Should this order be changed to m-m'-n?
-  complex double *Fmnm = calloc((2 * L - 1) * (2 * L - 1) * N, sizeof(*Fmnm));
+  // Fmnm' is accumulated directly into the Hermitian half-spectrum of the
+  // extended torus, with m and m' already shifted to FFT order and n as the
+  // inner (redundant) dimension. The c2r FFT is then performed in place,
+  // which requires each row of 2*N-1 real values to be padded to 2*N.
+  complex double *Fmnm = so3_alloc_large(nbeta_ext * nalpha * N, sizeof(*Fmnm));
   SO3_ERROR_MEM_ALLOC_CHECK(Fmnm);
-  int m_offset = L - 1;
-  int m_stride = 2 * L - 1;
-  int n_offset = 0;
+  double *fext = (double *)Fmnm;
   int n_stride = N;
-  int mm_offset = L - 1;
-  // unused: int mm_stride = 2*L-1;
+
+  // Set up plan before initialising array.
+  // The redundant dimension needs to be the last one.
+  so3_fft_plan_t *plan =
+      so3_fft_plan_dft_c2r_3d(nbeta_ext, nalpha, 2 * N - 1, Fmnm, fext, SO3_FFT_ESTIMATE);
 
   int n_start, n_stop, n_inc;
 
@@ -1731,9 +1724,38 @@ void so3_core_inverse_direct_real(
   int dl_offset = ssht_dl_get_offset(L, SSHT_DL_QUARTER);
   int dl_stride = ssht_dl_get_stride(L, SSHT_DL_QUARTER);
 
-  complex double *mn_factors = calloc((2 * L - 1) * N, sizeof *mn_factors);
+  // Extent of the entries of every row of the Wigner plane above the
+  // tolerance, if negligible entries are skipped.
+  int *dl_mlim = NULL;
+  if (parameters->dl_tolerance > 0.0) {
+    dl_mlim = malloc(L * sizeof *dl_mlim);
+    SO3_ERROR_MEM_ALLOC_CHECK(dl_mlim);
+  }
+
+  complex double *mn_factors = calloc((2 * M - 1) * N, sizeof *mn_factors);
   SO3_ERROR_MEM_ALLOC_CHECK(mn_factors);
 
+  // Kernel specialised for the n-mode and reality of this transform.
+  so3_kernel_args_t kernel_args = {
+      .parameters = parameters,
+      .L = L,
+      .M = M,
+      .N = N,
+      .dl = dl,
+      .dl_offset = dl_offset,
+      .dl_stride = dl_stride,
+      .dl_mlim = dl_mlim,
+      .signs = signs,
+      .exps = exps,
+      .mn_factors = mn_factors,
+      .layout = {
+          .origin = 0,
+          .m_step = n_stride,
+          .m_neg_shift = nalpha * n_stride,
+          .n_step = 1,
+          .mm_step = nalpha * n_stride}};
+  so3_kernel_inverse_t kernel = so3_kernel_inverse_get(n_mode, 1);
+
   // TODO: SSHT starts this loop from MAX(L0, abs(spin)).
   // Can we use a similar optimisation? el can probably
   // be limited by n, but then we'd need to switch the
@@ -1776,81 +1798,14 @@ void so3_core_inverse_direct_real(
     }
 
     // Compute Fmnm' contribution for current el.
-
-    // Factor which depends only on el.
-    double elfactor = (2.0 * el + 1.0) / (8.0 * SO3_PI * SO3_PI);
-
-    switch (n_mode) {
-    case SO3_N_MODE_ALL:
-      n_start = 0;
-      n_stop = MIN(N - 1, el);
-      n_inc = 1;
-      break;
-    case SO3_N_MODE_EVEN:
-      n_start = 0;
-      n_stop = MIN(N - 1, el);
-      n_stop -= n_stop % 2;
-      n_inc = 2;
-      break;
-    case SO3_N_MODE_ODD:
-      n_start = 1;
-      n_stop = MIN(N - 1, el);
-      n_stop -= 1 - n_stop % 2;
-      n_inc = 2;
-      break;
-    case SO3_N_MODE_MAXIMUM:
-      if (el < N - 1)
-        continue;
-      n_start = N - 1;
-      n_stop = N - 1;
-      n_inc = 1;
-      break;
-    case SO3_N_MODE_L:
-      if (el >= N)
-        continue;
-      n_start = el;
-      n_stop = el;
-      n_inc = 1;
-      break;
-    default:
-      SO3_ERROR_GENERIC("Invalid n-mode.");
-    }
-
-    // Factors which do not depend on m'.
-    for (n = n_start; n <= n_stop; n += n_inc)
-      for (m = -el; m <= el; ++m) {
-        int ind;
-        so3_sampling_elmn2ind_real(&ind, el, m, n, parameters);
-        int mod = ((n - m) % 4 + 4) % 4;
-        mn_factors[m + m_offset + m_stride * (n + n_offset)] = flmn[ind] * exps[mod];
-      }
-
-    for (mm = 0; mm <= el; ++mm) {
-      // These signs are needed for the symmetry relations of
-      // Wigner symbols.
-      double elmmsign = signs[el] * signs[mm];
-
-      for (n = n_start; n <= n_stop; n += n_inc) {
-        // Factor which does not depend on m.
-        double elnmm_factor = elfactor * dl[n + dl_offset + mm * dl_stride];
-        for (m = -el; m < 0; ++m)
-          Fmnm
-              [m + m_offset +
-               m_stride * (n + n_offset + n_stride * (mm + mm_offset))] +=
-              elnmm_factor * mn_factors[m + m_offset + m_stride * (n + n_offset)] *
-              elmmsign * dl[-m + dl_offset + mm * dl_stride];
-        for (m = 0; m <= el; ++m)
-          Fmnm
-              [m + m_offset +
-               m_stride * (n + n_offset + n_stride * (mm + mm_offset))] +=
-              elnmm_factor * mn_factors[m + m_offset + m_stride * (n + n_offset)] *
-              dl[m + dl_offset + mm * dl_stride];
-      }
-    }
+    if (dl_mlim)
+      so3_kernel_dl_mlim(dl_mlim, &kernel_args, el, parameters->dl_tolerance);
+    kernel(Fmnm, flmn, el, &kernel_args);
   }
 
   // Free dl memory.
   free(dl);
+  free(dl_mlim);
   if (dl_method == SSHT_DL_RISBO)
     free(dl8);
 
@@ -1883,73 +1838,46 @@ void so3_core_inverse_direct_real(
   // Use symmetry to compute Fmnm' for negative m'.
   for (mm = -L + 1; mm < 0; ++mm)
     for (n = n_start; n <= n_stop; n += n_inc)
-      for (m = -L + 1; m <= L - 1; ++m)
-        Fmnm[m + m_offset + m_stride * (n + n_offset + n_stride * (mm + mm_offset))] =
-            signs[abs(m + n) % 2] *
-            Fmnm
-                [m + m_offset +
-                 m_stride * (n + n_offset + n_stride * (-mm + mm_offset))];
-
-  // Apply phase modulation to account for sampling offset.
-  for (mm = -L + 1; mm <= L - 1; ++mm) {
-    complex double mmfactor = cexp(I * mm * SO3_PI / (2.0 * L - 1.0));
-    for (n = n_start; n <= n_stop; n += n_inc)
-      for (m = -L + 1; m <= L - 1; ++m)
-        Fmnm[m + m_offset + m_stride * (n + n_offset + n_stride * (mm + mm_offset))] *=
-            mmfactor;
-  }
-
-  // Allocate space for shifted Fmnm'.
-  complex double *Fmnm_shift =
-      calloc((2 * L - 1) * (2 * L - 1) * N, sizeof(*Fmnm_shift));
-  SO3_ERROR_MEM_ALLOC_CHECK(Fmnm_shift);
-
-  // Allocate space for function values.
-  double *fext = calloc((2 * L - 1) * (2 * L - 1) * (2 * N - 1), sizeof(*fext));
-  SO3_ERROR_MEM_ALLOC_CHECK(fext);
-
-  // Set up plan before initialising array.
-  // The redundant dimension needs to be the last one.
-  fftw_plan plan = fftw_plan_dft_c2r_3d(
-      2 * L - 1, 2 * L - 1, 2 * N - 1, Fmnm_shift, fext, FFTW_ESTIMATE);
-
-  // Apply spatial shift.
-  // This also reshapes the array to make n the inner dimension.
-  for (mm = -L + 1; mm <= L - 1; ++mm) {
-    int mm_shift = mm < 0 ? 2 * L - 1 : 0;
-    for (n = n_start; n <= n_stop; n += n_inc) {
-      for (m = -L + 1; m <= L - 1; ++m) {
-        int m_shift = m < 0 ? 2 * L - 1 : 0;
-        Fmnm_shift[n + n_stride * (m + m_shift + m_stride * (mm + mm_shift))] = Fmnm
-            [m + m_offset + m_stride * (n + n_offset + n_stride * (mm + mm_offset))];
+      for (m = -M + 1; m <= M - 1; ++m) {
+        int m_shift = m < 0 ? nalpha : 0;
+        Fmnm[n + n_stride * (m + m_shift + nalpha * (mm + nbeta_ext))] =
+            signs[abs(m + n) % 2] * Fmnm[n + n_stride * (m + m_shift + nalpha * (-mm))];
       }
+
+  // Apply phase modulation to account for sampling offset. MWSS sampling
+  // starts at the north pole, so there is no offset to account for.
+  if (sampling == SO3_SAMPLING_MW) {
+    for (mm = -L + 1; mm <= L - 1; ++mm) {
+      complex double mmfactor = cexp(I * mm * SO3_PI / (2.0 * L - 1.0));
+      int mm_shift = mm < 0 ? nbeta_ext : 0;
+      for (n = n_start; n <= n_stop; n += n_inc)
+        for (m = -M + 1; m <= M - 1; ++m) {
+          int m_shift = m < 0 ? nalpha : 0;
+          Fmnm[n + n_stride * (m + m_shift + nalpha * (mm + mm_shift))] *= mmfactor;
+        }
     }
   }
 
-  // Free Fmnm' memory.
-  free(Fmnm);
-
-  // Perform 3D FFT.
-  fftw_execute(plan);
-  fftw_destroy_plan(plan);
-
-  free(Fmnm_shift);
+  // Perform 3D FFT in place.
+  so3_fft_execute(plan);
+  so3_fft_destroy_plan(plan);
 
   // Extract f from the extended torus.
   // Again, we reshape the array in the process.
   int a, b, g;
-  int a_stride = 2 * L - 1;
-  // unused: int b_ext_stride = 2*L-1;
-  int b_stride = L;
-  int g_stride = 2 * N - 1;
+  int a_stride = nalpha;
+  // unused: int b_ext_stride = nbeta_ext;
+  int b_stride = nbeta;
+  // Rows of the in-place real output are padded to 2*N values.
+  int g_stride = 2 * N;
   for (g = 0; g < 2 * N - 1; ++g)
-    for (b = 0; b < L; ++b)
-      for (a = 0; a < 2 * L - 1; ++a)
+    for (b = 0; b < nbeta; ++b)
+      for (a = 0; a < nalpha; ++a)
         f[a + a_stride * (b + b_stride * (g))] =
             fext[g + g_stride * (a + a_stride * (b))];
 
-  // Free fext memory.
-  free(fext);
+  // Free Fmnm' memory, which also holds fext.
+  so3_alloc_free(Fmnm);
 
   if (verbosity > 0)
     printf("%sInverse transform computed!\n", SO3_PROMPT);
@@ -1968,7 +1896,8 @@ void so3_core_inverse_direct_real(
  * \param[out] flmn Harmonic coefficients. If \link so3_parameters_t::n_mode n_mode
  *                  \endlink is different from \link SO3_N_MODE_ALL \endlink,
  *                  this array has to be nulled before being past to the function.
- * \param[in] f Function on sphere. Provide a buffer of size (2*L-1)*L*(2*N-1).
+ * \param[in] f Function on sphere. Provide a buffer of size (2*L-1)*L*(2*N-1)
+ *              for MW sampling or 2*L*(L+1)*(2*N-1) for MWSS sampling.
  * \param[in]  parameters A fully populated parameters object. The \link
  *                        so3_parameters_t::reality reality \endlink flag
  *                        is ignored. Use \link so3_core_forward_direct
@@ -1980,7 +1909,7 @@ void so3_core_inverse_direct_real(
  */
 void so3_core_forward_direct_real(
     complex double *flmn, const double *f, const so3_parameters_t *parameters) {
-  int L0, L, N;
+  int L0, L, N, M;
   so3_sampling_t sampling;
   so3_storage_t storage;
   so3_n_mode_t n_mode;
@@ -1990,6 +1919,7 @@ void so3_core_forward_direct_real(
 
   L0 = parameters->L0;
   L = parameters->L;
+  M = so3_sampling_mlim(parameters);
   N = parameters->N;
   sampling = parameters->sampling_scheme;
   storage = parameters->storage;
@@ -2001,7 +1931,10 @@ void so3_core_forward_direct_real(
 
   // Print messages depending on verbosity level.
   if (verbosity > 0) {
-    printf("%sComputing forward transform using MW sampling with\n", SO3_PROMPT);
+    printf(
+        "%sComputing forward transform using %s sampling with\n",
+        SO3_PROMPT,
+        sampling == SO3_SAMPLING_MW ? "MW" : "MWSS");
     printf("%sparameters  (L, N, reality) = (%d, %d, FALSE)\n", SO3_PROMPT, L, N);
     if (verbosity > 1)
       printf(
@@ -2010,15 +1943,18 @@ void so3_core_forward_direct_real(
           storage);
   }
 
-  int m_stride = 2 * L - 1;
-  int m_offset = L - 1;
+  int m_stride = 2 * M - 1;
+  int m_offset = M - 1;
   int n_offset = 0;
   int n_stride = N;
   int mm_stride = 2 * L - 1;
   int mm_offset = L - 1;
-  int a_stride = 2 * L - 1;
-  int b_stride = L;
-  int bext_stride = 2 * L - 1;
+  // Sizes of the sampling grid and of its periodic extension in beta.
+  int nalpha, nbeta, nbeta_ext;
+  so3_core_grid_sizes(&nalpha, &nbeta, &nbeta_ext, parameters);
+  int a_stride = nalpha;
+  int b_stride = nbeta;
+  int bext_stride = nbeta_ext;
   int g_stride = 2 * N - 1;
 
   int n_start, n_stop, n_inc;
@@ -2072,21 +2008,21 @@ void so3_core_forward_direct_real(
   for (mm = -L + 1; mm <= L - 1; ++mm)
     expsmm[mm + mm_offset] = cexp(-I * mm * SSHT_PI / (2.0 * L - 1.0));
 
-  double norm_factor = 1.0 / (2.0 * L - 1.0) / (2.0 * N - 1.0);
+  double norm_factor = 1.0 / nalpha / (2.0 * N - 1.0);
 
   // Compute Fourier transform over alpha and gamma, i.e. compute Fmn(b).
-  complex double *Fmnb = calloc((2 * L - 1) * (2 * L - 1) * N, sizeof(*Fmnb));
+  complex double *Fmnb = so3_alloc_large(nbeta_ext * (2 * M - 1) * N, sizeof(*Fmnb));
   SO3_ERROR_MEM_ALLOC_CHECK(Fmnb);
-  double *fft_in = calloc((2 * L - 1) * (2 * N - 1), sizeof(*fft_in));
+  double *fft_in = calloc(nalpha * (2 * N - 1), sizeof(*fft_in));
   SO3_ERROR_MEM_ALLOC_CHECK(fft_in);
-  complex double *fft_out = calloc((2 * L - 1) * N, sizeof(*fft_out));
+  complex double *fft_out = calloc(nalpha * N, sizeof(*fft_out));
   SO3_ERROR_MEM_ALLOC_CHECK(fft_out);
   // Redundant dimension needs to be last
-  fftw_plan plan =
-      fftw_plan_dft_r2c_2d(2 * L - 1, 2 * N - 1, fft_in, fft_out, FFTW_ESTIMATE);
+  so3_fft_plan_t *plan =
+      so3_fft_plan_dft_r2c_2d(nalpha, 2 * N - 1, fft_in, fft_out, SO3_FFT_ESTIMATE);
 
   int a, b, g;
-  for (b = 0; b < L; ++b) {
+  for (b = 0; b < nbeta; ++b) {
     // TODO: This loop could probably be avoided by using
     // a more elaborate FFTW plan which performs the FFT directly
     // over the 1st and 3rd dimensions of f.
@@ -2095,66 +2031,71 @@ void so3_core_forward_direct_real(
     // new 2D array, to perform a standard 2D FFT there. While
     // we're at it, we also reshape that array such that gamma
     // is the inner dimension, as required by FFTW.
-    for (a = 0; a < 2 * L - 1; ++a)
+    for (a = 0; a < nalpha; ++a)
       for (g = 0; g < 2 * N - 1; ++g)
         fft_in[g + g_stride * (a)] = f[a + a_stride * (b + b_stride * (g))];
 
-    fftw_execute(plan);
+    so3_fft_execute(plan);
 
     // Apply spatial shift and normalisation factor, while
     // reshaping the dimensions once more.
     for (n = n_start; n <= n_stop; n += n_inc) {
-      for (m = -L + 1; m <= L - 1; ++m) {
-        int m_shift = m < 0 ? 2 * L - 1 : 0;
+      for (m = -M + 1; m <= M - 1; ++m) {
+        int m_shift = m < 0 ? nalpha : 0;
         Fmnb[b + bext_stride * (m + m_offset + m_stride * (n + n_offset))] =
             fft_out[n + n_stride * (m + m_shift)] * norm_factor;
       }
     }
   }
-  fftw_destroy_plan(plan);
+  so3_fft_destroy_plan(plan);
 
   // Extend Fmnb periodically.
   for (n = n_start; n <= n_stop; n += n_inc)
-    for (m = -L + 1; m <= L - 1; ++m) {
+    for (m = -M + 1; m <= M - 1; ++m) {
       int signmn = signs[abs(m + n) % 2];
-      for (b = L; b < 2 * L - 1; ++b)
+      for (b = nbeta; b < nbeta_ext; ++b)
         Fmnb[b + bext_stride * (m + m_offset + m_stride * (n + n_offset))] =
             signmn * Fmnb
-                         [(2 * L - 2 - b) +
+                         [(2 * (nbeta - 1) - b) +
                           bext_stride * (m + m_offset + m_stride * (n + n_offset))];
     }
 
   // Compute Fourier transform over beta, i.e. compute Fmnm'.
-  complex double *Fmnm = calloc((2 * L - 1) * (2 * L - 1) * (2 * N - 1), sizeof(*Fmnm));
+  complex double *Fmnm =
+      so3_alloc_large((2 * M - 1) * (2 * L - 1) * (2 * N - 1), sizeof(*Fmnm));
   SO3_ERROR_MEM_ALLOC_CHECK(Fmnm);
-  complex double *inout = calloc(2 * L - 1, sizeof(*inout));
+  complex double *inout = calloc(nbeta_ext, sizeof(*inout));
   SO3_ERROR_MEM_ALLOC_CHECK(inout);
 
-  plan = fftw_plan_dft_1d(2 * L - 1, inout, inout, FFTW_FORWARD, FFTW_ESTIMATE);
+  plan = so3_fft_plan_dft_1d(nbeta_ext, inout, inout, SO3_FFT_FORWARD, SO3_FFT_ESTIMATE);
   for (n = n_start; n <= n_stop; n += n_inc)
-    for (m = -L + 1; m <= L - 1; ++m) {
+    for (m = -M + 1; m <= M - 1; ++m) {
       memcpy(
           inout,
           Fmnb + 0 + bext_stride * (m + m_offset + m_stride * (n + n_offset)),
           bext_stride * sizeof(*Fmnb));
-      fftw_execute(plan);
+      so3_fft_execute(plan);
 
       // Apply spatial shift and normalisation factor
       for (mm = -L + 1; mm <= L - 1; ++mm) {
-        int mm_shift = mm < 0 ? 2 * L - 1 : 0;
+        int mm_shift = mm < 0 ? nbeta_ext : 0;
         Fmnm[mm + mm_offset + mm_stride * (m + m_offset + m_stride * (n + n_offset))] =
-            inout[mm + mm_shift] / (2.0 * L - 1.0);
+            inout[mm + mm_shift] / (double)nbeta_ext;
       }
     }
-  fftw_destroy_plan(plan);
+  so3_fft_destroy_plan(plan);
   free(inout);
 
-  // Apply phase modulation to account for sampling offset.
-  for (n = n_start; n <= n_stop; n += n_inc)
-    for (m = -L + 1; m <= L - 1; ++m)
-      for (mm = -L + 1; mm <= L - 1; ++mm)
-        Fmnm[mm + mm_offset + mm_stride * (m + m_offset + m_stride * (n + n_offset))] *=
-            expsmm[mm + mm_offset];
+  // Apply phase modulation to account for sampling offset. MWSS sampling
+  // starts at the north pole, so there is no offset to account for.
+  if (sampling == SO3_SAMPLING_MW)
+    for (n = n_start; n <= n_stop; n += n_inc)
+      for (m = -M + 1; m <= M - 1; ++m)
+        for (mm = -L + 1; mm <= L - 1; ++mm)
+          Fmnm
+              [mm + mm_offset +
+               mm_stride * (m + m_offset + m_stride * (n + n_offset))] *=
+              expsmm[mm + mm_offset];
 
   // Compute weights.
   complex double *w = calloc(4 * L - 3, sizeof(*w));
@@ -2168,10 +2109,10 @@ void so3_core_forward_direct_real(
   SO3_ERROR_MEM_ALLOC_CHECK(wr);
   inout = calloc(4 * L - 3, sizeof(*inout));
   SO3_ERROR_MEM_ALLOC_CHECK(inout);
-  fftw_plan plan_bwd =
-      fftw_plan_dft_1d(4 * L - 3, inout, inout, FFTW_BACKWARD, FFTW_MEASURE);
-  fftw_plan plan_fwd =
-      fftw_plan_dft_1d(4 * L - 3, inout, inout, FFTW_FORWARD, FFTW_MEASURE);
+  so3_fft_plan_t *plan_bwd =
+      so3_fft_plan_dft_1d(4 * L - 3, inout, inout, SO3_FFT_BACKWARD, SO3_FFT_MEASURE);
+  so3_fft_plan_t *plan_fwd =
+      so3_fft_plan_dft_1d(4 * L - 3, inout, inout, SO3_FFT_FORWARD, SO3_FFT_MEASURE);
 
   // Apply spatial shift.
   for (mm = 1; mm <= 2 * L - 2; ++mm)
@@ -2179,7 +2120,7 @@ void so3_core_forward_direct_real(
   for (mm = -2 * (L - 1); mm <= 0; ++mm)
     inout[mm + w_offset] = w[mm + 2 * (L - 1) + w_offset];
 
-  fftw_execute_dft(plan_bwd, inout, inout);
+  so3_fft_execute_dft(plan_bwd, inout, inout);
 
   // Apply spatial shift.
   for (mm = 0; mm <= 2 * L - 2; ++mm)
@@ -2190,10 +2131,10 @@ void so3_core_forward_direct_real(
   // Compute Gmnm' by convolution implemented as product in real space.
   complex double *Fmnm_pad = calloc(4 * L - 3, sizeof(*Fmnm_pad));
   SO3_ERROR_MEM_ALLOC_CHECK(Fmnm_pad);
-  complex double *Gmnm = calloc((2 * L - 1) * (2 * L - 1) * N, sizeof(*Gmnm));
+  complex double *Gmnm = so3_alloc_large((2 * M - 1) * (2 * L - 1) * N, sizeof(*Gmnm));
   SO3_ERROR_MEM_ALLOC_CHECK(Gmnm);
   for (n = n_start; n <= n_stop; n += n_inc)
-    for (m = -L + 1; m <= L - 1; ++m) {
+    for (m = -M + 1; m <= M - 1; ++m) {
 
       // Zero-pad Fmnm'.
       for (mm = -2 * (L - 1); mm <= -L; ++mm)
@@ -2210,7 +2151,7 @@ void so3_core_forward_direct_real(
       for (mm = -2 * (L - 1); mm <= 0; ++mm)
         inout[mm + w_offset] = Fmnm_pad[mm + 2 * (L - 1) + w_offset];
       // Compute IFFT of Fmnm'.
-      fftw_execute_dft(plan_bwd, inout, inout);
+      so3_fft_execute_dft(plan_bwd, inout, inout);
       // Apply spatial shift.
       for (mm = 0; mm <= 2 * L - 2; ++mm)
         Fmnm_pad[mm + w_offset] = inout[mm - 2 * (L - 1) + w_offset];
@@ -2228,7 +2169,7 @@ void so3_core_forward_direct_real(
       for (mm = -2 * (L - 1); mm <= 0; ++mm)
         inout[mm + w_offset] = Fmnm_pad[mm + 2 * (L - 1) + w_offset];
       // Compute Gmnm' by FFT.
-      fftw_execute_dft(plan_fwd, inout, inout);
+      so3_fft_execute_dft(plan_fwd, inout, inout);
       // Apply spatial shift.
       for (mm = 0; mm <= 2 * L - 2; ++mm)
         Fmnm_pad[mm + w_offset] = inout[mm - 2 * (L - 1) + w_offset];
@@ -2240,8 +2181,8 @@ void so3_core_forward_direct_real(
         Gmnm[m + m_offset + m_stride * (mm + mm_offset + mm_stride * (n + n_offset))] =
             Fmnm_pad[mm + w_offset] * 4.0 * SSHT_PI * SSHT_PI / (4.0 * L - 3.0);
     }
-  fftw_destroy_plan(plan_bwd);
-  fftw_destroy_plan(plan_fwd);
+  so3_fft_destroy_plan(plan_bwd);
+  so3_fft_destroy_plan(plan_fwd);
 
   // Compute flmn.
   double *dl, *dl8 = NULL;
@@ -2253,9 +2194,39 @@ void so3_core_forward_direct_real(
   }
   int dl_offset = ssht_dl_get_offset(L, SSHT_DL_QUARTER);
   int dl_stride = ssht_dl_get_stride(L, SSHT_DL_QUARTER);
+
+  // Extent of the entries of every row of the Wigner plane above the
+  // tolerance, if negligible entries are skipped.
+  int *dl_mlim = NULL;
+  if (parameters->dl_tolerance > 0.0) {
+    dl_mlim = malloc(L * sizeof *dl_mlim);
+    SO3_ERROR_MEM_ALLOC_CHECK(dl_mlim);
+  }
+
+  // Kernel specialised for the n-mode and reality of this transform.
+  so3_kernel_args_t kernel_args = {
+      .parameters = parameters,
+      .L = L,
+      .M = M,
+      .N = N,
+      .dl = dl,
+      .dl_offset = dl_offset,
+      .dl_stride = dl_stride,
+      .dl_mlim = dl_mlim,
+      .signs = signs,
+      .exps = exps,
+      .mn_factors = NULL,
+      .layout = {
+          .origin = m_offset + m_stride * (mm_offset + mm_stride * n_offset),
+          .m_step = 1,
+          .m_neg_shift = 0,
+          .n_step = m_stride * mm_stride,
+          .mm_step = m_stride}};
+  so3_kernel_forward_t kernel = so3_kernel_forward_get(n_mode, 1);
+
   for (n = 0; n <= N - 1; ++n)
     for (el = n; el < L; ++el)
-      for (m = -el; m <= el; ++m) {
+      for (m = -MIN(el, M - 1); m <= MIN(el, M - 1); ++m) {
         int ind;
         so3_sampling_elmn2ind_real(&ind, el, m, n, parameters);
         flmn[ind] = 0.0;
@@ -2299,82 +2270,22 @@ void so3_core_forward_direct_real(
     }
 
     // Compute flmn for current el.
-
-    switch (n_mode) {
-    case SO3_N_MODE_ALL:
-      n_start = 0;
-      n_stop = MIN(N - 1, el);
-      n_inc = 1;
-      break;
-    case SO3_N_MODE_EVEN:
-      n_start = 0;
-      n_stop = MIN(N - 1, el);
-      n_stop -= n_stop % 2;
-      n_inc = 2;
-      break;
-    case SO3_N_MODE_ODD:
-      n_start = 1;
-      n_stop = MIN(N - 1, el);
-      n_stop -= 1 - n_stop % 2;
-      n_inc = 2;
-      break;
-    case SO3_N_MODE_MAXIMUM:
-      if (el < N - 1)
-        continue;
-      n_start = N - 1;
-      n_stop = N - 1;
-      n_inc = 1;
-      break;
-    case SO3_N_MODE_L:
-      if (el >= N)
-        continue;
-      n_start = el;
-      n_stop = el;
-      n_inc = 1;
-      break;
-    default:
-      SO3_ERROR_GENERIC("Invalid n-mode.");
-    }
-
-    // TODO: Pull out a few multiplications into precomputations
-    // or split up loops to avoid conditionals to check signs.
-    for (mm = -el; mm <= el; ++mm) {
-      // These signs are needed for the symmetry relations of
-      // Wigner symbols.
-      double elmmsign = signs[el] * signs[abs(mm)];
-
-      for (n = n_start; n <= n_stop; n += n_inc) {
-        double mmsign = mm >= 0 ? 1.0 : signs[el] * signs[n];
-
-        // Factor which does not depend on m.
-        double elnmm_factor = mmsign * dl[n + dl_offset + abs(mm) * dl_stride];
-
-        for (m = -el; m <= el; ++m) {
-          mmsign = mm >= 0 ? 1.0 : signs[el] * signs[abs(m)];
-          double elmsign = m >= 0 ? 1.0 : elmmsign;
-          int ind;
-          so3_sampling_elmn2ind_real(&ind, el, m, n, parameters);
-          int mod = ((m - n) % 4 + 4) % 4;
-          flmn[ind] += exps[mod] * elnmm_factor * mmsign * elmsign *
-                       dl[abs(m) + dl_offset + abs(mm) * dl_stride] *
-                       Gmnm
-                           [m + m_offset +
-                            m_stride * (mm + mm_offset + mm_stride * (n + n_offset))];
-        }
-      }
-    }
+    if (dl_mlim)
+      so3_kernel_dl_mlim(dl_mlim, &kernel_args, el, parameters->dl_tolerance);
+    kernel(flmn, Gmnm, el, &kernel_args);
   }
 
   free(dl);
+  free(dl_mlim);
   if (dl_method == SSHT_DL_RISBO)
     free(dl8);
-  free(Fmnb);
-  free(Fmnm);
+  so3_alloc_free(Fmnb);
+  so3_alloc_free(Fmnm);
   free(inout);
   free(w);
   free(wr);
   free(Fmnm_pad);
-  free(Gmnm);
+  so3_alloc_free(Gmnm);
   free(sqrt_tbl);
   free(signs);
   free(exps);
@@ -2383,3 +2294,244 @@ void so3_core_forward_direct_real(
   if (verbosity > 0)
     printf("%sForward transform computed!\n", SO3_PROMPT);
 }
+
+// Whether a batch is better served by the small band-limit engine. Its plans
+// are cached, but the first one costs about as much as nbeta forward
+// transforms.
+static int so3_core_use_small(const so3_parameters_t *parameters, int batch) {
+  return parameters->L <= SO3_SMALL_L_MAX &&
+         (batch >= so3_sampling_nbeta(parameters) || so3_small_plan_cached(parameters));
+}
+
+/*!
+ * Compute inverse Wigner transforms of a batch of complex signals.
+ *
+ * For L <= SO3_SMALL_L_MAX, the dense matrices of the small band-limit
+ * engine (see so3_small.h) are used for batches of at least nbeta signals,
+ * and for any batch once a plan for these parameters has been built. The
+ * plans are kept in the global cache of \link so3_small_plan_get \endlink.
+ * Otherwise every signal is transformed with \link so3_core_inverse_direct
+ * \endlink.
+ *
+ * \param[out] f Functions on SO(3), stored one after the other, each of the
+ *               size documented in \link so3_core_inverse_direct \endlink.
+ * \param[in] flmn Harmonic coefficients, stored one after the other.
+ * \param[in] batch Number of signals.
+ * \param[in]  parameters A fully populated parameters object. The \link
+ *                        so3_parameters_t::reality reality\endlink flag
+ *                        is ignored.
+ * \retval none
+ */
+void so3_core_inverse_batch(
+    complex double *f,
+    const complex double *flmn,
+    int batch,
+    const so3_parameters_t *parameters) {
+  so3_parameters_t complex_parameters = *parameters;
+  complex_parameters.reality = 0;
+  int flmn_size = so3_sampling_flmn_size(&complex_parameters);
+  int f_size = so3_sampling_nalpha(parameters) * so3_sampling_nbeta(parameters) *
+               (2 * parameters->N - 1);
+
+  if (so3_core_use_small(&complex_parameters, batch)) {
+    so3_small_inverse(f, flmn, batch, so3_small_plan_get(&complex_parameters));
+  } else {
+    int k;
+    for (k = 0; k < batch; ++k)
+      so3_core_inverse_direct(f + f_size * k, flmn + flmn_size * k, &complex_parameters);
+  }
+}
+
+/*!
+ * Compute inverse Wigner transforms of a batch of real signals.
+ *
+ * The engine is selected as in \link so3_core_inverse_batch \endlink.
+ *
+ * \param[out] f Real functions on SO(3), stored one after the other.
+ * \param[in] flmn Harmonic coefficients for n >= 0, stored one after the other.
+ * \param[in] batch Number of signals.
+ * \param[in]  parameters A fully populated parameters object. The \link
+ *                        so3_parameters_t::reality reality\endlink flag
+ *                        is ignored.
+ * \retval none
+ */
+void so3_core_inverse_batch_real(
+    double *f,
+    const complex double *flmn,
+    int batch,
+    const so3_parameters_t *parameters) {
+  so3_parameters_t real_parameters = *parameters;
+  real_parameters.reality = 1;
+  int flmn_size = so3_sampling_flmn_size(&real_parameters);
+  int f_size = so3_sampling_nalpha(parameters) * so3_sampling_nbeta(parameters) *
+               (2 * parameters->N - 1);
+
+  if (so3_core_use_small(&real_parameters, batch)) {
+    so3_small_inverse_real(f, flmn, batch, so3_small_plan_get(&real_parameters));
+  } else {
+    int k;
+    for (k = 0; k < batch; ++k)
+      so3_core_inverse_direct_real(
+          f + f_size * k, flmn + flmn_size * k, &real_parameters);
+  }
+}
+
+/*!
+ * Compute forward Wigner transforms of a batch of complex signals.
+ *
+ * The engine is selected as in \link so3_core_inverse_batch \endlink.
+ *
+ * \param[out] flmn Harmonic coefficients, stored one after the other.
+ * \param[in] f Functions on SO(3), stored one after the other.
+ * \param[in] batch Number of signals.
+ * \param[in]  parameters A fully populated parameters object. The \link
+ *                        so3_parameters_t::reality reality\endlink flag
+ *                        is ignored.
+ * \retval none
+ */
+void so3_core_forward_batch(
+    complex double *flmn,
+    const complex double *f,
+    int batch,
+    const so3_parameters_t *parameters) {
+  so3_parameters_t complex_parameters = *parameters;
+  complex_parameters.reality = 0;
+  int flmn_size = so3_sampling_flmn_size(&complex_parameters);
+  int f_size = so3_sampling_nalpha(parameters) * so3_sampling_nbeta(parameters) *
+               (2 * parameters->N - 1);
+
+  if (so3_core_use_small(&complex_parameters, batch)) {
+    so3_small_forward(flmn, f, batch, so3_small_plan_get(&complex_parameters));
+  } else {
+    int k;
+    for (k = 0; k < batch; ++k)
+      so3_core_forward_direct(flmn + flmn_size * k, f + f_size * k, &complex_parameters);
+  }
+}
+
+/*!
+ * Compute forward Wigner transforms of a batch of real signals.
+ *
+ * The engine is selected as in \link so3_core_inverse_batch \endlink.
+ *
+ * \param[out] flmn Harmonic coefficients for n >= 0, stored one after the
+ *                  other.
+ * \param[in] f Real functions on SO(3), stored one after the other.
+ * \param[in] batch Number of signals.
+ * \param[in]  parameters A fully populated parameters object. The \link
+ *                        so3_parameters_t::reality reality\endlink flag
+ *                        is ignored.
+ * \retval none
+ */
+void so3_core_forward_batch_real(
+    complex double *flmn,
+    const double *f,
+    int batch,
+    const so3_parameters_t *parameters) {
+  so3_parameters_t real_parameters = *parameters;
+  real_parameters.reality = 1;
+  int flmn_size = so3_sampling_flmn_size(&real_parameters);
+  int f_size = so3_sampling_nalpha(parameters) * so3_sampling_nbeta(parameters) *
+               (2 * parameters->N - 1);
+
+  if (so3_core_use_small(&real_parameters, batch)) {
+    so3_small_forward_real(flmn, f, batch, so3_small_plan_get(&real_parameters));
+  } else {
+    int k;
+    for (k = 0; k < batch; ++k)
+      so3_core_forward_direct_real(
+          flmn + flmn_size * k, f + f_size * k, &real_parameters);
+  }
+}
+
+/*!
+ * Compute inverse Wigner transform for a complex signal with the fastest
+ * available algorithm.
+ *
+ * The algorithm, via SSHT or direct with the Risbo or Trapani recursion, is
+ * chosen by \link so3_tune_select \endlink, which benchmarks the candidates
+ * the first time a parameter set is seen.
+ *
+ * \param[out] f Function on SO(3). Provide a buffer of size
+ *               \link so3_sampling_f_size \endlink.
+ * \param[in]  flmn Harmonic coefficients.
+ * \param[in]  parameters A fully populated parameters object. The \link
+ *                        so3_parameters_t::dl_method dl_method\endlink is
+ *                        overridden by the tuner.
+ * \retval none
+ */
+void so3_core_inverse_auto(
+    complex double *f, const complex double *flmn, const so3_parameters_t *parameters) {
+  so3_parameters_t tuned = *parameters;
+  tuned.reality = 0;
+  so3_tune_choice_t choice = so3_tune_select(&tuned, SO3_TUNE_INVERSE);
+  tuned.dl_method = choice.dl_method;
+  if (choice.method == SO3_TUNE_METHOD_VIA_SSHT)
+    so3_core_inverse_via_ssht(f, flmn, &tuned);
+  else
+    so3_core_inverse_direct(f, flmn, &tuned);
+}
+
+/*!
+ * Compute inverse Wigner transform for a real signal with the fastest
+ * available algorithm, see \link so3_core_inverse_auto \endlink.
+ *
+ * \param[out] f Real function on SO(3). Provide a buffer of size
+ *               \link so3_sampling_f_size \endlink.
+ * \param[in]  flmn Harmonic coefficients for n >= 0.
+ * \param[in]  parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_core_inverse_auto_real(
+    double *f, const complex double *flmn, const so3_parameters_t *parameters) {
+  so3_parameters_t tuned = *parameters;
+  tuned.reality = 1;
+  so3_tune_choice_t choice = so3_tune_select(&tuned, SO3_TUNE_INVERSE);
+  tuned.dl_method = choice.dl_method;
+  if (choice.method == SO3_TUNE_METHOD_VIA_SSHT)
+    so3_core_inverse_via_ssht_real(f, flmn, &tuned);
+  else
+    so3_core_inverse_direct_real(f, flmn, &tuned);
+}
+
+/*!
+ * Compute forward Wigner transform for a complex signal with the fastest
+ * available algorithm, see \link so3_core_inverse_auto \endlink.
+ *
+ * \param[out] flmn Harmonic coefficients.
+ * \param[in]  f Function on SO(3).
+ * \param[in]  parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_core_forward_auto(
+    complex double *flmn, const complex double *f, const so3_parameters_t *parameters) {
+  so3_parameters_t tuned = *parameters;
+  tuned.reality = 0;
+  so3_tune_choice_t choice = so3_tune_select(&tuned, SO3_TUNE_FORWARD);
+  tuned.dl_method = choice.dl_method;
+  if (choice.method == SO3_TUNE_METHOD_VIA_SSHT)
+    so3_core_forward_via_ssht(flmn, f, &tuned);
+  else
+    so3_core_forward_direct(flmn, f, &tuned);
+}
+
+/*!
+ * Compute forward Wigner transform for a real signal with the fastest
+ * available algorithm, see \link so3_core_inverse_auto \endlink.
+ *
+ * \param[out] flmn Harmonic coefficients for n >= 0.
+ * \param[in]  f Real function on SO(3).
+ * \param[in]  parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_core_forward_auto_real(
+    complex double *flmn, const double *f, const so3_parameters_t *parameters) {
+  so3_parameters_t tuned = *parameters;
+  tuned.reality = 1;
+  so3_tune_choice_t choice = so3_tune_select(&tuned, SO3_TUNE_FORWARD);
+  tuned.dl_method = choice.dl_method;
+  if (choice.method == SO3_TUNE_METHOD_VIA_SSHT)
+    so3_core_forward_via_ssht_real(flmn, f, &tuned);
+  else
+    so3_core_forward_direct_real(flmn, f, &tuned);
+}
@@ -0,0 +1,333 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_descriptor.c
+ * Rotation-invariant descriptors of many signals from their harmonic
+ * coefficients.
+ *
+ * Under a rotation of the signal, f(R^-1 rho), the coefficients of every
+ * (el, n) mix over m by the Wigner D-matrix of degree el. Invariant under
+ * rotations are therefore the power spectrum
+ *
+ *   P_el = sum_mn |f_el,m,n|^2,
+ *
+ * and the bispectrum, which couples two such columns by Clebsch-Gordan
+ * coefficients to a third:
+ *
+ *   B = sum_m1,m2 C^(el, m1+m2)_(el1 m1, el2 m2) f_el1,m1,n1 f_el2,m2,n2
+ *       conj(f_el,m1+m2,n),
+ *
+ * for any n1, n2 and n, which vanishes unless |el1 - el2| <= el <= el1 + el2.
+ *
+ * The coefficients of every (el, n) are contiguous in m for all storage
+ * methods and n-orders, so they are located once per call, and the signals of
+ * a batch are then processed independently, shared out between threads. For
+ * real signals, the coefficients of n < 0 follow from those of -n.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "so3/so3_descriptor.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+#include "so3/so3_wigner.h"
+
+#include "so3_omp.h"
+
+#define MIN(a, b) ((a < b) ? (a) : (b))
+#define MAX(a, b) ((a > b) ? (a) : (b))
+
+// Location of the coefficients of one (el, n) in an flmn array.
+typedef struct {
+  // Index of m = -mmax, or -1 if the coefficients are zero.
+  int ind;
+  int mmax;
+  // Whether the column is obtained from that of -n of a real signal.
+  int mirrored;
+} so3_descriptor_column_t;
+
+static so3_descriptor_column_t
+so3_descriptor_column(int el, int n, const so3_parameters_t *parameters) {
+  so3_descriptor_column_t column = {-1, 0, 0};
+  const int stored_n = parameters->reality ? abs(n) : n;
+
+  if (el < 0 || el >= parameters->L || abs(n) > el ||
+      !so3_sampling_is_elmn_non_zero(el, 0, stored_n, parameters))
+    return column;
+  column.mmax = MIN(el, so3_sampling_mlim(parameters) - 1);
+  column.mirrored = parameters->reality && n < 0;
+  if (parameters->reality)
+    so3_sampling_elmn2ind_real(&column.ind, el, -column.mmax, stored_n, parameters);
+  else
+    so3_sampling_elmn2ind(&column.ind, el, -column.mmax, stored_n, parameters);
+  return column;
+}
+
+// Copy the coefficients m = -el .. el of a column, with zeros beyond mmax.
+// For real signals, f_el,m,n = (-1)^(m+n) conj(f_el,-m,-n).
+static void so3_descriptor_load(
+    complex double *values, int el, int n, const so3_descriptor_column_t *column,
+    const complex double *flmn) {
+  int m;
+  for (m = -el; m <= el; ++m)
+    values[m + el] = 0.0;
+  if (column->ind < 0)
+    return;
+  for (m = -column->mmax; m <= column->mmax; ++m) {
+    if (column->mirrored)
+      values[m + el] = ((m + n) % 2 ? -1.0 : 1.0) *
+                       conj(flmn[column->ind + column->mmax - m]);
+    else
+      values[m + el] = flmn[column->ind + column->mmax + m];
+  }
+}
+
+// Gauss-Legendre quadrature of q points, as angles beta = acos(x) of the
+// nodes x in [-1, 1] and their weights.
+static void so3_descriptor_gauss_legendre(double *beta, double *weight, int q) {
+  int i, k, iteration;
+  for (i = 0; i < q; ++i) {
+    double x = cos(SO3_PI * (i + 0.75) / (q + 0.5)), p = 1.0, derivative = 1.0;
+    for (iteration = 0; iteration < 100; ++iteration) {
+      double p_prev = 0.0, dx;
+      p = 1.0;
+      for (k = 1; k <= q; ++k) {
+        const double p_prev2 = p_prev;
+        p_prev = p;
+        p = ((2 * k - 1) * x * p_prev - (k - 1) * p_prev2) / k;
+      }
+      derivative = q * (x * p - p_prev) / (x * x - 1.0);
+      dx = p / derivative;
+      x -= dx;
+      if (fabs(dx) < 1e-15)
+        break;
+    }
+    beta[i] = acos(x);
+    weight[i] = 2.0 / ((1.0 - x * x) * derivative * derivative);
+  }
+}
+
+// d^el_mn at the quadrature angles for m = -mmax .. mmax, one row per m.
+static void so3_descriptor_wigner_d(
+    double *d, int el, int mmax, int n, const double *beta, int q) {
+  so3_wigner_d_recursion_t recursion;
+  int m;
+  for (m = -mmax; m <= mmax; ++m) {
+    so3_wigner_d_recursion_init(&recursion, m, n, beta, q);
+    while (recursion.el < el)
+      so3_wigner_d_recursion_next(&recursion);
+    memcpy(d + (m + mmax) * q, recursion.d, q * sizeof *d);
+    so3_wigner_d_recursion_free(&recursion);
+  }
+}
+
+/*!
+ * Compute the Clebsch-Gordan coefficients C^(el, m1+m2)_(el1 m1, el2 m2) of
+ * given degrees for all orders.
+ *
+ * The coefficients follow from the integral of products of Wigner
+ * d-functions,
+ *
+ *   int d^el1_m1,n1 d^el2_m2,n2 d^el_m,n sin(beta) dbeta
+ *     = 2 / (2*el+1) C^(el m)_(el1 m1, el2 m2) C^(el n)_(el1 n1, el2 n2),
+ *
+ * at n1 = el1, n = el, where the second coefficient is known in closed form.
+ * The integrand is a polynomial in cos(beta), which Gauss-Legendre quadrature
+ * integrates exactly, and the d-functions are evaluated by the recursion in el,
+ * so unlike the explicit sum over factorials the coefficients are accurate at
+ * all degrees.
+ *
+ * \param[out] cg Coefficients, a (2*el1+1) x (2*el2+1) array indexed by
+ *                (m1+el1)*(2*el2+1) + m2+el2, zero where |m1+m2| > el.
+ * \param[in] el1 First degree.
+ * \param[in] el2 Second degree.
+ * \param[in] el Coupled degree, with |el1 - el2| <= el <= el1 + el2.
+ * \retval none
+ */
+void so3_descriptor_clebsch_gordan(double *cg, int el1, int el2, int el) {
+  const int stride = 2 * el2 + 1, n2 = el - el1;
+  const int q = (el1 + el2 + el) / 2 + 1;
+  double *beta, *weight, *d1, *d2, *d;
+  double scale;
+  int m1, m2, i;
+
+  if (el1 < 0 || el2 < 0 || el < abs(el1 - el2) || el > el1 + el2)
+    SO3_ERROR_GENERIC("Degrees violate the triangle condition.");
+
+  beta = malloc(2 * q * sizeof *beta);
+  d1 = malloc((2 * el1 + 1) * q * sizeof *d1);
+  d2 = malloc((2 * el2 + 1) * q * sizeof *d2);
+  d = malloc((2 * el + 1) * q * sizeof *d);
+  SO3_ERROR_MEM_ALLOC_CHECK(beta);
+  SO3_ERROR_MEM_ALLOC_CHECK(d1);
+  SO3_ERROR_MEM_ALLOC_CHECK(d2);
+  SO3_ERROR_MEM_ALLOC_CHECK(d);
+  weight = beta + q;
+
+  so3_descriptor_gauss_legendre(beta, weight, q);
+  so3_descriptor_wigner_d(d1, el1, el1, el1, beta, q);
+  so3_descriptor_wigner_d(d2, el2, el2, n2, beta, q);
+  so3_descriptor_wigner_d(d, el, el, el, beta, q);
+
+  // 1 / C^(el el)_(el1 el1, el2 n2), which is positive.
+  scale = (el + 0.5) *
+          exp(-0.5 * (lgamma(2.0 * el + 2) + lgamma(el1 + el2 - el + 1.0) -
+                      lgamma(el1 + el2 + el + 2.0) - lgamma(el1 - el2 + el + 1.0) -
+                      lgamma(el2 - el1 + el + 1.0) + lgamma(2.0 * el1 + 1) +
+                      lgamma(el2 + n2 + 1.0) - lgamma(el2 - n2 + 1.0)));
+  memset(cg, 0, (2 * el1 + 1) * stride * sizeof *cg);
+  for (m1 = -el1; m1 <= el1; ++m1)
+    for (m2 = MAX(-el2, -el - m1); m2 <= MIN(el2, el - m1); ++m2) {
+      const double *a = d1 + (m1 + el1) * q, *b = d2 + (m2 + el2) * q;
+      const double *c = d + (m1 + m2 + el) * q;
+      double sum = 0.0;
+      for (i = 0; i < q; ++i)
+        sum += weight[i] * a[i] * b[i] * c[i];
+      cg[(m1 + el1) * stride + m2 + el2] = scale * sum;
+    }
+
+  free(beta);
+  free(d1);
+  free(d2);
+  free(d);
+}
+
+/*!
+ * Compute the power spectra of a batch of signals.
+ *
+ * \param[out] power Power spectra, L values per signal, zero for el < L0.
+ * \param[in] flmn Harmonic coefficients of the signals, one array of size
+ *                 \link so3_sampling_flmn_size \endlink after the other.
+ * \param[in] batch Number of signals.
+ * \param[in] parameters A fully populated parameters object. For real signals
+ *                       the coefficients of n < 0 are included.
+ * \retval none
+ */
+void so3_descriptor_power(
+    double *power, const complex double *flmn, int batch,
+    const so3_parameters_t *parameters) {
+  const int L = parameters->L, N = parameters->N;
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  so3_descriptor_column_t *columns = malloc(L * (2 * N - 1) * sizeof *columns);
+  int el, n, s;
+  SO3_ERROR_MEM_ALLOC_CHECK(columns);
+
+  // The stored columns, each counted for n and -n of real signals.
+  for (el = 0; el < L; ++el)
+    for (n = -N + 1; n < N; ++n)
+      columns[el * (2 * N - 1) + n + N - 1] =
+          parameters->reality && n < 0 ? (so3_descriptor_column_t){-1, 0, 0}
+                                       : so3_descriptor_column(el, n, parameters);
+
+  SO3_PRAGMA(omp parallel for schedule(static) if (batch > 1))
+  for (s = 0; s < batch; ++s) {
+    const complex double *f = flmn + (size_t)s * flmn_size;
+    int el, n, k;
+    for (el = 0; el < L; ++el) {
+      double sum = 0.0;
+      for (n = -N + 1; n < N; ++n) {
+        const so3_descriptor_column_t *column = columns + el * (2 * N - 1) + n + N - 1;
+        const double *fd = (const double *)(f + column->ind);
+        double s2 = 0.0;
+        if (column->ind < 0)
+          continue;
+        SO3_PRAGMA(omp simd reduction(+ : s2))
+        for (k = 0; k < 2 * (2 * column->mmax + 1); ++k)
+          s2 += fd[k] * fd[k];
+        sum += parameters->reality && n > 0 ? 2.0 * s2 : s2;
+      }
+      power[(size_t)s * L + el] = sum;
+    }
+  }
+
+  free(columns);
+}
+
+/*!
+ * Compute selected bispectrum entries of a batch of signals.
+ *
+ * \param[out] bispectrum Entries, ntriples values per signal. Entries of
+ *                        degrees that violate the triangle condition, or of
+ *                        coefficients that are zero for the parameters, are
+ *                        zero.
+ * \param[in] flmn Harmonic coefficients of the signals, one array of size
+ *                 \link so3_sampling_flmn_size \endlink after the other.
+ * \param[in] batch Number of signals.
+ * \param[in] triples Selected entries.
+ * \param[in] ntriples Number of selected entries.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_descriptor_bispectrum(
+    complex double *bispectrum, const complex double *flmn, int batch,
+    const so3_descriptor_triple_t *triples, int ntriples,
+    const so3_parameters_t *parameters) {
+  const int L = parameters->L;
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  so3_descriptor_column_t *columns = malloc(3 * ntriples * sizeof *columns);
+  double **cg = calloc(ntriples, sizeof *cg);
+  int t, s;
+  SO3_ERROR_MEM_ALLOC_CHECK(columns);
+  SO3_ERROR_MEM_ALLOC_CHECK(cg);
+
+  SO3_PRAGMA(omp parallel for schedule(dynamic) if (ntriples > 1))
+  for (t = 0; t < ntriples; ++t) {
+    const so3_descriptor_triple_t *triple = triples + t;
+    columns[3 * t] = so3_descriptor_column(triple->el1, triple->n1, parameters);
+    columns[3 * t + 1] = so3_descriptor_column(triple->el2, triple->n2, parameters);
+    columns[3 * t + 2] = so3_descriptor_column(triple->el, triple->n, parameters);
+    if (columns[3 * t].ind < 0 || columns[3 * t + 1].ind < 0 ||
+        columns[3 * t + 2].ind < 0 || triple->el < abs(triple->el1 - triple->el2) ||
+        triple->el > triple->el1 + triple->el2)
+      continue;
+    cg[t] = malloc((2 * triple->el1 + 1) * (2 * triple->el2 + 1) * sizeof *cg[t]);
+    SO3_ERROR_MEM_ALLOC_CHECK(cg[t]);
+    so3_descriptor_clebsch_gordan(cg[t], triple->el1, triple->el2, triple->el);
+  }
+
+  SO3_PRAGMA(omp parallel if (batch > 1)) {
+    complex double *values = malloc(3 * (2 * L - 1) * sizeof *values);
+    SO3_ERROR_MEM_ALLOC_CHECK(values);
+
+    SO3_PRAGMA(omp for schedule(static))
+    for (s = 0; s < batch; ++s) {
+      const complex double *f = flmn + (size_t)s * flmn_size;
+      int t;
+      for (t = 0; t < ntriples; ++t) {
+        const so3_descriptor_triple_t *triple = triples + t;
+        const int el1 = triple->el1, el2 = triple->el2, el = triple->el;
+        complex double *f1 = values, *f2 = values + 2 * L - 1;
+        complex double *f3 = values + 2 * (2 * L - 1);
+        complex double sum = 0.0;
+        int m1, m2;
+        if (cg[t] == NULL) {
+          bispectrum[(size_t)s * ntriples + t] = 0.0;
+          continue;
+        }
+        so3_descriptor_load(f1, el1, triple->n1, columns + 3 * t, f);
+        so3_descriptor_load(f2, el2, triple->n2, columns + 3 * t + 1, f);
+        so3_descriptor_load(f3, el, triple->n, columns + 3 * t + 2, f);
+        for (m1 = -el1; m1 <= el1; ++m1) {
+          const double *row = cg[t] + (m1 + el1) * (2 * el2 + 1) + el2;
+          complex double inner = 0.0;
+          for (m2 = MAX(-el2, -el - m1); m2 <= MIN(el2, el - m1); ++m2)
+            inner += row[m2] * f2[m2 + el2] * conj(f3[m1 + m2 + el]);
+          sum += f1[m1 + el1] * inner;
+        }
+        bispectrum[(size_t)s * ntriples + t] = sum;
+      }
+    }
+    free(values);
+  }
+
+  for (t = 0; t < ntriples; ++t)
+    free(cg[t]);
+  free(cg);
+  free(columns);
+}
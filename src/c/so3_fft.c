@@ -0,0 +1,754 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_fft.c
+ * FFT backend layer used by the core and adjoint transforms.
+ *
+ * Plans are described as in FFTW's guru interface: up to three transform
+ * dimensions and up to three loop ("howmany") dimensions, each with a length
+ * and input and output strides. The FFTW backend forwards the description to
+ * fftw_plan_guru_dft(_r2c/_c2r). The builtin backend needs no planning: it
+ * gathers each transform into a contiguous buffer, applies mixed-radix
+ * Cooley-Tukey transforms along every dimension (Bluestein's algorithm if a
+ * length has a large prime factor) and scatters the result. Real transforms
+ * are computed as complex transforms of the full, Hermitian-symmetric array.
+ *
+ * The backend is read when a plan is created, so that plans created before
+ * a call to \link so3_fft_set_backend \endlink keep working.
+ *
+ * FFTW's planner is not thread-safe, while executing plans is. Callers that
+ * transform on several threads install a lock with \link
+ * so3_fft_set_planner_lock \endlink, which is held while FFTW plans are
+ * created and destroyed, so that only planning is serialised.
+ */
+
+#include <complex.h> // Must be before fftw3.h
+#include <fftw3.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "so3/so3_error.h"
+#include "so3/so3_fft.h"
+
+#define SO3_FFT_MAX_RANK 3
+// Largest prime factor handled by the generic radix butterfly. Lengths with
+// larger prime factors use Bluestein's algorithm.
+#define SO3_FFT_MAX_RADIX 64
+// Enough for the (radix, length) pairs of any int length.
+#define SO3_FFT_MAX_FACTORS 64
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Complex transforms of one length along a contiguous line.
+typedef struct so3_fft_line {
+  int n;
+  int sign;
+  // (radix, remaining length) pairs of the Cooley-Tukey decomposition.
+  int factors[SO3_FFT_MAX_FACTORS];
+  // twiddles[k] = exp(sign*2*pi*i*k/n).
+  complex double *twiddles;
+  // Bluestein's algorithm, if nb > 0: chirp[k] = exp(sign*pi*i*k^2/n), and
+  // kernel is the forward transform of length nb of the conjugate chirp,
+  // divided by nb.
+  int nb;
+  complex double *chirp, *kernel;
+  struct so3_fft_line *sub;
+} so3_fft_line_t;
+
+struct so3_fft_plan {
+  so3_fft_backend_t backend;
+  so3_fft_kind_t kind;
+  int sign;
+  int rank, howmany_rank;
+  so3_fft_dim_t dims[SO3_FFT_MAX_RANK];
+  so3_fft_dim_t howmany_dims[SO3_FFT_MAX_RANK];
+  void *in, *out;
+  fftw_plan fftw;
+  so3_fft_line_t *lines[SO3_FFT_MAX_RANK];
+};
+
+static so3_fft_backend_t so3_fft_backend = SO3_FFT_DEFAULT_BACKEND;
+
+static so3_fft_lock_t so3_fft_lock, so3_fft_unlock;
+static void *so3_fft_lock_data;
+
+/*!
+ * Select the backend used for plans created from now on.
+ *
+ * \param[in] backend FFT backend.
+ * \retval none
+ */
+void so3_fft_set_backend(so3_fft_backend_t backend) {
+  if (backend < 0 || backend >= SO3_FFT_BACKEND_SIZE)
+    SO3_ERROR_GENERIC("Invalid FFT backend.");
+  so3_fft_backend = backend;
+}
+
+/*!
+ * Return the backend used for newly created plans.
+ *
+ * \retval backend FFT backend.
+ */
+so3_fft_backend_t so3_fft_get_backend(void) { return so3_fft_backend; }
+
+/*!
+ * Install the lock held while FFTW plans are created and destroyed. Not
+ * thread-safe: install it before planning on several threads.
+ *
+ * \param[in] lock Function taking the lock, or NULL for none.
+ * \param[in] unlock Function releasing the lock, or NULL for none.
+ * \param[in] data Argument of both functions.
+ * \retval none
+ */
+void so3_fft_set_planner_lock(
+    so3_fft_lock_t lock, so3_fft_lock_t unlock, void *data) {
+  if (!lock != !unlock)
+    SO3_ERROR_GENERIC("Planner lock needs both lock and unlock functions.");
+  so3_fft_lock = lock;
+  so3_fft_unlock = unlock;
+  so3_fft_lock_data = data;
+}
+
+/*!
+ * Get the lock installed with \link so3_fft_set_planner_lock \endlink, so
+ * that it can be restored after installing another.
+ *
+ * \param[out] lock Function taking the lock, or NULL for none.
+ * \param[out] unlock Function releasing the lock, or NULL for none.
+ * \param[out] data Argument of both functions.
+ * \retval none
+ */
+void so3_fft_get_planner_lock(
+    so3_fft_lock_t *lock, so3_fft_lock_t *unlock, void **data) {
+  *lock = so3_fft_lock;
+  *unlock = so3_fft_unlock;
+  *data = so3_fft_lock_data;
+}
+
+static void so3_fft_planner_lock(void) {
+  if (so3_fft_lock)
+    so3_fft_lock(so3_fft_lock_data);
+}
+
+static void so3_fft_planner_unlock(void) {
+  if (so3_fft_unlock)
+    so3_fft_unlock(so3_fft_lock_data);
+}
+
+// Decimation in time: transforms in[0], in[stride], ... into out[0..p*m-1],
+// where factors starts with (p, m).
+static void so3_fft_line_work(
+    const so3_fft_line_t *line,
+    complex double *out,
+    const complex double *in,
+    int fstride,
+    const int *factors) {
+  const int p = factors[0], m = factors[1];
+  const complex double *tw = line->twiddles;
+  int j, u, q, q1, k, twidx;
+
+  if (m == 1) {
+    for (j = 0; j < p; ++j)
+      out[j] = in[j * fstride];
+  } else {
+    for (j = 0; j < p; ++j)
+      so3_fft_line_work(line, out + j * m, in + j * fstride, fstride * p, factors + 2);
+  }
+
+  switch (p) {
+  case 1:
+    break;
+  case 2:
+    for (u = 0; u < m; ++u) {
+      complex double t = out[u + m] * tw[u * fstride];
+      out[u + m] = out[u] - t;
+      out[u] += t;
+    }
+    break;
+  case 4:
+    for (u = 0; u < m; ++u) {
+      complex double s0 = out[u + m] * tw[u * fstride];
+      complex double s1 = out[u + 2 * m] * tw[2 * u * fstride];
+      complex double s2 = out[u + 3 * m] * tw[3 * u * fstride];
+      complex double s5 = out[u] - s1;
+      complex double s3 = s0 + s2;
+      complex double s4 = (s0 - s2) * (line->sign * I);
+      out[u] += s1;
+      out[u + 2 * m] = out[u] - s3;
+      out[u] += s3;
+      out[u + m] = s5 + s4;
+      out[u + 3 * m] = s5 - s4;
+    }
+    break;
+  default: {
+    complex double scratch[SO3_FFT_MAX_RADIX];
+    for (u = 0; u < m; ++u) {
+      for (q1 = 0; q1 < p; ++q1)
+        scratch[q1] = out[u + q1 * m];
+      for (q1 = 0; q1 < p; ++q1) {
+        k = u + q1 * m;
+        complex double sum = scratch[0];
+        twidx = 0;
+        for (q = 1; q < p; ++q) {
+          twidx = (twidx + fstride * k) % line->n;
+          sum += scratch[q] * tw[twidx];
+        }
+        out[k] = sum;
+      }
+    }
+  }
+  }
+}
+
+// Transforms the contiguous line in into out. work holds 2*nb elements if
+// Bluestein's algorithm is used.
+static void so3_fft_line_execute(
+    const so3_fft_line_t *line,
+    complex double *out,
+    const complex double *in,
+    complex double *work) {
+  int k;
+
+  if (!line->nb) {
+    so3_fft_line_work(line, out, in, 1, line->factors);
+    return;
+  }
+
+  complex double *a = work, *A = work + line->nb;
+  for (k = 0; k < line->n; ++k)
+    a[k] = in[k] * line->chirp[k];
+  for (; k < line->nb; ++k)
+    a[k] = 0.0;
+  so3_fft_line_work(line->sub, A, a, 1, line->sub->factors);
+  // Inverse transform of the product as the conjugate of a forward one.
+  for (k = 0; k < line->nb; ++k)
+    A[k] = conj(A[k] * line->kernel[k]);
+  so3_fft_line_work(line->sub, a, A, 1, line->sub->factors);
+  for (k = 0; k < line->n; ++k)
+    out[k] = line->chirp[k] * conj(a[k]);
+}
+
+// Factorises n into radices 4, 2, 3, 5, 7, ... Returns 0 if a prime factor
+// exceeds SO3_FFT_MAX_RADIX.
+static int so3_fft_factorize(int *factors, int n) {
+  int p = 4, i = 0;
+  while (n > 1) {
+    while (n % p) {
+      p = p == 4 ? 2 : p == 2 ? 3 : p + 2;
+      if (p > SO3_FFT_MAX_RADIX)
+        return 0;
+    }
+    n /= p;
+    factors[i++] = p;
+    factors[i++] = n;
+  }
+  if (i == 0) {
+    factors[0] = 1;
+    factors[1] = 1;
+  }
+  return 1;
+}
+
+static void so3_fft_line_free(so3_fft_line_t *line) {
+  if (!line)
+    return;
+  free(line->twiddles);
+  free(line->chirp);
+  free(line->kernel);
+  so3_fft_line_free(line->sub);
+  free(line);
+}
+
+static so3_fft_line_t *so3_fft_line_init(int n, int sign) {
+  int k;
+  so3_fft_line_t *line = calloc(1, sizeof *line);
+  SO3_ERROR_MEM_ALLOC_CHECK(line);
+  line->n = n;
+  line->sign = sign;
+
+  if (so3_fft_factorize(line->factors, n)) {
+    line->twiddles = malloc(n * sizeof *line->twiddles);
+    SO3_ERROR_MEM_ALLOC_CHECK(line->twiddles);
+    for (k = 0; k < n; ++k)
+      line->twiddles[k] = cexp(sign * 2.0 * M_PI * I * k / n);
+    return line;
+  }
+
+  // Bluestein: a cyclic convolution of power-of-two length nb >= 2n-1.
+  for (line->nb = 1; line->nb < 2 * n - 1; line->nb *= 2)
+    ;
+  line->sub = so3_fft_line_init(line->nb, SO3_FFT_FORWARD);
+  line->chirp = malloc(n * sizeof *line->chirp);
+  SO3_ERROR_MEM_ALLOC_CHECK(line->chirp);
+  line->kernel = malloc(line->nb * sizeof *line->kernel);
+  SO3_ERROR_MEM_ALLOC_CHECK(line->kernel);
+  complex double *b = calloc(line->nb, sizeof *b);
+  SO3_ERROR_MEM_ALLOC_CHECK(b);
+  for (k = 0; k < n; ++k) {
+    // Reducing k^2 modulo 2n keeps the phase accurate.
+    long long k2 = ((long long)k * k) % (2 * n);
+    line->chirp[k] = cexp(sign * M_PI * I * (double)k2 / n);
+    b[k] = conj(line->chirp[k]);
+    if (k > 0)
+      b[line->nb - k] = b[k];
+  }
+  so3_fft_line_work(line->sub, line->kernel, b, 1, line->sub->factors);
+  for (k = 0; k < line->nb; ++k)
+    line->kernel[k] /= line->nb;
+  free(b);
+  return line;
+}
+
+static int so3_fft_line_work_size(const so3_fft_line_t *line) {
+  return line->nb ? 2 * line->nb : 0;
+}
+
+// In-place multidimensional complex transform of a contiguous row-major
+// array, one dimension at a time.
+static void so3_fft_nd(const so3_fft_plan_t *plan, complex double *data, complex double *buf) {
+  int d, i, j, k, total = 1, inner;
+  for (d = 0; d < plan->rank; ++d)
+    total *= plan->dims[d].n;
+
+  inner = total;
+  for (d = 0; d < plan->rank; ++d) {
+    const so3_fft_line_t *line = plan->lines[d];
+    const int n = line->n;
+    complex double *line_in = buf, *line_out = buf + n, *work = buf + 2 * n;
+    inner /= n;
+    for (i = 0; i < total / n; ++i) {
+      // Start of line i: outer index i / inner, inner index i % inner.
+      complex double *start = data + (i / inner) * n * inner + i % inner;
+      for (k = 0; k < n; ++k)
+        line_in[k] = start[k * inner];
+      so3_fft_line_execute(line, line_out, line_in, work);
+      for (j = 0; j < n; ++j)
+        start[j * inner] = line_out[j];
+    }
+  }
+}
+
+// Completes the Hermitian-symmetric half array, stored in the first
+// n_last/2+1 entries of each row of data, to the full array.
+static void so3_fft_hermitian_complete(const so3_fft_plan_t *plan, complex double *data) {
+  const int rank = plan->rank;
+  const int last = plan->dims[rank - 1].n;
+  int rows = 1, r, rr, d, k, rem, mul;
+  int idx[SO3_FFT_MAX_RANK];
+  for (d = 0; d < rank - 1; ++d)
+    rows *= plan->dims[d].n;
+
+  for (r = 0; r < rows; ++r) {
+    // Row with negated leading indices.
+    rem = r;
+    for (d = rank - 2; d >= 0; --d) {
+      idx[d] = rem % plan->dims[d].n;
+      rem /= plan->dims[d].n;
+    }
+    rr = 0;
+    mul = 1;
+    for (d = rank - 2; d >= 0; --d) {
+      rr += ((plan->dims[d].n - idx[d]) % plan->dims[d].n) * mul;
+      mul *= plan->dims[d].n;
+    }
+    for (k = last / 2 + 1; k < last; ++k)
+      data[r * last + k] = conj(data[rr * last + last - k]);
+  }
+}
+
+static void so3_fft_builtin_execute(const so3_fft_plan_t *plan, void *in, void *out) {
+  const int rank = plan->rank;
+  const int last = plan->dims[rank - 1].n;
+  const int half = plan->kind == SO3_FFT_C2C ? last : last / 2 + 1;
+  int total = 1, howmany = 1, buf_size = 0;
+  int d, h, i, rem, ioff, ooff, ipos, opos, k;
+
+  for (d = 0; d < rank; ++d) {
+    int size = 2 * plan->lines[d]->n + so3_fft_line_work_size(plan->lines[d]);
+    total *= plan->dims[d].n;
+    if (size > buf_size)
+      buf_size = size;
+  }
+  for (d = 0; d < plan->howmany_rank; ++d)
+    howmany *= plan->howmany_dims[d].n;
+
+  complex double *data = malloc(total * sizeof *data);
+  SO3_ERROR_MEM_ALLOC_CHECK(data);
+  complex double *buf = malloc(buf_size * sizeof *buf);
+  SO3_ERROR_MEM_ALLOC_CHECK(buf);
+
+  for (h = 0; h < howmany; ++h) {
+    ioff = ooff = 0;
+    rem = h;
+    for (d = plan->howmany_rank - 1; d >= 0; --d) {
+      ioff += (rem % plan->howmany_dims[d].n) * plan->howmany_dims[d].is;
+      ooff += (rem % plan->howmany_dims[d].n) * plan->howmany_dims[d].os;
+      rem /= plan->howmany_dims[d].n;
+    }
+
+    // Gather, including only the non-redundant half for C2R input.
+    for (i = 0; i < total; ++i) {
+      k = i % last;
+      if (plan->kind == SO3_FFT_C2R && k >= half)
+        continue;
+      rem = i;
+      ipos = ioff;
+      for (d = rank - 1; d >= 0; --d) {
+        ipos += (rem % plan->dims[d].n) * plan->dims[d].is;
+        rem /= plan->dims[d].n;
+      }
+      data[i] = plan->kind == SO3_FFT_R2C ? ((double *)in)[ipos]
+                                          : ((complex double *)in)[ipos];
+    }
+    if (plan->kind == SO3_FFT_C2R)
+      so3_fft_hermitian_complete(plan, data);
+
+    so3_fft_nd(plan, data, buf);
+
+    // Scatter, only the non-redundant half for R2C output.
+    for (i = 0; i < total; ++i) {
+      k = i % last;
+      if (plan->kind == SO3_FFT_R2C && k >= half)
+        continue;
+      rem = i;
+      opos = ooff;
+      for (d = rank - 1; d >= 0; --d) {
+        opos += (rem % plan->dims[d].n) * plan->dims[d].os;
+        rem /= plan->dims[d].n;
+      }
+      if (plan->kind == SO3_FFT_C2R)
+        ((double *)out)[opos] = creal(data[i]);
+      else
+        ((complex double *)out)[opos] = data[i];
+    }
+  }
+
+  free(data);
+  free(buf);
+}
+
+/*!
+ * Create a plan for transforms described as in FFTW's guru interface.
+ *
+ * \param[in] kind Complex, real-to-complex or complex-to-real transform.
+ * \param[in] rank Number of transform dimensions, at most 3.
+ * \param[in] dims Transform dimensions. For real transforms, n is the
+ *                 logical length of the real array, and the strides are in
+ *                 elements (double or complex double) of the respective
+ *                 array.
+ * \param[in] howmany_rank Number of loop dimensions, at most 3.
+ * \param[in] howmany_dims Loop dimensions.
+ * \param[in] in Input array.
+ * \param[in] out Output array, which may equal in.
+ * \param[in] sign SO3_FFT_FORWARD or SO3_FFT_BACKWARD. Ignored for real
+ *                 transforms, which are always forward (R2C) or backward (C2R).
+ * \param[in] flags Planning effort.
+ * \retval plan Plan, to be freed with \link so3_fft_destroy_plan \endlink.
+ */
+so3_fft_plan_t *so3_fft_plan_guru(
+    so3_fft_kind_t kind,
+    int rank,
+    const so3_fft_dim_t *dims,
+    int howmany_rank,
+    const so3_fft_dim_t *howmany_dims,
+    void *in,
+    void *out,
+    int sign,
+    so3_fft_flags_t flags) {
+  fftw_iodim fftw_dims[SO3_FFT_MAX_RANK], fftw_howmany_dims[SO3_FFT_MAX_RANK];
+  unsigned fftw_flags = flags == SO3_FFT_MEASURE ? FFTW_MEASURE : FFTW_ESTIMATE;
+  int d;
+
+  if (rank < 1 || rank > SO3_FFT_MAX_RANK || howmany_rank < 0 ||
+      howmany_rank > SO3_FFT_MAX_RANK)
+    SO3_ERROR_GENERIC("Unsupported FFT rank.");
+
+  so3_fft_plan_t *plan = calloc(1, sizeof *plan);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan);
+  plan->backend = so3_fft_backend;
+  plan->kind = kind;
+  plan->sign =
+      kind == SO3_FFT_R2C ? SO3_FFT_FORWARD : kind == SO3_FFT_C2R ? SO3_FFT_BACKWARD : sign;
+  plan->rank = rank;
+  plan->howmany_rank = howmany_rank;
+  plan->in = in;
+  plan->out = out;
+  for (d = 0; d < rank; ++d) {
+    plan->dims[d] = dims[d];
+    fftw_dims[d].n = dims[d].n;
+    fftw_dims[d].is = dims[d].is;
+    fftw_dims[d].os = dims[d].os;
+  }
+  for (d = 0; d < howmany_rank; ++d) {
+    plan->howmany_dims[d] = howmany_dims[d];
+    fftw_howmany_dims[d].n = howmany_dims[d].n;
+    fftw_howmany_dims[d].is = howmany_dims[d].is;
+    fftw_howmany_dims[d].os = howmany_dims[d].os;
+  }
+
+  switch (plan->backend) {
+  case SO3_FFT_BACKEND_FFTW:
+    so3_fft_planner_lock();
+    switch (kind) {
+    case SO3_FFT_C2C:
+      plan->fftw = fftw_plan_guru_dft(
+          rank, fftw_dims, howmany_rank, fftw_howmany_dims, in, out, sign, fftw_flags);
+      break;
+    case SO3_FFT_R2C:
+      plan->fftw = fftw_plan_guru_dft_r2c(
+          rank, fftw_dims, howmany_rank, fftw_howmany_dims, in, out, fftw_flags);
+      break;
+    case SO3_FFT_C2R:
+      plan->fftw = fftw_plan_guru_dft_c2r(
+          rank, fftw_dims, howmany_rank, fftw_howmany_dims, in, out, fftw_flags);
+      break;
+    }
+    so3_fft_planner_unlock();
+    if (!plan->fftw)
+      SO3_ERROR_GENERIC("FFTW planning failed.");
+    break;
+  case SO3_FFT_BACKEND_BUILTIN:
+    for (d = 0; d < rank; ++d)
+      plan->lines[d] = so3_fft_line_init(dims[d].n, plan->sign);
+    break;
+  default:
+    SO3_ERROR_GENERIC("Invalid FFT backend.");
+  }
+
+  return plan;
+}
+
+// Row-major strides of an array of logical size embed (or n, if NULL),
+// scaled by stride.
+static void so3_fft_many_dims(
+    so3_fft_dim_t *dims, int rank, const int *n, const int *embed, int stride, int input) {
+  int d, size = stride;
+  if (rank < 1 || rank > SO3_FFT_MAX_RANK)
+    SO3_ERROR_GENERIC("Unsupported FFT rank.");
+  for (d = rank - 1; d >= 0; --d) {
+    dims[d].n = n[d];
+    if (input)
+      dims[d].is = size;
+    else
+      dims[d].os = size;
+    size *= embed ? embed[d] : n[d];
+  }
+}
+
+/*!
+ * Create a plan for a batch of complex transforms, with the arguments of
+ * fftw_plan_many_dft.
+ */
+so3_fft_plan_t *so3_fft_plan_many_dft(
+    int rank,
+    const int *n,
+    int howmany,
+    complex double *in,
+    const int *inembed,
+    int istride,
+    int idist,
+    complex double *out,
+    const int *onembed,
+    int ostride,
+    int odist,
+    int sign,
+    so3_fft_flags_t flags) {
+  so3_fft_dim_t dims[SO3_FFT_MAX_RANK];
+  so3_fft_dim_t howmany_dims[1] = {{howmany, idist, odist}};
+  so3_fft_many_dims(dims, rank, n, inembed, istride, 1);
+  so3_fft_many_dims(dims, rank, n, onembed, ostride, 0);
+  return so3_fft_plan_guru(SO3_FFT_C2C, rank, dims, 1, howmany_dims, in, out, sign, flags);
+}
+
+/*!
+ * Create a plan for a batch of real-to-complex transforms, with the
+ * arguments of fftw_plan_many_dft_r2c. The complex output has n/2+1
+ * elements in the last dimension.
+ */
+so3_fft_plan_t *so3_fft_plan_many_dft_r2c(
+    int rank,
+    const int *n,
+    int howmany,
+    double *in,
+    const int *inembed,
+    int istride,
+    int idist,
+    complex double *out,
+    const int *onembed,
+    int ostride,
+    int odist,
+    so3_fft_flags_t flags) {
+  so3_fft_dim_t dims[SO3_FFT_MAX_RANK];
+  so3_fft_dim_t howmany_dims[1] = {{howmany, idist, odist}};
+  int half[SO3_FFT_MAX_RANK];
+  memcpy(half, n, rank * sizeof *half);
+  half[rank - 1] = n[rank - 1] / 2 + 1;
+  so3_fft_many_dims(dims, rank, n, inembed, istride, 1);
+  so3_fft_many_dims(dims, rank, n, onembed ? onembed : half, ostride, 0);
+  return so3_fft_plan_guru(
+      SO3_FFT_R2C, rank, dims, 1, howmany_dims, in, out, SO3_FFT_FORWARD, flags);
+}
+
+/*!
+ * Create a plan for a batch of complex-to-real transforms, with the
+ * arguments of fftw_plan_many_dft_c2r. See \link so3_fft_plan_many_dft_r2c
+ * \endlink.
+ */
+so3_fft_plan_t *so3_fft_plan_many_dft_c2r(
+    int rank,
+    const int *n,
+    int howmany,
+    complex double *in,
+    const int *inembed,
+    int istride,
+    int idist,
+    double *out,
+    const int *onembed,
+    int ostride,
+    int odist,
+    so3_fft_flags_t flags) {
+  so3_fft_dim_t dims[SO3_FFT_MAX_RANK];
+  so3_fft_dim_t howmany_dims[1] = {{howmany, idist, odist}};
+  int half[SO3_FFT_MAX_RANK];
+  memcpy(half, n, rank * sizeof *half);
+  half[rank - 1] = n[rank - 1] / 2 + 1;
+  so3_fft_many_dims(dims, rank, n, inembed ? inembed : half, istride, 1);
+  so3_fft_many_dims(dims, rank, n, onembed, ostride, 0);
+  return so3_fft_plan_guru(
+      SO3_FFT_C2R, rank, dims, 1, howmany_dims, in, out, SO3_FFT_BACKWARD, flags);
+}
+
+/*!
+ * Create a plan for a one-dimensional complex transform, as fftw_plan_dft_1d.
+ */
+so3_fft_plan_t *so3_fft_plan_dft_1d(
+    int n0, complex double *in, complex double *out, int sign, so3_fft_flags_t flags) {
+  so3_fft_dim_t dims[1] = {{n0, 1, 1}};
+  return so3_fft_plan_guru(SO3_FFT_C2C, 1, dims, 0, NULL, in, out, sign, flags);
+}
+
+/*!
+ * Create a plan for a row-major two-dimensional complex transform, as
+ * fftw_plan_dft_2d.
+ */
+so3_fft_plan_t *so3_fft_plan_dft_2d(
+    int n0,
+    int n1,
+    complex double *in,
+    complex double *out,
+    int sign,
+    so3_fft_flags_t flags) {
+  so3_fft_dim_t dims[2] = {{n0, n1, n1}, {n1, 1, 1}};
+  return so3_fft_plan_guru(SO3_FFT_C2C, 2, dims, 0, NULL, in, out, sign, flags);
+}
+
+/*!
+ * Create a plan for a row-major three-dimensional complex transform, as
+ * fftw_plan_dft_3d.
+ */
+so3_fft_plan_t *so3_fft_plan_dft_3d(
+    int n0,
+    int n1,
+    int n2,
+    complex double *in,
+    complex double *out,
+    int sign,
+    so3_fft_flags_t flags) {
+  so3_fft_dim_t dims[3] = {{n0, n1 * n2, n1 * n2}, {n1, n2, n2}, {n2, 1, 1}};
+  return so3_fft_plan_guru(SO3_FFT_C2C, 3, dims, 0, NULL, in, out, sign, flags);
+}
+
+/*!
+ * Create a plan for a row-major two-dimensional real-to-complex transform,
+ * as fftw_plan_dft_r2c_2d. The output has n0 x (n1/2+1) elements. If in and
+ * out coincide, the rows of the real array are padded to 2*(n1/2+1).
+ */
+so3_fft_plan_t *so3_fft_plan_dft_r2c_2d(
+    int n0, int n1, double *in, complex double *out, so3_fft_flags_t flags) {
+  const int half = n1 / 2 + 1;
+  const int row = (void *)in == (void *)out ? 2 * half : n1;
+  so3_fft_dim_t dims[2] = {{n0, row, half}, {n1, 1, 1}};
+  return so3_fft_plan_guru(SO3_FFT_R2C, 2, dims, 0, NULL, in, out, SO3_FFT_FORWARD, flags);
+}
+
+/*!
+ * Create a plan for a row-major two-dimensional complex-to-real transform,
+ * as fftw_plan_dft_c2r_2d. See \link so3_fft_plan_dft_r2c_2d \endlink.
+ */
+so3_fft_plan_t *so3_fft_plan_dft_c2r_2d(
+    int n0, int n1, complex double *in, double *out, so3_fft_flags_t flags) {
+  const int half = n1 / 2 + 1;
+  const int row = (void *)in == (void *)out ? 2 * half : n1;
+  so3_fft_dim_t dims[2] = {{n0, half, row}, {n1, 1, 1}};
+  return so3_fft_plan_guru(SO3_FFT_C2R, 2, dims, 0, NULL, in, out, SO3_FFT_BACKWARD, flags);
+}
+
+/*!
+ * Create a plan for a row-major three-dimensional complex-to-real transform,
+ * as fftw_plan_dft_c2r_3d. See \link so3_fft_plan_dft_r2c_2d \endlink.
+ */
+so3_fft_plan_t *so3_fft_plan_dft_c2r_3d(
+    int n0, int n1, int n2, complex double *in, double *out, so3_fft_flags_t flags) {
+  const int half = n2 / 2 + 1;
+  const int row = (void *)in == (void *)out ? 2 * half : n2;
+  so3_fft_dim_t dims[3] = {
+      {n0, n1 * half, n1 * row}, {n1, half, row}, {n2, 1, 1}};
+  return so3_fft_plan_guru(SO3_FFT_C2R, 3, dims, 0, NULL, in, out, SO3_FFT_BACKWARD, flags);
+}
+
+/*!
+ * Execute a plan on the arrays it was created with.
+ *
+ * \param[in] plan Plan.
+ * \retval none
+ */
+void so3_fft_execute(const so3_fft_plan_t *plan) {
+  if (plan->backend == SO3_FFT_BACKEND_FFTW)
+    fftw_execute(plan->fftw);
+  else
+    so3_fft_builtin_execute(plan, plan->in, plan->out);
+}
+
+/*!
+ * Execute a complex plan on new arrays, as fftw_execute_dft. The arrays
+ * must have the same layout, in-placeness and alignment as those the plan
+ * was created with.
+ *
+ * \param[in] plan Complex plan.
+ * \param[in] in Input array.
+ * \param[out] out Output array.
+ * \retval none
+ */
+void so3_fft_execute_dft(const so3_fft_plan_t *plan, complex double *in, complex double *out) {
+  if (plan->kind != SO3_FFT_C2C)
+    SO3_ERROR_GENERIC("so3_fft_execute_dft requires a complex plan.");
+  if (plan->backend == SO3_FFT_BACKEND_FFTW)
+    fftw_execute_dft(plan->fftw, in, out);
+  else
+    so3_fft_builtin_execute(plan, in, out);
+}
+
+/*!
+ * Free a plan.
+ *
+ * \param[in] plan Plan, may be NULL.
+ * \retval none
+ */
+void so3_fft_destroy_plan(so3_fft_plan_t *plan) {
+  int d;
+  if (!plan)
+    return;
+  if (plan->fftw) {
+    so3_fft_planner_lock();
+    fftw_destroy_plan(plan->fftw);
+    so3_fft_planner_unlock();
+  }
+  for (d = 0; d < plan->rank; ++d)
+    so3_fft_line_free(plan->lines[d]);
+  free(plan);
+}
@@ -0,0 +1,323 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_filter.c
+ * Harmonic filtering: forward transform, multiplication of every flmn by a
+ * filter h(el, m, n), and inverse transform, in one call.
+ *
+ * For complex signals that the via-SSHT transforms support, the three stages
+ * are fused. The signal is Fourier transformed in gamma once, and then for
+ * every n the spin -n SSHT forward transform, the filter and the spin -n SSHT
+ * inverse transform are applied to a single flm of L*L coefficients, which
+ * stays in cache, before the inverse Fourier transform in gamma. The full
+ * flmn array is never formed. The normalisations of the forward and inverse
+ * transforms cancel up to an overall factor 1/(2*N-1), which is folded into
+ * the filter.
+ *
+ * In all other cases, i.e. real or steerable signals, an azimuthal band-limit
+ * M < L and SO3_N_MODE_L, the signals are transformed separately into a
+ * scratch flmn array kept by the plan: for L <= SO3_SMALL_L_MAX with a small
+ * band-limit plan owned by the filter plan, and otherwise with the direct
+ * transforms signal by signal.
+ */
+
+#include <complex.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ssht/ssht.h>
+
+#include "so3/so3_alloc.h"
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_fft.h"
+#include "so3/so3_filter.h"
+#include "so3/so3_flmn.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_small.h"
+#include "so3/so3_types.h"
+
+#define MAX(a, b) ((a > b) ? (a) : (b))
+
+typedef void (*so3_filter_ssht_inverse_t)(
+    complex double *, const complex double *, int, int, int, ssht_dl_method_t, int);
+typedef void (*so3_filter_ssht_forward_t)(
+    complex double *, const complex double *, int, int, int, ssht_dl_method_t, int);
+
+struct so3_filter_plan {
+  so3_parameters_t parameters;
+  int fused;
+  int f_size, flmn_size;
+  // Fused path: samples per gamma slice and number of slices.
+  int fn_n_stride, ngamma;
+  so3_filter_ssht_forward_t ssht_forward;
+  so3_filter_ssht_inverse_t ssht_inverse;
+  // Fourier coefficients in gamma, ngamma x fn_n_stride, and one flm.
+  complex double *fn, *flm;
+  // In-place transforms in gamma of fn.
+  so3_fft_plan_t *fft_forward, *fft_backward;
+  // Separate transforms: small band-limit plan, or NULL for the direct
+  // transforms, and scratch for the flmn of flmn_batch signals.
+  so3_small_plan_t *small;
+  complex double *flmn;
+  int flmn_batch;
+};
+
+/*!
+ * Prepare the harmonic filtering of signals with the given parameters.
+ *
+ * \param[in] parameters A fully populated parameters object. The reality flag
+ *                       selects between \link so3_filter \endlink and \link
+ *                       so3_filter_real \endlink.
+ * \retval plan Plan to pass to the filter functions. Free it with \link
+ *              so3_filter_plan_free \endlink.
+ */
+so3_filter_plan_t *so3_filter_plan_init(const so3_parameters_t *parameters) {
+  so3_filter_plan_t *plan = calloc(1, sizeof *plan);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan);
+
+  plan->parameters = *parameters;
+  plan->parameters.verbosity = 0;
+  parameters = &plan->parameters;
+
+  const int L = parameters->L;
+  const int N = parameters->N;
+
+  plan->f_size = so3_sampling_f_size(parameters);
+  plan->flmn_size = so3_sampling_flmn_size(parameters);
+  plan->fused = !parameters->reality && !parameters->steerable &&
+                so3_sampling_mlim(parameters) == L &&
+                parameters->n_mode != SO3_N_MODE_L;
+  if (!plan->fused) {
+    if (L <= SO3_SMALL_L_MAX)
+      plan->small = so3_small_plan_init(parameters);
+    return plan;
+  }
+
+  switch (parameters->sampling_scheme) {
+  case SO3_SAMPLING_MW:
+    plan->fn_n_stride = L * (2 * L - 1);
+    plan->ssht_forward = ssht_core_mw_lb_forward_sov_conv_sym;
+    plan->ssht_inverse = ssht_core_mw_lb_inverse_sov_sym;
+    break;
+  case SO3_SAMPLING_MW_SS:
+    plan->fn_n_stride = (L + 1) * 2 * L;
+    plan->ssht_forward = ssht_core_mw_lb_forward_sov_conv_sym_ss;
+    plan->ssht_inverse = ssht_core_mw_lb_inverse_sov_sym_ss;
+    break;
+  default:
+    SO3_ERROR_GENERIC("Invalid sampling scheme.");
+  }
+  plan->ngamma = 2 * N - 1;
+
+  plan->fn = so3_alloc_large(plan->ngamma * plan->fn_n_stride, sizeof *plan->fn);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->fn);
+  plan->flm = malloc(L * L * sizeof *plan->flm);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->flm);
+
+  // Columns of fn, i.e. the samples of one (alpha, beta) over gamma, are
+  // strided by fn_n_stride.
+  plan->fft_forward = so3_fft_plan_many_dft(
+      1, &plan->ngamma, plan->fn_n_stride, plan->fn, NULL, plan->fn_n_stride, 1,
+      plan->fn, NULL, plan->fn_n_stride, 1, SO3_FFT_FORWARD, SO3_FFT_MEASURE);
+  plan->fft_backward = so3_fft_plan_many_dft(
+      1, &plan->ngamma, plan->fn_n_stride, plan->fn, NULL, plan->fn_n_stride, 1,
+      plan->fn, NULL, plan->fn_n_stride, 1, SO3_FFT_BACKWARD, SO3_FFT_MEASURE);
+
+  return plan;
+}
+
+/*!
+ * Free a filter plan.
+ *
+ * \param[in] plan Plan, may be NULL.
+ * \retval none
+ */
+void so3_filter_plan_free(so3_filter_plan_t *plan) {
+  if (plan == NULL)
+    return;
+  if (plan->fused) {
+    so3_fft_destroy_plan(plan->fft_forward);
+    so3_fft_destroy_plan(plan->fft_backward);
+    so3_alloc_free(plan->fn);
+    free(plan->flm);
+  }
+  so3_small_plan_free(plan->small);
+  so3_alloc_free(plan->flmn);
+  free(plan);
+}
+
+/*!
+ * Whether the plan fuses the transforms and the filter via SSHT, rather than
+ * falling back to separate transforms.
+ *
+ * \param[in] plan Plan.
+ * \retval fused 1 if fused, 0 otherwise.
+ */
+int so3_filter_plan_is_fused(const so3_filter_plan_t *plan) { return plan->fused; }
+
+// Filter one complex signal, fusing the stages per n.
+static void so3_filter_fused(
+    complex double *g, const complex double *f, const so3_filter_t *filter,
+    so3_filter_plan_t *plan) {
+  const so3_parameters_t *parameters = &plan->parameters;
+  const int L0 = parameters->L0;
+  const int L = parameters->L;
+  const int N = parameters->N;
+  const so3_n_mode_t n_mode = parameters->n_mode;
+  const double scale = 1.0 / plan->ngamma;
+  int n, el, m;
+
+  memcpy(plan->fn, f, plan->f_size * sizeof *f);
+  so3_fft_execute(plan->fft_forward);
+
+  for (n = -N + 1; n <= N - 1; ++n) {
+    const int L0e = MAX(L0, abs(n));
+    // fn is stored in n-order 0, 1, 2, -2, -1.
+    const int offset = n < 0 ? n + plan->ngamma : n;
+    complex double *fn_n = plan->fn + offset * plan->fn_n_stride;
+
+    if ((n_mode == SO3_N_MODE_EVEN && n % 2) ||
+        (n_mode == SO3_N_MODE_ODD && !(n % 2)) ||
+        (n_mode == SO3_N_MODE_MAXIMUM && abs(n) < N - 1)) {
+      memset(fn_n, 0, plan->fn_n_stride * sizeof *fn_n);
+      continue;
+    }
+
+    (*plan->ssht_forward)(
+        plan->flm, fn_n, L0e, L, -n, parameters->dl_method, parameters->verbosity);
+
+    // The signs (-1)^n of the forward and inverse transforms cancel.
+    for (el = L0e; el < L; ++el) {
+      complex double *flm = plan->flm + el * el + el;
+      double w = scale;
+      if (filter->eln)
+        w *= filter->eln[el * (2 * N - 1) + N - 1 + n];
+      if (filter->elmn) {
+        int ind;
+        so3_sampling_elmn2ind(&ind, el, 0, n, parameters);
+        for (m = -el; m <= el; ++m)
+          flm[m] *= w * filter->elmn[ind + m];
+      } else {
+        for (m = -el; m <= el; ++m)
+          flm[m] *= w;
+      }
+    }
+
+    (*plan->ssht_inverse)(
+        fn_n, plan->flm, L0e, L, -n, parameters->dl_method, parameters->verbosity);
+  }
+
+  so3_fft_execute(plan->fft_backward);
+  memcpy(g, plan->fn, plan->f_size * sizeof *g);
+}
+
+// Scratch of the plan for the flmn of a batch, grown as needed.
+static complex double *so3_filter_scratch(so3_filter_plan_t *plan, int batch) {
+  if (batch > plan->flmn_batch) {
+    so3_alloc_free(plan->flmn);
+    plan->flmn = so3_alloc_large((size_t)batch * plan->flmn_size, sizeof *plan->flmn);
+    SO3_ERROR_MEM_ALLOC_CHECK(plan->flmn);
+    plan->flmn_batch = batch;
+  }
+  return plan->flmn;
+}
+
+// Apply the filter to a batch of flmn arrays.
+static void so3_filter_apply(
+    complex double *flmn, const so3_filter_t *filter, int batch,
+    const so3_filter_plan_t *plan) {
+  int k, i;
+  for (k = 0; k < batch; ++k) {
+    complex double *x = flmn + k * plan->flmn_size;
+    if (filter->eln)
+      so3_flmn_scale_by_eln(x, filter->eln, &plan->parameters);
+    if (filter->elmn)
+      for (i = 0; i < plan->flmn_size; ++i)
+        x[i] *= filter->elmn[i];
+  }
+}
+
+/*!
+ * Filter a batch of complex signals, i.e. compute the inverse transform of
+ * h(el, m, n) flmn, where flmn is the forward transform of f.
+ *
+ * \param[out] g Filtered signals, stored one after the other, each of size
+ *               \link so3_sampling_f_size \endlink. May be the same array as f.
+ * \param[in] f Signals, stored one after the other. They are assumed to be
+ *              band-limited, as for the forward transforms.
+ * \param[in] filter Filter. For the (el, m, n) factor, entries that are zero by
+ *                   construction, e.g. padding, must still be finite.
+ * \param[in] batch Number of signals.
+ * \param[in,out] plan Plan for complex signals, whose scratch is reused.
+ * \retval none
+ */
+void so3_filter(
+    SO3_COMPLEX(double) * g, const SO3_COMPLEX(double) * f, const so3_filter_t *filter,
+    int batch, so3_filter_plan_t *plan) {
+  int k;
+
+  if (plan->parameters.reality)
+    SO3_ERROR_GENERIC("Plan is for real signals. Use so3_filter_real instead.");
+
+  if (plan->fused) {
+    for (k = 0; k < batch; ++k)
+      so3_filter_fused(g + k * plan->f_size, f + k * plan->f_size, filter, plan);
+    return;
+  }
+
+  complex double *flmn = so3_filter_scratch(plan, batch);
+  if (plan->small) {
+    so3_small_forward(flmn, f, batch, plan->small);
+    so3_filter_apply(flmn, filter, batch, plan);
+    so3_small_inverse(g, flmn, batch, plan->small);
+    return;
+  }
+  for (k = 0; k < batch; ++k)
+    so3_core_forward_direct(
+        flmn + k * plan->flmn_size, f + k * plan->f_size, &plan->parameters);
+  so3_filter_apply(flmn, filter, batch, plan);
+  for (k = 0; k < batch; ++k)
+    so3_core_inverse_direct(
+        g + k * plan->f_size, flmn + k * plan->flmn_size, &plan->parameters);
+}
+
+/*!
+ * Filter a batch of real signals, see \link so3_filter \endlink.
+ *
+ * \param[out] g Filtered signals, stored one after the other. May be the same
+ *               array as f.
+ * \param[in] f Real signals, stored one after the other.
+ * \param[in] filter Filter. It must satisfy h(el, -m, -n) = conj(h(el, m, n)),
+ *                   so that the filtered signals are real. Only n >= 0 is
+ *                   read, and the (el, m, n) factor is in the flmn layout of
+ *                   real signals.
+ * \param[in] batch Number of signals.
+ * \param[in,out] plan Plan for real signals, whose scratch is reused.
+ * \retval none
+ */
+void so3_filter_real(
+    double *g, const double *f, const so3_filter_t *filter, int batch,
+    so3_filter_plan_t *plan) {
+  int k;
+
+  if (!plan->parameters.reality)
+    SO3_ERROR_GENERIC("Plan is for complex signals. Use so3_filter instead.");
+
+  complex double *flmn = so3_filter_scratch(plan, batch);
+  if (plan->small) {
+    so3_small_forward_real(flmn, f, batch, plan->small);
+    so3_filter_apply(flmn, filter, batch, plan);
+    so3_small_inverse_real(g, flmn, batch, plan->small);
+    return;
+  }
+  for (k = 0; k < batch; ++k)
+    so3_core_forward_direct_real(
+        flmn + k * plan->flmn_size, f + k * plan->f_size, &plan->parameters);
+  so3_filter_apply(flmn, filter, batch, plan);
+  for (k = 0; k < batch; ++k)
+    so3_core_inverse_direct_real(
+        g + k * plan->f_size, flmn + k * plan->flmn_size, &plan->parameters);
+}
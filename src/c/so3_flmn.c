@@ -0,0 +1,392 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_flmn.c
+ * Level-1 algebra on harmonic coefficients.
+ *
+ * The kernels only visit the coefficients that can be non-zero for the given
+ * parameters, i.e. they skip the padding of padded storage, the degrees below
+ * L0 and the n excluded by the n-mode. For every (el, n), these coefficients
+ * are contiguous in m for all storage methods and n-orders, so the array is
+ * described once by a table of runs and the kernels are plain loops over
+ * interleaved doubles, which the compiler vectorises. With OpenMP, large
+ * arrays are split over el between threads.
+ *
+ * For real signals only the coefficients with n >= 0 are stored. The kernels
+ * account for the implied n < 0 coefficients, so that inner products and
+ * norms are those of the full arrays.
+ *
+ * Changing the band-limits copies the same runs as blocks, which also converts
+ * between storage methods and n-orders.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "so3/so3_error.h"
+#include "so3/so3_flmn.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+
+#include "so3_omp.h"
+
+#define MIN(a, b) ((a < b) ? (a) : (b))
+
+// Arrays with fewer coefficients are processed by a single thread.
+#define SO3_FLMN_PARALLEL_MIN 32768
+
+typedef struct {
+  int L, N, reality, parallel;
+  // Runs of degree el are run_start[el] .. run_start[el + 1] - 1.
+  int *run_start;
+  // flmn index of m = -min(el, M-1), n and length of each run.
+  int *ind, *n, *size;
+} so3_flmn_runs_t;
+
+static void so3_flmn_runs_init(
+    so3_flmn_runs_t *runs, const so3_parameters_t *parameters) {
+  const int L = parameters->L;
+  const int N = parameters->N;
+  const int M = so3_sampling_mlim(parameters);
+  int el, n, n_start, n_stop, n_inc, nruns;
+
+  runs->L = L;
+  runs->N = N;
+  runs->reality = parameters->reality;
+  runs->parallel = so3_sampling_flmn_size(parameters) >= SO3_FLMN_PARALLEL_MIN;
+  runs->run_start = malloc((L + 1) * sizeof *runs->run_start);
+  runs->ind = malloc(L * (2 * N - 1) * sizeof *runs->ind);
+  runs->n = malloc(L * (2 * N - 1) * sizeof *runs->n);
+  runs->size = malloc(L * (2 * N - 1) * sizeof *runs->size);
+  SO3_ERROR_MEM_ALLOC_CHECK(runs->run_start);
+  SO3_ERROR_MEM_ALLOC_CHECK(runs->ind);
+  SO3_ERROR_MEM_ALLOC_CHECK(runs->n);
+  SO3_ERROR_MEM_ALLOC_CHECK(runs->size);
+
+  so3_sampling_n_loop_values(&n_start, &n_stop, &n_inc, parameters);
+  nruns = 0;
+  for (el = 0; el < L; ++el) {
+    const int mmax = MIN(el, M - 1);
+    runs->run_start[el] = nruns;
+    for (n = n_start; n <= n_stop; n += n_inc) {
+      if (!so3_sampling_is_elmn_non_zero(el, 0, n, parameters))
+        continue;
+      if (parameters->reality)
+        so3_sampling_elmn2ind_real(&runs->ind[nruns], el, -mmax, n, parameters);
+      else
+        so3_sampling_elmn2ind(&runs->ind[nruns], el, -mmax, n, parameters);
+      runs->n[nruns] = n;
+      runs->size[nruns] = 2 * mmax + 1;
+      ++nruns;
+    }
+  }
+  runs->run_start[L] = nruns;
+}
+
+static void so3_flmn_runs_free(so3_flmn_runs_t *runs) {
+  free(runs->run_start);
+  free(runs->ind);
+  free(runs->n);
+  free(runs->size);
+}
+
+/*!
+ * Compute y = alpha*x + y.
+ *
+ * \param[in,out] y Harmonic coefficients.
+ * \param[in] alpha Scalar factor. For real signals it should be real, since a
+ *                  complex factor does not preserve the conjugate symmetry.
+ * \param[in] x Harmonic coefficients.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval none
+ *
+ * \note Coefficients that are zero by construction, e.g. padding, are not
+ *       accessed.
+ */
+void so3_flmn_axpy(
+    SO3_COMPLEX(double) * y, SO3_COMPLEX(double) alpha, const SO3_COMPLEX(double) * x,
+    const so3_parameters_t *parameters) {
+  const double ar = creal(alpha), ai = cimag(alpha);
+  so3_flmn_runs_t runs;
+  int el;
+
+  so3_flmn_runs_init(&runs, parameters);
+  SO3_PRAGMA(omp parallel for schedule(dynamic) if (runs.parallel))
+  for (el = 0; el < runs.L; ++el) {
+    int r, k;
+    for (r = runs.run_start[el]; r < runs.run_start[el + 1]; ++r) {
+      double *restrict yd = (double *)(y + runs.ind[r]);
+      const double *restrict xd = (const double *)(x + runs.ind[r]);
+      const int size = runs.size[r];
+      SO3_PRAGMA(omp simd)
+      for (k = 0; k < size; ++k) {
+        const double xr = xd[2 * k], xi = xd[2 * k + 1];
+        yd[2 * k] += ar * xr - ai * xi;
+        yd[2 * k + 1] += ar * xi + ai * xr;
+      }
+    }
+  }
+  so3_flmn_runs_free(&runs);
+}
+
+/*!
+ * Compute x = alpha*x.
+ *
+ * \param[in,out] x Harmonic coefficients.
+ * \param[in] alpha Scalar factor. For real signals it should be real.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_flmn_scale(
+    SO3_COMPLEX(double) * x, SO3_COMPLEX(double) alpha,
+    const so3_parameters_t *parameters) {
+  const double ar = creal(alpha), ai = cimag(alpha);
+  so3_flmn_runs_t runs;
+  int el;
+
+  so3_flmn_runs_init(&runs, parameters);
+  SO3_PRAGMA(omp parallel for schedule(dynamic) if (runs.parallel))
+  for (el = 0; el < runs.L; ++el) {
+    int r, k;
+    for (r = runs.run_start[el]; r < runs.run_start[el + 1]; ++r) {
+      double *restrict xd = (double *)(x + runs.ind[r]);
+      const int size = runs.size[r];
+      SO3_PRAGMA(omp simd)
+      for (k = 0; k < size; ++k) {
+        const double xr = xd[2 * k], xi = xd[2 * k + 1];
+        xd[2 * k] = ar * xr - ai * xi;
+        xd[2 * k + 1] = ar * xi + ai * xr;
+      }
+    }
+  }
+  so3_flmn_runs_free(&runs);
+}
+
+// Multiply the coefficients of (el, n) by weights[el * stride + n * n_step].
+static void so3_flmn_scale_weighted(
+    SO3_COMPLEX(double) * x, const double *weights, int stride, int n_step,
+    const so3_parameters_t *parameters) {
+  so3_flmn_runs_t runs;
+  int el;
+
+  so3_flmn_runs_init(&runs, parameters);
+  SO3_PRAGMA(omp parallel for schedule(dynamic) if (runs.parallel))
+  for (el = 0; el < runs.L; ++el) {
+    int r, k;
+    for (r = runs.run_start[el]; r < runs.run_start[el + 1]; ++r) {
+      double *restrict xd = (double *)(x + runs.ind[r]);
+      const int size = 2 * runs.size[r];
+      const double w = weights[el * stride + n_step * runs.n[r]];
+      SO3_PRAGMA(omp simd)
+      for (k = 0; k < size; ++k)
+        xd[k] *= w;
+    }
+  }
+  so3_flmn_runs_free(&runs);
+}
+
+/*!
+ * Multiply the coefficients of every degree el by weights[el].
+ *
+ * \param[in,out] x Harmonic coefficients.
+ * \param[in] weights Weights of the L degrees.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_flmn_scale_by_el(
+    SO3_COMPLEX(double) * x, const double *weights,
+    const so3_parameters_t *parameters) {
+  so3_flmn_scale_weighted(x, weights, 1, 0, parameters);
+}
+
+/*!
+ * Multiply the coefficients of every (el, n) by weights[el*(2*N-1) + N-1 + n].
+ *
+ * \param[in,out] x Harmonic coefficients.
+ * \param[in] weights Weights, an L x (2*N-1) array. For real signals, only the
+ *                    entries with n >= 0 are read and the weights of -n are
+ *                    taken to be those of n.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_flmn_scale_by_eln(
+    SO3_COMPLEX(double) * x, const double *weights,
+    const so3_parameters_t *parameters) {
+  const int N = parameters->N;
+  // The n-offset is folded into the weights pointer.
+  so3_flmn_scale_weighted(x, weights + N - 1, 2 * N - 1, 1, parameters);
+}
+
+// Sum of w(el, n) conj(x) y, with w(el, n) = weights[el*(2*N-1) + N-1 + n],
+// or w = 1 if weights is NULL.
+static SO3_COMPLEX(double) so3_flmn_dot_weighted(
+    const SO3_COMPLEX(double) * x, const SO3_COMPLEX(double) * y,
+    const double *weights, const so3_parameters_t *parameters) {
+  const int stride = 2 * parameters->N - 1;
+  so3_flmn_runs_t runs;
+  double re = 0.0, im = 0.0;
+  int el;
+
+  so3_flmn_runs_init(&runs, parameters);
+  SO3_PRAGMA(omp parallel for schedule(dynamic) reduction(+ : re, im) \
+             if (runs.parallel))
+  for (el = 0; el < runs.L; ++el) {
+    int r, k;
+    for (r = runs.run_start[el]; r < runs.run_start[el + 1]; ++r) {
+      const double *restrict xd = (const double *)(x + runs.ind[r]);
+      const double *restrict yd = (const double *)(y + runs.ind[r]);
+      const int size = runs.size[r];
+      double sr = 0.0, si = 0.0;
+      SO3_PRAGMA(omp simd reduction(+ : sr, si))
+      for (k = 0; k < size; ++k) {
+        const double xr = xd[2 * k], xi = xd[2 * k + 1];
+        const double yr = yd[2 * k], yi = yd[2 * k + 1];
+        sr += xr * yr + xi * yi;
+        si += xr * yi - xi * yr;
+      }
+      if (weights) {
+        const double w = weights[el * stride + runs.N - 1 + runs.n[r]];
+        sr *= w;
+        si *= w;
+      }
+      // The coefficients of -n contribute the complex conjugate.
+      if (runs.reality && runs.n[r] > 0)
+        re += 2.0 * sr;
+      else {
+        re += sr;
+        im += si;
+      }
+    }
+  }
+  so3_flmn_runs_free(&runs);
+  return re + I * im;
+}
+
+/*!
+ * Compute the inner product sum conj(x) y over all harmonic coefficients.
+ *
+ * \param[in] x Harmonic coefficients.
+ * \param[in] y Harmonic coefficients.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval dot Inner product. For real signals, it includes the coefficients
+ *             with n < 0 that are not stored.
+ */
+SO3_COMPLEX(double)
+so3_flmn_dot(
+    const SO3_COMPLEX(double) * x, const SO3_COMPLEX(double) * y,
+    const so3_parameters_t *parameters) {
+  return so3_flmn_dot_weighted(x, y, NULL, parameters);
+}
+
+/*!
+ * Compute the weighted inner product sum w(el, n) conj(x) y over all harmonic
+ * coefficients, where w(el, n) = weights[el*(2*N-1) + N-1 + n].
+ *
+ * \param[in] x Harmonic coefficients.
+ * \param[in] y Harmonic coefficients.
+ * \param[in] weights Weights, an L x (2*N-1) array. For real signals, only the
+ *                    entries with n >= 0 are read.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval dot Weighted inner product.
+ */
+SO3_COMPLEX(double)
+so3_flmn_weighted_dot(
+    const SO3_COMPLEX(double) * x, const SO3_COMPLEX(double) * y,
+    const double *weights, const so3_parameters_t *parameters) {
+  return so3_flmn_dot_weighted(x, y, weights, parameters);
+}
+
+/*!
+ * Compute the 2-norm of harmonic coefficients.
+ *
+ * \param[in] x Harmonic coefficients.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval norm Norm of x.
+ */
+double so3_flmn_norm(
+    const SO3_COMPLEX(double) * x, const so3_parameters_t *parameters) {
+  return sqrt(creal(so3_flmn_dot_weighted(x, x, NULL, parameters)));
+}
+
+/*!
+ * Compute the 2-norm of the harmonic coefficients of every degree el.
+ *
+ * \param[out] norms Norms of the L degrees, zero for el < L0.
+ * \param[in] x Harmonic coefficients.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_flmn_norm_per_el(
+    double *norms, const SO3_COMPLEX(double) * x, const so3_parameters_t *parameters) {
+  so3_flmn_runs_t runs;
+  int el;
+
+  so3_flmn_runs_init(&runs, parameters);
+  SO3_PRAGMA(omp parallel for schedule(dynamic) if (runs.parallel))
+  for (el = 0; el < runs.L; ++el) {
+    double sum = 0.0;
+    int r, k;
+    for (r = runs.run_start[el]; r < runs.run_start[el + 1]; ++r) {
+      const double *restrict xd = (const double *)(x + runs.ind[r]);
+      const int size = 2 * runs.size[r];
+      double s = 0.0;
+      SO3_PRAGMA(omp simd reduction(+ : s))
+      for (k = 0; k < size; ++k)
+        s += xd[k] * xd[k];
+      sum += (runs.reality && runs.n[r] > 0) ? 2.0 * s : s;
+    }
+    norms[el] = sqrt(sum);
+  }
+  so3_flmn_runs_free(&runs);
+}
+
+/*!
+ * Copy harmonic coefficients to different band-limits, storage method or
+ * n-order, truncating or zero-padding them.
+ *
+ * \param[out] flmn_out Harmonic coefficients for parameters_out. Coefficients
+ *                      that do not exist for parameters_in are set to zero.
+ * \param[in] parameters_out A fully populated parameters object.
+ * \param[in] flmn_in Harmonic coefficients for parameters_in.
+ * \param[in] parameters_in A fully populated parameters object with the same
+ *                          reality flag as parameters_out.
+ * \retval none
+ */
+void so3_flmn_change_bandlimit(
+    SO3_COMPLEX(double) * flmn_out, const so3_parameters_t *parameters_out,
+    const SO3_COMPLEX(double) * flmn_in, const so3_parameters_t *parameters_in) {
+  const int M_in = so3_sampling_mlim(parameters_in);
+  so3_flmn_runs_t runs;
+  int el;
+
+  if (parameters_out->reality != parameters_in->reality)
+    SO3_ERROR_GENERIC("Both coefficient arrays must be real or complex.");
+
+  memset(flmn_out, 0, so3_sampling_flmn_size(parameters_out) * sizeof *flmn_out);
+  so3_flmn_runs_init(&runs, parameters_out);
+  SO3_PRAGMA(omp parallel for schedule(dynamic) if (runs.parallel))
+  for (el = 0; el < MIN(runs.L, parameters_in->L); ++el) {
+    const int mmax_in = MIN(el, M_in - 1);
+    int r;
+    for (r = runs.run_start[el]; r < runs.run_start[el + 1]; ++r) {
+      const int n = runs.n[r];
+      const int mmax_out = (runs.size[r] - 1) / 2;
+      const int mmax = MIN(mmax_in, mmax_out);
+      int ind_in;
+      if (!so3_sampling_is_elmn_non_zero(el, 0, n, parameters_in))
+        continue;
+      if (parameters_in->reality)
+        so3_sampling_elmn2ind_real(&ind_in, el, -mmax, n, parameters_in);
+      else
+        so3_sampling_elmn2ind(&ind_in, el, -mmax, n, parameters_in);
+      memcpy(
+          flmn_out + runs.ind[r] + mmax_out - mmax, flmn_in + ind_in,
+          (2 * mmax + 1) * sizeof *flmn_out);
+    }
+  }
+  so3_flmn_runs_free(&runs);
+}
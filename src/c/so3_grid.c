@@ -0,0 +1,269 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_grid.c
+ * Coordinates of the sampling grid in bulk, and lookup of arbitrary rotations
+ * on the grid.
+ *
+ * Rotations are given by Euler angles (alpha, beta, gamma) in the zyz
+ * convention of the transforms, R = Rz(alpha) Ry(beta) Rz(gamma), by unit
+ * quaternions (w, x, y, z), or by row-major 3x3 rotation matrices. The grid
+ * is uniform in each angle, so the lookup of a rotation is a scaling and a
+ * rounding per angle, without any search. The loops over the rotations are
+ * free of branches apart from the clamping in beta, so that they vectorise.
+ *
+ * Lookups work on the Euler angles: the nearest sample is nearest in each
+ * angle separately. For steerable signals, gamma is sampled on [0, pi) and is
+ * reduced modulo pi.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "so3/so3_error.h"
+#include "so3/so3_grid.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+
+#include "so3_omp.h"
+
+// Below this sin(beta), rotation matrices are treated as rotations about z.
+#define SO3_GRID_POLE_EPSILON 1e-12
+
+// Steps and offsets of the grid in each angle.
+typedef struct {
+  int nalpha, nbeta, ngamma;
+  double alpha_step, beta_start, beta_step, gamma_period, gamma_step;
+} so3_grid_t;
+
+static void so3_grid_init(so3_grid_t *grid, const so3_parameters_t *parameters) {
+  grid->nalpha = so3_sampling_nalpha(parameters);
+  grid->nbeta = so3_sampling_nbeta(parameters);
+  grid->ngamma = so3_sampling_ngamma(parameters);
+  grid->alpha_step = 2.0 * SO3_PI / grid->nalpha;
+  grid->beta_start = so3_sampling_b2beta(0, parameters);
+  grid->beta_step = so3_sampling_b2beta(1, parameters) - grid->beta_start;
+  grid->gamma_period = parameters->steerable ? SO3_PI : 2.0 * SO3_PI;
+  grid->gamma_step = grid->gamma_period / grid->ngamma;
+}
+
+// Reduce an angle to [0, period).
+static inline double so3_grid_wrap(double angle, double period) {
+  return angle - period * floor(angle / period);
+}
+
+/*!
+ * Compute the Euler angles of every sample of the grid.
+ *
+ * \param[out] alphas Angles alpha, in the layout of the signal f, i.e. of size
+ *                    \link so3_sampling_f_size \endlink. May be NULL.
+ * \param[out] betas Angles beta, as alphas. May be NULL.
+ * \param[out] gammas Angles gamma, as alphas. May be NULL.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_grid_coordinates(
+    double *alphas, double *betas, double *gammas, const so3_parameters_t *parameters) {
+  so3_grid_t grid;
+  int a, b, g;
+
+  so3_grid_init(&grid, parameters);
+  for (g = 0; g < grid.ngamma; ++g) {
+    const double gamma = so3_sampling_g2gamma(g, parameters);
+    for (b = 0; b < grid.nbeta; ++b) {
+      const double beta = so3_sampling_b2beta(b, parameters);
+      const int offset = grid.nalpha * (b + grid.nbeta * g);
+      for (a = 0; a < grid.nalpha; ++a) {
+        if (alphas)
+          alphas[offset + a] = so3_sampling_a2alpha(a, parameters);
+        if (betas)
+          betas[offset + a] = beta;
+        if (gammas)
+          gammas[offset + a] = gamma;
+      }
+    }
+  }
+}
+
+/*!
+ * Compute the unit quaternions of every sample of the grid.
+ *
+ * \param[out] quaternions Quaternions (w, x, y, z) of the samples, 4 values per
+ *                         sample in the layout of the signal f.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_grid_quaternions(double *quaternions, const so3_parameters_t *parameters) {
+  const int f_size = so3_sampling_f_size(parameters);
+  double *angles = malloc(3 * f_size * sizeof *angles);
+  SO3_ERROR_MEM_ALLOC_CHECK(angles);
+
+  so3_grid_coordinates(angles, angles + f_size, angles + 2 * f_size, parameters);
+  so3_grid_euler_to_quaternion(
+      quaternions, angles, angles + f_size, angles + 2 * f_size, f_size);
+  free(angles);
+}
+
+/*!
+ * Convert Euler angles to unit quaternions.
+ *
+ * \param[out] quaternions Quaternions (w, x, y, z), 4 values per rotation.
+ * \param[in] alphas Angles alpha.
+ * \param[in] betas Angles beta.
+ * \param[in] gammas Angles gamma.
+ * \param[in] count Number of rotations.
+ * \retval none
+ */
+void so3_grid_euler_to_quaternion(
+    double *quaternions, const double *alphas, const double *betas,
+    const double *gammas, int count) {
+  int i;
+  SO3_PRAGMA(omp simd)
+  for (i = 0; i < count; ++i) {
+    const double sum = 0.5 * (alphas[i] + gammas[i]);
+    const double difference = 0.5 * (alphas[i] - gammas[i]);
+    const double c = cos(0.5 * betas[i]), s = sin(0.5 * betas[i]);
+    quaternions[4 * i] = c * cos(sum);
+    quaternions[4 * i + 1] = -s * sin(difference);
+    quaternions[4 * i + 2] = s * cos(difference);
+    quaternions[4 * i + 3] = c * sin(sum);
+  }
+}
+
+/*!
+ * Convert unit quaternions to Euler angles.
+ *
+ * \param[out] alphas Angles alpha in [0, 2*pi).
+ * \param[out] betas Angles beta in [0, pi].
+ * \param[out] gammas Angles gamma in [0, 2*pi). For rotations about z, i.e.
+ *                    beta = 0 or pi, alpha and gamma are not unique, and the
+ *                    rotation is split evenly between them.
+ * \param[in] quaternions Quaternions (w, x, y, z), 4 values per rotation. Both
+ *                        q and -q give the same angles.
+ * \param[in] count Number of rotations.
+ * \retval none
+ */
+void so3_grid_quaternion_to_euler(
+    double *alphas, double *betas, double *gammas, const double *quaternions,
+    int count) {
+  int i;
+  SO3_PRAGMA(omp simd)
+  for (i = 0; i < count; ++i) {
+    const double w = quaternions[4 * i], x = quaternions[4 * i + 1];
+    const double y = quaternions[4 * i + 2], z = quaternions[4 * i + 3];
+    const double sum = atan2(z, w), difference = atan2(-x, y);
+    betas[i] = 2.0 * atan2(sqrt(x * x + y * y), sqrt(w * w + z * z));
+    alphas[i] = so3_grid_wrap(sum + difference, 2.0 * SO3_PI);
+    gammas[i] = so3_grid_wrap(sum - difference, 2.0 * SO3_PI);
+  }
+}
+
+/*!
+ * Convert rotation matrices to Euler angles.
+ *
+ * \param[out] alphas Angles alpha in [0, 2*pi).
+ * \param[out] betas Angles beta in [0, pi].
+ * \param[out] gammas Angles gamma in [0, 2*pi). For rotations about z, i.e.
+ *                    beta = 0 or pi, gamma is set to zero.
+ * \param[in] matrices Row-major 3x3 rotation matrices, 9 values per rotation.
+ * \param[in] count Number of rotations.
+ * \retval none
+ */
+void so3_grid_matrix_to_euler(
+    double *alphas, double *betas, double *gammas, const double *matrices, int count) {
+  int i;
+  for (i = 0; i < count; ++i) {
+    const double *R = matrices + 9 * i;
+    const double sin_beta = sqrt(R[2] * R[2] + R[5] * R[5]);
+    betas[i] = atan2(sin_beta, R[8]);
+    if (sin_beta > SO3_GRID_POLE_EPSILON) {
+      alphas[i] = atan2(R[5], R[2]);
+      gammas[i] = atan2(R[7], -R[6]);
+    } else {
+      // R = Rz(alpha + gamma) at beta = 0, and Rz(alpha - gamma) Ry(pi) at
+      // beta = pi.
+      alphas[i] = R[8] > 0 ? atan2(R[3], R[0]) : atan2(-R[3], -R[0]);
+      gammas[i] = 0.0;
+    }
+    alphas[i] = so3_grid_wrap(alphas[i], 2.0 * SO3_PI);
+    gammas[i] = so3_grid_wrap(gammas[i], 2.0 * SO3_PI);
+  }
+}
+
+/*!
+ * Find the nearest sample of the grid to each of a set of rotations.
+ *
+ * \param[out] indices Index into the signal f of the nearest sample of each
+ *                     rotation.
+ * \param[in] alphas Angles alpha, any real value.
+ * \param[in] betas Angles beta in [0, pi].
+ * \param[in] gammas Angles gamma, any real value.
+ * \param[in] count Number of rotations.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_grid_nearest(
+    int *indices, const double *alphas, const double *betas, const double *gammas,
+    int count, const so3_parameters_t *parameters) {
+  so3_grid_t grid;
+  int i;
+
+  so3_grid_init(&grid, parameters);
+  const double alpha_scale = 1.0 / grid.alpha_step;
+  const double beta_scale = 1.0 / grid.beta_step;
+  const double gamma_scale = 1.0 / grid.gamma_step;
+  SO3_PRAGMA(omp simd)
+  for (i = 0; i < count; ++i) {
+    int a = (int)floor(so3_grid_wrap(alphas[i], 2.0 * SO3_PI) * alpha_scale + 0.5);
+    int b = (int)floor((betas[i] - grid.beta_start) * beta_scale + 0.5);
+    int g = (int)floor(
+        so3_grid_wrap(gammas[i], grid.gamma_period) * gamma_scale + 0.5);
+    a = a >= grid.nalpha ? a - grid.nalpha : a;
+    b = b < 0 ? 0 : (b >= grid.nbeta ? grid.nbeta - 1 : b);
+    g = g >= grid.ngamma ? g - grid.ngamma : g;
+    indices[i] = a + grid.nalpha * (b + grid.nbeta * g);
+  }
+}
+
+/*!
+ * Find the cell of the grid that encloses each of a set of rotations.
+ *
+ * \param[out] cells Enclosing cells. In beta, rotations outside the range of
+ *                   the samples, i.e. near the poles, are assigned to the
+ *                   first or last cell with the fraction clamped to [0, 1].
+ * \param[in] alphas Angles alpha, any real value.
+ * \param[in] betas Angles beta in [0, pi].
+ * \param[in] gammas Angles gamma, any real value.
+ * \param[in] count Number of rotations.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_grid_enclosing(
+    so3_grid_cell_t *cells, const double *alphas, const double *betas,
+    const double *gammas, int count, const so3_parameters_t *parameters) {
+  so3_grid_t grid;
+  int i;
+
+  so3_grid_init(&grid, parameters);
+  const double alpha_scale = 1.0 / grid.alpha_step;
+  const double beta_scale = 1.0 / grid.beta_step;
+  const double gamma_scale = 1.0 / grid.gamma_step;
+  SO3_PRAGMA(omp simd)
+  for (i = 0; i < count; ++i) {
+    const double x = so3_grid_wrap(alphas[i], 2.0 * SO3_PI) * alpha_scale;
+    const double y = (betas[i] - grid.beta_start) * beta_scale;
+    const double z = so3_grid_wrap(gammas[i], grid.gamma_period) * gamma_scale;
+    int a = (int)floor(x), b = (int)floor(y), g = (int)floor(z);
+    double tb;
+    cells[i].ta = x - a;
+    cells[i].tg = z - g;
+    b = b < 0 ? 0 : (b > grid.nbeta - 2 ? grid.nbeta - 2 : b);
+    tb = y - b;
+    cells[i].tb = tb < 0.0 ? 0.0 : (tb > 1.0 ? 1.0 : tb);
+    cells[i].a = a >= grid.nalpha ? a - grid.nalpha : a;
+    cells[i].b = b;
+    cells[i].g = g >= grid.ngamma ? g - grid.ngamma : g;
+  }
+}
@@ -0,0 +1,331 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_interp.c
+ * Approximate evaluation of sampled signals at arbitrary rotations by local
+ * interpolation on the grid.
+ *
+ * The signal f, in the layout of the inverse transforms, is interpolated
+ * separately in alpha, beta and gamma, linearly from 2x2x2 samples or by cubic
+ * convolution (Catmull-Rom) from 4x4x4 samples. Alpha and gamma are periodic.
+ * In beta, the stencil reaches across the poles into rows beyond the sampled
+ * range, which are filled with f(alpha, -beta, gamma) = f(alpha + pi, beta,
+ * gamma + pi) and f(alpha, 2*pi - beta, gamma) = f(alpha + pi, beta, gamma +
+ * pi). As alpha + pi and gamma + pi are not samples of the MW grids, these
+ * ghost rows are obtained exactly by phase shifts of the Fourier series in
+ * alpha and gamma, for every call. Steerable signals are not supported.
+ *
+ * Rotations are processed in blocks: the cells and weights of a block are
+ * computed in a branch-free loop that vectorises, and then the samples are
+ * gathered. Blocks are shared out between threads.
+ *
+ * The error relative to the exact band-limited value depends on how finely
+ * the grid oversamples the signal. For a signal of band-limits (L, N) sampled
+ * on a grid with band-limits (r*L, r*N), e.g. by zero-padding its flmn, the
+ * maximum error over random rotations relative to the maximum of |f| was
+ * measured for L = 4 and 8 on MW and MWSS grids, uniformly and near the poles,
+ * as at most:
+ *
+ *   r   linear   cubic
+ *   1   7e-1     6e-1
+ *   2   2.5e-1   5e-2
+ *   4   6e-2     5e-3
+ *   8   1.5e-2   4e-4
+ *
+ * i.e. the error falls as 1/r^2 for linear and about 1/r^3.5 for cubic
+ * interpolation. Without oversampling, r = 1, the interpolation is only a
+ * rough approximation. On the samples themselves both methods are exact.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "so3/so3_error.h"
+#include "so3/so3_fft.h"
+#include "so3/so3_interp.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+
+#include "so3_omp.h"
+
+// Rotations per block, and the smallest number of rotations for threads.
+#define SO3_INTERP_BLOCK 256
+#define SO3_INTERP_PARALLEL_MIN 4096
+
+// Ghost rows on either side of the sampled range in beta.
+#define SO3_INTERP_GHOSTS 2
+
+struct so3_interp_plan {
+  so3_parameters_t parameters;
+  so3_interp_method_t method;
+  int nalpha, nbeta, ngamma;
+  double alpha_step, beta_start, beta_step, gamma_step;
+  // One slice in (alpha, gamma), ngamma x nalpha, and its transforms.
+  complex double *slice;
+  so3_fft_plan_t *fft_forward, *fft_backward;
+  // Ghost rows, 2 * SO3_INTERP_GHOSTS slices of ngamma x nalpha values, of
+  // one or two doubles each.
+  double *ghosts;
+};
+
+/*!
+ * Prepare the interpolation of signals with the given parameters.
+ *
+ * \param[in] parameters A fully populated parameters object. The reality flag
+ *                       selects between \link so3_interp \endlink and \link
+ *                       so3_interp_real \endlink.
+ * \param[in] method Interpolation kernel.
+ * \retval plan Plan to pass to the interpolation functions. Free it with \link
+ *              so3_interp_plan_free \endlink.
+ */
+so3_interp_plan_t *
+so3_interp_plan_init(const so3_parameters_t *parameters, so3_interp_method_t method) {
+  so3_interp_plan_t *plan = calloc(1, sizeof *plan);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan);
+
+  if (method != SO3_INTERP_LINEAR && method != SO3_INTERP_CUBIC)
+    SO3_ERROR_GENERIC("Invalid interpolation method.");
+  if (parameters->L < 3)
+    SO3_ERROR_GENERIC("Interpolation requires L >= 3.");
+  if (parameters->steerable)
+    SO3_ERROR_GENERIC("Interpolation does not support steerable signals.");
+
+  plan->parameters = *parameters;
+  plan->method = method;
+  plan->nalpha = so3_sampling_nalpha(parameters);
+  plan->nbeta = so3_sampling_nbeta(parameters);
+  plan->ngamma = so3_sampling_ngamma(parameters);
+  plan->alpha_step = 2.0 * SO3_PI / plan->nalpha;
+  plan->beta_start = so3_sampling_b2beta(0, parameters);
+  plan->beta_step = so3_sampling_b2beta(1, parameters) - plan->beta_start;
+  plan->gamma_step = 2.0 * SO3_PI / plan->ngamma;
+
+  const int slice_size = plan->ngamma * plan->nalpha;
+  plan->slice = malloc(slice_size * sizeof *plan->slice);
+  plan->ghosts = malloc(2 * SO3_INTERP_GHOSTS * 2 * slice_size * sizeof *plan->ghosts);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->slice);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->ghosts);
+
+  plan->fft_forward = so3_fft_plan_dft_2d(
+      plan->ngamma, plan->nalpha, plan->slice, plan->slice, SO3_FFT_FORWARD,
+      SO3_FFT_ESTIMATE);
+  plan->fft_backward = so3_fft_plan_dft_2d(
+      plan->ngamma, plan->nalpha, plan->slice, plan->slice, SO3_FFT_BACKWARD,
+      SO3_FFT_ESTIMATE);
+
+  return plan;
+}
+
+/*!
+ * Free an interpolation plan.
+ *
+ * \param[in] plan Plan, may be NULL.
+ * \retval none
+ */
+void so3_interp_plan_free(so3_interp_plan_t *plan) {
+  if (plan == NULL)
+    return;
+  so3_fft_destroy_plan(plan->fft_forward);
+  so3_fft_destroy_plan(plan->fft_backward);
+  free(plan->slice);
+  free(plan->ghosts);
+  free(plan);
+}
+
+// Sign (-1)^k of the frequency of FFT index i of length n.
+static inline double so3_interp_parity(int i, int n) {
+  const int k = i <= (n - 1) / 2 ? i : i - n;
+  return k % 2 ? -1.0 : 1.0;
+}
+
+// Fill the ghost rows from f, given as ncomponents doubles per sample. Ghost
+// k < SO3_INTERP_GHOSTS is row b = -1-k, and ghost SO3_INTERP_GHOSTS + k is
+// row b = nbeta + k.
+static void so3_interp_ghosts(
+    const double *f, int ncomponents, so3_interp_plan_t *plan) {
+  const int nalpha = plan->nalpha, nbeta = plan->nbeta, ngamma = plan->ngamma;
+  const int slice_size = ngamma * nalpha;
+  const int ss = plan->parameters.sampling_scheme == SO3_SAMPLING_MW_SS;
+  const double scale = 1.0 / ((double)nalpha * ngamma);
+  int k, a, g, c;
+
+  for (k = 0; k < 2 * SO3_INTERP_GHOSTS; ++k) {
+    // Row at beta' = -beta_b or 2*pi - beta_b.
+    const int b = k < SO3_INTERP_GHOSTS ? -1 - k : nbeta + k - SO3_INTERP_GHOSTS;
+    int mirror = b < 0 ? -b - 1 + ss : 2 * nbeta - 2 - b;
+    double *ghost = plan->ghosts + k * 2 * slice_size;
+
+    mirror = mirror < 0 ? 0 : (mirror >= nbeta ? nbeta - 1 : mirror);
+    for (g = 0; g < ngamma; ++g) {
+      const double *row = f + ncomponents * nalpha * (mirror + nbeta * g);
+      for (a = 0; a < nalpha; ++a)
+        plan->slice[g * nalpha + a] =
+            ncomponents == 2 ? row[2 * a] + I * row[2 * a + 1] : row[a];
+    }
+    so3_fft_execute(plan->fft_forward);
+    for (g = 0; g < ngamma; ++g) {
+      const double sign = scale * so3_interp_parity(g, ngamma);
+      for (a = 0; a < nalpha; ++a)
+        plan->slice[g * nalpha + a] *= sign * so3_interp_parity(a, nalpha);
+    }
+    so3_fft_execute(plan->fft_backward);
+    for (g = 0; g < slice_size; ++g)
+      for (c = 0; c < ncomponents; ++c)
+        ghost[ncomponents * g + c] =
+            c ? cimag(plan->slice[g]) : creal(plan->slice[g]);
+  }
+}
+
+// Weights of the taps at offsets -1, 0, 1, 2 (cubic) or 0, 1 (linear) from
+// the lower corner, for a fraction t in [0, 1).
+static inline void so3_interp_weights(double *w, double t, so3_interp_method_t method) {
+  if (method == SO3_INTERP_CUBIC) {
+    const double t2 = t * t, t3 = t2 * t;
+    w[0] = 0.5 * (-t3 + 2.0 * t2 - t);
+    w[1] = 0.5 * (3.0 * t3 - 5.0 * t2 + 2.0);
+    w[2] = 0.5 * (-3.0 * t3 + 4.0 * t2 + t);
+    w[3] = 0.5 * (t3 - t2);
+  } else {
+    w[0] = 1.0 - t;
+    w[1] = t;
+  }
+}
+
+// Interpolate the rotations [start, stop) from f, given as ncomponents
+// doubles per sample.
+static void so3_interp_block(
+    double *values, const double *f, int ncomponents, const double *alphas,
+    const double *betas, const double *gammas, int start, int stop,
+    const so3_interp_plan_t *plan) {
+  const int nalpha = plan->nalpha, nbeta = plan->nbeta, ngamma = plan->ngamma;
+  const int taps = plan->method == SO3_INTERP_CUBIC ? 4 : 2;
+  const int offset = plan->method == SO3_INTERP_CUBIC ? 1 : 0;
+  const int slice_size = ngamma * nalpha;
+  int a0[SO3_INTERP_BLOCK], b0[SO3_INTERP_BLOCK], g0[SO3_INTERP_BLOCK];
+  double ta[SO3_INTERP_BLOCK], tb[SO3_INTERP_BLOCK], tg[SO3_INTERP_BLOCK];
+  const double alpha_scale = 1.0 / plan->alpha_step;
+  const double beta_scale = 1.0 / plan->beta_step;
+  const double gamma_scale = 1.0 / plan->gamma_step;
+  const int count = stop - start;
+  int i;
+
+  // Cells, with the lower corner in beta in [-1, nbeta - 1], so that the
+  // stencil stays within the ghost rows.
+  SO3_PRAGMA(omp simd)
+  for (i = 0; i < count; ++i) {
+    const double alpha = alphas[start + i], gamma = gammas[start + i];
+    const double x =
+        (alpha - 2.0 * SO3_PI * floor(alpha / (2.0 * SO3_PI))) * alpha_scale;
+    double y = (betas[start + i] - plan->beta_start) * beta_scale;
+    const double z =
+        (gamma - 2.0 * SO3_PI * floor(gamma / (2.0 * SO3_PI))) * gamma_scale;
+    y = y < -1.0 ? -1.0 : (y > nbeta - 1.0 ? nbeta - 1.0 : y);
+    a0[i] = (int)floor(x);
+    b0[i] = (int)floor(y);
+    g0[i] = (int)floor(z);
+    ta[i] = x - a0[i];
+    tb[i] = y - b0[i];
+    tg[i] = z - g0[i];
+  }
+
+  for (i = 0; i < count; ++i) {
+    double wa[4], wb[4], wg[4], sum[2] = {0.0, 0.0};
+    int ia[4], ja, jb, jg, c;
+
+    so3_interp_weights(wa, ta[i], plan->method);
+    so3_interp_weights(wb, tb[i], plan->method);
+    so3_interp_weights(wg, tg[i], plan->method);
+    for (ja = 0; ja < taps; ++ja) {
+      int a = a0[i] + ja - offset;
+      a = a < 0 ? a + nalpha : (a >= nalpha ? a - nalpha : a);
+      ia[ja] = ncomponents * a;
+    }
+
+    for (jg = 0; jg < taps; ++jg) {
+      int g = g0[i] + jg - offset;
+      g = g < 0 ? g + ngamma : (g >= ngamma ? g - ngamma : g);
+      for (jb = 0; jb < taps; ++jb) {
+        const int b = b0[i] + jb - offset;
+        const double w = wg[jg] * wb[jb];
+        const double *row;
+        if (b < 0)
+          row = plan->ghosts + (-1 - b) * 2 * slice_size;
+        else if (b >= nbeta)
+          row = plan->ghosts + (SO3_INTERP_GHOSTS + b - nbeta) * 2 * slice_size;
+        else
+          row = f + ncomponents * nalpha * nbeta * g + ncomponents * nalpha * b;
+        if (b < 0 || b >= nbeta)
+          row += ncomponents * nalpha * g;
+        for (ja = 0; ja < taps; ++ja)
+          for (c = 0; c < ncomponents; ++c)
+            sum[c] += w * wa[ja] * row[ia[ja] + c];
+      }
+    }
+    for (c = 0; c < ncomponents; ++c)
+      values[ncomponents * (start + i) + c] = sum[c];
+  }
+}
+
+static void so3_interp_run(
+    double *values, const double *f, int ncomponents, const double *alphas,
+    const double *betas, const double *gammas, int count, so3_interp_plan_t *plan) {
+  const int nblocks = (count + SO3_INTERP_BLOCK - 1) / SO3_INTERP_BLOCK;
+  int block;
+
+  so3_interp_ghosts(f, ncomponents, plan);
+  SO3_PRAGMA(omp parallel for schedule(static) if (count >= SO3_INTERP_PARALLEL_MIN))
+  for (block = 0; block < nblocks; ++block) {
+    const int start = block * SO3_INTERP_BLOCK;
+    const int stop =
+        start + SO3_INTERP_BLOCK < count ? start + SO3_INTERP_BLOCK : count;
+    so3_interp_block(
+        values, f, ncomponents, alphas, betas, gammas, start, stop, plan);
+  }
+}
+
+/*!
+ * Interpolate a complex signal at arbitrary rotations.
+ *
+ * \param[out] values Interpolated values, one per rotation.
+ * \param[in] f Signal on the grid of the plan, in the layout of the inverse
+ *              transforms.
+ * \param[in] alphas Angles alpha, any real value.
+ * \param[in] betas Angles beta in [0, pi].
+ * \param[in] gammas Angles gamma, any real value.
+ * \param[in] count Number of rotations.
+ * \param[in] plan Plan for complex signals.
+ * \retval none
+ */
+void so3_interp(
+    complex double *values, const complex double *f, const double *alphas,
+    const double *betas, const double *gammas, int count, so3_interp_plan_t *plan) {
+  if (plan->parameters.reality)
+    SO3_ERROR_GENERIC("Plan is for real signals. Use so3_interp_real instead.");
+  so3_interp_run(
+      (double *)values, (const double *)f, 2, alphas, betas, gammas, count, plan);
+}
+
+/*!
+ * Interpolate a real signal at arbitrary rotations, see \link so3_interp
+ * \endlink.
+ *
+ * \param[out] values Interpolated values, one per rotation.
+ * \param[in] f Real signal on the grid of the plan.
+ * \param[in] alphas Angles alpha, any real value.
+ * \param[in] betas Angles beta in [0, pi].
+ * \param[in] gammas Angles gamma, any real value.
+ * \param[in] count Number of rotations.
+ * \param[in] plan Plan for real signals.
+ * \retval none
+ */
+void so3_interp_real(
+    double *values, const double *f, const double *alphas, const double *betas,
+    const double *gammas, int count, so3_interp_plan_t *plan) {
+  if (!plan->parameters.reality)
+    SO3_ERROR_GENERIC("Plan is for complex signals. Use so3_interp instead.");
+  so3_interp_run(values, f, 1, alphas, betas, gammas, count, plan);
+}
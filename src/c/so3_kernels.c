@@ -0,0 +1,389 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_kernels.c
+ * Per-el inner kernels of the direct Wigner transforms.
+ *
+ * The generic kernels below take the n-mode, the reality flag and the step
+ * between consecutive m of the Fmnm'/Gmnm' layout as arguments. They are
+ * instantiated once per (n-mode, reality) combination with these arguments
+ * fixed at compile time, so that the compiler can fold the n-range
+ * computation and all sign conditionals out of the inner loops, and address
+ * contiguous m with unit stride. The instantiations are selected at run time
+ * through a dispatch table.
+ *
+ * The phase i^(m-n) of the forward kernels is looked up in a copy of exps
+ * rotated once per n, so the inner loops index it by m & 3 alone.
+ *
+ * Sampling and storage need no instantiations of their own: the sampling
+ * scheme only affects the FFT stages, and the flmn index of (el, m, n) is
+ * contiguous in m for every storage and n-order, so it is computed once per
+ * (el, n).
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+
+#include "so3_kernels.h"
+
+#define MIN(a, b) ((a < b) ? (a) : (b))
+#define MAX(a, b) ((a > b) ? (a) : (b))
+
+/*!
+ * Compute the range of n covered by degree el.
+ *
+ * \retval 0 if el does not contribute for this n-mode, 1 otherwise.
+ */
+static inline int so3_kernel_n_range(
+    int *n_start,
+    int *n_stop,
+    int *n_inc,
+    const int el,
+    const int N,
+    const so3_n_mode_t n_mode,
+    const int reality) {
+  if (reality) {
+    switch (n_mode) {
+    case SO3_N_MODE_ALL:
+      *n_start = 0;
+      *n_stop = MIN(N - 1, el);
+      *n_inc = 1;
+      return 1;
+    case SO3_N_MODE_EVEN:
+      *n_start = 0;
+      *n_stop = MIN(N - 1, el);
+      *n_stop -= *n_stop % 2;
+      *n_inc = 2;
+      return 1;
+    case SO3_N_MODE_ODD:
+      *n_start = 1;
+      *n_stop = MIN(N - 1, el);
+      *n_stop -= 1 - *n_stop % 2;
+      *n_inc = 2;
+      return 1;
+    case SO3_N_MODE_MAXIMUM:
+      *n_start = N - 1;
+      *n_stop = N - 1;
+      *n_inc = 1;
+      return el >= N - 1;
+    case SO3_N_MODE_L:
+      *n_start = el;
+      *n_stop = el;
+      *n_inc = 1;
+      return el < N;
+    default:
+      return 0;
+    }
+  }
+
+  switch (n_mode) {
+  case SO3_N_MODE_ALL:
+    *n_start = MAX(-N + 1, -el);
+    *n_stop = MIN(N - 1, el);
+    *n_inc = 1;
+    return 1;
+  case SO3_N_MODE_EVEN:
+    *n_start = MAX(-N + 1, -el);
+    *n_start += (-*n_start) % 2;
+    *n_stop = MIN(N - 1, el);
+    *n_stop -= *n_stop % 2;
+    *n_inc = 2;
+    return 1;
+  case SO3_N_MODE_ODD:
+    *n_start = MAX(-N + 1, -el);
+    *n_start += 1 + *n_start % 2;
+    *n_stop = MIN(N - 1, el);
+    *n_stop -= 1 - *n_stop % 2;
+    *n_inc = 2;
+    return 1;
+  case SO3_N_MODE_MAXIMUM:
+    *n_start = -N + 1;
+    *n_stop = N - 1;
+    *n_inc = MAX(1, 2 * N - 2);
+    return el >= N - 1;
+  case SO3_N_MODE_L:
+    *n_start = -el;
+    *n_stop = el;
+    *n_inc = MAX(1, 2 * el);
+    return el < N;
+  default:
+    return 0;
+  }
+}
+
+static inline int so3_kernel_flmn_index(
+    const int el, const int n, const so3_parameters_t *parameters, const int reality) {
+  int ind;
+  if (reality)
+    so3_sampling_elmn2ind_real(&ind, el, 0, n, parameters);
+  else
+    so3_sampling_elmn2ind(&ind, el, 0, n, parameters);
+  return ind;
+}
+
+// Step between consecutive m of the layout, fixed at compile time unless
+// m_step is 0.
+static inline int
+so3_kernel_m_step(const so3_kernel_layout_t *layout, const int m_step) {
+  if (!m_step)
+    return layout->m_step;
+  if (layout->m_step != m_step)
+    SO3_ERROR_GENERIC("Kernel instantiated for another m step.");
+  return m_step;
+}
+
+static inline void so3_kernel_inverse_generic(
+    complex double *Fmnm,
+    const complex double *flmn,
+    const int el,
+    const so3_kernel_args_t *args,
+    const so3_n_mode_t n_mode,
+    const int reality,
+    const int m_step_fixed) {
+  int m, n, mm;
+  int n_start, n_stop, n_inc;
+
+  if (!so3_kernel_n_range(&n_start, &n_stop, &n_inc, el, args->N, n_mode, reality))
+    return;
+
+  const int M = args->M;
+  const int mlim = MIN(el, M - 1);
+  const double *signs = args->signs;
+  const complex double *exps = args->exps;
+  const so3_kernel_layout_t layout = args->layout;
+  const int m_step = so3_kernel_m_step(&layout, m_step_fixed);
+  complex double *mn_factors = args->mn_factors;
+  int mn_offset = M - 1 + (2 * M - 1) * (reality ? 0 : args->N - 1);
+  int mn_stride = 2 * M - 1;
+
+  // Factor which depends only on el.
+  double elfactor = (2.0 * el + 1.0) / (8.0 * SO3_PI * SO3_PI);
+
+  // Factors which do not depend on m'.
+  for (n = n_start; n <= n_stop; n += n_inc) {
+    const complex double *flmn_n =
+        flmn + so3_kernel_flmn_index(el, n, args->parameters, reality);
+    complex double *mn_n = mn_factors + mn_offset + mn_stride * n;
+    for (m = -mlim; m <= mlim; ++m)
+      mn_n[m] = flmn_n[m] * exps[(n - m) & 3];
+  }
+
+  for (mm = 0; mm <= el; ++mm) {
+    // These signs are needed for the symmetry relations of
+    // Wigner symbols.
+    double elmmsign = signs[el] * signs[mm];
+    const double *dl_mm = args->dl + args->dl_offset + mm * args->dl_stride;
+    // Entries beyond the extent of the row are negligible.
+    const int cut = args->dl_mlim ? args->dl_mlim[mm] : el;
+    const int mm_mlim = MIN(mlim, cut);
+
+    for (n = n_start; n <= n_stop; n += n_inc) {
+      if (abs(n) > cut)
+        continue;
+      double elnsign = (reality || n >= 0) ? 1.0 : elmmsign;
+      // Factor which does not depend on m.
+      double elnmm_factor = elfactor * elnsign * dl_mm[abs(n)];
+      const complex double *mn_n = mn_factors + mn_offset + mn_stride * n;
+      complex double *F = Fmnm + layout.origin + n * layout.n_step + mm * layout.mm_step;
+      complex double *F_neg = F + layout.m_neg_shift;
+
+      double neg_factor = elnmm_factor * elmmsign;
+      for (m = -mm_mlim; m < 0; ++m)
+        F_neg[m * m_step] += neg_factor * mn_n[m] * dl_mm[-m];
+      for (m = 0; m <= mm_mlim; ++m)
+        F[m * m_step] += elnmm_factor * mn_n[m] * dl_mm[m];
+    }
+  }
+}
+
+static inline void so3_kernel_forward_generic(
+    complex double *flmn,
+    const complex double *Gmnm,
+    const int el,
+    const so3_kernel_args_t *args,
+    const so3_n_mode_t n_mode,
+    const int reality,
+    const int m_step_fixed) {
+  int m, n, mm, k;
+  int n_start, n_stop, n_inc;
+
+  if (!so3_kernel_n_range(&n_start, &n_stop, &n_inc, el, args->N, n_mode, reality))
+    return;
+
+  const int mlim = MIN(el, args->M - 1);
+  const double *signs = args->signs;
+  const complex double *exps = args->exps;
+  const so3_kernel_layout_t layout = args->layout;
+  const int m_step = so3_kernel_m_step(&layout, m_step_fixed);
+  const double *dl = args->dl + args->dl_offset;
+  // exps_n[m & 3] = i^(m-n).
+  complex double exps_n[4];
+  const int dl_stride = args->dl_stride;
+
+  for (n = n_start; n <= n_stop; n += n_inc) {
+    complex double *flmn_n =
+        flmn + so3_kernel_flmn_index(el, n, args->parameters, reality);
+    const complex double *G_n = Gmnm + layout.origin + n * layout.n_step;
+    for (k = 0; k < 4; ++k)
+      exps_n[k] = exps[(k - n) & 3];
+
+    // For m' < 0, use the symmetry of the Wigner symbols in m' and n (resp. m)
+    // to express d^el_{m', n} in terms of d^el_{-m', n}.
+    for (mm = -el; mm < 0; ++mm) {
+      double elmmsign = signs[el] * signs[-mm];
+      double elnsign = (reality || n >= 0) ? 1.0 : elmmsign;
+      const double *dl_mm = dl + (-mm) * dl_stride;
+      const int cut = args->dl_mlim ? args->dl_mlim[-mm] : el;
+      if (abs(n) > cut)
+        continue;
+      const int mm_mlim = MIN(mlim, cut);
+      const complex double *G = G_n + mm * layout.mm_step;
+      const complex double *G_neg = G + layout.m_neg_shift;
+      // Factor which does not depend on m.
+      double elnmm_factor = signs[el] * signs[abs(n)] * elnsign * dl_mm[abs(n)];
+
+      double neg_factor = elnmm_factor * signs[el] * elmmsign;
+      for (m = -mm_mlim; m < 0; ++m)
+        flmn_n[m] +=
+            exps_n[m & 3] * neg_factor * signs[-m] * dl_mm[-m] * G_neg[m * m_step];
+      double pos_factor = elnmm_factor * signs[el];
+      for (m = 0; m <= mm_mlim; ++m)
+        flmn_n[m] += exps_n[m & 3] * pos_factor * signs[m] * dl_mm[m] * G[m * m_step];
+    }
+
+    for (mm = 0; mm <= el; ++mm) {
+      double elmmsign = signs[el] * signs[mm];
+      double elnsign = (reality || n >= 0) ? 1.0 : elmmsign;
+      const double *dl_mm = dl + mm * dl_stride;
+      const int cut = args->dl_mlim ? args->dl_mlim[mm] : el;
+      if (abs(n) > cut)
+        continue;
+      const int mm_mlim = MIN(mlim, cut);
+      const complex double *G = G_n + mm * layout.mm_step;
+      const complex double *G_neg = G + layout.m_neg_shift;
+      // Factor which does not depend on m.
+      double elnmm_factor = elnsign * dl_mm[abs(n)];
+
+      double neg_factor = elnmm_factor * elmmsign;
+      for (m = -mm_mlim; m < 0; ++m)
+        flmn_n[m] += exps_n[m & 3] * neg_factor * dl_mm[-m] * G_neg[m * m_step];
+      for (m = 0; m <= mm_mlim; ++m)
+        flmn_n[m] += exps_n[m & 3] * elnmm_factor * dl_mm[m] * G[m * m_step];
+    }
+  }
+}
+
+// Instantiate the generic kernels for one (n-mode, reality) combination, with
+// the m step of the layouts so3_core passes them, or 0 to read it at run time.
+#define SO3_KERNEL_INSTANTIATE(NAME, N_MODE, REALITY, INVERSE_M_STEP, FORWARD_M_STEP) \
+  static void so3_kernel_inverse_##NAME(                                              \
+      complex double *Fmnm,                                                           \
+      const complex double *flmn,                                                     \
+      int el,                                                                         \
+      const so3_kernel_args_t *args) {                                                \
+    so3_kernel_inverse_generic(                                                       \
+        Fmnm, flmn, el, args, N_MODE, REALITY, INVERSE_M_STEP);                       \
+  }                                                                                   \
+  static void so3_kernel_forward_##NAME(                                              \
+      complex double *flmn,                                                           \
+      const complex double *Gmnm,                                                     \
+      int el,                                                                         \
+      const so3_kernel_args_t *args) {                                                \
+    so3_kernel_forward_generic(                                                       \
+        flmn, Gmnm, el, args, N_MODE, REALITY, FORWARD_M_STEP);                       \
+  }
+
+// The real inverse accumulates into the c2r FFT buffer, where m is strided.
+SO3_KERNEL_INSTANTIATE(all_complex, SO3_N_MODE_ALL, 0, 1, 1)
+SO3_KERNEL_INSTANTIATE(even_complex, SO3_N_MODE_EVEN, 0, 1, 1)
+SO3_KERNEL_INSTANTIATE(odd_complex, SO3_N_MODE_ODD, 0, 1, 1)
+SO3_KERNEL_INSTANTIATE(maximum_complex, SO3_N_MODE_MAXIMUM, 0, 1, 1)
+SO3_KERNEL_INSTANTIATE(l_complex, SO3_N_MODE_L, 0, 1, 1)
+SO3_KERNEL_INSTANTIATE(all_real, SO3_N_MODE_ALL, 1, 0, 1)
+SO3_KERNEL_INSTANTIATE(even_real, SO3_N_MODE_EVEN, 1, 0, 1)
+SO3_KERNEL_INSTANTIATE(odd_real, SO3_N_MODE_ODD, 1, 0, 1)
+SO3_KERNEL_INSTANTIATE(maximum_real, SO3_N_MODE_MAXIMUM, 1, 0, 1)
+SO3_KERNEL_INSTANTIATE(l_real, SO3_N_MODE_L, 1, 0, 1)
+
+// Dispatch tables, indexed by [reality][n_mode].
+static const so3_kernel_inverse_t so3_kernel_inverse_table[2][SO3_N_MODE_SIZE] = {
+    {so3_kernel_inverse_all_complex,
+     so3_kernel_inverse_even_complex,
+     so3_kernel_inverse_odd_complex,
+     so3_kernel_inverse_maximum_complex,
+     so3_kernel_inverse_l_complex},
+    {so3_kernel_inverse_all_real,
+     so3_kernel_inverse_even_real,
+     so3_kernel_inverse_odd_real,
+     so3_kernel_inverse_maximum_real,
+     so3_kernel_inverse_l_real}};
+
+static const so3_kernel_forward_t so3_kernel_forward_table[2][SO3_N_MODE_SIZE] = {
+    {so3_kernel_forward_all_complex,
+     so3_kernel_forward_even_complex,
+     so3_kernel_forward_odd_complex,
+     so3_kernel_forward_maximum_complex,
+     so3_kernel_forward_l_complex},
+    {so3_kernel_forward_all_real,
+     so3_kernel_forward_even_real,
+     so3_kernel_forward_odd_real,
+     so3_kernel_forward_maximum_real,
+     so3_kernel_forward_l_real}};
+
+/*!
+ * Compute the extent of the Wigner plane of degree el above a tolerance.
+ *
+ * The entries of d^el(pi/2) decay exponentially outside the disc
+ * m^2 + m'^2 <= el(el+1), so for every row m' the entries above the
+ * tolerance are contained in |m| <= dl_mlim[m']. Entries inside this range
+ * are kept even if they are small.
+ *
+ * \param[out] dl_mlim   Extent of every row m' = 0..el.
+ * \param[in]  args      Kernel arguments holding the Wigner plane of el.
+ * \param[in]  el        Degree of the Wigner plane.
+ * \param[in]  tolerance Magnitude below which entries are negligible.
+ * \retval none
+ */
+void so3_kernel_dl_mlim(
+    int *dl_mlim, const so3_kernel_args_t *args, int el, double tolerance) {
+  int m, mm;
+  for (mm = 0; mm <= el; ++mm) {
+    const double *dl_mm = args->dl + args->dl_offset + mm * args->dl_stride;
+    for (m = el; m >= 0 && fabs(dl_mm[m]) < tolerance; --m)
+      ;
+    dl_mlim[mm] = m;
+  }
+}
+
+/*!
+ * Select the inverse el-kernel specialised for the given n-mode and reality.
+ *
+ * \param[in] n_mode  N-mode of the transform.
+ * \param[in] reality Non-zero for real signals (n >= 0 only).
+ * \retval Kernel adding the contribution of one el to Fmnm'.
+ */
+so3_kernel_inverse_t so3_kernel_inverse_get(so3_n_mode_t n_mode, int reality) {
+  if (n_mode < 0 || n_mode >= SO3_N_MODE_SIZE)
+    SO3_ERROR_GENERIC("Invalid n-mode.");
+  return so3_kernel_inverse_table[reality ? 1 : 0][n_mode];
+}
+
+/*!
+ * Select the forward el-kernel specialised for the given n-mode and reality.
+ *
+ * \param[in] n_mode  N-mode of the transform.
+ * \param[in] reality Non-zero for real signals (n >= 0 only).
+ * \retval Kernel accumulating the flmn of one el.
+ */
+so3_kernel_forward_t so3_kernel_forward_get(so3_n_mode_t n_mode, int reality) {
+  if (n_mode < 0 || n_mode >= SO3_N_MODE_SIZE)
+    SO3_ERROR_GENERIC("Invalid n-mode.");
+  return so3_kernel_forward_table[reality ? 1 : 0][n_mode];
+}
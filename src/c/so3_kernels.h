@@ -0,0 +1,83 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_KERNELS
+#define SO3_KERNELS
+
+#include "so3/so3_types.h"
+#include <complex.h>
+
+/*!
+ * Internal to the library, not installed.
+ *
+ * Per-el inner kernels of the direct Wigner transforms (see so3_kernels.c).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Position of the (m, n, m') entries of an Fmnm'/Gmnm array used by the
+ * el-kernels. The entry for (m, n, m') lives at
+ * origin + m*m_step + n*n_step + m'*mm_step, plus m_neg_shift if m < 0.
+ */
+typedef struct {
+  int origin;
+  int m_step;
+  int m_neg_shift;
+  int n_step;
+  int mm_step;
+} so3_kernel_layout_t;
+
+/*!
+ * Quantities shared by all el-kernel invocations of one transform.
+ */
+typedef struct {
+  /*! Parameters of the transform, used for flmn indexing. */
+  const so3_parameters_t *parameters;
+  /*! Effective band-limits. M is the azimuthal band-limit. */
+  int L, M, N;
+  /*! Wigner plane for the current el, in SSHT_DL_QUARTER layout. */
+  const double *dl;
+  int dl_offset, dl_stride;
+  /*!
+   * dl_mlim[m'] is the largest |m| for which row m' of the Wigner plane is
+   * not negligible, or -1 if the whole row is. NULL keeps every entry.
+   */
+  const int *dl_mlim;
+  /*! signs[k] = (-1)^k for k = 0..L. */
+  const double *signs;
+  /*! exps[k] = i^k for k = 0..3. */
+  const SO3_COMPLEX(double) * exps;
+  /*! Workspace of (2*M-1)*(2*N-1) elements (inverse kernels only). */
+  SO3_COMPLEX(double) * mn_factors;
+  /*! Layout of Fmnm' (inverse) or Gmnm' (forward). */
+  so3_kernel_layout_t layout;
+} so3_kernel_args_t;
+
+/*!
+ * Adds the contribution of degree el to Fmnm' (m' >= 0 only).
+ */
+typedef void (*so3_kernel_inverse_t)(
+    SO3_COMPLEX(double) * Fmnm, const SO3_COMPLEX(double) * flmn, int el,
+    const so3_kernel_args_t *args);
+
+/*!
+ * Accumulates the flmn of degree el from Gmnm'.
+ */
+typedef void (*so3_kernel_forward_t)(
+    SO3_COMPLEX(double) * flmn, const SO3_COMPLEX(double) * Gmnm, int el,
+    const so3_kernel_args_t *args);
+
+void so3_kernel_dl_mlim(
+    int *dl_mlim, const so3_kernel_args_t *args, int el, double tolerance);
+
+so3_kernel_inverse_t so3_kernel_inverse_get(so3_n_mode_t n_mode, int reality);
+so3_kernel_forward_t so3_kernel_forward_get(so3_n_mode_t n_mode, int reality);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
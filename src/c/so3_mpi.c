@@ -0,0 +1,440 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_mpi.c
+ * MPI-distributed Wigner transforms via SSHT.
+ *
+ * The via-SSHT algorithm consists of independent spherical harmonic
+ * transforms, one per n, and FFTs over gamma. The inverse transform
+ * computes the fn(alpha, beta) of the locally owned n, transposes them with
+ * an all-to-all exchange so that every rank holds all n for its beta rows,
+ * and finishes with FFTs over gamma. The forward transform runs the same
+ * steps in reverse order. Neither the full signal nor the full set of
+ * coefficients is ever held by a single rank.
+ *
+ * Only complex, non-steerable signals with M = L are supported.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <mpi.h>
+#include <ssht/ssht.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "so3/so3_error.h"
+#include "so3/so3_fft.h"
+#include "so3/so3_mpi.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+
+#define MAX(a, b) ((a > b) ? (a) : (b))
+
+typedef void (*inverse_complex_ssht)(
+    complex double *, const complex double *, int, int, int, ssht_dl_method_t, int);
+typedef void (*forward_complex_ssht)(
+    complex double *, const complex double *, int, int, int, ssht_dl_method_t, int);
+
+// Start of block i when count items are split into size blocks.
+static int so3_mpi_block_start(int i, int count, int size) {
+  return (int)((long long)i * count / size);
+}
+
+// Layout of an arbitrary rank, which every rank can compute locally.
+static void so3_mpi_layout_of_rank(
+    so3_mpi_layout_t *layout,
+    int rank,
+    int size,
+    const so3_parameters_t *parameters) {
+  int n_start, n_stop, n_inc, n_total, k_start, nbeta;
+
+  so3_sampling_n_loop_values(&n_start, &n_stop, &n_inc, parameters);
+  n_total = (n_stop - n_start) / n_inc + 1;
+  k_start = so3_mpi_block_start(rank, n_total, size);
+  layout->rank = rank;
+  layout->size = size;
+  layout->n_inc = n_inc;
+  layout->n_first = n_start + k_start * n_inc;
+  layout->n_count = so3_mpi_block_start(rank + 1, n_total, size) - k_start;
+
+  nbeta = so3_sampling_nbeta(parameters);
+  layout->b_start = so3_mpi_block_start(rank, nbeta, size);
+  layout->b_stop = so3_mpi_block_start(rank + 1, nbeta, size);
+}
+
+static void so3_mpi_check_parameters(const so3_parameters_t *parameters) {
+  if (parameters->reality)
+    SO3_ERROR_GENERIC("Distributed transforms support complex signals only.");
+  if (parameters->steerable)
+    SO3_ERROR_GENERIC("Distributed transforms do not support steerable signals.");
+  if (so3_sampling_mlim(parameters) < parameters->L)
+    SO3_ERROR_GENERIC("Azimuthal band-limit M < L requires the direct transforms.");
+}
+
+/*!
+ * Compute the part of a transform owned by the calling rank.
+ *
+ * The owned n are split as evenly as possible between the ranks, and so are
+ * the beta rows. A rank may own no n or no rows if there are more ranks
+ * than values.
+ *
+ * \param[out] layout Layout of the calling rank.
+ * \param[in] comm Communicator shared by all ranks taking part in the
+ *                 transforms. It must stay valid while layout is used.
+ * \param[in] parameters A fully populated parameters object. Only complex,
+ *                       non-steerable signals with M = L are supported.
+ * \retval none
+ */
+void so3_mpi_layout_init(
+    so3_mpi_layout_t *layout, MPI_Comm comm, const so3_parameters_t *parameters) {
+  int rank, size;
+
+  so3_mpi_check_parameters(parameters);
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  so3_mpi_layout_of_rank(layout, rank, size, parameters);
+  layout->comm = comm;
+}
+
+/*!
+ * Number of harmonic coefficients held by the calling rank.
+ *
+ * \param[in] layout Layout of the calling rank.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval size Number of elements of flmn_local.
+ */
+int so3_mpi_flmn_local_size(
+    const so3_mpi_layout_t *layout, const so3_parameters_t *parameters) {
+  return layout->n_count * parameters->L * parameters->L;
+}
+
+/*!
+ * Number of signal samples held by the calling rank.
+ *
+ * \param[in] layout Layout of the calling rank.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval size Number of elements of f_local.
+ */
+int so3_mpi_f_local_size(
+    const so3_mpi_layout_t *layout, const so3_parameters_t *parameters) {
+  return so3_sampling_nalpha(parameters) * (layout->b_stop - layout->b_start) *
+         (2 * parameters->N - 1);
+}
+
+// Moves fn between the n-distributed layout fn_local[k][b][a] and the
+// beta-distributed layout fn_t[offset(n)][b - b_start][a].
+static void so3_mpi_transpose(
+    complex double *fn_local,
+    complex double *fn_t,
+    int to_beta,
+    const so3_mpi_layout_t *layout,
+    const so3_parameters_t *parameters) {
+  const int N = parameters->N;
+  const int nalpha = so3_sampling_nalpha(parameters);
+  const int nbeta = so3_sampling_nbeta(parameters);
+  const int nb_local = layout->b_stop - layout->b_start;
+  int r, k, n, offset, pos;
+  so3_mpi_layout_t other;
+
+  int *local_counts = malloc(layout->size * sizeof *local_counts);
+  int *local_displs = malloc(layout->size * sizeof *local_displs);
+  int *t_counts = malloc(layout->size * sizeof *t_counts);
+  int *t_displs = malloc(layout->size * sizeof *t_displs);
+  SO3_ERROR_MEM_ALLOC_CHECK(local_counts);
+  SO3_ERROR_MEM_ALLOC_CHECK(local_displs);
+  SO3_ERROR_MEM_ALLOC_CHECK(t_counts);
+  SO3_ERROR_MEM_ALLOC_CHECK(t_displs);
+
+  // Data held in the n layout for rank r: our n, r's rows. Data held in the
+  // beta layout for rank r: r's n, our rows.
+  int local_total = 0, t_total = 0;
+  for (r = 0; r < layout->size; ++r) {
+    so3_mpi_layout_of_rank(&other, r, layout->size, parameters);
+    local_counts[r] = layout->n_count * (other.b_stop - other.b_start) * nalpha;
+    t_counts[r] = other.n_count * nb_local * nalpha;
+    local_displs[r] = local_total;
+    t_displs[r] = t_total;
+    local_total += local_counts[r];
+    t_total += t_counts[r];
+  }
+
+  complex double *local_buf = malloc(MAX(local_total, 1) * sizeof *local_buf);
+  complex double *t_buf = malloc(MAX(t_total, 1) * sizeof *t_buf);
+  SO3_ERROR_MEM_ALLOC_CHECK(local_buf);
+  SO3_ERROR_MEM_ALLOC_CHECK(t_buf);
+
+  if (to_beta) {
+    for (r = 0, pos = 0; r < layout->size; ++r) {
+      so3_mpi_layout_of_rank(&other, r, layout->size, parameters);
+      const int nb = other.b_stop - other.b_start;
+      for (k = 0; k < layout->n_count; ++k, pos += nb * nalpha)
+        memcpy(
+            local_buf + pos,
+            fn_local + nalpha * (other.b_start + nbeta * k),
+            nb * nalpha * sizeof *local_buf);
+    }
+    MPI_Alltoallv(
+        local_buf,
+        local_counts,
+        local_displs,
+        MPI_C_DOUBLE_COMPLEX,
+        t_buf,
+        t_counts,
+        t_displs,
+        MPI_C_DOUBLE_COMPLEX,
+        layout->comm);
+  } else {
+    for (r = 0, pos = 0; r < layout->size; ++r) {
+      so3_mpi_layout_of_rank(&other, r, layout->size, parameters);
+      for (k = 0; k < other.n_count; ++k, pos += nb_local * nalpha) {
+        n = other.n_first + k * other.n_inc;
+        offset = n < 0 ? n + 2 * N - 1 : n;
+        memcpy(
+            t_buf + pos,
+            fn_t + offset * nb_local * nalpha,
+            nb_local * nalpha * sizeof *t_buf);
+      }
+    }
+    MPI_Alltoallv(
+        t_buf,
+        t_counts,
+        t_displs,
+        MPI_C_DOUBLE_COMPLEX,
+        local_buf,
+        local_counts,
+        local_displs,
+        MPI_C_DOUBLE_COMPLEX,
+        layout->comm);
+  }
+
+  if (to_beta) {
+    for (r = 0, pos = 0; r < layout->size; ++r) {
+      so3_mpi_layout_of_rank(&other, r, layout->size, parameters);
+      for (k = 0; k < other.n_count; ++k, pos += nb_local * nalpha) {
+        n = other.n_first + k * other.n_inc;
+        offset = n < 0 ? n + 2 * N - 1 : n;
+        memcpy(
+            fn_t + offset * nb_local * nalpha,
+            t_buf + pos,
+            nb_local * nalpha * sizeof *t_buf);
+      }
+    }
+  } else {
+    for (r = 0, pos = 0; r < layout->size; ++r) {
+      so3_mpi_layout_of_rank(&other, r, layout->size, parameters);
+      const int nb = other.b_stop - other.b_start;
+      for (k = 0; k < layout->n_count; ++k, pos += nb * nalpha)
+        memcpy(
+            fn_local + nalpha * (other.b_start + nbeta * k),
+            local_buf + pos,
+            nb * nalpha * sizeof *local_buf);
+    }
+  }
+
+  free(local_buf);
+  free(t_buf);
+  free(local_counts);
+  free(local_displs);
+  free(t_counts);
+  free(t_displs);
+}
+
+/*!
+ * Compute the inverse Wigner transform of a complex signal distributed over
+ * the ranks of layout->comm. Must be called by all ranks.
+ *
+ * \param[out] f_local Owned beta rows of the signal, see \link
+ *                     so3_mpi_layout_t \endlink. Provide a buffer of size
+ *                     \link so3_mpi_f_local_size \endlink.
+ * \param[in] flmn_local Harmonic coefficients of the owned n.
+ * \param[in] layout Layout of the calling rank.
+ * \param[in] parameters A fully populated parameters object. The storage
+ *                       method and n-order are ignored. With \link
+ *                       SO3_N_MODE_L \endlink only the coefficients with
+ *                       el = |n| are used, as in the direct transforms.
+ * \retval none
+ */
+void so3_mpi_inverse_via_ssht(
+    complex double *f_local,
+    const complex double *flmn_local,
+    const so3_mpi_layout_t *layout,
+    const so3_parameters_t *parameters) {
+  const int L0 = parameters->L0, L = parameters->L, N = parameters->N;
+  const int nalpha = so3_sampling_nalpha(parameters);
+  const int nbeta = so3_sampling_nbeta(parameters);
+  const int nb_local = layout->b_stop - layout->b_start;
+  const int fn_n_stride = nalpha * nbeta;
+  inverse_complex_ssht ssht;
+  int k, el, i;
+
+  so3_mpi_check_parameters(parameters);
+  switch (parameters->sampling_scheme) {
+  case SO3_SAMPLING_MW:
+    ssht = ssht_core_mw_lb_inverse_sov_sym;
+    break;
+  case SO3_SAMPLING_MW_SS:
+    ssht = ssht_core_mw_lb_inverse_sov_sym_ss;
+    break;
+  default:
+    SO3_ERROR_GENERIC("Invalid sampling scheme.");
+  }
+
+  // Spherical harmonic transforms of the owned n.
+  complex double *fn_local = malloc(MAX(layout->n_count * fn_n_stride, 1) * sizeof *fn_local);
+  SO3_ERROR_MEM_ALLOC_CHECK(fn_local);
+  complex double *flm = malloc(L * L * sizeof *flm);
+  SO3_ERROR_MEM_ALLOC_CHECK(flm);
+  for (k = 0; k < layout->n_count; ++k) {
+    const int n = layout->n_first + k * layout->n_inc;
+    const int L0e = MAX(L0, abs(n));
+    complex double *fn = fn_local + k * fn_n_stride;
+    int el_start, el_stop, el_inc;
+
+    // Coefficients outside the el range of the n-mode are ignored.
+    so3_sampling_el_loop_values(&el_start, &el_stop, &el_inc, n, parameters);
+    memcpy(flm, flmn_local + k * L * L, L * L * sizeof *flm);
+    for (el = L0e; el < L; ++el) {
+      double factor = el <= el_stop
+                          ? sqrt((double)(2 * el + 1) / (16. * pow(SO3_PI, 3.)))
+                          : 0.0;
+      for (i = el * el; i < (el + 1) * (el + 1); ++i)
+        flm[i] *= factor;
+    }
+    (*ssht)(fn, flm, L0e, L, -n, parameters->dl_method, 0);
+    if (n % 2)
+      for (i = 0; i < fn_n_stride; ++i)
+        fn[i] = -fn[i];
+  }
+  free(flm);
+
+  // Gather all n of the owned rows, then transform over gamma.
+  complex double *fn_t = calloc(MAX((2 * N - 1) * nb_local * nalpha, 1), sizeof *fn_t);
+  SO3_ERROR_MEM_ALLOC_CHECK(fn_t);
+  so3_mpi_transpose(fn_local, fn_t, 1, layout, parameters);
+  free(fn_local);
+
+  if (nb_local > 0) {
+    int fft_n = 2 * N - 1;
+    so3_fft_plan_t *plan = so3_fft_plan_many_dft(
+        1,
+        &fft_n,
+        nb_local * nalpha,
+        fn_t,
+        NULL,
+        nb_local * nalpha,
+        1,
+        f_local,
+        NULL,
+        nb_local * nalpha,
+        1,
+        SO3_FFT_BACKWARD,
+        SO3_FFT_ESTIMATE);
+    so3_fft_execute(plan);
+    so3_fft_destroy_plan(plan);
+  }
+  free(fn_t);
+}
+
+/*!
+ * Compute the forward Wigner transform of a complex signal distributed over
+ * the ranks of layout->comm. Must be called by all ranks.
+ *
+ * \param[out] flmn_local Harmonic coefficients of the owned n, see \link
+ *                        so3_mpi_layout_t \endlink. Provide a buffer of size
+ *                        \link so3_mpi_flmn_local_size \endlink.
+ * \param[in] f_local Owned beta rows of the signal.
+ * \param[in] layout Layout of the calling rank.
+ * \param[in] parameters A fully populated parameters object. The storage
+ *                       method and n-order are ignored. With \link
+ *                       SO3_N_MODE_L \endlink the coefficients with
+ *                       el != |n| are set to zero, as in the direct transforms.
+ * \retval none
+ */
+void so3_mpi_forward_via_ssht(
+    complex double *flmn_local,
+    const complex double *f_local,
+    const so3_mpi_layout_t *layout,
+    const so3_parameters_t *parameters) {
+  const int L0 = parameters->L0, L = parameters->L, N = parameters->N;
+  const int nalpha = so3_sampling_nalpha(parameters);
+  const int nbeta = so3_sampling_nbeta(parameters);
+  const int nb_local = layout->b_stop - layout->b_start;
+  const int fn_n_stride = nalpha * nbeta;
+  forward_complex_ssht ssht;
+  int k, el, i;
+
+  so3_mpi_check_parameters(parameters);
+  switch (parameters->sampling_scheme) {
+  case SO3_SAMPLING_MW:
+    ssht = ssht_core_mw_lb_forward_sov_conv_sym;
+    break;
+  case SO3_SAMPLING_MW_SS:
+    ssht = ssht_core_mw_lb_forward_sov_conv_sym_ss;
+    break;
+  default:
+    SO3_ERROR_GENERIC("Invalid sampling scheme.");
+  }
+
+  // Transform the owned rows over gamma.
+  const int t_size = (2 * N - 1) * nb_local * nalpha;
+  complex double *fn_t = malloc(MAX(t_size, 1) * sizeof *fn_t);
+  SO3_ERROR_MEM_ALLOC_CHECK(fn_t);
+  if (nb_local > 0) {
+    int fft_n = 2 * N - 1;
+    // The input is const, so transform a copy.
+    complex double *ftemp = malloc(t_size * sizeof *ftemp);
+    SO3_ERROR_MEM_ALLOC_CHECK(ftemp);
+    memcpy(ftemp, f_local, t_size * sizeof *ftemp);
+    so3_fft_plan_t *plan = so3_fft_plan_many_dft(
+        1,
+        &fft_n,
+        nb_local * nalpha,
+        ftemp,
+        NULL,
+        nb_local * nalpha,
+        1,
+        fn_t,
+        NULL,
+        nb_local * nalpha,
+        1,
+        SO3_FFT_FORWARD,
+        SO3_FFT_ESTIMATE);
+    so3_fft_execute(plan);
+    so3_fft_destroy_plan(plan);
+    free(ftemp);
+
+    double factor = 2 * SO3_PI / (double)(2 * N - 1);
+    for (i = 0; i < t_size; ++i)
+      fn_t[i] *= factor;
+  }
+
+  // Gather all rows of the owned n, then apply the spherical harmonic
+  // transforms.
+  complex double *fn_local = malloc(MAX(layout->n_count * fn_n_stride, 1) * sizeof *fn_local);
+  SO3_ERROR_MEM_ALLOC_CHECK(fn_local);
+  so3_mpi_transpose(fn_local, fn_t, 0, layout, parameters);
+  free(fn_t);
+
+  for (k = 0; k < layout->n_count; ++k) {
+    const int n = layout->n_first + k * layout->n_inc;
+    const int L0e = MAX(L0, abs(n));
+    const int sign = n % 2 ? -1 : 1;
+    complex double *flm = flmn_local + k * L * L;
+    int el_start, el_stop, el_inc;
+
+    so3_sampling_el_loop_values(&el_start, &el_stop, &el_inc, n, parameters);
+    (*ssht)(flm, fn_local + k * fn_n_stride, L0e, L, -n, parameters->dl_method, 0);
+    for (i = 0; i < L0e * L0e; ++i)
+      flm[i] = 0.0;
+    for (el = L0e; el < L; ++el) {
+      double factor =
+          el <= el_stop ? sign * sqrt(4.0 * SO3_PI / (double)(2 * el + 1)) : 0.0;
+      for (i = el * el; i < (el + 1) * (el + 1); ++i)
+        flm[i] *= factor;
+    }
+  }
+  free(fn_local);
+}
@@ -0,0 +1,21 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+#ifndef SO3_OMP
+#define SO3_OMP
+
+/*!
+ * Internal to the library, not installed.
+ *
+ * SO3_PRAGMA(omp ...) expands to the OpenMP pragma when so3 is built with
+ * OpenMP and to nothing otherwise, so that the pragma can also be written
+ * inside macros.
+ */
+#ifdef _OPENMP
+#define SO3_PRAGMA(...) _Pragma(#__VA_ARGS__)
+#else
+#define SO3_PRAGMA(...)
+#endif
+
+#endif
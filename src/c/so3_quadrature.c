@@ -0,0 +1,406 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_quadrature.c
+ * Exact integration of sampled signals and of products of two signals.
+ *
+ * The trapezoidal rule in alpha and gamma integrates the samples exactly, so
+ * only beta needs care. For fixed frequencies (m, n) in alpha and gamma, a
+ * signal of band-limit L extended to [0, 2*pi) by
+ *
+ *   f(alpha, 2*pi - beta, gamma) = f(alpha + pi, beta, gamma + pi)
+ *
+ * is a trigonometric polynomial of degree L-1 in beta, sampled at 2L-1 (MW)
+ * or 2L (MWSS) equispaced points. Its integral against sin(beta) over
+ * [0, pi] is the convolution of its spectrum with the weights of
+ * \link so3_sampling_weight \endlink, which is done once per band-limit and
+ * sampling scheme to give one weight per ring of the grid. The ring weights
+ * are kept in a global cache, guarded by a mutex, so an integral is a single
+ * weighted pass over the samples.
+ *
+ * The product of two signals has band-limit 2L-1, which the grid does not
+ * resolve in beta. The inner product therefore goes through the Fourier
+ * coefficients in alpha and gamma, as in \link so3_resample \endlink: every
+ * (m, n) of both signals is evaluated on the circle of band-limit 2L-1 by
+ * zero-padding its spectrum in beta, and the products are integrated there.
+ * The cost is that of FFTs over the grid instead of two forward transforms.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "so3/so3_error.h"
+#include "so3/so3_fft.h"
+#include "so3/so3_quadrature.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+
+#include "so3_omp.h"
+
+typedef struct {
+  int L;
+  so3_sampling_t sampling_scheme;
+  double *weights;
+} so3_quadrature_weights_t;
+
+// Protects quadrature_cache and quadrature_ncache.
+static pthread_mutex_t quadrature_lock = PTHREAD_MUTEX_INITIALIZER;
+static so3_quadrature_weights_t *quadrature_cache = NULL;
+static int quadrature_ncache = 0;
+
+// Number of samples of the circle in beta for band-limit L, and the angle of
+// the first.
+static int so3_quadrature_circle(
+    double *offset, const so3_parameters_t *parameters, int L) {
+  if (parameters->sampling_scheme == SO3_SAMPLING_MW_SS) {
+    *offset = 0.0;
+    return 2 * L;
+  }
+  *offset = SO3_PI / (2 * L - 1);
+  return 2 * L - 1;
+}
+
+// Weights of the samples of the circle for band-limit L, such that the
+// integral of a trigonometric polynomial of degree L-1 against sin(beta) over
+// [0, pi] is the weighted sum of its samples.
+static void so3_quadrature_circle_weights(
+    double *weights, const so3_parameters_t *parameters, int L) {
+  double offset;
+  const int ncircle = so3_quadrature_circle(&offset, parameters, L);
+  complex double *w = malloc((2 * L - 1) * sizeof *w);
+  int j, p;
+  SO3_ERROR_MEM_ALLOC_CHECK(w);
+
+  // so3_sampling_weight(p) is the integral of exp(-i*p*beta) sin(beta).
+  for (p = -L + 1; p < L; ++p)
+    w[p + L - 1] = so3_sampling_weight(parameters, -p) / ncircle;
+  for (j = 0; j < ncircle; ++j) {
+    const double beta = offset + 2.0 * SO3_PI * j / ncircle;
+    double sum = w[L - 1];
+    for (p = 1; p < L; ++p)
+      sum += 2.0 * creal(w[p + L - 1] * cexp(-I * p * beta));
+    weights[j] = sum;
+  }
+  free(w);
+}
+
+// Weights of the rings of the grid for integrands that are even in beta on
+// the circle, i.e. the weights of every sample and its mirror image combined.
+// They depend on the band-limit and the sampling scheme only, and are cached
+// until so3_quadrature_cache_clear.
+static const double *so3_quadrature_ring_weights(const so3_parameters_t *parameters) {
+  const int L = parameters->L, nbeta = so3_sampling_nbeta(parameters);
+  so3_quadrature_weights_t *cache;
+  double *weights = NULL;
+  double offset;
+  int i, b;
+
+  pthread_mutex_lock(&quadrature_lock);
+  for (i = 0; i < quadrature_ncache && !weights; ++i)
+    if (quadrature_cache[i].L == L &&
+        quadrature_cache[i].sampling_scheme == parameters->sampling_scheme)
+      weights = quadrature_cache[i].weights;
+  if (!weights) {
+    const int ncircle = so3_quadrature_circle(&offset, parameters, L);
+    double *circle = malloc(ncircle * sizeof *circle);
+    weights = malloc(nbeta * sizeof *weights);
+    SO3_ERROR_MEM_ALLOC_CHECK(circle);
+    SO3_ERROR_MEM_ALLOC_CHECK(weights);
+
+    so3_quadrature_circle_weights(circle, parameters, L);
+    for (b = 0; b < nbeta; ++b) {
+      const int mirror = ncircle - b - (ncircle == 2 * L ? 0 : 1);
+      weights[b] = circle[b];
+      if (mirror < ncircle && mirror >= nbeta)
+        weights[b] += circle[mirror];
+    }
+    free(circle);
+
+    cache = realloc(
+        quadrature_cache, (quadrature_ncache + 1) * sizeof *quadrature_cache);
+    SO3_ERROR_MEM_ALLOC_CHECK(cache);
+    quadrature_cache = cache;
+    quadrature_cache[quadrature_ncache].L = L;
+    quadrature_cache[quadrature_ncache].sampling_scheme = parameters->sampling_scheme;
+    quadrature_cache[quadrature_ncache].weights = weights;
+    ++quadrature_ncache;
+  }
+  pthread_mutex_unlock(&quadrature_lock);
+  return weights;
+}
+
+/*!
+ * Free the ring weights cached by \link so3_integrate \endlink and \link
+ * so3_integrate_real \endlink.
+ *
+ * No integral may be running meanwhile.
+ *
+ * \retval none
+ */
+void so3_quadrature_cache_clear(void) {
+  int i;
+
+  pthread_mutex_lock(&quadrature_lock);
+  for (i = 0; i < quadrature_ncache; ++i)
+    free(quadrature_cache[i].weights);
+  free(quadrature_cache);
+  quadrature_cache = NULL;
+  quadrature_ncache = 0;
+  pthread_mutex_unlock(&quadrature_lock);
+}
+
+// Steerable signals are sampled in gamma over [0, pi) only, which integrates
+// exactly the frequencies n of one parity: that of n_mode if it fixes one,
+// otherwise that of N-1, as in the transforms. Odd n integrate to zero, but
+// do not cancel on the grid.
+//
+// Whether the parameters select odd n is decided from the parameters alone:
+// the samples are not inspected, and are assumed to hold only the n the
+// parameters allow.
+static int so3_quadrature_steerable_odd_n(const so3_parameters_t *parameters) {
+  if (!parameters->steerable || parameters->n_mode == SO3_N_MODE_EVEN)
+    return 0;
+  return parameters->n_mode == SO3_N_MODE_ODD || parameters->N % 2 == 0;
+}
+
+/*!
+ * Integrate a complex signal over the rotation group.
+ *
+ * \param[in] f Signal on the grid of parameters, band-limited as described by
+ *              parameters.
+ * \param[in] parameters A fully populated parameters object. Steerable
+ *                       signals are integrated over the full range of gamma.
+ * \retval integral Integral of f with respect to the Haar measure
+ *                  sin(beta) dalpha dbeta dgamma, of total mass 8*pi^2.
+ */
+complex double
+so3_integrate(const complex double *f, const so3_parameters_t *parameters) {
+  const int nalpha = so3_sampling_nalpha(parameters);
+  const int nbeta = so3_sampling_nbeta(parameters);
+  const int ngamma = so3_sampling_ngamma(parameters);
+  const double *weights;
+  double re = 0.0, im = 0.0;
+  int r;
+
+  if (parameters->reality)
+    SO3_ERROR_GENERIC("Parameters are for real signals. Use so3_integrate_real.");
+  if (so3_quadrature_steerable_odd_n(parameters))
+    return 0.0;
+  weights = so3_quadrature_ring_weights(parameters);
+
+  SO3_PRAGMA(omp parallel for schedule(static) reduction(+ : re, im))
+  for (r = 0; r < nbeta * ngamma; ++r) {
+    const double *ring = (const double *)(f + (size_t)r * nalpha);
+    double ring_re = 0.0, ring_im = 0.0;
+    int a;
+    SO3_PRAGMA(omp simd reduction(+ : ring_re, ring_im))
+    for (a = 0; a < nalpha; ++a) {
+      ring_re += ring[2 * a];
+      ring_im += ring[2 * a + 1];
+    }
+    re += weights[r % nbeta] * ring_re;
+    im += weights[r % nbeta] * ring_im;
+  }
+
+  return 4.0 * SO3_PI * SO3_PI / ((double)nalpha * ngamma) * (re + I * im);
+}
+
+/*!
+ * Integrate a real signal over the rotation group.
+ *
+ * \param[in] f Signal on the grid of parameters, band-limited as described by
+ *              parameters.
+ * \param[in] parameters A fully populated parameters object. Steerable
+ *                       signals are integrated over the full range of gamma.
+ * \retval integral Integral of f with respect to the Haar measure
+ *                  sin(beta) dalpha dbeta dgamma, of total mass 8*pi^2.
+ */
+double so3_integrate_real(const double *f, const so3_parameters_t *parameters) {
+  const int nalpha = so3_sampling_nalpha(parameters);
+  const int nbeta = so3_sampling_nbeta(parameters);
+  const int ngamma = so3_sampling_ngamma(parameters);
+  const double *weights;
+  double sum = 0.0;
+  int r;
+
+  if (!parameters->reality)
+    SO3_ERROR_GENERIC("Parameters are for complex signals. Use so3_integrate.");
+  if (so3_quadrature_steerable_odd_n(parameters))
+    return 0.0;
+  weights = so3_quadrature_ring_weights(parameters);
+
+  SO3_PRAGMA(omp parallel for schedule(static) reduction(+ : sum))
+  for (r = 0; r < nbeta * ngamma; ++r) {
+    const double *ring = f + (size_t)r * nalpha;
+    double ring_sum = 0.0;
+    int a;
+    SO3_PRAGMA(omp simd reduction(+ : ring_sum))
+    for (a = 0; a < nalpha; ++a)
+      ring_sum += ring[a];
+    sum += weights[r % nbeta] * ring_sum;
+  }
+
+  return 4.0 * SO3_PI * SO3_PI / ((double)nalpha * ngamma) * sum;
+}
+
+// Inner product of complex signals f and g, stored one after the other in
+// work, which is overwritten with their Fourier coefficients in alpha and
+// gamma.
+static complex double so3_quadrature_inner_product(
+    complex double *work, const so3_parameters_t *parameters) {
+  const int L = parameters->L, N = parameters->N;
+  const int M = so3_sampling_mlim(parameters);
+  const int nalpha = so3_sampling_nalpha(parameters);
+  const int nbeta = so3_sampling_nbeta(parameters);
+  const int ngamma = so3_sampling_ngamma(parameters);
+  const int nm = 2 * M - 1;
+  double offset, offset_fine;
+  const int ncircle = so3_quadrature_circle(&offset, parameters, L);
+  const int ncircle_fine = so3_quadrature_circle(&offset_fine, parameters, 2 * L - 1);
+  const so3_fft_dim_t dims[2] = {
+      {ngamma, nalpha * nbeta, nalpha * nbeta}, {nalpha, 1, 1}};
+  const int f_size = so3_sampling_f_size(parameters);
+  const so3_fft_dim_t howmany_dims[2] = {
+      {2, f_size, f_size}, {nbeta, nalpha, nalpha}};
+  const complex double *f = work, *g = work + f_size;
+  complex double *circle = malloc(2 * nm * ncircle * sizeof *circle);
+  complex double *fine = malloc(2 * nm * ncircle_fine * sizeof *fine);
+  complex double *shift = malloc((2 * L - 1) * sizeof *shift);
+  double *weights = malloc(ncircle_fine * sizeof *weights);
+  so3_fft_plan_t *plan;
+  double re = 0.0, im = 0.0;
+  int m, n, k, j;
+  SO3_ERROR_MEM_ALLOC_CHECK(circle);
+  SO3_ERROR_MEM_ALLOC_CHECK(fine);
+  SO3_ERROR_MEM_ALLOC_CHECK(shift);
+  SO3_ERROR_MEM_ALLOC_CHECK(weights);
+
+  if (parameters->steerable)
+    SO3_ERROR_GENERIC("Inner products of steerable signals are not supported.");
+
+  // Fourier coefficients in alpha and gamma of every ring in beta.
+  plan = so3_fft_plan_guru(
+      SO3_FFT_C2C, 2, dims, 2, howmany_dims, work, work, SO3_FFT_FORWARD,
+      SO3_FFT_ESTIMATE);
+  so3_fft_execute(plan);
+  so3_fft_destroy_plan(plan);
+
+  so3_quadrature_circle_weights(weights, parameters, 2 * L - 1);
+  for (k = -L + 1; k < L; ++k)
+    shift[k + L - 1] = cexp(I * k * (offset_fine - offset));
+
+  // The circles of all m of one n for both signals, in blocks to bound the
+  // memory.
+  so3_fft_plan_t *plan_circle = so3_fft_plan_many_dft(
+      1, &ncircle, 2 * nm, circle, NULL, 1, ncircle, circle, NULL, 1, ncircle,
+      SO3_FFT_FORWARD, SO3_FFT_ESTIMATE);
+  so3_fft_plan_t *plan_fine = so3_fft_plan_many_dft(
+      1, &ncircle_fine, 2 * nm, fine, NULL, 1, ncircle_fine, fine, NULL, 1,
+      ncircle_fine, SO3_FFT_BACKWARD, SO3_FFT_ESTIMATE);
+  for (n = -N + 1; n < N; ++n) {
+    const int c = n < 0 ? n + ngamma : n;
+    for (m = -M + 1; m < M; ++m) {
+      const int a = m < 0 ? m + nalpha : m;
+      const double sign = (m + n) % 2 ? -1.0 : 1.0;
+      complex double *circle_f = circle + (m + M - 1) * ncircle;
+      complex double *circle_g = circle_f + nm * ncircle;
+      for (j = 0; j < ncircle; ++j) {
+        const int mirror = ncircle - j - (ncircle == 2 * L ? 0 : 1);
+        const int ind = j < nbeta ? a + nalpha * (j + nbeta * c)
+                                  : a + nalpha * (mirror + nbeta * c);
+        circle_f[j] = j < nbeta ? f[ind] : sign * f[ind];
+        circle_g[j] = j < nbeta ? g[ind] : sign * g[ind];
+      }
+    }
+    so3_fft_execute(plan_circle);
+
+    memset(fine, 0, 2 * nm * ncircle_fine * sizeof *fine);
+    for (j = 0; j < 2 * nm; ++j)
+      for (k = -L + 1; k < L; ++k)
+        fine[j * ncircle_fine + (k < 0 ? k + ncircle_fine : k)] =
+            shift[k + L - 1] * circle[j * ncircle + (k < 0 ? k + ncircle : k)];
+    so3_fft_execute(plan_fine);
+
+    SO3_PRAGMA(omp parallel for schedule(static) reduction(+ : re, im))
+    for (j = 0; j < nm * ncircle_fine; ++j) {
+      const complex double product =
+          fine[j] * conj(fine[nm * ncircle_fine + j]) * weights[j % ncircle_fine];
+      re += creal(product);
+      im += cimag(product);
+    }
+  }
+  so3_fft_destroy_plan(plan_circle);
+  so3_fft_destroy_plan(plan_fine);
+
+  free(circle);
+  free(fine);
+  free(shift);
+  free(weights);
+  {
+    const double scale = 1.0 / ((double)nalpha * ngamma * ncircle);
+    return 4.0 * SO3_PI * SO3_PI * scale * scale * (re + I * im);
+  }
+}
+
+/*!
+ * Compute the inner product of two complex signals.
+ *
+ * \param[in] f First signal on the grid of parameters, band-limited as
+ *              described by parameters.
+ * \param[in] g Second signal on the grid of parameters, band-limited as
+ *              described by parameters.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval product Integral of f conj(g) with respect to the Haar measure,
+ *                 exact although the product has band-limit 2L-1.
+ */
+complex double so3_inner_product(
+    const complex double *f, const complex double *g,
+    const so3_parameters_t *parameters) {
+  const int f_size = so3_sampling_f_size(parameters);
+  complex double *work = malloc(2 * (size_t)f_size * sizeof *work);
+  complex double product;
+  SO3_ERROR_MEM_ALLOC_CHECK(work);
+
+  if (parameters->reality)
+    SO3_ERROR_GENERIC("Parameters are for real signals. Use so3_inner_product_real.");
+  memcpy(work, f, f_size * sizeof *work);
+  memcpy(work + f_size, g, f_size * sizeof *work);
+  product = so3_quadrature_inner_product(work, parameters);
+  free(work);
+  return product;
+}
+
+/*!
+ * Compute the inner product of two real signals.
+ *
+ * \param[in] f First signal on the grid of parameters, band-limited as
+ *              described by parameters.
+ * \param[in] g Second signal on the grid of parameters, band-limited as
+ *              described by parameters.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval product Integral of f g with respect to the Haar measure, exact
+ *                 although the product has band-limit 2L-1.
+ */
+double so3_inner_product_real(
+    const double *f, const double *g, const so3_parameters_t *parameters) {
+  const int f_size = so3_sampling_f_size(parameters);
+  complex double *work = malloc(2 * (size_t)f_size * sizeof *work);
+  double product;
+  int i;
+  SO3_ERROR_MEM_ALLOC_CHECK(work);
+
+  if (!parameters->reality)
+    SO3_ERROR_GENERIC("Parameters are for complex signals. Use so3_inner_product.");
+  for (i = 0; i < f_size; ++i) {
+    work[i] = f[i];
+    work[f_size + i] = g[i];
+  }
+  product = creal(so3_quadrature_inner_product(work, parameters));
+  free(work);
+  return product;
+}
@@ -0,0 +1,358 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_resample.c
+ * Resampling of signals to other band-limits and sampling schemes.
+ *
+ * Removing harmonic content, i.e. lowering L, N or M, or raising L0, needs
+ * the Wigner coefficients: the signal is transformed forward, the coefficients
+ * are truncated by \link so3_flmn_change_bandlimit \endlink and transformed
+ * back, with the algorithms and plans chosen by the tuner.
+ *
+ * Otherwise, the signal is already band-limited for the output, and the
+ * resampling is done with FFTs alone, which also converts between the MW and
+ * MWSS grids at the same band-limits. For fixed frequencies (m, n) in alpha
+ * and gamma, a signal of band-limit L is a trigonometric polynomial of degree
+ * L-1 in beta once it is extended to [0, 2*pi) by
+ *
+ *   f(alpha, 2*pi - beta, gamma) = f(alpha + pi, beta, gamma + pi).
+ *
+ * The MW and MWSS grids sample this extension at 2L-1 and 2L equispaced
+ * points, so it is recovered by an FFT in beta and evaluated on the output
+ * grid by zero-padding its spectrum, as in alpha and gamma. The cost is that
+ * of FFTs over the grids instead of O(L^4) Wigner transforms.
+ *
+ * A plan keeps the FFT plans and buffers of either path, so that many signals
+ * can be resampled between the same grids without re-planning.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_fft.h"
+#include "so3/so3_flmn.h"
+#include "so3/so3_resample.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+
+// Whether every coefficient allowed by parameters_in is allowed by
+// parameters_out, so that no harmonic content has to be removed.
+static int so3_resample_is_direct(
+    const so3_parameters_t *parameters_out, const so3_parameters_t *parameters_in) {
+  if (parameters_out->steerable || parameters_in->steerable)
+    return 0;
+  if (parameters_out->L < parameters_in->L || parameters_out->N < parameters_in->N ||
+      parameters_out->L0 > parameters_in->L0 ||
+      so3_sampling_mlim(parameters_out) < so3_sampling_mlim(parameters_in))
+    return 0;
+  if (parameters_out->n_mode == SO3_N_MODE_ALL)
+    return 1;
+  // The n of SO3_N_MODE_MAXIMUM depend on N.
+  return parameters_out->n_mode == parameters_in->n_mode &&
+         (parameters_in->n_mode != SO3_N_MODE_MAXIMUM ||
+          parameters_out->N == parameters_in->N);
+}
+
+// Number of equispaced samples of the extension in beta to [0, 2*pi), and the
+// angle of the first.
+static int so3_resample_circle(double *offset, const so3_parameters_t *parameters) {
+  const int L = parameters->L;
+  if (parameters->sampling_scheme == SO3_SAMPLING_MW_SS) {
+    *offset = 0.0;
+    return 2 * L;
+  }
+  *offset = SO3_PI / (2 * L - 1);
+  return 2 * L - 1;
+}
+
+struct so3_resample_plan {
+  so3_parameters_t parameters_out, parameters_in;
+  int direct;
+  int f_size_in, f_size_out;
+  // FFT path: the (m, n) pairs, their circles in beta, the input and output
+  // grids, and the phase shift between the first samples of the circles.
+  int npairs, ncircle_in, ncircle_out;
+  complex double *work, *circle_in, *circle_out, *out, *shift;
+  so3_fft_plan_t *plan_in, *plan_circle_in, *plan_circle_out, *plan_out;
+  // Harmonic path: coefficients before and after the change of band-limits.
+  complex double *flmn_in, *flmn_out;
+};
+
+// 2D FFTs over (gamma, alpha) of every beta of a signal, in place.
+static so3_fft_plan_t *so3_resample_grid_plan(
+    complex double *f, const so3_parameters_t *parameters, int sign) {
+  const int nalpha = so3_sampling_nalpha(parameters);
+  const int nbeta = so3_sampling_nbeta(parameters);
+  const int ngamma = so3_sampling_ngamma(parameters);
+  const so3_fft_dim_t dims[2] = {
+      {ngamma, nalpha * nbeta, nalpha * nbeta}, {nalpha, 1, 1}};
+  const so3_fft_dim_t howmany_dims[1] = {{nbeta, nalpha, nalpha}};
+  return so3_fft_plan_guru(
+      SO3_FFT_C2C, 2, dims, 1, howmany_dims, f, f, sign, SO3_FFT_ESTIMATE);
+}
+
+/*!
+ * Prepare the resampling of signals from one grid to another.
+ *
+ * \param[in] parameters_out A fully populated parameters object of the
+ *                           output signals.
+ * \param[in] parameters_in A fully populated parameters object of the input
+ *                          signals. The reality flags of both must agree, and
+ *                          select between \link so3_resample_execute \endlink
+ *                          and \link so3_resample_execute_real \endlink.
+ * \retval plan Plan. Free it with \link so3_resample_plan_free \endlink.
+ */
+so3_resample_plan_t *so3_resample_plan_init(
+    const so3_parameters_t *parameters_out, const so3_parameters_t *parameters_in) {
+  if (!parameters_out->reality != !parameters_in->reality)
+    SO3_ERROR_GENERIC("Input and output must both be real or both be complex.");
+
+  so3_resample_plan_t *plan = calloc(1, sizeof *plan);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan);
+  plan->parameters_out = *parameters_out;
+  plan->parameters_in = *parameters_in;
+  parameters_out = &plan->parameters_out;
+  parameters_in = &plan->parameters_in;
+  plan->f_size_in = so3_sampling_f_size(parameters_in);
+  plan->f_size_out = so3_sampling_f_size(parameters_out);
+  plan->direct = so3_resample_is_direct(parameters_out, parameters_in);
+
+  if (!plan->direct) {
+    plan->flmn_in =
+        malloc(so3_sampling_flmn_size(parameters_in) * sizeof *plan->flmn_in);
+    plan->flmn_out =
+        malloc(so3_sampling_flmn_size(parameters_out) * sizeof *plan->flmn_out);
+    SO3_ERROR_MEM_ALLOC_CHECK(plan->flmn_in);
+    SO3_ERROR_MEM_ALLOC_CHECK(plan->flmn_out);
+    return plan;
+  }
+
+  const int L = parameters_in->L, N = parameters_in->N;
+  const int M = so3_sampling_mlim(parameters_in);
+  double offset_in, offset_out;
+  int k;
+
+  plan->npairs = (2 * M - 1) * (2 * N - 1);
+  plan->ncircle_in = so3_resample_circle(&offset_in, parameters_in);
+  plan->ncircle_out = so3_resample_circle(&offset_out, parameters_out);
+  plan->work = malloc(plan->f_size_in * sizeof *plan->work);
+  plan->circle_in = malloc(plan->npairs * plan->ncircle_in * sizeof *plan->circle_in);
+  plan->circle_out =
+      malloc(plan->npairs * plan->ncircle_out * sizeof *plan->circle_out);
+  plan->out = malloc(plan->f_size_out * sizeof *plan->out);
+  plan->shift = malloc((2 * L - 1) * sizeof *plan->shift);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->work);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->circle_in);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->circle_out);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->out);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->shift);
+
+  const double scale = 1.0 / ((double)so3_sampling_nalpha(parameters_in) *
+                              so3_sampling_ngamma(parameters_in) * plan->ncircle_in);
+  for (k = -L + 1; k < L; ++k)
+    plan->shift[k + L - 1] = scale * cexp(I * k * (offset_out - offset_in));
+
+  plan->plan_in = so3_resample_grid_plan(plan->work, parameters_in, SO3_FFT_FORWARD);
+  plan->plan_circle_in = so3_fft_plan_many_dft(
+      1, &plan->ncircle_in, plan->npairs, plan->circle_in, NULL, 1, plan->ncircle_in,
+      plan->circle_in, NULL, 1, plan->ncircle_in, SO3_FFT_FORWARD, SO3_FFT_ESTIMATE);
+  plan->plan_circle_out = so3_fft_plan_many_dft(
+      1, &plan->ncircle_out, plan->npairs, plan->circle_out, NULL, 1, plan->ncircle_out,
+      plan->circle_out, NULL, 1, plan->ncircle_out, SO3_FFT_BACKWARD, SO3_FFT_ESTIMATE);
+  plan->plan_out = so3_resample_grid_plan(plan->out, parameters_out, SO3_FFT_BACKWARD);
+  return plan;
+}
+
+/*!
+ * Free a resampling plan.
+ *
+ * \param[in] plan Plan, may be NULL.
+ * \retval none
+ */
+void so3_resample_plan_free(so3_resample_plan_t *plan) {
+  if (plan == NULL)
+    return;
+  if (plan->direct) {
+    so3_fft_destroy_plan(plan->plan_in);
+    so3_fft_destroy_plan(plan->plan_circle_in);
+    so3_fft_destroy_plan(plan->plan_circle_out);
+    so3_fft_destroy_plan(plan->plan_out);
+  }
+  free(plan->work);
+  free(plan->circle_in);
+  free(plan->circle_out);
+  free(plan->out);
+  free(plan->shift);
+  free(plan->flmn_in);
+  free(plan->flmn_out);
+  free(plan);
+}
+
+// Resample the signal in the work buffer of the plan into its out buffer.
+static void so3_resample_direct(so3_resample_plan_t *plan) {
+  const so3_parameters_t *parameters_in = &plan->parameters_in;
+  const so3_parameters_t *parameters_out = &plan->parameters_out;
+  const int L = parameters_in->L, N = parameters_in->N;
+  const int M = so3_sampling_mlim(parameters_in);
+  const int nalpha_in = so3_sampling_nalpha(parameters_in);
+  const int nbeta_in = so3_sampling_nbeta(parameters_in);
+  const int ngamma_in = so3_sampling_ngamma(parameters_in);
+  const int nalpha_out = so3_sampling_nalpha(parameters_out);
+  const int nbeta_out = so3_sampling_nbeta(parameters_out);
+  const int ngamma_out = so3_sampling_ngamma(parameters_out);
+  const int ncircle_in = plan->ncircle_in, ncircle_out = plan->ncircle_out;
+  const complex double *work = plan->work;
+  int m, n, k, j;
+
+  // Fourier coefficients in alpha and gamma of every row in beta.
+  so3_fft_execute(plan->plan_in);
+
+  // Extension of every (m, n) to the circle in beta, and its spectrum.
+  for (n = -N + 1; n < N; ++n)
+    for (m = -M + 1; m < M; ++m) {
+      const int a = m < 0 ? m + nalpha_in : m;
+      const int g = n < 0 ? n + ngamma_in : n;
+      const double sign = (m + n) % 2 ? -1.0 : 1.0;
+      complex double *circle =
+          plan->circle_in + ((n + N - 1) * (2 * M - 1) + m + M - 1) * ncircle_in;
+      for (j = 0; j < ncircle_in; ++j) {
+        const int mirror = ncircle_in - j - (ncircle_in == 2 * L ? 0 : 1);
+        circle[j] = j < nbeta_in
+                        ? work[a + nalpha_in * (j + nbeta_in * g)]
+                        : sign * work[a + nalpha_in * (mirror + nbeta_in * g)];
+      }
+    }
+  so3_fft_execute(plan->plan_circle_in);
+
+  // Zero-padded spectrum on the output circle, shifted to its first sample,
+  // and back to beta.
+  memset(plan->circle_out, 0, plan->npairs * ncircle_out * sizeof *plan->circle_out);
+  for (j = 0; j < plan->npairs; ++j)
+    for (k = -L + 1; k < L; ++k)
+      plan->circle_out[j * ncircle_out + (k < 0 ? k + ncircle_out : k)] =
+          plan->shift[k + L - 1] *
+          plan->circle_in[j * ncircle_in + (k < 0 ? k + ncircle_in : k)];
+  so3_fft_execute(plan->plan_circle_out);
+
+  // Zero-padded spectra in alpha and gamma, and back to the output grid.
+  memset(plan->out, 0, plan->f_size_out * sizeof *plan->out);
+  for (n = -N + 1; n < N; ++n)
+    for (m = -M + 1; m < M; ++m) {
+      const int a = m < 0 ? m + nalpha_out : m;
+      const int g = n < 0 ? n + ngamma_out : n;
+      const complex double *circle =
+          plan->circle_out + ((n + N - 1) * (2 * M - 1) + m + M - 1) * ncircle_out;
+      for (j = 0; j < nbeta_out; ++j)
+        plan->out[a + nalpha_out * (j + nbeta_out * g)] = circle[j];
+    }
+  so3_fft_execute(plan->plan_out);
+}
+
+/*!
+ * Resample a complex signal with a plan, see \link so3_resample \endlink.
+ *
+ * \param[in,out] plan Plan for complex signals, whose buffers are reused. A
+ *                     plan must not be used by several threads at once.
+ * \param[out] f_out Signal on the output grid of the plan.
+ * \param[in] f_in Signal on the input grid of the plan.
+ * \retval none
+ */
+void so3_resample_execute(
+    so3_resample_plan_t *plan, complex double *f_out, const complex double *f_in) {
+  if (plan->parameters_in.reality)
+    SO3_ERROR_GENERIC("Plan is for real signals. Use so3_resample_execute_real.");
+  if (plan->direct) {
+    memcpy(plan->work, f_in, plan->f_size_in * sizeof *f_in);
+    so3_resample_direct(plan);
+    memcpy(f_out, plan->out, plan->f_size_out * sizeof *f_out);
+    return;
+  }
+
+  so3_core_forward_auto(plan->flmn_in, f_in, &plan->parameters_in);
+  so3_flmn_change_bandlimit(
+      plan->flmn_out, &plan->parameters_out, plan->flmn_in, &plan->parameters_in);
+  so3_core_inverse_auto(f_out, plan->flmn_out, &plan->parameters_out);
+}
+
+/*!
+ * Resample a real signal with a plan, see \link so3_resample_real \endlink.
+ *
+ * \param[in,out] plan Plan for real signals, whose buffers are reused.
+ * \param[out] f_out Real signal on the output grid of the plan.
+ * \param[in] f_in Real signal on the input grid of the plan.
+ * \retval none
+ */
+void so3_resample_execute_real(
+    so3_resample_plan_t *plan, double *f_out, const double *f_in) {
+  int i;
+
+  if (!plan->parameters_in.reality)
+    SO3_ERROR_GENERIC("Plan is for complex signals. Use so3_resample_execute.");
+  if (plan->direct) {
+    for (i = 0; i < plan->f_size_in; ++i)
+      plan->work[i] = f_in[i];
+    so3_resample_direct(plan);
+    for (i = 0; i < plan->f_size_out; ++i)
+      f_out[i] = creal(plan->out[i]);
+    return;
+  }
+
+  so3_core_forward_auto_real(plan->flmn_in, f_in, &plan->parameters_in);
+  so3_flmn_change_bandlimit(
+      plan->flmn_out, &plan->parameters_out, plan->flmn_in, &plan->parameters_in);
+  so3_core_inverse_auto_real(f_out, plan->flmn_out, &plan->parameters_out);
+}
+
+/*!
+ * Resample a complex signal to other band-limits or another sampling scheme.
+ *
+ * \param[out] f_out Signal on the grid of parameters_out.
+ * \param[in] parameters_out A fully populated parameters object.
+ * \param[in] f_in Signal on the grid of parameters_in, band-limited as
+ *                 described by parameters_in.
+ * \param[in] parameters_in A fully populated parameters object.
+ * \retval none
+ *
+ * \note If parameters_out allows every harmonic coefficient of parameters_in,
+ *       e.g. for larger band-limits or for a change of sampling scheme, only
+ *       FFTs are used. Otherwise the signal is transformed to harmonic space
+ *       and back. Every call plans anew; use \link so3_resample_plan_init
+ *       \endlink to resample several signals between the same grids.
+ */
+void so3_resample(
+    complex double *f_out, const so3_parameters_t *parameters_out,
+    const complex double *f_in, const so3_parameters_t *parameters_in) {
+  if (parameters_out->reality || parameters_in->reality)
+    SO3_ERROR_GENERIC("Parameters are for real signals. Use so3_resample_real.");
+  so3_resample_plan_t *plan = so3_resample_plan_init(parameters_out, parameters_in);
+  so3_resample_execute(plan, f_out, f_in);
+  so3_resample_plan_free(plan);
+}
+
+/*!
+ * Resample a real signal to other band-limits or another sampling scheme, see
+ * \link so3_resample \endlink.
+ *
+ * \param[out] f_out Real signal on the grid of parameters_out.
+ * \param[in] parameters_out A fully populated parameters object for real
+ *                           signals.
+ * \param[in] f_in Real signal on the grid of parameters_in.
+ * \param[in] parameters_in A fully populated parameters object for real
+ *                          signals.
+ * \retval none
+ */
+void so3_resample_real(
+    double *f_out, const so3_parameters_t *parameters_out, const double *f_in,
+    const so3_parameters_t *parameters_in) {
+  if (!parameters_out->reality || !parameters_in->reality)
+    SO3_ERROR_GENERIC("Parameters are for complex signals. Use so3_resample.");
+  so3_resample_plan_t *plan = so3_resample_plan_init(parameters_out, parameters_in);
+  so3_resample_execute_real(plan, f_out, f_in);
+  so3_resample_plan_free(plan);
+}
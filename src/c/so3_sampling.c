@@ -8,12 +8,15 @@
 #include <stdbool.h> 
 #include "so3/so3_error.h"
 #include "so3/so3_types.h"
+#include "so3/so3_sampling.h"
 
 int so3_sampling_nalpha(const so3_parameters_t *);
 int so3_sampling_nbeta(const so3_parameters_t *);
 int so3_sampling_ngamma(const so3_parameters_t *);
+int so3_sampling_mlim(const so3_parameters_t *);
 
 #define MAX(a,b) ((a > b) ? (a) : (b))
+#define MIN(a,b) ((a < b) ? (a) : (b))
 
 //============================================================================
 // Sampling weights
@@ -119,20 +122,38 @@ int so3_sampling_n(const so3_parameters_t *parameters)
     switch (parameters->sampling_scheme)
     {
     case SO3_SAMPLING_MW:
-        return ((2*L-1)*(L-1) + 1)*so3_sampling_ngamma(parameters);
+        return (so3_sampling_nalpha(parameters)*(L-1) + 1)*so3_sampling_ngamma(parameters);
     case SO3_SAMPLING_MW_SS:
-        return ((2*L)*(L-1) + 2)*so3_sampling_ngamma(parameters);
+        return (so3_sampling_nalpha(parameters)*(L-1) + 2)*so3_sampling_ngamma(parameters);
     default:
         SO3_ERROR_GENERIC("Invalid sampling scheme.");
     }
 }
 
 
+/*!
+ * Compute the effective azimuthal band-limit.
+ *
+ * \param[in] parameters A parameters object with (at least) the following fields:
+ *                       \link so3_parameters_t::L L\endlink,
+ *                       \link so3_parameters_t::M M\endlink
+ * \retval M Azimuthal band-limit, i.e. M if 0 < M < L and L otherwise.
+ */
+int so3_sampling_mlim(const so3_parameters_t *parameters)
+{
+    if (parameters->M > 0 && parameters->M < parameters->L)
+        return parameters->M;
+    else
+        return parameters->L;
+}
+
+
 /*!
  * Compute number of alpha samples for a given sampling scheme.
  *
  * \param[in] parameters A parameters object with (at least) the following fields:
  *                       \link so3_parameters_t::L L\endlink,
+ *                       \link so3_parameters_t::M M\endlink,
  *                       \link so3_parameters_t::sampling_scheme sampling_scheme\endlink
  * \retval nalpha Number of alpha samples.
  *
@@ -141,15 +162,15 @@ int so3_sampling_n(const so3_parameters_t *parameters)
  */
 int so3_sampling_nalpha(const so3_parameters_t *parameters)
 {
-    int L;
-    L = parameters->L;
+    int M;
+    M = so3_sampling_mlim(parameters);
 
     switch (parameters->sampling_scheme)
     {
     case SO3_SAMPLING_MW:
-        return 2*L - 1;
+        return 2*M - 1;
     case SO3_SAMPLING_MW_SS:
-        return 2*L;
+        return 2*M;
     default:
         SO3_ERROR_GENERIC("Invalid sampling scheme.");
     }
@@ -210,11 +231,12 @@ int so3_sampling_ngamma(const so3_parameters_t *parameters)
  * Convert alpha index to angle for a given sampling scheme.
  *
  * \note
- *  - a ranges from [0 .. 2*L-2] => 2*L-1 points in [0,2*pi).
+ *  - a ranges from [0 .. 2*M-2] => 2*M-1 points in [0,2*pi).
  *
  * \param[in] a Alpha index.
  * \param[in] parameters A parameters object with (at least) the following fields:
  *                       \link so3_parameters_t::L L\endlink,
+ *                       \link so3_parameters_t::M M\endlink,
  *                       \link so3_parameters_t::sampling_scheme sampling_scheme\endlink
  * \retval alpha Alpha angle.
  *
@@ -223,15 +245,15 @@ int so3_sampling_ngamma(const so3_parameters_t *parameters)
  */
 double so3_sampling_a2alpha(int a, const so3_parameters_t *parameters)
 {
-    int L;
-    L = parameters->L;
+    int M;
+    M = so3_sampling_mlim(parameters);
 
     switch (parameters->sampling_scheme)
     {
     case SO3_SAMPLING_MW:
-        return 2.0 * a * SO3_PI / (2.0*L - 1.0);
+        return 2.0 * a * SO3_PI / (2.0*M - 1.0);
     case SO3_SAMPLING_MW_SS:
-        return 2.0 * a * SO3_PI / (2.0*L);
+        return 2.0 * a * SO3_PI / (2.0*M);
     default:
         SO3_ERROR_GENERIC("Invalid sampling scheme.");
     }
@@ -300,12 +322,97 @@ double so3_sampling_g2gamma(int g, const so3_parameters_t *parameters)
 // Harmonic index relations
 //============================================================================
 
+// Number of (el, m) pairs with el' < el and |m| < M, i.e. the offset of
+// el within a single flm-block.
+static int so3_sampling_lm_offset(int el, int M)
+{
+    if (el <= M)
+        return el*el;
+    else
+        return M*M + (el-M)*(2*M-1);
+}
+
+// Sum of so3_sampling_lm_offset(j, M) for j from 1 to k. For M >= k this
+// is the sum over j*j from 1 to k, i.e. k*(k+1)*(2*k+1)/6.
+static int so3_sampling_lm_offset_sum(int k, int M)
+{
+    if (k <= M)
+        return k*(k+1)*(2*k+1)/6;
+    else
+        return M*(M+1)*(2*M+1)/6 + (k-M)*M*M + (2*M-1)*(k-M)*(k-M+1)/2;
+}
+
+// Inverse of el*el + el + m (generalised to |m| < M) within an flm-block.
+static void so3_sampling_ind2lm(int *el, int *m, int ind, int M)
+{
+    if (ind < M*M)
+    {
+        *el = sqrt(ind);
+        *m = ind - (*el)*(*el) - *el;
+    }
+    else
+    {
+        ind -= M*M;
+        *el = M + ind/(2*M-1);
+        *m = ind%(2*M-1) - (M-1);
+    }
+}
+
+// Total size of the compact flm-blocks for |n| = 1 .. k, where the block
+// for |n| lacks the so3_sampling_lm_offset(|n|, M) coefficients with
+// el < |n|.
+static int so3_sampling_compact_blocks_size(int k, int lm_size, int M)
+{
+    return k*lm_size - so3_sampling_lm_offset_sum(k, M);
+}
+
+// Inverse of so3_sampling_compact_blocks_size: the largest k in [0, kmax]
+// for which the blocks for |n| = 1 .. k fit into the first ind coefficients.
+// For k <= M the block sizes sum to a cubic in k, whose smallest positive
+// root follows from the trigonometric solution of the depressed cubic, and
+// beyond M to a quadratic. The floating point estimate is off by at most
+// one, which the integer checks at the end correct.
+static int so3_sampling_compact_blocks_inverse(int ind, int L, int M, int kmax)
+{
+    int lm_size, k;
+    double p, q, r, b, d;
+
+    lm_size = so3_sampling_lm_offset(L, M);
+
+    if (M >= kmax || ind < so3_sampling_compact_blocks_size(M, lm_size, M))
+    {
+        // k*lm_size - k*(k+1)*(2*k+1)/6 = ind, shifted by k = t - 1/2
+        // to t^3 + p*t + q = 0.
+        p = -(3.0*lm_size + 0.25);
+        q = 1.5*lm_size + 3.0*ind;
+        r = 1.5*q/p*sqrt(-3.0/p);
+        r = MAX(-1.0, MIN(1.0, r));
+        k = floor(2.0*sqrt(-p/3.0)*cos(acos(r)/3.0 - 2.0*SO3_PI/3.0) - 0.5);
+    }
+    else
+    {
+        // With j = k - M, the blocks beyond M grow the size by
+        // (2*M-1)*(j*(2*(L-M)-1) - j*j)/2.
+        b = 2*(L-M) - 1;
+        d = 2.0*(ind - so3_sampling_compact_blocks_size(M, lm_size, M))/(2*M-1);
+        k = M + floor((b - sqrt(MAX(0.0, b*b - 4.0*d)))/2.0);
+    }
+
+    k = MAX(0, MIN(k, kmax));
+    while (k < kmax && so3_sampling_compact_blocks_size(k+1, lm_size, M) <= ind)
+        k++;
+    while (k > 0 && so3_sampling_compact_blocks_size(k, lm_size, M) > ind)
+        k--;
+    return k;
+}
+
 /*!
  * Get storage size of flmn array for different storage methods.
  *
  * \param[in] parameters A parameters object with (at least) the following fields:
  *                       \link so3_parameters_t::L L\endlink,
  *                       \link so3_parameters_t::N N\endlink,
+ *                       \link so3_parameters_t::M M\endlink,
  *                       \link so3_parameters_t::storage storage\endlink,
  *                       \link so3_parameters_t::reality reality\endlink
  * \retval Number of coefficients to be stored.
@@ -316,23 +423,26 @@ double so3_sampling_g2gamma(int g, const so3_parameters_t *parameters)
 int so3_sampling_flmn_size(
     const so3_parameters_t *parameters
 ) {
-    int L, N;
+    int L, N, M, lm_size;
     L = parameters->L;
     N = parameters->N;
+    M = so3_sampling_mlim(parameters);
+    // Size of a single (padded) flm-block.
+    lm_size = so3_sampling_lm_offset(L, M);
     switch (parameters->storage)
     {
     case SO3_STORAGE_PADDED:
         if (parameters->reality)
-            return N*L*L;
+            return N*lm_size;
         else
-            return (2*N-1)*L*L;
+            return (2*N-1)*lm_size;
     case SO3_STORAGE_COMPACT:
-        // Both of these are based on the fact that the sum
-        // over n*n from 1 to N-1 is (N-1)*N*(2*N-1)/6.
+        // For M = L, the sum of the block offsets is the sum
+        // over n*n from 1 to N-1, i.e. (N-1)*N*(2*N-1)/6.
         if (parameters->reality)
-            return N*(6*L*L-(N-1)*(2*N-1))/6;
+            return N*lm_size - so3_sampling_lm_offset_sum(N-1, M);
         else
-            return (2*N-1)*(3*L*L-N*(N-1))/3;
+            return (2*N-1)*lm_size - 2*so3_sampling_lm_offset_sum(N-1, M);
     default:
         SO3_ERROR_GENERIC("Invalid storage method.");
     }
@@ -344,7 +454,7 @@ int so3_sampling_flmn_size(
  *
  * \note Index ranges are as follows:
  *  - el ranges from [0 .. L-1].
- *  - m ranges from [-el .. el].
+ *  - m ranges from [-min{el, M-1} .. min{el, M-1}].
  *  - n ranges from [-el' .. el'], where el' = min{el, N}
  *  - ind ranges from [0 .. (2*N)(L**2-N(N-1)/3)-1] for compact storage methods
              and from [0 .. (2*N-1)*L**2-1] for 0-padded storage methods.
@@ -368,24 +478,31 @@ int so3_sampling_flmn_size(
  */
 void so3_sampling_elmn2ind(int *ind, int el, int m, int n, const so3_parameters_t *parameters)
 {
-    int L, N, offset, absn;
+    int L, N, M, offset, absn, lm_size, lm_ind;
     L = parameters->L;
     N = parameters->N;
+    M = so3_sampling_mlim(parameters);
+
+    // Size of a single (padded) flm-block and position of (el,m) in it.
+    // For M = L these are L*L and el*el + el + m, respectively.
+    lm_size = so3_sampling_lm_offset(L, M);
+    lm_ind = so3_sampling_lm_offset(el, M) + MIN(el, M-1) + m;
 
     // Most of the formulae here are based on the fact that the sum
-    // over n*n from 1 to N-1 is (N-1)*N*(2*N-1)/6.
+    // over n*n from 1 to N-1 is (N-1)*N*(2*N-1)/6, which generalises
+    // to so3_sampling_lm_offset_sum for M < L.
     switch (parameters->storage)
     {
     case SO3_STORAGE_PADDED:
         switch (parameters->n_order)
         {
         case SO3_N_ORDER_ZERO_FIRST:
-            offset = ((n < 0) ? -2*n - 1 : 2*n) * L*L;
-            *ind = offset + el*el + el + m;
+            offset = ((n < 0) ? -2*n - 1 : 2*n) * lm_size;
+            *ind = offset + lm_ind;
             return;
         case SO3_N_ORDER_NEGATIVE_FIRST:
-            offset = (N-1 + n) * L*L;
-            *ind = offset + el*el + el + m;
+            offset = (N-1 + n) * lm_size;
+            *ind = offset + lm_ind;
             return;
         default:
             SO3_ERROR_GENERIC("Invalid n-order.");
@@ -398,24 +515,24 @@ void so3_sampling_elmn2ind(int *ind, int el, int m, int n, const so3_parameters_
             if (absn > el)
                 SO3_ERROR_GENERIC("Tried to access component with n > l in compact storage.");
             // Initialize offset to the total storage that would be needed if N == n
-            offset = (2*absn-1)*(3*L*L - absn*(absn-1))/3;
+            offset = (2*absn-1)*lm_size - 2*so3_sampling_lm_offset_sum(absn-1, M);
             // Advance positive n by another lm-chunk
             if (n >= 0)
-                offset += L*L - n*n;
-            *ind = offset + el*el - n*n + el + m;
+                offset += lm_size - so3_sampling_lm_offset(absn, M);
+            *ind = offset + lm_ind - so3_sampling_lm_offset(absn, M);
             return;
         case SO3_N_ORDER_NEGATIVE_FIRST:
             absn = abs(n);
             if (absn > el)
                 SO3_ERROR_GENERIC("Tried to access component with n > l in compact storage.");
             // Initialize offset as for padded storage, minus the correction necessary for n = 0
-            offset = (N-1 + n) * L*L - (2*N - 1)*(N-1)*N/6;
+            offset = (N-1 + n) * lm_size - so3_sampling_lm_offset_sum(N-1, M);
             // Now correct the offset for other n due to missing padding
             if (n <= 0)
-                offset += absn*(2*absn+1)*(absn+1)/6;
+                offset += so3_sampling_lm_offset_sum(absn, M);
             else
-                offset -= absn*(2*absn-1)*(absn-1)/6;
-            *ind = offset + el*el - n*n + el + m;
+                offset -= so3_sampling_lm_offset_sum(absn-1, M);
+            *ind = offset + lm_ind - so3_sampling_lm_offset(absn, M);
             return;
         default:
             SO3_ERROR_GENERIC("Invalid n-order.");
@@ -431,7 +548,7 @@ void so3_sampling_elmn2ind(int *ind, int el, int m, int n, const so3_parameters_
  *
  * \note Index ranges are as follows:
  *  - el ranges from [0 .. L-1].
- *  - m ranges from [-el .. el].
+ *  - m ranges from [-min{el, M-1} .. min{el, M-1}].
  *  - n ranges from [-el' .. el'], where el' = min{el, N}
  *  - ind ranges from [0 .. (2*N)(L**2-N(N-1)/3)-1] for compact storage methods
              and from [0 .. (2*N-1)*L**2-1] for 0-padded storage methods.
@@ -454,9 +571,13 @@ void so3_sampling_elmn2ind(int *ind, int el, int m, int n, const so3_parameters_
  */
 void so3_sampling_ind2elmn(int *el, int *m, int *n, int ind, const so3_parameters_t *parameters)
 {
-    int L, N, offset;
+    int L, N, M, offset, start, absn, lm_size;
     L = parameters->L;
     N = parameters->N;
+    M = so3_sampling_mlim(parameters);
+
+    // Size of a single (padded) flm-block, L*L for M = L.
+    lm_size = so3_sampling_lm_offset(L, M);
 
     switch (parameters->storage)
     {
@@ -464,25 +585,23 @@ void so3_sampling_ind2elmn(int *el, int *m, int *n, int ind, const so3_parameter
         switch (parameters->n_order)
         {
         case SO3_N_ORDER_ZERO_FIRST:
-            *n = ind/(L*L);
+            *n = ind/lm_size;
 
             if(*n % 2)
                 *n = -(*n+1)/2;
             else
                 *n /= 2;
 
-            ind %= L*L;
+            ind %= lm_size;
 
-            *el = sqrt(ind);
-            *m = ind - (*el)*(*el) - *el;
+            so3_sampling_ind2lm(el, m, ind, M);
             return;
         case SO3_N_ORDER_NEGATIVE_FIRST:
-            *n = ind/(L*L) - (N-1);
+            *n = ind/lm_size - (N-1);
 
-            ind %= L*L;
+            ind %= lm_size;
 
-            *el = sqrt(ind);
-            *m = ind - (*el)*(*el) - *el;
+            so3_sampling_ind2lm(el, m, ind, M);
             return;
         default:
             SO3_ERROR_GENERIC("Invalid n-order.");
@@ -491,47 +610,51 @@ void so3_sampling_ind2elmn(int *el, int *m, int *n, int ind, const so3_parameter
         switch (parameters->n_order)
         {
         case SO3_N_ORDER_ZERO_FIRST:
+            // The n = 0 block is followed by the pairs of blocks for
+            // -|n| and |n|.
             offset = 0;
             *n = 0;
-            // TODO: Can this loop be replaced by an analytical function
-            // (or two - one for positive and one for negative *n)
-            while(ind + offset >= L*L)
+            if (ind >= lm_size)
             {
-                ind -= L*L - offset;
-
-                if (*n >= 0)
-                {
-                    *n = -(*n+1);
-                    offset = (*n)*(*n);
-                }
-                else
+                ind -= lm_size;
+                absn = so3_sampling_compact_blocks_inverse(ind/2, L, M, L-1) + 1;
+                ind -= 2*so3_sampling_compact_blocks_size(absn-1, lm_size, M);
+                offset = so3_sampling_lm_offset(absn, M);
+                *n = -absn;
+                if (ind >= lm_size - offset)
                 {
-                    *n = -(*n);
+                    ind -= lm_size - offset;
+                    *n = absn;
                 }
             }
 
-            ind += offset;
-
-            *el = sqrt(ind);
-            *m = ind - (*el)*(*el) - *el;
+            so3_sampling_ind2lm(el, m, ind + offset, M);
             return;
         case SO3_N_ORDER_NEGATIVE_FIRST:
-            *n = -N+1;
-            offset = (*n)*(*n);
-            // TODO: Can this loop be replaced by an analytical function
-            // (or two - one for positive and one for negative *n)
-            while(ind + offset >= L*L)
+            // The blocks for n < 0 end at the start of the n = 0 block,
+            // after which the blocks for n > 0 follow.
+            start = so3_sampling_compact_blocks_size(N-1, lm_size, M);
+            if (ind < start)
             {
-                ind -= L*L - offset;
-
-                (*n)++;
-                offset = (*n)*(*n);
+                absn = so3_sampling_compact_blocks_inverse(start-ind-1, L, M, N-1) + 1;
+                ind -= start - so3_sampling_compact_blocks_size(absn, lm_size, M);
+                *n = -absn;
+            }
+            else if (ind < start + lm_size)
+            {
+                absn = 0;
+                ind -= start;
+                *n = 0;
+            }
+            else
+            {
+                ind -= start + lm_size;
+                absn = so3_sampling_compact_blocks_inverse(ind, L, M, N-1) + 1;
+                ind -= so3_sampling_compact_blocks_size(absn-1, lm_size, M);
+                *n = absn;
             }
 
-            ind += offset;
-
-            *el = sqrt(ind);
-            *m = ind - (*el)*(*el) - *el;
+            so3_sampling_ind2lm(el, m, ind + so3_sampling_lm_offset(absn, M), M);
             return;
         default:
             SO3_ERROR_GENERIC("Invalid n-order.");
@@ -547,7 +670,7 @@ void so3_sampling_ind2elmn(int *el, int *m, int *n, int ind, const so3_parameter
  *
  * \note Index ranges are as follows:
  *  - el ranges from [0 .. L-1].
- *  - m ranges from [-el .. el].
+ *  - m ranges from [-min{el, M-1} .. min{el, M-1}].
  *  - n ranges from [0 .. el'], where el' = min{el, N}
  *  - ind ranges from [0 .. N*(L*L-(N-1)*(2*N-1)/6)-1] for compact storage methods
              and from [0 .. N*L*L-1] for 0-padded storage methods.
@@ -602,7 +725,7 @@ void so3_sampling_elmn2ind_real(int *ind, int el, int m, int n, const so3_parame
  *
  * \note Index ranges are as follows:
  *  - el ranges from [0 .. L-1].
- *  - m ranges from [-el .. el].
+ *  - m ranges from [-min{el, M-1} .. min{el, M-1}].
  *  - n ranges from [0 .. el'], where el' = min{el, N}
  *  - ind ranges from [0 .. N*(L*L-(N-1)*(2*N-1)/6)-1] for compact storage methods
              and from [0 .. N*L*L-1] for 0-padded storage methods.
@@ -834,7 +957,7 @@ bool so3_sampling_is_i_in_loop_range(const int i, const int i_start, const int i
  *
  * \note Index ranges are as follows:
  *  - el ranges from [0 .. L-1].
- *  - m ranges from [-el .. el].
+ *  - m ranges from [-min{el, M-1} .. min{el, M-1}].
  *  - n ranges from [-el' .. el'], where el' = min{el, N}
  *  - ind ranges from [0 .. (2*N)(L**2-N(N-1)/3)-1] for compact storage methods
              and from [0 .. (2*N-1)*L**2-1] for 0-padded storage methods.
@@ -871,6 +994,7 @@ bool so3_sampling_is_elmn_non_zero(const int el, const int m, const int n, const
 
     so3_sampling_m_loop_values(&m_start, &m_stop, &m_inc, el);
     if (!(so3_sampling_is_i_in_loop_range(m, m_start, m_stop, m_inc))) return false;
+    if (abs(m) >= so3_sampling_mlim(parameters)) return false;
 
     return true;
 
@@ -880,3 +1004,105 @@ int so3_sampling_is_elmn_non_zero_return_int(const int el, const int m, const in
     {
         return (int)so3_sampling_is_elmn_non_zero(el, m, n, parameters);
     }
+
+/*!
+ * Initialise a cursor over the coefficients of an flmn array. The cursor
+ * visits every stored coefficient in storage order, i.e. with ind running
+ * from 0 to \link so3_sampling_flmn_size \endlink - 1, and updates (el, m, n)
+ * incrementally, which avoids the index arithmetic of \link
+ * so3_sampling_ind2elmn \endlink when a whole array is processed.
+ *
+ * \note For padded storage, the padding coefficients with el < |n| are
+ *       visited as well. Use \link so3_sampling_is_elmn_non_zero \endlink
+ *       to skip coefficients that are zero for the given parameters.
+ *
+ * \param[out] iter Cursor, positioned before the first coefficient.
+ * \param[in]  parameters A parameters object with (at least) the following fields:
+ *                        \link so3_parameters_t::L L\endlink,
+ *                        \link so3_parameters_t::N N\endlink,
+ *                        \link so3_parameters_t::M M\endlink,
+ *                        \link so3_parameters_t::storage storage\endlink,
+ *                        \link so3_parameters_t::n_order n_order\endlink,
+ *                        \link so3_parameters_t::reality reality\endlink
+ * \retval none
+ *
+ * example:
+ *      so3_flmn_iter_init(&iter, &parameters);
+ *      while (so3_flmn_iter_next(&iter)) { flmn[iter.ind] ... iter.el ... }
+ */
+void so3_flmn_iter_init(so3_flmn_iter_t *iter, const so3_parameters_t *parameters)
+{
+    switch (parameters->storage)
+    {
+    case SO3_STORAGE_PADDED:
+    case SO3_STORAGE_COMPACT:
+        break;
+    default:
+        SO3_ERROR_GENERIC("Invalid storage method.");
+    }
+    switch (parameters->n_order)
+    {
+    case SO3_N_ORDER_ZERO_FIRST:
+    case SO3_N_ORDER_NEGATIVE_FIRST:
+        break;
+    default:
+        SO3_ERROR_GENERIC("Invalid n-order.");
+    }
+
+    iter->L = parameters->L;
+    iter->M = so3_sampling_mlim(parameters);
+    iter->size = so3_sampling_flmn_size(parameters);
+    iter->compact = parameters->storage == SO3_STORAGE_COMPACT;
+    // Real signals only store n >= 0, always in ascending order.
+    iter->zero_first = !parameters->reality && parameters->n_order == SO3_N_ORDER_ZERO_FIRST;
+
+    if (parameters->reality || iter->zero_first)
+        iter->n = 0;
+    else
+        iter->n = -parameters->N + 1;
+    iter->el = iter->compact ? abs(iter->n) : 0;
+    iter->mmax = MIN(iter->el, iter->M-1);
+    // One step before the first coefficient.
+    iter->m = -iter->mmax - 1;
+    iter->ind = -1;
+}
+
+/*!
+ * Advance a cursor initialised with \link so3_flmn_iter_init \endlink to
+ * the next coefficient.
+ *
+ * \param[in,out] iter Cursor.
+ * \retval true if the cursor points to a coefficient, false once all
+ *         coefficients have been visited.
+ */
+bool so3_flmn_iter_next(so3_flmn_iter_t *iter)
+{
+    if (iter->ind + 1 >= iter->size)
+        return false;
+    iter->ind++;
+
+    if (iter->m < iter->mmax)
+    {
+        iter->m++;
+        return true;
+    }
+
+    if (iter->el < iter->L-1)
+    {
+        iter->el++;
+        if (iter->mmax < iter->M-1)
+            iter->mmax++;
+        iter->m = -iter->mmax;
+        return true;
+    }
+
+    // Start of the next flm-block.
+    if (iter->zero_first)
+        iter->n = (iter->n >= 0) ? -iter->n - 1 : -iter->n;
+    else
+        iter->n++;
+    iter->el = iter->compact ? abs(iter->n) : 0;
+    iter->mmax = MIN(iter->el, iter->M-1);
+    iter->m = -iter->mmax;
+    return true;
+}
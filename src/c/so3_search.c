@@ -0,0 +1,318 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_search.c
+ * Coarse-to-fine search for the rotation that best matches two signals on the
+ * sphere.
+ *
+ * The correlation of f and g on the sphere as a function of the rotation is
+ * the S2 to SO(3) convolution of \link so3_conv_s2toso3_harmonic_convolution
+ * \endlink, h(alpha, beta, gamma) = sum_lmn flm conj(gln) conj(D^l_mn). It is
+ * sampled on the full grid only at a coarse band-limit, by truncating flm and
+ * glm, and its largest local maxima are kept as candidates. The band-limit is
+ * then doubled up to L, and at each level every candidate climbs to the
+ * largest value of h among its neighbours at a step of about one sample of
+ * that level, halving the step whenever it does not move. At these few
+ * rotations h is evaluated directly, with the recursion in el of the Wigner
+ * d-functions at fixed (m, n) run over all of them at once.
+ *
+ * A full-grid transform at band-limit L costs O(L^4) or O(L^3 N) operations,
+ * while a direct evaluation costs O(L^2 N) per rotation, of which there are
+ * 27 per candidate and step. Unless L is very large or many candidates are
+ * kept, the search therefore costs about as much as the coarse transform.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "so3/so3_conv.h"
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_grid.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_search.h"
+#include "so3/so3_types.h"
+#include "so3/so3_wigner.h"
+
+#include "so3_omp.h"
+
+#define MIN(a, b) ((a < b) ? (a) : (b))
+#define MAX(a, b) ((a > b) ? (a) : (b))
+
+// Steps of the climb at intermediate levels and at the final level.
+#define SO3_SEARCH_ROUNDS 3
+#define SO3_SEARCH_FINAL_ROUNDS 16
+
+// Neighbours of a rotation, including itself, in a 3x3x3 stencil.
+#define SO3_SEARCH_STENCIL 27
+#define SO3_SEARCH_CENTRE 13
+
+// Parameters of the correlation at band-limit L.
+static so3_parameters_t
+so3_search_level_parameters(const so3_parameters_t *parameters, int L) {
+  so3_parameters_t level = *parameters;
+  level.L0 = 0;
+  level.L = L;
+  level.N = MIN(parameters->N, L);
+  level.M = 0;
+  level.reality = 0;
+  level.steerable = 0;
+  level.storage = SO3_STORAGE_PADDED;
+  level.n_order = SO3_N_ORDER_NEGATIVE_FIRST;
+  level.n_mode = SO3_N_MODE_ALL;
+  return level;
+}
+
+// Insert a candidate into a list of at most capacity entries, sorted by
+// decreasing score.
+static void so3_search_insert(
+    so3_search_candidate_t *list, int *count, int capacity,
+    const so3_search_candidate_t *candidate) {
+  int i = *count < capacity ? (*count)++ : capacity;
+  if (i == capacity && candidate->score <= list[capacity - 1].score)
+    return;
+  if (i == capacity)
+    --i;
+  for (; i > 0 && list[i - 1].score < candidate->score; --i)
+    list[i] = list[i - 1];
+  list[i] = *candidate;
+}
+
+// Sort candidates by decreasing score, and drop those within the given angle
+// of a better one.
+static int so3_search_sort(so3_search_candidate_t *list, int count, double angle) {
+  so3_search_candidate_t *sorted = malloc(count * sizeof *sorted);
+  double *quaternions = malloc(4 * count * sizeof *quaternions);
+  const double threshold = cos(0.5 * angle);
+  int i, j, nsorted = 0, nkept = 0;
+  SO3_ERROR_MEM_ALLOC_CHECK(sorted);
+  SO3_ERROR_MEM_ALLOC_CHECK(quaternions);
+
+  for (i = 0; i < count; ++i)
+    so3_search_insert(sorted, &nsorted, count, list + i);
+  for (i = 0; i < count; ++i) {
+    double *q = quaternions + 4 * nkept;
+    so3_grid_euler_to_quaternion(
+        q, &sorted[i].alpha, &sorted[i].beta, &sorted[i].gamma, 1);
+    for (j = 0; j < nkept; ++j) {
+      const double *p = quaternions + 4 * j;
+      if (fabs(p[0] * q[0] + p[1] * q[1] + p[2] * q[2] + p[3] * q[3]) > threshold)
+        break;
+    }
+    if (j == nkept)
+      list[nkept++] = sorted[i];
+  }
+
+  free(sorted);
+  free(quaternions);
+  return nkept;
+}
+
+// Largest local maxima of the real part of the correlation on the full grid
+// at the band-limit of level.
+static int so3_search_coarse(
+    so3_search_candidate_t *candidates, int ncandidates, const complex double *flm,
+    const complex double *glm, const so3_parameters_t *level) {
+  const int nalpha = so3_sampling_nalpha(level);
+  const int nbeta = so3_sampling_nbeta(level);
+  const int ngamma = so3_sampling_ngamma(level);
+  complex double *hlmn = malloc(so3_sampling_flmn_size(level) * sizeof *hlmn);
+  complex double *h = malloc(so3_sampling_f_size(level) * sizeof *h);
+  int a, b, g, count = 0;
+  SO3_ERROR_MEM_ALLOC_CHECK(hlmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(h);
+
+  so3_conv_s2toso3_harmonic_convolution(hlmn, level, flm, glm);
+  so3_core_inverse_auto(h, hlmn, level);
+
+#define SO3_SEARCH_H(a, b, g) creal(h[(a) + nalpha * ((b) + nbeta * (g))])
+  for (g = 0; g < ngamma; ++g)
+    for (b = 0; b < nbeta; ++b)
+      for (a = 0; a < nalpha; ++a) {
+        const double value = SO3_SEARCH_H(a, b, g);
+        so3_search_candidate_t candidate;
+        if (value < SO3_SEARCH_H((a + 1) % nalpha, b, g) ||
+            value < SO3_SEARCH_H((a + nalpha - 1) % nalpha, b, g) ||
+            value < SO3_SEARCH_H(a, b, (g + 1) % ngamma) ||
+            value < SO3_SEARCH_H(a, b, (g + ngamma - 1) % ngamma) ||
+            (b > 0 && value < SO3_SEARCH_H(a, b - 1, g)) ||
+            (b < nbeta - 1 && value < SO3_SEARCH_H(a, b + 1, g)))
+          continue;
+        candidate.alpha = so3_sampling_a2alpha(a, level);
+        candidate.beta = so3_sampling_b2beta(b, level);
+        candidate.gamma = so3_sampling_g2gamma(g, level);
+        candidate.score = value;
+        so3_search_insert(candidates, &count, ncandidates, &candidate);
+      }
+#undef SO3_SEARCH_H
+
+  free(hlmn);
+  free(h);
+  return count;
+}
+
+// Real part of the correlation with band-limits (L, N) at a set of rotations,
+// summed over (m, n) with the recursion in el run over all rotations at once.
+static void so3_search_evaluate(
+    double *scores, const double *alphas, const double *betas, const double *gammas,
+    int count, const complex double *flm, const complex double *glm, int L, int N) {
+  int m;
+
+  memset(scores, 0, count * sizeof *scores);
+  SO3_PRAGMA(omp parallel if (count * L >= 4096)) {
+    double *partial = calloc(count, sizeof *partial);
+    complex double *sum = malloc(count * sizeof *sum);
+    SO3_ERROR_MEM_ALLOC_CHECK(partial);
+    SO3_ERROR_MEM_ALLOC_CHECK(sum);
+
+    SO3_PRAGMA(omp for schedule(dynamic))
+    for (m = -L + 1; m < L; ++m) {
+      int n;
+      for (n = -N + 1; n < N; ++n) {
+        so3_wigner_d_recursion_t recursion;
+        int k;
+        if (abs(n) >= L)
+          continue;
+        memset(sum, 0, count * sizeof *sum);
+        so3_wigner_d_recursion_init(&recursion, m, n, betas, count);
+        while (1) {
+          const int el = recursion.el;
+          const complex double c =
+              flm[el * el + el + m] * conj(glm[el * el + el + n]);
+          for (k = 0; k < count; ++k)
+            sum[k] += c * recursion.d[k];
+          if (el == L - 1)
+            break;
+          so3_wigner_d_recursion_next(&recursion);
+        }
+        so3_wigner_d_recursion_free(&recursion);
+        for (k = 0; k < count; ++k) {
+          const double phase = m * alphas[k] + n * gammas[k];
+          partial[k] += creal(sum[k]) * cos(phase) - cimag(sum[k]) * sin(phase);
+        }
+      }
+    }
+
+    SO3_PRAGMA(omp critical) {
+      int i;
+      for (i = 0; i < count; ++i)
+        scores[i] += partial[i];
+    }
+    free(partial);
+    free(sum);
+  }
+}
+
+// Let every candidate climb to the largest correlation among its neighbours
+// at band-limits (L, N), starting at a step of one sample.
+static void so3_search_refine(
+    so3_search_candidate_t *candidates, int count, const complex double *flm,
+    const complex double *glm, int L, int N, int rounds) {
+  const int npoints = SO3_SEARCH_STENCIL * count;
+  double *steps = malloc(count * sizeof *steps);
+  double *alphas = malloc(npoints * sizeof *alphas);
+  double *betas = malloc(npoints * sizeof *betas);
+  double *gammas = malloc(npoints * sizeof *gammas);
+  double *scores = malloc(npoints * sizeof *scores);
+  int i, j, round;
+  SO3_ERROR_MEM_ALLOC_CHECK(steps);
+  SO3_ERROR_MEM_ALLOC_CHECK(alphas);
+  SO3_ERROR_MEM_ALLOC_CHECK(betas);
+  SO3_ERROR_MEM_ALLOC_CHECK(gammas);
+  SO3_ERROR_MEM_ALLOC_CHECK(scores);
+
+  for (i = 0; i < count; ++i)
+    steps[i] = SO3_PI / L;
+  for (round = 0; round < rounds; ++round) {
+    for (i = 0; i < count; ++i)
+      for (j = 0; j < SO3_SEARCH_STENCIL; ++j) {
+        const int p = SO3_SEARCH_STENCIL * i + j;
+        const double beta = candidates[i].beta + (j / 3 % 3 - 1) * steps[i];
+        alphas[p] = candidates[i].alpha + (j % 3 - 1) * steps[i];
+        betas[p] = beta < 0.0 ? 0.0 : (beta > SO3_PI ? SO3_PI : beta);
+        gammas[p] = candidates[i].gamma + (j / 9 - 1) * steps[i];
+      }
+    so3_search_evaluate(scores, alphas, betas, gammas, npoints, flm, glm, L, N);
+    for (i = 0; i < count; ++i) {
+      const int offset = SO3_SEARCH_STENCIL * i;
+      int best = SO3_SEARCH_CENTRE;
+      for (j = 0; j < SO3_SEARCH_STENCIL; ++j)
+        if (scores[offset + j] > scores[offset + best])
+          best = j;
+      if (best == SO3_SEARCH_CENTRE)
+        steps[i] *= 0.5;
+      candidates[i].alpha = alphas[offset + best];
+      candidates[i].beta = betas[offset + best];
+      candidates[i].gamma = gammas[offset + best];
+      candidates[i].score = scores[offset + best];
+    }
+  }
+
+  free(steps);
+  free(alphas);
+  free(betas);
+  free(gammas);
+  free(scores);
+}
+
+/*!
+ * Find the rotations that maximise the correlation of two signals on the
+ * sphere, coarse to fine.
+ *
+ * \param[out] candidates Best rotations found, sorted by decreasing score, with
+ *                        alpha and gamma in [0, 2*pi). Rotations closer than
+ *                        about one sample at band-limit L to a better one are
+ *                        dropped.
+ * \param[in] ncandidates Maximum number of rotations to return, which is also
+ *                        the number of candidates carried between levels.
+ * \param[in] flm Harmonic coefficients of the signal, in the layout of SSHT,
+ *                i.e. of size L*L and indexed by el*el + el + m.
+ * \param[in] glm Harmonic coefficients of the pattern, as flm.
+ * \param[in] L_coarse Band-limit of the full-grid correlation of the coarsest
+ *                     level, or 0 for max(L/8, 4). The band-limit is doubled
+ *                     from there up to L.
+ * \param[in] parameters A parameters object with (at least) the following
+ *                       fields: L and N, the band-limits of the correlation,
+ *                       and the sampling scheme and dl_method of the coarse
+ *                       transform.
+ * \retval count Number of rotations written to candidates.
+ */
+int so3_search(
+    so3_search_candidate_t *candidates, int ncandidates, const complex double *flm,
+    const complex double *glm, int L_coarse, const so3_parameters_t *parameters) {
+  const int L = parameters->L;
+  so3_parameters_t level;
+  int count, el, i;
+
+  if (ncandidates < 1)
+    SO3_ERROR_GENERIC("At least one candidate must be kept.");
+  if (L_coarse <= 0)
+    L_coarse = MAX(L / 8, MIN(L, 4));
+  L_coarse = MIN(L_coarse, L);
+
+  level = so3_search_level_parameters(parameters, L_coarse);
+  count = so3_search_coarse(candidates, ncandidates, flm, glm, &level);
+  for (el = L_coarse; el < L;) {
+    el = MIN(2 * el, L);
+    level = so3_search_level_parameters(parameters, el);
+    so3_search_refine(
+        candidates, count, flm, glm, el, level.N,
+        el == L ? SO3_SEARCH_FINAL_ROUNDS : SO3_SEARCH_ROUNDS);
+    count = so3_search_sort(candidates, count, SO3_PI / el);
+  }
+  if (L_coarse == L) {
+    so3_search_refine(
+        candidates, count, flm, glm, L, level.N, SO3_SEARCH_FINAL_ROUNDS);
+    count = so3_search_sort(candidates, count, SO3_PI / L);
+  }
+
+  for (i = 0; i < count; ++i) {
+    candidates[i].alpha -= 2.0 * SO3_PI * floor(candidates[i].alpha / (2.0 * SO3_PI));
+    candidates[i].gamma -= 2.0 * SO3_PI * floor(candidates[i].gamma / (2.0 * SO3_PI));
+  }
+  return count;
+}
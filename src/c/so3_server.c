@@ -0,0 +1,623 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_server.c
+ * Transform server shared by all so3 consumers on one machine.
+ *
+ * The server listens on a Unix domain socket. One thread per connection
+ * receives requests (see so3_client.c), maps the shared-memory buffer that
+ * comes with each of them and queues a job. Worker threads take the oldest
+ * job together with every other queued job of the same operation and
+ * parameters, and run them as one batch:
+ *
+ * - Transforms with L <= SO3_SMALL_L_MAX use the small band-limit engine.
+ *   Its plans are cached for the lifetime of the server, and the signals of
+ *   all gathered jobs are transformed by one set of matrix products.
+ * - Larger transforms use the algorithm chosen by \link so3_tune_select
+ *   \endlink, whose decisions also stay in memory.
+ *
+ * FFTW planning is not thread-safe. Unless the server is built against
+ * fftw3_threads (SO3_SERVER_FFTW_THREADS), which makes the planner
+ * thread-safe, everything that may plan an FFT runs under one engine lock,
+ * and only the small band-limit products run concurrently.
+ */
+
+#include <complex.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef SO3_SERVER_FFTW_THREADS
+#include <fftw3.h>
+#endif
+
+#include "so3/so3_conv.h"
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_server.h"
+#include "so3/so3_small.h"
+#include "so3/so3_tune.h"
+#include "so3/so3_types.h"
+
+// Report a closed peer as an error rather than raising SIGPIPE.
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+typedef struct so3_server_job {
+  so3_server_request_t request;
+  char *data;
+  so3_server_status_t status;
+  int done;
+  struct so3_server_job *next;
+} so3_server_job_t;
+
+// Small band-limit plans are not modified by the transforms, so workers
+// share them.
+typedef struct {
+  so3_parameters_t parameters;
+  so3_small_plan_t *plan;
+} so3_server_plan_t;
+
+struct so3_server {
+  char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+  int listen_fd;
+  // Written to by so3_server_stop to wake the accept loop.
+  int wake[2];
+  int planner_thread_safe;
+  int stopping;
+  pthread_t accept_thread;
+  pthread_t *workers;
+  int nworkers;
+
+  // Protects the queue, the connections and the stopping flag.
+  pthread_mutex_t lock;
+  pthread_cond_t queued, finished;
+  so3_server_job_t *head, *tail;
+  int *connections;
+  int nconnections, connections_size;
+
+  pthread_mutex_t engine_lock, tune_lock, plans_lock;
+  so3_server_plan_t **plans;
+  int nplans;
+};
+
+typedef struct {
+  so3_server_t *server;
+  int fd;
+} so3_server_connection_t;
+
+static int
+so3_server_same_parameters(const so3_parameters_t *a, const so3_parameters_t *b) {
+  return a->reality == b->reality && a->L0 == b->L0 && a->L == b->L && a->N == b->N &&
+         so3_sampling_mlim(a) == so3_sampling_mlim(b) &&
+         a->sampling_scheme == b->sampling_scheme && a->n_order == b->n_order &&
+         a->storage == b->storage && a->n_mode == b->n_mode &&
+         a->dl_method == b->dl_method && a->steerable == b->steerable &&
+         a->dl_tolerance == b->dl_tolerance;
+}
+
+static int
+so3_server_same_job(const so3_server_request_t *a, const so3_server_request_t *b) {
+  return a->op == b->op && so3_server_same_parameters(&a->parameters, &b->parameters) &&
+         (a->op != SO3_SERVER_HARMONIC_CONVOLUTION ||
+          so3_server_same_parameters(&a->g_parameters, &b->g_parameters));
+}
+
+static void so3_server_engine_lock(so3_server_t *server) {
+  if (!server->planner_thread_safe)
+    pthread_mutex_lock(&server->engine_lock);
+}
+
+static void so3_server_engine_unlock(so3_server_t *server) {
+  if (!server->planner_thread_safe)
+    pthread_mutex_unlock(&server->engine_lock);
+}
+
+// Cached small band-limit plan, built on first use.
+static so3_server_plan_t *
+so3_server_small_plan(so3_server_t *server, const so3_parameters_t *parameters) {
+  so3_server_plan_t *plan = NULL;
+  int i;
+
+  pthread_mutex_lock(&server->plans_lock);
+  for (i = 0; i < server->nplans && !plan; ++i)
+    if (so3_server_same_parameters(&server->plans[i]->parameters, parameters))
+      plan = server->plans[i];
+  if (!plan) {
+    plan = malloc(sizeof *plan);
+    SO3_ERROR_MEM_ALLOC_CHECK(plan);
+    plan->parameters = *parameters;
+    so3_server_engine_lock(server);
+    plan->plan = so3_small_plan_init(parameters);
+    so3_server_engine_unlock(server);
+    server->plans =
+        realloc(server->plans, (server->nplans + 1) * sizeof *server->plans);
+    SO3_ERROR_MEM_ALLOC_CHECK(server->plans);
+    server->plans[server->nplans] = plan;
+    ++server->nplans;
+  }
+  pthread_mutex_unlock(&server->plans_lock);
+  return plan;
+}
+
+// Run the gathered jobs, which all have the same operation and parameters,
+// with the small band-limit engine.
+static void so3_server_run_small(
+    so3_server_t *server, so3_server_job_t **jobs, int njobs,
+    const so3_parameters_t *parameters) {
+  const so3_server_request_t *request = &jobs[0]->request;
+  const size_t in_size = so3_server_in_size(request) / request->batch;
+  const size_t out_size = so3_server_out_size(request) / request->batch;
+  so3_server_plan_t *plan = so3_server_small_plan(server, parameters);
+  char *in, *out;
+  int batch = 0, j;
+
+  if (njobs == 1) {
+    in = jobs[0]->data + request->in_offset;
+    out = jobs[0]->data + request->out_offset;
+    batch = request->batch;
+  } else {
+    for (j = 0; j < njobs; ++j)
+      batch += jobs[j]->request.batch;
+    in = malloc(in_size * batch);
+    out = malloc(out_size * batch);
+    SO3_ERROR_MEM_ALLOC_CHECK(in);
+    SO3_ERROR_MEM_ALLOC_CHECK(out);
+    for (batch = 0, j = 0; j < njobs; batch += jobs[j]->request.batch, ++j)
+      memcpy(
+          in + in_size * batch, jobs[j]->data + jobs[j]->request.in_offset,
+          in_size * jobs[j]->request.batch);
+  }
+
+  switch (request->op) {
+  case SO3_SERVER_INVERSE:
+    so3_small_inverse((complex double *)out, (complex double *)in, batch, plan->plan);
+    break;
+  case SO3_SERVER_INVERSE_REAL:
+    so3_small_inverse_real((double *)out, (complex double *)in, batch, plan->plan);
+    break;
+  case SO3_SERVER_FORWARD:
+    so3_small_forward((complex double *)out, (complex double *)in, batch, plan->plan);
+    break;
+  case SO3_SERVER_FORWARD_REAL:
+    so3_small_forward_real((complex double *)out, (double *)in, batch, plan->plan);
+    break;
+  default:
+    break;
+  }
+
+  if (njobs > 1) {
+    for (batch = 0, j = 0; j < njobs; batch += jobs[j]->request.batch, ++j)
+      memcpy(
+          jobs[j]->data + jobs[j]->request.out_offset, out + out_size * batch,
+          out_size * jobs[j]->request.batch);
+    free(in);
+    free(out);
+  }
+}
+
+// Run one signal of a job with the tuned algorithm or the convolution.
+static void so3_server_run_one(
+    so3_server_t *server, const so3_server_request_t *request, char *out,
+    const char *in, so3_parameters_t *parameters, so3_tune_choice_t choice) {
+  int via_ssht = choice.method == SO3_TUNE_METHOD_VIA_SSHT;
+  parameters->dl_method = choice.dl_method;
+
+  so3_server_engine_lock(server);
+  switch (request->op) {
+  case SO3_SERVER_INVERSE:
+    if (via_ssht)
+      so3_core_inverse_via_ssht(
+          (complex double *)out, (const complex double *)in, parameters);
+    else
+      so3_core_inverse_direct((complex double *)out, (const complex double *)in, parameters);
+    break;
+  case SO3_SERVER_INVERSE_REAL:
+    if (via_ssht)
+      so3_core_inverse_via_ssht_real((double *)out, (const complex double *)in, parameters);
+    else
+      so3_core_inverse_direct_real((double *)out, (const complex double *)in, parameters);
+    break;
+  case SO3_SERVER_FORWARD:
+    if (via_ssht)
+      so3_core_forward_via_ssht(
+          (complex double *)out, (const complex double *)in, parameters);
+    else
+      so3_core_forward_direct((complex double *)out, (const complex double *)in, parameters);
+    break;
+  case SO3_SERVER_FORWARD_REAL:
+    if (via_ssht)
+      so3_core_forward_via_ssht_real((complex double *)out, (const double *)in, parameters);
+    else
+      so3_core_forward_direct_real((complex double *)out, (const double *)in, parameters);
+    break;
+  default:
+    break;
+  }
+  so3_server_engine_unlock(server);
+}
+
+static void so3_server_run_convolution(const so3_server_job_t *job, size_t in_size, size_t out_size) {
+  const so3_server_request_t *request = &job->request;
+  so3_parameters_t h_parameters =
+      so3_conv_get_parameters_of_convolved_lmn(&request->parameters, &request->g_parameters);
+  size_t f_size =
+      (size_t)so3_sampling_flmn_size(&request->parameters) * sizeof(complex double);
+  int k;
+
+  for (k = 0; k < request->batch; ++k) {
+    const char *in = job->data + request->in_offset + in_size * k;
+    so3_conv_harmonic_convolution(
+        (complex double *)(job->data + request->out_offset + out_size * k), &h_parameters,
+        (const complex double *)in, &request->parameters,
+        (const complex double *)(in + f_size), &request->g_parameters);
+  }
+}
+
+// Run the gathered jobs, which all have the same operation and parameters,
+// and return their status.
+static so3_server_status_t
+so3_server_run(so3_server_t *server, so3_server_job_t **jobs, int njobs) {
+  const so3_server_request_t *request = &jobs[0]->request;
+  so3_parameters_t parameters = request->parameters;
+  int j, k;
+
+  // Jobs are checked before they are queued, but an invalid one must never
+  // reach the transforms, whose errors stop the server.
+  if (so3_server_check_request(request) != SO3_SERVER_OK)
+    return SO3_SERVER_EINVAL;
+  const size_t in_size = so3_server_in_size(request) / request->batch;
+  const size_t out_size = so3_server_out_size(request) / request->batch;
+
+  parameters.verbosity = 0;
+  if (request->op == SO3_SERVER_HARMONIC_CONVOLUTION) {
+    for (j = 0; j < njobs; ++j)
+      so3_server_run_convolution(jobs[j], in_size, out_size);
+    return SO3_SERVER_OK;
+  }
+
+  parameters.reality =
+      request->op == SO3_SERVER_INVERSE_REAL || request->op == SO3_SERVER_FORWARD_REAL;
+  if (!parameters.steerable && parameters.L <= SO3_SMALL_L_MAX) {
+    so3_server_run_small(server, jobs, njobs, &parameters);
+    return SO3_SERVER_OK;
+  }
+
+  // Tuning benchmarks the candidates the first time, which plans FFTs.
+  pthread_mutex_lock(&server->tune_lock);
+  so3_server_engine_lock(server);
+  so3_tune_choice_t choice = so3_tune_select(
+      &parameters, request->op == SO3_SERVER_INVERSE || request->op == SO3_SERVER_INVERSE_REAL
+                       ? SO3_TUNE_INVERSE
+                       : SO3_TUNE_FORWARD);
+  so3_server_engine_unlock(server);
+  pthread_mutex_unlock(&server->tune_lock);
+
+  for (j = 0; j < njobs; ++j)
+    for (k = 0; k < jobs[j]->request.batch; ++k)
+      so3_server_run_one(
+          server, request, jobs[j]->data + jobs[j]->request.out_offset + out_size * k,
+          jobs[j]->data + jobs[j]->request.in_offset + in_size * k, &parameters,
+          choice);
+  return SO3_SERVER_OK;
+}
+
+static void *so3_server_worker(void *arg) {
+  so3_server_t *server = arg;
+  so3_server_job_t *jobs[SO3_SERVER_MAX_BATCH];
+  so3_server_job_t **link;
+  so3_server_status_t status;
+  int njobs, j;
+
+  pthread_mutex_lock(&server->lock);
+  for (;;) {
+    while (!server->head && !server->stopping)
+      pthread_cond_wait(&server->queued, &server->lock);
+    if (!server->head)
+      break;
+
+    // Gather the oldest job and every queued job identical to it.
+    jobs[0] = server->head;
+    server->head = jobs[0]->next;
+    njobs = 1;
+    for (link = &server->head; *link && njobs < SO3_SERVER_MAX_BATCH;) {
+      if (so3_server_same_job(&(*link)->request, &jobs[0]->request)) {
+        jobs[njobs++] = *link;
+        *link = (*link)->next;
+      } else {
+        link = &(*link)->next;
+      }
+    }
+    for (server->tail = NULL, link = &server->head; *link; link = &(*link)->next)
+      server->tail = *link;
+    pthread_mutex_unlock(&server->lock);
+
+    status = so3_server_run(server, jobs, njobs);
+
+    pthread_mutex_lock(&server->lock);
+    for (j = 0; j < njobs; ++j) {
+      jobs[j]->status = status;
+      jobs[j]->done = 1;
+    }
+    pthread_cond_broadcast(&server->finished);
+  }
+  pthread_mutex_unlock(&server->lock);
+  return NULL;
+}
+
+// Receive one request and the file descriptor sent with it. Returns 0 at the
+// end of the connection.
+static int so3_server_receive(int fd, so3_server_request_t *request, int *shm_fd) {
+  char control[CMSG_SPACE(sizeof(int))];
+  struct iovec iov;
+  struct msghdr msg;
+  struct cmsghdr *cmsg;
+  size_t done;
+  ssize_t count;
+
+  *shm_fd = -1;
+  memset(&msg, 0, sizeof msg);
+  iov.iov_base = request;
+  iov.iov_len = sizeof *request;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof control;
+  do
+    count = recvmsg(fd, &msg, 0);
+  while (count < 0 && errno == EINTR);
+  if (count <= 0)
+    return 0;
+  for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+      memcpy(shm_fd, CMSG_DATA(cmsg), sizeof(int));
+
+  for (done = count; done < sizeof *request; done += count) {
+    count = recv(fd, (char *)request + done, sizeof *request - done, 0);
+    if (count < 0 && errno == EINTR)
+      count = 0;
+    else if (count <= 0) {
+      if (*shm_fd >= 0)
+        close(*shm_fd);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// Check the request and its buffer, and map it.
+static so3_server_status_t
+so3_server_map(const so3_server_request_t *request, int shm_fd, char **data) {
+  struct stat st;
+
+  if (request->magic != SO3_SERVER_MAGIC ||
+      so3_server_check_request(request) != SO3_SERVER_OK)
+    return SO3_SERVER_EINVAL;
+
+  size_t in_size = so3_server_in_size(request);
+  size_t out_size = so3_server_out_size(request);
+  if (request->in_offset > request->shm_size ||
+      in_size > request->shm_size - request->in_offset ||
+      request->out_offset > request->shm_size ||
+      out_size > request->shm_size - request->out_offset)
+    return SO3_SERVER_EINVAL;
+  if (shm_fd < 0)
+    return SO3_SERVER_ESHM;
+  // Pages past the end of the file would fault in the workers.
+  if (fstat(shm_fd, &st) != 0 || st.st_size < 0 ||
+      (uint64_t)st.st_size < request->shm_size)
+    return SO3_SERVER_ESHM;
+  *data = mmap(NULL, request->shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+  return *data == MAP_FAILED ? SO3_SERVER_ESHM : SO3_SERVER_OK;
+}
+
+static void *so3_server_connection(void *arg) {
+  so3_server_connection_t connection = *(so3_server_connection_t *)arg;
+  so3_server_t *server = connection.server;
+  so3_server_job_t job;
+  so3_server_response_t response;
+  int shm_fd, i;
+  free(arg);
+
+  while (so3_server_receive(connection.fd, &job.request, &shm_fd)) {
+    response.status = so3_server_map(&job.request, shm_fd, &job.data);
+    if (shm_fd >= 0)
+      close(shm_fd);
+
+    if (response.status == SO3_SERVER_OK) {
+      job.done = 0;
+      job.next = NULL;
+      pthread_mutex_lock(&server->lock);
+      if (server->tail)
+        server->tail->next = &job;
+      else
+        server->head = &job;
+      server->tail = &job;
+      pthread_cond_signal(&server->queued);
+      while (!job.done)
+        pthread_cond_wait(&server->finished, &server->lock);
+      pthread_mutex_unlock(&server->lock);
+      response.status = job.status;
+      munmap(job.data, job.request.shm_size);
+    }
+
+    if (send(connection.fd, &response, sizeof response, MSG_NOSIGNAL) !=
+        sizeof response)
+      break;
+  }
+
+  pthread_mutex_lock(&server->lock);
+  for (i = 0; i < server->nconnections; ++i)
+    if (server->connections[i] == connection.fd)
+      server->connections[i] = server->connections[--server->nconnections];
+  close(connection.fd);
+  pthread_cond_broadcast(&server->finished);
+  pthread_mutex_unlock(&server->lock);
+  return NULL;
+}
+
+static void *so3_server_accept(void *arg) {
+  so3_server_t *server = arg;
+  struct pollfd fds[2];
+  pthread_t thread;
+
+  fds[0].fd = server->listen_fd;
+  fds[0].events = POLLIN;
+  fds[1].fd = server->wake[0];
+  fds[1].events = POLLIN;
+  for (;;) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    if (fds[1].revents)
+      break;
+    int fd = accept(server->listen_fd, NULL, NULL);
+    if (fd < 0)
+      continue;
+
+    pthread_mutex_lock(&server->lock);
+    if (server->nconnections == server->connections_size) {
+      server->connections_size = 2 * server->connections_size + 4;
+      server->connections = realloc(
+          server->connections, server->connections_size * sizeof *server->connections);
+      SO3_ERROR_MEM_ALLOC_CHECK(server->connections);
+    }
+    server->connections[server->nconnections++] = fd;
+    pthread_mutex_unlock(&server->lock);
+
+    so3_server_connection_t *connection = malloc(sizeof *connection);
+    SO3_ERROR_MEM_ALLOC_CHECK(connection);
+    connection->server = server;
+    connection->fd = fd;
+    if (pthread_create(&thread, NULL, so3_server_connection, connection) == 0) {
+      pthread_detach(thread);
+    } else {
+      free(connection);
+      pthread_mutex_lock(&server->lock);
+      --server->nconnections;
+      pthread_mutex_unlock(&server->lock);
+      close(fd);
+    }
+  }
+  return NULL;
+}
+
+/*!
+ * Start a transform server in background threads of the calling process.
+ *
+ * \param[in] path Path of the socket to listen on, or NULL for
+ *                 \link so3_server_default_path \endlink. A stale socket
+ *                 file at this path is replaced.
+ * \param[in] nworkers Number of worker threads, at least 1.
+ * \retval server Running server, or NULL if the socket could not be
+ *                created. Stop it with \link so3_server_stop \endlink.
+ */
+so3_server_t *so3_server_start(const char *path, int nworkers) {
+  struct sockaddr_un address;
+  int i;
+
+  so3_server_t *server = calloc(1, sizeof *server);
+  SO3_ERROR_MEM_ALLOC_CHECK(server);
+  if (path)
+    snprintf(server->path, sizeof server->path, "%s", path);
+  else
+    so3_server_default_path(server->path, sizeof server->path);
+
+  memset(&address, 0, sizeof address);
+  address.sun_family = AF_UNIX;
+  memcpy(address.sun_path, server->path, sizeof server->path);
+  unlink(server->path);
+  server->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (server->listen_fd < 0 ||
+      bind(server->listen_fd, (struct sockaddr *)&address, sizeof address) != 0 ||
+      listen(server->listen_fd, 64) != 0 || pipe(server->wake) != 0) {
+    if (server->listen_fd >= 0)
+      close(server->listen_fd);
+    free(server);
+    return NULL;
+  }
+
+#ifdef SO3_SERVER_FFTW_THREADS
+  fftw_make_planner_thread_safe();
+  server->planner_thread_safe = 1;
+#endif
+
+  pthread_mutex_init(&server->lock, NULL);
+  pthread_cond_init(&server->queued, NULL);
+  pthread_cond_init(&server->finished, NULL);
+  pthread_mutex_init(&server->engine_lock, NULL);
+  pthread_mutex_init(&server->tune_lock, NULL);
+  pthread_mutex_init(&server->plans_lock, NULL);
+
+  server->nworkers = nworkers > 0 ? nworkers : 1;
+  server->workers = malloc(server->nworkers * sizeof *server->workers);
+  SO3_ERROR_MEM_ALLOC_CHECK(server->workers);
+  for (i = 0; i < server->nworkers; ++i)
+    if (pthread_create(&server->workers[i], NULL, so3_server_worker, server) != 0)
+      SO3_ERROR_GENERIC("Failed to start so3 server worker");
+  if (pthread_create(&server->accept_thread, NULL, so3_server_accept, server) != 0)
+    SO3_ERROR_GENERIC("Failed to start so3 server");
+  return server;
+}
+
+/*!
+ * Stop a server started with \link so3_server_start \endlink.
+ *
+ * Closes all connections, waits for queued requests to complete and
+ * removes the socket file.
+ *
+ * \param[in] server Server.
+ * \retval none
+ */
+void so3_server_stop(so3_server_t *server) {
+  int i;
+
+  if (write(server->wake[1], "", 1) != 1)
+    SO3_ERROR_GENERIC("Failed to stop so3 server");
+  pthread_join(server->accept_thread, NULL);
+  close(server->listen_fd);
+  unlink(server->path);
+
+  // Connections finish their current request before they see the shutdown.
+  pthread_mutex_lock(&server->lock);
+  for (i = 0; i < server->nconnections; ++i)
+    shutdown(server->connections[i], SHUT_RDWR);
+  while (server->nconnections > 0)
+    pthread_cond_wait(&server->finished, &server->lock);
+  server->stopping = 1;
+  pthread_cond_broadcast(&server->queued);
+  pthread_mutex_unlock(&server->lock);
+  for (i = 0; i < server->nworkers; ++i)
+    pthread_join(server->workers[i], NULL);
+
+  for (i = 0; i < server->nplans; ++i) {
+    so3_small_plan_free(server->plans[i]->plan);
+    free(server->plans[i]);
+  }
+  pthread_mutex_destroy(&server->lock);
+  pthread_cond_destroy(&server->queued);
+  pthread_cond_destroy(&server->finished);
+  pthread_mutex_destroy(&server->engine_lock);
+  pthread_mutex_destroy(&server->tune_lock);
+  pthread_mutex_destroy(&server->plans_lock);
+  close(server->wake[0]);
+  close(server->wake[1]);
+  free(server->plans);
+  free(server->connections);
+  free(server->workers);
+  free(server);
+}
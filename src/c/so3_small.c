@@ -0,0 +1,580 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_small.c
+ * Dense-matrix Wigner transforms for batches of signals at small band-limits.
+ *
+ * For small L, the cost of the direct transforms is dominated by FFTW
+ * planning, the Wigner recursions and memory management rather than by
+ * arithmetic. A plan instead precomputes, for every beta sample, the Wigner
+ * matrix of the inverse transform and the quadrature matrix of the forward
+ * transform, together with the Fourier matrices in alpha and gamma. The
+ * transforms are then plain dense matrix products, in which the batch index
+ * is the fastest-varying dimension.
+ *
+ * The forward quadrature matrices are obtained by applying the direct forward
+ * transform to a unit impulse on each beta ring, so that they are exact for
+ * both sampling schemes, every n-mode and every storage method.
+ *
+ * A plan is not modified by the transforms, which allocate their
+ * intermediate arrays on every call, so one plan may be used by several
+ * threads at once. Plans shared by the batched transforms of so3_core are
+ * kept in a global cache (see \link so3_small_plan_get \endlink), guarded
+ * by a mutex.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ssht/ssht.h>
+
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_small.h"
+#include "so3/so3_types.h"
+
+struct so3_small_plan {
+  so3_parameters_t parameters;
+  int flmn_size, f_size;
+  int nalpha, nbeta, ngamma;
+  // Number of m (resp. n) values, and offset of n = 0.
+  int nm, nn, n_offset;
+  // Number of non-zero harmonic coefficients.
+  int nterms;
+  // flmn index and (m, n) position of each non-zero coefficient.
+  int *ind, *mn;
+  // Inverse Wigner matrix, (2*el+1)/(8*pi^2) d^el_mn(beta_b), nterms x nbeta.
+  double *P;
+  // Forward quadrature matrix, nterms x nbeta.
+  complex double *Q;
+  // exp(i*m*alpha_a), nalpha x nm, and exp(i*n*gamma_g), ngamma x nn.
+  complex double *ealpha, *egamma;
+};
+
+// Protects small_cache and small_ncache.
+static pthread_mutex_t small_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static so3_small_plan_t **small_cache = NULL;
+static int small_ncache = 0;
+
+/*!
+ * Precompute the matrices of the small band-limit engine.
+ *
+ * \param[in] parameters A fully populated parameters object. The reality
+ *                       flag selects between the complex and real transforms.
+ * \retval plan Plan to pass to the so3_small transforms. Free it with
+ *              \link so3_small_plan_free \endlink.
+ */
+so3_small_plan_t *so3_small_plan_init(const so3_parameters_t *parameters) {
+  int el, m, n, a, b, g, t;
+  int n_start, n_stop, n_inc;
+  int el_start, el_stop, el_inc;
+  int m_start, m_stop, m_inc;
+
+  so3_small_plan_t *plan = calloc(1, sizeof(*plan));
+  SO3_ERROR_MEM_ALLOC_CHECK(plan);
+
+  plan->parameters = *parameters;
+  plan->parameters.verbosity = 0;
+  parameters = &plan->parameters;
+
+  int L = parameters->L;
+  int N = parameters->N;
+  int M = so3_sampling_mlim(parameters);
+  int reality = parameters->reality;
+
+  plan->flmn_size = so3_sampling_flmn_size(parameters);
+  plan->nalpha = so3_sampling_nalpha(parameters);
+  plan->nbeta = so3_sampling_nbeta(parameters);
+  // Like the direct transforms, always use 2*N-1 samples in gamma.
+  plan->ngamma = 2 * N - 1;
+  plan->f_size = plan->nalpha * plan->nbeta * plan->ngamma;
+  plan->nm = 2 * M - 1;
+  plan->nn = reality ? N : 2 * N - 1;
+  plan->n_offset = reality ? 0 : N - 1;
+
+  int nbeta = plan->nbeta;
+
+  // Enumerate the non-zero harmonic coefficients.
+  plan->ind = calloc(plan->flmn_size, sizeof(*plan->ind));
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->ind);
+  plan->mn = calloc(plan->flmn_size, sizeof(*plan->mn));
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->mn);
+  int *els = calloc(plan->flmn_size, sizeof(*els));
+  SO3_ERROR_MEM_ALLOC_CHECK(els);
+
+  t = 0;
+  so3_sampling_n_loop_values(&n_start, &n_stop, &n_inc, parameters);
+  for (n = n_start; n <= n_stop; n += n_inc) {
+    so3_sampling_el_loop_values(&el_start, &el_stop, &el_inc, n, parameters);
+    for (el = el_start; el <= el_stop; el += el_inc) {
+      so3_sampling_m_loop_values(&m_start, &m_stop, &m_inc, el);
+      for (m = m_start; m <= m_stop; m += m_inc) {
+        if (abs(m) >= M)
+          continue;
+        if (reality)
+          so3_sampling_elmn2ind_real(&plan->ind[t], el, m, n, parameters);
+        else
+          so3_sampling_elmn2ind(&plan->ind[t], el, m, n, parameters);
+        plan->mn[t] = m + M - 1 + plan->nm * (n + plan->n_offset);
+        els[t] = el;
+        ++t;
+      }
+    }
+  }
+  plan->nterms = t;
+
+  // Inverse Wigner matrix.
+  plan->P = calloc(plan->nterms * nbeta, sizeof(*plan->P));
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->P);
+  double *sqrt_tbl = calloc(2 * (L - 1) + 2, sizeof(*sqrt_tbl));
+  SO3_ERROR_MEM_ALLOC_CHECK(sqrt_tbl);
+  double *signs = calloc(L + 1, sizeof(*signs));
+  SO3_ERROR_MEM_ALLOC_CHECK(signs);
+  for (el = 0; el <= 2 * (L - 1) + 1; ++el)
+    sqrt_tbl[el] = sqrt((double)el);
+  for (m = 0; m <= L - 1; m += 2) {
+    signs[m] = 1.0;
+    signs[m + 1] = -1.0;
+  }
+  double *dl = ssht_dl_calloc(L, SSHT_DL_FULL);
+  SO3_ERROR_MEM_ALLOC_CHECK(dl);
+  int dl_offset = ssht_dl_get_offset(L, SSHT_DL_FULL);
+  int dl_stride = ssht_dl_get_stride(L, SSHT_DL_FULL);
+  for (b = 0; b < nbeta; ++b) {
+    double beta = so3_sampling_b2beta(b, parameters);
+    // The Risbo recursion has to run through every el in turn.
+    for (el = 0; el < L; ++el) {
+      ssht_dl_beta_risbo_full_table(dl, beta, L, SSHT_DL_FULL, el, sqrt_tbl, signs);
+      double elfactor = (2.0 * el + 1.0) / (8.0 * SO3_PI * SO3_PI);
+      for (t = 0; t < plan->nterms; ++t) {
+        if (els[t] != el)
+          continue;
+        m = plan->mn[t] % plan->nm - (M - 1);
+        n = plan->mn[t] / plan->nm - plan->n_offset;
+        plan->P[b + nbeta * t] =
+            elfactor * dl[(m + dl_offset) * dl_stride + n + dl_offset];
+      }
+    }
+  }
+  free(dl);
+  free(sqrt_tbl);
+  free(signs);
+  free(els);
+
+  // Forward quadrature matrix, from the response of the direct transform to
+  // a unit impulse at (alpha, beta_b, gamma) = (0, beta_b, 0).
+  plan->Q = calloc(plan->nterms * nbeta, sizeof(*plan->Q));
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->Q);
+  complex double *flmn = calloc(plan->flmn_size, sizeof(*flmn));
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  if (reality) {
+    double *f = calloc(plan->f_size, sizeof(*f));
+    SO3_ERROR_MEM_ALLOC_CHECK(f);
+    for (b = 0; b < nbeta; ++b) {
+      f[plan->nalpha * b] = 1.0;
+      so3_core_forward_direct_real(flmn, f, parameters);
+      f[plan->nalpha * b] = 0.0;
+      for (t = 0; t < plan->nterms; ++t)
+        plan->Q[b + nbeta * t] = flmn[plan->ind[t]];
+    }
+    free(f);
+  } else {
+    complex double *f = calloc(plan->f_size, sizeof(*f));
+    SO3_ERROR_MEM_ALLOC_CHECK(f);
+    for (b = 0; b < nbeta; ++b) {
+      f[plan->nalpha * b] = 1.0;
+      so3_core_forward_direct(flmn, f, parameters);
+      f[plan->nalpha * b] = 0.0;
+      for (t = 0; t < plan->nterms; ++t)
+        plan->Q[b + nbeta * t] = flmn[plan->ind[t]];
+    }
+    free(f);
+  }
+  free(flmn);
+
+  // Fourier matrices in alpha and gamma.
+  plan->ealpha = calloc(plan->nalpha * plan->nm, sizeof(*plan->ealpha));
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->ealpha);
+  for (a = 0; a < plan->nalpha; ++a)
+    for (m = -M + 1; m <= M - 1; ++m)
+      plan->ealpha[m + M - 1 + plan->nm * a] =
+          cexp(I * m * 2.0 * SO3_PI * a / plan->nalpha);
+  plan->egamma = calloc(plan->ngamma * plan->nn, sizeof(*plan->egamma));
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->egamma);
+  for (g = 0; g < plan->ngamma; ++g)
+    for (n = -plan->n_offset; n <= N - 1; ++n)
+      plan->egamma[n + plan->n_offset + plan->nn * g] =
+          cexp(I * n * 2.0 * SO3_PI * g / plan->ngamma);
+
+  return plan;
+}
+
+/*!
+ * Free a plan of the small band-limit engine.
+ *
+ * \param[in] plan Plan returned by \link so3_small_plan_init \endlink.
+ * \retval none
+ */
+void so3_small_plan_free(so3_small_plan_t *plan) {
+  if (plan == NULL)
+    return;
+  free(plan->ind);
+  free(plan->mn);
+  free(plan->P);
+  free(plan->Q);
+  free(plan->ealpha);
+  free(plan->egamma);
+  free(plan);
+}
+
+static int
+so3_small_same_parameters(const so3_parameters_t *a, const so3_parameters_t *b) {
+  return a->reality == b->reality && a->L0 == b->L0 && a->L == b->L && a->N == b->N &&
+         so3_sampling_mlim(a) == so3_sampling_mlim(b) &&
+         a->sampling_scheme == b->sampling_scheme && a->n_order == b->n_order &&
+         a->storage == b->storage && a->n_mode == b->n_mode &&
+         a->steerable == b->steerable && a->dl_tolerance == b->dl_tolerance;
+}
+
+/*!
+ * Look up a plan in the global cache of the small band-limit engine.
+ *
+ * \param[in] parameters A fully populated parameters object.
+ * \retval plan Cached plan for these parameters, or NULL if there is none.
+ */
+so3_small_plan_t *so3_small_plan_cached(const so3_parameters_t *parameters) {
+  so3_small_plan_t *plan = NULL;
+  int i;
+
+  pthread_mutex_lock(&small_cache_lock);
+  for (i = 0; i < small_ncache && !plan; ++i)
+    if (so3_small_same_parameters(&small_cache[i]->parameters, parameters))
+      plan = small_cache[i];
+  pthread_mutex_unlock(&small_cache_lock);
+  return plan;
+}
+
+/*!
+ * Get the plan for a parameter set from the global cache of the small
+ * band-limit engine, building it on first use.
+ *
+ * The plan is owned by the cache and stays valid until \link
+ * so3_small_plan_cache_clear \endlink. The cache may be used from several
+ * threads; a plan missing from it is built once, by the first of them.
+ *
+ * \param[in] parameters A fully populated parameters object.
+ * \retval plan Cached plan for these parameters.
+ */
+so3_small_plan_t *so3_small_plan_get(const so3_parameters_t *parameters) {
+  so3_small_plan_t *plan = NULL;
+  so3_small_plan_t **cache;
+  int i;
+
+  pthread_mutex_lock(&small_cache_lock);
+  for (i = 0; i < small_ncache && !plan; ++i)
+    if (so3_small_same_parameters(&small_cache[i]->parameters, parameters))
+      plan = small_cache[i];
+  if (!plan) {
+    plan = so3_small_plan_init(parameters);
+    cache = realloc(small_cache, (small_ncache + 1) * sizeof *small_cache);
+    SO3_ERROR_MEM_ALLOC_CHECK(cache);
+    small_cache = cache;
+    small_cache[small_ncache++] = plan;
+  }
+  pthread_mutex_unlock(&small_cache_lock);
+  return plan;
+}
+
+/*!
+ * Free every plan of the global cache of the small band-limit engine.
+ *
+ * No thread may be using a cached plan meanwhile.
+ *
+ * \retval none
+ */
+void so3_small_plan_cache_clear(void) {
+  int i;
+
+  pthread_mutex_lock(&small_cache_lock);
+  for (i = 0; i < small_ncache; ++i)
+    so3_small_plan_free(small_cache[i]);
+  free(small_cache);
+  small_cache = NULL;
+  small_ncache = 0;
+  pthread_mutex_unlock(&small_cache_lock);
+}
+
+// Zeroed scratch of nbeta*(nm*nn + nalpha*nn) + 2 elements per signal, to
+// be freed by the caller.
+static complex double *so3_small_work(const so3_small_plan_t *plan, int batch) {
+  size_t per_signal = (size_t)plan->nbeta * plan->nn * (plan->nm + plan->nalpha) + 2;
+  complex double *work = calloc(per_signal * batch, sizeof(*work));
+  SO3_ERROR_MEM_ALLOC_CHECK(work);
+  return work;
+}
+
+// Compute F[b][m, n][k] = sum_t P[t][b] flmn_k[ind[t]], with F zeroed and
+// batch elements of scratch x.
+static void so3_small_wigner_inverse(
+    complex double *F, complex double *x, const complex double *flmn, int batch,
+    const so3_small_plan_t *plan) {
+  int t, b, k;
+  int nbeta = plan->nbeta;
+  int nmn = plan->nm * plan->nn;
+
+  for (t = 0; t < plan->nterms; ++t) {
+    for (k = 0; k < batch; ++k)
+      x[k] = flmn[plan->ind[t] + plan->flmn_size * k];
+    const double *P = plan->P + nbeta * t;
+    for (b = 0; b < nbeta; ++b) {
+      complex double *Fb = F + batch * (plan->mn[t] + nmn * b);
+      for (k = 0; k < batch; ++k)
+        Fb[k] += P[b] * x[k];
+    }
+  }
+}
+
+// Compute G[b][a][n][k] = sum_m exp(i*m*alpha_a) F[b][m, n][k], with G
+// zeroed.
+static void so3_small_alpha_inverse(
+    complex double *G, const complex double *F, int batch,
+    const so3_small_plan_t *plan) {
+  int a, b, m, n, k;
+  int nm = plan->nm, nn = plan->nn, nalpha = plan->nalpha;
+
+  for (b = 0; b < plan->nbeta; ++b)
+    for (a = 0; a < nalpha; ++a) {
+      const complex double *ea = plan->ealpha + nm * a;
+      for (n = 0; n < nn; ++n) {
+        complex double *Gban = G + batch * (n + nn * (a + nalpha * b));
+        const complex double *Fbn = F + batch * nm * (n + nn * b);
+        for (m = 0; m < nm; ++m)
+          for (k = 0; k < batch; ++k)
+            Gban[k] += ea[m] * Fbn[k + batch * m];
+      }
+    }
+}
+
+// Split new scratch for an inverse transform into F, G and two arrays of
+// batch elements. Free it through F.
+static void so3_small_inverse_work(
+    complex double **F, complex double **G, complex double **x, complex double **sum,
+    int batch, const so3_small_plan_t *plan) {
+  size_t F_size = (size_t)plan->nbeta * plan->nm * plan->nn * batch;
+  size_t G_size = (size_t)plan->nbeta * plan->nalpha * plan->nn * batch;
+
+  *F = so3_small_work(plan, batch);
+  *G = *F + F_size;
+  *x = *G + G_size;
+  *sum = *x + batch;
+}
+
+/*!
+ * Compute inverse Wigner transforms of a batch of complex signals with the
+ * small band-limit engine.
+ *
+ * \param[out] f Functions on SO(3), stored one after the other. Provide a
+ *               buffer of batch*\link so3_sampling_f_size \endlink elements.
+ * \param[in] flmn Harmonic coefficients, stored one after the other.
+ * \param[in] batch Number of signals.
+ * \param[in] plan Plan for complex signals.
+ * \retval none
+ */
+void so3_small_inverse(
+    complex double *f, const complex double *flmn, int batch,
+    const so3_small_plan_t *plan) {
+  int a, b, g, n, k;
+  int nn = plan->nn, nalpha = plan->nalpha, nbeta = plan->nbeta;
+  complex double *F, *G, *x, *sum;
+
+  if (plan->parameters.reality)
+    SO3_ERROR_GENERIC("Plan is for real signals");
+
+  so3_small_inverse_work(&F, &G, &x, &sum, batch, plan);
+  so3_small_wigner_inverse(F, x, flmn, batch, plan);
+  so3_small_alpha_inverse(G, F, batch, plan);
+  for (g = 0; g < plan->ngamma; ++g) {
+    const complex double *eg = plan->egamma + nn * g;
+    for (b = 0; b < nbeta; ++b)
+      for (a = 0; a < nalpha; ++a) {
+        const complex double *Gba = G + batch * nn * (a + nalpha * b);
+        memset(sum, 0, batch * sizeof(*sum));
+        for (n = 0; n < nn; ++n)
+          for (k = 0; k < batch; ++k)
+            sum[k] += eg[n] * Gba[k + batch * n];
+        for (k = 0; k < batch; ++k)
+          f[a + nalpha * (b + nbeta * g) + plan->f_size * k] = sum[k];
+      }
+  }
+  free(F);
+}
+
+/*!
+ * Compute inverse Wigner transforms of a batch of real signals with the
+ * small band-limit engine.
+ *
+ * \param[out] f Real functions on SO(3), stored one after the other. Provide
+ *               a buffer of batch*\link so3_sampling_f_size \endlink elements.
+ * \param[in] flmn Harmonic coefficients for n >= 0, stored one after the other.
+ * \param[in] batch Number of signals.
+ * \param[in] plan Plan for real signals.
+ * \retval none
+ */
+void so3_small_inverse_real(
+    double *f, const complex double *flmn, int batch, const so3_small_plan_t *plan) {
+  int a, b, g, n, k;
+  int nn = plan->nn, nalpha = plan->nalpha, nbeta = plan->nbeta;
+  complex double *F, *G, *x, *work_sum;
+
+  if (!plan->parameters.reality)
+    SO3_ERROR_GENERIC("Plan is for complex signals");
+
+  so3_small_inverse_work(&F, &G, &x, &work_sum, batch, plan);
+  so3_small_wigner_inverse(F, x, flmn, batch, plan);
+  so3_small_alpha_inverse(G, F, batch, plan);
+
+  // Only n >= 0 is stored; the n < 0 terms are the complex conjugates of the
+  // n > 0 ones, which doubles the real part of the latter.
+  double *sum = (double *)work_sum;
+  for (g = 0; g < plan->ngamma; ++g) {
+    const complex double *eg = plan->egamma + nn * g;
+    for (b = 0; b < nbeta; ++b)
+      for (a = 0; a < nalpha; ++a) {
+        const complex double *Gba = G + batch * nn * (a + nalpha * b);
+        for (k = 0; k < batch; ++k)
+          sum[k] = creal(eg[0] * Gba[k]);
+        for (n = 1; n < nn; ++n)
+          for (k = 0; k < batch; ++k)
+            sum[k] += 2.0 * creal(eg[n] * Gba[k + batch * n]);
+        for (k = 0; k < batch; ++k)
+          f[a + nalpha * (b + nbeta * g) + plan->f_size * k] = sum[k];
+      }
+  }
+  free(F);
+}
+
+// Compute flmn_k[ind[t]] = sum_b Q[t][b] F[b][m, n][k] from
+// H[b][a][n][k] = sum_g exp(-i*n*gamma_g) f_k(a, b, g), which starts the
+// scratch returned by so3_small_work, followed by F and sum.
+static void so3_small_forward_from_gamma(
+    complex double *flmn, const complex double *H, int batch,
+    const so3_small_plan_t *plan) {
+  int a, b, m, n, t, k;
+  int nm = plan->nm, nn = plan->nn, nalpha = plan->nalpha, nbeta = plan->nbeta;
+  int nmn = nm * nn;
+
+  // F[b][m, n][k] = sum_a exp(-i*m*alpha_a) H[b][a][n][k]
+  complex double *F = (complex double *)H + (size_t)nbeta * nalpha * nn * batch;
+  complex double *sum = F + (size_t)nbeta * nmn * batch;
+  for (b = 0; b < nbeta; ++b)
+    for (a = 0; a < nalpha; ++a) {
+      const complex double *ea = plan->ealpha + nm * a;
+      for (n = 0; n < nn; ++n) {
+        const complex double *Hban = H + batch * (n + nn * (a + nalpha * b));
+        complex double *Fbn = F + batch * nm * (n + nn * b);
+        for (m = 0; m < nm; ++m) {
+          complex double e = conj(ea[m]);
+          for (k = 0; k < batch; ++k)
+            Fbn[k + batch * m] += e * Hban[k];
+        }
+      }
+    }
+
+  memset(flmn, 0, plan->flmn_size * batch * sizeof(*flmn));
+  for (t = 0; t < plan->nterms; ++t) {
+    const complex double *Q = plan->Q + nbeta * t;
+    memset(sum, 0, batch * sizeof(*sum));
+    for (b = 0; b < nbeta; ++b) {
+      const complex double *Fb = F + batch * (plan->mn[t] + nmn * b);
+      for (k = 0; k < batch; ++k)
+        sum[k] += Q[b] * Fb[k];
+    }
+    for (k = 0; k < batch; ++k)
+      flmn[plan->ind[t] + plan->flmn_size * k] = sum[k];
+  }
+}
+
+/*!
+ * Compute forward Wigner transforms of a batch of complex signals with the
+ * small band-limit engine.
+ *
+ * \param[out] flmn Harmonic coefficients, stored one after the other. Provide
+ *                  a buffer of batch*\link so3_sampling_flmn_size \endlink
+ *                  elements.
+ * \param[in] f Functions on SO(3), stored one after the other.
+ * \param[in] batch Number of signals.
+ * \param[in] plan Plan for complex signals.
+ * \retval none
+ */
+void so3_small_forward(
+    complex double *flmn, const complex double *f, int batch,
+    const so3_small_plan_t *plan) {
+  int a, b, g, n, k;
+  int nn = plan->nn, nalpha = plan->nalpha, nbeta = plan->nbeta;
+
+  if (plan->parameters.reality)
+    SO3_ERROR_GENERIC("Plan is for real signals");
+
+  complex double *H = so3_small_work(plan, batch);
+  for (g = 0; g < plan->ngamma; ++g) {
+    const complex double *eg = plan->egamma + nn * g;
+    for (b = 0; b < nbeta; ++b)
+      for (a = 0; a < nalpha; ++a) {
+        const complex double *fabg = f + a + nalpha * (b + nbeta * g);
+        complex double *Hba = H + batch * nn * (a + nalpha * b);
+        for (n = 0; n < nn; ++n) {
+          complex double e = conj(eg[n]);
+          for (k = 0; k < batch; ++k)
+            Hba[k + batch * n] += e * fabg[plan->f_size * k];
+        }
+      }
+  }
+
+  so3_small_forward_from_gamma(flmn, H, batch, plan);
+  free(H);
+}
+
+/*!
+ * Compute forward Wigner transforms of a batch of real signals with the
+ * small band-limit engine.
+ *
+ * \param[out] flmn Harmonic coefficients for n >= 0, stored one after the
+ *                  other. Provide a buffer of
+ *                  batch*\link so3_sampling_flmn_size \endlink elements.
+ * \param[in] f Real functions on SO(3), stored one after the other.
+ * \param[in] batch Number of signals.
+ * \param[in] plan Plan for real signals.
+ * \retval none
+ */
+void so3_small_forward_real(
+    complex double *flmn, const double *f, int batch, const so3_small_plan_t *plan) {
+  int a, b, g, n, k;
+  int nn = plan->nn, nalpha = plan->nalpha, nbeta = plan->nbeta;
+
+  if (!plan->parameters.reality)
+    SO3_ERROR_GENERIC("Plan is for complex signals");
+
+  complex double *H = so3_small_work(plan, batch);
+  for (g = 0; g < plan->ngamma; ++g) {
+    const complex double *eg = plan->egamma + nn * g;
+    for (b = 0; b < nbeta; ++b)
+      for (a = 0; a < nalpha; ++a) {
+        const double *fabg = f + a + nalpha * (b + nbeta * g);
+        complex double *Hba = H + batch * nn * (a + nalpha * b);
+        for (n = 0; n < nn; ++n) {
+          complex double e = conj(eg[n]);
+          for (k = 0; k < batch; ++k)
+            Hba[k + batch * n] += e * fabg[plan->f_size * k];
+        }
+      }
+  }
+
+  so3_small_forward_from_gamma(flmn, H, batch, plan);
+  free(H);
+}
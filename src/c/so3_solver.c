@@ -0,0 +1,734 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_solver.c
+ * Iterative least-squares reconstruction of band-limited signals from
+ * weighted or masked samples,
+ *
+ *   min_flmn || W^(1/2) (A flmn - f) ||^2 + lambda || flmn ||^2,
+ *
+ * where A is the inverse transform (\link so3_core_inverse_direct \endlink)
+ * and W a diagonal matrix of non-negative sample weights, e.g. a mask.
+ *
+ * Calling the transform and its adjoint in every iteration would re-plan
+ * the FFTs, recompute the Wigner recursion and reallocate all intermediate
+ * buffers each time. A solver instead keeps, for every beta ring, the
+ * (2*el+1)/(8*pi^2) d^el_mn(beta) factors of all non-zero coefficients,
+ * a pair of 2D FFT plans over (alpha, gamma) and a ring of scratch. A ring of
+ * A flmn is then one pass over the table into the (m, n) spectrum of the ring
+ * followed by one FFT, and the adjoint is the reverse.
+ *
+ * The normal operator A^H W A is applied ring by ring without forming A flmn:
+ * rings with zero weight are skipped, and since the rings are not aliased,
+ * rings of uniform weight w reduce to a multiplication of the spectrum by
+ * w*nalpha*ngamma without any FFT.
+ *
+ * The table holds nbeta doubles per non-zero coefficient, i.e. about
+ * 8*L*(2*N-1)*L^2 bytes for M = L. Above \link SO3_SOLVER_TABLE_MAX
+ * \endlink bytes it is not stored, and the factors of each ring are
+ * recomputed with the Risbo recursion whenever the ring is visited, which
+ * costs O(L^3) per ring instead of O(L^4) memory.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ssht/ssht.h>
+
+#include "so3/so3_error.h"
+#include "so3/so3_fft.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_solver.h"
+#include "so3/so3_types.h"
+
+#define SO3_SOLVER_DEFAULT_ITERATIONS 100
+#define SO3_SOLVER_DEFAULT_TOLERANCE 1e-10
+
+#define MIN(a, b) ((a < b) ? (a) : (b))
+
+struct so3_solver {
+  so3_parameters_t parameters;
+  int flmn_size, f_size;
+  int nalpha, nbeta, ngamma, ring_size;
+  // Number of non-zero harmonic coefficients.
+  int nterms;
+  // flmn index of each non-zero coefficient, and position of its (m, n) in
+  // the spectrum of a ring.
+  int *ind, *pos;
+  // Wigner table, P[t + nterms*b] = (2*el+1)/(8*pi^2) d^el_mn(beta_b), or
+  // NULL if it is too large, in which case Pring holds the factors of ring
+  // Pring_b only.
+  double *P, *Pring;
+  int Pring_b;
+  // m, n and first term of every el, and the buffers of the recursion.
+  int *ms, *ns, *el_start;
+  double *dl, *sqrt_tbl, *signs;
+  // Sample weights, or NULL for unit weights, and their square roots.
+  double *weights, *sqrt_weights;
+  // Weight shared by all samples of a ring, or -1 if they differ, and the
+  // sum of the weights of each ring.
+  double *ring_weight, *ring_sum;
+  // Ring of samples or spectrum, indexed by a + nalpha*g, and the in-place
+  // FFTs from spectrum to samples (backward) and back (forward).
+  complex double *ring;
+  so3_fft_plan_t *plan_backward, *plan_forward;
+  // Coefficient vectors and sample arrays of the iterations.
+  complex double *x, *r, *z, *p, *q, *fw, *fu;
+};
+
+// Fill Pb with the factors (2*el+1)/(8*pi^2) d^el_mn(beta_b) of all terms.
+static void so3_solver_fill_ring(so3_solver_t *solver, double *Pb, int b) {
+  const int L = solver->parameters.L;
+  const int dl_offset = ssht_dl_get_offset(L, SSHT_DL_FULL);
+  const int dl_stride = ssht_dl_get_stride(L, SSHT_DL_FULL);
+  double beta = so3_sampling_b2beta(b, &solver->parameters);
+  int el, t;
+
+  for (el = 0; el < L; ++el) {
+    ssht_dl_beta_risbo_full_table(
+        solver->dl, beta, L, SSHT_DL_FULL, el, solver->sqrt_tbl, solver->signs);
+    double elfactor = (2.0 * el + 1.0) / (8.0 * SO3_PI * SO3_PI);
+    for (t = solver->el_start[el]; t < solver->el_start[el + 1]; ++t)
+      Pb[t] = elfactor * solver->dl[(solver->ms[t] + dl_offset) * dl_stride +
+                                    solver->ns[t] + dl_offset];
+  }
+}
+
+// Factors of ring b, from the table or recomputed.
+static const double *so3_solver_ring_table(so3_solver_t *solver, int b) {
+  if (solver->P)
+    return solver->P + (size_t)solver->nterms * b;
+  if (solver->Pring_b != b) {
+    so3_solver_fill_ring(solver, solver->Pring, b);
+    solver->Pring_b = b;
+  }
+  return solver->Pring;
+}
+
+/*!
+ * Create a solver for the given parameters.
+ *
+ * \param[in] parameters A fully populated parameters object. Real and
+ *                       steerable signals are not supported.
+ * \retval solver Solver with unit weights. Free it with \link
+ *                so3_solver_free \endlink.
+ */
+so3_solver_t *so3_solver_init(const so3_parameters_t *parameters) {
+  int el, m, n, b, t;
+
+  if (parameters->reality)
+    SO3_ERROR_GENERIC("Solver does not support real signals");
+  if (parameters->steerable)
+    SO3_ERROR_GENERIC("Solver does not support steerable signals");
+
+  so3_solver_t *solver = calloc(1, sizeof(*solver));
+  SO3_ERROR_MEM_ALLOC_CHECK(solver);
+
+  solver->parameters = *parameters;
+  parameters = &solver->parameters;
+
+  int L = parameters->L;
+  int N = parameters->N;
+  int M = so3_sampling_mlim(parameters);
+
+  solver->flmn_size = so3_sampling_flmn_size(parameters);
+  solver->f_size = so3_sampling_f_size(parameters);
+  solver->nalpha = so3_sampling_nalpha(parameters);
+  solver->nbeta = so3_sampling_nbeta(parameters);
+  solver->ngamma = so3_sampling_ngamma(parameters);
+  solver->ring_size = solver->nalpha * solver->ngamma;
+
+  int nbeta = solver->nbeta;
+
+  // Enumerate the non-zero harmonic coefficients by el, so that the Wigner
+  // table can be filled while the recursion runs through el.
+  solver->ind = calloc(solver->flmn_size, sizeof(*solver->ind));
+  SO3_ERROR_MEM_ALLOC_CHECK(solver->ind);
+  solver->pos = calloc(solver->flmn_size, sizeof(*solver->pos));
+  SO3_ERROR_MEM_ALLOC_CHECK(solver->pos);
+  int *ms = solver->ms = calloc(solver->flmn_size, sizeof(*ms));
+  SO3_ERROR_MEM_ALLOC_CHECK(ms);
+  int *ns = solver->ns = calloc(solver->flmn_size, sizeof(*ns));
+  SO3_ERROR_MEM_ALLOC_CHECK(ns);
+  int *el_start = solver->el_start = calloc(L + 1, sizeof(*el_start));
+  SO3_ERROR_MEM_ALLOC_CHECK(el_start);
+
+  t = 0;
+  for (el = 0; el < L; ++el) {
+    el_start[el] = t;
+    for (m = -MIN(el, M - 1); m <= MIN(el, M - 1); ++m)
+      for (n = -MIN(el, N - 1); n <= MIN(el, N - 1); ++n) {
+        if (!so3_sampling_is_elmn_non_zero(el, m, n, parameters))
+          continue;
+        so3_sampling_elmn2ind(&solver->ind[t], el, m, n, parameters);
+        solver->pos[t] = (m < 0 ? m + solver->nalpha : m) +
+                         solver->nalpha * (n < 0 ? n + solver->ngamma : n);
+        ms[t] = m;
+        ns[t] = n;
+        ++t;
+      }
+  }
+  el_start[L] = t;
+  solver->nterms = t;
+
+  // Wigner table.
+  solver->sqrt_tbl = calloc(2 * (L - 1) + 2, sizeof(*solver->sqrt_tbl));
+  SO3_ERROR_MEM_ALLOC_CHECK(solver->sqrt_tbl);
+  solver->signs = calloc(L + 1, sizeof(*solver->signs));
+  SO3_ERROR_MEM_ALLOC_CHECK(solver->signs);
+  for (el = 0; el <= 2 * (L - 1) + 1; ++el)
+    solver->sqrt_tbl[el] = sqrt((double)el);
+  for (m = 0; m <= L - 1; m += 2) {
+    solver->signs[m] = 1.0;
+    solver->signs[m + 1] = -1.0;
+  }
+  solver->dl = ssht_dl_calloc(L, SSHT_DL_FULL);
+  SO3_ERROR_MEM_ALLOC_CHECK(solver->dl);
+  if ((size_t)solver->nterms * nbeta <= SO3_SOLVER_TABLE_MAX / sizeof(*solver->P)) {
+    solver->P = calloc((size_t)solver->nterms * nbeta, sizeof(*solver->P));
+    SO3_ERROR_MEM_ALLOC_CHECK(solver->P);
+    for (b = 0; b < nbeta; ++b)
+      so3_solver_fill_ring(solver, solver->P + (size_t)solver->nterms * b, b);
+  } else {
+    solver->Pring = calloc(solver->nterms, sizeof(*solver->Pring));
+    SO3_ERROR_MEM_ALLOC_CHECK(solver->Pring);
+    solver->Pring_b = -1;
+  }
+
+  // FFT plans. Measuring may overwrite the ring, which is still unused.
+  solver->ring = calloc(solver->ring_size, sizeof(*solver->ring));
+  SO3_ERROR_MEM_ALLOC_CHECK(solver->ring);
+  solver->plan_backward = so3_fft_plan_dft_2d(
+      solver->ngamma, solver->nalpha, solver->ring, solver->ring, SO3_FFT_BACKWARD,
+      SO3_FFT_MEASURE);
+  solver->plan_forward = so3_fft_plan_dft_2d(
+      solver->ngamma, solver->nalpha, solver->ring, solver->ring, SO3_FFT_FORWARD,
+      SO3_FFT_MEASURE);
+
+  solver->ring_weight = calloc(nbeta, sizeof(*solver->ring_weight));
+  SO3_ERROR_MEM_ALLOC_CHECK(solver->ring_weight);
+  solver->ring_sum = calloc(nbeta, sizeof(*solver->ring_sum));
+  SO3_ERROR_MEM_ALLOC_CHECK(solver->ring_sum);
+  so3_solver_set_weights(solver, NULL);
+
+  // Work arrays of the iterations.
+  solver->x = calloc(5 * (size_t)solver->nterms, sizeof(*solver->x));
+  SO3_ERROR_MEM_ALLOC_CHECK(solver->x);
+  solver->r = solver->x + solver->nterms;
+  solver->z = solver->r + solver->nterms;
+  solver->p = solver->z + solver->nterms;
+  solver->q = solver->p + solver->nterms;
+  solver->fw = calloc(2 * (size_t)solver->f_size, sizeof(*solver->fw));
+  SO3_ERROR_MEM_ALLOC_CHECK(solver->fw);
+  solver->fu = solver->fw + solver->f_size;
+
+  return solver;
+}
+
+/*!
+ * Free a solver.
+ *
+ * \param[in] solver Solver returned by \link so3_solver_init \endlink.
+ * \retval none
+ */
+void so3_solver_free(so3_solver_t *solver) {
+  if (solver == NULL)
+    return;
+  free(solver->ind);
+  free(solver->pos);
+  free(solver->P);
+  free(solver->Pring);
+  free(solver->ms);
+  free(solver->ns);
+  free(solver->el_start);
+  free(solver->dl);
+  free(solver->sqrt_tbl);
+  free(solver->signs);
+  free(solver->weights);
+  free(solver->sqrt_weights);
+  free(solver->ring_weight);
+  free(solver->ring_sum);
+  so3_fft_destroy_plan(solver->plan_backward);
+  so3_fft_destroy_plan(solver->plan_forward);
+  free(solver->ring);
+  free(solver->x);
+  free(solver->fw);
+  free(solver);
+}
+
+/*!
+ * Set the sample weights W of the least-squares problem.
+ *
+ * \param[in] solver Solver.
+ * \param[in] weights Non-negative weight of each sample, in the layout of
+ *                    the signal (\link so3_sampling_f_size \endlink
+ *                    elements), e.g. 0 and 1 for a mask. NULL restores unit
+ *                    weights. The weights are copied.
+ * \retval none
+ */
+void so3_solver_set_weights(so3_solver_t *solver, const double *weights) {
+  int a, b, g, i;
+  int nalpha = solver->nalpha, nbeta = solver->nbeta;
+
+  free(solver->weights);
+  free(solver->sqrt_weights);
+  solver->weights = NULL;
+  solver->sqrt_weights = NULL;
+
+  if (weights == NULL) {
+    for (b = 0; b < nbeta; ++b) {
+      solver->ring_weight[b] = 1.0;
+      solver->ring_sum[b] = solver->ring_size;
+    }
+    return;
+  }
+
+  solver->weights = malloc(solver->f_size * sizeof(*solver->weights));
+  SO3_ERROR_MEM_ALLOC_CHECK(solver->weights);
+  solver->sqrt_weights = malloc(solver->f_size * sizeof(*solver->sqrt_weights));
+  SO3_ERROR_MEM_ALLOC_CHECK(solver->sqrt_weights);
+  for (i = 0; i < solver->f_size; ++i) {
+    if (weights[i] < 0)
+      SO3_ERROR_GENERIC("Weights must be non-negative");
+    solver->weights[i] = weights[i];
+    solver->sqrt_weights[i] = sqrt(weights[i]);
+  }
+
+  for (b = 0; b < nbeta; ++b) {
+    double first = weights[nalpha * b];
+    solver->ring_weight[b] = first;
+    solver->ring_sum[b] = 0.0;
+    for (g = 0; g < solver->ngamma; ++g)
+      for (a = 0; a < nalpha; ++a) {
+        double w = weights[a + nalpha * (b + nbeta * g)];
+        solver->ring_sum[b] += w;
+        if (w != first)
+          solver->ring_weight[b] = -1.0;
+      }
+  }
+}
+
+// Fill the ring with the (m, n) spectrum of ring b of A x.
+static void so3_solver_ring_spectrum(
+    so3_solver_t *solver, const complex double *x, int b) {
+  int t;
+  const double *Pb = so3_solver_ring_table(solver, b);
+
+  memset(solver->ring, 0, solver->ring_size * sizeof(*solver->ring));
+  for (t = 0; t < solver->nterms; ++t)
+    solver->ring[solver->pos[t]] += Pb[t] * x[t];
+}
+
+// Accumulate y += scale * P_b^T ring, the adjoint of so3_solver_ring_spectrum.
+static void so3_solver_ring_accumulate(
+    so3_solver_t *solver, complex double *y, int b, double scale) {
+  int t;
+  const double *Pb = so3_solver_ring_table(solver, b);
+
+  for (t = 0; t < solver->nterms; ++t)
+    y[t] += scale * Pb[t] * solver->ring[solver->pos[t]];
+}
+
+// f = A x, optionally multiplied by per-sample factors.
+static void so3_solver_apply(
+    so3_solver_t *solver, complex double *f, const complex double *x,
+    const double *factors) {
+  int a, b, g, i;
+  int nalpha = solver->nalpha, nbeta = solver->nbeta;
+
+  for (b = 0; b < nbeta; ++b) {
+    so3_solver_ring_spectrum(solver, x, b);
+    so3_fft_execute(solver->plan_backward);
+    for (g = 0; g < solver->ngamma; ++g)
+      for (a = 0; a < nalpha; ++a) {
+        i = a + nalpha * (b + nbeta * g);
+        f[i] = solver->ring[a + nalpha * g];
+        if (factors)
+          f[i] *= factors[i];
+      }
+  }
+}
+
+// y = A^H f, with f optionally multiplied by per-sample factors first.
+static void so3_solver_apply_adjoint(
+    so3_solver_t *solver, complex double *y, const complex double *f,
+    const double *factors) {
+  int a, b, g, i;
+  int nalpha = solver->nalpha, nbeta = solver->nbeta;
+
+  memset(y, 0, solver->nterms * sizeof(*y));
+  for (b = 0; b < nbeta; ++b) {
+    for (g = 0; g < solver->ngamma; ++g)
+      for (a = 0; a < nalpha; ++a) {
+        i = a + nalpha * (b + nbeta * g);
+        solver->ring[a + nalpha * g] = factors ? factors[i] * f[i] : f[i];
+      }
+    so3_fft_execute(solver->plan_forward);
+    so3_solver_ring_accumulate(solver, y, b, 1.0);
+  }
+}
+
+// y = (A^H W A + damping) x, ring by ring.
+static void so3_solver_apply_normal(
+    so3_solver_t *solver, complex double *y, const complex double *x, double damping) {
+  int a, b, g, t;
+  int nalpha = solver->nalpha, nbeta = solver->nbeta;
+
+  for (t = 0; t < solver->nterms; ++t)
+    y[t] = damping * x[t];
+
+  for (b = 0; b < nbeta; ++b) {
+    double w = solver->ring_weight[b];
+    if (w == 0.0)
+      continue;
+    so3_solver_ring_spectrum(solver, x, b);
+    if (w > 0.0) {
+      // The forward FFT of the backward FFT of the band-limited spectrum is
+      // the spectrum times the number of samples.
+      so3_solver_ring_accumulate(solver, y, b, w * solver->ring_size);
+      continue;
+    }
+    so3_fft_execute(solver->plan_backward);
+    for (g = 0; g < solver->ngamma; ++g)
+      for (a = 0; a < nalpha; ++a)
+        solver->ring[a + nalpha * g] *= solver->weights[a + nalpha * (b + nbeta * g)];
+    so3_fft_execute(solver->plan_forward);
+    so3_solver_ring_accumulate(solver, y, b, 1.0);
+  }
+}
+
+static void so3_solver_gather(
+    so3_solver_t *solver, complex double *x, const complex double *flmn) {
+  int t;
+  for (t = 0; t < solver->nterms; ++t)
+    x[t] = flmn[solver->ind[t]];
+}
+
+static void so3_solver_scatter(
+    so3_solver_t *solver, complex double *flmn, const complex double *x) {
+  int t;
+  memset(flmn, 0, solver->flmn_size * sizeof(*flmn));
+  for (t = 0; t < solver->nterms; ++t)
+    flmn[solver->ind[t]] = x[t];
+}
+
+static double so3_solver_dot(
+    const complex double *x, const complex double *y, int size) {
+  int i;
+  double sum = 0.0;
+  for (i = 0; i < size; ++i)
+    sum += creal(conj(x[i]) * y[i]);
+  return sum;
+}
+
+static double so3_solver_norm(const complex double *x, int size) {
+  return sqrt(so3_solver_dot(x, x, size));
+}
+
+/*!
+ * Compute the inverse transform A flmn with the persistent plans of a
+ * solver. The result agrees with \link so3_core_inverse_direct \endlink; the
+ * sample weights are not applied.
+ *
+ * \param[in] solver Solver.
+ * \param[out] f Signal. Provide a buffer of \link so3_sampling_f_size
+ *               \endlink elements.
+ * \param[in] flmn Harmonic coefficients.
+ * \retval none
+ */
+void so3_solver_inverse(
+    so3_solver_t *solver, complex double *f, const complex double *flmn) {
+  so3_solver_gather(solver, solver->x, flmn);
+  so3_solver_apply(solver, f, solver->x, NULL);
+}
+
+/*!
+ * Compute the adjoint of the inverse transform, A^H f, with the persistent
+ * plans of a solver. The result agrees with \link
+ * so3_adjoint_inverse_direct \endlink; the sample weights are not applied.
+ *
+ * \param[in] solver Solver.
+ * \param[out] flmn Harmonic coefficients. Provide a buffer of \link
+ *                  so3_sampling_flmn_size \endlink elements.
+ * \param[in] f Signal.
+ * \retval none
+ */
+void so3_solver_adjoint_inverse(
+    so3_solver_t *solver, complex double *flmn, const complex double *f) {
+  so3_solver_apply_adjoint(solver, solver->x, f, NULL);
+  so3_solver_scatter(solver, flmn, solver->x);
+}
+
+/*!
+ * Apply the normal operator A^H W A of the weighted least-squares problem
+ * in a single pass over the rings.
+ *
+ * \param[in] solver Solver.
+ * \param[out] out Harmonic coefficients A^H W A flmn. Provide a buffer of
+ *                 \link so3_sampling_flmn_size \endlink elements.
+ * \param[in] flmn Harmonic coefficients.
+ * \retval none
+ */
+void so3_solver_normal(
+    so3_solver_t *solver, complex double *out, const complex double *flmn) {
+  so3_solver_gather(solver, solver->x, flmn);
+  so3_solver_apply_normal(solver, solver->r, solver->x, 0.0);
+  so3_solver_scatter(solver, out, solver->r);
+}
+
+// Diagonal of A^H W A + damping, the Jacobi preconditioner, into d.
+static void so3_solver_jacobi(so3_solver_t *solver, double *d, double damping) {
+  int b, t;
+  for (t = 0; t < solver->nterms; ++t)
+    d[t] = damping;
+  for (b = 0; b < solver->nbeta; ++b) {
+    const double *Pb = so3_solver_ring_table(solver, b);
+    for (t = 0; t < solver->nterms; ++t)
+      d[t] += solver->ring_sum[b] * Pb[t] * Pb[t];
+  }
+  // Coefficients that the samples do not constrain at all stay unscaled.
+  for (t = 0; t < solver->nterms; ++t)
+    if (d[t] <= 0.0)
+      d[t] = 1.0;
+}
+
+// Preconditioned conjugate gradients on (A^H W A + damping) x = A^H W f.
+static int so3_solver_cg(
+    so3_solver_t *solver, const complex double *f, int max_iterations, double tolerance,
+    double damping, const double *d, double *residual) {
+  int i, t;
+  int nterms = solver->nterms;
+  complex double *x = solver->x, *r = solver->r, *z = solver->z;
+  complex double *p = solver->p, *q = solver->q;
+
+  so3_solver_apply_adjoint(solver, r, f, solver->weights);
+  double rhs_norm = so3_solver_norm(r, nterms);
+  memset(x, 0, nterms * sizeof(*x));
+  *residual = 0.0;
+  if (rhs_norm == 0.0)
+    return 0;
+
+  for (t = 0; t < nterms; ++t)
+    z[t] = d ? r[t] / d[t] : r[t];
+  memcpy(p, z, nterms * sizeof(*p));
+  double rz = so3_solver_dot(r, z, nterms);
+
+  for (i = 0; i < max_iterations; ++i) {
+    so3_solver_apply_normal(solver, q, p, damping);
+    double alpha = rz / so3_solver_dot(p, q, nterms);
+    for (t = 0; t < nterms; ++t) {
+      x[t] += alpha * p[t];
+      r[t] -= alpha * q[t];
+    }
+    *residual = so3_solver_norm(r, nterms) / rhs_norm;
+    if (*residual <= tolerance)
+      return i + 1;
+
+    for (t = 0; t < nterms; ++t)
+      z[t] = d ? r[t] / d[t] : r[t];
+    double rz_new = so3_solver_dot(r, z, nterms);
+    double beta = rz_new / rz;
+    rz = rz_new;
+    for (t = 0; t < nterms; ++t)
+      p[t] = z[t] + beta * p[t];
+  }
+  return max_iterations;
+}
+
+// LSQR on min || W^(1/2) (A S y - f) ||^2 + damping || S y ||^2 with
+// x = S y, where S = diag(d)^(-1/2) for the Jacobi preconditioner and the
+// identity otherwise, so that the damping acts on x as in CG. Without a
+// preconditioner the damping is the scalar one of LSQR; with one it enters
+// as the extra rows damp*S of the operator, whose part of u is ud.
+static int so3_solver_lsqr(
+    so3_solver_t *solver, const complex double *f, int max_iterations, double tolerance,
+    double damping, const double *d, double *residual) {
+  int i, k, t;
+  int nterms = solver->nterms, f_size = solver->f_size;
+  const double *sw = solver->sqrt_weights;
+  // x holds the solution, v and w the LSQR vectors and z the scaled v.
+  complex double *x = solver->x, *v = solver->r, *w = solver->p, *z = solver->z;
+  complex double *u = solver->fu, *ud = NULL;
+  double alpha, beta;
+  double *s = NULL;
+  double damp = sqrt(damping);
+
+  if (d) {
+    s = malloc(nterms * sizeof(*s));
+    SO3_ERROR_MEM_ALLOC_CHECK(s);
+    for (t = 0; t < nterms; ++t)
+      s[t] = 1.0 / sqrt(d[t]);
+    if (damping > 0) {
+      ud = calloc(nterms, sizeof(*ud));
+      SO3_ERROR_MEM_ALLOC_CHECK(ud);
+    }
+  }
+
+  memset(x, 0, nterms * sizeof(*x));
+  *residual = 0.0;
+
+  // beta u = W^(1/2) f, alpha v = S A^H W^(1/2) u.
+  for (k = 0; k < f_size; ++k)
+    u[k] = sw ? sw[k] * f[k] : f[k];
+  beta = so3_solver_norm(u, f_size);
+  if (beta == 0.0) {
+    free(s);
+    free(ud);
+    return 0;
+  }
+  for (k = 0; k < f_size; ++k)
+    u[k] /= beta;
+  so3_solver_apply_adjoint(solver, v, u, sw);
+  if (s)
+    for (t = 0; t < nterms; ++t)
+      v[t] *= s[t];
+  alpha = so3_solver_norm(v, nterms);
+  if (alpha == 0.0) {
+    free(s);
+    free(ud);
+    return 0;
+  }
+  for (t = 0; t < nterms; ++t)
+    v[t] /= alpha;
+  memcpy(w, v, nterms * sizeof(*w));
+
+  // The extra rows replace the scalar damping.
+  double sdamp = ud ? 0.0 : damp;
+  double phibar = beta, rhobar = alpha;
+  double normar0 = alpha * beta;
+
+  for (i = 0; i < max_iterations; ++i) {
+    // beta (u, ud) = (W^(1/2) A S v, damp S v) - alpha (u, ud)
+    for (t = 0; t < nterms; ++t)
+      z[t] = s ? s[t] * v[t] : v[t];
+    so3_solver_apply(solver, solver->fw, z, sw);
+    for (k = 0; k < f_size; ++k)
+      u[k] = solver->fw[k] - alpha * u[k];
+    beta = so3_solver_norm(u, f_size);
+    if (ud) {
+      for (t = 0; t < nterms; ++t)
+        ud[t] = damp * z[t] - alpha * ud[t];
+      beta = hypot(beta, so3_solver_norm(ud, nterms));
+    }
+    if (beta > 0.0) {
+      for (k = 0; k < f_size; ++k)
+        u[k] /= beta;
+      if (ud)
+        for (t = 0; t < nterms; ++t)
+          ud[t] /= beta;
+    }
+
+    // alpha v = S (A^H W^(1/2) u + damp ud) - beta v
+    so3_solver_apply_adjoint(solver, z, u, sw);
+    if (ud)
+      for (t = 0; t < nterms; ++t)
+        z[t] += damp * ud[t];
+    for (t = 0; t < nterms; ++t)
+      v[t] = (s ? s[t] * z[t] : z[t]) - beta * v[t];
+    alpha = so3_solver_norm(v, nterms);
+    if (alpha > 0.0)
+      for (t = 0; t < nterms; ++t)
+        v[t] /= alpha;
+
+    // Eliminate the damping, then the subdiagonal beta.
+    double rhobar1 = hypot(rhobar, sdamp);
+    double cs1 = rhobar / rhobar1;
+    phibar = cs1 * phibar;
+    double rho = hypot(rhobar1, beta);
+    double cs = rhobar1 / rho, sn = beta / rho;
+    double theta = sn * alpha;
+    double phi = cs * phibar;
+    rhobar = -cs * alpha;
+    phibar = sn * phibar;
+
+    for (t = 0; t < nterms; ++t) {
+      x[t] += (phi / rho) * w[t];
+      w[t] = v[t] - (theta / rho) * w[t];
+    }
+
+    *residual = fabs(phibar) * alpha * fabs(cs) / normar0;
+    if (*residual <= tolerance || alpha == 0.0) {
+      ++i;
+      break;
+    }
+  }
+
+  if (s)
+    for (t = 0; t < nterms; ++t)
+      x[t] *= s[t];
+  free(s);
+  free(ud);
+  return MIN(i, max_iterations);
+}
+
+/*!
+ * Reconstruct harmonic coefficients from weighted samples by solving
+ *
+ *   min_flmn || W^(1/2) (A flmn - f) ||^2 + lambda || flmn ||^2
+ *
+ * iteratively, with A the inverse transform and W the weights set with
+ * \link so3_solver_set_weights \endlink.
+ *
+ * \param[in] solver Solver.
+ * \param[out] flmn Harmonic coefficients. Provide a buffer of \link
+ *                  so3_sampling_flmn_size \endlink elements.
+ * \param[in] f Samples. Samples with zero weight are ignored.
+ * \param[in] options Options, or NULL for the defaults.
+ * \param[out] residual If not NULL, the final residual of the normal
+ *                      equations relative to their right-hand side (for
+ *                      LSQR with a preconditioner, of the preconditioned
+ *                      equations).
+ * \retval iterations Number of iterations performed.
+ */
+int so3_solver_solve(
+    so3_solver_t *solver, complex double *flmn, const complex double *f,
+    const so3_solver_options_t *options, double *residual) {
+  so3_solver_options_t defaults = {0};
+  double *d = NULL;
+  double res;
+  int iterations;
+
+  if (options == NULL)
+    options = &defaults;
+  int max_iterations = options->max_iterations > 0 ? options->max_iterations
+                                                   : SO3_SOLVER_DEFAULT_ITERATIONS;
+  double tolerance =
+      options->tolerance > 0 ? options->tolerance : SO3_SOLVER_DEFAULT_TOLERANCE;
+  if (options->damping < 0)
+    SO3_ERROR_GENERIC("Damping must be non-negative");
+
+  if (options->preconditioner == SO3_SOLVER_PRECONDITIONER_JACOBI) {
+    d = malloc(solver->nterms * sizeof(*d));
+    SO3_ERROR_MEM_ALLOC_CHECK(d);
+    so3_solver_jacobi(solver, d, options->damping);
+  }
+
+  switch (options->method) {
+  case SO3_SOLVER_CG:
+    iterations = so3_solver_cg(
+        solver, f, max_iterations, tolerance, options->damping, d, &res);
+    break;
+  case SO3_SOLVER_LSQR:
+    iterations = so3_solver_lsqr(
+        solver, f, max_iterations, tolerance, options->damping, d, &res);
+    break;
+  default:
+    SO3_ERROR_GENERIC("Invalid solver method");
+  }
+  free(d);
+
+  so3_solver_scatter(solver, flmn, solver->x);
+  if (residual)
+    *residual = res;
+
+  if (solver->parameters.verbosity > 0)
+    printf(
+        "%sSolver stopped after %d iterations with relative residual %e\n", SO3_PROMPT,
+        iterations, res);
+  return iterations;
+}
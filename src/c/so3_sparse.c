@@ -0,0 +1,554 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_sparse.c
+ * Transforms of signals with few non-zero harmonic coefficients.
+ *
+ * The inverse transform takes a list of (el, m, n, flmn) and the forward
+ * transform computes only a requested list of (el, m, n). Coefficients are
+ * grouped by their orders (m, n), which share the Fourier factors in alpha and
+ * gamma, and the Wigner functions d^el_mn of a group are obtained together by
+ * the recursion in el of so3_wigner.c.
+ *
+ * The inverse synthesises every group on the grid directly. The forward
+ * transform sums the signal over alpha and gamma for each group, which is exact
+ * for band-limited signals, and then integrates over beta with a quadrature
+ * that is exact for the products of two band-limited functions of beta: the
+ * samples in beta are extended to [0, 2*pi) by the symmetry of the Wigner
+ * functions, interpolated by their Fourier series onto an equispaced grid that
+ * is fine enough, and integrated with the Fourier coefficients of |sin(beta)|.
+ *
+ * Both directions fall back to a full flmn array and the dense transforms of
+ * so3_core when the cost model expects them to be faster.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_sparse.h"
+#include "so3/so3_types.h"
+#include "so3/so3_wigner.h"
+
+#define MAX(a, b) ((a > b) ? (a) : (b))
+
+typedef struct {
+  int m, n, el, index;
+} so3_sparse_key_t;
+
+// Coefficients keys[start..stop) of equal (m, n), sorted by el.
+typedef struct {
+  int m, n, lmin, lmax, start, stop;
+} so3_sparse_group_t;
+
+typedef struct {
+  so3_sparse_key_t *keys;
+  so3_sparse_group_t *groups;
+  int ngroups;
+} so3_sparse_plan_t;
+
+static int so3_sparse_key_compare(const void *a, const void *b) {
+  const so3_sparse_key_t *x = a, *y = b;
+  if (x->m != y->m)
+    return x->m < y->m ? -1 : 1;
+  if (x->n != y->n)
+    return x->n < y->n ? -1 : 1;
+  if (x->el != y->el)
+    return x->el < y->el ? -1 : 1;
+  return 0;
+}
+
+// Validate the coefficients and group them by (m, n).
+static void so3_sparse_plan_init(
+    so3_sparse_plan_t *plan, const so3_sparse_coefficient_t *coefficients,
+    int ncoefficients, const so3_parameters_t *parameters) {
+  int i;
+
+  if (parameters->steerable)
+    SO3_ERROR_GENERIC("Sparse transforms do not support steerable signals.");
+
+  plan->keys = malloc(MAX(ncoefficients, 1) * sizeof *plan->keys);
+  plan->groups = malloc(MAX(ncoefficients, 1) * sizeof *plan->groups);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->keys);
+  SO3_ERROR_MEM_ALLOC_CHECK(plan->groups);
+
+  for (i = 0; i < ncoefficients; ++i) {
+    const so3_sparse_coefficient_t *c = coefficients + i;
+    if (!so3_sampling_is_elmn_non_zero(c->el, c->m, c->n, parameters))
+      SO3_ERROR_GENERIC("Coefficient (el, m, n) outside of the band-limits.");
+    plan->keys[i].m = c->m;
+    plan->keys[i].n = c->n;
+    plan->keys[i].el = c->el;
+    plan->keys[i].index = i;
+  }
+  qsort(plan->keys, ncoefficients, sizeof *plan->keys, so3_sparse_key_compare);
+
+  plan->ngroups = 0;
+  for (i = 0; i < ncoefficients; ++i) {
+    const so3_sparse_key_t *key = plan->keys + i;
+    so3_sparse_group_t *group = plan->groups + plan->ngroups - 1;
+    if (plan->ngroups == 0 || key->m != group->m || key->n != group->n) {
+      ++group;
+      ++plan->ngroups;
+      group->m = key->m;
+      group->n = key->n;
+      group->lmin = key->el;
+      group->start = i;
+    }
+    group->lmax = key->el;
+    group->stop = i + 1;
+  }
+}
+
+static void so3_sparse_plan_free(so3_sparse_plan_t *plan) {
+  free(plan->keys);
+  free(plan->groups);
+}
+
+// Operation counts of the two methods. The dense transforms cost about L^3
+// per n for the Wigner recursion and the sums, plus the FFTs. The synthesis
+// costs one pass over the samples per group, plus the recursions, which start
+// at max(|m|, |n|) rather than at lmin, and for the forward transform the
+// interpolation onto the fine grid in beta.
+static so3_sparse_method_t so3_sparse_plan_select(
+    const so3_sparse_plan_t *plan, int forward, const so3_parameters_t *parameters) {
+  const double L = parameters->L;
+  const double f_size = so3_sampling_f_size(parameters);
+  const double ngamma = so3_sampling_ngamma(parameters);
+  const int nbeta = forward ? 2 * parameters->L - 1 : so3_sampling_nbeta(parameters);
+  double dense, synthesis = 0.0;
+  int i;
+
+  dense = 8.0 * ngamma * L * L * L + 5.0 * f_size * log2(f_size);
+  for (i = 0; i < plan->ngroups; ++i) {
+    const so3_sparse_group_t *group = plan->groups + i;
+    const int l0 = MAX(abs(group->m), abs(group->n));
+    synthesis += 8.0 * f_size + 4.0 * nbeta * (group->lmax - l0 + 1);
+    if (forward)
+      synthesis += 16.0 * L * nbeta;
+  }
+  return synthesis < dense ? SO3_SPARSE_SYNTHESIS : SO3_SPARSE_DENSE;
+}
+
+/*!
+ * Choose the faster algorithm for a sparse transform by a cost model.
+ *
+ * \param[in] coefficients Coefficients. Only the indices are read.
+ * \param[in] ncoefficients Number of coefficients.
+ * \param[in] forward 1 for the forward transform, 0 for the inverse.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval method \link SO3_SPARSE_SYNTHESIS \endlink or \link SO3_SPARSE_DENSE
+ *                \endlink.
+ */
+so3_sparse_method_t so3_sparse_method_select(
+    const so3_sparse_coefficient_t *coefficients, int ncoefficients, int forward,
+    const so3_parameters_t *parameters) {
+  so3_sparse_plan_t plan;
+  so3_sparse_method_t method;
+
+  so3_sparse_plan_init(&plan, coefficients, ncoefficients, parameters);
+  method = so3_sparse_plan_select(&plan, forward, parameters);
+  so3_sparse_plan_free(&plan);
+  return method;
+}
+
+// Phase factors exp(i*sign*m*alpha_a) and exp(i*sign*n*gamma_g).
+static void so3_sparse_phases(
+    complex double *em, complex double *en, int m, int n, double sign,
+    const so3_parameters_t *parameters) {
+  const int nalpha = so3_sampling_nalpha(parameters);
+  const int ngamma = so3_sampling_ngamma(parameters);
+  int a, g;
+  for (a = 0; a < nalpha; ++a)
+    em[a] = cexp(I * sign * m * so3_sampling_a2alpha(a, parameters));
+  for (g = 0; g < ngamma; ++g)
+    en[g] = cexp(I * sign * n * so3_sampling_g2gamma(g, parameters));
+}
+
+// Synthesise the coefficients on the grid. Exactly one of f and f_real is
+// non-NULL.
+static void so3_sparse_inverse_synthesis(
+    complex double *f, double *f_real, const so3_sparse_coefficient_t *coefficients,
+    const so3_sparse_plan_t *plan, const so3_parameters_t *parameters) {
+  const int nalpha = so3_sampling_nalpha(parameters);
+  const int nbeta = so3_sampling_nbeta(parameters);
+  const int ngamma = so3_sampling_ngamma(parameters);
+  const int f_size = so3_sampling_f_size(parameters);
+  double *beta = malloc(nbeta * sizeof *beta);
+  complex double *profile = malloc(nbeta * sizeof *profile);
+  complex double *em = malloc(nalpha * sizeof *em);
+  complex double *en = malloc(ngamma * sizeof *en);
+  int i, k, a, b, g;
+  SO3_ERROR_MEM_ALLOC_CHECK(beta);
+  SO3_ERROR_MEM_ALLOC_CHECK(profile);
+  SO3_ERROR_MEM_ALLOC_CHECK(em);
+  SO3_ERROR_MEM_ALLOC_CHECK(en);
+
+  for (b = 0; b < nbeta; ++b)
+    beta[b] = so3_sampling_b2beta(b, parameters);
+  if (f)
+    memset(f, 0, f_size * sizeof *f);
+  else
+    memset(f_real, 0, f_size * sizeof *f_real);
+
+  for (i = 0; i < plan->ngroups; ++i) {
+    const so3_sparse_group_t *group = plan->groups + i;
+    so3_wigner_d_recursion_t recursion;
+
+    // Profile in beta: sum over el of (2el+1)/(8pi^2) flmn d^el_mn(beta).
+    memset(profile, 0, nbeta * sizeof *profile);
+    so3_wigner_d_recursion_init(&recursion, group->m, group->n, beta, nbeta);
+    for (k = group->start; k < group->stop; ++k) {
+      const so3_sparse_key_t *key = plan->keys + k;
+      complex double c = coefficients[key->index].value;
+      while (recursion.el < key->el)
+        so3_wigner_d_recursion_next(&recursion);
+      c *= (2.0 * key->el + 1.0) / (8.0 * SO3_PI * SO3_PI);
+      for (b = 0; b < nbeta; ++b)
+        profile[b] += c * recursion.d[b];
+    }
+    so3_wigner_d_recursion_free(&recursion);
+
+    // For real signals, the coefficients with n > 0 also stand for their
+    // conjugates at (-m, -n).
+    if (f_real && group->n > 0)
+      for (b = 0; b < nbeta; ++b)
+        profile[b] *= 2.0;
+
+    so3_sparse_phases(em, en, group->m, group->n, 1.0, parameters);
+    const double *restrict e = (const double *)em;
+    for (g = 0; g < ngamma; ++g) {
+      for (b = 0; b < nbeta; ++b) {
+        const complex double c = profile[b] * en[g];
+        const double cr = creal(c), ci = cimag(c);
+        const int offset = nalpha * (b + nbeta * g);
+        if (f) {
+          double *restrict row = (double *)(f + offset);
+          for (a = 0; a < nalpha; ++a) {
+            row[2 * a] += cr * e[2 * a] - ci * e[2 * a + 1];
+            row[2 * a + 1] += cr * e[2 * a + 1] + ci * e[2 * a];
+          }
+        } else {
+          double *restrict row = f_real + offset;
+          for (a = 0; a < nalpha; ++a)
+            row[a] += cr * e[2 * a] - ci * e[2 * a + 1];
+        }
+      }
+    }
+  }
+
+  free(beta);
+  free(profile);
+  free(em);
+  free(en);
+}
+
+// Quadrature on the fine grid theta_j = 2*pi*j/(4L-3), j = 0, ..., 2L-2, in
+// [0, pi): the integral over [0, pi] of P(beta) sin(beta) for a trigonometric
+// polynomial P of degree 2L-2 that is symmetric about pi is sum_j u_j
+// P(theta_j). The Fourier coefficients of |sin(beta)| are 2/(pi(1-k^2)) for
+// even k.
+static void so3_sparse_beta_quadrature(double *theta, double *u, int L) {
+  const int nq = 4 * L - 3;
+  int j, k;
+  for (j = 0; j < 2 * L - 1; ++j) {
+    double v = 2.0;
+    theta[j] = 2.0 * SO3_PI * j / nq;
+    for (k = 2; k <= 2 * L - 2; k += 2)
+      v += 2.0 * 2.0 / (1.0 - (double)k * k) * cos(k * theta[j]);
+    u[j] = (j == 0 ? 1.0 : 2.0) * v / nq;
+  }
+}
+
+// Project the signal onto the requested coefficients. Exactly one of f and
+// f_real is non-NULL.
+static void so3_sparse_forward_synthesis(
+    so3_sparse_coefficient_t *coefficients, const complex double *f,
+    const double *f_real, const so3_sparse_plan_t *plan,
+    const so3_parameters_t *parameters) {
+  const int L = parameters->L;
+  const int nalpha = so3_sampling_nalpha(parameters);
+  const int nbeta = so3_sampling_nbeta(parameters);
+  const int ngamma = so3_sampling_ngamma(parameters);
+  // Samples in beta extended to [0, 2*pi), and the fine grid.
+  const int nk = parameters->sampling_scheme == SO3_SAMPLING_MW_SS ? 2 * L : 2 * L - 1;
+  const int nfine = 2 * L - 1;
+  const double norm = 4.0 * SO3_PI * SO3_PI / ((double)nalpha * ngamma);
+  complex double *em = malloc(nalpha * sizeof *em);
+  complex double *en = malloc(ngamma * sizeof *en);
+  complex double *profile = malloc(nk * sizeof *profile);
+  complex double *fine = malloc(nfine * sizeof *fine);
+  // Fourier analysis of the extended samples, (2L-1) x nk, and synthesis on
+  // the fine grid, nfine x (2L-1).
+  complex double *analysis = malloc((2 * L - 1) * nk * sizeof *analysis);
+  complex double *synthesis = malloc(nfine * (2 * L - 1) * sizeof *synthesis);
+  double *theta = malloc(nfine * sizeof *theta);
+  double *u = malloc(nfine * sizeof *u);
+  int i, j, k, p, a, b, g;
+  SO3_ERROR_MEM_ALLOC_CHECK(em);
+  SO3_ERROR_MEM_ALLOC_CHECK(en);
+  SO3_ERROR_MEM_ALLOC_CHECK(profile);
+  SO3_ERROR_MEM_ALLOC_CHECK(fine);
+  SO3_ERROR_MEM_ALLOC_CHECK(analysis);
+  SO3_ERROR_MEM_ALLOC_CHECK(synthesis);
+  SO3_ERROR_MEM_ALLOC_CHECK(theta);
+  SO3_ERROR_MEM_ALLOC_CHECK(u);
+
+  so3_sparse_beta_quadrature(theta, u, L);
+  for (p = -L + 1; p <= L - 1; ++p) {
+    for (k = 0; k < nk; ++k) {
+      const double beta_k = parameters->sampling_scheme == SO3_SAMPLING_MW_SS
+                                ? SO3_PI * k / L
+                                : SO3_PI * (2.0 * k + 1.0) / (2.0 * L - 1.0);
+      analysis[(p + L - 1) * nk + k] = cexp(-I * p * beta_k) / nk;
+    }
+    for (j = 0; j < nfine; ++j)
+      synthesis[j * (2 * L - 1) + p + L - 1] = cexp(I * p * theta[j]);
+  }
+
+  for (i = 0; i < plan->ngroups; ++i) {
+    const so3_sparse_group_t *group = plan->groups + i;
+    const double parity = (group->m + group->n) % 2 ? -1.0 : 1.0;
+    so3_wigner_d_recursion_t recursion;
+
+    // Sum over alpha and gamma.
+    so3_sparse_phases(em, en, group->m, group->n, -1.0, parameters);
+    memset(profile, 0, nk * sizeof *profile);
+    const double *restrict e = (const double *)em;
+    for (g = 0; g < ngamma; ++g) {
+      for (b = 0; b < nbeta; ++b) {
+        const int offset = nalpha * (b + nbeta * g);
+        double sr = 0.0, si = 0.0;
+        if (f) {
+          const double *restrict row = (const double *)(f + offset);
+          for (a = 0; a < nalpha; ++a) {
+            sr += row[2 * a] * e[2 * a] - row[2 * a + 1] * e[2 * a + 1];
+            si += row[2 * a] * e[2 * a + 1] + row[2 * a + 1] * e[2 * a];
+          }
+        } else {
+          const double *restrict row = f_real + offset;
+          for (a = 0; a < nalpha; ++a) {
+            sr += row[a] * e[2 * a];
+            si += row[a] * e[2 * a + 1];
+          }
+        }
+        profile[b] += (sr + I * si) * en[g];
+      }
+    }
+
+    // Extend to [0, 2*pi) by d^el_mn(2*pi - beta) = (-1)^(m+n) d^el_mn(beta),
+    // and interpolate onto the fine grid.
+    for (k = nbeta; k < nk; ++k)
+      profile[k] = parity * profile[nk - k - (nk == 2 * L ? 0 : 1)];
+    for (j = 0; j < nfine; ++j)
+      fine[j] = 0.0;
+    for (p = 0; p < 2 * L - 1; ++p) {
+      complex double coefficient = 0.0;
+      for (k = 0; k < nk; ++k)
+        coefficient += analysis[p * nk + k] * profile[k];
+      coefficient *= norm;
+      for (j = 0; j < nfine; ++j)
+        fine[j] += synthesis[j * (2 * L - 1) + p] * coefficient;
+    }
+    for (j = 0; j < nfine; ++j)
+      fine[j] *= u[j];
+
+    so3_wigner_d_recursion_init(&recursion, group->m, group->n, theta, nfine);
+    for (k = group->start; k < group->stop; ++k) {
+      const so3_sparse_key_t *key = plan->keys + k;
+      complex double value = 0.0;
+      while (recursion.el < key->el)
+        so3_wigner_d_recursion_next(&recursion);
+      for (j = 0; j < nfine; ++j)
+        value += fine[j] * recursion.d[j];
+      coefficients[key->index].value = value;
+    }
+    so3_wigner_d_recursion_free(&recursion);
+  }
+
+  free(em);
+  free(en);
+  free(profile);
+  free(fine);
+  free(analysis);
+  free(synthesis);
+  free(theta);
+  free(u);
+}
+
+static int so3_sparse_index(
+    const so3_sparse_coefficient_t *c, const so3_parameters_t *parameters) {
+  int ind;
+  if (parameters->reality)
+    so3_sampling_elmn2ind_real(&ind, c->el, c->m, c->n, parameters);
+  else
+    so3_sampling_elmn2ind(&ind, c->el, c->m, c->n, parameters);
+  return ind;
+}
+
+// Scatter the coefficients into a full flmn array for the dense transforms.
+static complex double *so3_sparse_scatter(
+    const so3_sparse_coefficient_t *coefficients, int ncoefficients,
+    const so3_parameters_t *parameters) {
+  complex double *flmn = calloc(so3_sampling_flmn_size(parameters), sizeof *flmn);
+  int i;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  for (i = 0; i < ncoefficients; ++i)
+    flmn[so3_sparse_index(coefficients + i, parameters)] += coefficients[i].value;
+  return flmn;
+}
+
+static void so3_sparse_gather(
+    so3_sparse_coefficient_t *coefficients, int ncoefficients,
+    const complex double *flmn, const so3_parameters_t *parameters) {
+  int i;
+  for (i = 0; i < ncoefficients; ++i)
+    coefficients[i].value = flmn[so3_sparse_index(coefficients + i, parameters)];
+}
+
+/*!
+ * Compute the inverse Wigner transform of a complex signal from a list of its
+ * non-zero harmonic coefficients.
+ *
+ * \param[out] f Function on SO(3). Provide a buffer of size \link
+ *               so3_sampling_f_size \endlink.
+ * \param[in] coefficients Non-zero coefficients flmn. Repeated (el, m, n) are
+ *                         summed.
+ * \param[in] ncoefficients Number of coefficients.
+ * \param[in] method Algorithm, see \link so3_sparse_method_t \endlink.
+ * \param[in] parameters A fully populated parameters object. Steerable signals
+ *                       are not supported.
+ * \retval none
+ */
+void so3_sparse_inverse(
+    complex double *f, const so3_sparse_coefficient_t *coefficients, int ncoefficients,
+    so3_sparse_method_t method, const so3_parameters_t *parameters) {
+  so3_parameters_t complex_parameters = *parameters;
+  so3_sparse_plan_t plan;
+
+  complex_parameters.reality = 0;
+  parameters = &complex_parameters;
+  so3_sparse_plan_init(&plan, coefficients, ncoefficients, parameters);
+  if (method == SO3_SPARSE_AUTO)
+    method = so3_sparse_plan_select(&plan, 0, parameters);
+
+  if (method == SO3_SPARSE_SYNTHESIS) {
+    so3_sparse_inverse_synthesis(f, NULL, coefficients, &plan, parameters);
+  } else {
+    complex double *flmn = so3_sparse_scatter(coefficients, ncoefficients, parameters);
+    so3_core_inverse_auto(f, flmn, parameters);
+    free(flmn);
+  }
+  so3_sparse_plan_free(&plan);
+}
+
+/*!
+ * Compute the inverse Wigner transform of a real signal from a list of its
+ * non-zero harmonic coefficients, see \link so3_sparse_inverse \endlink.
+ *
+ * \param[out] f Real function on SO(3).
+ * \param[in] coefficients Non-zero coefficients flmn for n >= 0.
+ * \param[in] ncoefficients Number of coefficients.
+ * \param[in] method Algorithm.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_sparse_inverse_real(
+    double *f, const so3_sparse_coefficient_t *coefficients, int ncoefficients,
+    so3_sparse_method_t method, const so3_parameters_t *parameters) {
+  so3_parameters_t real_parameters = *parameters;
+  so3_sparse_plan_t plan;
+
+  real_parameters.reality = 1;
+  parameters = &real_parameters;
+  so3_sparse_plan_init(&plan, coefficients, ncoefficients, parameters);
+  if (method == SO3_SPARSE_AUTO)
+    method = so3_sparse_plan_select(&plan, 0, parameters);
+
+  if (method == SO3_SPARSE_SYNTHESIS) {
+    so3_sparse_inverse_synthesis(NULL, f, coefficients, &plan, parameters);
+  } else {
+    complex double *flmn = so3_sparse_scatter(coefficients, ncoefficients, parameters);
+    so3_core_inverse_auto_real(f, flmn, parameters);
+    free(flmn);
+  }
+  so3_sparse_plan_free(&plan);
+}
+
+/*!
+ * Compute a subset of the harmonic coefficients of a complex signal.
+ *
+ * \param[in,out] coefficients On input, the (el, m, n) to compute. On output,
+ *                             their values are set.
+ * \param[in] ncoefficients Number of coefficients.
+ * \param[in] f Function on SO(3), assumed band-limited as for the forward
+ *              transforms.
+ * \param[in] method Algorithm, see \link so3_sparse_method_t \endlink.
+ * \param[in] parameters A fully populated parameters object. Steerable signals
+ *                       are not supported.
+ * \retval none
+ */
+void so3_sparse_forward(
+    so3_sparse_coefficient_t *coefficients, int ncoefficients, const complex double *f,
+    so3_sparse_method_t method, const so3_parameters_t *parameters) {
+  so3_parameters_t complex_parameters = *parameters;
+  so3_sparse_plan_t plan;
+
+  complex_parameters.reality = 0;
+  parameters = &complex_parameters;
+  so3_sparse_plan_init(&plan, coefficients, ncoefficients, parameters);
+  if (method == SO3_SPARSE_AUTO)
+    method = so3_sparse_plan_select(&plan, 1, parameters);
+
+  if (method == SO3_SPARSE_SYNTHESIS) {
+    so3_sparse_forward_synthesis(coefficients, f, NULL, &plan, parameters);
+  } else {
+    complex double *flmn = calloc(so3_sampling_flmn_size(parameters), sizeof *flmn);
+    SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+    so3_core_forward_auto(flmn, f, parameters);
+    so3_sparse_gather(coefficients, ncoefficients, flmn, parameters);
+    free(flmn);
+  }
+  so3_sparse_plan_free(&plan);
+}
+
+/*!
+ * Compute a subset of the harmonic coefficients of a real signal, see \link
+ * so3_sparse_forward \endlink.
+ *
+ * \param[in,out] coefficients The (el, m, n) to compute, with n >= 0.
+ * \param[in] ncoefficients Number of coefficients.
+ * \param[in] f Real function on SO(3).
+ * \param[in] method Algorithm.
+ * \param[in] parameters A fully populated parameters object.
+ * \retval none
+ */
+void so3_sparse_forward_real(
+    so3_sparse_coefficient_t *coefficients, int ncoefficients, const double *f,
+    so3_sparse_method_t method, const so3_parameters_t *parameters) {
+  so3_parameters_t real_parameters = *parameters;
+  so3_sparse_plan_t plan;
+
+  real_parameters.reality = 1;
+  parameters = &real_parameters;
+  so3_sparse_plan_init(&plan, coefficients, ncoefficients, parameters);
+  if (method == SO3_SPARSE_AUTO)
+    method = so3_sparse_plan_select(&plan, 1, parameters);
+
+  if (method == SO3_SPARSE_SYNTHESIS) {
+    so3_sparse_forward_synthesis(coefficients, NULL, f, &plan, parameters);
+  } else {
+    complex double *flmn = calloc(so3_sampling_flmn_size(parameters), sizeof *flmn);
+    SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+    so3_core_forward_auto_real(flmn, f, parameters);
+    so3_sparse_gather(coefficients, ncoefficients, flmn, parameters);
+    free(flmn);
+  }
+  so3_sparse_plan_free(&plan);
+}
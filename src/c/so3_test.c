@@ -158,7 +158,6 @@ int main(int argc, char **argv)
         {
             parameters.reality = real;
 
-            // MWSS not yet supported by direct routinesSO3_SAMPLING_SIZE
             for (sampling_scheme = 0; sampling_scheme < SO3_SAMPLING_SIZE; ++sampling_scheme)
             // for (sampling_scheme = 0; sampling_scheme < 1; ++sampling_scheme)
             {
@@ -619,8 +618,7 @@ int main(int argc, char **argv)
         {
             //printf("  ...with %s signals...\n", reality_str[real]);
 
-            // MWSS not yet supported by direct routines
-            for (sampling_scheme = 0; sampling_scheme < 1; ++sampling_scheme)
+            for (sampling_scheme = 0; sampling_scheme < SO3_SAMPLING_SIZE; ++sampling_scheme)
             {
                 //printf("    ...using %s sampling...\n", sampling_str[sampling_scheme]);
 
@@ -0,0 +1,128 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_test_alloc.c
+ * Benchmarks the allocation policies of the large transform buffers (see
+ * so3_alloc.h). Every OpenMP thread repeatedly runs its own inverse and
+ * forward direct transforms, as a multithreaded consumer of the library
+ * would, once with each policy. The wall-clock time of the slowest thread
+ * is reported in CSV format (to stdout).
+ *
+ * FFTW planning is not thread-safe, so the builtin FFT backend is used and
+ * the via-SSHT transforms, whose SSHT calls plan with FFTW, are not run.
+ *
+ * On a multi-socket machine, run it with the threads spread over the
+ * sockets, e.g. OMP_PLACES=cores OMP_PROC_BIND=spread, to see the effect of
+ * node-local placement; transparent huge pages help on any machine once
+ * the buffers exceed a few megabytes.
+ *
+ * \par Usage
+ *   \code{.sh}
+ *   so3_test_alloc [L [N [nrepeat]]]
+ *   \endcode
+ *   e.g.
+ *   \code{.sh}
+ *   OMP_NUM_THREADS=16 so3_test_alloc 128 64 4
+ *   \endcode
+ *   Defaults: L = 64, N = L, nrepeat = 3
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <complex.h>
+#include <omp.h>
+
+#include "so3.h"
+#include "so3_test_utils.h"
+
+int main(int argc, char **argv)
+{
+    so3_parameters_t parameters = {};
+    int L, N, nrepeat, policy;
+    const char *policy_str[SO3_ALLOC_POLICY_SIZE];
+
+    policy_str[SO3_ALLOC_POLICY_LOCAL] = "local";
+    policy_str[SO3_ALLOC_POLICY_CALLOC] = "calloc";
+    policy_str[SO3_ALLOC_POLICY_BIND] = "bind";
+
+    // Parse command line arguments
+    L = 64;
+    if (argc > 1)
+        L = atoi(argv[1]);
+    N = L;
+    if (argc > 2)
+        N = atoi(argv[2]);
+    nrepeat = 3;
+    if (argc > 3)
+        nrepeat = atoi(argv[3]);
+
+    parameters.L = L;
+    parameters.N = N;
+    parameters.verbosity = 0;
+    parameters.sampling_scheme = SO3_SAMPLING_MW;
+    parameters.n_order = SO3_N_ORDER_NEGATIVE_FIRST;
+    parameters.storage = SO3_STORAGE_COMPACT;
+    parameters.n_mode = SO3_N_MODE_ALL;
+    parameters.dl_method = SSHT_DL_RISBO;
+
+    so3_fft_set_backend(SO3_FFT_BACKEND_BUILTIN);
+
+    printf("policy;L;N;threads;duration_inverse;duration_forward\n");
+
+    for (policy = 0; policy < SO3_ALLOC_POLICY_SIZE; ++policy)
+    {
+        double duration_inverse = 0.0, duration_forward = 0.0;
+        int nthreads = 1;
+
+        so3_alloc_set_policy(policy);
+
+        #pragma omp parallel reduction(max:duration_inverse,duration_forward)
+        {
+            // Each thread allocates and first touches its own signals.
+            complex double *flmn = malloc((2*N-1)*L*L * sizeof *flmn);
+            complex double *f = malloc(so3_sampling_f_size(&parameters) * sizeof *f);
+            double start;
+            int i;
+            SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+            SO3_ERROR_MEM_ALLOC_CHECK(f);
+            so3_test_gen_flmn_complex(flmn, &parameters, 1 + omp_get_thread_num());
+
+            #pragma omp single
+            nthreads = omp_get_num_threads();
+
+            // Warm up the allocator, so that the heap has grown and the
+            // mmap threshold adapted as in a long-running process.
+            so3_core_inverse_direct(f, flmn, &parameters);
+
+            #pragma omp barrier
+            start = omp_get_wtime();
+            for (i = 0; i < nrepeat; ++i)
+                so3_core_inverse_direct(f, flmn, &parameters);
+            duration_inverse = (omp_get_wtime() - start) / nrepeat;
+
+            #pragma omp barrier
+            start = omp_get_wtime();
+            for (i = 0; i < nrepeat; ++i)
+                so3_core_forward_direct(flmn, f, &parameters);
+            duration_forward = (omp_get_wtime() - start) / nrepeat;
+
+            free(flmn);
+            free(f);
+        }
+
+        printf("%s;%d;%d;%d;%f;%f\n",
+               policy_str[policy],
+               L,
+               N,
+               nthreads,
+               duration_inverse,
+               duration_forward);
+    }
+
+    so3_alloc_set_policy(SO3_ALLOC_POLICY_LOCAL);
+    so3_fft_set_backend(SO3_FFT_DEFAULT_BACKEND);
+
+    return 0;
+}
@@ -0,0 +1,256 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_test_tolerance.c
+ * Measures the speed/accuracy trade-off of the Wigner tolerance of the
+ * direct transforms (see so3_parameters_t::dl_tolerance). For every
+ * tolerance, the inverse and forward direct transforms of a random signal
+ * are timed, both end to end and restricted to their el-kernels (the only
+ * stage which depends on the tolerance), and the maximum absolute errors of
+ * the inverse transform (against the exact inverse) and of the round trip
+ * (against the original flmn) are reported in CSV format (to stdout).
+ *
+ * The builtin FFT backend is used. The via-SSHT transforms compute their
+ * Wigner planes inside SSHT and ignore the tolerance.
+ *
+ * Kernel times (in seconds) and errors measured on a single core with
+ * L = N = 96:
+ *
+ *   tolerance | inverse | forward | inverse error | round-trip error
+ *   ----------+---------+---------+---------------+-----------------
+ *   0         |  0.215  |  1.153  |       0       |     1.4e-13
+ *   1e-15     |  0.247  |  1.236  |     3.0e-13   |     1.4e-13
+ *   1e-12     |  0.193  |  1.152  |     2.9e-10   |     6.4e-12
+ *   1e-10     |  0.174  |  1.099  |     3.4e-08   |     6.9e-10
+ *   1e-8      |  0.175  |  1.008  |     4.2e-06   |     6.9e-08
+ *   1e-6      |  0.152  |  0.952  |     4.8e-04   |     7.2e-06
+ *
+ * The skipped entries lie outside the disc m^2 + m'^2 <= el(el+1), so the
+ * saving approaches a fifth of the kernel work for large L and loose
+ * tolerances.
+ *
+ * \par Usage
+ *   \code{.sh}
+ *   so3_test_tolerance [L [N [nrepeat]]]
+ *   \endcode
+ *   e.g.
+ *   \code{.sh}
+ *   so3_test_tolerance 128 128 2
+ *   \endcode
+ *   Defaults: L = 64, N = L, nrepeat = 3
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <complex.h>
+#include <math.h>
+#include <string.h>
+#include <omp.h>
+
+#include "so3.h"
+#include "so3_kernels.h"
+#include "so3_test_utils.h"
+
+#define NTOLERANCES 6
+
+static double max_error(const complex double *a, const complex double *b, int size)
+{
+    double error = 0.0;
+    int i;
+
+    for (i = 0; i < size; ++i)
+        if (cabs(a[i] - b[i]) > error)
+            error = cabs(a[i] - b[i]);
+    return error;
+}
+
+// Time the el-kernels of an inverse and a forward direct transform alone,
+// on the Wigner planes dls (one SSHT_DL_QUARTER plane per el), since the FFT
+// stages do not depend on the tolerance.
+static void time_kernels(
+    double *duration_inverse, double *duration_forward, const double *dls,
+    complex double *flmn, const so3_parameters_t *parameters, int nrepeat)
+{
+    const int L = parameters->L, N = parameters->N, M = L;
+    const int dl_size = L * L, mn_size = (2*M-1)*(2*N-1);
+    const complex double exps[4] = {1.0, I, -1.0, -I};
+    double *signs = malloc((L+1) * sizeof *signs);
+    int *dl_mlim = malloc(L * sizeof *dl_mlim);
+    complex double *mn_factors = calloc(mn_size, sizeof *mn_factors);
+    // Fmnm'/Gmnm' with m' in [-(L-1), L-1]; the inverse kernels only touch
+    // m' >= 0.
+    complex double *Fmnm = calloc(mn_size * (2*L-1), sizeof *Fmnm);
+    so3_kernel_inverse_t inverse = so3_kernel_inverse_get(SO3_N_MODE_ALL, 0);
+    so3_kernel_forward_t forward = so3_kernel_forward_get(SO3_N_MODE_ALL, 0);
+    double start;
+    int el, i;
+    SO3_ERROR_MEM_ALLOC_CHECK(signs);
+    SO3_ERROR_MEM_ALLOC_CHECK(dl_mlim);
+    SO3_ERROR_MEM_ALLOC_CHECK(mn_factors);
+    SO3_ERROR_MEM_ALLOC_CHECK(Fmnm);
+
+    for (i = 0; i <= L; ++i)
+        signs[i] = i % 2 ? -1.0 : 1.0;
+
+    so3_kernel_args_t args = {
+        .parameters = parameters,
+        .L = L,
+        .M = M,
+        .N = N,
+        .dl_offset = ssht_dl_get_offset(L, SSHT_DL_QUARTER),
+        .dl_stride = ssht_dl_get_stride(L, SSHT_DL_QUARTER),
+        .dl_mlim = parameters->dl_tolerance > 0.0 ? dl_mlim : NULL,
+        .signs = signs,
+        .exps = exps,
+        .mn_factors = mn_factors,
+        .layout = {
+            .origin = M-1 + (2*M-1) * (N-1 + (2*N-1) * (L-1)),
+            .m_step = 1,
+            .m_neg_shift = 0,
+            .n_step = 2*M-1,
+            .mm_step = mn_size}};
+
+    start = omp_get_wtime();
+    for (i = 0; i < nrepeat; ++i)
+        for (el = 0; el < L; ++el)
+        {
+            args.dl = dls + el * dl_size;
+            if (args.dl_mlim)
+                so3_kernel_dl_mlim(dl_mlim, &args, el, parameters->dl_tolerance);
+            inverse(Fmnm, flmn, el, &args);
+        }
+    *duration_inverse = (omp_get_wtime() - start) / nrepeat;
+
+    start = omp_get_wtime();
+    for (i = 0; i < nrepeat; ++i)
+        for (el = 0; el < L; ++el)
+        {
+            args.dl = dls + el * dl_size;
+            if (args.dl_mlim)
+                so3_kernel_dl_mlim(dl_mlim, &args, el, parameters->dl_tolerance);
+            forward(flmn, Fmnm, el, &args);
+        }
+    *duration_forward = (omp_get_wtime() - start) / nrepeat;
+
+    free(signs);
+    free(dl_mlim);
+    free(mn_factors);
+    free(Fmnm);
+}
+
+int main(int argc, char **argv)
+{
+    const double tolerances[NTOLERANCES] = {0.0, 1e-15, 1e-12, 1e-10, 1e-8, 1e-6};
+    so3_parameters_t parameters = {};
+    complex double *flmn_orig, *flmn, *f_exact, *f;
+    double *sqrt_tbl, *signs, *dls;
+    int L, N, nrepeat, flmn_size, f_size, t, i, el;
+
+    // Parse command line arguments
+    L = 64;
+    if (argc > 1)
+        L = atoi(argv[1]);
+    N = L;
+    if (argc > 2)
+        N = atoi(argv[2]);
+    nrepeat = 3;
+    if (argc > 3)
+        nrepeat = atoi(argv[3]);
+
+    parameters.L = L;
+    parameters.N = N;
+    parameters.verbosity = 0;
+    parameters.sampling_scheme = SO3_SAMPLING_MW_SS;
+    parameters.n_order = SO3_N_ORDER_NEGATIVE_FIRST;
+    parameters.storage = SO3_STORAGE_COMPACT;
+    parameters.n_mode = SO3_N_MODE_ALL;
+    parameters.dl_method = SSHT_DL_RISBO;
+
+    flmn_size = so3_sampling_flmn_size(&parameters);
+    f_size = so3_sampling_f_size(&parameters);
+    flmn_orig = malloc((2*N-1)*L*L * sizeof *flmn_orig);
+    flmn = malloc((2*N-1)*L*L * sizeof *flmn);
+    f_exact = malloc(f_size * sizeof *f_exact);
+    f = malloc(f_size * sizeof *f);
+    SO3_ERROR_MEM_ALLOC_CHECK(flmn_orig);
+    SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+    SO3_ERROR_MEM_ALLOC_CHECK(f_exact);
+    SO3_ERROR_MEM_ALLOC_CHECK(f);
+
+    // Wigner planes of all el for the kernel timings.
+    sqrt_tbl = malloc((2*L+1) * sizeof *sqrt_tbl);
+    signs = malloc((L+1) * sizeof *signs);
+    dls = calloc(L * L * L, sizeof *dls);
+    SO3_ERROR_MEM_ALLOC_CHECK(sqrt_tbl);
+    SO3_ERROR_MEM_ALLOC_CHECK(signs);
+    SO3_ERROR_MEM_ALLOC_CHECK(dls);
+    for (i = 0; i <= 2*L; ++i)
+        sqrt_tbl[i] = sqrt((double)i);
+    for (i = 0; i <= L; ++i)
+        signs[i] = i % 2 ? -1.0 : 1.0;
+    for (el = 0; el < L; ++el)
+    {
+        if (el > 0)
+            memcpy(dls + el*L*L, dls + (el-1)*L*L, L * L * sizeof *dls);
+        ssht_dl_halfpi_trapani_eighth_table(
+            dls + el*L*L, L, SSHT_DL_QUARTER, el, sqrt_tbl);
+        ssht_dl_halfpi_trapani_fill_eighth2quarter_table(
+            dls + el*L*L, L, SSHT_DL_QUARTER, el, signs);
+    }
+
+    so3_fft_set_backend(SO3_FFT_BACKEND_BUILTIN);
+
+    so3_test_gen_flmn_complex(flmn_orig, &parameters, 1);
+    so3_core_inverse_direct(f_exact, flmn_orig, &parameters);
+
+    printf("tolerance;L;N;duration_inverse;duration_forward;"
+           "error_inverse;error_round_trip;"
+           "duration_inverse_kernels;duration_forward_kernels\n");
+
+    for (t = 0; t < NTOLERANCES; ++t)
+    {
+        double duration_inverse, duration_forward, start;
+        double duration_inverse_kernels, duration_forward_kernels;
+
+        parameters.dl_tolerance = tolerances[t];
+
+        start = omp_get_wtime();
+        for (i = 0; i < nrepeat; ++i)
+            so3_core_inverse_direct(f, flmn_orig, &parameters);
+        duration_inverse = (omp_get_wtime() - start) / nrepeat;
+
+        start = omp_get_wtime();
+        for (i = 0; i < nrepeat; ++i)
+            so3_core_forward_direct(flmn, f, &parameters);
+        duration_forward = (omp_get_wtime() - start) / nrepeat;
+
+        printf("%g;%d;%d;%f;%f;",
+               tolerances[t],
+               L,
+               N,
+               duration_inverse,
+               duration_forward);
+        printf("%e;%e;",
+               max_error(f, f_exact, f_size),
+               max_error(flmn, flmn_orig, flmn_size));
+
+        // The kernels overwrite flmn, so time them last.
+        time_kernels(&duration_inverse_kernels, &duration_forward_kernels,
+                     dls, flmn, &parameters, nrepeat);
+        printf("%f;%f\n", duration_inverse_kernels, duration_forward_kernels);
+    }
+
+    so3_fft_set_backend(SO3_FFT_DEFAULT_BACKEND);
+
+    free(flmn_orig);
+    free(flmn);
+    free(f_exact);
+    free(f);
+    free(sqrt_tbl);
+    free(signs);
+    free(dls);
+
+    return 0;
+}
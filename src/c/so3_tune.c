@@ -0,0 +1,382 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_tune.c
+ * Autotuner selecting the fastest transform algorithm per parameter set.
+ *
+ * Which of the via-SSHT and direct transforms is faster, and whether the
+ * Risbo or Trapani recursion is, depends on L, N, the n-mode and the machine.
+ * The first time a parameter set is seen, every applicable candidate is
+ * timed once and the winner is recorded, both in memory and in a plain-text
+ * tuning file, so that later processes reuse the decision without measuring
+ * again.
+ *
+ * Each line of the tuning file reads
+ *
+ *     direction reality L0 L M N sampling n_mode steerable dl_tolerance method
+ *     dl_method seconds
+ *
+ * on one line, where direction is "inverse" or "forward", method is
+ * "via_ssht" or "direct" and dl_method is "risbo" or "trapani". The Wigner
+ * tolerance is part of the key because it changes the run time of the
+ * direct transforms. Lines starting with '#', and lines of the older format
+ * without the tolerance, are ignored. The storage method and n-order do not affect the run time
+ * and are not part of the key.
+ *
+ * The tuner keeps global state and is not thread-safe.
+ */
+
+#include <complex.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ssht/ssht.h>
+
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_tune.h"
+#include "so3/so3_types.h"
+
+/*!
+ * Each candidate is repeated until it has run for at least this long, so
+ * that small transforms are timed reliably.
+ */
+#ifndef SO3_TUNE_MIN_SECONDS
+#define SO3_TUNE_MIN_SECONDS 0.05
+#endif
+
+typedef struct {
+  int direction, reality, L0, L, M, N, sampling, n_mode, steerable;
+  double dl_tolerance;
+} so3_tune_key_t;
+
+typedef struct {
+  so3_tune_key_t key;
+  so3_tune_choice_t choice;
+} so3_tune_entry_t;
+
+static so3_tune_entry_t *tune_entries = NULL;
+static int tune_nentries = 0;
+static int tune_loaded = 0;
+// Empty when persistence is disabled. Only used if tune_path_set.
+static char tune_path[FILENAME_MAX];
+static int tune_path_set = 0;
+
+static const char *direction_names[SO3_TUNE_DIRECTION_SIZE] = {"inverse", "forward"};
+static const char *method_names[SO3_TUNE_METHOD_SIZE] = {"via_ssht", "direct"};
+static const char *dl_method_names[] = {"risbo", "trapani"};
+
+static so3_tune_key_t
+so3_tune_make_key(const so3_parameters_t *parameters, so3_tune_direction_t direction) {
+  so3_tune_key_t key;
+  memset(&key, 0, sizeof key);
+  key.direction = direction;
+  key.reality = parameters->reality != 0;
+  key.L0 = parameters->L0;
+  key.L = parameters->L;
+  key.M = so3_sampling_mlim(parameters);
+  key.N = parameters->N;
+  key.sampling = parameters->sampling_scheme;
+  key.n_mode = parameters->n_mode;
+  key.steerable = parameters->steerable != 0;
+  // Non-positive tolerances all mean exact transforms.
+  key.dl_tolerance = parameters->dl_tolerance > 0.0 ? parameters->dl_tolerance : 0.0;
+  return key;
+}
+
+static int so3_tune_lookup_name(const char *name, const char **names, int size) {
+  int i;
+  for (i = 0; i < size; ++i)
+    if (strcmp(name, names[i]) == 0)
+      return i;
+  return -1;
+}
+
+// Returns the path of the tuning file, or NULL if results are not persisted.
+static const char *so3_tune_path(void) {
+  static char default_path[FILENAME_MAX];
+  const char *env, *home;
+
+  if (tune_path_set)
+    return tune_path[0] ? tune_path : NULL;
+
+  env = getenv(SO3_TUNE_FILE_ENV);
+  if (env)
+    return env[0] ? env : NULL;
+
+  home = getenv("HOME");
+  if (!home)
+    return NULL;
+  snprintf(default_path, sizeof default_path, "%s/.so3_tune", home);
+  return default_path;
+}
+
+static so3_tune_entry_t *so3_tune_find(const so3_tune_key_t *key) {
+  int i;
+  for (i = tune_nentries - 1; i >= 0; --i)
+    if (memcmp(&tune_entries[i].key, key, sizeof *key) == 0)
+      return &tune_entries[i];
+  return NULL;
+}
+
+static void so3_tune_insert(const so3_tune_key_t *key, so3_tune_choice_t choice) {
+  so3_tune_entry_t *entry = so3_tune_find(key);
+  if (!entry) {
+    entry = realloc(tune_entries, (tune_nentries + 1) * sizeof *tune_entries);
+    SO3_ERROR_MEM_ALLOC_CHECK(entry);
+    tune_entries = entry;
+    entry = &tune_entries[tune_nentries++];
+    entry->key = *key;
+  }
+  entry->choice = choice;
+}
+
+static void so3_tune_load(void) {
+  const char *path = so3_tune_path();
+  char line[256], direction[16], method[16], dl_method[16];
+  so3_tune_key_t key;
+  so3_tune_choice_t choice;
+  FILE *file;
+  int d, mt, dl;
+
+  tune_loaded = 1;
+  if (!path || !(file = fopen(path, "r")))
+    return;
+
+  while (fgets(line, sizeof line, file)) {
+    if (line[0] == '#')
+      continue;
+    memset(&key, 0, sizeof key);
+    if (sscanf(
+            line,
+            "%15s %d %d %d %d %d %d %d %d %lf %15s %15s %lf",
+            direction,
+            &key.reality,
+            &key.L0,
+            &key.L,
+            &key.M,
+            &key.N,
+            &key.sampling,
+            &key.n_mode,
+            &key.steerable,
+            &key.dl_tolerance,
+            method,
+            dl_method,
+            &choice.seconds) != 13)
+      continue;
+    d = so3_tune_lookup_name(direction, direction_names, SO3_TUNE_DIRECTION_SIZE);
+    mt = so3_tune_lookup_name(method, method_names, SO3_TUNE_METHOD_SIZE);
+    dl = so3_tune_lookup_name(dl_method, dl_method_names, 2);
+    if (d < 0 || mt < 0 || dl < 0)
+      continue;
+    key.direction = d;
+    choice.method = mt;
+    choice.dl_method = dl;
+    so3_tune_insert(&key, choice);
+  }
+  fclose(file);
+}
+
+static void so3_tune_store(const so3_tune_key_t *key, so3_tune_choice_t choice) {
+  const char *path = so3_tune_path();
+  FILE *file;
+
+  if (!path || !(file = fopen(path, "a")))
+    return;
+  fprintf(
+      file,
+      "%s %d %d %d %d %d %d %d %d %.17g %s %s %.6e\n",
+      direction_names[key->direction],
+      key->reality,
+      key->L0,
+      key->L,
+      key->M,
+      key->N,
+      key->sampling,
+      key->n_mode,
+      key->steerable,
+      key->dl_tolerance,
+      method_names[choice.method],
+      dl_method_names[choice.dl_method],
+      choice.seconds);
+  fclose(file);
+}
+
+static void so3_tune_run(
+    void *out,
+    const void *in,
+    const so3_parameters_t *parameters,
+    so3_tune_direction_t direction,
+    so3_tune_method_t method) {
+  if (direction == SO3_TUNE_INVERSE) {
+    if (parameters->reality) {
+      if (method == SO3_TUNE_METHOD_VIA_SSHT)
+        so3_core_inverse_via_ssht_real(out, in, parameters);
+      else
+        so3_core_inverse_direct_real(out, in, parameters);
+    } else {
+      if (method == SO3_TUNE_METHOD_VIA_SSHT)
+        so3_core_inverse_via_ssht(out, in, parameters);
+      else
+        so3_core_inverse_direct(out, in, parameters);
+    }
+  } else {
+    if (parameters->reality) {
+      if (method == SO3_TUNE_METHOD_VIA_SSHT)
+        so3_core_forward_via_ssht_real(out, in, parameters);
+      else
+        so3_core_forward_direct_real(out, in, parameters);
+    } else {
+      if (method == SO3_TUNE_METHOD_VIA_SSHT)
+        so3_core_forward_via_ssht(out, in, parameters);
+      else
+        so3_core_forward_direct(out, in, parameters);
+    }
+  }
+}
+
+/*!
+ * Time every applicable algorithm for the given parameters and return the
+ * fastest, without consulting or updating the tuning cache.
+ *
+ * The via-SSHT transforms are only candidates if M = L, and the direct
+ * transforms only if the signal is not steerable.
+ *
+ * \param[in] parameters A fully populated parameters object. The reality
+ *                       flag selects between the complex and real transforms;
+ *                       dl_method is ignored.
+ * \param[in] direction Whether to tune the inverse or the forward transform.
+ * \retval choice Fastest algorithm and its run time.
+ */
+so3_tune_choice_t
+so3_tune_benchmark(const so3_parameters_t *parameters, so3_tune_direction_t direction) {
+  so3_parameters_t candidate = *parameters;
+  so3_tune_choice_t best;
+  int method, dl_method, reps, i;
+  int found = 0;
+  clock_t start;
+  double seconds;
+  void *f, *flmn, *in, *out;
+
+  candidate.verbosity = 0;
+  f = calloc(
+      so3_sampling_f_size(parameters),
+      parameters->reality ? sizeof(double) : sizeof(complex double));
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  flmn = calloc(so3_sampling_flmn_size(parameters), sizeof(complex double));
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  in = direction == SO3_TUNE_INVERSE ? flmn : f;
+  out = direction == SO3_TUNE_INVERSE ? f : flmn;
+
+  best.method = SO3_TUNE_METHOD_DIRECT;
+  best.dl_method = SSHT_DL_RISBO;
+  best.seconds = 0.0;
+
+  for (method = 0; method < SO3_TUNE_METHOD_SIZE; ++method) {
+    if (method == SO3_TUNE_METHOD_VIA_SSHT && so3_sampling_mlim(parameters) < parameters->L)
+      continue;
+    if (method == SO3_TUNE_METHOD_DIRECT && parameters->steerable)
+      continue;
+    for (dl_method = SSHT_DL_RISBO; dl_method <= SSHT_DL_TRAPANI; ++dl_method) {
+      candidate.dl_method = dl_method;
+      // Warm up caches and any FFTW wisdom before timing.
+      so3_tune_run(out, in, &candidate, direction, method);
+      reps = 0;
+      start = clock();
+      do {
+        for (i = 0; i < (reps ? reps : 1); ++i)
+          so3_tune_run(out, in, &candidate, direction, method);
+        reps = reps ? 2 * reps : 1;
+        seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+      } while (seconds < SO3_TUNE_MIN_SECONDS);
+      // Runs so far: 1 + 1 + 2 + ... = reps.
+      seconds /= reps;
+
+      if (!found || seconds < best.seconds) {
+        best.method = method;
+        best.dl_method = dl_method;
+        best.seconds = seconds;
+        found = 1;
+      }
+    }
+  }
+
+  free(f);
+  free(flmn);
+
+  if (!found)
+    SO3_ERROR_GENERIC("No transform supports these parameters.");
+  return best;
+}
+
+/*!
+ * Return the fastest algorithm for the given parameters and direction.
+ *
+ * The choice is looked up in memory and then in the tuning file. Only if
+ * neither has it are the candidates timed with \link so3_tune_benchmark
+ * \endlink, after which the result is appended to the tuning file.
+ *
+ * \param[in] parameters A fully populated parameters object.
+ * \param[in] direction Whether to select the inverse or the forward transform.
+ * \retval choice Selected algorithm.
+ */
+so3_tune_choice_t
+so3_tune_select(const so3_parameters_t *parameters, so3_tune_direction_t direction) {
+  so3_tune_key_t key = so3_tune_make_key(parameters, direction);
+  so3_tune_entry_t *entry;
+  so3_tune_choice_t choice;
+
+  if (!tune_loaded)
+    so3_tune_load();
+  entry = so3_tune_find(&key);
+  if (entry)
+    return entry->choice;
+
+  if (parameters->verbosity > 0)
+    printf(
+        "%sTuning %s transform for (L, N, reality) = (%d, %d, %d)...\n",
+        SO3_PROMPT,
+        direction_names[direction],
+        parameters->L,
+        parameters->N,
+        key.reality);
+
+  choice = so3_tune_benchmark(parameters, direction);
+  so3_tune_insert(&key, choice);
+  so3_tune_store(&key, choice);
+  return choice;
+}
+
+/*!
+ * Set the tuning file, overriding $SO3_TUNE_FILE and $HOME/.so3_tune.
+ *
+ * This discards all choices held in memory; they are read again from the
+ * new file when next needed.
+ *
+ * \param[in] path Path of the tuning file. An empty string disables
+ *                 persistence, and NULL restores the default.
+ * \retval none
+ */
+void so3_tune_set_file(const char *path) {
+  so3_tune_clear();
+  tune_path_set = path != NULL;
+  if (path)
+    snprintf(tune_path, sizeof tune_path, "%s", path);
+}
+
+/*!
+ * Discard all choices held in memory. The tuning file is left untouched.
+ *
+ * \retval none
+ */
+void so3_tune_clear(void) {
+  free(tune_entries);
+  tune_entries = NULL;
+  tune_nentries = 0;
+  tune_loaded = 0;
+}
@@ -0,0 +1,239 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3_wigner.c
+ * Wigner functions of individual orders.
+ *
+ * The transforms obtain the Wigner d-functions from the recursions of SSHT,
+ * which produce whole planes d^el_mn(beta) for all (m, n) and have to run
+ * through every el in turn. When only a few orders (m, n) are needed, the
+ * three-term recursion in el at fixed (m, n),
+ *
+ *   d^(el+1)_mn = a_el (cos(beta) - b_el) d^el_mn - c_el d^(el-1)_mn,
+ *
+ * started from the closed form of d^el_mn at el = max(|m|, |n|), is far
+ * cheaper. It is evaluated for many angles at once, so that the inner loop
+ * over the angles vectorises.
+ *
+ * The same recursion, run over the angles beta of many rotations, yields the
+ * Wigner D-matrices D^el_mn(alpha, beta, gamma) of all the rotations for all
+ * el, m and n, with the inner loop over the rotations and the orders (m, n)
+ * shared out between threads.
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+#include "so3/so3_wigner.h"
+
+#include "so3_omp.h"
+
+#define MAX(a, b) ((a > b) ? (a) : (b))
+#define MIN(a, b) ((a < b) ? (a) : (b))
+
+// Batches with fewer entries are computed by a single thread.
+#define SO3_WIGNER_PARALLEL_MIN 32768
+// Rotations whose D-matrices are filled together by so3_wigner_D_batch.
+#define SO3_WIGNER_BLOCK 16
+
+// d^j_mn(beta) for j = max(|m|, |n|), where the sum of the explicit formula
+// has a single term. The magnitude is formed in log space, as the binomial
+// prefactor overflows for large j.
+static double so3_wigner_d_start(int j, int m, int n, double beta) {
+  const double c = cos(0.5 * beta), s = sin(0.5 * beta);
+  // The single k of sum_k (-1)^(m-n+k) ... for which all factorials are of
+  // non-negative arguments.
+  const int k = MAX(0, n - m);
+  const int ec = 2 * j + n - m - 2 * k;
+  const int es = m - n + 2 * k;
+  double log_magnitude, sign;
+
+  if ((ec > 0 && c == 0.0) || (es > 0 && s == 0.0))
+    return 0.0;
+
+  log_magnitude = 0.5 * (lgamma(j + m + 1.0) + lgamma(j - m + 1.0) +
+                         lgamma(j + n + 1.0) + lgamma(j - n + 1.0)) -
+                  lgamma(j + n - k + 1.0) - lgamma(k + 1.0) -
+                  lgamma(m - n + k + 1.0) - lgamma(j - m - k + 1.0);
+  if (ec > 0)
+    log_magnitude += ec * log(fabs(c));
+  if (es > 0)
+    log_magnitude += es * log(fabs(s));
+
+  sign = (m - n + k) % 2 ? -1.0 : 1.0;
+  if (c < 0.0 && ec % 2)
+    sign = -sign;
+  if (s < 0.0 && es % 2)
+    sign = -sign;
+  return sign * exp(log_magnitude);
+}
+
+/*!
+ * Start the recursion at el = max(|m|, |n|).
+ *
+ * \param[out] recursion Recursion state, with d holding d^el_mn(beta).
+ * \param[in] m First order.
+ * \param[in] n Second order.
+ * \param[in] beta Angles.
+ * \param[in] nbeta Number of angles.
+ * \retval none
+ */
+void so3_wigner_d_recursion_init(
+    so3_wigner_d_recursion_t *recursion, int m, int n, const double *beta, int nbeta) {
+  int i;
+
+  recursion->m = m;
+  recursion->n = n;
+  recursion->el = MAX(abs(m), abs(n));
+  recursion->nbeta = nbeta;
+  recursion->d = malloc(nbeta * sizeof *recursion->d);
+  recursion->d_prev = malloc(nbeta * sizeof *recursion->d_prev);
+  recursion->cos_beta = malloc(nbeta * sizeof *recursion->cos_beta);
+  SO3_ERROR_MEM_ALLOC_CHECK(recursion->d);
+  SO3_ERROR_MEM_ALLOC_CHECK(recursion->d_prev);
+  SO3_ERROR_MEM_ALLOC_CHECK(recursion->cos_beta);
+
+  for (i = 0; i < nbeta; ++i) {
+    recursion->d[i] = so3_wigner_d_start(recursion->el, m, n, beta[i]);
+    recursion->d_prev[i] = 0.0;
+    recursion->cos_beta[i] = cos(beta[i]);
+  }
+}
+
+/*!
+ * Advance the recursion from el to el + 1.
+ *
+ * \param[in,out] recursion Recursion state.
+ * \retval none
+ */
+void so3_wigner_d_recursion_next(so3_wigner_d_recursion_t *recursion) {
+  const int el = recursion->el;
+  const double m = recursion->m, n = recursion->n;
+  const double el1 = el + 1.0;
+  const double norm = sqrt((el1 * el1 - m * m) * (el1 * el1 - n * n));
+  const double a = el1 * (2.0 * el + 1.0) / norm;
+  // Both b and c vanish at el = 0, where m = n = 0, and c at the start of the
+  // recursion, where d^(el-1)_mn is zero anyway.
+  const double b = el > 0 ? m * n / (el * el1) : 0.0;
+  const double c =
+      el > 0 ? el1 * sqrt(((double)el * el - m * m) * ((double)el * el - n * n)) /
+                   (el * norm)
+             : 0.0;
+  double *restrict d = recursion->d;
+  double *restrict d_prev = recursion->d_prev;
+  const double *restrict cos_beta = recursion->cos_beta;
+  int i;
+
+  for (i = 0; i < recursion->nbeta; ++i) {
+    const double next = a * (cos_beta[i] - b) * d[i] - c * d_prev[i];
+    d_prev[i] = d[i];
+    d[i] = next;
+  }
+  recursion->el = el + 1;
+}
+
+/*!
+ * Free the recursion state.
+ *
+ * \param[in] recursion Recursion state.
+ * \retval none
+ */
+void so3_wigner_d_recursion_free(so3_wigner_d_recursion_t *recursion) {
+  free(recursion->d);
+  free(recursion->d_prev);
+  free(recursion->cos_beta);
+}
+
+// Parameters whose flmn layout holds the D-matrix of one rotation.
+static so3_parameters_t so3_wigner_D_parameters(
+    int el_max, so3_storage_t storage, so3_n_order_t n_order) {
+  so3_parameters_t parameters = {0};
+  parameters.L = el_max + 1;
+  parameters.N = el_max + 1;
+  parameters.storage = storage;
+  parameters.n_order = n_order;
+  parameters.n_mode = SO3_N_MODE_ALL;
+  return parameters;
+}
+
+/*!
+ * Number of entries of the Wigner D-matrices of one rotation, see \link
+ * so3_wigner_D_batch \endlink.
+ *
+ * \param[in] el_max Maximum degree.
+ * \param[in] storage Storage method.
+ * \retval size Number of entries.
+ */
+int so3_wigner_D_size(int el_max, so3_storage_t storage) {
+  const so3_parameters_t parameters =
+      so3_wigner_D_parameters(el_max, storage, SO3_N_ORDER_NEGATIVE_FIRST);
+  return so3_sampling_flmn_size(&parameters);
+}
+
+/*!
+ * Compute the Wigner D-matrices
+ * D^el_mn(alpha, beta, gamma) = exp(-i m alpha) d^el_mn(beta) exp(-i n gamma)
+ * for el = 0, ..., el_max and a batch of rotations. The inverse transforms
+ * synthesise a signal from the conjugates of these functions.
+ *
+ * \param[out] out D-matrices of each rotation, stored one after the other,
+ *                 each of size \link so3_wigner_D_size \endlink and in the
+ *                 flmn layout of band-limits L = N = el_max + 1 with the given
+ *                 storage and n-order. Padding entries are set to zero.
+ * \param[in] el_max Maximum degree.
+ * \param[in] alphas Euler angles alpha of the rotations.
+ * \param[in] betas Euler angles beta of the rotations.
+ * \param[in] gammas Euler angles gamma of the rotations.
+ * \param[in] count Number of rotations.
+ * \param[in] storage Storage method.
+ * \param[in] n_order Order of n.
+ * \retval none
+ */
+void so3_wigner_D_batch(
+    complex double *out, int el_max, const double *alphas, const double *betas,
+    const double *gammas, int count, so3_storage_t storage, so3_n_order_t n_order) {
+  const so3_parameters_t parameters =
+      so3_wigner_D_parameters(el_max, storage, n_order);
+  const int size = so3_sampling_flmn_size(&parameters);
+  const int nblocks = (count + SO3_WIGNER_BLOCK - 1) / SO3_WIGNER_BLOCK;
+  int block;
+
+  // Each block of rotations is filled by one thread, so that the writes go
+  // to the few D-matrices of the block rather than to all of them.
+  SO3_PRAGMA(omp parallel for schedule(dynamic) \
+             if ((double)count * size >= SO3_WIGNER_PARALLEL_MIN))
+  for (block = 0; block < nblocks; ++block) {
+    const int start = block * SO3_WIGNER_BLOCK;
+    const int nr = MIN(SO3_WIGNER_BLOCK, count - start);
+    complex double *block_out = out + (size_t)start * size;
+    complex double phase[SO3_WIGNER_BLOCK];
+    so3_wigner_d_recursion_t recursion;
+    int m, n, r;
+
+    memset(block_out, 0, (size_t)nr * size * sizeof *out);
+    for (m = -el_max; m <= el_max; ++m)
+      for (n = -el_max; n <= el_max; ++n) {
+        for (r = 0; r < nr; ++r)
+          phase[r] = cexp(-I * (m * alphas[start + r] + n * gammas[start + r]));
+
+        so3_wigner_d_recursion_init(&recursion, m, n, betas + start, nr);
+        while (1) {
+          int ind;
+          so3_sampling_elmn2ind(&ind, recursion.el, m, n, &parameters);
+          for (r = 0; r < nr; ++r)
+            block_out[(size_t)r * size + ind] = phase[r] * recursion.d[r];
+          if (recursion.el == el_max)
+            break;
+          so3_wigner_d_recursion_next(&recursion);
+        }
+        so3_wigner_d_recursion_free(&recursion);
+      }
+  }
+}
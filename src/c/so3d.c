@@ -0,0 +1,73 @@
+// S03 package to perform Wigner transform on the rotation group SO(3)
+// Copyright (C) 2013 Martin Büttner and Jason McEwen
+// See LICENSE.txt for license details
+
+/*!
+ * \file so3d.c
+ * Transform server daemon, see so3_server.c.
+ *
+ * Usage: so3d [-s socket] [-j workers] [-v]
+ *
+ * The socket defaults to \link so3_server_default_path \endlink and the
+ * number of worker threads to the number of online processors. The server
+ * runs until it receives SIGINT or SIGTERM.
+ */
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "so3/so3_server.h"
+#include "so3/so3_types.h"
+
+int main(int argc, char **argv) {
+  const char *path = NULL;
+  char default_path[256];
+  int nworkers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  int verbose = 0, option, received;
+  sigset_t signals;
+
+  while ((option = getopt(argc, argv, "s:j:v")) != -1) {
+    switch (option) {
+    case 's':
+      path = optarg;
+      break;
+    case 'j':
+      nworkers = atoi(optarg);
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    default:
+      fprintf(stderr, "Usage: %s [-s socket] [-j workers] [-v]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (!path) {
+    so3_server_default_path(default_path, sizeof default_path);
+    path = default_path;
+  }
+
+  // Block the signals before any thread is started, so that only sigwait
+  // receives them.
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+  so3_server_t *server = so3_server_start(path, nworkers);
+  if (!server) {
+    fprintf(stderr, "%sCould not listen on %s\n", SO3_PROMPT, path);
+    return 1;
+  }
+  if (verbose)
+    printf("%sListening on %s with %d workers\n", SO3_PROMPT, path, nworkers);
+
+  sigwait(&signals, &received);
+  so3_server_stop(server);
+  if (verbose)
+    printf("%sStopped\n", SO3_PROMPT);
+  return 0;
+}
@@ -48,7 +48,6 @@ void test_so3_sampling_n_loop_values()
         {
             parameters.reality = real;
 
-            // MWSS not yet supported by direct routinesSO3_SAMPLING_SIZE
             for (int sampling_scheme = 0; sampling_scheme < SO3_SAMPLING_SIZE; ++sampling_scheme)
             // for (sampling_scheme = 0; sampling_scheme < 1; ++sampling_scheme)
             {
@@ -67,6 +67,103 @@ cdef extern from "so3/so3.h":
         const double complex * glm, 
     )
 
+    void so3_flmn_axpy(
+        double complex * y, double complex alpha, const double complex * x,
+        const so3_parameters_t* parameters)
+    void so3_flmn_scale_by_el(
+        double complex * x, const double* weights,
+        const so3_parameters_t* parameters)
+    double complex so3_flmn_dot(
+        const double complex * x, const double complex * y,
+        const so3_parameters_t* parameters)
+    void so3_flmn_norm_per_el(
+        double* norms, const double complex * x,
+        const so3_parameters_t* parameters)
+    void so3_flmn_change_bandlimit(
+        double complex * flmn_out, const so3_parameters_t* parameters_out,
+        const double complex * flmn_in, const so3_parameters_t* parameters_in)
+
+    void so3_resample(
+        double complex * f_out, const so3_parameters_t* parameters_out,
+        const double complex * f_in, const so3_parameters_t* parameters_in)
+    void so3_resample_real(
+        double* f_out, const so3_parameters_t* parameters_out,
+        const double* f_in, const so3_parameters_t* parameters_in)
+
+    int so3_wigner_D_size(int el_max, so3_storage_t storage)
+    void so3_wigner_D_batch(
+        double complex * out, int el_max, const double* alphas,
+        const double* betas, const double* gammas, int count,
+        so3_storage_t storage, so3_n_order_t n_order)
+
+    void so3_grid_coordinates(
+        double* alphas, double* betas, double* gammas,
+        const so3_parameters_t* parameters)
+    void so3_grid_quaternion_to_euler(
+        double* alphas, double* betas, double* gammas,
+        const double* quaternions, int count)
+    void so3_grid_matrix_to_euler(
+        double* alphas, double* betas, double* gammas,
+        const double* matrices, int count)
+    void so3_grid_nearest(
+        int* indices, const double* alphas, const double* betas,
+        const double* gammas, int count, const so3_parameters_t* parameters)
+
+    ctypedef enum so3_interp_method_t:
+        SO3_INTERP_LINEAR, SO3_INTERP_CUBIC
+    ctypedef struct so3_interp_plan_t:
+        pass
+    so3_interp_plan_t* so3_interp_plan_init(
+        const so3_parameters_t* parameters, so3_interp_method_t method)
+    void so3_interp_plan_free(so3_interp_plan_t* plan)
+    void so3_interp(
+        double complex * values, const double complex * f, const double* alphas,
+        const double* betas, const double* gammas, int count,
+        so3_interp_plan_t* plan)
+    void so3_interp_real(
+        double* values, const double* f, const double* alphas,
+        const double* betas, const double* gammas, int count,
+        so3_interp_plan_t* plan)
+
+    ctypedef struct so3_search_candidate_t:
+        double alpha
+        double beta
+        double gamma
+        double score
+    int so3_search(
+        so3_search_candidate_t* candidates, int ncandidates,
+        const double complex * flm, const double complex * glm, int L_coarse,
+        const so3_parameters_t* parameters)
+
+    double complex so3_integrate(
+        const double complex * f, const so3_parameters_t* parameters)
+    double so3_integrate_real(const double* f, const so3_parameters_t* parameters)
+    double complex so3_inner_product(
+        const double complex * f, const double complex * g,
+        const so3_parameters_t* parameters)
+    double so3_inner_product_real(
+        const double* f, const double* g, const so3_parameters_t* parameters)
+
+    size_t so3_codec_encode_bound(const so3_parameters_t* parameters)
+    size_t so3_codec_encode(
+        unsigned char* data, const double complex * flmn, double error_bound,
+        const so3_parameters_t* parameters)
+    int so3_codec_decode(
+        double complex * flmn, const unsigned char* data, size_t size,
+        const so3_parameters_t* parameters)
+
+    ctypedef struct so3_descriptor_triple_t:
+        int el1, n1
+        int el2, n2
+        int el, n
+    void so3_descriptor_power(
+        double* power, const double complex * flmn, int batch,
+        const so3_parameters_t* parameters)
+    void so3_descriptor_bispectrum(
+        double complex * bispectrum, const double complex * flmn, int batch,
+        const so3_descriptor_triple_t* triples, int ntriples,
+        const so3_parameters_t* parameters)
+
     ctypedef struct so3_parameters_t:
         int verbosity
         int reality
@@ -79,6 +176,8 @@ cdef extern from "so3/so3.h":
         so3_n_mode_t n_mode
         ssht_dl_method_t dl_method
         int steerable 
+        int M
+        double dl_tolerance
 
     ctypedef enum so3_sampling_t:
         SO3_SAMPLING_MW, SO3_SAMPLING_MW_SS, SO3_SAMPLING_SIZE
@@ -109,7 +208,9 @@ class SO3Parameters:
         so3_storage_t storage=SO3_STORAGE_PADDED,
         so3_n_mode_t n_mode=SO3_N_MODE_ALL,
         ssht_dl_method_t dl_method=SSHT_DL_RISBO,
-        int steerable=0
+        int steerable=0,
+        int M=0,
+        double dl_tolerance=0.0
         ):
         self.L = L
         self.N = N
@@ -122,6 +223,8 @@ class SO3Parameters:
         self.n_mode = n_mode
         self.dl_method = dl_method
         self.steerable = steerable    
+        self.M = M
+        self.dl_tolerance = dl_tolerance
 
     def from_dict(self, dict parameters_dict):
         self.L = parameters_dict['L']
@@ -135,6 +238,8 @@ class SO3Parameters:
         self.n_mode = parameters_dict['n_mode']
         self.dl_method = parameters_dict['dl_method']
         self.steerable = parameters_dict['steerable']
+        self.M = parameters_dict.get('M', 0)
+        self.dl_tolerance = parameters_dict.get('dl_tolerance', 0.0)
         return self
 
 
@@ -149,7 +254,9 @@ def create_parameter_dict(
         str storage_str="SO3_STORAGE_PADDED",
         str n_mode_str="SO3_N_MODE_ALL",
         str dl_method_str="SSHT_DL_RISBO",
-        int steerable=0
+        int steerable=0,
+        int M=0,
+        double dl_tolerance=0.0
         ):
     """function to create params class from input
     this is just here to prevent some breaking changes
@@ -203,6 +310,8 @@ def create_parameter_dict(
     parameters.n_mode = n_mode
     parameters.dl_method = dl_method
     parameters.steerable = steerable
+    parameters.M = M
+    parameters.dl_tolerance = dl_tolerance
 
     return SO3Parameters(
     L = L,
@@ -215,7 +324,9 @@ def create_parameter_dict(
     storage = storage,
     n_mode = n_mode,
     dl_method = dl_method,
-    steerable = steerable
+    steerable = steerable,
+    M = M,
+    dl_tolerance = dl_tolerance
     )
 
 cdef so3_parameters_t create_parameter_struct(so3_parameters):
@@ -231,6 +342,8 @@ cdef so3_parameters_t create_parameter_struct(so3_parameters):
     parameters.n_mode = so3_parameters.n_mode
     parameters.dl_method = so3_parameters.dl_method
     parameters.steerable = so3_parameters.steerable
+    parameters.M = so3_parameters.M
+    parameters.dl_tolerance = so3_parameters.dl_tolerance
 
     return parameters
 
@@ -438,5 +551,349 @@ def s2toso3_harmonic_convolution(
     )
     return hlmn
 
+# level-1 algebra on harmonic coefficients, skipping the coefficients that
+# are zero by construction
+
+def flmn_axpy(
+    double complex alpha,
+    np.ndarray[ double complex, ndim=1, mode="c"] x not None,
+    np.ndarray[ double complex, ndim=1, mode="c"] y not None,
+    so3_parameters not None):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+
+    flmn_size = so3_sampling_flmn_size(&parameters)
+    if x.shape[0] != flmn_size or y.shape[0] != flmn_size:
+        raise ValueError("x and y do not match the size given by so3_parameters")
+    result = np.array(y, dtype=complex, copy=True)
+    so3_flmn_axpy(
+        <double complex*> np.PyArray_DATA(result), alpha,
+        <const double complex*> np.PyArray_DATA(x), &parameters)
+    return result
+
+def flmn_scale_by_el(
+    np.ndarray[ double complex, ndim=1, mode="c"] x not None,
+    np.ndarray[ double, ndim=1, mode="c"] weights not None,
+    so3_parameters not None):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+
+    if x.shape[0] != so3_sampling_flmn_size(&parameters):
+        raise ValueError("x does not match the size given by so3_parameters")
+    if weights.shape[0] < parameters.L:
+        raise ValueError("weights must have at least L elements")
+    result = np.array(x, dtype=complex, copy=True)
+    so3_flmn_scale_by_el(
+        <double complex*> np.PyArray_DATA(result),
+        <const double*> np.PyArray_DATA(weights), &parameters)
+    return result
+
+def flmn_dot(
+    np.ndarray[ double complex, ndim=1, mode="c"] x not None,
+    np.ndarray[ double complex, ndim=1, mode="c"] y not None,
+    so3_parameters not None):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+
+    flmn_size = so3_sampling_flmn_size(&parameters)
+    if x.shape[0] != flmn_size or y.shape[0] != flmn_size:
+        raise ValueError("x and y do not match the size given by so3_parameters")
+    return so3_flmn_dot(
+        <const double complex*> np.PyArray_DATA(x),
+        <const double complex*> np.PyArray_DATA(y), &parameters)
+
+def flmn_norm_per_el(
+    np.ndarray[ double complex, ndim=1, mode="c"] x not None,
+    so3_parameters not None):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+
+    if x.shape[0] != so3_sampling_flmn_size(&parameters):
+        raise ValueError("x does not match the size given by so3_parameters")
+    norms = np.zeros([parameters.L,], dtype=float)
+    so3_flmn_norm_per_el(
+        <double*> np.PyArray_DATA(norms),
+        <const double complex*> np.PyArray_DATA(x), &parameters)
+    return norms
+
+def flmn_change_bandlimit(
+    np.ndarray[ double complex, ndim=1, mode="c"] flmn not None,
+    so3_parameters_in not None,
+    so3_parameters_out not None):
+    cdef so3_parameters_t parameters_in=create_parameter_struct(so3_parameters_in)
+    cdef so3_parameters_t parameters_out=create_parameter_struct(so3_parameters_out)
+
+    if flmn.shape[0] != so3_sampling_flmn_size(&parameters_in):
+        raise ValueError("flmn does not match the size given by so3_parameters_in")
+    result = np.zeros([so3_sampling_flmn_size(&parameters_out),], dtype=complex)
+    so3_flmn_change_bandlimit(
+        <double complex*> np.PyArray_DATA(result), &parameters_out,
+        <const double complex*> np.PyArray_DATA(flmn), &parameters_in)
+    return result
+
+# Resampling to other band-limits and sampling schemes
+
+def resample(np.ndarray f not None, so3_parameters_in not None, so3_parameters_out not None):
+    cdef so3_parameters_t parameters_in=create_parameter_struct(so3_parameters_in)
+    cdef so3_parameters_t parameters_out=create_parameter_struct(so3_parameters_out)
+    cdef np.ndarray f_c
+
+    if f.size != so3_sampling_f_size(&parameters_in):
+        raise ValueError("f does not match the sampling of so3_parameters_in")
+    f_length = so3_sampling_f_size(&parameters_out)
+    if parameters_in.reality:
+        f_c = np.ascontiguousarray(f, dtype=float)
+        result = np.zeros([f_length,], dtype=float)
+        so3_resample_real(
+            <double*> np.PyArray_DATA(result), &parameters_out,
+            <const double*> np.PyArray_DATA(f_c), &parameters_in)
+    else:
+        f_c = np.ascontiguousarray(f, dtype=complex)
+        result = np.zeros([f_length,], dtype=complex)
+        so3_resample(
+            <double complex*> np.PyArray_DATA(result), &parameters_out,
+            <const double complex*> np.PyArray_DATA(f_c), &parameters_in)
+    return result
+
+# Quadrature on the sampled grid
+
+def integrate(np.ndarray f not None, so3_parameters not None):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+    cdef np.ndarray f_c
+
+    if f.size != so3_sampling_f_size(&parameters):
+        raise ValueError("f does not match the sampling of so3_parameters")
+    if parameters.reality:
+        f_c = np.ascontiguousarray(f, dtype=float)
+        return so3_integrate_real(<const double*> np.PyArray_DATA(f_c), &parameters)
+    f_c = np.ascontiguousarray(f, dtype=complex)
+    return so3_integrate(<const double complex*> np.PyArray_DATA(f_c), &parameters)
+
+def inner_product(np.ndarray f not None, np.ndarray g not None, so3_parameters not None):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+    cdef np.ndarray f_c, g_c
+
+    if f.size != so3_sampling_f_size(&parameters) or g.size != f.size:
+        raise ValueError("f and g do not match the sampling of so3_parameters")
+    if parameters.reality:
+        f_c = np.ascontiguousarray(f, dtype=float)
+        g_c = np.ascontiguousarray(g, dtype=float)
+        return so3_inner_product_real(
+            <const double*> np.PyArray_DATA(f_c),
+            <const double*> np.PyArray_DATA(g_c), &parameters)
+    f_c = np.ascontiguousarray(f, dtype=complex)
+    g_c = np.ascontiguousarray(g, dtype=complex)
+    return so3_inner_product(
+        <const double complex*> np.PyArray_DATA(f_c),
+        <const double complex*> np.PyArray_DATA(g_c), &parameters)
+
+# compressed archival of harmonic coefficients
+
+def compress(np.ndarray flmn not None, so3_parameters not None, double error_bound=0.0):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+    cdef np.ndarray flmn_c = np.ascontiguousarray(flmn, dtype=complex)
+
+    if flmn_c.size != so3_sampling_flmn_size(&parameters):
+        raise ValueError("flmn does not match the size given by so3_parameters")
+    if error_bound < 0:
+        raise ValueError("error_bound must be non-negative")
+    cdef np.ndarray data = np.empty(so3_codec_encode_bound(&parameters), dtype=np.uint8)
+    size = so3_codec_encode(
+        <unsigned char*> np.PyArray_DATA(data),
+        <const double complex*> np.PyArray_DATA(flmn_c), error_bound, &parameters)
+    return data[:size].tobytes()
+
+def decompress(bytes data not None, so3_parameters not None):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+    cdef np.ndarray data_c = np.frombuffer(data, dtype=np.uint8)
+    cdef np.ndarray flmn = np.empty(so3_sampling_flmn_size(&parameters), dtype=complex)
+
+    if so3_codec_decode(
+            <double complex*> np.PyArray_DATA(flmn),
+            <const unsigned char*> np.PyArray_DATA(data_c), data_c.size,
+            &parameters) != 0:
+        raise ValueError("data are not valid compressed coefficients")
+    return flmn
+
+# Wigner D-matrices of many rotations
+
+def wigner_D_batch(
+    int el_max,
+    np.ndarray[ double, ndim=1, mode="c"] alphas not None,
+    np.ndarray[ double, ndim=1, mode="c"] betas not None,
+    np.ndarray[ double, ndim=1, mode="c"] gammas not None,
+    str storage_str="SO3_STORAGE_PADDED",
+    str n_order_str="SO3_N_ORDER_NEGATIVE_FIRST"):
+    cdef so3_storage_t storage = SO3_STORAGE_PADDED
+    cdef so3_n_order_t n_order = SO3_N_ORDER_NEGATIVE_FIRST
+    if storage_str != "SO3_STORAGE_PADDED":
+        storage = SO3_STORAGE_COMPACT
+    if n_order_str != "SO3_N_ORDER_NEGATIVE_FIRST":
+        n_order = SO3_N_ORDER_ZERO_FIRST
+
+    count = alphas.shape[0]
+    if betas.shape[0] != count or gammas.shape[0] != count:
+        raise ValueError("alphas, betas and gammas must have the same length")
+    D = np.zeros([count, so3_wigner_D_size(el_max, storage)], dtype=complex)
+    so3_wigner_D_batch(
+        <double complex*> np.PyArray_DATA(D), el_max,
+        <const double*> np.PyArray_DATA(alphas),
+        <const double*> np.PyArray_DATA(betas),
+        <const double*> np.PyArray_DATA(gammas), count, storage, n_order)
+    return D
+
+# coordinates of the sampling grid and lookup of rotations on it
+
+def grid_coordinates(so3_parameters not None):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+
+    length = so3_sampling_f_size(&parameters)
+    alphas = np.zeros([length,], dtype=float)
+    betas = np.zeros([length,], dtype=float)
+    gammas = np.zeros([length,], dtype=float)
+    so3_grid_coordinates(
+        <double*> np.PyArray_DATA(alphas), <double*> np.PyArray_DATA(betas),
+        <double*> np.PyArray_DATA(gammas), &parameters)
+    return alphas, betas, gammas
+
+def quaternion_to_euler(np.ndarray[ double, ndim=2, mode="c"] quaternions not None):
+    if quaternions.shape[1] != 4:
+        raise ValueError("quaternions must have shape (count, 4)")
+    count = quaternions.shape[0]
+    alphas = np.zeros([count,], dtype=float)
+    betas = np.zeros([count,], dtype=float)
+    gammas = np.zeros([count,], dtype=float)
+    so3_grid_quaternion_to_euler(
+        <double*> np.PyArray_DATA(alphas), <double*> np.PyArray_DATA(betas),
+        <double*> np.PyArray_DATA(gammas),
+        <const double*> np.PyArray_DATA(quaternions), count)
+    return alphas, betas, gammas
+
+def matrix_to_euler(np.ndarray[ double, ndim=3, mode="c"] matrices not None):
+    if matrices.shape[1] != 3 or matrices.shape[2] != 3:
+        raise ValueError("matrices must have shape (count, 3, 3)")
+    count = matrices.shape[0]
+    alphas = np.zeros([count,], dtype=float)
+    betas = np.zeros([count,], dtype=float)
+    gammas = np.zeros([count,], dtype=float)
+    so3_grid_matrix_to_euler(
+        <double*> np.PyArray_DATA(alphas), <double*> np.PyArray_DATA(betas),
+        <double*> np.PyArray_DATA(gammas),
+        <const double*> np.PyArray_DATA(matrices), count)
+    return alphas, betas, gammas
+
+def grid_nearest(
+    np.ndarray[ double, ndim=1, mode="c"] alphas not None,
+    np.ndarray[ double, ndim=1, mode="c"] betas not None,
+    np.ndarray[ double, ndim=1, mode="c"] gammas not None,
+    so3_parameters not None):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+
+    count = alphas.shape[0]
+    if betas.shape[0] != count or gammas.shape[0] != count:
+        raise ValueError("alphas, betas and gammas must have the same length")
+    indices = np.zeros([count,], dtype=np.intc)
+    so3_grid_nearest(
+        <int*> np.PyArray_DATA(indices),
+        <const double*> np.PyArray_DATA(alphas),
+        <const double*> np.PyArray_DATA(betas),
+        <const double*> np.PyArray_DATA(gammas), count, &parameters)
+    return indices
+
+def interp(
+    np.ndarray f not None,
+    np.ndarray[ double, ndim=1, mode="c"] alphas not None,
+    np.ndarray[ double, ndim=1, mode="c"] betas not None,
+    np.ndarray[ double, ndim=1, mode="c"] gammas not None,
+    so3_parameters not None,
+    str method_str="SO3_INTERP_CUBIC"):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+    cdef so3_interp_method_t method
+    cdef so3_interp_plan_t* plan
+    cdef np.ndarray f_c
+
+    if method_str == "SO3_INTERP_LINEAR":
+        method = SO3_INTERP_LINEAR
+    elif method_str == "SO3_INTERP_CUBIC":
+        method = SO3_INTERP_CUBIC
+    else:
+        raise ValueError("Invalid interpolation method: " + method_str)
+    count = alphas.shape[0]
+    if betas.shape[0] != count or gammas.shape[0] != count:
+        raise ValueError("alphas, betas and gammas must have the same length")
+    if f.size != so3_sampling_f_size(&parameters):
+        raise ValueError("f does not match the sampling of so3_parameters")
+
+    plan = so3_interp_plan_init(&parameters, method)
+    if parameters.reality:
+        f_c = np.ascontiguousarray(f, dtype=np.float64)
+        values = np.zeros([count,], dtype=np.float64)
+        so3_interp_real(
+            <double*> np.PyArray_DATA(values),
+            <const double*> np.PyArray_DATA(f_c),
+            <const double*> np.PyArray_DATA(alphas),
+            <const double*> np.PyArray_DATA(betas),
+            <const double*> np.PyArray_DATA(gammas), count, plan)
+    else:
+        f_c = np.ascontiguousarray(f, dtype=np.complex128)
+        values = np.zeros([count,], dtype=np.complex128)
+        so3_interp(
+            <double complex*> np.PyArray_DATA(values),
+            <const double complex*> np.PyArray_DATA(f_c),
+            <const double*> np.PyArray_DATA(alphas),
+            <const double*> np.PyArray_DATA(betas),
+            <const double*> np.PyArray_DATA(gammas), count, plan)
+    so3_interp_plan_free(plan)
+    return values
+
+def search(
+    np.ndarray[ double complex, ndim=1, mode="c"] flm not None,
+    np.ndarray[ double complex, ndim=1, mode="c"] glm not None,
+    so3_parameters not None,
+    int ncandidates=1,
+    int L_coarse=0):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+
+    if flm.shape[0] < parameters.L**2 or glm.shape[0] < parameters.L**2:
+        raise ValueError("flm and glm must have at least L**2 coefficients")
+    # Each candidate is (alpha, beta, gamma, score).
+    candidates = np.zeros([ncandidates, 4], dtype=np.float64)
+    count = so3_search(
+        <so3_search_candidate_t*> np.PyArray_DATA(candidates), ncandidates,
+        <const double complex*> np.PyArray_DATA(flm),
+        <const double complex*> np.PyArray_DATA(glm), L_coarse, &parameters)
+    return candidates[:count, :3], candidates[:count, 3]
+
+# Rotation-invariant descriptors of many signals
+
+def descriptor_power(np.ndarray flmn not None, so3_parameters not None):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+    cdef np.ndarray flmn_c = np.ascontiguousarray(flmn, dtype=np.complex128)
+    flmn_size = so3_sampling_flmn_size(&parameters)
+
+    if flmn_c.shape[flmn_c.ndim - 1] != flmn_size:
+        raise ValueError("flmn does not match so3_parameters")
+    batch = flmn_c.size // flmn_size
+    power = np.zeros(flmn_c.shape[:flmn_c.ndim - 1] + (parameters.L,), dtype=np.float64)
+    so3_descriptor_power(
+        <double*> np.PyArray_DATA(power),
+        <const double complex*> np.PyArray_DATA(flmn_c), batch, &parameters)
+    return power
+
+def descriptor_bispectrum(np.ndarray flmn not None, triples not None, so3_parameters not None):
+    cdef so3_parameters_t parameters=create_parameter_struct(so3_parameters)
+    cdef np.ndarray flmn_c = np.ascontiguousarray(flmn, dtype=np.complex128)
+    # Each triple is (el1, n1, el2, n2, el, n).
+    cdef np.ndarray triples_c = np.ascontiguousarray(triples, dtype=np.intc).reshape(-1, 6)
+    flmn_size = so3_sampling_flmn_size(&parameters)
+
+    if flmn_c.shape[flmn_c.ndim - 1] != flmn_size:
+        raise ValueError("flmn does not match so3_parameters")
+    batch = flmn_c.size // flmn_size
+    ntriples = triples_c.shape[0]
+    bispectrum = np.zeros(flmn_c.shape[:flmn_c.ndim - 1] + (ntriples,), dtype=np.complex128)
+    so3_descriptor_bispectrum(
+        <double complex*> np.PyArray_DATA(bispectrum),
+        <const double complex*> np.PyArray_DATA(flmn_c), batch,
+        <const so3_descriptor_triple_t*> np.PyArray_DATA(triples_c), ntriples,
+        &parameters)
+    return bispectrum
+
 def test_func():
     return "hello"
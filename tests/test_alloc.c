@@ -0,0 +1,94 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <complex.h>
+
+#include "so3/so3_alloc.h"
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+static void test_alloc_zeroed_aligned(void **state) {
+  // Below and above the threshold for mapped buffers.
+  const size_t sizes[] = {1, 1000, SO3_ALLOC_LARGE_MIN, 3 * SO3_ALLOC_LARGE_MIN + 7};
+  int p, s;
+  size_t i;
+
+  for (p = 0; p < SO3_ALLOC_POLICY_SIZE; ++p) {
+    so3_alloc_set_policy(p);
+    assert_int_equal(so3_alloc_get_policy(), p);
+    for (s = 0; s < sizeof sizes / sizeof *sizes; ++s) {
+      unsigned char *buffer = so3_alloc_large(sizes[s], 1);
+      assert_non_null(buffer);
+      assert_int_equal((uintptr_t)buffer % 64, 0);
+      for (i = 0; i < sizes[s]; ++i)
+        assert_int_equal(buffer[i], 0);
+      memset(buffer, 0xff, sizes[s]);
+      so3_alloc_free(buffer);
+    }
+  }
+  so3_alloc_free(NULL);
+  so3_alloc_set_policy(SO3_ALLOC_POLICY_LOCAL);
+}
+
+static void test_alloc_overflow(void **state) {
+  assert_null(so3_alloc_large(SIZE_MAX / 2, 4));
+}
+
+static void test_alloc_transform_policies(void **state) {
+  // Large enough for Fmnm and fext to be mapped.
+  const so3_parameters_t parameters = {
+      .L0 = 0,
+      .L = 48,
+      .N = 48,
+      .verbosity = 0,
+      .n_mode = SO3_N_MODE_ALL,
+      .sampling_scheme = SO3_SAMPLING_MW,
+      .n_order = SO3_N_ORDER_NEGATIVE_FIRST,
+      .storage = SO3_STORAGE_PADDED,
+      .dl_method = SSHT_DL_RISBO,
+      .steerable = 0};
+  const int f_size = so3_sampling_f_size(&parameters);
+  const int flmn_size = so3_sampling_flmn_size(&parameters);
+  complex double *flmn = malloc(flmn_size * sizeof *flmn);
+  complex double *f_local = malloc(f_size * sizeof *f_local);
+  complex double *f_calloc = malloc(f_size * sizeof *f_calloc);
+  int i;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(f_local);
+  SO3_ERROR_MEM_ALLOC_CHECK(f_calloc);
+  gen_flmn_complex(flmn, &parameters, 1);
+
+  so3_alloc_set_policy(SO3_ALLOC_POLICY_LOCAL);
+  so3_core_inverse_direct(f_local, flmn, &parameters);
+  so3_alloc_set_policy(SO3_ALLOC_POLICY_CALLOC);
+  so3_core_inverse_direct(f_calloc, flmn, &parameters);
+  so3_alloc_set_policy(SO3_ALLOC_POLICY_LOCAL);
+
+  for (i = 0; i < f_size; ++i) {
+    assert_float_equal(creal(f_local[i]), creal(f_calloc[i]), 0);
+    assert_float_equal(cimag(f_local[i]), cimag(f_calloc[i]), 0);
+  }
+
+  free(flmn);
+  free(f_local);
+  free(f_calloc);
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_alloc_zeroed_aligned),
+      cmocka_unit_test(test_alloc_overflow),
+      cmocka_unit_test(test_alloc_transform_policies),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
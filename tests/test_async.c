@@ -0,0 +1,319 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <complex.h>
+
+#include "so3/so3_async.h"
+#include "so3/so3_conv.h"
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_fft.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_small.h"
+#include "so3/so3_tune.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+#define NJOBS 8
+
+static const so3_parameters_t small_parameters = {
+    .L0 = 0,
+    .L = 8,
+    .N = 3,
+    .verbosity = 0,
+    .n_mode = SO3_N_MODE_ALL,
+    .sampling_scheme = SO3_SAMPLING_MW,
+    .n_order = SO3_N_ORDER_NEGATIVE_FIRST,
+    .storage = SO3_STORAGE_COMPACT,
+    .dl_method = SSHT_DL_RISBO,
+    .steerable = 0};
+
+static int setup(void **state) {
+  so3_tune_set_file("");
+  *state = so3_async_start(2);
+  return 0;
+}
+
+static int teardown(void **state) {
+  so3_async_stop(*state);
+  so3_tune_clear();
+  return 0;
+}
+
+// The generators write (2N-1)*L*L coefficients whatever the storage.
+static complex double *random_flmn(const so3_parameters_t *parameters, int batch, int seed) {
+  const int size = so3_sampling_flmn_size(parameters);
+  complex double *flmn = malloc(batch * size * sizeof *flmn);
+  complex double *scratch =
+      malloc((2 * parameters->N - 1) * parameters->L * parameters->L * sizeof *scratch);
+  int k;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(scratch);
+  for (k = 0; k < batch; ++k) {
+    if (parameters->reality)
+      gen_flmn_real(scratch, parameters, seed + k);
+    else
+      gen_flmn_complex(scratch, parameters, seed + k);
+    memcpy(flmn + k * size, scratch, size * sizeof *flmn);
+  }
+  free(scratch);
+  return flmn;
+}
+
+static void assert_complex_equal(
+    const complex double *actual, const complex double *expected, int size) {
+  int i;
+  for (i = 0; i < size; ++i) {
+    assert_float_equal(creal(actual[i]), creal(expected[i]), 1e-10);
+    assert_float_equal(cimag(actual[i]), cimag(expected[i]), 1e-10);
+  }
+}
+
+// Every job has its own counter, so the callbacks need no lock.
+static void count_calls(so3_async_job_t *job, void *user_data) { ++*(int *)user_data; }
+
+static void count_and_release(so3_async_job_t *job, void *user_data) {
+  ++*(int *)user_data;
+  so3_async_release(job);
+}
+
+static void wait_and_release(so3_async_job_t **jobs, const int *calls) {
+  int k;
+  for (k = 0; k < NJOBS; ++k) {
+    so3_async_wait(jobs[k]);
+    assert_true(so3_async_poll(jobs[k]));
+    assert_int_equal(calls[k], 1);
+    so3_async_release(jobs[k]);
+  }
+}
+
+// Jobs queued together are gathered into batches, whose results must match
+// the blocking transforms signal by signal.
+static void test_async_complex(void **state) {
+  so3_async_t *pool = *state;
+  const so3_parameters_t *parameters = &small_parameters;
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  const int f_size = so3_sampling_f_size(parameters);
+  complex double *flmn = random_flmn(parameters, NJOBS, 1);
+  complex double *f = malloc(NJOBS * f_size * sizeof *f);
+  complex double *flmn_async = malloc(NJOBS * flmn_size * sizeof *flmn_async);
+  complex double *expected = malloc(f_size * sizeof *expected);
+  complex double *flmn_expected = malloc(flmn_size * sizeof *flmn_expected);
+  so3_async_job_t *jobs[NJOBS];
+  int calls[NJOBS] = {0};
+  int k;
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_async);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_expected);
+
+  for (k = 0; k < NJOBS; ++k)
+    jobs[k] = so3_submit_inverse(
+        pool, f + k * f_size, flmn + k * flmn_size, parameters, count_calls, &calls[k]);
+  wait_and_release(jobs, calls);
+
+  memset(calls, 0, sizeof calls);
+  for (k = 0; k < NJOBS; ++k)
+    jobs[k] = so3_submit_forward(
+        pool, flmn_async + k * flmn_size, f + k * f_size, parameters, count_calls,
+        &calls[k]);
+  wait_and_release(jobs, calls);
+
+  for (k = 0; k < NJOBS; ++k) {
+    so3_core_inverse_direct(expected, flmn + k * flmn_size, parameters);
+    assert_complex_equal(f + k * f_size, expected, f_size);
+    so3_core_forward_direct(flmn_expected, f + k * f_size, parameters);
+    assert_complex_equal(flmn_async + k * flmn_size, flmn_expected, flmn_size);
+  }
+
+  free(flmn);
+  free(f);
+  free(flmn_async);
+  free(expected);
+  free(flmn_expected);
+}
+
+static void test_async_real(void **state) {
+  so3_async_t *pool = *state;
+  so3_parameters_t parameters = small_parameters;
+  parameters.reality = 1;
+  parameters.sampling_scheme = SO3_SAMPLING_MW_SS;
+  const int flmn_size = so3_sampling_flmn_size(&parameters);
+  const int f_size = so3_sampling_f_size(&parameters);
+  complex double *flmn = random_flmn(&parameters, NJOBS, 5);
+  double *f = malloc(NJOBS * f_size * sizeof *f);
+  complex double *flmn_async = malloc(NJOBS * flmn_size * sizeof *flmn_async);
+  double *expected = malloc(f_size * sizeof *expected);
+  so3_async_job_t *jobs[NJOBS];
+  int calls[NJOBS] = {0};
+  int k, i;
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_async);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+
+  for (k = 0; k < NJOBS; ++k)
+    jobs[k] = so3_submit_inverse_real(
+        pool, f + k * f_size, flmn + k * flmn_size, &parameters, count_calls,
+        &calls[k]);
+  wait_and_release(jobs, calls);
+
+  // The round trip recovers the coefficients.
+  memset(calls, 0, sizeof calls);
+  for (k = 0; k < NJOBS; ++k)
+    jobs[k] = so3_submit_forward_real(
+        pool, flmn_async + k * flmn_size, f + k * f_size, &parameters, count_calls,
+        &calls[k]);
+  wait_and_release(jobs, calls);
+
+  for (k = 0; k < NJOBS; ++k) {
+    so3_core_inverse_direct_real(expected, flmn + k * flmn_size, &parameters);
+    for (i = 0; i < f_size; ++i)
+      assert_float_equal(f[k * f_size + i], expected[i], 1e-10);
+  }
+  assert_complex_equal(flmn_async, flmn, NJOBS * flmn_size);
+
+  free(flmn);
+  free(f);
+  free(flmn_async);
+  free(expected);
+}
+
+static void test_async_tuned(void **state) {
+  // Above SO3_SMALL_L_MAX the pool uses the tuned algorithm, and the workers
+  // share the identical jobs.
+  so3_async_t *pool = *state;
+  so3_parameters_t parameters = small_parameters;
+  parameters.L = SO3_SMALL_L_MAX + 4;
+  parameters.N = 2;
+  const int flmn_size = so3_sampling_flmn_size(&parameters);
+  const int f_size = so3_sampling_f_size(&parameters);
+  complex double *flmn = random_flmn(&parameters, NJOBS, 9);
+  complex double *f = malloc(NJOBS * f_size * sizeof *f);
+  complex double *expected = malloc(f_size * sizeof *expected);
+  so3_async_job_t *jobs[NJOBS];
+  int k;
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+
+  for (k = 0; k < NJOBS; ++k)
+    jobs[k] = so3_submit_inverse(
+        pool, f + k * f_size, flmn + k * flmn_size, &parameters, NULL, NULL);
+  for (k = 0; k < NJOBS; ++k) {
+    so3_async_wait(jobs[k]);
+    so3_async_release(jobs[k]);
+    so3_core_inverse_direct(expected, flmn + k * flmn_size, &parameters);
+    assert_complex_equal(f + k * f_size, expected, f_size);
+  }
+
+  free(flmn);
+  free(f);
+  free(expected);
+}
+
+static void test_async_convolve(void **state) {
+  so3_async_t *pool = *state;
+  so3_parameters_t f_parameters = small_parameters;
+  so3_parameters_t g_parameters = small_parameters;
+  g_parameters.L = 6;
+  so3_parameters_t h_parameters =
+      so3_conv_get_parameters_of_convolved_lmn(&f_parameters, &g_parameters);
+  const int h_size = so3_sampling_flmn_size(&h_parameters);
+  complex double *flmn = random_flmn(&f_parameters, 1, 3);
+  complex double *glmn = random_flmn(&g_parameters, 1, 4);
+  complex double *hlmn = malloc(h_size * sizeof *hlmn);
+  complex double *expected = malloc(h_size * sizeof *expected);
+  int calls = 0;
+  SO3_ERROR_MEM_ALLOC_CHECK(hlmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+
+  so3_async_job_t *job = so3_submit_convolve(
+      pool, hlmn, flmn, &f_parameters, glmn, &g_parameters, count_calls, &calls);
+  so3_async_wait(job);
+  so3_async_release(job);
+  assert_int_equal(calls, 1);
+
+  so3_conv_harmonic_convolution(
+      expected, &h_parameters, flmn, &f_parameters, glmn, &g_parameters);
+  assert_complex_equal(hlmn, expected, h_size);
+
+  free(flmn);
+  free(glmn);
+  free(hlmn);
+  free(expected);
+}
+
+// Handles released at submission or from the callback, with stopping the
+// pool as the only synchronisation.
+static void test_async_release(void **state) {
+  so3_async_t *pool = so3_async_start(3);
+  const so3_parameters_t *parameters = &small_parameters;
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  const int f_size = so3_sampling_f_size(parameters);
+  complex double *flmn = random_flmn(parameters, NJOBS, 13);
+  complex double *f = malloc(NJOBS * f_size * sizeof *f);
+  complex double *expected = malloc(f_size * sizeof *expected);
+  int calls[NJOBS] = {0};
+  int k;
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+
+  for (k = 0; k < NJOBS; ++k) {
+    if (k % 2)
+      so3_submit_inverse(
+          pool, f + k * f_size, flmn + k * flmn_size, parameters, count_and_release,
+          &calls[k]);
+    else
+      so3_async_release(so3_submit_inverse(
+          pool, f + k * f_size, flmn + k * flmn_size, parameters, count_calls,
+          &calls[k]));
+  }
+  so3_async_stop(pool);
+
+  for (k = 0; k < NJOBS; ++k) {
+    assert_int_equal(calls[k], 1);
+    so3_core_inverse_direct(expected, flmn + k * flmn_size, parameters);
+    assert_complex_equal(f + k * f_size, expected, f_size);
+  }
+
+  free(flmn);
+  free(f);
+  free(expected);
+}
+
+static void dummy_lock(void *data) { (void)data; }
+
+// The last pool to stop puts back the planner lock the application had.
+static void test_async_planner_lock(void **state) {
+  int data;
+  so3_fft_lock_t lock, unlock;
+  void *lock_data;
+  so3_async_t *first, *second;
+  (void)state;
+
+  so3_fft_set_planner_lock(dummy_lock, dummy_lock, &data);
+  first = so3_async_start(1);
+  second = so3_async_start(1);
+  so3_async_stop(first);
+  so3_async_stop(second);
+  so3_fft_get_planner_lock(&lock, &unlock, &lock_data);
+  assert_true(lock == dummy_lock && unlock == dummy_lock && lock_data == &data);
+  so3_fft_set_planner_lock(NULL, NULL, NULL);
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_setup_teardown(test_async_complex, setup, teardown),
+      cmocka_unit_test_setup_teardown(test_async_real, setup, teardown),
+      cmocka_unit_test_setup_teardown(test_async_tuned, setup, teardown),
+      cmocka_unit_test_setup_teardown(test_async_convolve, setup, teardown),
+      cmocka_unit_test(test_async_release),
+      cmocka_unit_test(test_async_planner_lock),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
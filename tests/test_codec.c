@@ -0,0 +1,232 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <complex.h>
+#include <math.h>
+
+#include "so3/so3_codec.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+static int flmn_index(int el, int m, int n, const so3_parameters_t *parameters) {
+  int ind;
+  if (parameters->reality)
+    so3_sampling_elmn2ind_real(&ind, el, m, n, parameters);
+  else
+    so3_sampling_elmn2ind(&ind, el, m, n, parameters);
+  return ind;
+}
+
+// Random coefficients whose magnitude decays with el, as for smooth signals.
+static complex double *gen_decaying(const so3_parameters_t *parameters, int seed) {
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  complex double *flmn = alloc_random_flmn(parameters, seed);
+  int ind, el, m, n;
+  for (ind = 0; ind < flmn_size; ++ind) {
+    if (parameters->reality)
+      so3_sampling_ind2elmn_real(&el, &m, &n, ind, parameters);
+    else
+      so3_sampling_ind2elmn(&el, &m, &n, ind, parameters);
+    flmn[ind] *= exp(-el / 2.0);
+  }
+  return flmn;
+}
+
+static void check_lossless(const so3_parameters_t *parameters) {
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  const size_t bound = so3_codec_encode_bound(parameters);
+  complex double *flmn = gen_decaying(parameters, 1);
+  complex double *decoded = malloc(flmn_size * sizeof *decoded);
+  unsigned char *data = malloc(bound);
+  size_t size, single_size;
+  int ind;
+  SO3_ERROR_MEM_ALLOC_CHECK(decoded);
+  SO3_ERROR_MEM_ALLOC_CHECK(data);
+
+  size = so3_codec_encode(data, flmn, 0.0, parameters);
+  assert_true(size <= bound);
+  assert_int_equal(so3_codec_size(data, bound), size);
+  memset(decoded, 0xff, flmn_size * sizeof *decoded);
+  assert_int_equal(so3_codec_decode(decoded, data, size, parameters), 0);
+  assert_memory_equal(decoded, flmn, flmn_size * sizeof *flmn);
+
+  // Coefficients of single precision keep only five of their eight bytes.
+  for (ind = 0; ind < flmn_size; ++ind)
+    flmn[ind] = (float)creal(flmn[ind]) + I * (float)cimag(flmn[ind]);
+  single_size = so3_codec_encode(data, flmn, 0.0, parameters);
+  assert_true(single_size < 0.65 * size);
+  assert_int_equal(so3_codec_decode(decoded, data, single_size, parameters), 0);
+  assert_memory_equal(decoded, flmn, flmn_size * sizeof *flmn);
+
+  free(flmn);
+  free(decoded);
+  free(data);
+}
+
+static void test_codec_lossless(void **state) {
+  so3_parameters_t parameters = *(const so3_parameters_t *)*state;
+  check_lossless(&parameters);
+  parameters.storage = SO3_STORAGE_COMPACT;
+  parameters.n_mode = SO3_N_MODE_EVEN;
+  check_lossless(&parameters);
+  parameters.reality = 1;
+  parameters.L0 = 3;
+  check_lossless(&parameters);
+}
+
+// Decode into another storage method and n-order, and compare coefficient by
+// coefficient.
+static void check_lossy(const so3_parameters_t *parameters) {
+  const double error_bound = 1e-6;
+  so3_parameters_t decoded_parameters = *parameters;
+  decoded_parameters.storage = SO3_STORAGE_COMPACT;
+  decoded_parameters.n_order = SO3_N_ORDER_ZERO_FIRST;
+  const int decoded_size = so3_sampling_flmn_size(&decoded_parameters);
+  complex double *flmn = gen_decaying(parameters, 2);
+  complex double *decoded = malloc(decoded_size * sizeof *decoded);
+  unsigned char *data = malloc(so3_codec_encode_bound(parameters));
+  size_t size, lossless_size;
+  int el, m, n;
+  SO3_ERROR_MEM_ALLOC_CHECK(decoded);
+  SO3_ERROR_MEM_ALLOC_CHECK(data);
+
+  lossless_size = so3_codec_encode(data, flmn, 0.0, parameters);
+  size = so3_codec_encode(data, flmn, error_bound, parameters);
+  assert_true(size < lossless_size / 3);
+  assert_int_equal(so3_codec_decode(decoded, data, size, &decoded_parameters), 0);
+
+  for (el = parameters->L0; el < parameters->L; ++el)
+    for (m = -el; m <= el; ++m)
+      for (n = parameters->reality ? 0 : -el; n <= el; ++n) {
+        if (abs(n) >= parameters->N ||
+            !so3_sampling_is_elmn_non_zero(el, m, n, parameters))
+          continue;
+        const complex double f = flmn[flmn_index(el, m, n, parameters)];
+        const complex double g = decoded[flmn_index(el, m, n, &decoded_parameters)];
+        assert_true(fabs(creal(f) - creal(g)) <= error_bound * (1 + 1e-12));
+        assert_true(fabs(cimag(f) - cimag(g)) <= error_bound * (1 + 1e-12));
+      }
+
+  free(flmn);
+  free(decoded);
+  free(data);
+}
+
+static void test_codec_lossy(void **state) {
+  so3_parameters_t parameters = *(const so3_parameters_t *)*state;
+  check_lossy(&parameters);
+  parameters.M = 5;
+  check_lossy(&parameters);
+  parameters.reality = 1;
+  check_lossy(&parameters);
+}
+
+// Decoding a single degree writes exactly the coefficients of that degree.
+static void test_codec_decode_el(void **state) {
+  const so3_parameters_t *parameters = *state;
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  const int el = 7;
+  complex double *flmn = gen_decaying(parameters, 3);
+  complex double *decoded = calloc(flmn_size, sizeof *decoded);
+  unsigned char *data = malloc(so3_codec_encode_bound(parameters));
+  int ind, el_ind, m, n;
+  SO3_ERROR_MEM_ALLOC_CHECK(decoded);
+  SO3_ERROR_MEM_ALLOC_CHECK(data);
+
+  const size_t size = so3_codec_encode(data, flmn, 1e-8, parameters);
+  assert_int_equal(so3_codec_decode_el(decoded, data, size, el, parameters), 0);
+  for (ind = 0; ind < flmn_size; ++ind) {
+    so3_sampling_ind2elmn(&el_ind, &m, &n, ind, parameters);
+    if (el_ind == el && abs(n) <= el) {
+      assert_float_equal(creal(decoded[ind]), creal(flmn[ind]), 1e-8);
+      assert_float_equal(cimag(decoded[ind]), cimag(flmn[ind]), 1e-8);
+    } else {
+      assert_true(decoded[ind] == 0.0);
+    }
+  }
+
+  free(flmn);
+  free(decoded);
+  free(data);
+}
+
+// Offset of the block of degree el in the header of encoded coefficients.
+static size_t get_offset(const unsigned char *data, int el) {
+  size_t offset = 0;
+  int i;
+  for (i = 7; i >= 0; --i)
+    offset = offset << 8 | data[32 + 8 * el + i];
+  return offset;
+}
+
+static void set_offset(unsigned char *data, int el, size_t offset) {
+  int i;
+  for (i = 0; i < 8; ++i)
+    data[32 + 8 * el + i] = (unsigned char)(offset >> (8 * i));
+}
+
+// Truncated or corrupt data are rejected without writing the coefficients.
+static void test_codec_invalid(void **state) {
+  const so3_parameters_t *parameters = *state;
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  const int L = parameters->L, N = parameters->N;
+  complex double *flmn = gen_decaying(parameters, 4);
+  complex double *decoded = calloc(flmn_size, sizeof *decoded);
+  complex double *zero = calloc(flmn_size, sizeof *zero);
+  unsigned char *data = malloc(so3_codec_encode_bound(parameters));
+  unsigned char *corrupt = malloc(so3_codec_encode_bound(parameters));
+  size_t size, cut;
+  SO3_ERROR_MEM_ALLOC_CHECK(decoded);
+  SO3_ERROR_MEM_ALLOC_CHECK(zero);
+  SO3_ERROR_MEM_ALLOC_CHECK(data);
+  SO3_ERROR_MEM_ALLOC_CHECK(corrupt);
+
+  size = so3_codec_encode(data, flmn, 1e-6, parameters);
+  for (cut = 0; cut < size; cut += cut < 64 ? 1 : 97) {
+    assert_int_equal(so3_codec_size(data, cut), 0);
+    assert_int_equal(so3_codec_decode(decoded, data, cut, parameters), -1);
+    assert_int_equal(so3_codec_decode_el(decoded, data, cut, 0, parameters), -1);
+  }
+  assert_memory_equal(decoded, zero, flmn_size * sizeof *decoded);
+
+  // An end beyond the data, offsets out of order, and the widest codes for
+  // the runs of the last block, whose payload then exceeds it.
+  memcpy(corrupt, data, size);
+  set_offset(corrupt, L, size);
+  assert_int_equal(so3_codec_size(corrupt, size), 0);
+  assert_int_equal(so3_codec_decode(decoded, corrupt, size, parameters), -1);
+  memcpy(corrupt, data, size);
+  set_offset(corrupt, 3, get_offset(corrupt, 4) + 1);
+  assert_int_equal(so3_codec_decode(decoded, corrupt, size, parameters), -1);
+  memcpy(corrupt, data, size);
+  memset(corrupt + get_offset(corrupt, L - 1), 64, 2 * N - 1);
+  assert_int_equal(so3_codec_size(corrupt, size), size);
+  assert_int_equal(so3_codec_decode(decoded, corrupt, size, parameters), -1);
+  assert_int_equal(so3_codec_decode_el(decoded, corrupt, size, L - 1, parameters), -1);
+  assert_memory_equal(decoded, zero, flmn_size * sizeof *decoded);
+
+  free(flmn);
+  free(decoded);
+  free(zero);
+  free(data);
+  free(corrupt);
+}
+
+int main(void) {
+  so3_parameters_t parameters = test_parameters(12, 6, SO3_STORAGE_PADDED);
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_prestate(test_codec_lossless, &parameters),
+      cmocka_unit_test_prestate(test_codec_lossy, &parameters),
+      cmocka_unit_test_prestate(test_codec_decode_el, &parameters),
+      cmocka_unit_test_prestate(test_codec_invalid, &parameters),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,216 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <complex.h>
+#include <math.h>
+
+#include "so3/so3_descriptor.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+#include "so3/so3_wigner.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+#define BATCH 3
+#define MIN(a, b) ((a < b) ? (a) : (b))
+
+static double cg_value(int el1, int m1, int el2, int m2, int el) {
+  double *cg = malloc((2 * el1 + 1) * (2 * el2 + 1) * sizeof *cg);
+  double value;
+  SO3_ERROR_MEM_ALLOC_CHECK(cg);
+  so3_descriptor_clebsch_gordan(cg, el1, el2, el);
+  value = cg[(m1 + el1) * (2 * el2 + 1) + m2 + el2];
+  free(cg);
+  return value;
+}
+
+// The coefficients agree with tabulated values, and the coupled states of all
+// degrees el are orthonormal.
+static void test_descriptor_clebsch_gordan(void **state) {
+  (void)state;
+  const int el1 = 20, el2 = 13, size = (2 * el1 + 1) * (2 * el2 + 1);
+  double *cg = malloc((el1 + el2 + 1) * size * sizeof *cg);
+  int el, elp, m1, m2, m;
+  SO3_ERROR_MEM_ALLOC_CHECK(cg);
+
+  assert_float_equal(cg_value(1, 1, 1, -1, 0), 1 / sqrt(3), 1e-14);
+  assert_float_equal(cg_value(1, 0, 1, 0, 0), -1 / sqrt(3), 1e-14);
+  assert_float_equal(cg_value(1, 1, 1, 0, 1), 1 / sqrt(2), 1e-14);
+  assert_float_equal(cg_value(1, 0, 1, 1, 1), -1 / sqrt(2), 1e-14);
+  assert_float_equal(cg_value(1, 0, 1, 0, 2), sqrt(2.0 / 3), 1e-14);
+  assert_float_equal(cg_value(2, -1, 1, 1, 2), -1 / sqrt(2), 1e-14);
+
+  for (el = el1 - el2; el <= el1 + el2; ++el)
+    so3_descriptor_clebsch_gordan(cg + el * size, el1, el2, el);
+  for (el = el1 - el2; el <= el1 + el2; ++el)
+    for (elp = el; elp <= el1 + el2; ++elp)
+      for (m = -el; m <= el; m += 5) {
+        double sum = 0.0;
+        for (m1 = -el1; m1 <= el1; ++m1) {
+          m2 = m - m1;
+          if (abs(m2) > el2)
+            continue;
+          sum += cg[el * size + (m1 + el1) * (2 * el2 + 1) + m2 + el2] *
+                 cg[elp * size + (m1 + el1) * (2 * el2 + 1) + m2 + el2];
+        }
+        assert_float_equal(sum, el == elp ? 1.0 : 0.0, 1e-12);
+      }
+  free(cg);
+}
+
+// The coefficients f_el,m,n of a complex signal in the layout of parameters,
+// including n < 0 of real signals.
+static complex double coefficient(
+    const complex double *flmn, int el, int m, int n, const so3_parameters_t *p) {
+  int ind;
+  if (el < p->L0 || abs(m) >= so3_sampling_mlim(p) || abs(n) >= p->N || abs(n) > el)
+    return 0.0;
+  if (!p->reality) {
+    so3_sampling_elmn2ind(&ind, el, m, n, p);
+    return flmn[ind];
+  }
+  if (n >= 0) {
+    so3_sampling_elmn2ind_real(&ind, el, m, n, p);
+    return flmn[ind];
+  }
+  so3_sampling_elmn2ind_real(&ind, el, -m, -n, p);
+  return ((m + n) % 2 ? -1.0 : 1.0) * conj(flmn[ind]);
+}
+
+static const so3_descriptor_triple_t triples[] = {
+    {1, 0, 1, 0, 2, 0},  {2, 1, 3, -1, 4, 0}, {3, -2, 3, 2, 0, 1},
+    {4, 3, 2, -4, 5, 2}, {7, 4, 6, 1, 3, -3}, {2, 0, 2, 0, 5, 0},
+};
+#define NTRIPLES (int)(sizeof triples / sizeof triples[0])
+
+// Rotate the signals by random rotations, which maps f_el,m,n to
+// sum_m' D^el_mm' f_el,m',n, and compare their descriptors.
+static void check_descriptor_invariance(const so3_parameters_t *parameters) {
+  const int L = parameters->L, N = parameters->N;
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  const int D_size = so3_wigner_D_size(L - 1, SO3_STORAGE_PADDED);
+  const double alphas[] = {0.3, 2.1, 5.9}, betas[] = {1.2, 0.1, 2.9};
+  const double gammas[] = {4.4, 0.7, 1.9};
+  so3_parameters_t D_parameters = {0};
+  complex double *flmn = malloc(BATCH * (2 * N - 1) * L * L * sizeof *flmn);
+  complex double *D = malloc(BATCH * D_size * sizeof *D);
+  complex double *bispectrum = malloc(2 * BATCH * NTRIPLES * sizeof *bispectrum);
+  double *power = malloc(2 * BATCH * L * sizeof *power);
+  int s, el, m, mp, n, ind, t;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(D);
+  SO3_ERROR_MEM_ALLOC_CHECK(bispectrum);
+  SO3_ERROR_MEM_ALLOC_CHECK(power);
+
+  // The generators zero the padded size beyond each signal, which the next
+  // signal then overwrites.
+  for (s = 0; s < BATCH; ++s) {
+    if (parameters->reality)
+      gen_flmn_real(flmn + s * flmn_size, parameters, s + 1);
+    else
+      gen_flmn_complex(flmn + s * flmn_size, parameters, s + 1);
+  }
+  so3_wigner_D_batch(
+      D, L - 1, alphas, betas, gammas, BATCH, SO3_STORAGE_PADDED,
+      SO3_N_ORDER_NEGATIVE_FIRST);
+  D_parameters.L = L;
+  D_parameters.N = L;
+  D_parameters.storage = SO3_STORAGE_PADDED;
+  D_parameters.n_order = SO3_N_ORDER_NEGATIVE_FIRST;
+
+  // Rotations do not preserve the limit of m, so the rotated signals are
+  // complex and of all orders m.
+  so3_parameters_t rotated_parameters = *parameters;
+  rotated_parameters.reality = 0;
+  rotated_parameters.storage = SO3_STORAGE_PADDED;
+  rotated_parameters.n_order = SO3_N_ORDER_NEGATIVE_FIRST;
+  rotated_parameters.n_mode = SO3_N_MODE_ALL;
+  rotated_parameters.sampling_scheme = SO3_SAMPLING_MW;
+  const int rotated_size = so3_sampling_flmn_size(&rotated_parameters);
+  complex double *rotated = calloc(BATCH * rotated_size, sizeof *rotated);
+  SO3_ERROR_MEM_ALLOC_CHECK(rotated);
+  for (s = 0; s < BATCH; ++s)
+    for (el = 0; el < L; ++el)
+      for (n = -MIN(el, N - 1); n <= MIN(el, N - 1); ++n)
+        for (m = -el; m <= el; ++m) {
+          complex double sum = 0.0;
+          for (mp = -el; mp <= el; ++mp) {
+            so3_sampling_elmn2ind(&ind, el, m, mp, &D_parameters);
+            sum += D[s * D_size + ind] *
+                   coefficient(flmn + s * flmn_size, el, mp, n, parameters);
+          }
+          so3_sampling_elmn2ind(&ind, el, m, n, &rotated_parameters);
+          rotated[s * rotated_size + ind] = sum;
+        }
+
+  so3_descriptor_power(power, flmn, BATCH, parameters);
+  so3_descriptor_power(power + BATCH * L, rotated, BATCH, &rotated_parameters);
+  so3_descriptor_bispectrum(bispectrum, flmn, BATCH, triples, NTRIPLES, parameters);
+  so3_descriptor_bispectrum(
+      bispectrum + BATCH * NTRIPLES, rotated, BATCH, triples, NTRIPLES,
+      &rotated_parameters);
+
+  for (s = 0; s < BATCH; ++s) {
+    for (el = 0; el < L; ++el) {
+      double expected = 0.0;
+      for (n = -N + 1; n < N; ++n)
+        for (m = -el; m <= el; ++m) {
+          const complex double f =
+              coefficient(flmn + s * flmn_size, el, m, n, parameters);
+          expected += creal(f * conj(f));
+        }
+      assert_float_equal(power[s * L + el], expected, 1e-10);
+      assert_float_equal(power[(BATCH + s) * L + el], expected, 1e-10);
+    }
+    for (t = 0; t < NTRIPLES; ++t) {
+      const complex double b = bispectrum[s * NTRIPLES + t];
+      const complex double b_rotated = bispectrum[(BATCH + s) * NTRIPLES + t];
+      assert_float_equal(creal(b_rotated), creal(b), 1e-10);
+      assert_float_equal(cimag(b_rotated), cimag(b), 1e-10);
+    }
+  }
+  // Entries of zero coefficients or that violate the triangle condition vanish.
+  assert_float_equal(cabs(bispectrum[2]), 0.0, 0.0);
+  assert_float_equal(cabs(bispectrum[5]), 0.0, 0.0);
+
+  free(flmn);
+  free(rotated);
+  free(D);
+  free(bispectrum);
+  free(power);
+}
+
+static void test_descriptor_invariance(void **state) {
+  so3_parameters_t parameters = *(const so3_parameters_t *)*state;
+  check_descriptor_invariance(&parameters);
+  parameters.storage = SO3_STORAGE_COMPACT;
+  parameters.n_order = SO3_N_ORDER_ZERO_FIRST;
+  check_descriptor_invariance(&parameters);
+  parameters.sampling_scheme = SO3_SAMPLING_MW_SS;
+  parameters.L0 = 2;
+  check_descriptor_invariance(&parameters);
+}
+
+static void test_descriptor_invariance_real(void **state) {
+  so3_parameters_t parameters = *(const so3_parameters_t *)*state;
+  parameters.reality = 1;
+  check_descriptor_invariance(&parameters);
+  parameters.storage = SO3_STORAGE_COMPACT;
+  parameters.n_order = SO3_N_ORDER_ZERO_FIRST;
+  check_descriptor_invariance(&parameters);
+}
+
+int main(void) {
+  so3_parameters_t parameters = test_parameters(8, 5, SO3_STORAGE_PADDED);
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_descriptor_clebsch_gordan),
+      cmocka_unit_test_prestate(test_descriptor_invariance, &parameters),
+      cmocka_unit_test_prestate(test_descriptor_invariance_real, &parameters),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,186 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <complex.h>
+#include <math.h>
+
+#include "so3/so3_error.h"
+#include "so3/so3_fft.h"
+#include "so3/so3_types.h"
+
+#include <cmocka.h>
+
+static const so3_fft_backend_t backends[] = {
+    SO3_FFT_BACKEND_FFTW, SO3_FFT_BACKEND_BUILTIN};
+
+static complex double naive_dft(const complex double *x, int n, int k, int stride, int sign) {
+  complex double sum = 0.0;
+  int j;
+  for (j = 0; j < n; ++j)
+    sum += x[j * stride] * cexp(sign * 2.0 * SO3_PI * I * (double)((long)j * k % n) / n);
+  return sum;
+}
+
+static void test_fft_1d(void **state) {
+  // Radix 4, 2, 3, 5, 7, a generic odd radix and a large prime (Bluestein).
+  const int lengths[] = {1, 2, 8, 12, 15, 21, 29, 97};
+  const int signs[] = {SO3_FFT_FORWARD, SO3_FFT_BACKWARD};
+  int b, l, s, k;
+
+  for (b = 0; b < 2; ++b) {
+    so3_fft_set_backend(backends[b]);
+    for (l = 0; l < sizeof lengths / sizeof *lengths; ++l) {
+      const int n = lengths[l];
+      complex double *x = malloc(n * sizeof *x);
+      complex double *y = malloc(n * sizeof *y);
+      SO3_ERROR_MEM_ALLOC_CHECK(x);
+      SO3_ERROR_MEM_ALLOC_CHECK(y);
+      for (k = 0; k < n; ++k)
+        x[k] = sin(1.3 * k) + I * cos(0.7 * k);
+
+      for (s = 0; s < 2; ++s) {
+        so3_fft_plan_t *plan = so3_fft_plan_dft_1d(n, x, y, signs[s], SO3_FFT_ESTIMATE);
+        so3_fft_execute(plan);
+        so3_fft_destroy_plan(plan);
+        for (k = 0; k < n; ++k) {
+          complex double expected = naive_dft(x, n, k, 1, signs[s]);
+          assert_float_equal(creal(y[k]), creal(expected), 1e-10);
+          assert_float_equal(cimag(y[k]), cimag(expected), 1e-10);
+        }
+      }
+      free(x);
+      free(y);
+    }
+  }
+  so3_fft_set_backend(SO3_FFT_DEFAULT_BACKEND);
+}
+
+static void test_fft_many_strided(void **state) {
+  // Columns of a 7 x 5 row-major array, in place.
+  const int rows = 7, cols = 5;
+  int b, r, c;
+
+  for (b = 0; b < 2; ++b) {
+    so3_fft_set_backend(backends[b]);
+    complex double *x = malloc(rows * cols * sizeof *x);
+    complex double *y = malloc(rows * cols * sizeof *y);
+    SO3_ERROR_MEM_ALLOC_CHECK(x);
+    SO3_ERROR_MEM_ALLOC_CHECK(y);
+    for (r = 0; r < rows * cols; ++r)
+      x[r] = y[r] = cos(0.3 * r * r) - I * r;
+
+    so3_fft_plan_t *plan = so3_fft_plan_many_dft(
+        1, &rows, cols, y, NULL, cols, 1, y, NULL, cols, 1, SO3_FFT_BACKWARD,
+        SO3_FFT_ESTIMATE);
+    so3_fft_execute(plan);
+    so3_fft_destroy_plan(plan);
+
+    for (c = 0; c < cols; ++c)
+      for (r = 0; r < rows; ++r) {
+        complex double expected = naive_dft(x + c, rows, r, cols, SO3_FFT_BACKWARD);
+        assert_float_equal(creal(y[c + cols * r]), creal(expected), 1e-10);
+        assert_float_equal(cimag(y[c + cols * r]), cimag(expected), 1e-10);
+      }
+    free(x);
+    free(y);
+  }
+  so3_fft_set_backend(SO3_FFT_DEFAULT_BACKEND);
+}
+
+static void test_fft_real_round_trip(void **state) {
+  // In-place 3D c2r of the out-of-place 2D r2c of every slice.
+  const int n0 = 3, n1 = 4, n2 = 7, half = n2 / 2 + 1;
+  int b, i, j;
+
+  for (b = 0; b < 2; ++b) {
+    so3_fft_set_backend(backends[b]);
+    double *x = malloc(n0 * n1 * n2 * sizeof *x);
+    complex double *X = calloc(n0 * n1 * half, sizeof *X);
+    complex double *slice = malloc(n1 * half * sizeof *slice);
+    SO3_ERROR_MEM_ALLOC_CHECK(x);
+    SO3_ERROR_MEM_ALLOC_CHECK(X);
+    SO3_ERROR_MEM_ALLOC_CHECK(slice);
+    for (i = 0; i < n0 * n1 * n2; ++i)
+      x[i] = sin(1.7 * i) + 0.1 * i;
+
+    // 2D transforms over (n1, n2), then 1D transforms over n0.
+    for (i = 0; i < n0; ++i) {
+      so3_fft_plan_t *plan =
+          so3_fft_plan_dft_r2c_2d(n1, n2, x + i * n1 * n2, slice, SO3_FFT_ESTIMATE);
+      so3_fft_execute(plan);
+      so3_fft_destroy_plan(plan);
+      for (j = 0; j < n1 * half; ++j)
+        X[i * n1 * half + j] = slice[j];
+    }
+    so3_fft_plan_t *plan = so3_fft_plan_many_dft(
+        1, &n0, n1 * half, X, NULL, n1 * half, 1, X, NULL, n1 * half, 1,
+        SO3_FFT_FORWARD, SO3_FFT_ESTIMATE);
+    so3_fft_execute(plan);
+    so3_fft_destroy_plan(plan);
+
+    plan = so3_fft_plan_dft_c2r_3d(n0, n1, n2, X, (double *)X, SO3_FFT_ESTIMATE);
+    so3_fft_execute(plan);
+    so3_fft_destroy_plan(plan);
+
+    // Rows of the in-place result are padded to 2*half.
+    for (i = 0; i < n0 * n1; ++i)
+      for (j = 0; j < n2; ++j)
+        assert_float_equal(
+            ((double *)X)[i * 2 * half + j] / (n0 * n1 * n2), x[i * n2 + j], 1e-12);
+
+    free(x);
+    free(X);
+    free(slice);
+  }
+  so3_fft_set_backend(SO3_FFT_DEFAULT_BACKEND);
+}
+
+// The planner lock is held while FFTW plans are created and destroyed, but
+// not while they are executed.
+static void count_lock(void *data) { ++((int *)data)[0]; }
+
+static void count_unlock(void *data) { ++((int *)data)[1]; }
+
+static void test_fft_planner_lock(void **state) {
+  complex double x[8] = {1.0};
+  int counts[2] = {0, 0};
+  so3_fft_lock_t lock, unlock;
+  void *data;
+  so3_fft_plan_t *plan;
+
+  so3_fft_set_backend(SO3_FFT_BACKEND_FFTW);
+  so3_fft_set_planner_lock(count_lock, count_unlock, counts);
+  so3_fft_get_planner_lock(&lock, &unlock, &data);
+  assert_true(lock == count_lock && unlock == count_unlock && data == counts);
+  plan = so3_fft_plan_dft_1d(8, x, x, SO3_FFT_FORWARD, SO3_FFT_ESTIMATE);
+  assert_int_equal(counts[0], 1);
+  assert_int_equal(counts[1], 1);
+  so3_fft_execute(plan);
+  assert_int_equal(counts[0], 1);
+  so3_fft_destroy_plan(plan);
+  assert_int_equal(counts[0], 2);
+  assert_int_equal(counts[1], 2);
+
+  // The builtin backend has no planner.
+  so3_fft_set_backend(SO3_FFT_BACKEND_BUILTIN);
+  so3_fft_destroy_plan(so3_fft_plan_dft_1d(8, x, x, SO3_FFT_FORWARD, SO3_FFT_ESTIMATE));
+  assert_int_equal(counts[0], 2);
+
+  so3_fft_set_planner_lock(NULL, NULL, NULL);
+  so3_fft_get_planner_lock(&lock, &unlock, &data);
+  assert_true(lock == NULL && unlock == NULL && data == NULL);
+  so3_fft_set_backend(SO3_FFT_DEFAULT_BACKEND);
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_fft_1d),
+      cmocka_unit_test(test_fft_many_strided),
+      cmocka_unit_test(test_fft_real_round_trip),
+      cmocka_unit_test(test_fft_planner_lock),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
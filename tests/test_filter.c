@@ -0,0 +1,197 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <complex.h>
+
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_filter.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_small.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+#define BATCH 3
+
+// Filters with entries for every (el, n) and every flmn index.
+static void random_filters(
+    double *eln, complex double *elmn, const so3_parameters_t *parameters) {
+  const int L = parameters->L, N = parameters->N;
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  int i;
+  for (i = 0; i < L * (2 * N - 1); ++i)
+    eln[i] = ran2_dp(3);
+  for (i = 0; i < flmn_size; ++i)
+    elmn[i] = ran2_dp(3) + I * ran2_dp(3);
+}
+
+// Filter separately: forward transform, multiply and inverse transform.
+static void reference_filter(
+    complex double *g, const complex double *f, const so3_filter_t *filter,
+    const so3_parameters_t *parameters) {
+  const int N = parameters->N;
+  complex double *flmn = calloc(so3_sampling_flmn_size(parameters), sizeof *flmn);
+  so3_flmn_iter_t iter;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+
+  so3_core_forward_direct(flmn, f, parameters);
+  so3_flmn_iter_init(&iter, parameters);
+  while (so3_flmn_iter_next(&iter)) {
+    if (filter->eln)
+      flmn[iter.ind] *= filter->eln[iter.el * (2 * N - 1) + N - 1 + iter.n];
+    if (filter->elmn)
+      flmn[iter.ind] *= filter->elmn[iter.ind];
+  }
+  so3_core_inverse_direct(g, flmn, parameters);
+  free(flmn);
+}
+
+static void check_filter(const so3_parameters_t *parameters, int fused) {
+  const int f_size = so3_sampling_f_size(parameters);
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  const int L = parameters->L, N = parameters->N;
+  complex double *flmn = malloc((2 * N - 1) * L * L * sizeof *flmn);
+  complex double *f = malloc(BATCH * f_size * sizeof *f);
+  complex double *g = malloc(BATCH * f_size * sizeof *g);
+  complex double *expected = malloc(f_size * sizeof *expected);
+  double *eln = malloc(L * (2 * N - 1) * sizeof *eln);
+  complex double *elmn = malloc(flmn_size * sizeof *elmn);
+  int k, variant;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(g);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+  SO3_ERROR_MEM_ALLOC_CHECK(eln);
+  SO3_ERROR_MEM_ALLOC_CHECK(elmn);
+
+  for (k = 0; k < BATCH; ++k) {
+    gen_flmn_complex(flmn, parameters, k + 1);
+    so3_core_inverse_direct(f + k * f_size, flmn, parameters);
+  }
+  random_filters(eln, elmn, parameters);
+
+  so3_filter_plan_t *plan = so3_filter_plan_init(parameters);
+  assert_int_equal(so3_filter_plan_is_fused(plan), fused);
+
+  const so3_filter_t filters[] = {{eln, NULL}, {NULL, elmn}, {eln, elmn}};
+  for (variant = 0; variant < 3; ++variant) {
+    so3_filter(g, f, &filters[variant], BATCH, plan);
+    for (k = 0; k < BATCH; ++k) {
+      reference_filter(expected, f + k * f_size, &filters[variant], parameters);
+      assert_complex_array_equal(g + k * f_size, expected, f_size, 1e-10);
+    }
+  }
+
+  // In place.
+  memcpy(g, f, BATCH * f_size * sizeof *f);
+  so3_filter(g, g, &filters[2], BATCH, plan);
+  reference_filter(expected, f + (BATCH - 1) * f_size, &filters[2], parameters);
+  assert_complex_array_equal(g + (BATCH - 1) * f_size, expected, f_size, 1e-10);
+
+  so3_filter_plan_free(plan);
+  free(flmn);
+  free(f);
+  free(g);
+  free(expected);
+  free(eln);
+  free(elmn);
+}
+
+static void test_filter_fused(void **state) {
+  const so3_parameters_t *base_parameters = *state;
+  so3_parameters_t parameters = *base_parameters;
+  check_filter(&parameters, 1);
+
+  parameters.sampling_scheme = SO3_SAMPLING_MW_SS;
+  parameters.storage = SO3_STORAGE_PADDED;
+  parameters.n_order = SO3_N_ORDER_ZERO_FIRST;
+  check_filter(&parameters, 1);
+
+  parameters = *base_parameters;
+  parameters.L0 = 2;
+  parameters.n_mode = SO3_N_MODE_EVEN;
+  check_filter(&parameters, 1);
+}
+
+static void test_filter_fallback(void **state) {
+  const so3_parameters_t *base_parameters = *state;
+  so3_parameters_t parameters = *base_parameters;
+  parameters.M = 5;
+  check_filter(&parameters, 0);
+
+  parameters = *base_parameters;
+  parameters.n_mode = SO3_N_MODE_L;
+  check_filter(&parameters, 0);
+}
+
+// Below and above SO3_SMALL_L_MAX the plan keeps a small band-limit plan or
+// uses the direct transforms, with its scratch reused by repeated calls.
+static void check_filter_real(const so3_parameters_t *parameters_in) {
+  so3_parameters_t parameters = *parameters_in;
+  const int f_size = so3_sampling_f_size(&parameters);
+  const int L = parameters.L, N = parameters.N;
+  complex double *flmn = malloc((2 * N - 1) * L * L * sizeof *flmn);
+  double *f = malloc(f_size * sizeof *f);
+  double *g = malloc(f_size * sizeof *g);
+  double *expected = malloc(f_size * sizeof *expected);
+  double *eln = malloc(L * (2 * N - 1) * sizeof *eln);
+  int i;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(g);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+  SO3_ERROR_MEM_ALLOC_CHECK(eln);
+
+  gen_flmn_real(flmn, &parameters, 1);
+  so3_core_inverse_direct_real(f, flmn, &parameters);
+  for (i = 0; i < L * (2 * N - 1); ++i)
+    eln[i] = ran2_dp(4);
+
+  so3_filter_plan_t *plan = so3_filter_plan_init(&parameters);
+  assert_int_equal(so3_filter_plan_is_fused(plan), 0);
+  const so3_filter_t filter = {eln, NULL};
+  so3_filter_real(g, f, &filter, 1, plan);
+  so3_filter_real(g, f, &filter, 1, plan);
+  so3_filter_plan_free(plan);
+
+  so3_core_forward_direct_real(flmn, f, &parameters);
+  so3_flmn_iter_t iter;
+  so3_flmn_iter_init(&iter, &parameters);
+  while (so3_flmn_iter_next(&iter))
+    flmn[iter.ind] *= eln[iter.el * (2 * N - 1) + N - 1 + iter.n];
+  so3_core_inverse_direct_real(expected, flmn, &parameters);
+  for (i = 0; i < f_size; ++i)
+    assert_float_equal(g[i], expected[i], 1e-10);
+
+  free(flmn);
+  free(f);
+  free(g);
+  free(expected);
+  free(eln);
+}
+
+static void test_filter_real(void **state) {
+  const so3_parameters_t *base_parameters = *state;
+  so3_parameters_t parameters = *base_parameters;
+  parameters.reality = 1;
+  check_filter_real(&parameters);
+
+  parameters.L = SO3_SMALL_L_MAX + 2;
+  check_filter_real(&parameters);
+}
+
+int main(void) {
+  so3_parameters_t parameters = test_parameters(8, 4, SO3_STORAGE_COMPACT);
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_prestate(test_filter_fused, &parameters),
+      cmocka_unit_test_prestate(test_filter_fallback, &parameters),
+      cmocka_unit_test_prestate(test_filter_real, &parameters),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,295 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <complex.h>
+#include <math.h>
+
+#include "so3/so3_error.h"
+#include "so3/so3_flmn.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+static void for_each_layout(void (*fn)(so3_parameters_t const *)) {
+  const so3_storage_t storages[] = {SO3_STORAGE_PADDED, SO3_STORAGE_COMPACT};
+  const so3_n_order_t n_orders[] = {
+      SO3_N_ORDER_ZERO_FIRST, SO3_N_ORDER_NEGATIVE_FIRST};
+  const so3_n_mode_t n_modes[] = {
+      SO3_N_MODE_ALL, SO3_N_MODE_EVEN, SO3_N_MODE_ODD, SO3_N_MODE_MAXIMUM,
+      SO3_N_MODE_L};
+  for (int s = 0; s < 2; ++s)
+    for (int o = 0; o < 2; ++o)
+      for (int reality = 0; reality < 2; ++reality)
+        for (int mode = 0; mode < 5; ++mode)
+          for (int L0 = 0; L0 < 3; L0 += 2)
+            for (int M = 3; M <= 7; M += 4) {
+              so3_parameters_t parameters = {
+                  .L0 = L0,
+                  .L = 7,
+                  .N = 4,
+                  .M = M,
+                  .reality = reality,
+                  .n_order = n_orders[o],
+                  .storage = storages[s],
+                  .n_mode = n_modes[mode]};
+              fn(&parameters);
+            }
+}
+
+static complex double *random_array(int size, int seed) {
+  complex double *x = malloc(size * sizeof *x);
+  SO3_ERROR_MEM_ALLOC_CHECK(x);
+  for (int i = 0; i < size; ++i)
+    x[i] = (2.0 * ran2_dp(seed) - 1.0) + I * (2.0 * ran2_dp(seed) - 1.0);
+  return x;
+}
+
+static int is_active(const so3_flmn_iter_t *iter, so3_parameters_t const *parameters) {
+  return so3_sampling_is_elmn_non_zero(iter->el, iter->m, iter->n, parameters);
+}
+
+// Weight of a stored coefficient in sums over the full array.
+static double multiplicity(int n, so3_parameters_t const *parameters) {
+  return parameters->reality && n > 0 ? 2.0 : 1.0;
+}
+
+static void assert_complex_equal(complex double actual, complex double expected) {
+  assert_float_equal(creal(actual), creal(expected), 1e-12);
+  assert_float_equal(cimag(actual), cimag(expected), 1e-12);
+}
+
+static void assert_updates(so3_parameters_t const *parameters) {
+  const int size = so3_sampling_flmn_size(parameters);
+  const int L = parameters->L, N = parameters->N;
+  const complex double alpha = 0.5 - 1.5 * I;
+  complex double *x = random_array(size, 1);
+  complex double *y = random_array(size, 2);
+  complex double *axpy = random_array(size, 3);
+  complex double *scaled = random_array(size, 4);
+  complex double *by_el = random_array(size, 5);
+  complex double *by_eln = random_array(size, 6);
+  double *el_weights = malloc(L * sizeof *el_weights);
+  double *eln_weights = malloc(L * (2 * N - 1) * sizeof *eln_weights);
+  so3_flmn_iter_t iter;
+  SO3_ERROR_MEM_ALLOC_CHECK(el_weights);
+  SO3_ERROR_MEM_ALLOC_CHECK(eln_weights);
+
+  for (int i = 0; i < L; ++i)
+    el_weights[i] = ran2_dp(7);
+  for (int i = 0; i < L * (2 * N - 1); ++i)
+    eln_weights[i] = ran2_dp(7);
+  for (int i = 0; i < size; ++i)
+    axpy[i] = scaled[i] = by_el[i] = by_eln[i] = y[i];
+
+  so3_flmn_axpy(axpy, alpha, x, parameters);
+  so3_flmn_scale(scaled, alpha, parameters);
+  so3_flmn_scale_by_el(by_el, el_weights, parameters);
+  so3_flmn_scale_by_eln(by_eln, eln_weights, parameters);
+
+  // Coefficients that are zero by construction must not be touched.
+  so3_flmn_iter_init(&iter, parameters);
+  while (so3_flmn_iter_next(&iter)) {
+    const int i = iter.ind;
+    if (is_active(&iter, parameters)) {
+      const double w = eln_weights[iter.el * (2 * N - 1) + N - 1 + iter.n];
+      assert_complex_equal(axpy[i], y[i] + alpha * x[i]);
+      assert_complex_equal(scaled[i], alpha * y[i]);
+      assert_complex_equal(by_el[i], el_weights[iter.el] * y[i]);
+      assert_complex_equal(by_eln[i], w * y[i]);
+    } else {
+      assert_true(axpy[i] == y[i]);
+      assert_true(scaled[i] == y[i]);
+      assert_true(by_el[i] == y[i]);
+      assert_true(by_eln[i] == y[i]);
+    }
+  }
+
+  free(x);
+  free(y);
+  free(axpy);
+  free(scaled);
+  free(by_el);
+  free(by_eln);
+  free(el_weights);
+  free(eln_weights);
+}
+
+static void test_flmn_updates(void **state) {
+  (void)state;
+  for_each_layout(assert_updates);
+}
+
+static void assert_reductions(so3_parameters_t const *parameters) {
+  const int size = so3_sampling_flmn_size(parameters);
+  const int L = parameters->L, N = parameters->N;
+  complex double *x = random_array(size, 8);
+  complex double *y = random_array(size, 9);
+  double *weights = malloc(L * (2 * N - 1) * sizeof *weights);
+  double *norms = malloc(L * sizeof *norms);
+  double *expected_norms = calloc(L, sizeof *expected_norms);
+  complex double dot = 0.0, weighted_dot = 0.0;
+  double norm = 0.0;
+  so3_flmn_iter_t iter;
+  SO3_ERROR_MEM_ALLOC_CHECK(weights);
+  SO3_ERROR_MEM_ALLOC_CHECK(norms);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected_norms);
+
+  for (int i = 0; i < L * (2 * N - 1); ++i)
+    weights[i] = ran2_dp(10);
+
+  so3_flmn_iter_init(&iter, parameters);
+  while (so3_flmn_iter_next(&iter)) {
+    if (!is_active(&iter, parameters))
+      continue;
+    const int i = iter.ind;
+    const double c = multiplicity(iter.n, parameters);
+    const double w = weights[iter.el * (2 * N - 1) + N - 1 + iter.n];
+    complex double term = conj(x[i]) * y[i];
+    // For real signals, the coefficient of -n adds the complex conjugate.
+    if (c == 2.0)
+      term = creal(term);
+    dot += c * term;
+    weighted_dot += c * w * term;
+    norm += c * creal(conj(x[i]) * x[i]);
+    expected_norms[iter.el] += c * creal(conj(x[i]) * x[i]);
+  }
+
+  assert_complex_equal(so3_flmn_dot(x, y, parameters), dot);
+  assert_complex_equal(so3_flmn_weighted_dot(x, y, weights, parameters), weighted_dot);
+  assert_float_equal(so3_flmn_norm(x, parameters), sqrt(norm), 1e-12);
+  so3_flmn_norm_per_el(norms, x, parameters);
+  for (int el = 0; el < L; ++el)
+    assert_float_equal(norms[el], sqrt(expected_norms[el]), 1e-12);
+
+  free(x);
+  free(y);
+  free(weights);
+  free(norms);
+  free(expected_norms);
+}
+
+static void test_flmn_reductions(void **state) {
+  (void)state;
+  for_each_layout(assert_reductions);
+}
+
+// Inner products of real signals must equal those of their full coefficients.
+static void test_flmn_real_matches_complex(void **state) {
+  (void)state;
+  const so3_parameters_t real_parameters = {
+      .L0 = 1,
+      .L = 9,
+      .N = 5,
+      .reality = 1,
+      .n_order = SO3_N_ORDER_NEGATIVE_FIRST,
+      .storage = SO3_STORAGE_COMPACT,
+      .n_mode = SO3_N_MODE_ALL};
+  so3_parameters_t complex_parameters = real_parameters;
+  complex_parameters.reality = 0;
+  const int L = real_parameters.L, N = real_parameters.N;
+  const int padded_size = (2 * N - 1) * L * L;
+  complex double *x_real = malloc(padded_size * sizeof *x_real);
+  complex double *y_real = malloc(padded_size * sizeof *y_real);
+  complex double *x = calloc(padded_size, sizeof *x);
+  complex double *y = calloc(padded_size, sizeof *y);
+  double norms_real[9], norms[9];
+  so3_flmn_iter_t iter;
+  SO3_ERROR_MEM_ALLOC_CHECK(x_real);
+  SO3_ERROR_MEM_ALLOC_CHECK(y_real);
+  SO3_ERROR_MEM_ALLOC_CHECK(x);
+  SO3_ERROR_MEM_ALLOC_CHECK(y);
+
+  gen_flmn_real(x_real, &real_parameters, 11);
+  gen_flmn_real(y_real, &real_parameters, 12);
+  so3_flmn_iter_init(&iter, &real_parameters);
+  while (so3_flmn_iter_next(&iter)) {
+    int ind, ind_neg;
+    const double sign = (iter.m + iter.n) % 2 ? -1.0 : 1.0;
+    so3_sampling_elmn2ind(&ind, iter.el, iter.m, iter.n, &complex_parameters);
+    so3_sampling_elmn2ind(&ind_neg, iter.el, -iter.m, -iter.n, &complex_parameters);
+    x[ind] = x_real[iter.ind];
+    y[ind] = y_real[iter.ind];
+    x[ind_neg] = sign * conj(x_real[iter.ind]);
+    y[ind_neg] = sign * conj(y_real[iter.ind]);
+  }
+
+  assert_complex_equal(
+      so3_flmn_dot(x_real, y_real, &real_parameters),
+      so3_flmn_dot(x, y, &complex_parameters));
+  so3_flmn_norm_per_el(norms_real, x_real, &real_parameters);
+  so3_flmn_norm_per_el(norms, x, &complex_parameters);
+  for (int el = 0; el < L; ++el)
+    assert_float_equal(norms_real[el], norms[el], 1e-12);
+
+  free(x_real);
+  free(y_real);
+  free(x);
+  free(y);
+}
+
+// Padding to larger band-limits in another layout and truncating back must
+// give the same coefficients, with zeros everywhere else.
+static void assert_change_bandlimit(so3_parameters_t const *parameters) {
+  const int size = so3_sampling_flmn_size(parameters);
+  so3_parameters_t large = *parameters;
+  large.L0 = 0;
+  large.L = parameters->L + 2;
+  large.N = parameters->N + 1;
+  large.M = 0;
+  large.n_mode = SO3_N_MODE_ALL;
+  large.storage = SO3_STORAGE_PADDED;
+  large.n_order = parameters->n_order == SO3_N_ORDER_ZERO_FIRST
+                      ? SO3_N_ORDER_NEGATIVE_FIRST
+                      : SO3_N_ORDER_ZERO_FIRST;
+  const int large_size = so3_sampling_flmn_size(&large);
+  complex double *x = random_array(size, 13);
+  complex double *padded = random_array(large_size, 14);
+  complex double *truncated = random_array(size, 15);
+  double norm = 0.0, padded_norm = 0.0;
+  so3_flmn_iter_t iter;
+
+  so3_flmn_change_bandlimit(padded, &large, x, parameters);
+  so3_flmn_change_bandlimit(truncated, parameters, padded, &large);
+  so3_flmn_iter_init(&iter, parameters);
+  while (so3_flmn_iter_next(&iter)) {
+    int ind;
+    if (!is_active(&iter, parameters)) {
+      assert_true(truncated[iter.ind] == 0.0);
+      continue;
+    }
+    if (parameters->reality)
+      so3_sampling_elmn2ind_real(&ind, iter.el, iter.m, iter.n, &large);
+    else
+      so3_sampling_elmn2ind(&ind, iter.el, iter.m, iter.n, &large);
+    assert_true(padded[ind] == x[iter.ind]);
+    assert_true(truncated[iter.ind] == x[iter.ind]);
+    norm += pow(cabs(x[iter.ind]), 2);
+  }
+  for (int i = 0; i < large_size; ++i)
+    padded_norm += pow(cabs(padded[i]), 2);
+  assert_float_equal(padded_norm, norm, 1e-12);
+
+  free(x);
+  free(padded);
+  free(truncated);
+}
+
+static void test_flmn_change_bandlimit(void **state) {
+  (void)state;
+  for_each_layout(assert_change_bandlimit);
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_flmn_updates),
+      cmocka_unit_test(test_flmn_reductions),
+      cmocka_unit_test(test_flmn_real_matches_complex),
+      cmocka_unit_test(test_flmn_change_bandlimit),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,169 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <math.h>
+
+#include "so3/so3_error.h"
+#include "so3/so3_grid.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+// Row-major Rz(alpha) Ry(beta) Rz(gamma).
+static void euler_to_matrix(double *R, double alpha, double beta, double gamma) {
+  const double ca = cos(alpha), sa = sin(alpha), cb = cos(beta), sb = sin(beta);
+  const double cg = cos(gamma), sg = sin(gamma);
+  R[0] = ca * cb * cg - sa * sg;
+  R[1] = -ca * cb * sg - sa * cg;
+  R[2] = ca * sb;
+  R[3] = sa * cb * cg + ca * sg;
+  R[4] = -sa * cb * sg + ca * cg;
+  R[5] = sa * sb;
+  R[6] = -sb * cg;
+  R[7] = sb * sg;
+  R[8] = cb;
+}
+
+// Every sample maps back to itself through its quaternion, also after a
+// small perturbation. Samples at the poles, where alpha and gamma are not
+// unique, are skipped.
+static void check_grid_roundtrip(const so3_parameters_t *parameters) {
+  const int f_size = so3_sampling_f_size(parameters);
+  const int nalpha = so3_sampling_nalpha(parameters);
+  const int nbeta = so3_sampling_nbeta(parameters);
+  double *alphas = malloc(f_size * sizeof *alphas);
+  double *betas = malloc(f_size * sizeof *betas);
+  double *gammas = malloc(f_size * sizeof *gammas);
+  double *quaternions = malloc(4 * f_size * sizeof *quaternions);
+  int *indices = malloc(f_size * sizeof *indices);
+  int i;
+  SO3_ERROR_MEM_ALLOC_CHECK(alphas);
+  SO3_ERROR_MEM_ALLOC_CHECK(betas);
+  SO3_ERROR_MEM_ALLOC_CHECK(gammas);
+  SO3_ERROR_MEM_ALLOC_CHECK(quaternions);
+  SO3_ERROR_MEM_ALLOC_CHECK(indices);
+
+  so3_grid_coordinates(alphas, betas, gammas, parameters);
+  for (i = 0; i < f_size; ++i) {
+    const int a = i % nalpha, b = (i / nalpha) % nbeta, g = i / (nalpha * nbeta);
+    assert_float_equal(alphas[i], so3_sampling_a2alpha(a, parameters), 1e-15);
+    assert_float_equal(betas[i], so3_sampling_b2beta(b, parameters), 1e-15);
+    assert_float_equal(gammas[i], so3_sampling_g2gamma(g, parameters), 1e-15);
+  }
+
+  so3_grid_quaternions(quaternions, parameters);
+  for (i = 0; i < f_size; ++i) {
+    const double *q = quaternions + 4 * i;
+    const double norm = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+    assert_float_equal(norm, 1.0, 1e-14);
+  }
+  so3_grid_quaternion_to_euler(alphas, betas, gammas, quaternions, f_size);
+  for (i = 0; i < f_size; ++i) {
+    alphas[i] += 0.2 * (ran2_dp(1) - 0.5) * 2.0 * SO3_PI / nalpha;
+    betas[i] += 0.2 * (ran2_dp(1) - 0.5) * SO3_PI / nbeta;
+  }
+  so3_grid_nearest(indices, alphas, betas, gammas, f_size, parameters);
+  for (i = 0; i < f_size; ++i) {
+    const double beta = so3_sampling_b2beta((i / nalpha) % nbeta, parameters);
+    if (beta > 1e-12 && beta < SO3_PI - 1e-12)
+      assert_int_equal(indices[i], i);
+  }
+
+  free(alphas);
+  free(betas);
+  free(gammas);
+  free(quaternions);
+  free(indices);
+}
+
+static void test_grid_roundtrip(void **state) {
+  const so3_parameters_t *base_parameters = *state;
+  so3_parameters_t parameters = *base_parameters;
+  check_grid_roundtrip(&parameters);
+
+  parameters.sampling_scheme = SO3_SAMPLING_MW_SS;
+  check_grid_roundtrip(&parameters);
+
+  parameters = *base_parameters;
+  parameters.M = 3;
+  check_grid_roundtrip(&parameters);
+}
+
+static void test_grid_matrix_to_euler(void **state) {
+  (void)state;
+  const double alphas[] = {0.3, 5.9, 1.0, 2.0, 4.0};
+  const double betas[] = {1.1, 0.2, 3.0, 0.0, SO3_PI};
+  const double gammas[] = {2.5, 0.1, 6.0, 0.0, 0.0};
+  double R[5 * 9], alpha[5], beta[5], gamma[5];
+  int i;
+
+  for (i = 0; i < 5; ++i)
+    euler_to_matrix(R + 9 * i, alphas[i], betas[i], gammas[i]);
+  so3_grid_matrix_to_euler(alpha, beta, gamma, R, 5);
+  for (i = 0; i < 5; ++i) {
+    assert_float_equal(alpha[i], alphas[i], 1e-12);
+    assert_float_equal(beta[i], betas[i], 1e-12);
+    assert_float_equal(gamma[i], gammas[i], 1e-12);
+  }
+
+  // Quaternions of the same rotations agree up to sign with the matrices.
+  double q[5 * 4];
+  so3_grid_euler_to_quaternion(q, alphas, betas, gammas, 5);
+  for (i = 0; i < 5; ++i) {
+    const double w = q[4 * i], x = q[4 * i + 1], y = q[4 * i + 2], z = q[4 * i + 3];
+    assert_float_equal(R[9 * i], 1 - 2 * (y * y + z * z), 1e-12);
+    assert_float_equal(R[9 * i + 2], 2 * (x * z + w * y), 1e-12);
+    assert_float_equal(R[9 * i + 3], 2 * (x * y + w * z), 1e-12);
+    assert_float_equal(R[9 * i + 7], 2 * (y * z + w * x), 1e-12);
+  }
+}
+
+static void test_grid_enclosing(void **state) {
+  so3_parameters_t parameters = *(const so3_parameters_t *)*state;
+  parameters.sampling_scheme = SO3_SAMPLING_MW_SS;
+  parameters.steerable = 1;
+  parameters.n_mode = SO3_N_MODE_EVEN;
+  const int count = 200;
+  const int nalpha = so3_sampling_nalpha(&parameters);
+  const int ngamma = so3_sampling_ngamma(&parameters);
+  double alphas[200], betas[200], gammas[200];
+  so3_grid_cell_t cells[200];
+  int i;
+
+  for (i = 0; i < count; ++i) {
+    alphas[i] = 4.0 * SO3_PI * (ran2_dp(2) - 0.5);
+    betas[i] = SO3_PI * ran2_dp(2);
+    gammas[i] = 4.0 * SO3_PI * ran2_dp(2);
+  }
+  so3_grid_enclosing(cells, alphas, betas, gammas, count, &parameters);
+  for (i = 0; i < count; ++i) {
+    const so3_grid_cell_t *c = cells + i;
+    const double da = 2.0 * SO3_PI / nalpha, dg = SO3_PI / ngamma;
+    const double alpha = so3_sampling_a2alpha(c->a, &parameters) + c->ta * da;
+    const double beta = so3_sampling_b2beta(c->b, &parameters) + c->tb * SO3_PI / 6;
+    const double gamma = so3_sampling_g2gamma(c->g, &parameters) + c->tg * dg;
+    assert_true(c->ta >= 0.0 && c->ta < 1.0);
+    assert_true(c->tg >= 0.0 && c->tg < 1.0);
+    assert_float_equal(cos(alpha), cos(alphas[i]), 1e-12);
+    assert_float_equal(sin(alpha), sin(alphas[i]), 1e-12);
+    assert_float_equal(beta, betas[i], 1e-12);
+    // Gamma is periodic in pi for steerable signals.
+    assert_float_equal(cos(2 * gamma), cos(2 * gammas[i]), 1e-12);
+    assert_float_equal(sin(2 * gamma), sin(2 * gammas[i]), 1e-12);
+  }
+}
+
+int main(void) {
+  so3_parameters_t parameters = test_parameters(6, 4, SO3_STORAGE_COMPACT);
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_prestate(test_grid_roundtrip, &parameters),
+      cmocka_unit_test(test_grid_matrix_to_euler),
+      cmocka_unit_test_prestate(test_grid_enclosing, &parameters),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,180 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <complex.h>
+#include <math.h>
+
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_grid.h"
+#include "so3/so3_interp.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+#include "so3/so3_wigner.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+#define NROTATIONS 500
+
+// Oversampling of the grid relative to the band-limits of the signal.
+#define OVERSAMPLING 4
+
+static void test_interp_on_grid(void **state) {
+  so3_parameters_t parameters = *(const so3_parameters_t *)*state;
+  parameters.L = 6;
+  parameters.N = 4;
+  const int f_size = so3_sampling_f_size(&parameters);
+  complex double *f = malloc(f_size * sizeof *f);
+  complex double *values = malloc(f_size * sizeof *values);
+  double *alphas = malloc(f_size * sizeof *alphas);
+  double *betas = malloc(f_size * sizeof *betas);
+  double *gammas = malloc(f_size * sizeof *gammas);
+  int i, method;
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(values);
+  SO3_ERROR_MEM_ALLOC_CHECK(alphas);
+  SO3_ERROR_MEM_ALLOC_CHECK(betas);
+  SO3_ERROR_MEM_ALLOC_CHECK(gammas);
+
+  for (i = 0; i < f_size; ++i)
+    f[i] = (2.0 * ran2_dp(1) - 1.0) + I * (2.0 * ran2_dp(1) - 1.0);
+  so3_grid_coordinates(alphas, betas, gammas, &parameters);
+  for (method = SO3_INTERP_LINEAR; method <= SO3_INTERP_CUBIC; ++method) {
+    so3_interp_plan_t *plan = so3_interp_plan_init(&parameters, method);
+    so3_interp(values, f, alphas, betas, gammas, f_size, plan);
+    assert_complex_array_equal(values, f, f_size, 1e-12);
+    so3_interp_plan_free(plan);
+  }
+
+  free(f);
+  free(values);
+  free(alphas);
+  free(betas);
+  free(gammas);
+}
+
+// Interpolate a signal of the band-limits of parameters from a grid that
+// oversamples it, and compare with the exact values from the Wigner
+// D-functions. Rotations are spread uniformly, or lie within a few samples of
+// the north pole. Real signals store n >= 0 only, and the terms of n > 0
+// stand for those of -n as well.
+static void check_interp_accuracy(const so3_parameters_t *parameters, int near_pole) {
+  const int L = parameters->L, N = parameters->N;
+  const double tolerances[] = {0.1, 0.01};
+  so3_parameters_t grid_parameters = *parameters;
+  grid_parameters.L = OVERSAMPLING * L;
+  grid_parameters.N = OVERSAMPLING * N;
+  const int D_size = so3_wigner_D_size(L - 1, SO3_STORAGE_PADDED);
+  const int flmn_size = so3_sampling_flmn_size(&grid_parameters);
+  const int f_size = so3_sampling_f_size(&grid_parameters);
+  so3_parameters_t D_parameters = *parameters;
+  D_parameters.N = L;
+  D_parameters.reality = 0;
+  complex double *flmn = alloc_random_flmn(parameters, 1);
+  complex double *grid_flmn = calloc(flmn_size, sizeof *grid_flmn);
+  complex double *f = malloc(f_size * sizeof *f);
+  complex double *D = malloc(NROTATIONS * D_size * sizeof *D);
+  complex double exact[NROTATIONS], values[NROTATIONS];
+  double alphas[NROTATIONS], betas[NROTATIONS], gammas[NROTATIONS];
+  double maximum = 0.0;
+  so3_flmn_iter_t iter;
+  int i, method;
+  SO3_ERROR_MEM_ALLOC_CHECK(grid_flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(D);
+
+  so3_flmn_iter_init(&iter, parameters);
+  while (so3_flmn_iter_next(&iter)) {
+    int ind;
+    if (parameters->reality)
+      so3_sampling_elmn2ind_real(&ind, iter.el, iter.m, iter.n, &grid_parameters);
+    else
+      so3_sampling_elmn2ind(&ind, iter.el, iter.m, iter.n, &grid_parameters);
+    grid_flmn[ind] = flmn[iter.ind];
+  }
+  if (parameters->reality) {
+    double *f_real = (double *)f;
+    so3_core_inverse_direct_real(f_real, grid_flmn, &grid_parameters);
+  } else {
+    so3_core_inverse_direct(f, grid_flmn, &grid_parameters);
+  }
+
+  for (i = 0; i < NROTATIONS; ++i) {
+    alphas[i] = 2.0 * SO3_PI * ran2_dp(1);
+    betas[i] = acos(2.0 * ran2_dp(1) - 1.0);
+    gammas[i] = 2.0 * SO3_PI * ran2_dp(1);
+    if (near_pole)
+      betas[i] *= 3.0 / grid_parameters.L;
+  }
+  so3_wigner_D_batch(
+      D, L - 1, alphas, betas, gammas, NROTATIONS, SO3_STORAGE_PADDED,
+      SO3_N_ORDER_NEGATIVE_FIRST);
+  for (i = 0; i < NROTATIONS; ++i) {
+    exact[i] = 0.0;
+    so3_flmn_iter_init(&iter, parameters);
+    while (so3_flmn_iter_next(&iter)) {
+      const double weight = parameters->reality && iter.n ? 2.0 : 1.0;
+      int ind;
+      if (abs(iter.m) > iter.el || abs(iter.n) > iter.el)
+        continue;
+      so3_sampling_elmn2ind(&ind, iter.el, iter.m, iter.n, &D_parameters);
+      exact[i] += weight * (2 * iter.el + 1) / (8.0 * SO3_PI * SO3_PI) *
+                  flmn[iter.ind] * conj(D[i * D_size + ind]);
+    }
+    if (parameters->reality)
+      exact[i] = creal(exact[i]);
+    maximum = fmax(maximum, cabs(exact[i]));
+  }
+
+  for (method = SO3_INTERP_LINEAR; method <= SO3_INTERP_CUBIC; ++method) {
+    so3_interp_plan_t *plan = so3_interp_plan_init(&grid_parameters, method);
+    if (parameters->reality) {
+      double real_values[NROTATIONS];
+      so3_interp_real(
+          real_values, (double *)f, alphas, betas, gammas, NROTATIONS, plan);
+      for (i = 0; i < NROTATIONS; ++i)
+        values[i] = real_values[i];
+    } else {
+      so3_interp(values, f, alphas, betas, gammas, NROTATIONS, plan);
+    }
+    for (i = 0; i < NROTATIONS; ++i)
+      assert_true(cabs(values[i] - exact[i]) < tolerances[method] * maximum);
+    so3_interp_plan_free(plan);
+  }
+
+  free(flmn);
+  free(grid_flmn);
+  free(f);
+  free(D);
+}
+
+static void test_interp_accuracy(void **state) {
+  so3_parameters_t parameters = *(const so3_parameters_t *)*state;
+  check_interp_accuracy(&parameters, 0);
+  check_interp_accuracy(&parameters, 1);
+
+  parameters.sampling_scheme = SO3_SAMPLING_MW_SS;
+  check_interp_accuracy(&parameters, 0);
+  check_interp_accuracy(&parameters, 1);
+}
+
+static void test_interp_accuracy_real(void **state) {
+  so3_parameters_t parameters = *(const so3_parameters_t *)*state;
+  parameters.reality = 1;
+  check_interp_accuracy(&parameters, 0);
+  check_interp_accuracy(&parameters, 1);
+}
+
+int main(void) {
+  so3_parameters_t parameters = test_parameters(4, 3, SO3_STORAGE_PADDED);
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_prestate(test_interp_on_grid, &parameters),
+      cmocka_unit_test_prestate(test_interp_accuracy, &parameters),
+      cmocka_unit_test_prestate(test_interp_accuracy_real, &parameters),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,133 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mpi.h>
+
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_mpi.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+// Every rank computes the serial transform and compares its own part.
+static void test_mpi_inverse_forward(void **state) {
+  const so3_parameters_t parameters = **(const so3_parameters_t **)state;
+  const int L = parameters.L, N = parameters.N;
+  const int nalpha = so3_sampling_nalpha(&parameters);
+  const int nbeta = so3_sampling_nbeta(&parameters);
+  so3_mpi_layout_t layout;
+  int k, el, m, a, b, g, ind;
+
+  so3_mpi_layout_init(&layout, MPI_COMM_WORLD, &parameters);
+  const int nb_local = layout.b_stop - layout.b_start;
+
+  complex double *flmn = calloc((2 * N - 1) * L * L, sizeof *flmn);
+  complex double *f = calloc(so3_sampling_f_size(&parameters), sizeof *f);
+  complex double *flmn_local =
+      calloc(so3_mpi_flmn_local_size(&layout, &parameters) + 1, sizeof *flmn_local);
+  complex double *flmn_back =
+      calloc(so3_mpi_flmn_local_size(&layout, &parameters) + 1, sizeof *flmn_back);
+  complex double *f_local =
+      calloc(so3_mpi_f_local_size(&layout, &parameters) + 1, sizeof *f_local);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_local);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_back);
+  SO3_ERROR_MEM_ALLOC_CHECK(f_local);
+
+  gen_flmn_complex(flmn, &parameters, 1);
+  so3_core_inverse_via_ssht(f, flmn, &parameters);
+
+  for (k = 0; k < layout.n_count; ++k) {
+    const int n = layout.n_first + k * layout.n_inc;
+    for (el = max(parameters.L0, abs(n)); el < L; ++el)
+      for (m = -el; m <= el; ++m) {
+        so3_sampling_elmn2ind(&ind, el, m, n, &parameters);
+        flmn_local[k * L * L + el * el + el + m] = flmn[ind];
+      }
+  }
+
+  // With SO3_N_MODE_L the coefficients with el != |n| must be ignored, so
+  // fill them with garbage for the inverse and expect zeros back.
+  complex double *flmn_input = malloc(
+      (so3_mpi_flmn_local_size(&layout, &parameters) + 1) * sizeof *flmn_input);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_input);
+  memcpy(
+      flmn_input, flmn_local,
+      so3_mpi_flmn_local_size(&layout, &parameters) * sizeof *flmn_input);
+  if (parameters.n_mode == SO3_N_MODE_L)
+    for (k = 0; k < layout.n_count; ++k) {
+      const int n = layout.n_first + k * layout.n_inc;
+      for (el = max(parameters.L0, abs(n)); el < L; ++el)
+        if (el != abs(n))
+          for (m = -el; m <= el; ++m)
+            flmn_input[k * L * L + el * el + el + m] = 1.0 + I;
+    }
+
+  so3_mpi_inverse_via_ssht(f_local, flmn_input, &layout, &parameters);
+  for (g = 0; g < 2 * N - 1; ++g)
+    for (b = 0; b < nb_local; ++b)
+      for (a = 0; a < nalpha; ++a) {
+        complex double expected = f[a + nalpha * (b + layout.b_start + nbeta * g)];
+        complex double actual = f_local[a + nalpha * (b + nb_local * g)];
+        assert_float_equal(creal(actual), creal(expected), 1e-10);
+        assert_float_equal(cimag(actual), cimag(expected), 1e-10);
+      }
+
+  so3_mpi_forward_via_ssht(flmn_back, f_local, &layout, &parameters);
+  for (k = 0; k < so3_mpi_flmn_local_size(&layout, &parameters); ++k) {
+    assert_float_equal(creal(flmn_back[k]), creal(flmn_local[k]), 1e-10);
+    assert_float_equal(cimag(flmn_back[k]), cimag(flmn_local[k]), 1e-10);
+  }
+
+  free(flmn);
+  free(f);
+  free(flmn_local);
+  free(flmn_input);
+  free(flmn_back);
+  free(f_local);
+}
+
+int main(int argc, char **argv) {
+  int result;
+  const so3_parameters_t mw = {
+      .L0 = 0,
+      .L = 8,
+      .N = 5,
+      .verbosity = 0,
+      .n_mode = SO3_N_MODE_ALL,
+      .reality = 0,
+      .sampling_scheme = SO3_SAMPLING_MW,
+      .n_order = SO3_N_ORDER_ZERO_FIRST,
+      .storage = SO3_STORAGE_PADDED,
+      .dl_method = SSHT_DL_RISBO,
+      .steerable = 0};
+  so3_parameters_t mwss = mw;
+  mwss.sampling_scheme = SO3_SAMPLING_MW_SS;
+  so3_parameters_t even = mw;
+  even.n_mode = SO3_N_MODE_EVEN;
+  even.L0 = 2;
+  so3_parameters_t single = mw;
+  single.N = 1;
+  so3_parameters_t lmode = mw;
+  lmode.n_mode = SO3_N_MODE_L;
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_prestate(test_mpi_inverse_forward, (void **)&mw),
+      cmocka_unit_test_prestate(test_mpi_inverse_forward, (void **)&mwss),
+      cmocka_unit_test_prestate(test_mpi_inverse_forward, (void **)&even),
+      cmocka_unit_test_prestate(test_mpi_inverse_forward, (void **)&single),
+      cmocka_unit_test_prestate(test_mpi_inverse_forward, (void **)&lmode),
+  };
+
+  MPI_Init(&argc, &argv);
+  result = cmocka_run_group_tests(tests, NULL, NULL);
+  MPI_Finalize();
+  return result;
+}
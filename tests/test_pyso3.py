@@ -1,5 +1,5 @@
 import numpy as np
-from pytest import approx
+from pytest import approx, raises
 
 import so3
 
@@ -31,3 +31,132 @@ def test_convolve_smoke_test():
     f = so3.inverse(so3.forward(f_before, g_p), g_p)
     g = so3.inverse(so3.forward(g_before, g_p), g_p)
     so3.convolve(f, g_p, g, g_p)
+
+
+def test_flmn_algebra():
+    rng = np.random.default_rng()
+    params = so3.create_parameter_dict(16, 8, storage_str="SO3_STORAGE_COMPACT")
+    flmn_length = so3.flmn_size(params)
+    x = rng.normal(size=(flmn_length, 2)) @ [1, 1j]
+    y = rng.normal(size=(flmn_length, 2)) @ [1, 1j]
+
+    # Compact storage of a complex signal has no structural zeros.
+    assert so3.flmn_dot(x, y, params) == approx(np.vdot(x, y))
+    assert so3.flmn_axpy(2.0, x, y, params) == approx(2.0 * x + y)
+    norms = so3.flmn_norm_per_el(x, params)
+    assert np.sum(norms**2) == approx(np.vdot(x, x).real)
+    assert so3.flmn_scale_by_el(x, np.ones(16), params) == approx(x)
+    with raises(ValueError):
+        so3.flmn_dot(x[:-1], y[:-1], params)
+
+
+def test_wigner_D_batch():
+    el_max = 8
+    params = so3.create_parameter_dict(el_max + 1, el_max + 1)
+    alphas = np.array([0.1, 1.2])
+    betas = np.array([0.4, 2.5])
+    gammas = np.array([3.0, 0.7])
+    D = so3.wigner_D_batch(el_max, alphas, betas, gammas)
+    assert D.shape == (2, so3.flmn_size(params))
+
+    # D^1_00(beta) = cos(beta).
+    assert D[:, so3.elmn2ind(1, 0, 0, params)] == approx(np.cos(betas))
+    # The rows of each D^el are orthonormal.
+    el = 5
+    block = np.array(
+        [[D[0, so3.elmn2ind(el, m, n, params)] for n in range(-el, el + 1)]
+         for m in range(-el, el + 1)])
+    assert block @ block.conj().T == approx(np.eye(2 * el + 1))
+
+
+def test_grid_lookup():
+    params = so3.create_parameter_dict(8, 4)
+    alphas, betas, gammas = so3.grid_coordinates(params)
+    assert alphas.shape == (so3.f_size(params),)
+
+    # Interior samples are their own nearest samples.
+    interior = np.flatnonzero(betas < np.pi - 1e-12)
+    indices = so3.grid_nearest(
+        alphas[interior], betas[interior], gammas[interior], params)
+    assert np.array_equal(indices, interior)
+
+
+def test_interp():
+    params = so3.create_parameter_dict(8, 4)
+    f = np.random.rand(so3.f_size(params)) + 1j * np.random.rand(so3.f_size(params))
+    alphas, betas, gammas = so3.grid_coordinates(params)
+
+    # Interpolation reproduces the samples.
+    for method in ["SO3_INTERP_LINEAR", "SO3_INTERP_CUBIC"]:
+        values = so3.interp(f, alphas, betas, gammas, params, method)
+        assert values == approx(f)
+
+
+def test_search():
+    L = 16
+    params = so3.create_parameter_dict(L, L)
+    flm = (np.random.rand(L * L) + 1j * np.random.rand(L * L)) / (
+        1 + np.sqrt(np.arange(L * L)))
+
+    # A signal correlates best with itself at the identity, with its energy.
+    rotations, scores = so3.search(flm, flm, params, 2)
+    assert scores[0] == approx(np.sum(np.abs(flm) ** 2), rel=1e-4)
+    assert np.cos(0.5 * rotations[0, 1]) == approx(1.0, abs=1e-4)
+
+
+def test_resample():
+    small = so3.create_parameter_dict(6, 4, storage_str="SO3_STORAGE_COMPACT")
+    large = so3.create_parameter_dict(9, 5, sampling_scheme_str="SO3_SAMPLING_MW_SS")
+    flmn = np.random.rand(so3.flmn_size(small)) + 1j * np.random.rand(
+        so3.flmn_size(small))
+    flmn_large = so3.flmn_change_bandlimit(flmn, small, large)
+    assert so3.flmn_change_bandlimit(flmn_large, large, small) == approx(flmn)
+    with raises(ValueError):
+        so3.flmn_change_bandlimit(flmn, large, small)
+
+    f = so3.inverse(flmn, small)
+    assert so3.resample(f, small, large) == approx(so3.inverse(flmn_large, large))
+
+
+def test_descriptors():
+    params = so3.create_parameter_dict(6, 4, storage_str="SO3_STORAGE_COMPACT")
+    flmn = np.random.rand(3, so3.flmn_size(params)) + 1j * np.random.rand(
+        3, so3.flmn_size(params))
+
+    power = so3.descriptor_power(flmn, params)
+    assert power.shape == (3, 6)
+    assert power.sum(axis=1) == approx(np.sum(np.abs(flmn) ** 2, axis=1))
+
+    triples = [[1, 0, 1, 0, 2, 0], [2, 1, 3, -1, 4, 0]]
+    bispectrum = so3.descriptor_bispectrum(flmn, triples, params)
+    assert bispectrum.shape == (3, 2)
+    assert bispectrum[1] == approx(so3.descriptor_bispectrum(flmn[1], triples, params))
+
+
+def test_quadrature():
+    params = so3.create_parameter_dict(6, 4, storage_str="SO3_STORAGE_COMPACT")
+    flmn = np.random.rand(so3.flmn_size(params)) + 1j * np.random.rand(
+        so3.flmn_size(params))
+    glmn = np.random.rand(so3.flmn_size(params)) + 1j * np.random.rand(
+        so3.flmn_size(params))
+    f = so3.inverse(flmn, params)
+    g = so3.inverse(glmn, params)
+
+    assert so3.integrate(f, params) == approx(flmn[so3.elmn2ind(0, 0, 0, params)])
+    weights = np.array(
+        [2 * so3.ind2elmn(i, params)[0] + 1 for i in range(so3.flmn_size(params))])
+    expected = np.sum(weights * flmn * glmn.conj()) / (8 * np.pi ** 2)
+    assert so3.inner_product(f, g, params) == approx(expected)
+
+
+def test_compress():
+    params = so3.create_parameter_dict(6, 4, storage_str="SO3_STORAGE_COMPACT")
+    flmn = np.random.rand(so3.flmn_size(params)) + 1j * np.random.rand(
+        so3.flmn_size(params))
+
+    assert np.array_equal(so3.decompress(so3.compress(flmn, params), params), flmn)
+    data = so3.compress(flmn, params, error_bound=1e-6)
+    assert len(data) < flmn.nbytes
+    assert np.abs(so3.decompress(data, params) - flmn).max() <= 1.01e-6 * np.sqrt(2)
+    with raises(ValueError):
+        so3.decompress(data[: len(data) // 2], params)
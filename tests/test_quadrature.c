@@ -0,0 +1,135 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <complex.h>
+#include <math.h>
+
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_quadrature.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+// The integral of f is f_000, and the inner product of f and g is
+//   sum_elmn (2*el+1) / (8*pi^2) f_elmn conj(g_elmn),
+// with the coefficients of n < 0 of real signals included.
+static void check_quadrature(const so3_parameters_t *parameters) {
+  const int L = parameters->L, N = parameters->N;
+  const int f_size = so3_sampling_f_size(parameters);
+  complex double *flmn = alloc_random_flmn(parameters, 1);
+  complex double *glmn = alloc_random_flmn(parameters, 2);
+  complex double *f = malloc(f_size * sizeof *f);
+  complex double *g = malloc(f_size * sizeof *g);
+  complex double expected_integral = 0.0, expected_product = 0.0;
+  int el, m, n, ind;
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(g);
+
+  for (el = parameters->L0; el < L; ++el)
+    for (n = parameters->reality ? 0 : -N + 1; n < N; ++n)
+      for (m = -el; m <= el; ++m) {
+        if (abs(n) > el || !so3_sampling_is_elmn_non_zero(el, m, n, parameters))
+          continue;
+        if (parameters->reality)
+          so3_sampling_elmn2ind_real(&ind, el, m, n, parameters);
+        else
+          so3_sampling_elmn2ind(&ind, el, m, n, parameters);
+        expected_product += (parameters->reality && n > 0 ? 2.0 : 1.0) * (2 * el + 1) /
+                            (8 * SO3_PI * SO3_PI) * flmn[ind] * conj(glmn[ind]);
+        if (el == 0)
+          expected_integral = flmn[ind];
+      }
+
+  if (parameters->reality) {
+    double *f_real = (double *)f, *g_real = (double *)g;
+    so3_core_inverse_direct_real(f_real, flmn, parameters);
+    so3_core_inverse_direct_real(g_real, glmn, parameters);
+    assert_float_equal(
+        so3_integrate_real(f_real, parameters), creal(expected_integral), 1e-10);
+    assert_float_equal(
+        so3_inner_product_real(f_real, g_real, parameters), creal(expected_product),
+        1e-10);
+  } else {
+    complex double integral, product;
+    so3_core_inverse_direct(f, flmn, parameters);
+    so3_core_inverse_direct(g, glmn, parameters);
+    integral = so3_integrate(f, parameters);
+    product = so3_inner_product(f, g, parameters);
+    // The ring weights are cached, and rebuilt identically once cleared.
+    so3_quadrature_cache_clear();
+    assert_true(so3_integrate(f, parameters) == integral);
+    assert_float_equal(creal(integral), creal(expected_integral), 1e-10);
+    assert_float_equal(cimag(integral), cimag(expected_integral), 1e-10);
+    assert_float_equal(creal(product), creal(expected_product), 1e-10);
+    assert_float_equal(cimag(product), cimag(expected_product), 1e-10);
+  }
+
+  free(flmn);
+  free(glmn);
+  free(f);
+  free(g);
+}
+
+static void check_quadrature_all(const so3_parameters_t *base_parameters, int reality) {
+  so3_parameters_t parameters = *base_parameters;
+  parameters.reality = reality;
+  check_quadrature(&parameters);
+  parameters.sampling_scheme = SO3_SAMPLING_MW_SS;
+  check_quadrature(&parameters);
+  parameters.L = 8;
+  parameters.N = 8;
+  parameters.storage = SO3_STORAGE_COMPACT;
+  check_quadrature(&parameters);
+  parameters.sampling_scheme = SO3_SAMPLING_MW;
+  parameters.n_mode = SO3_N_MODE_EVEN;
+  check_quadrature(&parameters);
+}
+
+static void test_quadrature(void **state) { check_quadrature_all(*state, 0); }
+
+// Steerable signals are sampled over half the range of gamma, where only the
+// frequencies n of one parity cancel. Odd n integrate to zero.
+static void test_quadrature_steerable(void **state) {
+  so3_parameters_t parameters = *(const so3_parameters_t *)*state;
+  const int L = parameters.L, N = parameters.N;
+  complex double *flmn = calloc((2 * N - 1) * L * L, sizeof *flmn);
+  // The inverse transform works on the grid of all 2N-1 samples in gamma, and
+  // only the one via SSHT samples steerable signals.
+  complex double *f = malloc(so3_sampling_f_size(&parameters) * sizeof *f);
+  complex double integral;
+  int ind, mode;
+  parameters.steerable = 1;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+
+  for (mode = 0; mode < 2; ++mode) {
+    parameters.n_mode = mode ? SO3_N_MODE_ODD : SO3_N_MODE_EVEN;
+    gen_flmn_complex(flmn, &parameters, 3);
+    so3_core_inverse_via_ssht(f, flmn, &parameters);
+    so3_sampling_elmn2ind(&ind, 0, 0, 0, &parameters);
+    integral = so3_integrate(f, &parameters);
+    assert_float_equal(creal(integral), mode ? 0.0 : creal(flmn[ind]), 1e-10);
+    assert_float_equal(cimag(integral), mode ? 0.0 : cimag(flmn[ind]), 1e-10);
+  }
+
+  free(flmn);
+  free(f);
+}
+
+static void test_quadrature_real(void **state) { check_quadrature_all(*state, 1); }
+
+int main(void) {
+  so3_parameters_t parameters = test_parameters(7, 4, SO3_STORAGE_PADDED);
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_prestate(test_quadrature, &parameters),
+      cmocka_unit_test_prestate(test_quadrature_real, &parameters),
+      cmocka_unit_test_prestate(test_quadrature_steerable, &parameters),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
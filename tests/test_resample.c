@@ -0,0 +1,148 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <complex.h>
+#include <math.h>
+
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_flmn.h"
+#include "so3/so3_resample.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+// Resample the signal of random coefficients in the layout of parameters from
+// the grid of parameters_in to that of parameters_out, and compare with the
+// inverse transform of the same coefficients on the output grid.
+static void check_resample(
+    const so3_parameters_t *parameters_out, const so3_parameters_t *parameters_in,
+    const so3_parameters_t *parameters) {
+  const int f_size_in = so3_sampling_f_size(parameters_in);
+  const int f_size_out = so3_sampling_f_size(parameters_out);
+  complex double *flmn = alloc_random_flmn(parameters, 1);
+  complex double *flmn_in =
+      malloc(so3_sampling_flmn_size(parameters_in) * sizeof *flmn_in);
+  complex double *flmn_out =
+      malloc(so3_sampling_flmn_size(parameters_out) * sizeof *flmn_out);
+  complex double *f_in = malloc(f_size_in * sizeof *f_in);
+  complex double *f_out = malloc(f_size_out * sizeof *f_out);
+  complex double *expected = malloc(f_size_out * sizeof *expected);
+  int i;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_in);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_out);
+  SO3_ERROR_MEM_ALLOC_CHECK(f_in);
+  SO3_ERROR_MEM_ALLOC_CHECK(f_out);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+
+  so3_flmn_change_bandlimit(flmn_in, parameters_in, flmn, parameters);
+  so3_flmn_change_bandlimit(flmn_out, parameters_out, flmn, parameters);
+
+  if (parameters->reality) {
+    double *f_in_real = (double *)f_in, *f_out_real = (double *)f_out;
+    double *expected_real = (double *)expected;
+    so3_core_inverse_direct_real(f_in_real, flmn_in, parameters_in);
+    so3_core_inverse_direct_real(expected_real, flmn_out, parameters_out);
+    so3_resample_real(f_out_real, parameters_out, f_in_real, parameters_in);
+    for (i = 0; i < f_size_out; ++i)
+      assert_float_equal(f_out_real[i], expected_real[i], 1e-10);
+  } else {
+    so3_core_inverse_direct(f_in, flmn_in, parameters_in);
+    so3_core_inverse_direct(expected, flmn_out, parameters_out);
+    so3_resample(f_out, parameters_out, f_in, parameters_in);
+    assert_complex_array_equal(f_out, expected, f_size_out, 1e-10);
+  }
+
+  free(flmn);
+  free(flmn_in);
+  free(flmn_out);
+  free(f_in);
+  free(f_out);
+  free(expected);
+}
+
+static void check_resample_all(const so3_parameters_t *parameters, int reality) {
+  so3_parameters_t small = *parameters, large = *parameters;
+  so3_parameters_t mw = *parameters;
+  small.reality = large.reality = mw.reality = reality;
+  large.L = 9;
+  large.N = 5;
+  large.storage = SO3_STORAGE_COMPACT;
+
+  // Upsampling and changes of scheme use FFTs only.
+  check_resample(&large, &small, &mw);
+  large.sampling_scheme = SO3_SAMPLING_MW_SS;
+  check_resample(&large, &small, &mw);
+  small.sampling_scheme = SO3_SAMPLING_MW_SS;
+  check_resample(&large, &small, &mw);
+  large.sampling_scheme = SO3_SAMPLING_MW;
+  check_resample(&large, &small, &mw);
+  check_resample(&mw, &small, &mw);
+
+  // Downsampling of a signal that is band-limited for the output.
+  check_resample(&small, &large, &mw);
+  small.sampling_scheme = SO3_SAMPLING_MW;
+  check_resample(&small, &large, &mw);
+}
+
+static void test_resample(void **state) { check_resample_all(*state, 0); }
+
+static void test_resample_real(void **state) { check_resample_all(*state, 1); }
+
+// A plan resamples several signals in turn, as the one-shot function does.
+static void check_resample_plan(
+    const so3_parameters_t *parameters_out, const so3_parameters_t *parameters_in) {
+  const int L = parameters_in->L, N = parameters_in->N;
+  const int f_size_in = so3_sampling_f_size(parameters_in);
+  const int f_size_out = so3_sampling_f_size(parameters_out);
+  complex double *flmn = malloc((2 * N - 1) * L * L * sizeof *flmn);
+  complex double *f_in = malloc(f_size_in * sizeof *f_in);
+  complex double *f_out = malloc(f_size_out * sizeof *f_out);
+  complex double *expected = malloc(f_size_out * sizeof *expected);
+  so3_resample_plan_t *plan = so3_resample_plan_init(parameters_out, parameters_in);
+  int seed;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(f_in);
+  SO3_ERROR_MEM_ALLOC_CHECK(f_out);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+
+  for (seed = 1; seed <= 3; ++seed) {
+    gen_flmn_complex(flmn, parameters_in, seed);
+    so3_core_inverse_direct(f_in, flmn, parameters_in);
+    so3_resample(expected, parameters_out, f_in, parameters_in);
+    so3_resample_execute(plan, f_out, f_in);
+    assert_complex_array_equal(f_out, expected, f_size_out, 1e-12);
+  }
+
+  so3_resample_plan_free(plan);
+  free(flmn);
+  free(f_in);
+  free(f_out);
+  free(expected);
+}
+
+static void test_resample_plan(void **state) {
+  const so3_parameters_t *parameters = *state;
+  so3_parameters_t small = *parameters, large = *parameters;
+  large.L = 9;
+  large.N = 5;
+  large.sampling_scheme = SO3_SAMPLING_MW_SS;
+
+  check_resample_plan(&large, &small);
+  check_resample_plan(&small, &large);
+}
+
+int main(void) {
+  so3_parameters_t parameters = test_parameters(6, 4, SO3_STORAGE_PADDED);
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_prestate(test_resample, &parameters),
+      cmocka_unit_test_prestate(test_resample_real, &parameters),
+      cmocka_unit_test_prestate(test_resample_plan, &parameters),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
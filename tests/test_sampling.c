@@ -1,6 +1,7 @@
 #include <setjmp.h>
 #include <stdarg.h>
 #include <stddef.h>
+#include <stdlib.h>
 
 #include "so3/so3_sampling.h"
 #include "so3/so3_types.h"
@@ -142,6 +143,98 @@ void test_indexing_real_compact_storage(void **state) {
   sampling_real_assertions(tests, sizeof(tests) / sizeof(tests[0]), &parameters);
 }
 
+void test_indexing_azimuthal_band_limit(void **state) {
+  so3_parameters_t parameters = {
+      .L = 3,
+      .N = 3,
+      .M = 2,
+      .n_order = SO3_N_ORDER_ZERO_FIRST,
+      .storage = SO3_STORAGE_PADDED};
+  LMN2Index tests[] = {
+      {.el = 0, .m = 0, .n = 0, .index = 0},
+      {.el = 1, .m = -1, .n = 0, .index = 1},
+      {.el = 2, .m = 1, .n = 0, .index = 6},
+      {.el = 2, .m = 1, .n = -1, .index = 13},
+      {.el = 2, .m = 1, .n = 1, .index = 20},
+      {.el = 2, .m = -1, .n = 2, .index = 32},
+  };
+
+  sampling_assertions(tests, sizeof(tests) / sizeof(tests[0]), &parameters);
+  assert_int_equal(so3_sampling_flmn_size(&parameters), 35);
+  assert_int_equal(so3_sampling_nalpha(&parameters), 3);
+  assert_false(so3_sampling_is_elmn_non_zero(2, 2, 0, &parameters));
+}
+
+// Calls fn for every storage, n-order and reality, and a range of band-limits.
+static void for_each_layout(void (*fn)(so3_parameters_t const *)) {
+  const so3_storage_t storages[] = {SO3_STORAGE_PADDED, SO3_STORAGE_COMPACT};
+  const so3_n_order_t n_orders[] = {
+      SO3_N_ORDER_ZERO_FIRST, SO3_N_ORDER_NEGATIVE_FIRST};
+  for (int s = 0; s < 2; ++s)
+    for (int o = 0; o < 2; ++o)
+      for (int reality = 0; reality < 2; ++reality)
+        for (int L = 1; L <= 12; ++L)
+          for (int N = 1; N <= L; ++N)
+            for (int M = 1; M <= L; ++M) {
+              so3_parameters_t parameters = {
+                  .L = L,
+                  .N = N,
+                  .M = M,
+                  .reality = reality,
+                  .n_order = n_orders[o],
+                  .storage = storages[s]};
+              fn(&parameters);
+            }
+}
+
+static void assert_ind2elmn_round_trip(so3_parameters_t const *parameters) {
+  const int size = so3_sampling_flmn_size(parameters);
+  for (int i = 0; i < size; ++i) {
+    int el, m, n, ind;
+    if (parameters->reality) {
+      so3_sampling_ind2elmn_real(&el, &m, &n, i, parameters);
+      so3_sampling_elmn2ind_real(&ind, el, m, n, parameters);
+    } else {
+      so3_sampling_ind2elmn(&el, &m, &n, i, parameters);
+      so3_sampling_elmn2ind(&ind, el, m, n, parameters);
+    }
+    assert_in_range(el, 0, parameters->L - 1);
+    assert_true(abs(m) <= el && abs(m) < parameters->M);
+    assert_in_range(abs(n), 0, parameters->N - 1);
+    if (parameters->storage == SO3_STORAGE_COMPACT)
+      assert_true(abs(n) <= el);
+    assert_int_equal(ind, i);
+  }
+}
+
+void test_ind2elmn_round_trip(void **state) {
+  for_each_layout(assert_ind2elmn_round_trip);
+}
+
+static void assert_flmn_iter_matches(so3_parameters_t const *parameters) {
+  const int size = so3_sampling_flmn_size(parameters);
+  so3_flmn_iter_t iter;
+  int count = 0;
+
+  so3_flmn_iter_init(&iter, parameters);
+  while (so3_flmn_iter_next(&iter)) {
+    int el, m, n;
+    assert_int_equal(iter.ind, count);
+    if (parameters->reality)
+      so3_sampling_ind2elmn_real(&el, &m, &n, iter.ind, parameters);
+    else
+      so3_sampling_ind2elmn(&el, &m, &n, iter.ind, parameters);
+    assert_int_equal(iter.el, el);
+    assert_int_equal(iter.m, m);
+    assert_int_equal(iter.n, n);
+    ++count;
+  }
+  assert_int_equal(count, size);
+  assert_false(so3_flmn_iter_next(&iter));
+}
+
+void test_flmn_iter(void **state) { for_each_layout(assert_flmn_iter_matches); }
+
 int main(void) {
   const struct CMUnitTest tests[] = {
       cmocka_unit_test(test_indexing_padded_storage_with_zero_first),
@@ -150,6 +243,9 @@ int main(void) {
       cmocka_unit_test(test_indexing_compact_storage_with_negative_first),
       cmocka_unit_test(test_indexing_real_padded_storage),
       cmocka_unit_test(test_indexing_real_compact_storage),
+      cmocka_unit_test(test_indexing_azimuthal_band_limit),
+      cmocka_unit_test(test_ind2elmn_round_trip),
+      cmocka_unit_test(test_flmn_iter),
   };
 
   return cmocka_run_group_tests(tests, NULL, NULL);
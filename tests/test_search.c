@@ -0,0 +1,104 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <complex.h>
+#include <math.h>
+
+#include "so3/so3_conv.h"
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_grid.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_search.h"
+#include "so3/so3_types.h"
+#include "so3/so3_wigner.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+#define BANDLIMIT 16
+#define NCANDIDATES 4
+
+// The pattern g is the signal f rotated by (alpha, beta, gamma), glm = sum_n
+// D^l_mn flm, so that the correlation peaks at the inverse rotation with the
+// energy of f.
+static void check_search(
+    const so3_parameters_t *parameters, double alpha, double beta, double gamma) {
+  const int L = BANDLIMIT;
+  const int D_size = so3_wigner_D_size(L - 1, SO3_STORAGE_PADDED);
+  const int f_size = so3_sampling_f_size(parameters);
+  complex double flm[BANDLIMIT * BANDLIMIT], glm[BANDLIMIT * BANDLIMIT];
+  complex double *D = malloc(D_size * sizeof *D);
+  complex double *hlmn = malloc(so3_sampling_flmn_size(parameters) * sizeof *hlmn);
+  complex double *h = malloc(f_size * sizeof *h);
+  so3_search_candidate_t candidates[NCANDIDATES];
+  double energy = 0.0, grid_maximum = -INFINITY, q[4], p[4];
+  int el, m, n, i, count;
+  SO3_ERROR_MEM_ALLOC_CHECK(D);
+  SO3_ERROR_MEM_ALLOC_CHECK(hlmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(h);
+
+  // Coefficients that decay with el, so that the coarse levels see the peak.
+  for (el = 0; el < L; ++el)
+    for (m = -el; m <= el; ++m) {
+      flm[el * el + el + m] =
+          ((2.0 * ran2_dp(1) - 1.0) + I * (2.0 * ran2_dp(1) - 1.0)) / (1.0 + el);
+      energy += pow(cabs(flm[el * el + el + m]), 2);
+    }
+  so3_wigner_D_batch(
+      D, L - 1, &alpha, &beta, &gamma, 1, SO3_STORAGE_PADDED,
+      SO3_N_ORDER_NEGATIVE_FIRST);
+  for (el = 0; el < L; ++el)
+    for (m = -el; m <= el; ++m) {
+      glm[el * el + el + m] = 0.0;
+      for (n = -el; n <= el; ++n) {
+        int ind;
+        so3_sampling_elmn2ind(&ind, el, m, n, parameters);
+        glm[el * el + el + m] += D[ind] * flm[el * el + el + n];
+      }
+    }
+
+  count = so3_search(candidates, NCANDIDATES, flm, glm, 4, parameters);
+  assert_true(count >= 1 && count <= NCANDIDATES);
+  for (i = 1; i < count; ++i)
+    assert_true(candidates[i].score <= candidates[0].score);
+  assert_float_equal(candidates[0].score, energy, 1e-4 * energy);
+
+  // The best rotation is the inverse of the rotation of g, up to the sign of
+  // its quaternion.
+  so3_grid_euler_to_quaternion(q, &alpha, &beta, &gamma, 1);
+  so3_grid_euler_to_quaternion(
+      p, &candidates[0].alpha, &candidates[0].beta, &candidates[0].gamma, 1);
+  assert_float_equal(
+      fabs(p[0] * q[0] - p[1] * q[1] - p[2] * q[2] - p[3] * q[3]), 1.0, 1e-4);
+
+  // The search does at least as well as the full grid at band-limit L.
+  so3_conv_s2toso3_harmonic_convolution(hlmn, parameters, flm, glm);
+  so3_core_inverse_direct(h, hlmn, parameters);
+  for (i = 0; i < f_size; ++i)
+    grid_maximum = fmax(grid_maximum, creal(h[i]));
+  assert_true(candidates[0].score >= grid_maximum - 1e-10 * energy);
+
+  free(D);
+  free(hlmn);
+  free(h);
+}
+
+static void test_search(void **state) {
+  const so3_parameters_t *parameters = *state;
+  check_search(parameters, 0.3, 1.2, 4.0);
+  check_search(parameters, 5.0, 2.9, 1.0);
+  check_search(parameters, 2.0, 0.05, 0.5);
+}
+
+int main(void) {
+  so3_parameters_t parameters =
+      test_parameters(BANDLIMIT, BANDLIMIT, SO3_STORAGE_PADDED);
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_prestate(test_search, &parameters),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
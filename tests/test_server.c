@@ -0,0 +1,402 @@
+#include <limits.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <complex.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "so3/so3_conv.h"
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_server.h"
+#include "so3/so3_small.h"
+#include "so3/so3_tune.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+#define NTHREADS 4
+
+static char socket_path[64];
+
+static const so3_parameters_t small_parameters = {
+    .L0 = 0,
+    .L = 8,
+    .N = 3,
+    .verbosity = 0,
+    .n_mode = SO3_N_MODE_ALL,
+    .sampling_scheme = SO3_SAMPLING_MW,
+    .n_order = SO3_N_ORDER_NEGATIVE_FIRST,
+    .storage = SO3_STORAGE_COMPACT,
+    .dl_method = SSHT_DL_RISBO,
+    .steerable = 0};
+
+static int setup(void **state) {
+  snprintf(socket_path, sizeof socket_path, "/tmp/so3d-test-%ld.sock", (long)getpid());
+  so3_tune_set_file("");
+  *state = so3_server_start(socket_path, 2);
+  return *state ? 0 : -1;
+}
+
+static int teardown(void **state) {
+  so3_server_stop(*state);
+  so3_tune_clear();
+  return 0;
+}
+
+// The generators write (2N-1)*L*L coefficients whatever the storage.
+static complex double *random_flmn(const so3_parameters_t *parameters, int batch, int seed) {
+  const int size = so3_sampling_flmn_size(parameters);
+  complex double *flmn = malloc(batch * size * sizeof *flmn);
+  complex double *scratch =
+      malloc((2 * parameters->N - 1) * parameters->L * parameters->L * sizeof *scratch);
+  int k;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(scratch);
+  for (k = 0; k < batch; ++k) {
+    if (parameters->reality)
+      gen_flmn_real(scratch, parameters, seed + k);
+    else
+      gen_flmn_complex(scratch, parameters, seed + k);
+    memcpy(flmn + k * size, scratch, size * sizeof *flmn);
+  }
+  free(scratch);
+  return flmn;
+}
+
+static void assert_complex_equal(
+    const complex double *actual, const complex double *expected, int size) {
+  int i;
+  for (i = 0; i < size; ++i) {
+    assert_float_equal(creal(actual[i]), creal(expected[i]), 1e-10);
+    assert_float_equal(cimag(actual[i]), cimag(expected[i]), 1e-10);
+  }
+}
+
+static void test_server_complex(void **state) {
+  const int batch = 3;
+  so3_parameters_t parameters = small_parameters;
+  const int flmn_size = so3_sampling_flmn_size(&parameters);
+  const int f_size = so3_sampling_f_size(&parameters);
+  complex double *flmn = random_flmn(&parameters, batch, 1);
+  complex double *f = malloc(batch * f_size * sizeof *f);
+  complex double *expected = malloc(f_size * sizeof *expected);
+  complex double *flmn_server = malloc(batch * flmn_size * sizeof *flmn_server);
+  complex double *flmn_expected = calloc(flmn_size, sizeof *flmn_expected);
+  int k;
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_server);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_expected);
+
+  so3_client_t *client = so3_client_connect(socket_path);
+  assert_non_null(client);
+  assert_int_equal(so3_client_inverse(client, f, flmn, batch, &parameters), SO3_SERVER_OK);
+  assert_int_equal(
+      so3_client_forward(client, flmn_server, f, batch, &parameters), SO3_SERVER_OK);
+  so3_client_close(client);
+
+  for (k = 0; k < batch; ++k) {
+    so3_core_inverse_direct(expected, flmn + k * flmn_size, &parameters);
+    assert_complex_equal(f + k * f_size, expected, f_size);
+    so3_core_forward_direct(flmn_expected, f + k * f_size, &parameters);
+    assert_complex_equal(flmn_server + k * flmn_size, flmn_expected, flmn_size);
+  }
+
+  free(flmn);
+  free(f);
+  free(expected);
+  free(flmn_server);
+  free(flmn_expected);
+}
+
+static void test_server_real(void **state) {
+  const int batch = 2;
+  so3_parameters_t parameters = small_parameters;
+  parameters.reality = 1;
+  parameters.sampling_scheme = SO3_SAMPLING_MW_SS;
+  const int flmn_size = so3_sampling_flmn_size(&parameters);
+  const int f_size = so3_sampling_f_size(&parameters);
+  complex double *flmn = random_flmn(&parameters, batch, 5);
+  double *f = malloc(batch * f_size * sizeof *f);
+  double *expected = malloc(f_size * sizeof *expected);
+  int k, i;
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+
+  so3_client_t *client = so3_client_connect(socket_path);
+  assert_non_null(client);
+  assert_int_equal(
+      so3_client_inverse_real(client, f, flmn, batch, &parameters), SO3_SERVER_OK);
+  so3_client_close(client);
+
+  for (k = 0; k < batch; ++k) {
+    so3_core_inverse_direct_real(expected, flmn + k * flmn_size, &parameters);
+    for (i = 0; i < f_size; ++i)
+      assert_float_equal(f[k * f_size + i], expected[i], 1e-10);
+  }
+
+  free(flmn);
+  free(f);
+  free(expected);
+}
+
+static void test_server_tuned(void **state) {
+  // Above SO3_SMALL_L_MAX the server uses the tuned algorithm.
+  so3_parameters_t parameters = small_parameters;
+  parameters.L = SO3_SMALL_L_MAX + 4;
+  parameters.N = 2;
+  const int f_size = so3_sampling_f_size(&parameters);
+  complex double *flmn = random_flmn(&parameters, 1, 9);
+  complex double *f = malloc(f_size * sizeof *f);
+  complex double *expected = malloc(f_size * sizeof *expected);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+
+  so3_client_t *client = so3_client_connect(socket_path);
+  assert_non_null(client);
+  assert_int_equal(so3_client_inverse(client, f, flmn, 1, &parameters), SO3_SERVER_OK);
+  so3_client_close(client);
+
+  so3_core_inverse_direct(expected, flmn, &parameters);
+  assert_complex_equal(f, expected, f_size);
+
+  free(flmn);
+  free(f);
+  free(expected);
+}
+
+typedef struct {
+  const complex double *flmn;
+  complex double *f;
+  so3_server_status_t status;
+} concurrent_job_t;
+
+// Submit one inverse transform through a shared-memory buffer, without
+// copies through the convenience functions.
+static void *submit_inverse(void *arg) {
+  concurrent_job_t *job = arg;
+  so3_server_request_t request;
+  memset(&request, 0, sizeof request);
+  request.op = SO3_SERVER_INVERSE;
+  request.parameters = small_parameters;
+  request.batch = 1;
+  size_t in_size = so3_server_in_size(&request);
+  size_t out_size = so3_server_out_size(&request);
+
+  so3_shm_t *shm = so3_shm_alloc(in_size + out_size);
+  so3_client_t *client = so3_client_connect(socket_path);
+  if (!shm || !client) {
+    job->status = SO3_SERVER_EIO;
+  } else {
+    memcpy(shm->data, job->flmn, in_size);
+    request.in_offset = 0;
+    request.out_offset = in_size;
+    job->status = so3_client_submit(client, &request, shm);
+    memcpy(job->f, (char *)shm->data + in_size, out_size);
+  }
+  so3_client_close(client);
+  so3_shm_free(shm);
+  return NULL;
+}
+
+static void test_server_concurrent(void **state) {
+  const int flmn_size = so3_sampling_flmn_size(&small_parameters);
+  const int f_size = so3_sampling_f_size(&small_parameters);
+  complex double *flmn = random_flmn(&small_parameters, NTHREADS, 11);
+  complex double *f = malloc(NTHREADS * f_size * sizeof *f);
+  complex double *expected = malloc(f_size * sizeof *expected);
+  concurrent_job_t jobs[NTHREADS];
+  pthread_t threads[NTHREADS];
+  int k;
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+
+  for (k = 0; k < NTHREADS; ++k) {
+    jobs[k].flmn = flmn + k * flmn_size;
+    jobs[k].f = f + k * f_size;
+    assert_int_equal(pthread_create(&threads[k], NULL, submit_inverse, &jobs[k]), 0);
+  }
+  for (k = 0; k < NTHREADS; ++k) {
+    pthread_join(threads[k], NULL);
+    assert_int_equal(jobs[k].status, SO3_SERVER_OK);
+    so3_core_inverse_direct(expected, flmn + k * flmn_size, &small_parameters);
+    assert_complex_equal(f + k * f_size, expected, f_size);
+  }
+
+  free(flmn);
+  free(f);
+  free(expected);
+}
+
+static void test_server_convolution(void **state) {
+  so3_parameters_t f_parameters = small_parameters;
+  so3_parameters_t g_parameters = small_parameters;
+  g_parameters.L = 6;
+  so3_parameters_t h_parameters =
+      so3_conv_get_parameters_of_convolved_lmn(&f_parameters, &g_parameters);
+  const int h_size = so3_sampling_flmn_size(&h_parameters);
+  complex double *flmn = random_flmn(&f_parameters, 1, 3);
+  complex double *glmn = random_flmn(&g_parameters, 1, 4);
+  complex double *hlmn = malloc(h_size * sizeof *hlmn);
+  complex double *expected = malloc(h_size * sizeof *expected);
+  SO3_ERROR_MEM_ALLOC_CHECK(hlmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+
+  so3_client_t *client = so3_client_connect(socket_path);
+  assert_non_null(client);
+  assert_int_equal(
+      so3_client_harmonic_convolution(
+          client, hlmn, flmn, &f_parameters, glmn, &g_parameters),
+      SO3_SERVER_OK);
+  so3_client_close(client);
+
+  so3_conv_harmonic_convolution(
+      expected, &h_parameters, flmn, &f_parameters, glmn, &g_parameters);
+  assert_complex_equal(hlmn, expected, h_size);
+
+  free(flmn);
+  free(glmn);
+  free(hlmn);
+  free(expected);
+}
+
+static void test_server_invalid(void **state) {
+  so3_server_request_t request;
+  memset(&request, 0, sizeof request);
+  request.op = SO3_SERVER_INVERSE;
+  request.parameters = small_parameters;
+  request.batch = 1;
+
+  // The buffer is too small for the output.
+  so3_shm_t *shm = so3_shm_alloc(so3_server_in_size(&request));
+  so3_client_t *client = so3_client_connect(socket_path);
+  assert_non_null(shm);
+  assert_non_null(client);
+  request.out_offset = so3_server_in_size(&request);
+  assert_int_equal(so3_client_submit(client, &request, shm), SO3_SERVER_EINVAL);
+
+  request.batch = 0;
+  request.out_offset = 0;
+  assert_int_equal(so3_client_submit(client, &request, shm), SO3_SERVER_EINVAL);
+  so3_client_close(client);
+  so3_shm_free(shm);
+
+  assert_null(so3_client_connect("/nonexistent/so3d.sock"));
+}
+
+// Malformed parameters are rejected before they reach the transforms, and
+// the server keeps running.
+static void test_server_invalid_parameters(void **state) {
+  const so3_parameters_t *parameters = &small_parameters;
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  const int f_size = so3_sampling_f_size(parameters);
+  complex double *flmn = random_flmn(parameters, 1, 21);
+  complex double *f = malloc(f_size * sizeof *f);
+  complex double *expected = malloc(f_size * sizeof *expected);
+  so3_server_request_t request;
+  so3_parameters_t bad[11];
+  int k;
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+
+  for (k = 0; k < 11; ++k)
+    bad[k] = *parameters;
+  bad[0].sampling_scheme = SO3_SAMPLING_SIZE;
+  bad[1].storage = -1;
+  bad[2].n_order = SO3_N_ORDER_SIZE;
+  bad[3].n_mode = SO3_N_MODE_SIZE + 3;
+  bad[4].dl_method = SSHT_DL_TRAPANI + 1;
+  bad[5].L0 = bad[5].L;
+  bad[6].L0 = -1;
+  bad[7].N = bad[7].L + 1;
+  bad[8].M = bad[8].L + 1;
+  bad[9].M = -2;
+  bad[10].L = 1 << 20;
+
+  so3_client_t *client = so3_client_connect(socket_path);
+  assert_non_null(client);
+  memset(&request, 0, sizeof request);
+  request.op = SO3_SERVER_INVERSE;
+  request.batch = 1;
+  for (k = 0; k < 11; ++k) {
+    request.parameters = bad[k];
+    assert_int_equal(so3_server_check_request(&request), SO3_SERVER_EINVAL);
+    assert_int_equal(so3_server_in_size(&request), 0);
+    assert_int_equal(
+        so3_client_inverse(client, f, flmn, 1, &bad[k]), SO3_SERVER_EINVAL);
+  }
+
+  // Sent as is, with a buffer large enough for any of them.
+  so3_shm_t *shm = so3_shm_alloc(4 * (flmn_size + f_size) * sizeof *flmn);
+  assert_non_null(shm);
+  request.out_offset = 2 * flmn_size * sizeof *flmn;
+  for (k = 0; k < 11; ++k) {
+    request.parameters = bad[k];
+    assert_int_equal(so3_client_submit(client, &request, shm), SO3_SERVER_EINVAL);
+  }
+
+  // Steerable signals with M < L have no algorithm.
+  request.parameters = *parameters;
+  request.parameters.steerable = 1;
+  request.parameters.M = parameters->L - 2;
+  assert_int_equal(so3_client_submit(client, &request, shm), SO3_SERVER_EINVAL);
+
+  // A convolution needs valid and compatible g_parameters.
+  request.op = SO3_SERVER_HARMONIC_CONVOLUTION;
+  request.parameters = *parameters;
+  request.g_parameters = *parameters;
+  request.g_parameters.N = 0;
+  assert_int_equal(so3_client_submit(client, &request, shm), SO3_SERVER_EINVAL);
+  request.g_parameters = *parameters;
+  request.g_parameters.storage = SO3_STORAGE_PADDED;
+  assert_int_equal(so3_client_submit(client, &request, shm), SO3_SERVER_EINVAL);
+
+  // A batch whose size overflows size_t.
+  request.op = SO3_SERVER_INVERSE;
+  request.parameters = *parameters;
+  request.parameters.L = 1024;
+  request.parameters.N = 500;
+  request.batch = INT_MAX;
+  assert_int_equal(so3_server_check_request(&request), SO3_SERVER_EINVAL);
+  assert_int_equal(so3_server_in_size(&request), 0);
+  assert_int_equal(so3_client_submit(client, &request, shm), SO3_SERVER_EINVAL);
+
+  // A buffer claimed larger than its file.
+  so3_shm_t larger = *shm;
+  larger.size = 64 * shm->size;
+  request.parameters = *parameters;
+  request.batch = 1;
+  assert_int_equal(so3_client_submit(client, &request, &larger), SO3_SERVER_ESHM);
+  so3_shm_free(shm);
+
+  assert_int_equal(so3_client_inverse(client, f, flmn, 1, parameters), SO3_SERVER_OK);
+  so3_core_inverse_direct(expected, flmn, parameters);
+  assert_complex_equal(f, expected, f_size);
+  so3_client_close(client);
+
+  free(flmn);
+  free(f);
+  free(expected);
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_setup_teardown(test_server_complex, setup, teardown),
+      cmocka_unit_test_setup_teardown(test_server_real, setup, teardown),
+      cmocka_unit_test_setup_teardown(test_server_tuned, setup, teardown),
+      cmocka_unit_test_setup_teardown(test_server_concurrent, setup, teardown),
+      cmocka_unit_test_setup_teardown(test_server_convolution, setup, teardown),
+      cmocka_unit_test_setup_teardown(test_server_invalid, setup, teardown),
+      cmocka_unit_test_setup_teardown(test_server_invalid_parameters, setup, teardown),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
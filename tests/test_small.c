@@ -0,0 +1,267 @@
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_small.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+#define BATCH 7
+#define NTHREADS 4
+
+static void test_small_complex(void **state) {
+  const so3_parameters_t parameters = **(const so3_parameters_t **)state;
+  const int flmn_size = so3_sampling_flmn_size(&parameters);
+  const int f_size = so3_sampling_nalpha(&parameters) *
+                     so3_sampling_nbeta(&parameters) * (2 * parameters.N - 1);
+  assert_true(BATCH >= so3_sampling_nbeta(&parameters));
+
+  complex double *flmn = malloc(BATCH * flmn_size * sizeof *flmn);
+  complex double *flmn_small = malloc(BATCH * flmn_size * sizeof *flmn_small);
+  complex double *flmn_direct = calloc(BATCH * flmn_size, sizeof *flmn_direct);
+  complex double *f_small = malloc(BATCH * f_size * sizeof *f_small);
+  complex double *f_direct = malloc(BATCH * f_size * sizeof *f_direct);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_small);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_direct);
+  SO3_ERROR_MEM_ALLOC_CHECK(f_small);
+  SO3_ERROR_MEM_ALLOC_CHECK(f_direct);
+  // The generators fill a fully padded, complex coefficient array.
+  complex double *scratch =
+      malloc((2 * parameters.N - 1) * parameters.L * parameters.L * sizeof *scratch);
+  SO3_ERROR_MEM_ALLOC_CHECK(scratch);
+
+  int k, i;
+  for (k = 0; k < BATCH; ++k) {
+    gen_flmn_complex(scratch, &parameters, k + 1);
+    memcpy(flmn + k * flmn_size, scratch, flmn_size * sizeof *flmn);
+  }
+  free(scratch);
+
+  so3_core_inverse_batch(f_small, flmn, BATCH, &parameters);
+  for (k = 0; k < BATCH; ++k)
+    so3_core_inverse_direct(f_direct + k * f_size, flmn + k * flmn_size, &parameters);
+  for (i = 0; i < BATCH * f_size; ++i) {
+    assert_float_equal(creal(f_small[i]), creal(f_direct[i]), 1e-12);
+    assert_float_equal(cimag(f_small[i]), cimag(f_direct[i]), 1e-12);
+  }
+
+  so3_core_forward_batch(flmn_small, f_direct, BATCH, &parameters);
+  for (k = 0; k < BATCH; ++k)
+    so3_core_forward_direct(
+        flmn_direct + k * flmn_size, f_direct + k * f_size, &parameters);
+  for (i = 0; i < BATCH * flmn_size; ++i) {
+    assert_float_equal(creal(flmn_small[i]), creal(flmn_direct[i]), 1e-12);
+    assert_float_equal(cimag(flmn_small[i]), cimag(flmn_direct[i]), 1e-12);
+    assert_float_equal(creal(flmn_small[i]), creal(flmn[i]), 1e-10);
+    assert_float_equal(cimag(flmn_small[i]), cimag(flmn[i]), 1e-10);
+  }
+
+  free(flmn);
+  free(flmn_small);
+  free(flmn_direct);
+  free(f_small);
+  free(f_direct);
+}
+
+static void test_small_real(void **state) {
+  so3_parameters_t parameters = **(const so3_parameters_t **)state;
+  parameters.reality = 1;
+  const int flmn_size = so3_sampling_flmn_size(&parameters);
+  const int f_size = so3_sampling_nalpha(&parameters) *
+                     so3_sampling_nbeta(&parameters) * (2 * parameters.N - 1);
+  assert_true(BATCH >= so3_sampling_nbeta(&parameters));
+
+  complex double *flmn = malloc(BATCH * flmn_size * sizeof *flmn);
+  complex double *flmn_small = malloc(BATCH * flmn_size * sizeof *flmn_small);
+  complex double *flmn_direct = calloc(BATCH * flmn_size, sizeof *flmn_direct);
+  double *f_small = malloc(BATCH * f_size * sizeof *f_small);
+  double *f_direct = malloc(BATCH * f_size * sizeof *f_direct);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_small);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_direct);
+  SO3_ERROR_MEM_ALLOC_CHECK(f_small);
+  SO3_ERROR_MEM_ALLOC_CHECK(f_direct);
+  // The generators fill a fully padded, complex coefficient array.
+  complex double *scratch =
+      malloc((2 * parameters.N - 1) * parameters.L * parameters.L * sizeof *scratch);
+  SO3_ERROR_MEM_ALLOC_CHECK(scratch);
+
+  int k, i;
+  for (k = 0; k < BATCH; ++k) {
+    gen_flmn_real(scratch, &parameters, k + 1);
+    memcpy(flmn + k * flmn_size, scratch, flmn_size * sizeof *flmn);
+  }
+  free(scratch);
+
+  so3_core_inverse_batch_real(f_small, flmn, BATCH, &parameters);
+  for (k = 0; k < BATCH; ++k)
+    so3_core_inverse_direct_real(
+        f_direct + k * f_size, flmn + k * flmn_size, &parameters);
+  for (i = 0; i < BATCH * f_size; ++i)
+    assert_float_equal(f_small[i], f_direct[i], 1e-12);
+
+  so3_core_forward_batch_real(flmn_small, f_direct, BATCH, &parameters);
+  for (k = 0; k < BATCH; ++k)
+    so3_core_forward_direct_real(
+        flmn_direct + k * flmn_size, f_direct + k * f_size, &parameters);
+  for (i = 0; i < BATCH * flmn_size; ++i) {
+    assert_float_equal(creal(flmn_small[i]), creal(flmn_direct[i]), 1e-12);
+    assert_float_equal(cimag(flmn_small[i]), cimag(flmn_direct[i]), 1e-12);
+    assert_float_equal(creal(flmn_small[i]), creal(flmn[i]), 1e-10);
+    assert_float_equal(cimag(flmn_small[i]), cimag(flmn[i]), 1e-10);
+  }
+
+  free(flmn);
+  free(flmn_small);
+  free(flmn_direct);
+  free(f_small);
+  free(f_direct);
+}
+
+// Once built, the cached plan serves batches of any size.
+static void test_small_cached(void **state) {
+  const so3_parameters_t parameters = **(const so3_parameters_t **)state;
+  const int flmn_size = so3_sampling_flmn_size(&parameters);
+  const int f_size = so3_sampling_f_size(&parameters);
+  const int batches[3] = {BATCH, 1, 3};
+  complex double *flmn = malloc(BATCH * flmn_size * sizeof *flmn);
+  complex double *f = malloc(BATCH * f_size * sizeof *f);
+  complex double *expected = malloc(f_size * sizeof *expected);
+  complex double *scratch =
+      malloc((2 * parameters.N - 1) * parameters.L * parameters.L * sizeof *scratch);
+  int j, k, i;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+  SO3_ERROR_MEM_ALLOC_CHECK(scratch);
+  for (k = 0; k < BATCH; ++k) {
+    gen_flmn_complex(scratch, &parameters, k + 11);
+    memcpy(flmn + k * flmn_size, scratch, flmn_size * sizeof *flmn);
+  }
+  free(scratch);
+
+  so3_small_plan_cache_clear();
+  assert_null(so3_small_plan_cached(&parameters));
+  for (j = 0; j < 3; ++j) {
+    so3_core_inverse_batch(f, flmn, batches[j], &parameters);
+    assert_non_null(so3_small_plan_cached(&parameters));
+    assert_true(so3_small_plan_cached(&parameters) == so3_small_plan_get(&parameters));
+    for (k = 0; k < batches[j]; ++k) {
+      so3_core_inverse_direct(expected, flmn + k * flmn_size, &parameters);
+      for (i = 0; i < f_size; ++i) {
+        assert_float_equal(creal(f[k * f_size + i]), creal(expected[i]), 1e-12);
+        assert_float_equal(cimag(f[k * f_size + i]), cimag(expected[i]), 1e-12);
+      }
+    }
+  }
+  so3_small_plan_cache_clear();
+  assert_null(so3_small_plan_cached(&parameters));
+
+  free(flmn);
+  free(f);
+  free(expected);
+}
+
+typedef struct {
+  const so3_parameters_t *parameters;
+  const complex double *flmn;
+  complex double *f;
+} small_thread_t;
+
+static void *small_thread(void *data) {
+  small_thread_t *thread = data;
+  so3_core_inverse_batch(thread->f, thread->flmn, BATCH, thread->parameters);
+  return NULL;
+}
+
+// Threads racing to build the same plan share it, and transform concurrently.
+static void test_small_threads(void **state) {
+  const so3_parameters_t parameters = **(const so3_parameters_t **)state;
+  const int flmn_size = so3_sampling_flmn_size(&parameters);
+  const int f_size = so3_sampling_f_size(&parameters);
+  complex double *flmn = malloc(BATCH * flmn_size * sizeof *flmn);
+  complex double *f = malloc(NTHREADS * BATCH * f_size * sizeof *f);
+  complex double *expected = malloc(BATCH * f_size * sizeof *expected);
+  complex double *scratch =
+      malloc((2 * parameters.N - 1) * parameters.L * parameters.L * sizeof *scratch);
+  pthread_t threads[NTHREADS];
+  small_thread_t data[NTHREADS];
+  int j, k, i;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+  SO3_ERROR_MEM_ALLOC_CHECK(scratch);
+  for (k = 0; k < BATCH; ++k) {
+    gen_flmn_complex(scratch, &parameters, k + 21);
+    memcpy(flmn + k * flmn_size, scratch, flmn_size * sizeof *flmn);
+  }
+  free(scratch);
+  for (k = 0; k < BATCH; ++k)
+    so3_core_inverse_direct(expected + k * f_size, flmn + k * flmn_size, &parameters);
+
+  so3_small_plan_cache_clear();
+  for (j = 0; j < NTHREADS; ++j) {
+    data[j].parameters = &parameters;
+    data[j].flmn = flmn;
+    data[j].f = f + j * BATCH * f_size;
+    assert_int_equal(pthread_create(&threads[j], NULL, small_thread, &data[j]), 0);
+  }
+  for (j = 0; j < NTHREADS; ++j)
+    pthread_join(threads[j], NULL);
+  for (j = 0; j < NTHREADS; ++j)
+    for (i = 0; i < BATCH * f_size; ++i) {
+      assert_float_equal(creal(data[j].f[i]), creal(expected[i]), 1e-12);
+      assert_float_equal(cimag(data[j].f[i]), cimag(expected[i]), 1e-12);
+    }
+  so3_small_plan_cache_clear();
+
+  free(flmn);
+  free(f);
+  free(expected);
+}
+
+int main(void) {
+  const so3_parameters_t mw = {
+      .L0 = 0,
+      .L = 6,
+      .N = 3,
+      .verbosity = 0,
+      .n_mode = SO3_N_MODE_ALL,
+      .reality = 0,
+      .sampling_scheme = SO3_SAMPLING_MW,
+      .n_order = SO3_N_ORDER_ZERO_FIRST,
+      .storage = SO3_STORAGE_PADDED,
+      .steerable = 0};
+  so3_parameters_t mwss = mw;
+  mwss.sampling_scheme = SO3_SAMPLING_MW_SS;
+  so3_parameters_t compact = mw;
+  compact.L0 = 2;
+  compact.storage = SO3_STORAGE_COMPACT;
+  compact.n_order = SO3_N_ORDER_NEGATIVE_FIRST;
+  so3_parameters_t azimuthal = mwss;
+  azimuthal.M = 4;
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_prestate(test_small_complex, (void **)&mw),
+      cmocka_unit_test_prestate(test_small_real, (void **)&mw),
+      cmocka_unit_test_prestate(test_small_complex, (void **)&mwss),
+      cmocka_unit_test_prestate(test_small_real, (void **)&mwss),
+      cmocka_unit_test_prestate(test_small_complex, (void **)&compact),
+      cmocka_unit_test_prestate(test_small_real, (void **)&compact),
+      cmocka_unit_test_prestate(test_small_complex, (void **)&azimuthal),
+      cmocka_unit_test_prestate(test_small_real, (void **)&azimuthal),
+      cmocka_unit_test_prestate(test_small_cached, (void **)&mw),
+      cmocka_unit_test_prestate(test_small_threads, (void **)&mw),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -187,6 +187,48 @@ void test_direct_vs_ssht(void **_state) {
   free(f_ssht);
 }
 
+// The direct inverse transforms with a Wigner tolerance stay close to the
+// exact ones.
+void test_dl_tolerance_vs_exact(void **_state) {
+  SO3TestState const *state = *(const SO3TestState **)_state;
+  so3_parameters_t const *parameters = &state->params;
+  so3_parameters_t exact = *parameters;
+  exact.dl_tolerance = 0.0;
+
+  complex double *flmn_orig = calloc(
+      (2 * parameters->N - 1) * parameters->L * parameters->L, sizeof(complex double));
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_orig);
+  int const f_size = so3_sampling_f_size(parameters);
+  complex double *f_exact = calloc(f_size, sizeof(complex double));
+  SO3_ERROR_MEM_ALLOC_CHECK(f_exact);
+  complex double *f_approx = calloc(f_size, sizeof(complex double));
+  SO3_ERROR_MEM_ALLOC_CHECK(f_approx);
+
+  if (parameters->reality) {
+    gen_flmn_real(flmn_orig, parameters, state->seed);
+    so3_core_inverse_direct_real((double *)f_exact, flmn_orig, &exact);
+    so3_core_inverse_direct_real((double *)f_approx, flmn_orig, parameters);
+  } else {
+    gen_flmn_complex(flmn_orig, parameters, state->seed);
+    so3_core_inverse_direct(f_exact, flmn_orig, &exact);
+    so3_core_inverse_direct(f_approx, flmn_orig, parameters);
+  }
+
+  double max_error = 0.0;
+  for (int i = 0; i < f_size; i += 1) {
+    assert_float_equal(creal(f_exact[i]), creal(f_approx[i]), state->tolerance);
+    assert_float_equal(cimag(f_exact[i]), cimag(f_approx[i]), state->tolerance);
+    if (cabs(f_exact[i] - f_approx[i]) > max_error)
+      max_error = cabs(f_exact[i] - f_approx[i]);
+  }
+  // The tolerance is large enough to skip some entries at this band-limit.
+  assert_true(max_error > 0.0);
+
+  free(flmn_orig);
+  free(f_exact);
+  free(f_approx);
+}
+
 static SO3TestState *parametrization(
     char const *name,
     so3_sampling_t sampling,
@@ -253,7 +295,7 @@ char const *name_of_test(
 }
 
 int main(void) {
-  struct CMUnitTest tests[180];
+  struct CMUnitTest tests[320];
   memset(tests, 0, sizeof(tests));
 
   int i = 0;
@@ -270,59 +312,106 @@ int main(void) {
         tests[i].test_func = &test_real_back_and_forth;
       }
 
-  for (so3_n_mode_t mode = 0; mode < SO3_N_MODE_SIZE; mode += 1)
-    for (so3_storage_t storage = 0; storage < SO3_STORAGE_SIZE; storage += 1)
-      for (int steerable = 0; steerable < 2; steerable += 1, i += 1) {
-        tests[i].name = name_of_test(
-            "back_and_forth: direct", sampling, order, mode, storage, steerable, 1);
-        tests[i].initial_state =
-            parametrization("direct", sampling, order, mode, storage, steerable, 1);
-        tests[i].test_func = &test_real_back_and_forth;
-      }
-
-  for (so3_n_mode_t mode = 0; mode < SO3_N_MODE_SIZE; mode += 1)
-    for (so3_storage_t storage = 0; storage < SO3_STORAGE_SIZE; storage += 1)
-      for (int steerable = 0; steerable < 2; steerable += 1, i += 1) {
-        tests[i].name = name_of_test(
-            "direct vs ssht", sampling, order, mode, storage, steerable, 1);
-        tests[i].initial_state =
-            parametrization("", sampling, order, mode, storage, steerable, 1);
-        tests[i].test_func = &test_real_direct_vs_ssht;
-      }
+  for (so3_sampling_t sampling = 0; sampling < SO3_SAMPLING_SIZE; sampling += 1)
+    for (so3_n_mode_t mode = 0; mode < SO3_N_MODE_SIZE; mode += 1)
+      for (so3_storage_t storage = 0; storage < SO3_STORAGE_SIZE; storage += 1)
+        for (int steerable = 0; steerable < 2; steerable += 1, i += 1) {
+          tests[i].name = name_of_test(
+              "back_and_forth: direct", sampling, order, mode, storage, steerable, 1);
+          tests[i].initial_state =
+              parametrization("direct", sampling, order, mode, storage, steerable, 1);
+          tests[i].test_func = &test_real_back_and_forth;
+        }
 
-  for (so3_n_mode_t mode = 0; mode < SO3_N_MODE_SIZE; mode += 1)
-    for (so3_storage_t storage = 0; storage < SO3_STORAGE_SIZE; storage += 1)
-      for (so3_n_order_t order = 0; order < SO3_N_ORDER_SIZE; order += 1)
+  for (so3_sampling_t sampling = 0; sampling < SO3_SAMPLING_SIZE; sampling += 1)
+    for (so3_n_mode_t mode = 0; mode < SO3_N_MODE_SIZE; mode += 1)
+      for (so3_storage_t storage = 0; storage < SO3_STORAGE_SIZE; storage += 1)
         for (int steerable = 0; steerable < 2; steerable += 1, i += 1) {
-          assert(i + 2 < sizeof(tests) / sizeof(tests[0]));
           tests[i].name = name_of_test(
-              "back_and_forth: ssht", sampling, order, mode, storage, steerable, 0);
+              "direct vs ssht", sampling, order, mode, storage, steerable, 1);
           tests[i].initial_state =
-              parametrization("ssht", sampling, order, mode, storage, steerable, 0);
-          tests[i].test_func = &test_back_and_forth;
+              parametrization("", sampling, order, mode, storage, steerable, 1);
+          tests[i].test_func = &test_real_direct_vs_ssht;
         }
 
   for (so3_n_mode_t mode = 0; mode < SO3_N_MODE_SIZE; mode += 1)
     for (so3_storage_t storage = 0; storage < SO3_STORAGE_SIZE; storage += 1)
       for (so3_n_order_t order = 0; order < SO3_N_ORDER_SIZE; order += 1)
         for (int steerable = 0; steerable < 2; steerable += 1, i += 1) {
+          assert(i + 2 < sizeof(tests) / sizeof(tests[0]));
           tests[i].name = name_of_test(
-              "back_and_forth: direct", sampling, order, mode, storage, steerable, 0);
+              "back_and_forth: ssht", sampling, order, mode, storage, steerable, 0);
           tests[i].initial_state =
-              parametrization("direct", sampling, order, mode, storage, steerable, 0);
+              parametrization("ssht", sampling, order, mode, storage, steerable, 0);
           tests[i].test_func = &test_back_and_forth;
         }
 
-  for (so3_n_mode_t mode = 0; mode < SO3_N_MODE_SIZE; mode += 1)
+  for (so3_sampling_t sampling = 0; sampling < SO3_SAMPLING_SIZE; sampling += 1)
+    for (so3_n_mode_t mode = 0; mode < SO3_N_MODE_SIZE; mode += 1)
+      for (so3_storage_t storage = 0; storage < SO3_STORAGE_SIZE; storage += 1)
+        for (so3_n_order_t order = 0; order < SO3_N_ORDER_SIZE; order += 1)
+          for (int steerable = 0; steerable < 2; steerable += 1, i += 1) {
+            tests[i].name = name_of_test(
+                "back_and_forth: direct", sampling, order, mode, storage, steerable, 0);
+            tests[i].initial_state =
+                parametrization("direct", sampling, order, mode, storage, steerable, 0);
+            tests[i].test_func = &test_back_and_forth;
+          }
+
+  for (so3_sampling_t sampling = 0; sampling < SO3_SAMPLING_SIZE; sampling += 1)
+    for (so3_n_mode_t mode = 0; mode < SO3_N_MODE_SIZE; mode += 1)
+      for (so3_storage_t storage = 0; storage < SO3_STORAGE_SIZE; storage += 1)
+        for (so3_n_order_t order = 0; order < SO3_N_ORDER_SIZE; order += 1)
+          for (int steerable = 0; steerable < 2; steerable += 1, i += 1) {
+            tests[i].name = name_of_test(
+                "direct vs ssht", sampling, order, mode, storage, steerable, 0);
+            tests[i].initial_state =
+                parametrization("", sampling, order, mode, storage, steerable, 0);
+            tests[i].test_func = &test_direct_vs_ssht;
+          }
+
+  // Direct transforms with an azimuthal band-limit M < L.
+  for (so3_sampling_t sampling = 0; sampling < SO3_SAMPLING_SIZE; sampling += 1)
     for (so3_storage_t storage = 0; storage < SO3_STORAGE_SIZE; storage += 1)
-      for (so3_n_order_t order = 0; order < SO3_N_ORDER_SIZE; order += 1)
-        for (int steerable = 0; steerable < 2; steerable += 1, i += 1) {
+      for (int real = 0; real < 2; real += 1, i += 1) {
+        assert(i + 2 < sizeof(tests) / sizeof(tests[0]));
+        const so3_n_mode_t mode = SO3_N_MODE_ALL;
+        tests[i].name = name_of_test(
+            "back_and_forth: direct, M=3", sampling, order, mode, storage, 0, real);
+        SO3TestState *state =
+            parametrization("direct", sampling, order, mode, storage, 0, real);
+        state->params.M = 3;
+        tests[i].initial_state = state;
+        tests[i].test_func = real ? &test_real_back_and_forth : &test_back_and_forth;
+      }
+
+  // Direct transforms skipping Wigner entries below a tolerance, at a
+  // band-limit where d^el(pi/2) has entries below it.
+  for (so3_sampling_t sampling = 0; sampling < SO3_SAMPLING_SIZE; sampling += 1)
+    for (int real = 0; real < 2; real += 1) {
+      const so3_n_mode_t mode = SO3_N_MODE_ALL;
+      const so3_storage_t storage = SO3_STORAGE_COMPACT;
+      for (int exact = 0; exact < 2; exact += 1, i += 1) {
+        assert(i + 2 < sizeof(tests) / sizeof(tests[0]));
+        SO3TestState *state =
+            parametrization("direct", sampling, order, mode, storage, 0, real);
+        state->params.L = 32;
+        state->params.dl_tolerance = 1e-8;
+        if (exact) {
+          state->tolerance = 1e-6;
           tests[i].name = name_of_test(
-              "direct vs ssht", sampling, order, mode, storage, steerable, 0);
-          tests[i].initial_state =
-              parametrization("", sampling, order, mode, storage, steerable, 0);
-          tests[i].test_func = &test_direct_vs_ssht;
+              "direct vs exact, dl_tolerance=1e-8", sampling, order, mode, storage, 0,
+              real);
+          tests[i].test_func = &test_dl_tolerance_vs_exact;
+        } else {
+          tests[i].name = name_of_test(
+              "back_and_forth: direct, dl_tolerance=1e-8", sampling, order, mode,
+              storage, 0, real);
+          tests[i].test_func = real ? &test_real_back_and_forth : &test_back_and_forth;
         }
+        tests[i].initial_state = state;
+      }
+    }
 
   int result = cmocka_run_group_tests(tests, NULL, NULL);
 
@@ -0,0 +1,220 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <complex.h>
+
+#include "so3/so3_adjoint.h"
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_solver.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+// Compare the coefficients that are not zero by construction; the direct
+// adjoint also fills the padding of padded storage.
+static void assert_flmn_equal(
+    const complex double *actual, const complex double *expected,
+    const so3_parameters_t *parameters, double tolerance) {
+  so3_flmn_iter_t iter;
+  so3_flmn_iter_init(&iter, parameters);
+  while (so3_flmn_iter_next(&iter)) {
+    if (!so3_sampling_is_elmn_non_zero(iter.el, iter.m, iter.n, parameters))
+      continue;
+    assert_float_equal(creal(actual[iter.ind]), creal(expected[iter.ind]), tolerance);
+    assert_float_equal(cimag(actual[iter.ind]), cimag(expected[iter.ind]), tolerance);
+  }
+}
+
+static void check_operators(const so3_parameters_t *parameters) {
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  const int f_size = so3_sampling_f_size(parameters);
+  complex double *flmn = alloc_random_flmn(parameters, 1);
+  complex double *flmn_out = malloc(flmn_size * sizeof *flmn_out);
+  complex double *expected_flmn = malloc(flmn_size * sizeof *expected_flmn);
+  complex double *f = malloc(f_size * sizeof *f);
+  complex double *expected_f = malloc(f_size * sizeof *expected_f);
+  double *weights = malloc(f_size * sizeof *weights);
+  int i;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_out);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected_flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected_f);
+  SO3_ERROR_MEM_ALLOC_CHECK(weights);
+
+  so3_solver_t *solver = so3_solver_init(parameters);
+
+  so3_solver_inverse(solver, f, flmn);
+  so3_core_inverse_direct(expected_f, flmn, parameters);
+  assert_complex_array_equal(f, expected_f, f_size, 1e-10);
+
+  for (i = 0; i < f_size; ++i)
+    f[i] = (2.0 * ran2_dp(2) - 1.0) + I * (2.0 * ran2_dp(2) - 1.0);
+  so3_solver_adjoint_inverse(solver, flmn_out, f);
+  so3_adjoint_inverse_direct(expected_flmn, f, parameters);
+  assert_flmn_equal(flmn_out, expected_flmn, parameters, 1e-10);
+
+  // A^H W A with a ring masked out, a ring of uniform weight and varying
+  // weights elsewhere.
+  const int nalpha = so3_sampling_nalpha(parameters);
+  const int nbeta = so3_sampling_nbeta(parameters);
+  for (i = 0; i < f_size; ++i) {
+    int b = (i / nalpha) % nbeta;
+    weights[i] = b == 1 ? 0.0 : b == 2 ? 3.0 : ran2_dp(3);
+  }
+  so3_solver_set_weights(solver, weights);
+  so3_solver_normal(solver, flmn_out, flmn);
+  so3_core_inverse_direct(f, flmn, parameters);
+  for (i = 0; i < f_size; ++i)
+    f[i] *= weights[i];
+  so3_adjoint_inverse_direct(expected_flmn, f, parameters);
+  assert_flmn_equal(flmn_out, expected_flmn, parameters, 1e-10);
+
+  so3_solver_free(solver);
+  free(flmn);
+  free(flmn_out);
+  free(expected_flmn);
+  free(f);
+  free(expected_f);
+  free(weights);
+}
+
+static void test_solver_operators(void **state) {
+  const so3_parameters_t *base_parameters = *state;
+  so3_parameters_t parameters = *base_parameters;
+  check_operators(&parameters);
+
+  parameters.sampling_scheme = SO3_SAMPLING_MW_SS;
+  parameters.storage = SO3_STORAGE_PADDED;
+  parameters.n_order = SO3_N_ORDER_ZERO_FIRST;
+  check_operators(&parameters);
+
+  parameters = *base_parameters;
+  parameters.M = 5;
+  parameters.L0 = 2;
+  parameters.n_mode = SO3_N_MODE_EVEN;
+  check_operators(&parameters);
+}
+
+static void check_recovery(
+    const so3_parameters_t *parameters, const double *weights,
+    const so3_solver_options_t *options) {
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  const int f_size = so3_sampling_f_size(parameters);
+  complex double *flmn = alloc_random_flmn(parameters, 4);
+  complex double *flmn_out = malloc(flmn_size * sizeof *flmn_out);
+  complex double *f = malloc(f_size * sizeof *f);
+  double residual;
+  int i;
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_out);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+
+  so3_core_inverse_direct(f, flmn, parameters);
+  // Masked samples must not matter.
+  if (weights)
+    for (i = 0; i < f_size; ++i)
+      if (weights[i] == 0.0)
+        f[i] = 1e3;
+
+  so3_solver_t *solver = so3_solver_init(parameters);
+  so3_solver_set_weights(solver, weights);
+  int iterations = so3_solver_solve(solver, flmn_out, f, options, &residual);
+  so3_solver_free(solver);
+
+  assert_true(iterations > 0);
+  assert_true(iterations < options->max_iterations);
+  assert_true(residual <= options->tolerance);
+  assert_complex_array_equal(flmn_out, flmn, flmn_size, 1e-8);
+
+  free(flmn);
+  free(flmn_out);
+  free(f);
+}
+
+static void test_solver_full_sampling(void **state) {
+  const so3_parameters_t *base_parameters = *state;
+  so3_solver_options_t options = {.max_iterations = 200, .tolerance = 1e-12};
+
+  options.method = SO3_SOLVER_CG;
+  check_recovery(base_parameters, NULL, &options);
+  options.method = SO3_SOLVER_LSQR;
+  check_recovery(base_parameters, NULL, &options);
+}
+
+static void test_solver_masked(void **state) {
+  const so3_parameters_t *base_parameters = *state;
+  const int f_size = so3_sampling_f_size(base_parameters);
+  double *weights = malloc(f_size * sizeof *weights);
+  so3_solver_options_t options = {.max_iterations = 500, .tolerance = 1e-12};
+  int i;
+  SO3_ERROR_MEM_ALLOC_CHECK(weights);
+
+  // Drop about a tenth of the samples and weight the others unevenly.
+  for (i = 0; i < f_size; ++i)
+    weights[i] = ran2_dp(5) < 0.1 ? 0.0 : 0.5 + ran2_dp(5);
+
+  options.method = SO3_SOLVER_CG;
+  options.preconditioner = SO3_SOLVER_PRECONDITIONER_JACOBI;
+  check_recovery(base_parameters, weights, &options);
+  options.method = SO3_SOLVER_LSQR;
+  check_recovery(base_parameters, weights, &options);
+  options.preconditioner = SO3_SOLVER_PRECONDITIONER_NONE;
+  check_recovery(base_parameters, weights, &options);
+
+  free(weights);
+}
+
+static void test_solver_damping(void **state) {
+  const so3_parameters_t *base_parameters = *state;
+  const int flmn_size = so3_sampling_flmn_size(base_parameters);
+  const int f_size = so3_sampling_f_size(base_parameters);
+  complex double *flmn = alloc_random_flmn(base_parameters, 6);
+  complex double *flmn_cg = malloc(flmn_size * sizeof *flmn_cg);
+  complex double *flmn_lsqr = malloc(flmn_size * sizeof *flmn_lsqr);
+  complex double *f = malloc(f_size * sizeof *f);
+  so3_solver_options_t options = {
+      .max_iterations = 500, .tolerance = 1e-13, .damping = 1e-3};
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_cg);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_lsqr);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+
+  so3_core_inverse_direct(f, flmn, base_parameters);
+  so3_solver_t *solver = so3_solver_init(base_parameters);
+  options.method = SO3_SOLVER_CG;
+  so3_solver_solve(solver, flmn_cg, f, &options, NULL);
+  options.method = SO3_SOLVER_LSQR;
+  so3_solver_solve(solver, flmn_lsqr, f, &options, NULL);
+
+  // Both minimise the same damped functional.
+  assert_complex_array_equal(flmn_lsqr, flmn_cg, flmn_size, 1e-8);
+
+  // The preconditioner changes the iterations but not the damped functional.
+  options.preconditioner = SO3_SOLVER_PRECONDITIONER_JACOBI;
+  so3_solver_solve(solver, flmn_lsqr, f, &options, NULL);
+  assert_complex_array_equal(flmn_lsqr, flmn_cg, flmn_size, 1e-8);
+  options.method = SO3_SOLVER_CG;
+  so3_solver_solve(solver, flmn_lsqr, f, &options, NULL);
+  assert_complex_array_equal(flmn_lsqr, flmn_cg, flmn_size, 1e-8);
+  so3_solver_free(solver);
+
+  free(flmn);
+  free(flmn_cg);
+  free(flmn_lsqr);
+  free(f);
+}
+
+int main(void) {
+  so3_parameters_t parameters = test_parameters(8, 4, SO3_STORAGE_COMPACT);
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_prestate(test_solver_operators, &parameters),
+      cmocka_unit_test_prestate(test_solver_full_sampling, &parameters),
+      cmocka_unit_test_prestate(test_solver_masked, &parameters),
+      cmocka_unit_test_prestate(test_solver_damping, &parameters),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,210 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <complex.h>
+
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_sparse.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+#define MAX_COEFFICIENTS 64
+
+// Every stride-th non-zero coefficient of flmn, with its value.
+static int pick_coefficients(
+    so3_sparse_coefficient_t *coefficients, const complex double *flmn, int stride,
+    const so3_parameters_t *parameters) {
+  so3_flmn_iter_t iter;
+  int count = 0, ncoefficients = 0;
+  so3_flmn_iter_init(&iter, parameters);
+  while (so3_flmn_iter_next(&iter) && ncoefficients < MAX_COEFFICIENTS) {
+    if (!so3_sampling_is_elmn_non_zero(iter.el, iter.m, iter.n, parameters))
+      continue;
+    if (count++ % stride)
+      continue;
+    coefficients[ncoefficients].el = iter.el;
+    coefficients[ncoefficients].m = iter.m;
+    coefficients[ncoefficients].n = iter.n;
+    coefficients[ncoefficients].value = flmn[iter.ind];
+    ++ncoefficients;
+  }
+  return ncoefficients;
+}
+
+static void check_sparse(const so3_parameters_t *parameters) {
+  const int f_size = so3_sampling_f_size(parameters);
+  const int flmn_size = so3_sampling_flmn_size(parameters);
+  const so3_sparse_method_t methods[] = {SO3_SPARSE_SYNTHESIS, SO3_SPARSE_DENSE};
+  so3_sparse_coefficient_t coefficients[MAX_COEFFICIENTS];
+  complex double *flmn = alloc_random_flmn(parameters, 1);
+  complex double *sparse_flmn = calloc(flmn_size, sizeof *sparse_flmn);
+  complex double *f = malloc(f_size * sizeof *f);
+  complex double *expected = malloc(f_size * sizeof *expected);
+  int ncoefficients, i, k;
+  SO3_ERROR_MEM_ALLOC_CHECK(sparse_flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+
+  ncoefficients = pick_coefficients(coefficients, flmn, 7, parameters);
+  for (i = 0; i < ncoefficients; ++i) {
+    int ind;
+    so3_sampling_elmn2ind(
+        &ind, coefficients[i].el, coefficients[i].m, coefficients[i].n, parameters);
+    sparse_flmn[ind] = coefficients[i].value;
+  }
+  so3_core_inverse_direct(expected, sparse_flmn, parameters);
+
+  for (k = 0; k < 2; ++k) {
+    so3_sparse_inverse(f, coefficients, ncoefficients, methods[k], parameters);
+    assert_complex_array_equal(f, expected, f_size, 1e-10);
+  }
+
+  // Forward transform of a signal with all coefficients, of which only the
+  // subset is requested.
+  so3_core_inverse_direct(f, flmn, parameters);
+  for (k = 0; k < 2; ++k) {
+    for (i = 0; i < ncoefficients; ++i)
+      coefficients[i].value = 0.0;
+    so3_sparse_forward(coefficients, ncoefficients, f, methods[k], parameters);
+    for (i = 0; i < ncoefficients; ++i) {
+      int ind;
+      so3_sampling_elmn2ind(
+          &ind, coefficients[i].el, coefficients[i].m, coefficients[i].n, parameters);
+      assert_float_equal(creal(coefficients[i].value), creal(flmn[ind]), 1e-10);
+      assert_float_equal(cimag(coefficients[i].value), cimag(flmn[ind]), 1e-10);
+    }
+  }
+
+  free(flmn);
+  free(sparse_flmn);
+  free(f);
+  free(expected);
+}
+
+static void test_sparse_complex(void **state) {
+  const so3_parameters_t *base_parameters = *state;
+  so3_parameters_t parameters = *base_parameters;
+  check_sparse(&parameters);
+
+  parameters.sampling_scheme = SO3_SAMPLING_MW_SS;
+  parameters.storage = SO3_STORAGE_PADDED;
+  parameters.n_order = SO3_N_ORDER_ZERO_FIRST;
+  check_sparse(&parameters);
+
+  parameters = *base_parameters;
+  parameters.L0 = 2;
+  parameters.n_mode = SO3_N_MODE_EVEN;
+  check_sparse(&parameters);
+
+  parameters = *base_parameters;
+  parameters.M = 5;
+  check_sparse(&parameters);
+}
+
+static void test_sparse_real(void **state) {
+  so3_parameters_t parameters = *(const so3_parameters_t *)*state;
+  parameters.reality = 1;
+  parameters.sampling_scheme = SO3_SAMPLING_MW_SS;
+  const int f_size = so3_sampling_f_size(&parameters);
+  const int flmn_size = so3_sampling_flmn_size(&parameters);
+  const so3_sparse_method_t methods[] = {SO3_SPARSE_SYNTHESIS, SO3_SPARSE_DENSE};
+  so3_sparse_coefficient_t coefficients[MAX_COEFFICIENTS];
+  complex double *flmn = alloc_random_flmn(&parameters, 1);
+  complex double *sparse_flmn = calloc(flmn_size, sizeof *sparse_flmn);
+  double *f = malloc(f_size * sizeof *f);
+  double *expected = malloc(f_size * sizeof *expected);
+  int ncoefficients, i, k;
+  SO3_ERROR_MEM_ALLOC_CHECK(sparse_flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+  SO3_ERROR_MEM_ALLOC_CHECK(expected);
+
+  // The n = 0 coefficients of real signals come in pairs (el, +-m, 0), so
+  // take them all.
+  ncoefficients = 0;
+  so3_flmn_iter_t iter;
+  so3_flmn_iter_init(&iter, &parameters);
+  while (so3_flmn_iter_next(&iter)) {
+    if ((iter.n == 0 && iter.el < 4) || (iter.n == 2 && iter.el == 5)) {
+      coefficients[ncoefficients].el = iter.el;
+      coefficients[ncoefficients].m = iter.m;
+      coefficients[ncoefficients].n = iter.n;
+      coefficients[ncoefficients].value = flmn[iter.ind];
+      sparse_flmn[iter.ind] = flmn[iter.ind];
+      ++ncoefficients;
+    }
+  }
+  so3_core_inverse_direct_real(expected, sparse_flmn, &parameters);
+
+  for (k = 0; k < 2; ++k) {
+    so3_sparse_inverse_real(f, coefficients, ncoefficients, methods[k], &parameters);
+    for (i = 0; i < f_size; ++i)
+      assert_float_equal(f[i], expected[i], 1e-10);
+  }
+
+  so3_core_inverse_direct_real(f, flmn, &parameters);
+  for (k = 0; k < 2; ++k) {
+    so3_sparse_forward_real(coefficients, ncoefficients, f, methods[k], &parameters);
+    for (i = 0; i < ncoefficients; ++i) {
+      int ind;
+      so3_sampling_elmn2ind_real(
+          &ind, coefficients[i].el, coefficients[i].m, coefficients[i].n, &parameters);
+      assert_float_equal(creal(coefficients[i].value), creal(flmn[ind]), 1e-10);
+      assert_float_equal(cimag(coefficients[i].value), cimag(flmn[ind]), 1e-10);
+    }
+  }
+
+  free(flmn);
+  free(sparse_flmn);
+  free(f);
+  free(expected);
+}
+
+static void test_sparse_method_select(void **state) {
+  so3_parameters_t parameters = *(const so3_parameters_t *)*state;
+  parameters.L = 32;
+  parameters.N = 8;
+  const int flmn_size = so3_sampling_flmn_size(&parameters);
+  so3_sparse_coefficient_t *coefficients = malloc(flmn_size * sizeof *coefficients);
+  so3_flmn_iter_t iter;
+  int ncoefficients = 0;
+  SO3_ERROR_MEM_ALLOC_CHECK(coefficients);
+
+  so3_flmn_iter_init(&iter, &parameters);
+  while (so3_flmn_iter_next(&iter)) {
+    coefficients[ncoefficients].el = iter.el;
+    coefficients[ncoefficients].m = iter.m;
+    coefficients[ncoefficients].n = iter.n;
+    ++ncoefficients;
+  }
+
+  assert_int_equal(
+      so3_sparse_method_select(coefficients, 3, 0, &parameters), SO3_SPARSE_SYNTHESIS);
+  assert_int_equal(
+      so3_sparse_method_select(coefficients, 3, 1, &parameters), SO3_SPARSE_SYNTHESIS);
+  assert_int_equal(
+      so3_sparse_method_select(coefficients, ncoefficients, 0, &parameters),
+      SO3_SPARSE_DENSE);
+  assert_int_equal(
+      so3_sparse_method_select(coefficients, ncoefficients, 1, &parameters),
+      SO3_SPARSE_DENSE);
+
+  free(coefficients);
+}
+
+int main(void) {
+  so3_parameters_t parameters = test_parameters(8, 4, SO3_STORAGE_COMPACT);
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_prestate(test_sparse_complex, &parameters),
+      cmocka_unit_test_prestate(test_sparse_real, &parameters),
+      cmocka_unit_test_prestate(test_sparse_method_select, &parameters),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
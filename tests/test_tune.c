@@ -0,0 +1,159 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "so3/so3_core.h"
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_tune.h"
+#include "so3/so3_types.h"
+#include "utilities.h"
+
+#include <cmocka.h>
+
+#define TUNE_FILE "so3_test_tune.txt"
+
+static const so3_parameters_t base_parameters = {
+    .L0 = 0,
+    .L = 6,
+    .N = 3,
+    .verbosity = 0,
+    .n_mode = SO3_N_MODE_ALL,
+    .reality = 0,
+    .sampling_scheme = SO3_SAMPLING_MW,
+    .n_order = SO3_N_ORDER_ZERO_FIRST,
+    .storage = SO3_STORAGE_PADDED,
+    .dl_method = SSHT_DL_RISBO,
+    .steerable = 0};
+
+static int setup(void **state) {
+  remove(TUNE_FILE);
+  so3_tune_set_file(TUNE_FILE);
+  return 0;
+}
+
+static int teardown(void **state) {
+  so3_tune_set_file(NULL);
+  remove(TUNE_FILE);
+  return 0;
+}
+
+static int count_lines(const char *path) {
+  FILE *file = fopen(path, "r");
+  int c, lines = 0;
+  if (!file)
+    return 0;
+  while ((c = fgetc(file)) != EOF)
+    lines += c == '\n';
+  fclose(file);
+  return lines;
+}
+
+static void test_tune_reads_file(void **state) {
+  FILE *file = fopen(TUNE_FILE, "w");
+  assert_non_null(file);
+  fprintf(file, "# comment\n");
+  // A line of the format without the Wigner tolerance is ignored.
+  fprintf(file, "forward 1 0 6 6 3 0 0 0 direct risbo 9.0e+00\n");
+  fprintf(file, "forward 1 0 6 6 3 0 0 0 0 via_ssht trapani 1.5e+00\n");
+  fprintf(file, "forward 1 0 6 6 3 0 0 0 1e-08 direct risbo 2.5e+00\n");
+  fclose(file);
+
+  so3_parameters_t parameters = base_parameters;
+  parameters.reality = 1;
+  so3_tune_choice_t choice = so3_tune_select(&parameters, SO3_TUNE_FORWARD);
+  assert_int_equal(choice.method, SO3_TUNE_METHOD_VIA_SSHT);
+  assert_int_equal(choice.dl_method, SSHT_DL_TRAPANI);
+  assert_float_equal(choice.seconds, 1.5, 1e-12);
+
+  // Truncated transforms are tuned separately from exact ones.
+  parameters.dl_tolerance = 1e-8;
+  choice = so3_tune_select(&parameters, SO3_TUNE_FORWARD);
+  assert_int_equal(choice.method, SO3_TUNE_METHOD_DIRECT);
+  assert_int_equal(choice.dl_method, SSHT_DL_RISBO);
+  assert_float_equal(choice.seconds, 2.5, 1e-12);
+  assert_int_equal(count_lines(TUNE_FILE), 4);
+}
+
+static void test_tune_persists_choice(void **state) {
+  so3_parameters_t parameters = base_parameters;
+  // SSHT cannot handle M < L, so only the direct transforms are candidates.
+  parameters.M = 4;
+  so3_tune_choice_t choice = so3_tune_select(&parameters, SO3_TUNE_INVERSE);
+  assert_int_equal(choice.method, SO3_TUNE_METHOD_DIRECT);
+  assert_true(choice.seconds > 0.0);
+  assert_int_equal(count_lines(TUNE_FILE), 1);
+
+  // A second selection must not benchmark or store again.
+  so3_tune_clear();
+  so3_tune_choice_t again = so3_tune_select(&parameters, SO3_TUNE_INVERSE);
+  assert_int_equal(again.method, choice.method);
+  assert_int_equal(again.dl_method, choice.dl_method);
+  assert_float_equal(again.seconds, choice.seconds, 1e-6 * choice.seconds);
+  assert_int_equal(count_lines(TUNE_FILE), 1);
+}
+
+static void test_auto_complex(void **state) {
+  const so3_parameters_t parameters = base_parameters;
+  const int flmn_size = so3_sampling_flmn_size(&parameters);
+  complex double *flmn = calloc(flmn_size, sizeof *flmn);
+  complex double *flmn_auto = calloc(flmn_size, sizeof *flmn_auto);
+  complex double *f = calloc(so3_sampling_f_size(&parameters), sizeof *f);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_auto);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+
+  gen_flmn_complex(flmn, &parameters, 1);
+  so3_core_inverse_auto(f, flmn, &parameters);
+  so3_core_forward_auto(flmn_auto, f, &parameters);
+  for (int i = 0; i < flmn_size; ++i) {
+    assert_float_equal(creal(flmn_auto[i]), creal(flmn[i]), 1e-10);
+    assert_float_equal(cimag(flmn_auto[i]), cimag(flmn[i]), 1e-10);
+  }
+  assert_int_equal(count_lines(TUNE_FILE), 2);
+
+  free(flmn);
+  free(flmn_auto);
+  free(f);
+}
+
+static void test_auto_real(void **state) {
+  so3_parameters_t parameters = base_parameters;
+  parameters.reality = 1;
+  parameters.sampling_scheme = SO3_SAMPLING_MW_SS;
+  const int flmn_size = so3_sampling_flmn_size(&parameters);
+  // The generator fills a fully padded, complex coefficient array.
+  complex double *flmn =
+      calloc((2 * parameters.N - 1) * parameters.L * parameters.L, sizeof *flmn);
+  complex double *flmn_auto = calloc(flmn_size, sizeof *flmn_auto);
+  double *f = calloc(so3_sampling_f_size(&parameters), sizeof *f);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn_auto);
+  SO3_ERROR_MEM_ALLOC_CHECK(f);
+
+  gen_flmn_real(flmn, &parameters, 1);
+  so3_core_inverse_auto_real(f, flmn, &parameters);
+  so3_core_forward_auto_real(flmn_auto, f, &parameters);
+  for (int i = 0; i < flmn_size; ++i) {
+    assert_float_equal(creal(flmn_auto[i]), creal(flmn[i]), 1e-10);
+    assert_float_equal(cimag(flmn_auto[i]), cimag(flmn[i]), 1e-10);
+  }
+
+  free(flmn);
+  free(flmn_auto);
+  free(f);
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test_setup_teardown(test_tune_reads_file, setup, teardown),
+      cmocka_unit_test_setup_teardown(test_tune_persists_choice, setup, teardown),
+      cmocka_unit_test_setup_teardown(test_auto_complex, setup, teardown),
+      cmocka_unit_test_setup_teardown(test_auto_real, setup, teardown),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
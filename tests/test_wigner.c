@@ -0,0 +1,123 @@
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <complex.h>
+#include <math.h>
+
+#include "so3/so3_error.h"
+#include "so3/so3_sampling.h"
+#include "so3/so3_types.h"
+#include "so3/so3_wigner.h"
+
+#include <cmocka.h>
+
+#define COUNT 5
+
+static const double alphas[COUNT] = {0.0, 0.3, 1.7, 4.0, 6.1};
+static const double betas[COUNT] = {0.0, 0.4, SO3_PI / 2, 2.9, SO3_PI};
+static const double gammas[COUNT] = {0.0, 5.2, 0.9, 2.2, 3.3};
+
+// Explicit sum for d^el_mn(beta).
+static double wigner_d_sum(int el, int m, int n, double beta) {
+  const double c = cos(beta / 2), s = sin(beta / 2);
+  double sum = 0.0;
+  int k;
+  for (k = 0; k <= 2 * el; ++k) {
+    if (el + n - k < 0 || m - n + k < 0 || el - m - k < 0)
+      continue;
+    sum += ((m - n + k) % 2 ? -1.0 : 1.0) *
+           exp(0.5 * (lgamma(el + m + 1.0) + lgamma(el - m + 1.0) +
+                      lgamma(el + n + 1.0) + lgamma(el - n + 1.0)) -
+               lgamma(el + n - k + 1.0) - lgamma(k + 1.0) -
+               lgamma(m - n + k + 1.0) - lgamma(el - m - k + 1.0)) *
+           pow(c, 2 * el + n - m - 2 * k) * pow(s, m - n + 2 * k);
+  }
+  return sum;
+}
+
+static void check_D_batch(int el_max, so3_storage_t storage, so3_n_order_t n_order) {
+  so3_parameters_t parameters = {0};
+  const int size = so3_wigner_D_size(el_max, storage);
+  complex double *D = malloc(COUNT * size * sizeof *D);
+  so3_flmn_iter_t iter;
+  int r;
+  SO3_ERROR_MEM_ALLOC_CHECK(D);
+
+  so3_wigner_D_batch(D, el_max, alphas, betas, gammas, COUNT, storage, n_order);
+
+  parameters.L = el_max + 1;
+  parameters.N = el_max + 1;
+  parameters.storage = storage;
+  parameters.n_order = n_order;
+  assert_int_equal(size, so3_sampling_flmn_size(&parameters));
+  for (r = 0; r < COUNT; ++r) {
+    so3_flmn_iter_init(&iter, &parameters);
+    while (so3_flmn_iter_next(&iter)) {
+      complex double expected = 0.0;
+      if (abs(iter.m) <= iter.el && abs(iter.n) <= iter.el)
+        expected = cexp(-I * (iter.m * alphas[r] + iter.n * gammas[r])) *
+                   wigner_d_sum(iter.el, iter.m, iter.n, betas[r]);
+      assert_float_equal(creal(D[r * size + iter.ind]), creal(expected), 1e-12);
+      assert_float_equal(cimag(D[r * size + iter.ind]), cimag(expected), 1e-12);
+    }
+  }
+  free(D);
+}
+
+static void test_wigner_D_batch(void **state) {
+  (void)state;
+  check_D_batch(6, SO3_STORAGE_PADDED, SO3_N_ORDER_ZERO_FIRST);
+  check_D_batch(6, SO3_STORAGE_PADDED, SO3_N_ORDER_NEGATIVE_FIRST);
+  check_D_batch(6, SO3_STORAGE_COMPACT, SO3_N_ORDER_ZERO_FIRST);
+  check_D_batch(6, SO3_STORAGE_COMPACT, SO3_N_ORDER_NEGATIVE_FIRST);
+}
+
+// The D-matrices are unitary, which also checks the stability of the
+// recursion at degrees where the explicit sum loses accuracy.
+static void test_wigner_D_unitary(void **state) {
+  (void)state;
+  const int el_max = 64;
+  so3_parameters_t parameters = {0};
+  const int size = so3_wigner_D_size(el_max, SO3_STORAGE_COMPACT);
+  complex double *D = malloc(COUNT * size * sizeof *D);
+  int r, el, m, mp, n;
+  SO3_ERROR_MEM_ALLOC_CHECK(D);
+
+  parameters.L = el_max + 1;
+  parameters.N = el_max + 1;
+  parameters.storage = SO3_STORAGE_COMPACT;
+  parameters.n_order = SO3_N_ORDER_NEGATIVE_FIRST;
+  so3_wigner_D_batch(
+      D, el_max, alphas, betas, gammas, COUNT, SO3_STORAGE_COMPACT,
+      SO3_N_ORDER_NEGATIVE_FIRST);
+
+  for (r = 0; r < COUNT; ++r) {
+    for (el = 0; el <= el_max; el += 16) {
+      for (m = -el; m <= el; m += 3) {
+        for (mp = -el; mp <= el; mp += 5) {
+          complex double sum = 0.0;
+          for (n = -el; n <= el; ++n) {
+            int ind, indp;
+            so3_sampling_elmn2ind(&ind, el, m, n, &parameters);
+            so3_sampling_elmn2ind(&indp, el, mp, n, &parameters);
+            sum += D[r * size + ind] * conj(D[r * size + indp]);
+          }
+          assert_float_equal(creal(sum), m == mp ? 1.0 : 0.0, 1e-10);
+          assert_float_equal(cimag(sum), 0.0, 1e-10);
+        }
+      }
+    }
+  }
+  free(D);
+}
+
+int main(void) {
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_wigner_D_batch),
+      cmocka_unit_test(test_wigner_D_unitary),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -1,4 +1,7 @@
 #include <complex.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -7,6 +10,8 @@
 #include "so3/so3_sampling.h"
 #include "utilities.h"
 
+#include <cmocka.h>
+
 int max(int a, int b) {
   if (a > b)
     return a;
@@ -31,12 +36,13 @@ int max(int a, int b) {
  */
 void gen_flmn_complex(
     complex double *flmn, const so3_parameters_t *parameters, int seed) {
-  int L0, L, N;
+  int L0, L, N, mlim;
   int i, el, m, n, n_start, n_stop, n_inc, ind;
 
   L0 = parameters->L0;
   L = parameters->L;
   N = parameters->N;
+  mlim = so3_sampling_mlim(parameters);
 
   for (i = 0; i < (2 * N - 1) * L * L; ++i)
     flmn[i] = 0.0;
@@ -76,6 +82,8 @@ void gen_flmn_complex(
         break;
 
       for (m = -el; m <= el; ++m) {
+        if (abs(m) >= mlim)
+          continue;
         so3_sampling_elmn2ind(&ind, el, m, n, parameters);
         flmn[ind] = (2.0 * ran2_dp(seed) - 1.0) + I * (2.0 * ran2_dp(seed) - 1.0);
       }
@@ -104,13 +112,14 @@ void gen_flmn_complex(
  */
 void gen_flmn_real(
     complex double *flmn, const so3_parameters_t *parameters, int seed) {
-  int L0, L, N;
+  int L0, L, N, mlim;
   int i, el, m, n, n_start, n_stop, n_inc, ind;
   double real, imag;
 
   L0 = parameters->L0;
   L = parameters->L;
   N = parameters->N;
+  mlim = so3_sampling_mlim(parameters);
 
   for (i = 0; i < (2 * N - 1) * L * L; ++i)
     flmn[i] = 0.0;
@@ -158,7 +167,7 @@ void gen_flmn_real(
         if (parameters->n_mode == SO3_N_MODE_L && el != 0)
           break;
 
-        for (m = 1; m <= el; ++m) {
+        for (m = 1; m <= el && m < mlim; ++m) {
           real = (2.0 * ran2_dp(seed) - 1.0);
           imag = (2.0 * ran2_dp(seed) - 1.0);
           so3_sampling_elmn2ind_real(&ind, el, m, 0, parameters);
@@ -177,6 +186,8 @@ void gen_flmn_real(
           break;
 
         for (m = -el; m <= el; ++m) {
+          if (abs(m) >= mlim)
+            continue;
 
           so3_sampling_elmn2ind_real(&ind, el, m, n, parameters);
           flmn[ind] = (2.0 * ran2_dp(seed) - 1.0) + I * (2.0 * ran2_dp(seed) - 1.0);
@@ -237,3 +248,67 @@ double ran2_dp(int idum) {
     iy = iy + IMM1;
   return (AM * iy < RNMX ? AM * iy : RNMX); // min(AM*iy,RNMX);
 }
+
+/*!
+ * Parameters shared by the unit tests: complex signals sampled with MW and
+ * all n-modes, starting from el = 0. Tests change fields from there.
+ *
+ * \param[in] L Harmonic band-limit.
+ * \param[in] N Azimuthal band-limit.
+ * \param[in] storage Storage method of the coefficients.
+ * \retval parameters Parameters of the signals.
+ */
+so3_parameters_t test_parameters(int L, int N, so3_storage_t storage) {
+  so3_parameters_t parameters = {
+      .L0 = 0,
+      .L = L,
+      .N = N,
+      .verbosity = 0,
+      .n_mode = SO3_N_MODE_ALL,
+      .sampling_scheme = SO3_SAMPLING_MW,
+      .n_order = SO3_N_ORDER_NEGATIVE_FIRST,
+      .storage = storage,
+      .dl_method = SSHT_DL_RISBO,
+      .reality = 0,
+      .steerable = 0};
+  return parameters;
+}
+
+/*!
+ * Allocate and generate random Wigner coefficients of a real or complex
+ * signal, as selected by the reality flag.
+ *
+ * \param[in] parameters Parameters of the signal.
+ * \param[in] seed Integer seed required for random number generator.
+ * \retval flmn Coefficients in an array of (2*N-1)*L*L elements, as the
+ *              generators require. Free it with free.
+ */
+complex double *alloc_random_flmn(const so3_parameters_t *parameters, int seed) {
+  complex double *flmn =
+      malloc((2 * parameters->N - 1) * parameters->L * parameters->L * sizeof *flmn);
+  SO3_ERROR_MEM_ALLOC_CHECK(flmn);
+  if (parameters->reality)
+    gen_flmn_real(flmn, parameters, seed);
+  else
+    gen_flmn_complex(flmn, parameters, seed);
+  return flmn;
+}
+
+/*!
+ * Assert that two complex arrays agree element by element.
+ *
+ * \param[in] actual Computed values.
+ * \param[in] expected Expected values.
+ * \param[in] size Number of elements.
+ * \param[in] tolerance Absolute tolerance on the real and imaginary parts.
+ * \retval none
+ */
+void assert_complex_array_equal(
+    const complex double *actual, const complex double *expected, int size,
+    double tolerance) {
+  int i;
+  for (i = 0; i < size; ++i) {
+    assert_float_equal(creal(actual[i]), creal(expected[i]), tolerance);
+    assert_float_equal(cimag(actual[i]), cimag(expected[i]), tolerance);
+  }
+}
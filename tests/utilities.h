@@ -9,4 +9,9 @@ int max(int a, int b);
 void gen_flmn_real(complex double *flmn, const so3_parameters_t *parameters, int seed);
 void gen_flmn_complex(
     complex double *flmn, const so3_parameters_t *parameters, int seed);
+so3_parameters_t test_parameters(int L, int N, so3_storage_t storage);
+complex double *alloc_random_flmn(const so3_parameters_t *parameters, int seed);
+void assert_complex_array_equal(
+    const complex double *actual, const complex double *expected, int size,
+    double tolerance);
 #endif